@@ -3,21 +3,27 @@ import json
 import logging
 from contextlib import asynccontextmanager
 
-from fastapi import FastAPI, Query, WebSocket, WebSocketDisconnect
+from fastapi import APIRouter, Depends, FastAPI, HTTPException, Query, WebSocket, WebSocketDisconnect
 from fastapi.middleware.cors import CORSMiddleware
-from fastapi.responses import JSONResponse
+from fastapi.responses import JSONResponse, Response
 
 import tank_sim
 
+from .metrics import CONTENT_TYPE as METRICS_CONTENT_TYPE
 from .models import (
     ConfigResponse,
+    ForecastCommand,
     InletFlowCommand,
     InletModeCommand,
     PIDTuningCommand,
+    SessionCreateCommand,
     SetpointCommand,
+    SimulationRateCommand,
     SimulationState,
 )
+from .sessions import SessionLimitError, SessionRegistry
 from .simulation import SimulationManager
+from .telemetry import FORMAT_BINARY, FORMAT_JSON, FORMATS, encode_history
 
 # Configure logging
 logging.basicConfig(
@@ -26,7 +32,10 @@ logging.basicConfig(
 )
 logger = logging.getLogger(__name__)
 
-# Global simulation manager instance
+# Global session registry; every session is stepped by its C++ SessionPool
+sessions: SessionRegistry | None = None
+
+# The default session, which also backs the unscoped /api routes and /ws
 simulation_manager: SimulationManager | None = None
 
 # Track the background simulation loop task
@@ -39,15 +48,17 @@ async def lifespan(app: FastAPI):
     Manages application startup and shutdown.
     """
     # Startup
-    global simulation_manager, simulation_task
+    global sessions, simulation_manager, simulation_task
     try:
-        config = tank_sim.create_default_config()
-        simulation_manager = SimulationManager(config)
-        simulation_manager.initialize()
-        logger.info("Application started successfully")
+        sessions = SessionRegistry()
+        simulation_manager = sessions.create(SessionRegistry.DEFAULT_SESSION)
+        logger.info(
+            f"Application started successfully "
+            f"({sessions.pool.thread_count} session pool threads)"
+        )
 
         # Start the simulation loop as a background task
-        simulation_task = asyncio.create_task(simulation_manager.simulation_loop())
+        simulation_task = asyncio.create_task(sessions.simulation_loop())
         logger.info("Simulation loop started")
 
     except Exception as e:
@@ -89,6 +100,25 @@ app.add_middleware(
 )
 
 
+def get_session(session_id: str = SessionRegistry.DEFAULT_SESSION) -> SimulationManager:
+    """
+    Resolve the session a request targets.
+
+    Under /api/sessions/{session_id} the id comes from the path; under the
+    unscoped /api routes it defaults to the default session.
+    """
+    if sessions is None:
+        raise HTTPException(status_code=503, detail="Simulation not initialized")
+    manager = sessions.get(session_id)
+    if manager is None:
+        raise HTTPException(status_code=404, detail=f"Unknown session '{session_id}'")
+    return manager
+
+
+# Per-session endpoints, mounted at /api and at /api/sessions/{session_id}
+router = APIRouter()
+
+
 # REST Endpoints
 @app.get("/api/health")
 async def health_check():
@@ -96,32 +126,94 @@ async def health_check():
     return {"status": "ok"}
 
 
-@app.get("/api/state", response_model=SimulationState)
-async def get_state():
+@app.get("/metrics", include_in_schema=False)
+async def get_metrics():
+    """Prometheus scrape endpoint: simulator hot-path and scheduler metrics."""
+    if sessions is None:
+        return Response(status_code=503)
+    async with sessions.step_lock:
+        content = sessions.get_metrics_text()
+    return Response(content=content, media_type=METRICS_CONTENT_TYPE)
+
+
+@app.post("/api/sessions", status_code=201)
+async def create_session(command: SessionCreateCommand | None = None):
+    """Create an independent simulation session (a random id if none is given)."""
+    if sessions is None:
+        return JSONResponse(status_code=500, content={"error": "Simulation not initialized"})
+    try:
+        manager = sessions.create(command.session_id if command is not None else None)
+    except SessionLimitError as e:
+        return JSONResponse(status_code=429, content={"error": str(e)})
+    except ValueError as e:
+        return JSONResponse(status_code=409, content={"error": str(e)})
+    except Exception as e:
+        logger.error(f"Error creating session: {e}")
+        return JSONResponse(status_code=500, content={"error": str(e)})
+    async with sessions.step_lock:
+        return sessions.describe(manager)
+
+
+@app.get("/api/sessions")
+async def list_sessions():
+    """List every session with its clock, rate and connection count."""
+    if sessions is None:
+        return JSONResponse(status_code=500, content={"error": "Simulation not initialized"})
+    async with sessions.step_lock:
+        described = [sessions.describe(m) for m in sessions.sessions.values()]
+    return {
+        "max_sessions": sessions.MAX_SESSIONS,
+        "pool_threads": sessions.pool.thread_count,
+        "sessions": described,
+    }
+
+
+@app.delete("/api/sessions/{session_id}")
+async def delete_session(session_id: str):
+    """Remove a session and close its WebSocket connections."""
+    if sessions is None:
+        return JSONResponse(status_code=500, content={"error": "Simulation not initialized"})
+    if session_id not in sessions:
+        return JSONResponse(
+            status_code=404, content={"error": f"Unknown session '{session_id}'"}
+        )
+    try:
+        await sessions.remove(session_id)
+    except ValueError as e:
+        return JSONResponse(status_code=409, content={"error": str(e)})
+    return {"message": "Session removed", "session_id": session_id}
+
+
+@router.get("/state", response_model=SimulationState)
+async def get_state(manager: SimulationManager = Depends(get_session)):
     """Get current simulation state snapshot."""
     try:
-        if simulation_manager is None or not simulation_manager.initialized:
+        if not manager.initialized:
             return JSONResponse(
                 status_code=500, content={"error": "Simulation not initialized"}
             )
 
-        state = simulation_manager.get_state()
+        async with manager.step_lock:
+            state = manager.get_state()
         return state
     except Exception as e:
         logger.error(f"Error getting state: {e}")
         return JSONResponse(status_code=500, content={"error": str(e)})
 
 
-@app.get("/api/config", response_model=ConfigResponse)
-async def get_config():
+@router.get("/config", response_model=ConfigResponse)
+async def get_config(manager: SimulationManager = Depends(get_session)):
     """Get current simulation configuration."""
     try:
-        if simulation_manager is None or not simulation_manager.initialized:
+        if not manager.initialized:
             return JSONResponse(
                 status_code=500, content={"error": "Simulation not initialized"}
             )
 
-        config = simulation_manager.config
+        async with manager.step_lock:
+            history_size = manager.history_size()
+
+        config = manager.config
         model_params = config.model_params
         controller = config.controllers[0]
         gains = controller.gains
@@ -138,24 +230,28 @@ async def get_config():
                 "tau_D": gains.tau_D,
             },
             "timestep": config.dt,
-            "history_capacity": 7200,
-            "history_size": len(simulation_manager.history),
+            "history_capacity": manager.HISTORY_CAPACITY,
+            "history_size": history_size,
+            "max_trend_duration": manager.max_trend_duration,
+            "speed_factor": manager.speed_factor,
+            "publish_interval": manager.publish_interval,
         }
     except Exception as e:
         logger.error(f"Error getting config: {e}")
         return JSONResponse(status_code=500, content={"error": str(e)})
 
 
-@app.post("/api/reset")
-async def reset_simulation():
+@router.post("/reset")
+async def reset_simulation(manager: SimulationManager = Depends(get_session)):
     """Reset simulation to initial steady state."""
     try:
-        if simulation_manager is None or not simulation_manager.initialized:
+        if not manager.initialized:
             return JSONResponse(
                 status_code=500, content={"error": "Simulation not initialized"}
             )
 
-        simulation_manager.reset()
+        async with manager.step_lock:
+            manager.reset()
         logger.info("Simulation reset")
         return {"message": "Simulation reset successfully"}
     except Exception as e:
@@ -163,16 +259,18 @@ async def reset_simulation():
         return JSONResponse(status_code=500, content={"error": str(e)})
 
 
-@app.post("/api/setpoint")
-async def set_setpoint(command: SetpointCommand):
+@router.post("/setpoint")
+async def set_setpoint(
+    command: SetpointCommand, manager: SimulationManager = Depends(get_session)
+):
     """Update the simulation setpoint."""
     try:
-        if simulation_manager is None or not simulation_manager.initialized:
+        if not manager.initialized:
             return JSONResponse(
                 status_code=500, content={"error": "Simulation not initialized"}
             )
 
-        simulation_manager.set_setpoint(command.value)
+        manager.set_setpoint(command.value)
         logger.info(f"Setpoint changed to {command.value}")
         return {"message": "Setpoint updated", "value": command.value}
     except Exception as e:
@@ -180,11 +278,13 @@ async def set_setpoint(command: SetpointCommand):
         return JSONResponse(status_code=500, content={"error": str(e)})
 
 
-@app.post("/api/pid")
-async def set_pid_gains(command: PIDTuningCommand):
+@router.post("/pid")
+async def set_pid_gains(
+    command: PIDTuningCommand, manager: SimulationManager = Depends(get_session)
+):
     """Update PID controller gains."""
     try:
-        if simulation_manager is None or not simulation_manager.initialized:
+        if not manager.initialized:
             return JSONResponse(
                 status_code=500, content={"error": "Simulation not initialized"}
             )
@@ -193,7 +293,7 @@ async def set_pid_gains(command: PIDTuningCommand):
         gains.Kc = command.Kc
         gains.tau_I = command.tau_I
         gains.tau_D = command.tau_D
-        simulation_manager.set_pid_gains(gains)
+        manager.set_pid_gains(gains)
         logger.info(
             f"PID gains updated: Kc={command.Kc}, tau_I={command.tau_I}, tau_D={command.tau_D}"
         )
@@ -206,16 +306,18 @@ async def set_pid_gains(command: PIDTuningCommand):
         return JSONResponse(status_code=500, content={"error": str(e)})
 
 
-@app.post("/api/inlet_flow")
-async def set_inlet_flow(command: InletFlowCommand):
+@router.post("/inlet_flow")
+async def set_inlet_flow(
+    command: InletFlowCommand, manager: SimulationManager = Depends(get_session)
+):
     """Update inlet flow rate."""
     try:
-        if simulation_manager is None or not simulation_manager.initialized:
+        if not manager.initialized:
             return JSONResponse(
                 status_code=500, content={"error": "Simulation not initialized"}
             )
 
-        simulation_manager.set_inlet_flow(command.value)
+        manager.set_inlet_flow(command.value)
         logger.info(f"Inlet flow changed to {command.value}")
         return {"message": "Inlet flow updated", "value": command.value}
     except Exception as e:
@@ -223,18 +325,21 @@ async def set_inlet_flow(command: InletFlowCommand):
         return JSONResponse(status_code=500, content={"error": str(e)})
 
 
-@app.post("/api/inlet_mode")
-async def set_inlet_mode(command: InletModeCommand):
+@router.post("/inlet_mode")
+async def set_inlet_mode(
+    command: InletModeCommand, manager: SimulationManager = Depends(get_session)
+):
     """Switch inlet between constant and Brownian modes."""
     try:
-        if simulation_manager is None or not simulation_manager.initialized:
+        if not manager.initialized:
             return JSONResponse(
                 status_code=500, content={"error": "Simulation not initialized"}
             )
 
-        simulation_manager.set_inlet_mode(
-            command.mode, command.min, command.max, command.variance
-        )
+        async with manager.step_lock:
+            manager.set_inlet_mode(
+                command.mode, command.min, command.max, command.variance
+            )
         logger.info(f"Inlet mode changed to {command.mode}")
         return {
             "message": "Inlet mode updated",
@@ -248,30 +353,153 @@ async def set_inlet_mode(command: InletModeCommand):
         return JSONResponse(status_code=500, content={"error": str(e)})
 
 
-@app.get("/api/history")
-async def get_history(duration: int = Query(3600, ge=1, le=7200)):
-    """Get historical data points."""
+@router.post("/speed")
+async def set_speed(
+    command: SimulationRateCommand, manager: SimulationManager = Depends(get_session)
+):
+    """Change simulation speed and, optionally, the broadcast interval."""
+    try:
+        if not manager.initialized:
+            return JSONResponse(
+                status_code=500, content={"error": "Simulation not initialized"}
+            )
+
+        async with manager.step_lock:
+            manager.set_speed(command.speed_factor)
+            if command.publish_interval is not None:
+                manager.set_publish_interval(command.publish_interval)
+        logger.info(f"Simulation speed changed to {command.speed_factor}x")
+        return {
+            "message": "Simulation rate updated",
+            "speed_factor": manager.speed_factor,
+            "publish_interval": manager.publish_interval,
+        }
+    except Exception as e:
+        logger.error(f"Error setting simulation speed: {e}")
+        return JSONResponse(status_code=500, content={"error": str(e)})
+
+
+@router.get("/history")
+async def get_history(
+    duration: int = Query(3600, ge=1),
+    format: str = Query(FORMAT_JSON, pattern=f"^({FORMAT_JSON}|{FORMAT_BINARY})$"),
+    manager: SimulationManager = Depends(get_session),
+):
+    """
+    Get historical data points.
+
+    duration is in simulated seconds and may not exceed what the history
+    buffer holds (HISTORY_CAPACITY * dt). format=binary returns a columnar
+    application/octet-stream frame (see api/telemetry.py) instead of JSON.
+    """
     try:
-        if simulation_manager is None or not simulation_manager.initialized:
+        if not manager.initialized:
             return JSONResponse(
                 status_code=500, content={"error": "Simulation not initialized"}
             )
 
-        history = simulation_manager.get_history(duration)
+        if duration > manager.max_history_duration:
+            return JSONResponse(
+                status_code=422,
+                content={
+                    "detail": f"duration must be at most "
+                    f"{manager.max_history_duration:g} seconds"
+                },
+            )
+
+        if format == FORMAT_BINARY:
+            # The columns are views into the ring buffer; encode before
+            # releasing the lock lets the pool step again
+            async with manager.step_lock:
+                content = encode_history(manager.get_history_columns(duration))
+            return Response(content=content, media_type="application/octet-stream")
+
+        async with manager.step_lock:
+            history = manager.get_history(duration)
         return history
     except Exception as e:
         logger.error(f"Error getting history: {e}")
         return JSONResponse(status_code=500, content={"error": str(e)})
 
 
+@router.get("/history/trend")
+async def get_history_trend(
+    duration: int = Query(3600, ge=1),
+    points: int = Query(500, ge=10, le=5000),
+    manager: SimulationManager = Depends(get_session),
+):
+    """
+    Get a downsampled min/max/mean trend of the most recent duration seconds.
+
+    The response holds at most points buckets whatever the duration (up to
+    the coarsest pyramid level's span), and is served from precomputed
+    buckets rather than a rescan of raw samples.
+    """
+    try:
+        if not manager.initialized:
+            return JSONResponse(
+                status_code=500, content={"error": "Simulation not initialized"}
+            )
+
+        if duration > manager.max_trend_duration:
+            return JSONResponse(
+                status_code=422,
+                content={
+                    "detail": f"duration must be at most "
+                    f"{manager.max_trend_duration:g} seconds"
+                },
+            )
+
+        async with manager.step_lock:
+            return manager.get_trend(duration, points)
+    except Exception as e:
+        logger.error(f"Error getting history trend: {e}")
+        return JSONResponse(status_code=500, content={"error": str(e)})
+
+
+@router.post("/forecast")
+async def forecast(
+    command: ForecastCommand, manager: SimulationManager = Depends(get_session)
+):
+    """
+    Predict the tank level for candidate setpoint and inlet flow moves.
+
+    Every candidate is forked from the current state and simulated over the
+    horizon in one vectorized C++ batch; the response holds each
+    candidate's predicted level and the envelope across candidates.
+    """
+    try:
+        if not manager.initialized:
+            return JSONResponse(
+                status_code=500, content={"error": "Simulation not initialized"}
+            )
+
+        async with manager.step_lock:
+            return manager.forecast(
+                command.horizon, command.points, command.setpoints, command.inlet_flows
+            )
+    except ValueError as e:
+        return JSONResponse(status_code=422, content={"detail": str(e)})
+    except Exception as e:
+        logger.error(f"Error computing forecast: {e}")
+        return JSONResponse(status_code=500, content={"error": str(e)})
+
+
 # WebSocket endpoint
 @app.websocket("/ws")
-async def websocket_endpoint(websocket: WebSocket):
+@app.websocket("/ws/{session_id}")
+async def websocket_endpoint(
+    websocket: WebSocket, session_id: str = SessionRegistry.DEFAULT_SESSION
+):
     """
     WebSocket endpoint for real-time state broadcasting and command handling.
 
+    /ws serves the default session and /ws/{session_id} any other; commands
+    apply to that session only. Connect with ?format=binary to receive state updates as fixed-layout
+    binary frames instead of JSON (see api/telemetry.py for the layout).
+
     Sends:
-    - State updates: {"type": "state", "data": {...}}
+    - State updates: {"type": "state", "data": {...}}, or a binary state frame
     - Error messages: {"type": "error", "message": "..."}
 
     Receives:
@@ -279,19 +507,31 @@ async def websocket_endpoint(websocket: WebSocket):
     - {"type": "pid", "Kc": <float>, "tau_I": <float>, "tau_D": <float>}
     - {"type": "inlet_flow", "value": <float>}
     - {"type": "inlet_mode", "mode": <str>, "min": <float>, "max": <float>, "variance": <float>}
+    - {"type": "speed", "speed_factor": <float>, "publish_interval": <float, optional>}
+    - {"type": "format", "format": "json" | "binary"}
     """
     await websocket.accept()
     logger.info("Client connected to WebSocket")
 
+    manager = sessions.get(session_id) if sessions is not None else None
     try:
-        if simulation_manager is None or not simulation_manager.initialized:
-            await websocket.send_json(
-                {"type": "error", "message": "Simulation not initialized"}
+        if manager is None or not manager.initialized:
+            message = (
+                "Simulation not initialized"
+                if sessions is None
+                else f"Unknown session '{session_id}'"
             )
+            await websocket.send_json({"type": "error", "message": message})
             await websocket.close()
             return
 
-        simulation_manager.add_connection(websocket)
+        fmt = websocket.query_params.get("format", FORMAT_JSON)
+        if fmt not in FORMATS:
+            await websocket.send_json(
+                {"type": "error", "message": f"Unknown format '{fmt}', using json"}
+            )
+            fmt = FORMAT_JSON
+        manager.add_connection(websocket, fmt)
 
         while True:
             # Receive JSON messages from client
@@ -318,7 +558,7 @@ async def websocket_endpoint(websocket: WebSocket):
                             {"type": "error", "message": "Missing 'value' field"}
                         )
                     else:
-                        simulation_manager.set_setpoint(float(value))
+                        manager.set_setpoint(float(value))
                         logger.info(f"Setpoint command: {value}")
 
                 elif msg_type == "pid":
@@ -337,7 +577,7 @@ async def websocket_endpoint(websocket: WebSocket):
                         gains.Kc = float(kc)
                         gains.tau_I = float(tau_i)
                         gains.tau_D = float(tau_d)
-                        simulation_manager.set_pid_gains(gains)
+                        manager.set_pid_gains(gains)
                         logger.info(
                             f"PID command: Kc={kc}, tau_I={tau_i}, tau_D={tau_d}"
                         )
@@ -349,7 +589,7 @@ async def websocket_endpoint(websocket: WebSocket):
                             {"type": "error", "message": "Missing 'value' field"}
                         )
                     else:
-                        simulation_manager.set_inlet_flow(float(value))
+                        manager.set_inlet_flow(float(value))
                         logger.info(f"Inlet flow command: {value}")
 
                 elif msg_type == "inlet_mode":
@@ -365,11 +605,36 @@ async def websocket_endpoint(websocket: WebSocket):
                             }
                         )
                     else:
-                        simulation_manager.set_inlet_mode(
-                            str(mode), float(min_val), float(max_val), float(variance)
-                        )
+                        async with manager.step_lock:
+                            manager.set_inlet_mode(
+                                str(mode), float(min_val), float(max_val), float(variance)
+                            )
                         logger.info(f"Inlet mode command: {mode}")
 
+                elif msg_type == "speed":
+                    speed = message.get("speed_factor")
+                    interval = message.get("publish_interval")
+                    if speed is None:
+                        await websocket.send_json(
+                            {"type": "error", "message": "Missing 'speed_factor' field"}
+                        )
+                    else:
+                        async with manager.step_lock:
+                            manager.set_speed(float(speed))
+                            if interval is not None:
+                                manager.set_publish_interval(float(interval))
+                        logger.info(f"Speed command: {speed}x")
+
+                elif msg_type == "format":
+                    fmt = message.get("format")
+                    if fmt is None:
+                        await websocket.send_json(
+                            {"type": "error", "message": "Missing 'format' field"}
+                        )
+                    else:
+                        manager.set_connection_format(websocket, str(fmt))
+                        logger.info(f"Format command: {fmt}")
+
                 else:
                     await websocket.send_json(
                         {
@@ -391,9 +656,14 @@ async def websocket_endpoint(websocket: WebSocket):
 
     except WebSocketDisconnect:
         logger.info("Client disconnected from WebSocket")
-        if simulation_manager is not None:
-            simulation_manager.remove_connection(websocket)
+        if manager is not None:
+            manager.remove_connection(websocket)
     except Exception as e:
         logger.error(f"WebSocket error: {e}")
-        if simulation_manager is not None:
-            simulation_manager.remove_connection(websocket)
+        if manager is not None:
+            manager.remove_connection(websocket)
+
+
+# Per-session routes: the default session at /api, any session under /api/sessions
+app.include_router(router, prefix="/api")
+app.include_router(router, prefix="/api/sessions/{session_id}")
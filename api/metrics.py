@@ -0,0 +1,161 @@
+"""
+Prometheus text exposition for GET /metrics.
+
+Two sources are exported:
+- the C++ simulator's hot-path counters (Simulator.get_metrics()): steps,
+  derivative/Jacobian evaluations, per-phase time and a step latency
+  histogram with log2 buckets
+- wall time the scheduler loop spends in each of its own phases (advancing
+  physics, reading state, broadcasting), recorded here in Python
+
+With several sessions the simulator counters are summed over sessions
+(merge_simulator_metrics()).
+
+Format reference: https://prometheus.io/docs/instrumenting/exposition_formats/
+"""
+
+import math
+import time
+from typing import Any
+
+CONTENT_TYPE = "text/plain; version=0.0.4; charset=utf-8"
+
+# Scheduler loop phases, in the order simulation_loop() runs them
+LOOP_PHASES = ("advance", "get_state", "broadcast")
+
+
+class LoopTimings:
+    """Accumulated wall time and call count per scheduler loop phase."""
+
+    def __init__(self):
+        self.seconds: dict[str, float] = {phase: 0.0 for phase in LOOP_PHASES}
+        self.count: dict[str, int] = {phase: 0 for phase in LOOP_PHASES}
+
+    def record(self, phase: str, seconds: float):
+        self.seconds[phase] += seconds
+        self.count[phase] += 1
+
+    def time(self, phase: str) -> "_PhaseTimer":
+        """Context manager that records the time spent in its body."""
+        return _PhaseTimer(self, phase)
+
+
+class _PhaseTimer:
+    def __init__(self, timings: LoopTimings, phase: str):
+        self.timings = timings
+        self.phase = phase
+        self.start = 0.0
+
+    def __enter__(self):
+        self.start = time.perf_counter()
+        return self
+
+    def __exit__(self, *exc):
+        self.timings.record(self.phase, time.perf_counter() - self.start)
+        return False
+
+
+def _value(v: float) -> str:
+    if math.isinf(v):
+        return "+Inf" if v > 0 else "-Inf"
+    return repr(float(v)) if isinstance(v, float) else str(v)
+
+
+def _metric(lines: list[str], name: str, kind: str, help_text: str, samples):
+    """Append one metric family; samples is a list of (labels, value)."""
+    lines.append(f"# HELP {name} {help_text}")
+    lines.append(f"# TYPE {name} {kind}")
+    for labels, value in samples:
+        label_text = ",".join(f'{k}="{v}"' for k, v in labels.items())
+        suffix = f"{{{label_text}}}" if label_text else ""
+        lines.append(f"{name}{suffix} {_value(value)}")
+
+
+def merge_simulator_metrics(metrics: list[dict[str, Any]]) -> dict[str, Any] | None:
+    """Sum Simulator.get_metrics() dicts from several sessions (None if empty)."""
+    if not metrics:
+        return None
+    merged = {
+        "enabled": any(m["enabled"] for m in metrics),
+        "steps": sum(m["steps"] for m in metrics),
+        "derivative_evaluations": sum(m["derivative_evaluations"] for m in metrics),
+        "jacobian_evaluations": sum(m["jacobian_evaluations"] for m in metrics),
+        "step_seconds": sum(m["step_seconds"] for m in metrics),
+        "phase_seconds": {},
+        "latency_upper_bounds": max(
+            (m["latency_upper_bounds"] for m in metrics), key=len
+        ),
+        "latency_counts": [],
+    }
+    for m in metrics:
+        for phase, seconds in m["phase_seconds"].items():
+            merged["phase_seconds"][phase] = merged["phase_seconds"].get(phase, 0.0) + seconds
+    counts = [0] * len(merged["latency_upper_bounds"])
+    for m in metrics:
+        for i, count in enumerate(m["latency_counts"]):
+            counts[i] += count
+    merged["latency_counts"] = counts
+    return merged
+
+
+def format_prometheus(
+    simulator_metrics: dict[str, Any] | None,
+    loop_timings: LoopTimings,
+    connections: int = 0,
+    sessions: int | None = None,
+    pool_threads: int | None = None,
+) -> str:
+    """Render simulator and scheduler metrics in Prometheus text format."""
+    lines: list[str] = []
+
+    if simulator_metrics is not None:
+        m = simulator_metrics
+        _metric(lines, "tank_sim_metrics_enabled", "gauge",
+                "1 if the simulator core was built with instrumentation",
+                [({}, 1 if m["enabled"] else 0)])
+        _metric(lines, "tank_sim_steps_total", "counter",
+                "Control periods stepped by the simulator",
+                [({}, m["steps"])])
+        _metric(lines, "tank_sim_derivative_evaluations_total", "counter",
+                "Plant derivative evaluations",
+                [({}, m["derivative_evaluations"])])
+        _metric(lines, "tank_sim_jacobian_evaluations_total", "counter",
+                "Plant Jacobian evaluations (Rosenbrock integrator)",
+                [({}, m["jacobian_evaluations"])])
+        _metric(lines, "tank_sim_step_phase_seconds_total", "counter",
+                "Time spent in each phase of Simulator.step()",
+                [({"phase": phase}, seconds)
+                 for phase, seconds in m["phase_seconds"].items()])
+
+        # Histogram: Prometheus buckets are cumulative and end with +Inf
+        name = "tank_sim_step_latency_seconds"
+        lines.append(f"# HELP {name} Wall time of one Simulator.step()")
+        lines.append(f"# TYPE {name} histogram")
+        cumulative = 0
+        for bound, count in zip(m["latency_upper_bounds"], m["latency_counts"]):
+            cumulative += count
+            if not math.isinf(bound):
+                lines.append(f'{name}_bucket{{le="{bound:.3e}"}} {cumulative}')
+        lines.append(f'{name}_bucket{{le="+Inf"}} {cumulative}')
+        lines.append(f"{name}_sum {_value(m['step_seconds'])}")
+        lines.append(f"{name}_count {cumulative}")
+
+    _metric(lines, "tank_sim_loop_phase_seconds_total", "counter",
+            "Wall time the scheduler loop spent in each phase",
+            [({"phase": p}, loop_timings.seconds[p]) for p in LOOP_PHASES])
+    _metric(lines, "tank_sim_loop_phase_calls_total", "counter",
+            "Scheduler loop iterations that ran each phase",
+            [({"phase": p}, loop_timings.count[p]) for p in LOOP_PHASES])
+    _metric(lines, "tank_sim_websocket_connections", "gauge",
+            "Open WebSocket connections",
+            [({}, connections)])
+    if sessions is not None:
+        _metric(lines, "tank_sim_sessions", "gauge",
+                "Simulation sessions",
+                [({}, sessions)])
+    if pool_threads is not None:
+        _metric(lines, "tank_sim_session_pool_threads", "gauge",
+                "Worker threads stepping sessions",
+                [({}, pool_threads)])
+
+    return "\n".join(lines) + "\n"
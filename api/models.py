@@ -100,6 +100,48 @@ class InletModeCommand(BaseModel):
         return v
 
 
+class SimulationRateCommand(BaseModel):
+    """
+    Model for simulation speed and publish rate commands.
+    """
+
+    speed_factor: float = Field(
+        1.0,
+        gt=0.0,
+        le=1000.0,
+        description="Simulation speed as a multiple of real time, default 1.0",
+    )
+    publish_interval: float | None = Field(
+        None,
+        ge=0.05,
+        le=60.0,
+        description="Wall-clock seconds between state broadcasts (unchanged if omitted)",
+    )
+
+
+class ForecastCommand(BaseModel):
+    """
+    Model for predictive look-ahead requests.
+
+    Each schedule is one value per candidate (a step change held for the
+    whole horizon) or one list of equal-length segment values per
+    candidate. null entries hold the previous value.
+    """
+
+    horizon: float = Field(
+        600.0, gt=0.0, le=86400.0, description="Simulated seconds to predict"
+    )
+    points: int = Field(
+        60, ge=1, le=5000, description="Maximum samples returned per candidate"
+    )
+    setpoints: list[float | None] | list[list[float | None]] | None = Field(
+        None, description="Setpoint schedule per candidate"
+    )
+    inlet_flows: list[float | None] | list[list[float | None]] | None = Field(
+        None, description="Inlet flow schedule per candidate"
+    )
+
+
 class ConfigResponse(BaseModel):
     """
     Model for configuration response.
@@ -120,6 +162,15 @@ class ConfigResponse(BaseModel):
     history_size: int = Field(
         ..., ge=0, description="Current number of history entries stored"
     )
+    max_trend_duration: float = Field(
+        0.0, ge=0.0, description="Longest duration accepted by /api/history/trend (s)"
+    )
+    speed_factor: float = Field(
+        1.0, gt=0.0, description="Simulation speed as a multiple of real time"
+    )
+    publish_interval: float = Field(
+        1.0, gt=0.0, description="Wall-clock seconds between state broadcasts"
+    )
 
 
 class HistoryQueryParams(BaseModel):
@@ -135,6 +186,20 @@ class HistoryQueryParams(BaseModel):
     )
 
 
+class SessionCreateCommand(BaseModel):
+    """
+    Model for session creation requests.
+    """
+
+    session_id: str | None = Field(
+        None,
+        min_length=1,
+        max_length=64,
+        pattern=r"^[A-Za-z0-9_-]+$",
+        description="Id for the new session; a random one if omitted",
+    )
+
+
 # Example usage
 try:
     state = SimulationState(
@@ -0,0 +1,237 @@
+import asyncio
+import logging
+import os
+import time
+import uuid
+from typing import Any
+
+import tank_sim
+
+from .metrics import LoopTimings, format_prometheus, merge_simulator_metrics
+from .simulation import SimulationManager
+
+logger = logging.getLogger(__name__)
+
+
+class SessionLimitError(RuntimeError):
+    """Raised when creating a session would exceed MAX_SESSIONS."""
+
+
+class SessionRegistry:
+    """
+    Independent simulation sessions, all stepped by one C++ worker pool.
+
+    Every session is a SimulationManager with its own simulator, scheduler
+    clock, inlet mode and WebSocket connections. Their simulators are added
+    to a tank_sim.SessionPool, which pins each to one of a fixed set of
+    worker threads. One asyncio loop serves every session: each wake-up it
+    collects the steps due for the sessions whose publish time has come,
+    runs them all in a single SessionPool.advance() call (in C++, sharded
+    across the workers, GIL released) from a worker thread, then reads and
+    broadcasts their states. The event loop is never blocked by stepping,
+    so it keeps accepting connections and serving requests meanwhile.
+
+    Setpoint, gain and inlet flow commands go through each simulator's
+    command queue (Simulator.post_commands()), which is drained at step
+    boundaries, so they may be posted while the pool steps. Anything else
+    that touches a simulator directly (reset, inlet mode, speed changes,
+    state and history reads) must hold step_lock, which the loop holds
+    while the pool runs.
+
+    The "default" session always exists and backs the unscoped /api routes.
+    """
+
+    DEFAULT_SESSION = "default"
+
+    # Upper bound on concurrent sessions. Each holds its own simulator and
+    # history (a few MB with the default history pyramid).
+    MAX_SESSIONS = int(os.environ.get("TANK_SIM_MAX_SESSIONS", "512"))
+
+    # Worker threads stepping sessions; 0 uses every core
+    POOL_THREADS = int(os.environ.get("TANK_SIM_POOL_THREADS", "0"))
+
+    # Longest the loop sleeps, so sessions created or retimed mid-sleep are
+    # picked up promptly
+    MAX_IDLE_SLEEP = 0.25  # seconds of wall time
+
+    def __init__(self, config_factory=tank_sim.create_default_config, threads: int | None = None):
+        self.config_factory = config_factory
+        self.pool = tank_sim.SessionPool(self.POOL_THREADS if threads is None else threads)
+        self.sessions: dict[str, SimulationManager] = {}
+        self.pool_ids: dict[str, int] = {}
+
+        # Wall time per loop phase, summed over sessions; exported by GET /metrics
+        self.loop_timings: LoopTimings = LoopTimings()
+
+        # Held while the pool steps; shared with every session's manager
+        self.step_lock: asyncio.Lock = asyncio.Lock()
+
+    def create(self, session_id: str | None = None) -> SimulationManager:
+        """Create, initialize and register a session (a random id if None)."""
+        if session_id is None:
+            session_id = uuid.uuid4().hex
+        if session_id in self.sessions:
+            raise ValueError(f"Session '{session_id}' already exists")
+        if len(self.sessions) >= self.MAX_SESSIONS:
+            raise SessionLimitError(f"Session limit of {self.MAX_SESSIONS} reached")
+
+        manager = SimulationManager(self.config_factory(), session_id)
+        manager.loop_timings = self.loop_timings
+        manager.step_lock = self.step_lock
+        manager.initialize()
+        self.pool_ids[session_id] = self.pool.add(manager.simulator)
+        self.sessions[session_id] = manager
+        logger.info(f"Session {session_id} created. Total sessions: {len(self.sessions)}")
+        return manager
+
+    def get(self, session_id: str) -> SimulationManager | None:
+        return self.sessions.get(session_id)
+
+    async def remove(self, session_id: str):
+        """Close a session's connections and drop it from the pool."""
+        if session_id == self.DEFAULT_SESSION:
+            raise ValueError("The default session cannot be removed")
+        manager = self.sessions.pop(session_id)
+        async with self.step_lock:
+            self.pool.remove(self.pool_ids.pop(session_id))
+        for connection in list(manager.connections):
+            try:
+                await connection.close()
+            except Exception as e:
+                logger.warning(f"Error closing connection of session {session_id}: {e}")
+        logger.info(f"Session {session_id} removed. Total sessions: {len(self.sessions)}")
+
+    def __len__(self) -> int:
+        return len(self.sessions)
+
+    def __contains__(self, session_id: str) -> bool:
+        return session_id in self.sessions
+
+    def describe(self, manager: SimulationManager) -> dict[str, Any]:
+        """Summary of one session for GET /api/sessions."""
+        return {
+            "session_id": manager.session_id,
+            "time": manager.simulator.get_time() if manager.simulator is not None else 0.0,
+            "connections": len(manager.connections),
+            "speed_factor": manager.speed_factor,
+            "publish_interval": manager.publish_interval,
+            "shard": self.pool.shard(self.pool_ids[manager.session_id]),
+        }
+
+    def advance(self, managers: list[SimulationManager], now: float) -> int:
+        """
+        Bring every given session up to its scaled wall clock at `now`.
+
+        All sessions run in one SessionPool.advance() call. A session whose
+        step fails is logged and skipped; the others are unaffected. This
+        blocks until the batch is done; simulation_loop() calls it from a
+        worker thread with step_lock held.
+
+        Returns:
+            Total steps run
+        """
+        work = []
+        session_ids = {}
+        for manager in managers:
+            steps = manager.plan_steps(now)
+            if steps > 0:
+                pool_id = self.pool_ids[manager.session_id]
+                work.append((pool_id, steps))
+                session_ids[pool_id] = manager.session_id
+        if not work:
+            return 0
+
+        failures = self.pool.advance(work)
+        for pool_id, message in failures:
+            logger.error(f"Error stepping session {session_ids[pool_id]}: {message}")
+        return sum(steps for _, steps in work)
+
+    def get_metrics_text(self) -> str:
+        """Prometheus exposition: simulator counters summed over sessions, plus loop timings."""
+        metrics = [
+            m.simulator.get_metrics()
+            for m in self.sessions.values()
+            if m.simulator is not None and m.initialized
+        ]
+        return format_prometheus(
+            merge_simulator_metrics(metrics),
+            self.loop_timings,
+            sum(len(m.connections) for m in self.sessions.values()),
+            sessions=len(self.sessions),
+            pool_threads=self.pool.thread_count,
+        )
+
+    async def simulation_loop(self):
+        """
+        Scheduler loop for every session.
+
+        Each session keeps its own speed factor and publish interval. The
+        loop sleeps until the earliest publish deadline (at most
+        MAX_IDLE_SLEEP), then, for the sessions that are due:
+        - Runs all their due physics steps in one C++ batch, in a worker
+          thread so the event loop stays free for I/O
+        - Reads each session's current state
+        - Broadcasts every state concurrently
+
+        Deadlines are absolute per session, so time spent stepping and
+        broadcasting does not accumulate as drift. A session that overruns
+        by more than a whole interval skips the missed publishes, but its
+        physics still catches up on the next one.
+        """
+        logger.info("Simulation loop started")
+        try:
+            now = time.monotonic()
+            for manager in self.sessions.values():
+                manager._rebase_clock(now)
+                manager.next_publish = now + manager.publish_interval
+
+            while True:
+                wake = min(
+                    (m.next_publish for m in self.sessions.values()),
+                    default=float("inf"),
+                )
+                delay = min(wake - time.monotonic(), self.MAX_IDLE_SLEEP)
+                await asyncio.sleep(max(0.0, delay))
+                now = time.monotonic()
+
+                due = [
+                    m for m in self.sessions.values() if m.initialized and m.next_publish <= now
+                ]
+                if not due:
+                    continue
+
+                try:
+                    async with self.step_lock:
+                        # Advance physics of every due session to its scaled
+                        # wall clock, off the event loop
+                        with self.loop_timings.time("advance"):
+                            await asyncio.to_thread(self.advance, due, now)
+
+                        # Get current states
+                        with self.loop_timings.time("get_state"):
+                            messages = [{"type": "state", "data": m.get_state()} for m in due]
+
+                    # Broadcast to each session's clients, all sessions at once
+                    with self.loop_timings.time("broadcast"):
+                        await asyncio.gather(
+                            *(m.broadcast(message) for m, message in zip(due, messages))
+                        )
+                    for manager in due:
+                        manager.publish_sequence += 1
+
+                except Exception as e:
+                    logger.error(f"Error in simulation loop iteration: {e}")
+                    # Continue loop without crashing
+
+                after = time.monotonic()
+                for manager in due:
+                    manager.next_publish += manager.publish_interval
+                    if manager.next_publish < after:
+                        manager.next_publish = after + manager.publish_interval
+
+        except asyncio.CancelledError:
+            logger.info("Simulation loop cancelled")
+            raise
+        except Exception as e:
+            logger.error(f"Fatal error in simulation loop: {e}")
+            raise
@@ -1,34 +1,71 @@
 import asyncio
 import logging
-from collections import deque
+import math
+import os
+import time
 from typing import Any
 
 import numpy as np
 
 import tank_sim
 
+from .metrics import LoopTimings, format_prometheus
+from .telemetry import FORMAT_BINARY, FORMAT_JSON, FORMATS, encode_json, encode_state
+
 logger = logging.getLogger(__name__)
 
 
 class SimulationManager:
     """
-    Singleton manager for the tank simulator.
-    Manages simulation state and provides interface for API to interact with the simulator.
-    """
+    Manager for one simulation session.
 
-    _instance: "SimulationManager | None" = None
-
-    def __new__(cls, config: tank_sim.SimulatorConfig):
-        if cls._instance is None:
-            cls._instance = super(SimulationManager, cls).__new__(cls)
-        return cls._instance
+    Owns the session's tank_sim.Simulator, inlet mode, scheduler clock and
+    WebSocket connections, and provides the interface the API uses to drive
+    it. Sessions are independent; api.sessions.SessionRegistry keeps many of
+    them and steps them all through one C++ SessionPool.
+    """
 
-    def __init__(self, config: tank_sim.SimulatorConfig):
+    # Scheduler limits
+    MAX_SPEED_FACTOR = 1000.0
+    MIN_PUBLISH_INTERVAL = 0.05  # seconds of wall time
+    MAX_PUBLISH_INTERVAL = 60.0
+    MAX_CATCHUP_STEPS = 100_000  # per publish tick; beyond this the backlog is dropped
+
+    # POST /forecast limit; 256 candidates over 10 minutes take a few ms
+    MAX_FORECAST_CANDIDATES = 1024
+
+    # Per-step history kept by the C++ simulator; 7200 samples = 2 hours at dt = 1 s
+    HISTORY_CAPACITY = int(os.environ.get("TANK_SIM_HISTORY_CAPACITY", "7200"))
+
+    # Min/max/mean pyramid for long trends, as (steps per bucket, buckets kept):
+    # 10 s buckets for a day, 1 min for a week, 10 min for 30 days at dt = 1 s
+    HISTORY_LEVELS = [(10, 8640), (60, 10080), (600, 4320)]
+
+    # Operator commands pending between steps; the C++ queue is lock-free, so
+    # handlers never wait on a SessionPool step of this simulator
+    COMMAND_QUEUE_CAPACITY = 1024
+
+    # Input driven by the Brownian inlet mode (tank_sim input 0)
+    INLET_FLOW_INDEX = 0
+
+    # Signals summarized by get_trend(), i.e. every state key except time
+    TREND_FIELDS = (
+        "tank_level",
+        "setpoint",
+        "error",
+        "inlet_flow",
+        "outlet_flow",
+        "valve_position",
+        "controller_output",
+    )
+
+    def __init__(self, config: tank_sim.SimulatorConfig, session_id: str = "default"):
+        self.session_id: str = session_id
         self.config: tank_sim.SimulatorConfig = config
         self.initialized: bool = False
         self.simulator: tank_sim.Simulator | None = None
-        self.connections: set = set()
-        self.history: deque = deque(maxlen=7200)  # 2 hours at 1 Hz
+        self.connections: dict[Any, str] = {}  # websocket -> wire format
+        self.publish_sequence: int = 0
         self.inlet_mode: str = "constant"
         self.inlet_mode_params: dict[str, float] = {
             "min": 0.8,
@@ -36,9 +73,35 @@ class SimulationManager:
             "variance": 0.05,
         }
 
+        # Scheduler: simulation time follows a monotonic wall clock scaled by
+        # speed_factor; state is published every publish_interval wall seconds
+        self.speed_factor: float = 1.0
+        self.publish_interval: float = 1.0
+        self._wall_anchor: float = time.monotonic()
+        self._sim_anchor: float = 0.0
+        self.next_publish: float = self._wall_anchor + self.publish_interval
+
+        # Wall time per scheduler loop phase, exported by GET /metrics
+        self.loop_timings: LoopTimings = LoopTimings()
+
+        # Held while the simulator is stepped off the event loop; callers
+        # touching it directly, other than through post_commands(), take it
+        # too. A SessionRegistry replaces it with its shared lock.
+        self.step_lock: asyncio.Lock = asyncio.Lock()
+
+        # Forecaster for the last requested (horizon_steps, sample_interval);
+        # it keeps its batch between calls
+        self._forecaster: tank_sim.Forecaster | None = None
+        self._forecast_shape: tuple[int, int] | None = None
+
     def initialize(self):
         """Initialize the simulator with the configuration."""
         try:
+            # The simulator records every step into a C++ ring buffer, so
+            # history needs no Python-side bookkeeping
+            self.config.history_capacity = self.HISTORY_CAPACITY
+            self.config.history_levels = self.HISTORY_LEVELS
+            self.config.command_queue_capacity = self.COMMAND_QUEUE_CAPACITY
             self.simulator = tank_sim.Simulator(self.config)
             self.initialized = True
             logger.info("SimulationManager initialized successfully")
@@ -62,31 +125,9 @@ class SimulationManager:
             }
 
         try:
-            state = self.simulator.get_state()
-            tank_level = state[0]
-            setpoint = self.simulator.get_setpoint(0)  # 0 is controller index
-            inlet_flow = self.simulator.get_inputs()[0]
-            valve_position = self.simulator.get_inputs()[1]
-            error = self.simulator.get_error(0)  # 0 is controller index
-            controller_output = self.simulator.get_controller_output(0)
-            time = self.simulator.get_time()
-
-            # Calculate outlet flow using valve equation: q_out = k_v * valve_position * sqrt(tank_level)
-            k_v = self.config.model_params.k_v
-            outlet_flow = (
-                k_v * valve_position * (tank_level**0.5) if tank_level > 0 else 0.0
-            )
-
-            return {
-                "time": float(time),
-                "tank_level": float(tank_level),
-                "setpoint": float(setpoint),
-                "inlet_flow": float(inlet_flow),
-                "outlet_flow": float(outlet_flow),
-                "valve_position": float(valve_position),
-                "error": float(error),
-                "controller_output": float(controller_output),
-            }
+            # One crossing into C++ for the whole operating point
+            snapshot = self.simulator.snapshot(0)  # 0 is controller index
+            return {key: float(value) for key, value in snapshot.items()}
         except Exception as e:
             logger.error(f"Error getting state: {e}")
             return {
@@ -107,16 +148,117 @@ class SimulationManager:
             return
 
         try:
-            # Apply Brownian inlet flow if enabled
-            if self.inlet_mode == "brownian":
-                current_inlet_flow = self.simulator.get_inputs()[0]
-                new_inlet_flow = self.apply_brownian_inlet(current_inlet_flow)
-                self.simulator.set_input(0, new_inlet_flow)
-
+            # Brownian inlet flow, if enabled, is applied inside the C++ step
             self.simulator.step()
         except Exception as e:
             logger.error(f"Error during simulation step: {e}")
 
+    def advance(self, n_steps: int) -> int:
+        """
+        Advance the simulation by n_steps physics steps.
+
+        Uses the bulk C++ run() path (one call, GIL released); Brownian inlet
+        disturbances are generated inside the C++ step loop.
+
+        Returns:
+            Number of steps taken
+        """
+        if n_steps <= 0:
+            return 0
+        if self.simulator is None or not self.initialized:
+            logger.warning("advance called but simulator not initialized")
+            return 0
+
+        try:
+            self.simulator.run(n_steps)
+        except Exception as e:
+            logger.error(f"Error during bulk simulation run: {e}")
+            return 0
+        return n_steps
+
+    def _rebase_clock(self, now: float | None = None, sim_time: float | None = None):
+        """Anchor the scheduler clock at sim_time (default: the current simulation time)."""
+        self._wall_anchor = time.monotonic() if now is None else now
+        if sim_time is None:
+            sim_time = (
+                self.simulator.get_time()
+                if self.simulator is not None and self.initialized
+                else 0.0
+            )
+        self._sim_anchor = sim_time
+
+    def steps_due(self, now: float) -> int:
+        """
+        Number of physics steps needed to bring simulation time up to the
+        scaled wall clock at monotonic time `now`.
+        """
+        if self.simulator is None or not self.initialized:
+            return 0
+        target = self._sim_anchor + (now - self._wall_anchor) * self.speed_factor
+        behind = (target - self.simulator.get_time()) / self.config.dt
+        # Tolerance absorbs round-off in accumulated simulation time
+        return max(0, math.floor(behind + 1e-9))
+
+    def plan_steps(self, now: float) -> int:
+        """
+        Number of physics steps to run at monotonic time `now`.
+
+        This is steps_due(now), capped at MAX_CATCHUP_STEPS. A larger backlog
+        is dropped (with a warning) and the clock is rebased at the end of
+        the capped run rather than letting the server fall further behind.
+        The caller must then run exactly the returned number of steps.
+        """
+        due = self.steps_due(now)
+        if due > self.MAX_CATCHUP_STEPS:
+            logger.warning(
+                f"Session {self.session_id} {due} steps behind; running "
+                f"{self.MAX_CATCHUP_STEPS} and dropping the rest"
+            )
+            self._rebase_clock(
+                now, self.simulator.get_time() + self.MAX_CATCHUP_STEPS * self.config.dt
+            )
+            return self.MAX_CATCHUP_STEPS
+        return due
+
+    def tick(self, now: float) -> int:
+        """
+        Run every physics step that is due at monotonic time `now`.
+
+        Catch-up after a stall happens here in one bulk call (see
+        plan_steps() for the backlog limit). The session registry instead
+        collects plan_steps() from every session and runs them in one
+        SessionPool.advance() batch.
+
+        Returns:
+            Number of steps taken
+        """
+        return self.advance(self.plan_steps(now))
+
+    def set_speed(self, speed_factor: float):
+        """Set simulation speed as a multiple of real time (e.g. 100.0)."""
+        if not 0.0 < speed_factor <= self.MAX_SPEED_FACTOR:
+            raise ValueError(
+                f"speed_factor must be in (0, {self.MAX_SPEED_FACTOR}], got {speed_factor}"
+            )
+        # Finish the steps due at the old speed, then rebase so the new speed
+        # applies from now without a jump
+        now = time.monotonic()
+        self.tick(now)
+        self._rebase_clock(now)
+        self.speed_factor = float(speed_factor)
+        logger.info(f"Simulation speed set to {speed_factor}x real time")
+
+    def set_publish_interval(self, interval: float):
+        """Set the wall-clock interval between state broadcasts (seconds)."""
+        if not self.MIN_PUBLISH_INTERVAL <= interval <= self.MAX_PUBLISH_INTERVAL:
+            raise ValueError(
+                f"publish_interval must be in [{self.MIN_PUBLISH_INTERVAL}, "
+                f"{self.MAX_PUBLISH_INTERVAL}], got {interval}"
+            )
+        self.publish_interval = float(interval)
+        self.next_publish = time.monotonic() + self.publish_interval
+        logger.info(f"Publish interval set to {interval} s")
+
     def reset(self):
         """Reset simulation to initial conditions and clear history buffer."""
         if self.simulator is None or not self.initialized:
@@ -124,8 +266,9 @@ class SimulationManager:
             return
 
         try:
-            self.simulator.reset()
-            self.history.clear()
+            self.simulator.reset()  # Also clears the history buffer
+            self.simulator.set_disturbances([])
+            self._rebase_clock()
             self.inlet_mode = "constant"
             self.inlet_mode_params = {
                 "min": 0.8,
@@ -136,66 +279,62 @@ class SimulationManager:
         except Exception as e:
             logger.error(f"Error resetting simulation: {e}")
 
-    def set_setpoint(self, value: float):
-        """Set the controller setpoint."""
+    def post_commands(self, commands: list["tank_sim.Command"]) -> int:
+        """Queue commands to apply, in order, at the start of the next step.
+
+        Returns the number queued; a full queue drops the rest (logged).
+        """
         if self.simulator is None or not self.initialized:
-            logger.warning("set_setpoint called but simulator not initialized")
-            return
+            logger.warning("post_commands called but simulator not initialized")
+            return 0
 
         try:
-            self.simulator.set_setpoint(0, value)  # 0 is controller index
-            logger.info(f"Setpoint set to {value}")
+            queued = self.simulator.post_commands(commands)
         except Exception as e:
-            logger.error(f"Error setting setpoint: {e}")
+            logger.error(f"Error posting commands: {e}")
+            return 0
+        if queued < len(commands):
+            logger.warning(
+                f"Command queue full: dropped {len(commands) - queued} of {len(commands)}"
+            )
+        return queued
 
-    def set_pid_gains(self, gains: tank_sim.PIDGains):
-        """Set PID controller gains."""
-        if self.simulator is None or not self.initialized:
-            logger.warning("set_pid_gains called but simulator not initialized")
-            return
+    def set_setpoint(self, value: float):
+        """Set the controller setpoint from the next step on."""
+        # 0 is controller index
+        if self.post_commands([tank_sim.Command.setpoint(0, value)]):
+            logger.info(f"Setpoint set to {value}")
 
-        try:
-            self.simulator.set_controller_gains(0, gains)  # 0 is controller index
+    def set_pid_gains(self, gains: tank_sim.PIDGains):
+        """Set PID controller gains from the next step on."""
+        # 0 is controller index
+        if self.post_commands([tank_sim.Command.retune(0, gains)]):
             logger.info(
                 f"PID gains set: Kc={gains.Kc}, tau_I={gains.tau_I}, tau_D={gains.tau_D}"
             )
-        except Exception as e:
-            logger.error(f"Error setting PID gains: {e}")
 
     def set_inlet_flow(self, value: float):
-        """Set inlet flow rate."""
-        if self.simulator is None or not self.initialized:
-            logger.warning("set_inlet_flow called but simulator not initialized")
-            return
-
-        try:
-            self.simulator.set_input(0, value)  # 0 is inlet flow input index
+        """Set inlet flow rate from the next step on."""
+        # 0 is inlet flow input index
+        if self.post_commands([tank_sim.Command.input(0, value)]):
             logger.info(f"Inlet flow set to {value}")
-        except Exception as e:
-            logger.error(f"Error setting inlet flow: {e}")
 
-    def apply_brownian_inlet(self, current_flow: float) -> float:
+    def brownian_inlet_disturbance(self) -> "tank_sim.Disturbance":
         """
-        Apply Brownian motion to inlet flow.
+        Native disturbance implementing the Brownian inlet mode.
 
-        Args:
-            current_flow: Current inlet flow value
-
-        Returns:
-            New inlet flow value after applying Brownian step
+        Each physics step adds a normal increment with standard deviation
+        inlet_mode_params["variance"] to the inlet flow, then clamps it to
+        [min, max]. The simulator scales its sigma by sqrt(dt), so sigma is
+        chosen to give exactly that per-step deviation.
         """
-        # Generate random increment from normal distribution
-        increment = np.random.normal(0.0, self.inlet_mode_params["variance"])
-
-        # Add increment to current flow
-        new_flow = current_flow + increment
-
-        # Clamp to bounds
-        min_flow = self.inlet_mode_params["min"]
-        max_flow = self.inlet_mode_params["max"]
-        new_flow = np.clip(new_flow, min_flow, max_flow)
-
-        return float(new_flow)
+        params = self.inlet_mode_params
+        return tank_sim.Disturbance.brownian(
+            self.INLET_FLOW_INDEX,
+            sigma=params["variance"] / math.sqrt(self.config.dt),
+            min_value=params["min"],
+            max_value=params["max"],
+        )
 
     def set_inlet_mode(
         self, mode: str, min_flow: float, max_flow: float, variance: float = 0.05
@@ -206,7 +345,7 @@ class SimulationManager:
             return
 
         try:
-            # Store mode parameters for Brownian implementation
+            # Parameters are kept for reporting; the disturbance runs in C++
             self.inlet_mode = mode
             self.inlet_mode_params = {
                 "min": min_flow,
@@ -214,98 +353,265 @@ class SimulationManager:
                 "variance": variance,
             }
             if mode == "brownian":
+                self.simulator.set_disturbances([self.brownian_inlet_disturbance()])
                 logger.info(
                     f"Brownian inlet mode enabled: min={min_flow}, max={max_flow}, variance={variance}"
                 )
             else:
+                self.simulator.set_disturbances([])
                 logger.info(f"Inlet mode set to {mode}")
         except Exception as e:
             logger.error(f"Error setting inlet mode: {e}")
 
+    @property
+    def max_history_duration(self) -> float:
+        """Simulated seconds the history buffer can hold."""
+        return self.HISTORY_CAPACITY * self.config.dt
+
+    def history_size(self) -> int:
+        """Number of samples currently held in the history buffer."""
+        if self.simulator is None or not self.initialized:
+            return 0
+        return len(self.simulator.history)
+
+    def get_history_columns(self, duration: float = 3600) -> dict[str, np.ndarray]:
+        """
+        Get the most recent duration seconds of history as columns.
+
+        The lookup is a binary search in the C++ ring buffer and the arrays
+        are zero-copy views, so the cost is O(window), with no per-sample
+        Python objects. The views are only valid until the simulator steps
+        again; use them under step_lock and copy them to keep the data
+        across an await.
+
+        Args:
+            duration: Seconds of simulation time to return, ending now
+
+        Returns:
+            Dict of 1D float64 arrays keyed like get_state(), oldest first
+        """
+        if self.simulator is None or not self.initialized:
+            return {}
+        now = self.simulator.get_time()
+        return self.simulator.history.window(now - duration, now)
+
     def get_history(self, duration: int = 3600) -> list[dict[str, Any]]:
         """
         Get historical data points.
 
+        History holds one sample per simulation step, so at speed factors
+        above 1 a duration covers more steps than wall-clock seconds.
+
         Args:
-            duration: Number of seconds of history to return (1-7200, default 3600)
+            duration: Seconds of simulation time to return (default 3600)
 
         Returns:
             List of state snapshots in chronological order (oldest first)
         """
-        if duration < 1 or duration > 7200:
-            logger.warning(f"Invalid duration {duration}, clamping to valid range")
-            duration = max(1, min(duration, 7200))
-
-        num_entries = min(duration, len(self.history))
-        if num_entries == 0:
+        columns = self.get_history_columns(max(1, duration))
+        if not columns:
             return []
 
-        return list(self.history)[-num_entries:]
+        keys = list(columns)
+        rows = zip(*(columns[key].tolist() for key in keys))
+        return [dict(zip(keys, row)) for row in rows]
+
+    @property
+    def max_trend_duration(self) -> float:
+        """Simulated seconds the coarsest pyramid level can hold."""
+        factor, capacity = self.HISTORY_LEVELS[-1]
+        return max(factor * capacity * self.config.dt, self.max_history_duration)
+
+    def forecast(
+        self,
+        horizon: float,
+        points: int,
+        setpoints: list | None = None,
+        inlet_flows: list | None = None,
+    ) -> dict[str, Any]:
+        """
+        Predict the level over the next horizon seconds for each candidate.
+
+        Candidates are forked from the current state and run together in
+        the C++ Forecaster (see tank_sim.Forecaster for the schedule
+        layout); None entries in a schedule hold the previous value.
+
+        Returns:
+            Dict with "time" (sample times), "levels" (one list per
+            candidate), "lower"/"upper" (envelope across candidates per
+            sample) and "min"/"max" (per candidate over the horizon)
+        """
+        if self.simulator is None or not self.initialized:
+            raise RuntimeError("Simulation not initialized")
+
+        steps = max(1, round(horizon / self.config.dt))
+        shape = (steps, max(1, steps // points))
+        if self._forecaster is None or self._forecast_shape != shape:
+            self._forecaster = tank_sim.Forecaster(
+                self.config, tank_sim.ForecastOptions(*shape)
+            )
+            self._forecast_shape = shape
+
+        def schedule(values):
+            if values is None:
+                return None
+            if len(values) > self.MAX_FORECAST_CANDIDATES:
+                raise ValueError(
+                    f"At most {self.MAX_FORECAST_CANDIDATES} forecast candidates, "
+                    f"got {len(values)}"
+                )
+            return np.array(values, dtype=float)  # None becomes NaN
+
+        f = self._forecaster.run(
+            self.simulator, setpoints=schedule(setpoints), inlet_flows=schedule(inlet_flows)
+        )
+        return {
+            "time": f["time"].tolist(),
+            "levels": f["levels"].T.tolist(),
+            "lower": f["lower"].tolist(),
+            "upper": f["upper"].tolist(),
+            "min": f["candidate_min"].tolist(),
+            "max": f["candidate_max"].tolist(),
+        }
+
+    def get_trend(self, duration: float, max_points: int) -> dict[str, Any]:
+        """
+        Get a trend of the most recent duration seconds in at most max_points buckets.
+
+        Raw samples are returned when they fit the budget. Otherwise the
+        finest pyramid level that covers the range within the budget is used,
+        so the cost depends on max_points, not duration. If even the coarsest
+        level has too many buckets, adjacent buckets are merged.
 
-    def add_connection(self, websocket):
-        """Add a WebSocket connection."""
-        self.connections.add(websocket)
+        Args:
+            duration: Seconds of simulation time to return, ending now
+            max_points: Upper bound on the number of buckets returned
+
+        Returns:
+            Dict with "bucket_seconds" (nominal bucket width; dt for raw
+            samples), "time" (time of each bucket's last sample), and "min",
+            "max" and "mean" dicts of per-bucket lists keyed by TREND_FIELDS
+        """
+        result: dict[str, Any] = {
+            "duration": duration,
+            "bucket_seconds": self.config.dt,
+            "time": [],
+            "min": {field: [] for field in self.TREND_FIELDS},
+            "max": {field: [] for field in self.TREND_FIELDS},
+            "mean": {field: [] for field in self.TREND_FIELDS},
+        }
+        if self.simulator is None or not self.initialized:
+            return result
+
+        now = self.simulator.get_time()
+        t0 = now - duration
+        if duration <= self.max_history_duration:
+            columns = self.simulator.history.window(t0, now)
+            if len(columns["time"]) <= max_points:
+                result["time"] = columns["time"].tolist()
+                for stat in ("min", "max", "mean"):
+                    result[stat] = {f: columns[f].tolist() for f in self.TREND_FIELDS}
+                return result
+
+        pyramid = self.simulator.history_pyramid
+        level = pyramid.select(t0, now, max_points)
+        buckets = pyramid.query(level, t0, now)
+        counts = np.asarray(buckets["count"], dtype=float)
+        times = np.asarray(buckets["time"]["last"])
+        stats = {
+            f: (
+                np.asarray(buckets[f]["min"]),
+                np.asarray(buckets[f]["max"]),
+                np.asarray(buckets[f]["mean"]),
+            )
+            for f in self.TREND_FIELDS
+        }
+        bucket_seconds = pyramid.levels[level][0] * self.config.dt
+
+        if len(counts) > max_points:
+            # Merge runs of `group` buckets; means are weighted by sample count
+            group = -(-len(counts) // max_points)
+            starts = np.arange(0, len(counts), group)
+            ends = np.minimum(starts + group, len(counts)) - 1
+            merged = np.add.reduceat(counts, starts)
+            stats = {
+                f: (
+                    np.minimum.reduceat(lo, starts),
+                    np.maximum.reduceat(hi, starts),
+                    np.add.reduceat(mean * counts, starts) / merged,
+                )
+                for f, (lo, hi, mean) in stats.items()
+            }
+            times = times[ends]
+            bucket_seconds *= group
+
+        result["bucket_seconds"] = bucket_seconds
+        result["time"] = times.tolist()
+        for f, (lo, hi, mean) in stats.items():
+            result["min"][f] = lo.tolist()
+            result["max"][f] = hi.tolist()
+            result["mean"][f] = mean.tolist()
+        return result
+
+    def add_connection(self, websocket, fmt: str = FORMAT_JSON):
+        """Add a WebSocket connection that receives broadcasts in the given format."""
+        self.set_connection_format(websocket, fmt)
         logger.info(
-            f"WebSocket connection added. Total connections: {len(self.connections)}"
+            f"WebSocket connection added ({fmt}). Total connections: {len(self.connections)}"
         )
 
+    def set_connection_format(self, websocket, fmt: str):
+        """Select the broadcast wire format ("json" or "binary") for a connection."""
+        if fmt not in FORMATS:
+            raise ValueError(f"Unknown format '{fmt}', expected one of {FORMATS}")
+        self.connections[websocket] = fmt
+
     def remove_connection(self, websocket):
         """Remove a WebSocket connection."""
-        self.connections.discard(websocket)
+        self.connections.pop(websocket, None)
         logger.info(
             f"WebSocket connection removed. Total connections: {len(self.connections)}"
         )
 
-    async def broadcast(self, message: dict[str, Any]):
-        """Broadcast message to all connected clients."""
-        disconnected = []
-        for connection in self.connections:
-            try:
-                await connection.send_json(message)
-            except Exception as e:
-                logger.warning(f"Error sending message to client: {e}")
-                disconnected.append(connection)
-
-        # Remove failed connections
-        for connection in disconnected:
-            self.remove_connection(connection)
+    def get_metrics_text(self) -> str:
+        """Prometheus exposition of simulator and scheduler metrics."""
+        simulator_metrics = None
+        if self.simulator is not None and self.initialized:
+            simulator_metrics = self.simulator.get_metrics()
+        return format_prometheus(
+            simulator_metrics, self.loop_timings, len(self.connections)
+        )
 
-    async def simulation_loop(self):
+    async def broadcast(self, message: dict[str, Any]):
         """
-        Main simulation loop running at 1 Hz.
+        Broadcast message to all connected clients.
 
-        Continuously:
-        - Steps the simulation
-        - Gets current state
-        - Broadcasts state to all connected WebSocket clients
-        - Stores state in history buffer
+        The message is serialized once per wire format, not once per client,
+        and sent to all clients concurrently. State messages go to binary
+        connections as state frames; anything else is sent to every client
+        as JSON text.
         """
-        logger.info("Simulation loop started")
-        try:
-            while True:
-                await asyncio.sleep(1.0)
-
-                try:
-                    # Advance simulation by one step
-                    self.step()
-
-                    # Get current state
-                    state = self.get_state()
-
-                    # Store in history buffer
-                    self.history.append(state)
-
-                    # Broadcast to all connected clients
-                    message = {"type": "state", "data": state}
-                    await self.broadcast(message)
+        if not self.connections:
+            return
 
-                except Exception as e:
-                    logger.error(f"Error in simulation loop iteration: {e}")
-                    # Continue loop without crashing
+        text = encode_json(message)
+        frame = None
+        if message.get("type") == "state" and FORMAT_BINARY in self.connections.values():
+            frame = encode_state(message["data"], self.publish_sequence)
+
+        connections = list(self.connections.items())
+        results = await asyncio.gather(
+            *(
+                connection.send_bytes(frame)
+                if fmt == FORMAT_BINARY and frame is not None
+                else connection.send_text(text)
+                for connection, fmt in connections
+            ),
+            return_exceptions=True,
+        )
 
-        except asyncio.CancelledError:
-            logger.info("Simulation loop cancelled")
-            raise
-        except Exception as e:
-            logger.error(f"Fatal error in simulation loop: {e}")
-            raise
+        # Remove failed connections
+        for (connection, _), result in zip(connections, results):
+            if isinstance(result, Exception):
+                logger.warning(f"Error sending message to client: {result}")
+                self.remove_connection(connection)
@@ -0,0 +1,144 @@
+"""
+Wire formats for WebSocket state broadcasts.
+
+Clients choose a format per connection:
+- "json" (default): {"type": "state", "data": {...}} text frames
+- "binary": fixed-layout little-endian state frames, 72 bytes each
+
+Binary state frame layout (all little-endian):
+
+    offset  size  type     field
+    0       1     uint8    frame kind (FRAME_STATE = 1)
+    1       1     uint8    format version (BINARY_VERSION = 1)
+    2       2     uint16   reserved, always 0
+    4       4     uint32   sequence number, wraps at 2**32
+    8       64    float64  STATE_FIELDS, in order
+
+The sequence number increments once per published state, so clients can
+detect dropped frames. Errors and other non-state messages are always sent
+as JSON text frames, whatever the connection format.
+
+GET /api/history?format=binary uses a columnar frame instead:
+
+    offset  size       type     field
+    0       1          uint8    frame kind (FRAME_HISTORY = 2)
+    1       1          uint8    format version (BINARY_VERSION = 1)
+    2       2          uint16   field count (len(STATE_FIELDS))
+    4       4          uint32   sample count n
+    8       8 * n * 8  float64  one column of n values per STATE_FIELDS entry
+
+Each broadcast is encoded once per format and the same bytes are sent to
+every connection using that format.
+"""
+
+import json
+import struct
+from typing import Any
+
+import numpy as np
+
+FORMAT_JSON = "json"
+FORMAT_BINARY = "binary"
+FORMATS = (FORMAT_JSON, FORMAT_BINARY)
+
+FRAME_STATE = 1
+FRAME_HISTORY = 2
+BINARY_VERSION = 1
+
+# Field order of the binary state frame; keep in sync with frontend/lib/websocket.ts
+STATE_FIELDS = (
+    "time",
+    "tank_level",
+    "setpoint",
+    "error",
+    "inlet_flow",
+    "outlet_flow",
+    "valve_position",
+    "controller_output",
+)
+
+_STATE_STRUCT = struct.Struct("<BBHI" + "d" * len(STATE_FIELDS))
+STATE_FRAME_SIZE = _STATE_STRUCT.size
+_HISTORY_HEADER = struct.Struct("<BBHI")
+
+
+def encode_json(message: dict[str, Any]) -> str:
+    """Serialize a message as a JSON text frame."""
+    return json.dumps(message, separators=(",", ":"))
+
+
+def encode_state(state: dict[str, float], sequence: int) -> bytes:
+    """
+    Pack a state snapshot into a binary state frame.
+
+    Args:
+        state: State dictionary with every key in STATE_FIELDS
+        sequence: Publish counter, reduced modulo 2**32
+
+    Returns:
+        STATE_FRAME_SIZE bytes
+    """
+    return _STATE_STRUCT.pack(
+        FRAME_STATE,
+        BINARY_VERSION,
+        0,
+        sequence & 0xFFFFFFFF,
+        *(float(state[field]) for field in STATE_FIELDS),
+    )
+
+
+def decode_state(frame: bytes) -> tuple[int, dict[str, float]]:
+    """
+    Unpack a binary state frame.
+
+    Returns:
+        (sequence, state dictionary)
+
+    Raises:
+        ValueError: If the frame size, kind, or version is not recognized
+    """
+    if len(frame) != STATE_FRAME_SIZE:
+        raise ValueError(
+            f"State frame must be {STATE_FRAME_SIZE} bytes, got {len(frame)}"
+        )
+    kind, version, _, sequence, *values = _STATE_STRUCT.unpack(frame)
+    if kind != FRAME_STATE or version != BINARY_VERSION:
+        raise ValueError(f"Unsupported frame kind {kind} version {version}")
+    return sequence, dict(zip(STATE_FIELDS, values))
+
+
+def encode_history(columns: dict[str, np.ndarray]) -> bytes:
+    """
+    Pack history columns into a binary history frame.
+
+    Each column is written with one bulk copy, so the cost does not involve
+    any per-sample Python objects.
+
+    Args:
+        columns: 1D float64 arrays of equal length, keyed by STATE_FIELDS
+            (an empty dict encodes zero samples)
+    """
+    count = len(columns["time"]) if columns else 0
+    parts = [_HISTORY_HEADER.pack(FRAME_HISTORY, BINARY_VERSION, len(STATE_FIELDS), count)]
+    if count:
+        parts.extend(
+            np.ascontiguousarray(columns[field], dtype="<f8").tobytes()
+            for field in STATE_FIELDS
+        )
+    return b"".join(parts)
+
+
+def decode_history(frame: bytes) -> dict[str, np.ndarray]:
+    """
+    Unpack a binary history frame into columns.
+
+    Raises:
+        ValueError: If the header or frame size is not recognized
+    """
+    kind, version, fields, count = _HISTORY_HEADER.unpack_from(frame)
+    if kind != FRAME_HISTORY or version != BINARY_VERSION or fields != len(STATE_FIELDS):
+        raise ValueError(f"Unsupported frame kind {kind} version {version}")
+    if len(frame) != _HISTORY_HEADER.size + 8 * fields * count:
+        raise ValueError("History frame size does not match its header")
+    data = np.frombuffer(frame, dtype="<f8", offset=_HISTORY_HEADER.size)
+    return {field: data[i * count : (i + 1) * count] for i, field in enumerate(STATE_FIELDS)}
@@ -9,12 +9,137 @@ import sys
 from unittest.mock import MagicMock
 
 import httpx
+import numpy as np
 import pytest
 from starlette.testclient import TestClient
 
 
+# Mock of tank_sim.HistoryBuffer: keeps per-step snapshots in a list
+class MockHistory:
+    def __init__(self, capacity):
+        self.capacity = capacity
+        self.samples = []
+
+    def __len__(self):
+        return len(self.samples)
+
+    @property
+    def size(self):
+        return len(self.samples)
+
+    def append(self, sample):
+        self.samples.append(sample)
+        del self.samples[: -self.capacity]
+
+    def clear(self):
+        self.samples.clear()
+
+    def window(self, t0, t1, copy=False):
+        """Samples with t0 <= time <= t1, as a dict of arrays."""
+        selected = [s for s in self.samples if t0 <= s["time"] <= t1]
+        keys = list(MockSimulator.snapshot_keys)
+        return {k: np.array([s[k] for s in selected], dtype=float) for k in keys}
+
+
+class MockPyramid:
+    """Brute-force stand-in for tank_sim.HistoryPyramid (keeps every sample)."""
+
+    def __init__(self, levels):
+        self.levels = [tuple(level) for level in levels]
+        self.samples = []
+
+    def append(self, sample):
+        self.samples.append(sample)
+
+    def clear(self):
+        self.samples.clear()
+
+    def _buckets(self, level, t0, t1):
+        factor, capacity = self.levels[level]
+        complete = len(self.samples) // factor
+        first = max(0, complete - capacity)
+        groups = [
+            self.samples[k * factor : (k + 1) * factor]
+            for k in range(first, -(-len(self.samples) // factor))
+        ]
+        return [g for g in groups if g[0]["time"] <= t1 and g[-1]["time"] >= t0]
+
+    def select(self, t0, t1, max_points):
+        for level, (factor, capacity) in enumerate(self.levels):
+            complete = len(self.samples) // factor
+            covers = complete <= capacity or self.samples[(complete - capacity) * factor]["time"] <= t0
+            if covers and len(self._buckets(level, t0, t1)) <= max_points:
+                return level
+        return len(self.levels) - 1
+
+    def query(self, level, t0, t1):
+        groups = self._buckets(level, t0, t1)
+        result = {"count": np.array([len(g) for g in groups], dtype=np.int32)}
+        for key in MockSimulator.snapshot_keys:
+            values = [np.array([s[key] for s in g]) for g in groups]
+            result[key] = {
+                "min": np.array([v.min() for v in values]),
+                "max": np.array([v.max() for v in values]),
+                "mean": np.array([v.mean() for v in values]),
+                "last": np.array([v[-1] for v in values]),
+            }
+        return result
+
+
+class MockDisturbance:
+    """Stand-in for tank_sim.Disturbance (only the Brownian kind is used)."""
+
+    def __init__(self, input_index, sigma, min_value, max_value):
+        self.input_index = input_index
+        self.sigma = sigma
+        self.min_value = min_value
+        self.max_value = max_value
+
+    @staticmethod
+    def brownian(input_index, sigma, min_value=-np.inf, max_value=np.inf):
+        return MockDisturbance(input_index, sigma, min_value, max_value)
+
+    def apply(self, inputs, dt):
+        """Advance inputs by one step, as the C++ step loop does."""
+        value = inputs[self.input_index] + self.sigma * np.sqrt(dt) * np.random.normal()
+        inputs[self.input_index] = float(np.clip(value, self.min_value, self.max_value))
+
+
+class MockCommand:
+    """Stand-in for tank_sim.Command built by its factories."""
+
+    def __init__(self, kind, index, value=0.0, gains=None):
+        self.kind = kind
+        self.index = index
+        self.value = value
+        self.gains = gains
+
+    @staticmethod
+    def input(index, value):
+        return MockCommand("input", index, value)
+
+    @staticmethod
+    def setpoint(controller, value):
+        return MockCommand("setpoint", controller, value)
+
+    @staticmethod
+    def retune(controller, gains):
+        return MockCommand("gains", controller, gains=gains)
+
+
 # Mock Simulator class that will be used by all tests
 class MockSimulator:
+    snapshot_keys = (
+        "time",
+        "tank_level",
+        "setpoint",
+        "inlet_flow",
+        "outlet_flow",
+        "valve_position",
+        "error",
+        "controller_output",
+    )
+
     def __init__(self, config):
         self.config = config
         self.state = [2.5]  # tank_level
@@ -24,9 +149,36 @@ class MockSimulator:
         self.controller_output = [0.5]  # per controller
         self.time = 0.0
         self.step_count = 0
+        capacity = getattr(config, "history_capacity", 0)
+        self.history = MockHistory(capacity) if isinstance(capacity, int) and capacity > 0 else None
+        levels = getattr(config, "history_levels", None)
+        self.history_pyramid = MockPyramid(levels) if isinstance(levels, list) and levels else None
+        self.disturbances = []
+        self.commands = []
+
+    def post_commands(self, commands):
+        """Queue commands for the next step (mirrors Simulator.post_commands)."""
+        self.commands.extend(commands)
+        return len(commands)
+
+    def set_disturbances(self, disturbances):
+        self.disturbances = list(disturbances)
+
+    def get_disturbances(self):
+        return list(self.disturbances)
 
     def step(self):
         """Simulate one step forward."""
+        for command in self.commands:
+            if command.kind == "input":
+                self.set_input(command.index, command.value)
+            elif command.kind == "setpoint":
+                self.set_setpoint(command.index, command.value)
+            else:
+                self.set_controller_gains(command.index, command.gains)
+        self.commands.clear()
+        for disturbance in self.disturbances:
+            disturbance.apply(self.inputs, 1.0)
         self.time += 1.0
         self.step_count += 1
         # Simple simulation: inlet - outlet
@@ -34,11 +186,50 @@ class MockSimulator:
         net_flow = self.inputs[0] - outlet
         self.state[0] = max(0, self.state[0] + net_flow * 1.0)
         self.error[0] = self.setpoint[0] - self.state[0]
+        if self.history is not None:
+            self.history.append(self.snapshot())
+        if self.history_pyramid is not None:
+            self.history_pyramid.append(self.snapshot())
+
+    def run(self, n_steps):
+        """Advance n_steps in one call (mirrors Simulator.run)."""
+        for _ in range(n_steps):
+            self.step()
+
+    def get_metrics(self):
+        """Instrumentation counters (mirrors Simulator.get_metrics)."""
+        return {
+            "enabled": True,
+            "steps": self.step_count,
+            "derivative_evaluations": 4 * self.step_count,
+            "jacobian_evaluations": 0,
+            "phase_seconds": {"integration": 0.0, "control": 0.0, "recording": 0.0},
+            "step_seconds": 1e-6 * self.step_count,
+            "latency_upper_bounds": [5e-7, 1e-6, float("inf")],
+            "latency_counts": [0, self.step_count, 0],
+        }
 
     def get_state(self):
         """Get tank level."""
         return self.state
 
+    def snapshot(self, controller_idx=0):
+        """Get all telemetry for one controller in a single call."""
+        tank_level = self.state[0]
+        valve_position = self.inputs[1]
+        k_v = self.config.model_params.k_v
+        outlet_flow = k_v * valve_position * (tank_level**0.5) if tank_level > 0 else 0.0
+        return {
+            "time": self.time,
+            "tank_level": tank_level,
+            "setpoint": self.setpoint[controller_idx],
+            "inlet_flow": self.inputs[0],
+            "outlet_flow": outlet_flow,
+            "valve_position": valve_position,
+            "error": self.error[controller_idx],
+            "controller_output": self.controller_output[controller_idx],
+        }
+
     def get_setpoint(self, controller_idx):
         """Get controller setpoint."""
         return self.setpoint[controller_idx]
@@ -80,6 +271,79 @@ class MockSimulator:
         self.controller_output = [0.5]
         self.time = 0.0
         self.step_count = 0
+        self.commands.clear()
+        if self.history is not None:
+            self.history.clear()
+        if self.history_pyramid is not None:
+            self.history_pyramid.clear()
+
+
+# Mock Forecaster: every candidate holds the current level
+class MockForecaster:
+    def __init__(self, config, options):
+        self.config = config
+        self.options = options
+        self.sample_count = options.horizon_steps // options.sample_interval
+
+    def run(self, simulator, setpoints=None, inlet_flows=None):
+        schedules = [s for s in (setpoints, inlet_flows) if s is not None]
+        if not schedules:
+            raise ValueError("Forecast needs at least one candidate schedule")
+        candidates = len(schedules[0])
+        step = self.options.sample_interval * self.config.dt
+        levels = np.full((self.sample_count, candidates), simulator.get_state()[0])
+        return {
+            "time": simulator.get_time() + step * np.arange(1, self.sample_count + 1),
+            "levels": levels,
+            "lower": levels.min(axis=1),
+            "upper": levels.max(axis=1),
+            "candidate_min": levels.min(axis=0),
+            "candidate_max": levels.max(axis=0),
+        }
+
+
+def create_forecast_options(horizon_steps, sample_interval=1):
+    options = MagicMock()
+    options.horizon_steps = horizon_steps
+    options.sample_interval = sample_interval
+    return options
+
+
+# Mock SessionPool: steps every requested simulator on the calling thread
+class MockSessionPool:
+    def __init__(self, threads=0):
+        self.thread_count = threads if threads > 0 else 2
+        self.simulators = {}
+        self.next_id = 0
+
+    def add(self, simulator):
+        session = self.next_id
+        self.next_id += 1
+        self.simulators[session] = simulator
+        return session
+
+    def remove(self, session):
+        if session not in self.simulators:
+            raise IndexError(f"Unknown session {session}")
+        del self.simulators[session]
+
+    def shard(self, session):
+        return session % self.thread_count
+
+    def advance(self, work):
+        failures = []
+        for session, steps in work:
+            try:
+                self.simulators[session].run(steps)
+            except Exception as e:
+                failures.append((session, str(e)))
+        return failures
+
+    def __contains__(self, session):
+        return session in self.simulators
+
+    def __len__(self):
+        return len(self.simulators)
 
 
 # Install mock BEFORE any imports - this runs at module import time
@@ -104,6 +368,11 @@ if "tank_sim" not in sys.modules:
     mock_module.SimulatorConfig = MagicMock(return_value=mock_config)
     mock_module.create_default_config = MagicMock(return_value=mock_config)
     mock_module.Simulator = MockSimulator
+    mock_module.Disturbance = MockDisturbance
+    mock_module.Command = MockCommand
+    mock_module.SessionPool = MockSessionPool
+    mock_module.Forecaster = MockForecaster
+    mock_module.ForecastOptions = create_forecast_options
 
     # Mock PIDGains
     def create_pid_gains(Kc, tau_I, tau_D):
@@ -140,11 +409,8 @@ def app():
     """
     # Import after mock_tank_sim fixture ensures mock is in place
     from api.main import app as fastapi_app
-    from api.simulation import SimulationManager
-
-    # Reset the SimulationManager singleton for test isolation
-    SimulationManager._instance = None
 
+    # Each TestClient gets a fresh session registry from the lifespan
     return fastapi_app
 
 
@@ -58,7 +58,30 @@ def sim_manager(mock_config):
         manager.simulator.get_error.return_value = 1.0
         manager.simulator.get_controller_output.return_value = 0.5
         manager.simulator.get_time.return_value = 0.0
-        manager.simulator.step = MagicMock()
+        manager.simulator.snapshot.side_effect = lambda index=0: {
+            "time": 0.0,
+            "tank_level": 2.0,
+            "setpoint": 3.0,
+            "inlet_flow": manager.current_inlet_flow,
+            "outlet_flow": 0.0,
+            "valve_position": 0.5,
+            "error": 1.0,
+            "controller_output": 0.5,
+        }
+        # Disturbances run inside the simulator's step, as in the C++ core
+        manager.disturbances = []
+
+        def mock_set_disturbances(disturbances):
+            manager.disturbances = list(disturbances)
+
+        def mock_step():
+            inputs = [manager.current_inlet_flow, 0.5]
+            for disturbance in manager.disturbances:
+                disturbance.apply(inputs, mock_config.dt)
+            manager.current_inlet_flow = inputs[0]
+
+        manager.simulator.set_disturbances = mock_set_disturbances
+        manager.simulator.step = MagicMock(side_effect=mock_step)
         return manager
 
 
@@ -231,28 +254,23 @@ async def test_pid_rejects_brownian_disturbances(sim_manager):
 
 
 @pytest.mark.asyncio
-async def test_apply_brownian_inlet_direct(sim_manager):
+async def test_brownian_disturbance_parameters(sim_manager):
     """
-    Test the apply_brownian_inlet method directly.
-    Verify that it returns values within bounds and applies random increment.
+    Brownian mode installs one native disturbance on the inlet flow whose
+    per-step standard deviation is the requested variance.
     """
+    sim_manager.config.dt = 4.0
     sim_manager.set_inlet_mode("brownian", min_flow=0.5, max_flow=1.5, variance=0.1)
 
-    current_flow = 1.0
-    new_flows = []
+    assert len(sim_manager.disturbances) == 1
+    disturbance = sim_manager.disturbances[0]
+    assert disturbance.input_index == 0
+    assert disturbance.sigma * np.sqrt(4.0) == pytest.approx(0.1)
+    assert disturbance.min_value == 0.5
+    assert disturbance.max_value == 1.5
 
-    # Generate 50 new flows
-    for _ in range(50):
-        new_flow = sim_manager.apply_brownian_inlet(current_flow)
-        new_flows.append(new_flow)
-        current_flow = new_flow
-
-    # Verify all flows are within bounds
-    for flow in new_flows:
-        assert 0.5 <= flow <= 1.5, f"Flow {flow} outside bounds"
-
-    # Verify flows are different (not constant)
-    assert len(set(new_flows)) > 1, "Flows should vary"
+    sim_manager.set_inlet_mode("constant", min_flow=0.5, max_flow=1.5, variance=0.1)
+    assert sim_manager.disturbances == []
 
 
 @pytest.mark.asyncio
@@ -267,8 +285,9 @@ async def test_brownian_reset_behavior(sim_manager):
     # Reset simulation
     sim_manager.reset()
 
-    # Verify inlet mode is reset to constant
+    # Verify inlet mode is reset to constant and the disturbance removed
     assert sim_manager.inlet_mode == "constant"
+    assert sim_manager.disturbances == []
 
     # Verify parameters are reset to defaults
     assert sim_manager.inlet_mode_params["min"] == 0.8
@@ -5,8 +5,11 @@ Tests all HTTP endpoints including GET, POST, and error cases.
 Uses mocked tank_sim to avoid C++ compilation dependency.
 """
 
+import numpy as np
 import pytest
 
+from api.telemetry import STATE_FIELDS, decode_history
+
 
 def test_health_endpoint(client):
     """Verify GET /health returns status 200 and contains 'status' field."""
@@ -74,6 +77,37 @@ def test_get_history_with_duration(client):
     assert isinstance(data, list)
 
 
+def test_get_history_window_from_simulator(client):
+    """Verify history comes from the simulator's per-step buffer, oldest first."""
+    from api import main
+
+    main.simulation_manager.simulator.run(30)
+    data = client.get("/api/history?duration=10").json()
+
+    times = [entry["time"] for entry in data]
+    assert times == sorted(times)
+    assert times[-1] - times[0] <= 10
+    assert len(data) >= 10
+
+
+def test_get_history_binary(client):
+    """Verify format=binary returns columnar float64 data."""
+    from api import main
+
+    main.simulation_manager.simulator.run(30)
+    response = client.get("/api/history?duration=20&format=binary")
+    assert response.status_code == 200
+    assert response.headers["content-type"] == "application/octet-stream"
+
+    columns = decode_history(response.content)
+    assert list(columns) == list(STATE_FIELDS)
+    assert len(columns["time"]) >= 20
+    assert (columns["time"][1:] > columns["time"][:-1]).all()
+
+    response = client.get("/api/history?format=csv")
+    assert response.status_code == 422
+
+
 def test_get_history_validation(client):
     """Verify invalid duration values return appropriate validation errors."""
     # Test negative duration
@@ -93,6 +127,62 @@ def test_get_history_validation(client):
     assert response.status_code == 422
 
 
+def test_get_history_trend_raw(client):
+    """Verify short trends within the point budget are raw samples."""
+    from api import main
+
+    main.simulation_manager.simulator.run(30)
+    data = client.get("/api/history/trend?duration=20&points=100").json()
+
+    assert data["bucket_seconds"] == 1.0
+    assert len(data["time"]) >= 20
+    assert data["min"]["tank_level"] == data["mean"]["tank_level"]
+    assert set(data["mean"]) == set(main.simulation_manager.TREND_FIELDS)
+
+
+def test_get_history_trend_uses_pyramid(client):
+    """Verify long trends come from the coarsest level within the budget."""
+    from api import main
+
+    sim = main.simulation_manager.simulator
+    sim.run(200)
+    data = client.get("/api/history/trend?duration=200&points=10").json()
+
+    # 10 s buckets would need 20 points, so 60 s buckets are used
+    assert data["bucket_seconds"] == 60.0
+    assert len(data["time"]) == 4
+    samples = sim.history_pyramid.samples
+    assert data["time"][0] == samples[59]["time"]
+    assert data["max"]["tank_level"][0] == max(s["tank_level"] for s in samples[:60])
+
+
+def test_get_history_trend_merges_to_budget(client):
+    """Verify buckets are merged when even the coarsest level exceeds the budget."""
+    from api import main
+    from api.tests.conftest import MockPyramid
+
+    sim = main.simulation_manager.simulator
+    sim.history_pyramid = MockPyramid([(1, 1000)])
+    sim.run(50)
+    data = client.get("/api/history/trend?duration=50&points=10").json()
+
+    assert len(data["time"]) <= 10
+    group = int(data["bucket_seconds"])
+    first = sim.history_pyramid.samples[:group]
+    assert group >= 5
+    assert data["time"][0] == first[-1]["time"]
+    assert data["mean"]["tank_level"][0] == pytest.approx(
+        np.mean([s["tank_level"] for s in first])
+    )
+
+
+def test_get_history_trend_validation(client):
+    """Verify trend parameters are range checked."""
+    assert client.get("/api/history/trend?points=5").status_code == 422
+    assert client.get("/api/history/trend?duration=0").status_code == 422
+    assert client.get("/api/history/trend?duration=100000000").status_code == 422
+
+
 def test_post_setpoint_valid(client):
     """Verify POST /api/setpoint with valid value succeeds."""
     payload = {"value": 3.5}
@@ -219,3 +309,26 @@ def test_post_pid_gains_missing_fields(client):
     """Verify POST /api/pid with missing fields returns validation error."""
     response = client.post("/api/pid", json={"Kc": 1.5})
     assert response.status_code == 422
+
+
+def test_forecast(client):
+    """Verify POST /api/forecast returns one level series per candidate."""
+    response = client.post(
+        "/api/forecast",
+        json={"horizon": 600, "points": 60, "setpoints": [2.0, 2.5, 3.0, None]},
+    )
+    assert response.status_code == 200
+    data = response.json()
+    assert len(data["time"]) == 60
+    assert len(data["levels"]) == 4
+    assert all(len(levels) == 60 for levels in data["levels"])
+    assert len(data["lower"]) == len(data["upper"]) == 60
+    assert len(data["min"]) == len(data["max"]) == 4
+
+
+def test_forecast_validation(client):
+    """Verify forecasts need a schedule and a bounded candidate count."""
+    assert client.post("/api/forecast", json={}).status_code == 422
+    assert client.post("/api/forecast", json={"horizon": -1, "setpoints": [2.0]}).status_code == 422
+    too_many = {"setpoints": [2.0] * 2000}
+    assert client.post("/api/forecast", json=too_many).status_code == 422
@@ -0,0 +1,86 @@
+"""Tests for the Prometheus /metrics endpoint and its text formatter."""
+
+import pytest
+
+import tank_sim
+from api.metrics import LOOP_PHASES, LoopTimings, format_prometheus
+from api.simulation import SimulationManager
+
+
+def _samples(text):
+    """Parse exposition text into {sample name with labels: value}."""
+    samples = {}
+    for line in text.splitlines():
+        if line and not line.startswith("#"):
+            name, value = line.rsplit(" ", 1)
+            samples[name] = float(value)
+    return samples
+
+
+@pytest.fixture
+def simulator_metrics():
+    return {
+        "enabled": True,
+        "steps": 10,
+        "derivative_evaluations": 40,
+        "jacobian_evaluations": 0,
+        "phase_seconds": {"integration": 2e-6, "control": 1e-6, "recording": 0.0},
+        "step_seconds": 4e-6,
+        "latency_upper_bounds": [1e-7, 2e-7, float("inf")],
+        "latency_counts": [3, 6, 1],
+    }
+
+
+def test_histogram_buckets_are_cumulative(simulator_metrics):
+    """Buckets accumulate and end with +Inf; _count equals the last bucket."""
+    samples = _samples(format_prometheus(simulator_metrics, LoopTimings()))
+    assert samples['tank_sim_step_latency_seconds_bucket{le="1.000e-07"}'] == 3
+    assert samples['tank_sim_step_latency_seconds_bucket{le="2.000e-07"}'] == 9
+    assert samples['tank_sim_step_latency_seconds_bucket{le="+Inf"}'] == 10
+    assert samples["tank_sim_step_latency_seconds_count"] == 10
+    assert samples["tank_sim_step_latency_seconds_sum"] == pytest.approx(4e-6)
+
+
+def test_counters_and_phase_labels(simulator_metrics):
+    """Work counters and per-phase times are exported with phase labels."""
+    timings = LoopTimings()
+    timings.record("advance", 0.5)
+    timings.record("advance", 0.25)
+    text = format_prometheus(simulator_metrics, timings, connections=2)
+    samples = _samples(text)
+
+    assert "# TYPE tank_sim_steps_total counter" in text
+    assert samples["tank_sim_steps_total"] == 10
+    assert samples["tank_sim_derivative_evaluations_total"] == 40
+    assert samples['tank_sim_step_phase_seconds_total{phase="integration"}'] == 2e-6
+    assert samples['tank_sim_loop_phase_seconds_total{phase="advance"}'] == 0.75
+    assert samples['tank_sim_loop_phase_calls_total{phase="advance"}'] == 2
+    assert samples["tank_sim_websocket_connections"] == 2
+
+
+def test_without_simulator_only_loop_metrics():
+    """Before initialization only the scheduler metrics are exported."""
+    samples = _samples(format_prometheus(None, LoopTimings()))
+    assert "tank_sim_steps_total" not in samples
+    for phase in LOOP_PHASES:
+        assert samples[f'tank_sim_loop_phase_seconds_total{{phase="{phase}"}}'] == 0
+
+
+def test_manager_exports_simulator_metrics():
+    """SimulationManager reads the simulator's counters for each scrape."""
+    manager = SimulationManager(tank_sim.create_default_config())
+    manager.initialize()
+    manager.advance(5)
+
+    samples = _samples(manager.get_metrics_text())
+    assert samples["tank_sim_steps_total"] == 5
+
+
+def test_metrics_endpoint(client):
+    """GET /metrics serves Prometheus text."""
+    response = client.get("/metrics")
+    assert response.status_code == 200
+    assert response.headers["content-type"].startswith("text/plain")
+    assert "version=0.0.4" in response.headers["content-type"]
+    assert "# TYPE tank_sim_step_latency_seconds histogram" in response.text
+    assert 'tank_sim_step_latency_seconds_bucket{le="+Inf"}' in response.text
@@ -0,0 +1,108 @@
+"""Tests for the faster-than-real-time, multi-rate simulation scheduler."""
+
+from unittest.mock import MagicMock
+
+import pytest
+
+import tank_sim
+from api.simulation import SimulationManager
+
+
+@pytest.fixture
+def manager():
+    """Create an initialized SimulationManager backed by the MockSimulator."""
+    manager = SimulationManager(tank_sim.create_default_config())
+    manager.initialize()
+    manager._rebase_clock(now=100.0)
+    yield manager
+
+
+def test_real_time_runs_one_step_per_second(manager):
+    """At 1x with dt = 1 s, one wall second is due one physics step."""
+    assert manager.steps_due(100.0) == 0
+    assert manager.tick(101.0) == 1
+    assert manager.simulator.get_time() == pytest.approx(1.0)
+    assert manager.tick(101.5) == 0
+
+
+def test_speed_factor_scales_steps(manager):
+    """At 100x, one wall second is due 100 physics steps."""
+    manager.speed_factor = 100.0
+    assert manager.tick(101.0) == 100
+    assert manager.simulator.get_time() == pytest.approx(100.0)
+
+
+def test_multi_rate_publish_does_not_change_physics(manager):
+    """Publishing more often than dt only runs steps when they are due."""
+    taken = [manager.tick(100.0 + 0.25 * k) for k in range(1, 9)]
+    assert taken == [0, 0, 0, 1, 0, 0, 0, 1]
+
+
+def test_catch_up_uses_bulk_run(manager):
+    """A stall is recovered with one bulk run() call, not per-step calls."""
+    manager.simulator.run = MagicMock(wraps=manager.simulator.run)
+    assert manager.tick(130.0) == 30
+    manager.simulator.run.assert_called_once_with(30)
+
+
+def test_brownian_mode_uses_bulk_run(manager):
+    """Brownian inlet is generated in the C++ step loop, so bulk run() is kept."""
+    manager.set_inlet_mode("brownian", min_flow=0.8, max_flow=1.2, variance=0.05)
+    manager.simulator.run = MagicMock(wraps=manager.simulator.run)
+    assert manager.tick(105.0) == 5
+    manager.simulator.run.assert_called_once_with(5)
+    assert manager.simulator.get_time() == pytest.approx(5.0)
+    assert manager.simulator.get_inputs()[0] != 1.0
+
+
+def test_backlog_beyond_limit_is_dropped(manager):
+    """Excessive backlog runs the cap and rebases instead of spiralling."""
+    manager.MAX_CATCHUP_STEPS = 10
+    assert manager.tick(200.0) == 10
+    # Clock was rebased at t = 200: nothing further is due
+    assert manager.steps_due(200.0) == 0
+    assert manager.steps_due(201.0) == 1
+
+
+def test_set_speed_validation(manager):
+    """Speed and publish interval must be within limits."""
+    with pytest.raises(ValueError):
+        manager.set_speed(0.0)
+    with pytest.raises(ValueError):
+        manager.set_speed(manager.MAX_SPEED_FACTOR * 2)
+    with pytest.raises(ValueError):
+        manager.set_publish_interval(0.0)
+
+    manager.set_speed(50.0)
+    manager.set_publish_interval(0.5)
+    assert manager.speed_factor == 50.0
+    assert manager.publish_interval == 0.5
+
+
+def test_speed_endpoint(client):
+    """POST /api/speed updates the rate and is reflected in /api/config."""
+    response = client.post("/api/speed", json={"speed_factor": 10.0, "publish_interval": 0.5})
+    assert response.status_code == 200
+    assert response.json()["speed_factor"] == 10.0
+
+    config = client.get("/api/config").json()
+    assert config["speed_factor"] == 10.0
+    assert config["publish_interval"] == 0.5
+
+    response = client.post("/api/speed", json={"speed_factor": -1.0})
+    assert response.status_code == 422
+
+
+def test_commands_apply_at_next_step(manager):
+    """Setters queue commands that the simulator applies at a step boundary."""
+    manager.set_setpoint(3.0)
+    manager.set_inlet_flow(1.2)
+    assert manager.simulator.get_setpoint(0) == 2.5
+    assert manager.tick(101.0) == 1
+    assert manager.simulator.get_setpoint(0) == 3.0
+    assert manager.simulator.get_inputs()[0] == 1.2
+
+    assert manager.post_commands([tank_sim.Command.setpoint(0, 2.0)]) == 1
+    manager.reset()  # Discards what is still pending
+    manager.tick(manager._wall_anchor + 1.0)
+    assert manager.simulator.get_setpoint(0) == 2.5
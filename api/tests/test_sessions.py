@@ -0,0 +1,142 @@
+"""Tests for multi-session serving: the session registry and its endpoints."""
+
+import asyncio
+import threading
+
+import pytest
+
+from api import main
+from api.sessions import SessionLimitError, SessionRegistry
+
+
+@pytest.fixture
+def registry():
+    """A registry holding only the default session."""
+    registry = SessionRegistry(threads=2)
+    registry.create(SessionRegistry.DEFAULT_SESSION)
+    return registry
+
+
+def test_registry_create_and_remove(registry):
+    """Sessions get their own simulator and pool slot; the default one is permanent."""
+    other = registry.create("other")
+    assert len(registry) == 2
+    assert other.simulator is not registry.get("default").simulator
+    assert len(registry.pool) == 2
+
+    with pytest.raises(ValueError):
+        registry.create("other")
+
+    asyncio.run(registry.remove("other"))
+    assert "other" not in registry
+    assert len(registry.pool) == 1
+    with pytest.raises(ValueError):
+        asyncio.run(registry.remove(SessionRegistry.DEFAULT_SESSION))
+
+
+def test_registry_session_limit(registry, monkeypatch):
+    """Creating beyond MAX_SESSIONS is refused."""
+    monkeypatch.setattr(SessionRegistry, "MAX_SESSIONS", 2)
+    registry.create()
+    with pytest.raises(SessionLimitError):
+        registry.create()
+
+
+def test_registry_advances_each_session_at_its_own_speed(registry):
+    """One batch brings every session up to its own scaled clock."""
+    fast = registry.create("fast")
+    slow = registry.get("default")
+    for manager in (fast, slow):
+        manager._rebase_clock(now=100.0)
+    fast.speed_factor = 10.0
+
+    assert registry.advance([fast, slow], 102.0) == 22
+    assert fast.simulator.get_time() == pytest.approx(20.0)
+    assert slow.simulator.get_time() == pytest.approx(2.0)
+
+    # Sessions left out of the batch do not move
+    assert registry.advance([slow], 103.0) == 1
+    assert fast.simulator.get_time() == pytest.approx(20.0)
+
+
+def test_simulation_loop_steps_off_the_event_loop(registry, monkeypatch):
+    """The pool runs in a worker thread, under step_lock, while the loop keeps serving I/O."""
+    manager = registry.get("default")
+    manager.publish_interval = 0.01
+    manager.speed_factor = 1000.0  # Some steps are due at every publish
+    stepped = []
+    pool_advance = registry.pool.advance
+
+    def advance(work):
+        stepped.append((threading.get_ident(), registry.step_lock.locked()))
+        return pool_advance(work)
+
+    monkeypatch.setattr(registry.pool, "advance", advance)
+
+    async def run():
+        loop_task = asyncio.create_task(registry.simulation_loop())
+        ticks = 0
+        while not stepped:
+            await asyncio.sleep(0.005)
+            ticks += 1
+        loop_task.cancel()
+        with pytest.raises(asyncio.CancelledError):
+            await loop_task
+        return threading.get_ident(), ticks
+
+    loop_thread, ticks = asyncio.run(asyncio.wait_for(run(), timeout=5.0))
+    assert ticks > 0
+    assert all(thread != loop_thread and locked for thread, locked in stepped)
+    assert manager.step_lock is registry.step_lock
+
+
+def test_registry_metrics_sum_sessions(registry):
+    """GET /metrics counters are summed over sessions."""
+    registry.create("other").advance(3)
+    registry.get("default").advance(2)
+    text = registry.get_metrics_text()
+    assert "tank_sim_steps_total 5" in text
+    assert "tank_sim_sessions 2" in text
+
+
+def test_session_endpoints(client):
+    """Sessions are created, listed, addressed and removed over REST."""
+    response = client.post("/api/sessions", json={"session_id": "alice"})
+    assert response.status_code == 201
+    assert response.json()["session_id"] == "alice"
+    assert client.post("/api/sessions", json={"session_id": "alice"}).status_code == 409
+
+    created = client.post("/api/sessions")
+    assert created.status_code == 201
+    generated = created.json()["session_id"]
+
+    listed = client.get("/api/sessions").json()
+    ids = {s["session_id"] for s in listed["sessions"]}
+    assert ids == {"default", "alice", generated}
+
+    # Commands reach only the addressed session
+    assert client.post("/api/sessions/alice/setpoint", json={"value": 3.5}).status_code == 200
+    main.sessions.get("alice").step()  # Commands apply at the next step
+    assert client.get("/api/sessions/alice/state").json()["setpoint"] == 3.5
+    assert client.get("/api/state").json()["setpoint"] != 3.5
+
+    assert client.delete("/api/sessions/alice").status_code == 200
+    assert client.get("/api/sessions/alice/state").status_code == 404
+    assert client.delete("/api/sessions/alice").status_code == 404
+    assert client.delete("/api/sessions/default").status_code == 409
+
+
+def test_session_websocket(client):
+    """/ws/{session_id} streams that session's state; unknown ids get an error."""
+    client.post("/api/sessions", json={"session_id": "bob"})
+    client.post("/api/sessions/bob/setpoint", json={"value": 3.0})
+    main.sessions.get("bob").step()
+    with client.websocket_connect("/ws/bob") as ws:
+        message = ws.receive_json()
+        assert message["type"] == "state"
+        assert message["data"]["setpoint"] == 3.0
+
+    with client.websocket_connect("/ws/nobody") as ws:
+        message = ws.receive_json()
+        assert message["type"] == "error"
+        assert "nobody" in message["message"]
@@ -0,0 +1,142 @@
+"""Tests for the WebSocket wire formats and single-serialization broadcast."""
+
+import asyncio
+import json
+import struct
+
+import pytest
+
+import tank_sim
+from api.simulation import SimulationManager
+from api.telemetry import (
+    STATE_FIELDS,
+    STATE_FRAME_SIZE,
+    decode_state,
+    encode_json,
+    encode_state,
+)
+
+
+class RecordingConnection:
+    """Stand-in WebSocket that records what it was sent."""
+
+    def __init__(self, fail=False):
+        self.fail = fail
+        self.text = []
+        self.binary = []
+
+    async def send_text(self, text):
+        if self.fail:
+            raise RuntimeError("connection closed")
+        self.text.append(text)
+
+    async def send_bytes(self, data):
+        if self.fail:
+            raise RuntimeError("connection closed")
+        self.binary.append(data)
+
+
+@pytest.fixture
+def manager():
+    """Create a SimulationManager with no connections."""
+    manager = SimulationManager(tank_sim.create_default_config())
+    yield manager
+
+
+def test_state_frame_round_trip(simulation_state):
+    """Encoding then decoding reproduces every field exactly."""
+    frame = encode_state(simulation_state, sequence=42)
+    assert len(frame) == STATE_FRAME_SIZE == 72
+
+    sequence, decoded = decode_state(frame)
+    assert sequence == 42
+    assert decoded == simulation_state
+
+
+def test_state_frame_layout(simulation_state):
+    """Header is kind, version, reserved, sequence; fields follow in order."""
+    frame = encode_state(simulation_state, sequence=2**32 + 7)
+    kind, version, reserved, sequence = struct.unpack_from("<BBHI", frame)
+    assert (kind, version, reserved, sequence) == (1, 1, 0, 7)
+    assert struct.unpack_from("<d", frame, 8 + 8 * STATE_FIELDS.index("error"))[0] == 0.5
+
+
+def test_decode_rejects_bad_frames(simulation_state):
+    """Truncated frames or unknown kinds are rejected."""
+    frame = encode_state(simulation_state, sequence=0)
+    with pytest.raises(ValueError):
+        decode_state(frame[:-1])
+    with pytest.raises(ValueError):
+        decode_state(b"\x02" + frame[1:])
+
+
+def test_broadcast_serializes_once_per_format(manager, simulation_state):
+    """Every client of a format receives the identical pre-encoded payload."""
+    json_clients = [RecordingConnection() for _ in range(3)]
+    binary_clients = [RecordingConnection() for _ in range(3)]
+    for connection in json_clients:
+        manager.add_connection(connection)
+    for connection in binary_clients:
+        manager.add_connection(connection, "binary")
+
+    message = {"type": "state", "data": simulation_state}
+    asyncio.run(manager.broadcast(message))
+
+    texts = [c.text[0] for c in json_clients]
+    frames = [c.binary[0] for c in binary_clients]
+    assert all(t is texts[0] for t in texts)
+    assert all(f is frames[0] for f in frames)
+    assert json.loads(texts[0]) == message
+    assert decode_state(frames[0])[1] == simulation_state
+    assert not any(c.binary for c in json_clients)
+    assert not any(c.text for c in binary_clients)
+
+
+def test_broadcast_non_state_messages_are_json(manager):
+    """Binary connections still get non-state messages as JSON text."""
+    connection = RecordingConnection()
+    manager.add_connection(connection, "binary")
+    message = {"type": "error", "message": "boom"}
+    asyncio.run(manager.broadcast(message))
+    assert connection.text == [encode_json(message)]
+    assert connection.binary == []
+
+
+def test_broadcast_drops_failed_connections(manager, simulation_state):
+    """A failing client is removed without affecting the others."""
+    good = RecordingConnection()
+    bad = RecordingConnection(fail=True)
+    manager.add_connection(good, "binary")
+    manager.add_connection(bad, "binary")
+    asyncio.run(manager.broadcast({"type": "state", "data": simulation_state}))
+    assert len(good.binary) == 1
+    assert list(manager.connections) == [good]
+
+
+def test_unknown_format_rejected(manager):
+    """Only json and binary formats are accepted."""
+    with pytest.raises(ValueError):
+        manager.add_connection(RecordingConnection(), "msgpack")
+
+
+def test_websocket_binary_state_updates(client):
+    """Connecting with ?format=binary streams binary state frames."""
+    with client.websocket_connect("/ws?format=binary") as ws:
+        first_sequence, state = decode_state(ws.receive_bytes())
+        assert set(state) == set(STATE_FIELDS)
+        second_sequence, _ = decode_state(ws.receive_bytes())
+        assert second_sequence == first_sequence + 1
+
+
+def test_websocket_format_command(client):
+    """A format command switches an open connection to binary frames."""
+    with client.websocket_connect("/ws") as ws:
+        assert ws.receive_json()["type"] == "state"
+        ws.send_json({"type": "format", "format": "binary"})
+        # At most one JSON update can already be in flight
+        message = ws.receive()
+        if "text" in message:
+            assert json.loads(message["text"])["type"] == "state"
+            message = ws.receive()
+        _, state = decode_state(message["bytes"])
+        assert "tank_level" in state
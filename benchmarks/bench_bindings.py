@@ -0,0 +1,119 @@
+"""Per-step cost of driving the simulator through the Python bindings.
+
+Complements the C++ suite (bench_tank_sim_core): the numbers here include
+the pybind11 call, argument conversion and, for getters, numpy array
+creation, which is what the FastAPI server and notebooks actually pay.
+
+Usage::
+
+    python benchmarks/bench_bindings.py                 # table to stdout
+    python benchmarks/bench_bindings.py --json out.json # also write JSON
+
+The JSON mirrors Google Benchmark's layout ("context" plus a "benchmarks"
+list) so both suites can be tracked with the same tooling; each entry has
+``time_per_step`` in seconds.
+"""
+
+import argparse
+import json
+import platform
+import sys
+import time
+
+import numpy as np
+
+import tank_sim
+
+
+def _measure(name, steps_per_call, func, min_time):
+    """Call func repeatedly for at least min_time seconds; return a result."""
+    func()  # Warm up caches and any lazy initialization
+    calls = 0
+    start = time.perf_counter()
+    elapsed = 0.0
+    while elapsed < min_time:
+        func()
+        calls += 1
+        elapsed = time.perf_counter() - start
+    steps = calls * steps_per_call
+    return {
+        "name": name,
+        "iterations": calls,
+        "steps": steps,
+        "real_time": elapsed / calls,
+        "time_per_step": elapsed / steps,
+    }
+
+
+def run_benchmarks(min_time):
+    config = tank_sim.create_default_config()
+    results = []
+
+    sim = tank_sim.Simulator(config)
+    results.append(_measure("Simulator.step", 1, sim.step, min_time))
+
+    def step_and_read():
+        sim.step()
+        sim.get_state()
+
+    results.append(_measure("Simulator.step+get_state", 1, step_and_read, min_time))
+    results.append(_measure("Simulator.snapshot", 1, sim.snapshot, min_time))
+
+    for steps in (100, 10000):
+        trajectory = sim.make_trajectory(steps)
+
+        def run_into(trajectory=trajectory, steps=steps):
+            trajectory.clear()
+            sim.run(steps, trajectory)
+
+        results.append(
+            _measure(f"Simulator.run/steps:{steps}", steps, run_into, min_time)
+        )
+
+    for lanes in (64, 4096):
+        batch = tank_sim.BatchSimulator(config, lanes)
+        batch.set_setpoints(np.linspace(2.0, 3.5, lanes))
+        results.append(
+            _measure(
+                f"BatchSimulator.run/lanes:{lanes}",
+                lanes * 100,
+                lambda batch=batch: batch.run(100),
+                min_time,
+            )
+        )
+    return results
+
+
+def main(argv=None):
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--json", metavar="PATH", help="write results as JSON")
+    parser.add_argument(
+        "--min-time",
+        type=float,
+        default=0.5,
+        help="seconds to run each benchmark (default: 0.5)",
+    )
+    args = parser.parse_args(argv)
+
+    results = run_benchmarks(args.min_time)
+
+    print(f"{'Benchmark':<36} {'ns/step':>12} {'steps':>12}")
+    for r in results:
+        print(f"{r['name']:<36} {r['time_per_step'] * 1e9:>12.1f} {r['steps']:>12}")
+
+    if args.json:
+        report = {
+            "context": {
+                "date": time.strftime("%Y-%m-%dT%H:%M:%S%z"),
+                "python": sys.version.split()[0],
+                "platform": platform.platform(),
+                "tank_sim_version": tank_sim.get_version(),
+            },
+            "benchmarks": results,
+        }
+        with open(args.json, "w") as f:
+            json.dump(report, f, indent=2)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,269 @@
+/**
+ * @file bench_kernels.cpp
+ * @brief Micro-benchmarks of the building blocks of one simulation step:
+ *        model derivatives, the valve equation kernels, the RK4 steppers
+ *        and the PID update (scalar and banked).
+ */
+
+#include <benchmark/benchmark.h>
+#include <Eigen/Dense>
+#include <cmath>
+#include <vector>
+
+#include "bench_support.h"
+#include "constants.h"
+#include "fixed_stepper.h"
+#include "pid_controller.h"
+#include "pid_controller_bank.h"
+#include "stepper.h"
+#include "tank_model.h"
+#include "valve.h"
+
+using namespace tank_sim;
+using namespace tank_sim::constants;
+
+namespace {
+
+TankModel defaultModel() {
+    return TankModel(TankModel::Parameters{DEFAULT_TANK_AREA,
+                                           DEFAULT_VALVE_COEFFICIENT,
+                                           TANK_MAX_HEIGHT});
+}
+
+// Dynamic-size API: returns a fresh VectorXd per call
+void BM_TankModelDerivatives(benchmark::State &state) {
+    const TankModel model = defaultModel();
+    Eigen::VectorXd x = Eigen::VectorXd::Constant(1, TANK_NOMINAL_HEIGHT);
+    Eigen::VectorXd u(2);
+    u << TEST_INLET_FLOW, TEST_VALVE_POSITION;
+
+    bench::StepCounters counters(state);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(x);
+        Eigen::VectorXd dxdt = model.derivatives(x, u);
+        benchmark::DoNotOptimize(dxdt.data());
+    }
+    counters.report(1);
+}
+BENCHMARK(BM_TankModelDerivatives);
+
+// In-place API used by the dynamic Stepper
+void BM_TankModelDerivativesInPlace(benchmark::State &state) {
+    const TankModel model = defaultModel();
+    Eigen::VectorXd x = Eigen::VectorXd::Constant(1, TANK_NOMINAL_HEIGHT);
+    Eigen::VectorXd u(2);
+    u << TEST_INLET_FLOW, TEST_VALVE_POSITION;
+    Eigen::VectorXd dxdt(1);
+
+    bench::StepCounters counters(state);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(x);
+        model.derivatives(x, u, dxdt);
+        benchmark::DoNotOptimize(dxdt.data());
+    }
+    counters.report(1);
+}
+BENCHMARK(BM_TankModelDerivativesInPlace);
+
+// Fixed-size inline overload used by Simulator's hot path
+void BM_TankModelDerivativesFixed(benchmark::State &state) {
+    const TankModel model = defaultModel();
+    TankModel::StateVector x = TankModel::StateVector::Constant(TANK_NOMINAL_HEIGHT);
+    TankModel::InputVector u(TEST_INLET_FLOW, TEST_VALVE_POSITION);
+
+    bench::StepCounters counters(state);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(x);
+        TankModel::StateVector dxdt = model.derivatives(x, u);
+        benchmark::DoNotOptimize(dxdt);
+    }
+    counters.report(1);
+}
+BENCHMARK(BM_TankModelDerivativesFixed);
+
+// Valve-equation square root over the levels of a 4096-lane batch, the
+// BatchSimulator stage pattern. time_per_step is per lane.
+// Arg: 0 = std::sqrt, 1 = fastSqrt()
+void BM_ValveSqrt(benchmark::State &state) {
+    const Eigen::Index lanes = 4096;
+    const Eigen::ArrayXd h = Eigen::ArrayXd::LinSpaced(lanes, 0.01, TANK_MAX_HEIGHT);
+    Eigen::ArrayXd out(lanes);
+    const bool fast = state.range(0) == 1;
+
+    bench::StepCounters counters(state);
+    for (auto _ : state) {
+        if (fast) {
+            out = h.unaryExpr([](double v) { return fastSqrt(v); });
+        } else {
+            out = h.sqrt();
+        }
+        benchmark::DoNotOptimize(out.data());
+        benchmark::ClobberMemory();
+    }
+    counters.report(static_cast<double>(lanes));
+}
+BENCHMARK(BM_ValveSqrt)->ArgName("fast")->Arg(0)->Arg(1);
+
+// Equal-percentage f(x) over 4096 positions: the lookup table against the
+// closed form it samples. time_per_step is per lane.
+// Arg: 0 = ValveCurve table, 1 = pow()
+void BM_ValveOpening(benchmark::State &state) {
+    const Eigen::Index lanes = 4096;
+    const ValveCurve curve(ValveCharacteristic::EQUAL_PERCENTAGE);
+    const Eigen::ArrayXd x = Eigen::ArrayXd::LinSpaced(lanes, 0.0, 1.0);
+    Eigen::ArrayXd out(lanes);
+    const bool closedForm = state.range(0) == 1;
+    const double r = DEFAULT_VALVE_RANGEABILITY;
+
+    bench::StepCounters counters(state);
+    for (auto _ : state) {
+        if (closedForm) {
+            out = x.unaryExpr([r](double v) { return (std::pow(r, v) - 1.0) / (r - 1.0); });
+        } else {
+            curve.openings(x, out);
+        }
+        benchmark::DoNotOptimize(out.data());
+        benchmark::ClobberMemory();
+    }
+    counters.report(static_cast<double>(lanes));
+}
+BENCHMARK(BM_ValveOpening)->ArgName("pow")->Arg(0)->Arg(1);
+
+// Stepper::step() through the allocating std::function API.
+// Arg: 0 = GSL backend, 1 = Native backend
+void BM_StepperStep(benchmark::State &state) {
+    const auto backend = state.range(0) == 0 ? Stepper::Backend::GSL
+                                             : Stepper::Backend::Native;
+    const TankModel model = defaultModel();
+    Stepper stepper(TANK_STATE_SIZE, TANK_INPUT_SIZE, backend);
+    Eigen::VectorXd x = Eigen::VectorXd::Constant(1, TANK_NOMINAL_HEIGHT);
+    Eigen::VectorXd u(2);
+    u << TEST_INLET_FLOW, TEST_VALVE_POSITION;
+    const Stepper::DerivativeFunc f =
+        [&model](double, const Eigen::VectorXd &y, const Eigen::VectorXd &v) {
+            return model.derivatives(y, v);
+        };
+
+    double t = 0.0;
+    bench::StepCounters counters(state);
+    for (auto _ : state) {
+        x = stepper.step(t, TEST_DT, x, u, f);
+        t += TEST_DT;
+        benchmark::DoNotOptimize(x.data());
+    }
+    counters.report(1);
+}
+BENCHMARK(BM_StepperStep)->ArgName("native")->Arg(0)->Arg(1);
+
+// Stepper::step() in place, the path Simulator uses for Integrator::GslRK4
+void BM_StepperStepInPlace(benchmark::State &state) {
+    const auto backend = state.range(0) == 0 ? Stepper::Backend::GSL
+                                             : Stepper::Backend::Native;
+    const TankModel model = defaultModel();
+    Stepper stepper(TANK_STATE_SIZE, TANK_INPUT_SIZE, backend);
+    Eigen::VectorXd x = Eigen::VectorXd::Constant(1, TANK_NOMINAL_HEIGHT);
+    Eigen::VectorXd u(2);
+    u << TEST_INLET_FLOW, TEST_VALVE_POSITION;
+    const Stepper::InPlaceDerivativeFunc f =
+        [&model](double, const Eigen::Ref<const Eigen::VectorXd> &y,
+                 const Eigen::Ref<const Eigen::VectorXd> &v,
+                 Eigen::Ref<Eigen::VectorXd> dydt) { model.derivatives(y, v, dydt); };
+
+    double t = 0.0;
+    bench::StepCounters counters(state);
+    for (auto _ : state) {
+        stepper.step(t, TEST_DT, x, u, f);
+        t += TEST_DT;
+        benchmark::DoNotOptimize(x.data());
+    }
+    counters.report(1);
+}
+BENCHMARK(BM_StepperStepInPlace)->ArgName("native")->Arg(0)->Arg(1);
+
+// FixedStepper with the model inlined into the stages
+void BM_FixedStepperStep(benchmark::State &state) {
+    const TankModel model = defaultModel();
+    FixedStepper<TANK_STATE_SIZE, TANK_INPUT_SIZE> stepper;
+    TankModel::StateVector x = TankModel::StateVector::Constant(TANK_NOMINAL_HEIGHT);
+    TankModel::InputVector u(TEST_INLET_FLOW, TEST_VALVE_POSITION);
+
+    double t = 0.0;
+    bench::StepCounters counters(state);
+    for (auto _ : state) {
+        x = stepper.step(t, TEST_DT, x, u,
+                         [&model](double, const TankModel::StateVector &y,
+                                  const TankModel::InputVector &v) {
+                             return model.derivatives(y, v);
+                         });
+        t += TEST_DT;
+        benchmark::DoNotOptimize(x);
+    }
+    counters.report(1);
+}
+BENCHMARK(BM_FixedStepperStep);
+
+void BM_PIDCompute(benchmark::State &state) {
+    PIDController pid(PIDController::Gains{-1.0, 10.0, 1.0}, 0.5, 0.0, 1.0, 10.0);
+    double error = 0.01;
+
+    bench::StepCounters counters(state);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(error);
+        double output = pid.compute(error, 0.001, TEST_DT);
+        benchmark::DoNotOptimize(output);
+        error = -error;  // Stay unsaturated so the integral path is taken
+    }
+    counters.report(1);
+}
+BENCHMARK(BM_PIDCompute);
+
+// N loops as a std::vector<PIDController> with per-loop gather/scatter, the
+// pre-bank Simulator pattern; time_per_step is per loop update
+void BM_PIDComputeLoops(benchmark::State &state) {
+    const auto loops = static_cast<Eigen::Index>(state.range(0));
+    std::vector<PIDController> controllers(
+        loops, PIDController(PIDController::Gains{-1.0, 10.0, 1.0}, 0.5, 0.0, 1.0, 10.0));
+    std::vector<double> previousErrors(loops, 0.0);
+    Eigen::VectorXd measured = Eigen::VectorXd::Constant(loops, 1.0);
+    Eigen::VectorXd outputs = Eigen::VectorXd::Zero(loops);
+    double offset = 0.01;
+
+    bench::StepCounters counters(state);
+    for (auto _ : state) {
+        for (Eigen::Index i = 0; i < loops; ++i) {
+            const double error = 1.0 - measured(i);
+            outputs(i) = controllers[i].compute(error, (error - previousErrors[i]) / TEST_DT,
+                                                TEST_DT);
+            previousErrors[i] = error;
+        }
+        benchmark::DoNotOptimize(outputs.data());
+        offset = -offset;
+        measured(0) += offset;
+    }
+    counters.report(static_cast<double>(loops));
+}
+BENCHMARK(BM_PIDComputeLoops)->ArgName("loops")->RangeMultiplier(4)->Range(1, 1024);
+
+// The same N loops in a PIDControllerBank
+void BM_PIDBankComputeAll(benchmark::State &state) {
+    const auto loops = static_cast<Eigen::Index>(state.range(0));
+    PIDControllerBank bank;
+    for (Eigen::Index i = 0; i < loops; ++i) {
+        bank.addLoop(PIDController::Gains{-1.0, 10.0, 1.0}, 0.5, 0.0, 1.0, 10.0, i, i, 1.0);
+    }
+    Eigen::VectorXd measured = Eigen::VectorXd::Constant(loops, 1.0);
+    Eigen::VectorXd outputs = Eigen::VectorXd::Zero(loops);
+    double offset = 0.01;
+
+    bench::StepCounters counters(state);
+    for (auto _ : state) {
+        bank.computeAll(TEST_DT, measured, outputs);
+        benchmark::DoNotOptimize(outputs.data());
+        offset = -offset;
+        measured(0) += offset;
+    }
+    counters.report(static_cast<double>(loops));
+}
+BENCHMARK(BM_PIDBankComputeAll)->ArgName("loops")->RangeMultiplier(4)->Range(1, 1024);
+
+}  // namespace
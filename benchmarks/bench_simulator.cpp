@@ -0,0 +1,293 @@
+/**
+ * @file bench_simulator.cpp
+ * @brief End-to-end step costs: Simulator (per integrator and controller
+ *        count), the bulk run paths, BatchSimulator (per lane precision),
+ *        NetworkSimulator and gradient tuning.
+ */
+
+#include <benchmark/benchmark.h>
+#include <Eigen/Dense>
+
+#include "batch_simulator.h"
+#include "bench_support.h"
+#include "constants.h"
+#include "forecast.h"
+#include "gain_tuner.h"
+#include "network_simulator.h"
+#include "parameter_sweep.h"
+#include "plant_network.h"
+#include "simulator.h"
+#include "trajectory.h"
+
+using namespace tank_sim;
+using namespace tank_sim::constants;
+
+namespace {
+
+// Benchmark argument -> integrator, in enum order
+Simulator::Integrator integratorArg(int64_t arg) {
+    switch (arg) {
+    case 1:
+        return Simulator::Integrator::GslRK4;
+    case 2:
+        return Simulator::Integrator::AdaptiveRKF45;
+    case 3:
+        return Simulator::Integrator::Rosenbrock;
+    case 4:
+        return Simulator::Integrator::ExactZOH;
+    default:
+        return Simulator::Integrator::RK4;
+    }
+}
+
+// Simulator::step() with 0..N level controllers (0 = open loop)
+void BM_SimulatorStep(benchmark::State &state) {
+    Simulator sim(bench::steadyStateConfig(static_cast<int>(state.range(0))));
+
+    bench::StepCounters counters(state);
+    for (auto _ : state) {
+        sim.step();
+    }
+    benchmark::DoNotOptimize(sim.getTime());
+    counters.report(1);
+}
+BENCHMARK(BM_SimulatorStep)->ArgName("controllers")->DenseRange(0, 4);
+
+// Simulator::step() for each integrator, one controller.
+// Arg: 0 = RK4, 1 = GslRK4, 2 = AdaptiveRKF45, 3 = Rosenbrock, 4 = ExactZOH
+void BM_SimulatorStepIntegrator(benchmark::State &state) {
+    Simulator::Config config = bench::steadyStateConfig(1);
+    config.integrator = integratorArg(state.range(0));
+    // Keep the loop moving so the adaptive integrator has work to do
+    config.controllerConfig[0].initialSetpoint = 3.0;
+    Simulator sim(config);
+
+    bench::StepCounters counters(state);
+    for (auto _ : state) {
+        sim.step();
+    }
+    benchmark::DoNotOptimize(sim.getTime());
+    counters.report(1);
+}
+BENCHMARK(BM_SimulatorStepIntegrator)->ArgName("integrator")->DenseRange(0, 4);
+
+// Building a simulator from a config: the constructor, or reinit() of one
+// that already exists (fork/ensemble workloads). time_per_step and
+// allocs_per_step are per construction. Args: integrator (0 = RK4,
+// 1 = GslRK4), reinit (0 = construct, 1 = reinit)
+void BM_SimulatorConstruct(benchmark::State &state) {
+    Simulator::Config config = bench::steadyStateConfig(1);
+    config.integrator = integratorArg(state.range(0));
+    config.disturbances = {Disturbance::brownian(INPUT_INDEX_INLET_FLOW, 0.01)};
+    Simulator sim(config);
+
+    bench::StepCounters counters(state);
+    for (auto _ : state) {
+        if (state.range(1) == 0) {
+            Simulator fresh(config);
+            benchmark::DoNotOptimize(&fresh);
+        } else {
+            sim.reinit(config);
+            benchmark::DoNotOptimize(&sim);
+        }
+    }
+    counters.report(1);
+}
+BENCHMARK(BM_SimulatorConstruct)
+    ->ArgNames({"integrator", "reinit"})
+    ->ArgsProduct({{0, 1}, {0, 1}});
+
+// Simulator::step() with per-step history recording enabled
+void BM_SimulatorStepWithHistory(benchmark::State &state) {
+    Simulator::Config config = bench::steadyStateConfig(1);
+    config.historyCapacity = 1 << 16;
+    config.historyLevels = {{60, 1440}, {3600, 720}};
+    Simulator sim(config);
+
+    bench::StepCounters counters(state);
+    for (auto _ : state) {
+        sim.step();
+    }
+    counters.report(1);
+}
+BENCHMARK(BM_SimulatorStepWithHistory);
+
+// Bulk run(n) into a preallocated Trajectory. Arg: steps per call
+void BM_SimulatorRunTrajectory(benchmark::State &state) {
+    const int steps = static_cast<int>(state.range(0));
+    Simulator sim(bench::steadyStateConfig(1));
+    Trajectory trajectory = sim.makeTrajectory(steps);
+
+    bench::StepCounters counters(state);
+    for (auto _ : state) {
+        trajectory.clear();
+        sim.run(steps, trajectory);
+    }
+    benchmark::DoNotOptimize(trajectory.time.data());
+    counters.report(steps);
+}
+BENCHMARK(BM_SimulatorRunTrajectory)->ArgName("steps")->Arg(100)->Arg(10000);
+
+// Bulk run(n) without recording. Arg: steps per call
+void BM_SimulatorRun(benchmark::State &state) {
+    const int steps = static_cast<int>(state.range(0));
+    Simulator sim(bench::steadyStateConfig(1));
+
+    bench::StepCounters counters(state);
+    for (auto _ : state) {
+        sim.run(steps);
+    }
+    benchmark::DoNotOptimize(sim.getTime());
+    counters.report(steps);
+}
+BENCHMARK(BM_SimulatorRun)->ArgName("steps")->Arg(100)->Arg(10000);
+
+// BatchSimulator::step(); time_per_step is per lane-step. Arg: lanes
+void BM_BatchSimulatorStep(benchmark::State &state) {
+    const int lanes = static_cast<int>(state.range(0));
+    BatchSimulator batch(bench::steadyStateConfig(1), lanes);
+    batch.setSetpoints(BatchSimulator::LaneArray::LinSpaced(lanes, 2.0, 3.5));
+
+    bench::StepCounters counters(state);
+    for (auto _ : state) {
+        batch.step();
+    }
+    benchmark::DoNotOptimize(batch.getLevels().data());
+    counters.report(lanes);
+}
+BENCHMARK(BM_BatchSimulatorStep)->ArgName("lanes")->RangeMultiplier(8)->Range(1, 32768);
+
+// BatchSimulator::step() on 4096 lanes per valve characteristic, in enum
+// order; the per-step table lookup is the only extra work.
+// time_per_step is per lane-step. Arg: characteristic
+void BM_BatchSimulatorStepValve(benchmark::State &state) {
+    const int lanes = 4096;
+    Simulator::Config config = bench::steadyStateConfig(1);
+    config.params.valve_characteristic = static_cast<ValveCharacteristic>(state.range(0));
+    BatchSimulator batch(config, lanes);
+    batch.setSetpoints(BatchSimulator::LaneArray::LinSpaced(lanes, 2.0, 3.5));
+
+    bench::StepCounters counters(state);
+    for (auto _ : state) {
+        batch.step();
+    }
+    benchmark::DoNotOptimize(batch.getLevels().data());
+    counters.report(lanes);
+}
+BENCHMARK(BM_BatchSimulatorStepValve)->ArgName("characteristic")->DenseRange(0, 2);
+
+template <typename Batch>
+void runBatchSteps(benchmark::State &state, int lanes) {
+    Batch batch(bench::steadyStateConfig(1), lanes);
+    batch.setSetpoints(Batch::LaneArray::LinSpaced(lanes, 2.0, 3.5));
+
+    bench::StepCounters counters(state);
+    for (auto _ : state) {
+        batch.step();
+    }
+    benchmark::DoNotOptimize(batch.getLevels().data());
+    counters.report(lanes);
+}
+
+// BatchSimulator::step() per lane precision: double (BatchSimulator), float
+// (FloatBatchSimulator) and float with a double integral
+// (MixedBatchSimulator). time_per_step is per lane-step.
+// Args: precision (0 = double, 1 = float, 2 = mixed), lanes
+void BM_BatchSimulatorStepPrecision(benchmark::State &state) {
+    const int lanes = static_cast<int>(state.range(1));
+    switch (state.range(0)) {
+    case 0:
+        runBatchSteps<BatchSimulator>(state, lanes);
+        break;
+    case 1:
+        runBatchSteps<FloatBatchSimulator>(state, lanes);
+        break;
+    default:
+        runBatchSteps<MixedBatchSimulator>(state, lanes);
+        break;
+    }
+}
+BENCHMARK(BM_BatchSimulatorStepPrecision)->ArgNames({"precision", "lanes"})
+    ->ArgsProduct({{0, 1, 2}, {4096, 32768}});
+
+// Forecaster::run() over a 10-minute horizon (600 steps at dt = 1 s), one
+// setpoint step per candidate; the predictive display needs < 10 ms at 256.
+// time_per_step is per candidate-step. Arg: candidates
+void BM_Forecast(benchmark::State &state) {
+    const int candidates = static_cast<int>(state.range(0));
+    const Simulator::Config config = bench::steadyStateConfig(1);
+    Simulator live(config);
+    live.run(100);
+    const Simulator::Snapshot snapshot = live.save();
+    Forecaster forecaster(config, Forecaster::Options{600, 10});
+    const Eigen::MatrixXd setpoints =
+        Eigen::VectorXd::LinSpaced(candidates, 1.0, 4.0);
+    const Eigen::MatrixXd inletFlows;
+
+    bench::StepCounters counters(state);
+    for (auto _ : state) {
+        Forecaster::Result result = forecaster.run(snapshot, setpoints, inletFlows);
+        benchmark::DoNotOptimize(result.levels.data());
+    }
+    counters.report(600.0 * candidates);
+}
+BENCHMARK(BM_Forecast)->ArgName("candidates")->RangeMultiplier(4)->Range(16, 1024)
+    ->Unit(benchmark::kMillisecond);
+
+// One 600-step tuning case: a single-threaded ParameterSweep case (value
+// only) against GainTuner::evaluate() (value and three-gain gradient).
+// time_per_step is per closed-loop step. Arg: dual (0 = sweep, 1 = tuner)
+void BM_GainTunerEvaluate(benchmark::State &state) {
+    const Simulator::Config config = bench::steadyStateConfig(1);
+    const PIDController::Gains gains{-1.0, 50.0, 2.0};
+    ParameterSweep::Options sweepOptions;
+    sweepOptions.steps = 600;
+    sweepOptions.setpoint = 3.0;
+    sweepOptions.threads = 1;
+    const ParameterSweep sweep(config, sweepOptions);
+    GainTuner::Options tunerOptions;
+    tunerOptions.steps = 600;
+    tunerOptions.setpoint = 3.0;
+    const GainTuner tuner(config, tunerOptions);
+
+    bench::StepCounters counters(state);
+    for (auto _ : state) {
+        if (state.range(0) == 0) {
+            benchmark::DoNotOptimize(sweep.run({gains})[0].iae);
+        } else {
+            benchmark::DoNotOptimize(tuner.evaluate(gains).gradient.data());
+        }
+    }
+    counters.report(600.0);
+}
+BENCHMARK(BM_GainTunerEvaluate)->ArgName("dual")->Arg(0)->Arg(1)
+    ->Unit(benchmark::kMicrosecond);
+
+// NetworkSimulator::step() on an open-loop cascade; time_per_step is per
+// tank-step. Args: tanks, integrator (0 = RK4, 3 = Rosenbrock)
+void BM_NetworkSimulatorStep(benchmark::State &state) {
+    const int tanks = static_cast<int>(state.range(0));
+    NetworkSimulator::Config config;
+    config.network = PlantNetwork::cascade(
+        tanks, TankModel::Parameters{DEFAULT_TANK_AREA, DEFAULT_VALVE_COEFFICIENT,
+                                     TANK_MAX_HEIGHT});
+    config.initialState = Eigen::VectorXd::Constant(tanks, TANK_NOMINAL_HEIGHT);
+    config.initialInputs =
+        Eigen::VectorXd::Constant(config.network.inputCount, TEST_VALVE_POSITION);
+    config.initialInputs(0) = TEST_INLET_FLOW;
+    config.dt = TEST_DT;
+    config.integrator = integratorArg(state.range(1));
+    NetworkSimulator sim(config);
+
+    bench::StepCounters counters(state);
+    for (auto _ : state) {
+        sim.step();
+    }
+    benchmark::DoNotOptimize(sim.getState().data());
+    counters.report(tanks);
+}
+BENCHMARK(BM_NetworkSimulatorStep)
+    ->ArgNames({"tanks", "integrator"})
+    ->ArgsProduct({{10, 100, 1000}, {0, 3}});
+
+}  // namespace
@@ -0,0 +1,125 @@
+#include "bench_support.h"
+
+#include <atomic>
+#include <cerrno>
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+std::atomic<std::uint64_t> allocations{0};
+
+}  // namespace
+
+#if defined(__GLIBC__)
+
+// Eigen's dynamic storage calls malloc directly rather than operator new, so
+// on glibc count at the malloc level (operator new is built on malloc there)
+extern "C" {
+void *__libc_malloc(std::size_t size);
+void *__libc_calloc(std::size_t count, std::size_t size);
+void *__libc_realloc(void *p, std::size_t size);
+void *__libc_memalign(std::size_t alignment, std::size_t size);
+
+void *malloc(std::size_t size) noexcept {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    return __libc_malloc(size);
+}
+
+void *calloc(std::size_t count, std::size_t size) noexcept {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    return __libc_calloc(count, size);
+}
+
+void *realloc(void *p, std::size_t size) noexcept {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    return __libc_realloc(p, size);
+}
+
+int posix_memalign(void **out, std::size_t alignment, std::size_t size) noexcept {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    void *p = __libc_memalign(alignment, size);
+    if (p == nullptr) {
+        return ENOMEM;
+    }
+    *out = p;
+    return 0;
+}
+}
+
+#else
+
+// Elsewhere only operator new is counted; Eigen's dynamic allocations are
+// missed, so allocs_per_step is a lower bound
+namespace {
+
+void *countedAllocate(std::size_t size) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void *p = std::malloc(size == 0 ? 1 : size)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+}  // namespace
+
+void *operator new(std::size_t size) { return countedAllocate(size); }
+void *operator new[](std::size_t size) { return countedAllocate(size); }
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete[](void *p) noexcept { std::free(p); }
+void operator delete(void *p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void *p, std::size_t) noexcept { std::free(p); }
+
+#endif
+
+namespace tank_sim::bench {
+
+std::uint64_t allocationCount() {
+    return allocations.load(std::memory_order_relaxed);
+}
+
+StepCounters::StepCounters(benchmark::State &state)
+    : state_(state), startAllocations_(allocationCount()) {}
+
+void StepCounters::report(double stepsPerIteration) {
+    const double steps =
+        stepsPerIteration * static_cast<double>(state_.iterations());
+    const double allocated =
+        static_cast<double>(allocationCount() - startAllocations_);
+
+    // An inverted rate counter is elapsed seconds per step
+    state_.counters["time_per_step"] = benchmark::Counter(
+        steps, benchmark::Counter::kIsRate | benchmark::Counter::kInvert);
+    state_.counters["allocs_per_step"] = steps > 0.0 ? allocated / steps : 0.0;
+    state_.SetItemsProcessed(static_cast<int64_t>(steps));
+}
+
+Simulator::ControllerConfig levelController(double setpoint) {
+    Simulator::ControllerConfig ctrl;
+    ctrl.gains = PIDController::Gains{-1.0, 10.0, 0.0};
+    ctrl.bias = 0.5;
+    ctrl.minOutputLimit = 0.0;
+    ctrl.maxOutputLimit = 1.0;
+    ctrl.maxIntegralAccumulation = 10.0;
+    ctrl.measuredIndex = 0;
+    ctrl.outputIndex = constants::INPUT_INDEX_VALVE_POSITION;
+    ctrl.initialSetpoint = setpoint;
+    return ctrl;
+}
+
+Simulator::Config steadyStateConfig(int controllerCount) {
+    Simulator::Config config;
+    config.params = TankModel::Parameters{constants::DEFAULT_TANK_AREA,
+                                          constants::DEFAULT_VALVE_COEFFICIENT,
+                                          constants::TANK_MAX_HEIGHT};
+    config.initialState = Eigen::VectorXd::Constant(1, constants::TANK_NOMINAL_HEIGHT);
+    config.initialInputs = Eigen::VectorXd(2);
+    config.initialInputs << constants::TEST_INLET_FLOW, constants::TEST_VALVE_POSITION;
+    config.dt = constants::TEST_DT;
+    for (int i = 0; i < controllerCount; ++i) {
+        config.controllerConfig.push_back(levelController());
+    }
+    return config;
+}
+
+}  // namespace tank_sim::bench
@@ -0,0 +1,50 @@
+#ifndef TANK_SIM_BENCH_SUPPORT_H
+#define TANK_SIM_BENCH_SUPPORT_H
+
+#include <benchmark/benchmark.h>
+#include <cstdint>
+
+#include "constants.h"
+#include "simulator.h"
+
+namespace tank_sim::bench {
+
+/**
+ * @brief Number of global operator new calls so far in this process.
+ *
+ * bench_support.cpp replaces the global allocation functions with counting
+ * wrappers, so every heap allocation made by the library is seen here.
+ */
+std::uint64_t allocationCount();
+
+/**
+ * @brief Counts allocations made while a benchmark's timing loop runs.
+ *
+ * Construct it just before `for (auto _ : state)` and call report() after
+ * the loop with the number of simulation steps one iteration performs. It
+ * sets two counters, which appear in the console table and the JSON output:
+ *
+ *   time_per_step    seconds per step (per lane- or tank-step for batches
+ *                    and networks), shown in ns in the console table
+ *   allocs_per_step  heap allocations per step
+ */
+class StepCounters {
+public:
+    explicit StepCounters(benchmark::State &state);
+
+    void report(double stepsPerIteration);
+
+private:
+    benchmark::State &state_;
+    std::uint64_t startAllocations_;
+};
+
+/// The steady-state level loop used throughout the tests (Kc < 0)
+Simulator::ControllerConfig levelController(double setpoint = constants::TANK_NOMINAL_HEIGHT);
+
+/// Single tank at steady state with the given number of level controllers
+Simulator::Config steadyStateConfig(int controllerCount);
+
+}  // namespace tank_sim::bench
+
+#endif  // TANK_SIM_BENCH_SUPPORT_H
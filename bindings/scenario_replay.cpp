@@ -0,0 +1,141 @@
+#include "scenario_replay.h"
+#include "trajectory_log.h"
+#include <chrono>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace tank_sim;
+
+namespace {
+
+// Same plant and loop as tank_sim.create_default_config(): 120 m² tank at
+// steady state, reverse-acting level controller on the outlet valve
+Simulator::Config defaultConfig() {
+  Simulator::ControllerConfig controller;
+  controller.gains = PIDController::Gains{-1.0, 10.0, 1.0};
+  controller.bias = 0.5;
+  controller.minOutputLimit = 0.0;
+  controller.maxOutputLimit = 1.0;
+  controller.maxIntegralAccumulation = 10.0;
+  controller.measuredIndex = 0;
+  controller.outputIndex = 1;
+  controller.initialSetpoint = 2.5;
+
+  Simulator::Config config;
+  config.params.area = 120.0;
+  config.params.k_v = 1.2649;
+  config.params.max_height = 5.0;
+  config.controllerConfig.push_back(controller);
+  config.initialState = Eigen::VectorXd::Constant(1, 2.5);
+  config.initialInputs = Eigen::VectorXd(2);
+  config.initialInputs << 1.0, 0.5;
+  config.dt = 1.0;
+  return config;
+}
+
+// Golden log directory of a scenario: <golden_dir>/<scenario file stem>
+std::string goldenPath(const std::string &goldenDir, const std::string &scenario) {
+  return (std::filesystem::path(goldenDir) /
+          std::filesystem::path(scenario).stem()).string();
+}
+
+int usage() {
+  std::cerr << "Usage: scenario_replay record|check <golden_dir> <scenario>...\n"
+            << "  record  replay each scenario and write its golden trajectory log\n"
+            << "  check   replay each scenario and compare it to its golden log\n"
+            << "Options (before the mode): --threads N, --atol X, --rtol X\n";
+  return 2;
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  ScenarioReplay::Options options;
+  int arg = 1;
+  try {
+    for (; arg + 1 < argc && std::string(argv[arg]).rfind("--", 0) == 0; arg += 2) {
+      const std::string flag = argv[arg];
+      if (flag == "--threads") {
+        options.threads = std::stoi(argv[arg + 1]);
+      } else if (flag == "--atol") {
+        options.tolerance.absolute = std::stod(argv[arg + 1]);
+      } else if (flag == "--rtol") {
+        options.tolerance.relative = std::stod(argv[arg + 1]);
+      } else {
+        return usage();
+      }
+    }
+  } catch (const std::exception &) {
+    return usage();
+  }
+  if (argc - arg < 3) {
+    return usage();
+  }
+  const std::string mode = argv[arg];
+  const std::string goldenDir = argv[arg + 1];
+  const std::vector<std::string> files(argv + arg + 2, argv + argc);
+  if (mode != "record" && mode != "check") {
+    return usage();
+  }
+
+  try {
+    std::vector<Scenario> scenarios;
+    for (const std::string &file : files) {
+      scenarios.push_back(Scenario::load(file));
+    }
+    const ScenarioReplay replay(defaultConfig(), options);
+    const auto start = std::chrono::steady_clock::now();
+
+    if (mode == "record") {
+      const std::vector<Trajectory> trajectories = replay.replayAll(scenarios);
+      std::filesystem::create_directories(goldenDir);
+      for (size_t i = 0; i < files.size(); ++i) {
+        const std::string path = goldenPath(goldenDir, files[i]);
+        std::filesystem::remove_all(path);  // A new golden replaces the old
+        const Trajectory &trajectory = trajectories[i];
+        TrajectoryLogWriter writer(path, trajectory.state.rows(),
+                                   trajectory.inputs.rows(),
+                                   trajectory.setpoint.rows());
+        writer.append(trajectory);
+        writer.close();
+        std::cout << "recorded " << path << " (" << trajectory.size()
+                  << " samples)\n";
+      }
+      return 0;
+    }
+
+    std::vector<Trajectory> goldens;
+    for (const std::string &file : files) {
+      const TrajectoryLogReader reader(goldenPath(goldenDir, file));
+      goldens.push_back(reader.read(0, reader.size()));
+    }
+    const std::vector<ScenarioReplay::Result> results =
+        replay.verify(scenarios, goldens);
+    const double seconds = std::chrono::duration<double>(
+                               std::chrono::steady_clock::now() - start)
+                               .count();
+
+    int failed = 0;
+    std::cout << std::scientific << std::setprecision(3);
+    for (size_t i = 0; i < results.size(); ++i) {
+      const ScenarioReplay::Result &result = results[i];
+      if (result.passed) {
+        continue;
+      }
+      ++failed;
+      std::cout << "FAIL " << files[i] << ": " << result.signal
+                << " at sample " << result.firstFailure
+                << ", max error " << result.maxError << "\n";
+    }
+    std::cout << std::defaultfloat << results.size() - failed << "/"
+              << results.size() << " scenarios match their goldens ("
+              << seconds << " s, " << replay.getThreadCount() << " thread(s))\n";
+    return failed == 0 ? 0 : 1;
+  } catch (const std::exception &e) {
+    std::cerr << "scenario_replay: " << e.what() << "\n";
+    return 2;
+  }
+}
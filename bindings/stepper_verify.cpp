@@ -99,6 +99,27 @@ int main() {
   std::cout << "Relative difference:              " 
             << std::abs(actual_ratio - expected_ratio) / expected_ratio * 100 << "%\n\n";
 
+  // ========== Test 3: Native backend vs GSL ==========
+  std::cout << "Test 3: Native RK4 backend, dt = 0.1\n";
+  std::cout << "-----------------------------------------\n";
+
+  Stepper stepper3(1, 1, Stepper::Backend::Native);
+  Eigen::VectorXd state3(1);
+  state3(0) = y0;
+
+  double t3 = 0.0;
+  for (int i = 0; i < steps1; ++i) {
+    state3 = stepper3.step(t3, dt1, state3, dummy_input, exponential_decay_derivative);
+    t3 += dt1;
+  }
+
+  double error3 = std::abs(state3(0) - analytical_final);
+  double backend_diff = std::abs(state3(0) - state1(0));
+  std::cout << "Final state at t=1.0: " << state3(0) << "\n";
+  std::cout << "GSL result (Test 1):  " << state1(0) << "\n";
+  std::cout << "Absolute error:       " << error3 << "\n";
+  std::cout << "Native - GSL:         " << backend_diff << "\n\n";
+
   // ========== Summary ==========
   std::cout << "========================================\n";
   std::cout << "SUMMARY\n";
@@ -107,12 +128,14 @@ int main() {
   bool error1_ok = error1 < 1e-5;
   bool error2_ok = error2 < 1e-7;
   bool order_ok = std::abs(actual_ratio - expected_ratio) / expected_ratio < 0.1;
+  bool native_ok = error3 < 1e-5 && backend_diff < 1e-5;
   
   std::cout << "dt=0.1 error < 1e-5:      " << (error1_ok ? "✓ PASS" : "✗ FAIL") << "\n";
   std::cout << "dt=0.05 error < 1e-7:     " << (error2_ok ? "✓ PASS" : "✗ FAIL") << "\n";
   std::cout << "Order ratio within 10%:   " << (order_ok ? "✓ PASS" : "✗ FAIL") << "\n";
+  std::cout << "Native matches GSL:       " << (native_ok ? "✓ PASS" : "✗ FAIL") << "\n";
 
-  if (error1_ok && error2_ok && order_ok) {
+  if (error1_ok && error2_ok && order_ok && native_ok) {
     std::cout << "\n✓ All verification tests PASSED\n";
     return 0;
   } else {
@@ -14,22 +14,22 @@ const MAX_CHART_POINTS = 500;
 
 /**
  * TrendsView component displays historical simulation state updates
- * as interactive charts with configurable time ranges (1 min to 2 hours).
+ * as interactive charts with configurable time ranges (1 min to 7 days).
  *
- * Fetches historical data from the backend via useHistory hook
- * and displays three charts:
+ * Fetches a server-side downsampled trend (at most MAX_CHART_POINTS
+ * points) via useHistory hook and displays three charts:
  * - Tank level vs setpoint over time
  * - Inlet and outlet flow rates over time
  * - Controller output (valve position) over time
  *
  * Features a time range selector to control how much historical data
- * to display (1 min, 5 min, 30 min, 1 hr, or 2 hr).
+ * to display (1 min, 5 min, 30 min, 1 hr, 2 hr, 24 hr, or 7 days).
  *
  * Handles loading, error, and empty states appropriately.
  */
 export function TrendsView() {
   const [duration, setDuration] = useState(3600); // Default: 1 hour
-  const { history, loading, error } = useHistory(duration);
+  const { history, bucketSeconds, loading, error } = useHistory(duration, MAX_CHART_POINTS);
   const { state } = useSimulation();
   const [chartData, setChartData] = useState<SimulationState[]>([]);
   const latestTimeRef = useRef<number>(-Infinity);
@@ -40,6 +40,8 @@ export function TrendsView() {
     { label: "30 min", value: 1800 },
     { label: "1 hr", value: 3600 },
     { label: "2 hr", value: 7200 },
+    { label: "24 hr", value: 86400 },
+    { label: "7 days", value: 604800 },
   ];
 
   // Initialize chartData with historical data when it loads
@@ -50,50 +52,27 @@ export function TrendsView() {
     }
   }, [history, loading]);
 
-  // Append real-time WebSocket updates to chartData
+  // Append real-time WebSocket updates to chartData, at most one point per
+  // bucket width so live points match the resolution of the fetched trend
   useEffect(() => {
-    if (state && state.time > latestTimeRef.current) {
+    if (state && state.time >= latestTimeRef.current + bucketSeconds) {
       latestTimeRef.current = state.time;
       setChartData((prev) => {
         if (prev.length === 0) return prev;
-        const updated = [...prev, state];
-        // Limit to last 7200 entries (2 hours at 1Hz)
-        if (updated.length > 7200) {
-          return updated.slice(-7200);
-        }
-        return updated;
+        // Drop points that have scrolled out of the selected range
+        const start = state.time - duration;
+        const firstInRange = prev.findIndex((point) => point.time >= start);
+        return [...(firstInRange === -1 ? [] : prev.slice(firstInRange)), state];
       });
     }
-  }, [state]);
+  }, [state, bucketSeconds, duration]);
 
-  // Stable downsampling using FIXED decimation factor.
-  // Key: Use a constant decimation regardless of current data length.
-  // This prevents previously rendered points from shifting positions.
-  const displayData = useMemo(() => {
-    if (chartData.length <= MAX_CHART_POINTS) {
-      return chartData;
-    }
-
-    // Fixed decimation factor: designed for max buffer size (7200 points)
-    // 7200 / 500 = ~14, so we take every 14th point
-    // This factor remains constant, ensuring stable rendering
-    const DECIMATION = 14;
-
-    const result: SimulationState[] = [];
-
-    // Take every DECIMATION-th point starting from index 0
-    for (let i = 0; i < chartData.length; i += DECIMATION) {
-      result.push(chartData[i]);
-    }
-
-    // Always include the very last point for current state accuracy
-    const lastPoint = chartData[chartData.length - 1];
-    if (result[result.length - 1] !== lastPoint) {
-      result.push(lastPoint);
-    }
-
-    return result;
-  }, [chartData]);
+  // The server already bounds the trend to MAX_CHART_POINTS; this only
+  // guards against live appends outpacing the range trimming above
+  const displayData = useMemo(
+    () => (chartData.length <= MAX_CHART_POINTS ? chartData : chartData.slice(-MAX_CHART_POINTS)),
+    [chartData],
+  );
 
   return (
     <div className="w-full h-full flex flex-col">
@@ -1,14 +1,15 @@
 "use client";
 
 import { useState, useEffect, useCallback } from "react";
-import { SimulationState } from "../lib/types";
+import { SimulationState, TrendField, TrendResponse } from "../lib/types";
 
 const MIN_DURATION = 1;
-const MAX_DURATION = 7200;
+const MAX_DURATION = 604800; // 7 days
 const DEFAULT_DURATION = 3600;
+const DEFAULT_MAX_POINTS = 500;
 
 /**
- * Clamps duration to valid range (1-7200 seconds).
+ * Clamps duration to valid range (1 second to 7 days).
  * Logs warning to console if clamping occurs.
  */
 function clampDuration(duration: number): number {
@@ -32,28 +33,52 @@ function clampDuration(duration: number): number {
   return duration;
 }
 
+/**
+ * Converts a columnar trend into one SimulationState per bucket, using
+ * the bucket means (and the time of each bucket's last sample).
+ */
+function trendToStates(trend: TrendResponse): SimulationState[] {
+  const fields = Object.keys(trend.mean) as TrendField[];
+  return trend.time.map((time, i) => {
+    const point = { time } as SimulationState;
+    for (const field of fields) {
+      point[field] = trend.mean[field][i];
+    }
+    return point;
+  });
+}
+
 /**
  * React hook that fetches and manages historical simulation data.
  *
- * Fetches data from /api/history endpoint with the specified duration.
- * Automatically refetches when duration changes.
+ * Fetches a downsampled trend from /api/history/trend, so the payload holds
+ * at most maxPoints entries whatever the duration. Short ranges come back
+ * as raw samples; longer ones as bucket means, with bucketSeconds giving
+ * the bucket width. Automatically refetches when duration or maxPoints
+ * changes.
  *
- * @param durationSeconds - Number of seconds of history to fetch (1-7200, default 3600)
- * @returns Object with history data, loading state, error state, and refetch function
+ * @param durationSeconds - Number of seconds of history to fetch (1 s to 7 days, default 3600)
+ * @param maxPoints - Upper bound on the number of points returned (default 500)
+ * @returns Object with history data, bucket width, loading state, error state, and refetch function
  *
  * @example
- * const { history, loading, error, refetch } = useHistory(1800);
+ * const { history, loading, error, refetch } = useHistory(86400);
  * if (loading) return <div>Loading...</div>;
  * if (error) return <div>Error: {error}</div>;
  * return <Chart data={history} />;
  */
-export function useHistory(durationSeconds: number = DEFAULT_DURATION): {
+export function useHistory(
+  durationSeconds: number = DEFAULT_DURATION,
+  maxPoints: number = DEFAULT_MAX_POINTS,
+): {
   history: SimulationState[];
+  bucketSeconds: number;
   loading: boolean;
   error: string | null;
   refetch: () => Promise<void>;
 } {
   const [history, setHistory] = useState<SimulationState[]>([]);
+  const [bucketSeconds, setBucketSeconds] = useState(1);
   const [loading, setLoading] = useState(true);
   const [error, setError] = useState<string | null>(null);
 
@@ -63,7 +88,7 @@ export function useHistory(durationSeconds: number = DEFAULT_DURATION): {
       setError(null);
 
       const validDuration = clampDuration(durationSeconds);
-      const url = `/api/history?duration=${validDuration}`;
+      const url = `/api/history/trend?duration=${validDuration}&points=${maxPoints}`;
 
       const response = await fetch(url);
 
@@ -74,12 +99,14 @@ export function useHistory(durationSeconds: number = DEFAULT_DURATION): {
 
       const data: unknown = await response.json();
 
-      // Validate that response is an array
-      if (!Array.isArray(data)) {
-        throw new Error("Invalid response format: expected array of SimulationState objects");
+      // Validate the columnar trend shape
+      const trend = data as TrendResponse;
+      if (typeof data !== "object" || data === null || !Array.isArray(trend.time) || !trend.mean) {
+        throw new Error("Invalid response format: expected a trend object");
       }
 
-      setHistory(data as SimulationState[]);
+      setHistory(trendToStates(trend));
+      setBucketSeconds(trend.bucket_seconds);
     } catch (e) {
       const errorMsg = e instanceof Error ? e.message : "Unknown error";
       console.error("Failed to fetch history:", e);
@@ -87,11 +114,11 @@ export function useHistory(durationSeconds: number = DEFAULT_DURATION): {
     } finally {
       setLoading(false);
     }
-  }, [durationSeconds]);
+  }, [durationSeconds, maxPoints]);
 
   useEffect(() => {
     fetchHistory();
-  }, [durationSeconds, fetchHistory]);
+  }, [durationSeconds, maxPoints, fetchHistory]);
 
-  return { history, loading, error, refetch: fetchHistory };
+  return { history, bucketSeconds, loading, error, refetch: fetchHistory };
 }
@@ -33,7 +33,8 @@ export function useWebSocket(): {
   // Effect: Initialize connection on mount, cleanup on unmount
   useEffect(() => {
     const url = process.env.NEXT_PUBLIC_WS_URL || "ws://localhost:8000/ws";
-    const client = new WebSocketClient(url);
+    // Binary state frames are ~3x smaller than JSON and skip JSON.parse
+    const client = new WebSocketClient(url, "binary");
     clientRef.current = client;
 
     const unsubConnect = client.on("connect", () => {
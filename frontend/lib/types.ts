@@ -49,6 +49,7 @@ export interface ConfigResponse {
   timestep: number;
   history_capacity: number;
   history_size: number;
+  max_trend_duration: number;
 }
 
 /**
@@ -56,6 +57,24 @@ export interface ConfigResponse {
  */
 export type HistoryPoint = SimulationState;
 
+/**
+ * Signals summarized by GET /api/history/trend (every state field but time)
+ */
+export type TrendField = Exclude<keyof SimulationState, "time">;
+
+/**
+ * Downsampled trend returned by GET /api/history/trend.
+ * Columnar: entry i of every array describes bucket i, oldest first.
+ */
+export interface TrendResponse {
+  duration: number;
+  bucket_seconds: number;
+  time: number[];
+  min: Record<TrendField, number[]>;
+  max: Record<TrendField, number[]>;
+  mean: Record<TrendField, number[]>;
+}
+
 /**
  * WebSocket message from client to server
  * Discriminated union for type-safe command handling
@@ -1,3 +1,5 @@
+import { SimulationState } from "./types";
+
 /**
  * WebSocket connection status type
  */
@@ -22,11 +24,68 @@ export type ConnectionCallback = () => void;
  */
 export type ErrorCallback = (error: Event) => void;
 
+/**
+ * Wire format for state broadcasts, negotiated per connection
+ */
+export type WireFormat = "json" | "binary";
+
+const FRAME_STATE = 1;
+const BINARY_VERSION = 1;
+
+/**
+ * Field order of a binary state frame; must match STATE_FIELDS in api/telemetry.py
+ */
+const STATE_FIELDS: (keyof SimulationState)[] = [
+  "time",
+  "tank_level",
+  "setpoint",
+  "error",
+  "inlet_flow",
+  "outlet_flow",
+  "valve_position",
+  "controller_output",
+];
+
+export const STATE_FRAME_SIZE = 8 + 8 * STATE_FIELDS.length;
+
+/**
+ * Decode a binary state frame into the same message shape as a JSON state update.
+ * Layout (little-endian): uint8 kind, uint8 version, uint16 reserved,
+ * uint32 sequence, then one float64 per STATE_FIELDS entry.
+ * @param buffer - Frame payload
+ * @returns State message, including the frame sequence number
+ * @throws Error if the frame size, kind, or version is not recognized
+ */
+export function decodeStateFrame(buffer: ArrayBuffer): {
+  type: "state";
+  sequence: number;
+  data: SimulationState;
+} {
+  if (buffer.byteLength !== STATE_FRAME_SIZE) {
+    throw new Error(
+      `State frame must be ${STATE_FRAME_SIZE} bytes, got ${buffer.byteLength}`,
+    );
+  }
+  const view = new DataView(buffer);
+  const kind = view.getUint8(0);
+  const version = view.getUint8(1);
+  if (kind !== FRAME_STATE || version !== BINARY_VERSION) {
+    throw new Error(`Unsupported frame kind ${kind} version ${version}`);
+  }
+
+  const data = {} as SimulationState;
+  STATE_FIELDS.forEach((field, i) => {
+    data[field] = view.getFloat64(8 + 8 * i, true);
+  });
+  return { type: "state", sequence: view.getUint32(4, true), data };
+}
+
 /**
  * WebSocket client for communicating with the Tank Dynamics backend
  */
 export class WebSocketClient {
   private url: string;
+  private format: WireFormat;
   private websocket: WebSocket | null = null;
   private connectionStatus: ConnectionStatus = "disconnected";
   private callbacks: {
@@ -49,9 +108,11 @@ export class WebSocketClient {
   /**
    * Create a WebSocket client
    * @param url - WebSocket endpoint URL
+   * @param format - Wire format for state updates; "binary" is smaller and cheaper to parse
    */
-  constructor(url: string) {
+  constructor(url: string, format: WireFormat = "json") {
     this.url = url;
+    this.format = format;
   }
 
   /**
@@ -73,7 +134,12 @@ export class WebSocketClient {
     try {
       this.manualDisconnect = false;
       this.connectionStatus = "connecting";
-      this.websocket = new WebSocket(this.url);
+      const url =
+        this.format === "json"
+          ? this.url
+          : `${this.url}${this.url.includes("?") ? "&" : "?"}format=${this.format}`;
+      this.websocket = new WebSocket(url);
+      this.websocket.binaryType = "arraybuffer";
 
       this.websocket.addEventListener("open", () => {
         this.connectionStatus = "connected";
@@ -83,10 +149,13 @@ export class WebSocketClient {
 
       this.websocket.addEventListener("message", (event: MessageEvent) => {
         try {
-          const data = JSON.parse(event.data);
+          const data =
+            event.data instanceof ArrayBuffer
+              ? decodeStateFrame(event.data)
+              : JSON.parse(event.data);
           this.callbacks.message.forEach((callback) => callback(data));
         } catch (error) {
-          console.error("Failed to parse WebSocket message:", error);
+          console.error("Failed to decode WebSocket message:", error);
         }
       });
 
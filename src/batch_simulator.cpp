@@ -0,0 +1,555 @@
+#include "batch_simulator.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+
+namespace tank_sim {
+
+namespace {
+
+std::vector<Simulator::Config> replicate(const Simulator::Config &config,
+                                         int laneCount) {
+  if (laneCount <= 0) {
+    throw std::invalid_argument("Lane count must be positive, got " +
+                                std::to_string(laneCount));
+  }
+  return std::vector<Simulator::Config>(static_cast<size_t>(laneCount), config);
+}
+
+double inverseOrZero(double tau) {
+  // Matches PIDController::compute(): tau_I = 0 disables integral action
+  return tau != 0.0 ? 1.0 / tau : 0.0;
+}
+
+template <typename Batch>
+PrecisionReport compare(BatchSimulator &baseline, Batch &reduced, int steps) {
+  PrecisionReport report;
+  report.lanes = baseline.getLaneCount();
+  report.steps = steps;
+
+  Eigen::ArrayXd error(report.lanes);
+  double squares = 0.0;
+  for (int k = 0; k < steps; ++k) {
+    baseline.step();
+    reduced.step();
+
+    error = (reduced.getLevels().template cast<double>() -
+             baseline.getLevels()).abs();
+    Eigen::Index lane = 0;
+    report.finalMaxLevelError = error.maxCoeff(&lane);
+    if (report.finalMaxLevelError > report.maxLevelError) {
+      report.maxLevelError = report.finalMaxLevelError;
+      report.worstLane = static_cast<int>(lane);
+    }
+    squares += error.square().sum();
+
+    if (baseline.hasController()) {
+      report.maxOutputError = std::max(
+          report.maxOutputError,
+          (reduced.getControllerOutputs().template cast<double>() -
+           baseline.getControllerOutputs()).abs().maxCoeff());
+      report.maxIntegralError = std::max(
+          report.maxIntegralError,
+          (reduced.getIntegralStates().template cast<double>() -
+           baseline.getIntegralStates()).abs().maxCoeff());
+    }
+  }
+  if (steps > 0) {
+    report.rmsLevelError = std::sqrt(
+        squares / (static_cast<double>(steps) * report.lanes));
+  }
+  return report;
+}
+
+void checkSteps(int steps) {
+  if (steps < 0) {
+    throw std::invalid_argument("Step count cannot be negative, got " +
+                                std::to_string(steps));
+  }
+}
+
+}  // namespace
+
+template <typename Scalar, typename Accumulator>
+BasicBatchSimulator<Scalar, Accumulator>::BasicBatchSimulator(
+    const Simulator::Config &config, int laneCount)
+    : BasicBatchSimulator(replicate(config, laneCount)) {
+  // Identical lanes get consecutive streams so their disturbances differ
+  for (int lane = 0; lane < laneCount; ++lane) {
+    streams(lane) = config.disturbanceStream + static_cast<std::uint32_t>(lane);
+  }
+}
+
+template <typename Scalar, typename Accumulator>
+BasicBatchSimulator<Scalar, Accumulator>::BasicBatchSimulator(
+    const std::vector<Simulator::Config> &configs)
+    : laneCount(static_cast<int>(configs.size())), dt(0.0), time(0.0),
+      stepCount(0), controlled(false), outputIndex(constants::INPUT_INDEX_VALVE_POSITION),
+      nonlinearValves(0) {
+  if (configs.empty()) {
+    throw std::invalid_argument("BatchSimulator requires at least one lane");
+  }
+
+  // Shared settings come from the first lane; loadLane() checks the rest
+  const Simulator::Config &first = configs.front();
+  dt = first.dt;
+  if (dt <= 0.0 || dt < constants::MIN_DT || dt > constants::MAX_DT) {
+    throw std::invalid_argument(
+        "dt must be positive and between " + std::to_string(constants::MIN_DT) +
+        " and " + std::to_string(constants::MAX_DT) + " seconds");
+  }
+  if (first.controllerConfig.size() > 1) {
+    throw std::invalid_argument(
+        "BatchSimulator supports at most one controller per lane, got " +
+        std::to_string(first.controllerConfig.size()));
+  }
+  controlled = !first.controllerConfig.empty();
+  if (controlled) {
+    outputIndex = first.controllerConfig.front().outputIndex;
+  }
+  disturbances = DisturbanceGenerator(first.disturbances, dt,
+                                      first.disturbanceSeed);
+  if (controlled) {
+    disturbances.validateInputs(constants::TANK_INPUT_SIZE, {outputIndex});
+  } else {
+    disturbances.validateInputs(constants::TANK_INPUT_SIZE, {});
+  }
+  streams.resize(laneCount);
+
+  level.resize(laneCount);
+  inputs.resize(laneCount, constants::TANK_INPUT_SIZE);
+  area.resize(laneCount);
+  valveCoefficient.resize(laneCount);
+  valveCurves.resize(laneCount);
+  valveOpening.resize(laneCount);
+  kc.setZero(laneCount);
+  inverseTauI.setZero(laneCount);
+  tauD.setZero(laneCount);
+  bias.setZero(laneCount);
+  minOutput.setZero(laneCount);
+  maxOutput.setZero(laneCount);
+  maxIntegral.setZero(laneCount);
+  integral.setZero(laneCount);
+  previousError.setZero(laneCount);
+  initialSetpoint.setZero(laneCount);
+
+  for (int lane = 0; lane < laneCount; ++lane) {
+    loadLane(lane, configs[static_cast<size_t>(lane)]);
+  }
+
+  initialLevel = level;
+  initialInputs = inputs;
+  setpoint = initialSetpoint;
+  workspace = Rk4Workspace<LaneArray>(laneCount);
+  unsaturatedOutput.resize(laneCount);
+}
+
+template <typename Scalar, typename Accumulator>
+void BasicBatchSimulator<Scalar, Accumulator>::loadLane(
+    int lane, const Simulator::Config &config) {
+  const std::string prefix = "Lane " + std::to_string(lane) + ": ";
+
+  if (config.initialState.size() != constants::TANK_STATE_SIZE ||
+      config.initialInputs.size() != constants::TANK_INPUT_SIZE) {
+    throw std::invalid_argument(
+        prefix + "initial state and inputs must have sizes " +
+        std::to_string(constants::TANK_STATE_SIZE) + " and " +
+        std::to_string(constants::TANK_INPUT_SIZE));
+  }
+  if (config.integrator != Simulator::Integrator::RK4 &&
+      config.integrator != Simulator::Integrator::GslRK4) {
+    throw std::invalid_argument(prefix +
+                                "BatchSimulator integrates with RK4 only");
+  }
+  if (config.dt != dt) {
+    throw std::invalid_argument(prefix + "dt " + std::to_string(config.dt) +
+                                " differs from the batch dt " +
+                                std::to_string(dt));
+  }
+  if (config.controllerConfig.size() != (controlled ? 1u : 0u)) {
+    throw std::invalid_argument(
+        prefix + "all lanes must have the same number of controllers");
+  }
+
+  if (config.disturbances != disturbances.getDisturbances() ||
+      config.disturbanceSeed != disturbances.getSeed()) {
+    throw std::invalid_argument(
+        prefix + "all lanes must have the same disturbances and seed");
+  }
+  streams(lane) = config.disturbanceStream;
+
+  setParameters(lane, config.params);
+  level(lane) = config.initialState(0);
+  inputs.row(lane) =
+      config.initialInputs.transpose().array().template cast<Scalar>();
+
+  if (!controlled) {
+    return;
+  }
+
+  const Simulator::ControllerConfig &ctrl = config.controllerConfig.front();
+  if (ctrl.measuredIndex != 0) {
+    throw std::invalid_argument(prefix +
+                                "controller must measure the level (index 0)");
+  }
+  if (ctrl.outputIndex < 0 || ctrl.outputIndex >= constants::TANK_INPUT_SIZE) {
+    throw std::invalid_argument(
+        prefix + "controller output_index " + std::to_string(ctrl.outputIndex) +
+        " is out of bounds for input vector of size " +
+        std::to_string(constants::TANK_INPUT_SIZE));
+  }
+  if (ctrl.outputIndex != outputIndex) {
+    throw std::invalid_argument(
+        prefix + "all lanes must drive the same output_index");
+  }
+
+  // Construct a scalar controller purely to reuse its parameter validation
+  PIDController validated(ctrl.gains, ctrl.bias, ctrl.minOutputLimit,
+                          ctrl.maxOutputLimit, ctrl.maxIntegralAccumulation);
+  static_cast<void>(validated);
+
+  setLaneGains(lane, ctrl.gains);
+  bias(lane) = ctrl.bias;
+  minOutput(lane) = ctrl.minOutputLimit;
+  maxOutput(lane) = ctrl.maxOutputLimit;
+  maxIntegral(lane) = ctrl.maxIntegralAccumulation;
+  initialSetpoint(lane) = ctrl.initialSetpoint;
+}
+
+template <typename Scalar, typename Accumulator>
+void BasicBatchSimulator<Scalar, Accumulator>::step() {
+  using constants::INPUT_INDEX_INLET_FLOW;
+  using constants::INPUT_INDEX_VALVE_POSITION;
+
+  // Step 0: Input disturbances for the period [time, time + dt), all lanes
+  if (!disturbances.empty()) {
+    disturbances.applyLanes(stepCount, time, streams, inputs);
+  }
+
+  // Step 1: Integrate all lanes with the shared RK4 kernel. Each stage is one
+  // array expression over N lanes: dh/dt = (q_in - k_v * f(x) * sqrt(h)) / A,
+  // with the outflow selected to zero for empty tanks (no branch per lane)
+  updateValveOpenings();
+  rk4Step(time, dt, level, inputs, workspace,
+          [this](double, const LaneArray &h, const InputArray &u,
+                 LaneArray &dhdt) {
+            dhdt = (u.col(INPUT_INDEX_INLET_FLOW) -
+                    (h > 0.0).select(valveCoefficient * valveOpening *
+                                         valveSqrt(h.max(0.0)),
+                                     0.0)) /
+                   area;
+          });
+
+  // Step 2: Advance simulation time
+  time += dt;
+  ++stepCount;
+
+  // Step 3: Update controllers for the NEXT step
+  if (controlled) {
+    updateControllers();
+  }
+}
+
+template <typename Scalar, typename Accumulator>
+void BasicBatchSimulator<Scalar, Accumulator>::updateValveOpenings() {
+  const auto position = inputs.col(constants::INPUT_INDEX_VALVE_POSITION);
+  if (nonlinearValves == 0) {
+    valveOpening = position;
+    return;
+  }
+  for (int lane = 0; lane < laneCount; ++lane) {
+    valveOpening(lane) = valveCurves[lane].opening(position(lane));
+  }
+}
+
+template <typename Scalar, typename Accumulator>
+void BasicBatchSimulator<Scalar, Accumulator>::updateControllers() {
+  // Vectorized PIDController::compute(); term order matches the scalar code.
+  // error = setpoint - level, error_dot = (error - previous_error) / dt.
+  // The casts are no-ops unless the integral is accumulated in double.
+  unsaturatedOutput =
+      bias + kc * ((setpoint - level) +
+                   inverseTauI * integral.template cast<Scalar>() +
+                   tauD * (((setpoint - level) - previousError) / dt));
+
+  // Clamp to the actuator limits
+  inputs.col(outputIndex) = unsaturatedOutput.max(minOutput).min(maxOutput);
+
+  // Anti-windup: hold the integral in saturated lanes, otherwise accumulate
+  // and clamp to +/- max_integral
+  integral = ((unsaturatedOutput < minOutput) ||
+              (unsaturatedOutput > maxOutput))
+                 .select(integral,
+                         (integral +
+                          (setpoint - level).template cast<Accumulator>() * dt)
+                             .max(-maxIntegral)
+                             .min(maxIntegral));
+
+  previousError = setpoint - level;
+}
+
+template <typename Scalar, typename Accumulator>
+void BasicBatchSimulator<Scalar, Accumulator>::run(int nSteps) {
+  if (nSteps < 0) {
+    throw std::invalid_argument("Step count cannot be negative, got " +
+                                std::to_string(nSteps));
+  }
+  for (int i = 0; i < nSteps; ++i) {
+    step();
+  }
+}
+
+template <typename Scalar, typename Accumulator>
+void BasicBatchSimulator<Scalar, Accumulator>::reset() {
+  time = 0.0;
+  stepCount = 0;
+  level = initialLevel;
+  inputs = initialInputs;
+  integral.setZero();
+  previousError.setZero();
+  setpoint = initialSetpoint;
+}
+
+template <typename Scalar, typename Accumulator>
+void BasicBatchSimulator<Scalar, Accumulator>::restore(
+    const Simulator::Snapshot &snapshot) {
+  if (snapshot.controllerCount != (controlled ? 1 : 0)) {
+    throw std::invalid_argument(
+        "Snapshot has " + std::to_string(snapshot.controllerCount) +
+        " controller(s) but the batch has " + std::to_string(controlled ? 1 : 0));
+  }
+  time = snapshot.time;
+  stepCount = snapshot.stepCount;
+  level.setConstant(snapshot.state[0]);
+  for (int j = 0; j < constants::TANK_INPUT_SIZE; ++j) {
+    inputs.col(j).setConstant(snapshot.inputs[j]);
+  }
+  if (!controlled) {
+    return;
+  }
+
+  const Simulator::Snapshot::Controller &saved = snapshot.controllers[0];
+  for (int lane = 0; lane < laneCount; ++lane) {
+    setLaneGains(lane, saved.gains);
+  }
+  setpoint.setConstant(saved.setpoint);
+  previousError.setConstant(saved.previousError);
+  integral.setConstant(saved.integralState);
+}
+
+template <typename Scalar, typename Accumulator>
+int BasicBatchSimulator<Scalar, Accumulator>::getLaneCount() const {
+  return laneCount;
+}
+
+template <typename Scalar, typename Accumulator>
+bool BasicBatchSimulator<Scalar, Accumulator>::hasController() const {
+  return controlled;
+}
+
+template <typename Scalar, typename Accumulator>
+double BasicBatchSimulator<Scalar, Accumulator>::getDt() const {
+  return dt;
+}
+
+template <typename Scalar, typename Accumulator>
+double BasicBatchSimulator<Scalar, Accumulator>::getTime() const {
+  return time;
+}
+
+template <typename Scalar, typename Accumulator>
+std::uint64_t BasicBatchSimulator<Scalar, Accumulator>::getStepCount() const {
+  return stepCount;
+}
+
+template <typename Scalar, typename Accumulator>
+const DisturbanceGenerator::StreamArray &
+BasicBatchSimulator<Scalar, Accumulator>::getDisturbanceStreams() const {
+  return streams;
+}
+
+template <typename Scalar, typename Accumulator>
+const typename BasicBatchSimulator<Scalar, Accumulator>::LaneArray &
+BasicBatchSimulator<Scalar, Accumulator>::getLevels() const {
+  return level;
+}
+
+template <typename Scalar, typename Accumulator>
+typename BasicBatchSimulator<Scalar, Accumulator>::LaneArray
+BasicBatchSimulator<Scalar, Accumulator>::getInputs(int index) const {
+  checkInputIndex(index);
+  return inputs.col(index);
+}
+
+template <typename Scalar, typename Accumulator>
+const typename BasicBatchSimulator<Scalar, Accumulator>::LaneArray &
+BasicBatchSimulator<Scalar, Accumulator>::getSetpoints() const {
+  checkController();
+  return setpoint;
+}
+
+template <typename Scalar, typename Accumulator>
+const typename BasicBatchSimulator<Scalar, Accumulator>::AccumulatorArray &
+BasicBatchSimulator<Scalar, Accumulator>::getIntegralStates() const {
+  checkController();
+  return integral;
+}
+
+template <typename Scalar, typename Accumulator>
+typename BasicBatchSimulator<Scalar, Accumulator>::LaneArray
+BasicBatchSimulator<Scalar, Accumulator>::getErrors() const {
+  checkController();
+  return setpoint - level;
+}
+
+template <typename Scalar, typename Accumulator>
+typename BasicBatchSimulator<Scalar, Accumulator>::LaneArray
+BasicBatchSimulator<Scalar, Accumulator>::getControllerOutputs() const {
+  checkController();
+  return inputs.col(outputIndex);
+}
+
+template <typename Scalar, typename Accumulator>
+typename BasicBatchSimulator<Scalar, Accumulator>::LaneArray
+BasicBatchSimulator<Scalar, Accumulator>::getOutletFlows() const {
+  LaneArray opening = inputs.col(constants::INPUT_INDEX_VALVE_POSITION);
+  if (nonlinearValves > 0) {
+    for (int lane = 0; lane < laneCount; ++lane) {
+      opening(lane) = valveCurves[lane].opening(opening(lane));
+    }
+  }
+  return (level > 0.0)
+      .select(valveCoefficient * opening * valveSqrt(level.max(0.0)), 0.0);
+}
+
+template <typename Scalar, typename Accumulator>
+void BasicBatchSimulator<Scalar, Accumulator>::setInput(
+    int index, const Eigen::Ref<const LaneArray> &values) {
+  checkInputIndex(index);
+  checkLaneValues(values);
+  inputs.col(index) = values;
+}
+
+template <typename Scalar, typename Accumulator>
+void BasicBatchSimulator<Scalar, Accumulator>::setSetpoints(
+    const Eigen::Ref<const LaneArray> &values) {
+  checkController();
+  checkLaneValues(values);
+  setpoint = values;
+}
+
+template <typename Scalar, typename Accumulator>
+void BasicBatchSimulator<Scalar, Accumulator>::setInput(int lane, int index,
+                                                        double value) {
+  checkLane(lane);
+  checkInputIndex(index);
+  inputs(lane, index) = value;
+}
+
+template <typename Scalar, typename Accumulator>
+void BasicBatchSimulator<Scalar, Accumulator>::setSetpoint(int lane,
+                                                           double value) {
+  checkController();
+  checkLane(lane);
+  setpoint(lane) = value;
+}
+
+template <typename Scalar, typename Accumulator>
+void BasicBatchSimulator<Scalar, Accumulator>::setControllerGains(
+    int lane, const PIDController::Gains &gains) {
+  checkController();
+  checkLane(lane);
+  setLaneGains(lane, gains);
+}
+
+template <typename Scalar, typename Accumulator>
+void BasicBatchSimulator<Scalar, Accumulator>::setParameters(
+    int lane, const TankModel::Parameters &params) {
+  checkLane(lane);
+  // Reuse TankModel's validation (throws std::invalid_argument)
+  TankModel validated(params);
+  area(lane) = params.area;
+  valveCoefficient(lane) = params.k_v;
+  nonlinearValves -= valveCurves[lane].isLinear() ? 0 : 1;
+  valveCurves[lane] = validated.getValveCurve();
+  nonlinearValves += valveCurves[lane].isLinear() ? 0 : 1;
+}
+
+template <typename Scalar, typename Accumulator>
+void BasicBatchSimulator<Scalar, Accumulator>::setLaneGains(
+    int lane, const PIDController::Gains &gains) {
+  // Like PIDController::setGains(), the integral state is kept (bumpless)
+  kc(lane) = gains.Kc;
+  inverseTauI(lane) = inverseOrZero(gains.tau_I);
+  tauD(lane) = gains.tau_D;
+}
+
+template <typename Scalar, typename Accumulator>
+void BasicBatchSimulator<Scalar, Accumulator>::checkController() const {
+  if (!controlled) {
+    throw std::out_of_range("BatchSimulator has no controllers");
+  }
+}
+
+template <typename Scalar, typename Accumulator>
+void BasicBatchSimulator<Scalar, Accumulator>::checkLane(int lane) const {
+  if (lane < 0 || lane >= laneCount) {
+    throw std::out_of_range("Lane index " + std::to_string(lane) +
+                            " out of bounds for " + std::to_string(laneCount) +
+                            " lane(s)");
+  }
+}
+
+template <typename Scalar, typename Accumulator>
+void BasicBatchSimulator<Scalar, Accumulator>::checkInputIndex(
+    int index) const {
+  if (index < 0 || index >= constants::TANK_INPUT_SIZE) {
+    throw std::out_of_range("Input index " + std::to_string(index) +
+                            " out of bounds for input vector of size " +
+                            std::to_string(constants::TANK_INPUT_SIZE));
+  }
+}
+
+template <typename Scalar, typename Accumulator>
+void BasicBatchSimulator<Scalar, Accumulator>::checkLaneValues(
+    const Eigen::Ref<const LaneArray> &values) const {
+  if (values.size() != laneCount) {
+    throw std::invalid_argument("Expected " + std::to_string(laneCount) +
+                                " lane values, got " +
+                                std::to_string(values.size()));
+  }
+}
+
+template class BasicBatchSimulator<double>;
+template class BasicBatchSimulator<float>;
+template class BasicBatchSimulator<float, double>;
+
+template <typename Batch>
+PrecisionReport measurePrecision(const std::vector<Simulator::Config> &configs,
+                                 int steps) {
+  checkSteps(steps);
+  BatchSimulator baseline(configs);
+  Batch reduced(configs);
+  return compare(baseline, reduced, steps);
+}
+
+template <typename Batch>
+PrecisionReport measurePrecision(const Simulator::Config &config,
+                                 int laneCount, int steps) {
+  checkSteps(steps);
+  BatchSimulator baseline(config, laneCount);
+  Batch reduced(config, laneCount);
+  return compare(baseline, reduced, steps);
+}
+
+template PrecisionReport measurePrecision<FloatBatchSimulator>(
+    const std::vector<Simulator::Config> &, int);
+template PrecisionReport measurePrecision<MixedBatchSimulator>(
+    const std::vector<Simulator::Config> &, int);
+template PrecisionReport measurePrecision<FloatBatchSimulator>(
+    const Simulator::Config &, int, int);
+template PrecisionReport measurePrecision<MixedBatchSimulator>(
+    const Simulator::Config &, int, int);
+
+}  // namespace tank_sim
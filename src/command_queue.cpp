@@ -0,0 +1,103 @@
+#include "command_queue.h"
+#include <stdexcept>
+
+namespace tank_sim {
+
+Command Command::input(int index, double value) {
+    return Command{Kind::INPUT, index, value, PIDController::Gains{0.0, 0.0, 0.0}};
+}
+
+Command Command::setpoint(int controller, double value) {
+    return Command{Kind::SETPOINT, controller, value,
+                   PIDController::Gains{0.0, 0.0, 0.0}};
+}
+
+Command Command::retune(int controller, const PIDController::Gains &gains) {
+    return Command{Kind::GAINS, controller, 0.0, gains};
+}
+
+CommandQueue::CommandQueue(Eigen::Index capacity)
+    : mask_(0), enqueue_(0), dropped_(0), dequeue_(0) {
+    if (capacity <= 0 || capacity > (Eigen::Index(1) << 30)) {
+        throw std::invalid_argument("Command queue capacity must be in [1, 2^30]");
+    }
+    std::uint64_t cells = 1;
+    while (cells < static_cast<std::uint64_t>(capacity)) {
+        cells <<= 1;
+    }
+    mask_ = cells - 1;
+    cells_.reset(new Cell[cells]);
+    // Cell i is free for the producer claiming position i
+    for (std::uint64_t i = 0; i < cells; ++i) {
+        cells_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+}
+
+Eigen::Index CommandQueue::capacity() const {
+    return static_cast<Eigen::Index>(mask_ + 1);
+}
+
+bool CommandQueue::push(const Command &command) {
+    std::uint64_t position = enqueue_.load(std::memory_order_relaxed);
+    for (;;) {
+        Cell &cell = cells_[position & mask_];
+        const std::uint64_t sequence = cell.sequence.load(std::memory_order_acquire);
+        const auto lag = static_cast<std::int64_t>(sequence - position);
+        if (lag == 0) {
+            // Free for this position: claim it (on failure position reloads)
+            if (enqueue_.compare_exchange_weak(position, position + 1,
+                                               std::memory_order_relaxed)) {
+                cell.command = command;
+                cell.sequence.store(position + 1, std::memory_order_release);
+                return true;
+            }
+        } else if (lag < 0) {
+            // Still holds the command from one lap ago: full
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        } else {
+            // Another producer claimed it first
+            position = enqueue_.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+Eigen::Index CommandQueue::push(const Command *commands, Eigen::Index count) {
+    for (Eigen::Index i = 0; i < count; ++i) {
+        if (!push(commands[i])) {
+            // Keep the accepted ones a prefix, so order is preserved
+            dropped_.fetch_add(static_cast<std::uint64_t>(count - i - 1),
+                               std::memory_order_relaxed);
+            return i;
+        }
+    }
+    return count;
+}
+
+bool CommandQueue::pop(Command &command) {
+    Cell &cell = cells_[dequeue_ & mask_];
+    if (cell.sequence.load(std::memory_order_acquire) != dequeue_ + 1) {
+        return false;  // Empty, or the next command is still being written
+    }
+    command = cell.command;
+    // Free the cell for the producer one lap ahead
+    cell.sequence.store(dequeue_ + mask_ + 1, std::memory_order_release);
+    ++dequeue_;
+    return true;
+}
+
+void CommandQueue::clear() {
+    Command discarded;
+    while (pop(discarded)) {
+    }
+}
+
+std::uint64_t CommandQueue::pushed() const {
+    return enqueue_.load(std::memory_order_relaxed);
+}
+
+std::uint64_t CommandQueue::dropped() const {
+    return dropped_.load(std::memory_order_relaxed);
+}
+
+}  // namespace tank_sim
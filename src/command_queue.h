@@ -0,0 +1,112 @@
+#ifndef TANK_SIM_COMMAND_QUEUE_H
+#define TANK_SIM_COMMAND_QUEUE_H
+
+#include "pid_controller.h"
+#include <Eigen/Dense>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+namespace tank_sim {
+
+/**
+ * @brief One operator command for a Simulator: set an input, move a
+ *        setpoint or retune a controller.
+ */
+struct Command {
+    enum class Kind {
+        INPUT,     ///< inputs(index) = value
+        SETPOINT,  ///< setpoint of controller index = value
+        GAINS      ///< gains of controller index = gains
+    };
+
+    Kind kind;
+    int index;                   ///< Input index, or controller index
+    double value;                ///< INPUT and SETPOINT
+    PIDController::Gains gains;  ///< GAINS
+
+    static Command input(int index, double value);
+    static Command setpoint(int controller, double value);
+    static Command retune(int controller, const PIDController::Gains &gains);
+};
+
+/**
+ * @brief Bounded, lock-free multi-producer single-consumer command queue.
+ *
+ * Any number of threads push() commands while the simulation thread pops
+ * them at the start of each step. The queue is a ring of capacity() cells,
+ * each with a sequence number (D. Vyukov's bounded queue): a producer
+ * claims a cell with one compare-and-swap on the enqueue position, writes
+ * the command and publishes it with a release store of the cell sequence;
+ * the consumer checks the sequence of the next cell with one acquire load.
+ * Nothing allocates after construction and nobody waits on anybody: a push
+ * to a full queue fails immediately (see dropped()), and pop() on an empty
+ * queue, or one whose next cell is still being written, returns false.
+ *
+ * Commands pop in the order their producers claimed cells, so commands
+ * from one thread keep their order, and a command whose producer is still
+ * writing holds back the ones claimed after it until the next drain.
+ *
+ * pop() and clear() are consumer-side operations and must not race with
+ * each other.
+ */
+class CommandQueue {
+public:
+    /**
+     * @param capacity Minimum number of pending commands; rounded up to a
+     *        power of two (must be > 0)
+     *
+     * @throws std::invalid_argument if capacity is not positive or too large
+     */
+    explicit CommandQueue(Eigen::Index capacity);
+
+    CommandQueue(const CommandQueue &) = delete;
+    CommandQueue &operator=(const CommandQueue &) = delete;
+
+    /// Number of cells (a power of two)
+    Eigen::Index capacity() const;
+
+    /**
+     * @brief Enqueues one command. Safe from any thread; never blocks.
+     *
+     * @return false, and counts the command as dropped, if the queue is full
+     */
+    bool push(const Command &command);
+
+    /**
+     * @brief Enqueues commands in order until the queue is full.
+     *
+     * @return Number enqueued; the remaining count - n are dropped
+     */
+    Eigen::Index push(const Command *commands, Eigen::Index count);
+
+    /// Dequeues the oldest published command; consumer only
+    bool pop(Command &command);
+
+    /// Discards every published command; consumer only
+    void clear();
+
+    /// Commands accepted since construction
+    std::uint64_t pushed() const;
+
+    /// Commands rejected because the queue was full
+    std::uint64_t dropped() const;
+
+private:
+    struct Cell {
+        std::atomic<std::uint64_t> sequence;
+        Command command;
+    };
+
+    std::unique_ptr<Cell[]> cells_;
+    std::uint64_t mask_;
+    /// Producers' claim position, on its own cache line
+    alignas(64) std::atomic<std::uint64_t> enqueue_;
+    std::atomic<std::uint64_t> dropped_;
+    /// Consumer position, touched only by the consumer
+    alignas(64) std::uint64_t dequeue_;
+};
+
+}  // namespace tank_sim
+
+#endif  // TANK_SIM_COMMAND_QUEUE_H
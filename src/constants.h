@@ -68,6 +68,15 @@ constexpr double DEFAULT_TANK_AREA = 120.0;
  */
 constexpr double DEFAULT_VALVE_COEFFICIENT = 1.2649;
 
+/**
+ * @brief Rangeability of an equal-percentage valve
+ *
+ * Unitless ratio of the largest to the smallest controllable flow.
+ * Typical globe valves are rated between 20 and 50.
+ * Used by ValveCharacteristic::EQUAL_PERCENTAGE (see valve.h).
+ */
+constexpr double DEFAULT_VALVE_RANGEABILITY = 50.0;
+
 /**
  * @brief Maximum liquid height in the tank
  *
@@ -120,6 +129,18 @@ constexpr double MIN_DT = 0.001;
  */
 constexpr double MAX_DT = 10.0;
 
+/**
+ * @brief Smallest level (or level difference) used for valve-flow slopes
+ *        in model Jacobians
+ *
+ * Unit: meters
+ * d/dh sqrt(h) is infinite at h = 0. Evaluating the slope at no less than
+ * this head keeps the Rosenbrock iteration matrix finite and still strongly
+ * damping, so an empty tank refills smoothly instead of stalling at zero.
+ * The flows themselves are never regularized.
+ */
+constexpr double MIN_JACOBIAN_HEAD = 1e-6;
+
 /**
  * @brief Minimum expected error ratio for RK4 convergence validation
  *
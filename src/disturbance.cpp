@@ -0,0 +1,220 @@
+#include "disturbance.h"
+
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+namespace tank_sim {
+
+Disturbance Disturbance::brownian(int inputIndex, double sigma, double minValue,
+                                  double maxValue) {
+    Disturbance disturbance;
+    disturbance.kind = Kind::BROWNIAN;
+    disturbance.inputIndex = inputIndex;
+    disturbance.sigma = sigma;
+    disturbance.minValue = minValue;
+    disturbance.maxValue = maxValue;
+    return disturbance;
+}
+
+Disturbance Disturbance::ornsteinUhlenbeck(int inputIndex, double mean, double theta,
+                                           double sigma, double minValue,
+                                           double maxValue) {
+    Disturbance disturbance = brownian(inputIndex, sigma, minValue, maxValue);
+    disturbance.kind = Kind::ORNSTEIN_UHLENBECK;
+    disturbance.mean = mean;
+    disturbance.theta = theta;
+    return disturbance;
+}
+
+Disturbance Disturbance::step(int inputIndex, double startTime, double magnitude) {
+    Disturbance disturbance;
+    disturbance.kind = Kind::STEP;
+    disturbance.inputIndex = inputIndex;
+    disturbance.startTime = startTime;
+    disturbance.magnitude = magnitude;
+    return disturbance;
+}
+
+Disturbance Disturbance::ramp(int inputIndex, double startTime, double duration,
+                              double magnitude) {
+    Disturbance disturbance = step(inputIndex, startTime, magnitude);
+    disturbance.kind = Kind::RAMP;
+    disturbance.duration = duration;
+    return disturbance;
+}
+
+double Disturbance::offset(double time, double dt) const {
+    switch (kind) {
+    case Kind::STEP:
+        // Periods [t, t + dt) tile the time axis (the next period starts at
+        // exactly this t + dt), so the step fires in exactly one of them
+        return time <= startTime && startTime < time + dt ? magnitude : 0.0;
+    case Kind::RAMP: {
+        const double overlap = std::min(time + dt, startTime + duration) -
+                               std::max(time, startTime);
+        return overlap > 0.0 ? magnitude * overlap / duration : 0.0;
+    }
+    default:
+        return 0.0;
+    }
+}
+
+bool Disturbance::operator==(const Disturbance &other) const {
+    return kind == other.kind && inputIndex == other.inputIndex &&
+           sigma == other.sigma && theta == other.theta && mean == other.mean &&
+           magnitude == other.magnitude && startTime == other.startTime &&
+           duration == other.duration && minValue == other.minValue &&
+           maxValue == other.maxValue;
+}
+
+namespace {
+
+// Error message prefix, built only when a check fails
+std::string label(std::size_t d) {
+    return "Disturbance " + std::to_string(d) + ": ";
+}
+
+}  // namespace
+
+DisturbanceGenerator::DisturbanceGenerator(std::vector<Disturbance> disturbances,
+                                           double dt, std::uint64_t seed,
+                                           std::uint32_t stream)
+    : disturbances_(), coefficients_(), dt_(dt), seed_(seed), stream_(stream) {
+    validate(disturbances);
+    disturbances_ = std::move(disturbances);
+    computeCoefficients();
+}
+
+void DisturbanceGenerator::assign(const std::vector<Disturbance> &disturbances,
+                                  double dt, std::uint64_t seed, std::uint32_t stream) {
+    validate(disturbances);
+    disturbances_ = disturbances;  // Copy-assignment reuses the capacity
+    dt_ = dt;
+    seed_ = seed;
+    stream_ = stream;
+    computeCoefficients();
+}
+
+void DisturbanceGenerator::validate(const std::vector<Disturbance> &disturbances) {
+    for (std::size_t d = 0; d < disturbances.size(); ++d) {
+        const Disturbance &disturbance = disturbances[d];
+
+        if (disturbance.inputIndex < 0) {
+            throw std::invalid_argument(label(d) + "input index cannot be negative, got " +
+                                        std::to_string(disturbance.inputIndex));
+        }
+        if (!std::isfinite(disturbance.sigma) || !std::isfinite(disturbance.theta) ||
+            !std::isfinite(disturbance.mean) || !std::isfinite(disturbance.magnitude) ||
+            !std::isfinite(disturbance.startTime) ||
+            !std::isfinite(disturbance.duration) || std::isnan(disturbance.minValue) ||
+            std::isnan(disturbance.maxValue)) {
+            throw std::invalid_argument(label(d) + "parameters must be finite");
+        }
+        if (disturbance.minValue > disturbance.maxValue) {
+            throw std::invalid_argument(label(d) + "min_value exceeds max_value");
+        }
+        if (disturbance.sigma < 0.0 || disturbance.theta < 0.0) {
+            throw std::invalid_argument(label(d) + "sigma and theta must be non-negative");
+        }
+        if (disturbance.kind == Disturbance::Kind::RAMP && !(disturbance.duration > 0.0)) {
+            throw std::invalid_argument(label(d) + "ramp duration must be positive");
+        }
+    }
+}
+
+void DisturbanceGenerator::computeCoefficients() {
+    coefficients_.assign(disturbances_.size(), Coefficients());
+    for (std::size_t d = 0; d < disturbances_.size(); ++d) {
+        const Disturbance &disturbance = disturbances_[d];
+        Coefficients &c = coefficients_[d];
+        if (disturbance.kind == Disturbance::Kind::ORNSTEIN_UHLENBECK &&
+            disturbance.theta > 0.0) {
+            c.target = disturbance.mean;
+            c.decay = std::exp(-disturbance.theta * dt_);
+            c.noiseScale = disturbance.sigma *
+                           std::sqrt(-std::expm1(-2.0 * disturbance.theta * dt_) /
+                                     (2.0 * disturbance.theta));
+        } else {
+            c.noiseScale = disturbance.sigma * std::sqrt(dt_);
+        }
+    }
+}
+
+void DisturbanceGenerator::validateInputs(int inputCount,
+                                          const std::vector<int> &controlledInputs) const {
+    validateInputs(disturbances_, inputCount, [&controlledInputs](int index) {
+        return std::find(controlledInputs.begin(), controlledInputs.end(), index) !=
+               controlledInputs.end();
+    });
+}
+
+void DisturbanceGenerator::throwInputOutOfRange(std::size_t d, int index, int inputCount) {
+    throw std::invalid_argument(label(d) + "input index " + std::to_string(index) +
+                                " is out of bounds for input vector of size " +
+                                std::to_string(inputCount));
+}
+
+void DisturbanceGenerator::throwInputControlled(std::size_t d, int index) {
+    // The controller would overwrite the disturbed value every step
+    throw std::invalid_argument(label(d) + "input " + std::to_string(index) +
+                                " is written by a controller");
+}
+
+template <typename Lanes>
+void DisturbanceGenerator::applyLanesTo(std::uint64_t step, double time,
+                                        const StreamArray &streams,
+                                        Lanes &inputs) {
+    using Scalar = typename Lanes::Scalar;
+    const Eigen::Index lanes = inputs.rows();
+    radius_.resize(lanes);
+    angle_.resize(lanes);
+    const Philox4x32::Key key{static_cast<std::uint32_t>(seed_),
+                              static_cast<std::uint32_t>(seed_ >> 32)};
+
+    for (std::size_t d = 0; d < disturbances_.size(); ++d) {
+        const Disturbance &disturbance = disturbances_[d];
+        auto values = inputs.col(disturbance.inputIndex);
+
+        if (disturbance.isStochastic()) {
+            // Integer pass: one Philox block per lane, as in counterNormal()
+            for (Eigen::Index lane = 0; lane < lanes; ++lane) {
+                const Philox4x32::Counter bits = Philox4x32::generate(
+                    {static_cast<std::uint32_t>(step),
+                     static_cast<std::uint32_t>(step >> 32),
+                     static_cast<std::uint32_t>(d), streams(lane)},
+                    key);
+                radius_(lane) = Philox4x32::uniform(bits[0], bits[1]);
+                angle_(lane) = Philox4x32::uniform(bits[2], bits[3]);
+            }
+            // Box-Muller over all lanes with Eigen's packet log, sqrt and cos
+            // (cast<double>() is a no-op on double lanes)
+            const Coefficients &c = coefficients_[d];
+            values = (c.target + (values.template cast<double>() - c.target) * c.decay +
+                      c.noiseScale * ((-2.0 * radius_.log()).sqrt() *
+                                      (constants::TWO_PI * angle_).cos()))
+                         .max(disturbance.minValue)
+                         .min(disturbance.maxValue)
+                         .template cast<Scalar>();
+        } else {
+            values = (values.template cast<double>() + disturbance.offset(time, dt_))
+                         .max(disturbance.minValue)
+                         .min(disturbance.maxValue)
+                         .template cast<Scalar>();
+        }
+    }
+}
+
+void DisturbanceGenerator::applyLanes(std::uint64_t step, double time,
+                                      const StreamArray &streams,
+                                      Eigen::Ref<Eigen::ArrayXXd> inputs) {
+    applyLanesTo(step, time, streams, inputs);
+}
+
+void DisturbanceGenerator::applyLanes(std::uint64_t step, double time,
+                                      const StreamArray &streams,
+                                      Eigen::Ref<Eigen::ArrayXXf> inputs) {
+    applyLanesTo(step, time, streams, inputs);
+}
+
+}  // namespace tank_sim
@@ -0,0 +1,267 @@
+#ifndef TANK_SIM_DISTURBANCE_H
+#define TANK_SIM_DISTURBANCE_H
+
+#include "constants.h"
+#include <Eigen/Dense>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace tank_sim {
+
+/**
+ * @brief Philox4x32-10 counter-based random number generator.
+ *
+ * Salmon et al., "Parallel Random Numbers: As Easy as 1, 2, 3" (SC '11).
+ * generate() is a pure function of a 128-bit counter and a 64-bit key: ten
+ * rounds of two 32x32->64 multiplies and some xors, with no state to carry
+ * between calls. Any draw can therefore be computed directly from its
+ * coordinates, in any order and on any thread, which is what makes
+ * per-lane streams reproducible regardless of batch size or partitioning.
+ */
+class Philox4x32 {
+public:
+    using Counter = std::array<std::uint32_t, 4>;
+    using Key = std::array<std::uint32_t, 2>;
+
+    static Counter generate(Counter counter, Key key) {
+        for (int round = 0; round < ROUNDS; ++round) {
+            if (round > 0) {
+                key[0] += WEYL_0;
+                key[1] += WEYL_1;
+            }
+            const std::uint64_t product0 =
+                static_cast<std::uint64_t>(MULTIPLIER_0) * counter[0];
+            const std::uint64_t product1 =
+                static_cast<std::uint64_t>(MULTIPLIER_1) * counter[2];
+            counter = {static_cast<std::uint32_t>(product1 >> 32) ^ counter[1] ^ key[0],
+                       static_cast<std::uint32_t>(product1),
+                       static_cast<std::uint32_t>(product0 >> 32) ^ counter[3] ^ key[1],
+                       static_cast<std::uint32_t>(product0)};
+        }
+        return counter;
+    }
+
+    /// Uniform double in (0, 1] from 64 random bits (53 significant)
+    static double uniform(std::uint32_t high, std::uint32_t low) {
+        const std::uint64_t bits =
+            (static_cast<std::uint64_t>(high) << 21) ^ (low >> 11);
+        return (static_cast<double>(bits) + 1.0) * 0x1.0p-53;
+    }
+
+private:
+    static constexpr int ROUNDS = 10;
+    static constexpr std::uint32_t MULTIPLIER_0 = 0xD2511F53u;
+    static constexpr std::uint32_t MULTIPLIER_1 = 0xCD9E8D57u;
+    static constexpr std::uint32_t WEYL_0 = 0x9E3779B9u;
+    static constexpr std::uint32_t WEYL_1 = 0xBB67AE85u;
+};
+
+/**
+ * @brief Standard normal draw at coordinates (seed, stream, step, channel).
+ *
+ * One Philox block per draw, turned into a normal with the Box-Muller
+ * cosine branch. Simulator uses channel = disturbance index and step = the
+ * control period, so every (period, disturbance, stream) has its own value.
+ */
+inline double counterNormal(std::uint64_t seed, std::uint32_t stream,
+                            std::uint64_t step, std::uint32_t channel) {
+    const Philox4x32::Counter bits = Philox4x32::generate(
+        {static_cast<std::uint32_t>(step), static_cast<std::uint32_t>(step >> 32),
+         channel, stream},
+        {static_cast<std::uint32_t>(seed), static_cast<std::uint32_t>(seed >> 32)});
+    const double radius = std::sqrt(-2.0 * std::log(Philox4x32::uniform(bits[0], bits[1])));
+    return radius * std::cos(constants::TWO_PI * Philox4x32::uniform(bits[2], bits[3]));
+}
+
+/**
+ * @brief One input upset: a stochastic process or a scheduled change.
+ *
+ * Every kind is an update rule applied to the current value of input
+ * inputIndex once per control period [t, t + dt), before integration, so a
+ * disturbance composes with operator setInput() calls exactly as the Python
+ * Brownian inlet did:
+ *
+ *   BROWNIAN:            u += sigma * sqrt(dt) * N(0, 1)
+ *   ORNSTEIN_UHLENBECK:  u = mean + (u - mean) * exp(-theta dt)
+ *                            + sigma * sqrt((1 - exp(-2 theta dt)) / (2 theta)) * N(0, 1)
+ *                        (the exact discretization; theta = 0 is Brownian)
+ *   STEP:                u += magnitude in the period containing startTime
+ *   RAMP:                u changes by magnitude spread evenly over
+ *                        [startTime, startTime + duration)
+ *
+ * After every update the value is clamped to [minValue, maxValue]
+ * (unbounded by default). STEP and RAMP depend only on time, so replays
+ * from a snapshot repeat them exactly; a STEP whose startTime has already
+ * passed never fires.
+ */
+struct Disturbance {
+    enum class Kind { BROWNIAN, ORNSTEIN_UHLENBECK, STEP, RAMP };
+
+    Kind kind = Kind::BROWNIAN;
+    int inputIndex = 0;
+    double sigma = 0.0;       ///< BROWNIAN, ORNSTEIN_UHLENBECK: intensity (units/sqrt(s))
+    double theta = 0.0;       ///< ORNSTEIN_UHLENBECK: reversion rate (1/s)
+    double mean = 0.0;        ///< ORNSTEIN_UHLENBECK: long-run mean
+    double magnitude = 0.0;   ///< STEP, RAMP: total change
+    double startTime = 0.0;   ///< STEP, RAMP: simulation time (s)
+    double duration = 0.0;    ///< RAMP: seconds over which the change is spread
+    double minValue = -std::numeric_limits<double>::infinity();
+    double maxValue = std::numeric_limits<double>::infinity();
+
+    static Disturbance brownian(int inputIndex, double sigma,
+                                double minValue = -std::numeric_limits<double>::infinity(),
+                                double maxValue = std::numeric_limits<double>::infinity());
+    static Disturbance ornsteinUhlenbeck(int inputIndex, double mean, double theta,
+                                         double sigma,
+                                         double minValue = -std::numeric_limits<double>::infinity(),
+                                         double maxValue = std::numeric_limits<double>::infinity());
+    static Disturbance step(int inputIndex, double startTime, double magnitude);
+    static Disturbance ramp(int inputIndex, double startTime, double duration,
+                            double magnitude);
+
+    /// Deterministic change (STEP, RAMP) over the period [time, time + dt)
+    double offset(double time, double dt) const;
+
+    bool isStochastic() const {
+        return kind == Kind::BROWNIAN || kind == Kind::ORNSTEIN_UHLENBECK;
+    }
+
+    bool operator==(const Disturbance &other) const;
+    bool operator!=(const Disturbance &other) const { return !(*this == other); }
+};
+
+/**
+ * @brief Applies a list of Disturbances to plant inputs, step by step.
+ *
+ * Random draws come from counterNormal(seed, stream, step, index), so the
+ * sequence a plant sees depends only on its seed, its stream and the step
+ * count: a Simulator with stream s and lane l of a BatchSimulator whose lane
+ * stream is s see the same disturbances, however many lanes the batch has.
+ *
+ * Disturbances are applied in list order. A default-constructed generator
+ * is empty and apply() does nothing.
+ */
+class DisturbanceGenerator {
+public:
+    /// Per-lane stream ids for applyLanes()
+    using StreamArray = Eigen::Array<std::uint32_t, Eigen::Dynamic, 1>;
+
+    DisturbanceGenerator() = default;
+
+    /**
+     * @throws std::invalid_argument for a negative input index, negative
+     *         sigma or theta, a RAMP without a positive duration, non-finite
+     *         parameters or minValue > maxValue
+     */
+    DisturbanceGenerator(std::vector<Disturbance> disturbances, double dt,
+                         std::uint64_t seed = 0, std::uint32_t stream = 0);
+
+    /// Same as constructing a new generator, but reuses this one's storage.
+    /// Validates first; on failure the generator is unchanged.
+    void assign(const std::vector<Disturbance> &disturbances, double dt,
+                std::uint64_t seed = 0, std::uint32_t stream = 0);
+
+    /// The constructor's checks alone, for a list not yet in a generator
+    static void validate(const std::vector<Disturbance> &disturbances);
+
+    bool empty() const { return disturbances_.empty(); }
+    const std::vector<Disturbance> &getDisturbances() const { return disturbances_; }
+    std::uint64_t getSeed() const { return seed_; }
+    std::uint32_t getStream() const { return stream_; }
+
+    /// Throws std::invalid_argument if a disturbance targets an input
+    /// outside [0, inputCount) or the input written by a controller
+    void validateInputs(int inputCount, const std::vector<int> &controlledInputs) const;
+
+    /// validateInputs() for a list not yet in a generator; controlled(index)
+    /// returns true for an input written by a controller
+    template <typename Controlled>
+    static void validateInputs(const std::vector<Disturbance> &disturbances,
+                               int inputCount, Controlled controlled) {
+        for (std::size_t d = 0; d < disturbances.size(); ++d) {
+            const int index = disturbances[d].inputIndex;
+            if (index >= inputCount) {
+                throwInputOutOfRange(d, index, inputCount);
+            }
+            if (controlled(index)) {
+                throwInputControlled(d, index);
+            }
+        }
+    }
+
+    /// Updates inputs (anything indexable with operator()) for control
+    /// period step, which starts at time
+    template <typename Inputs>
+    void apply(std::uint64_t step, double time, Inputs &inputs) const {
+        for (std::size_t d = 0; d < disturbances_.size(); ++d) {
+            const Disturbance &disturbance = disturbances_[d];
+            double value = inputs(disturbance.inputIndex);
+            if (disturbance.isStochastic()) {
+                value = coefficients_[d].target +
+                        (value - coefficients_[d].target) * coefficients_[d].decay +
+                        coefficients_[d].noiseScale *
+                            counterNormal(seed_, stream_, step,
+                                          static_cast<std::uint32_t>(d));
+            } else {
+                value += disturbance.offset(time, dt_);
+            }
+            inputs(disturbance.inputIndex) =
+                std::min(std::max(value, disturbance.minValue), disturbance.maxValue);
+        }
+    }
+
+    /**
+     * @brief Vectorized apply() for many plants at once.
+     *
+     * inputs is lanes x inputs (column i holds input i of every lane) and
+     * lane l draws from streams(l). Normals for all lanes are generated in
+     * one pass per disturbance and combined with Eigen array expressions.
+     */
+    void applyLanes(std::uint64_t step, double time, const StreamArray &streams,
+                    Eigen::Ref<Eigen::ArrayXXd> inputs);
+
+    /**
+     * @brief applyLanes() for float lanes.
+     *
+     * Draws and updates are computed in double and rounded once on store,
+     * so a float lane sees the double lane's disturbance sequence to float
+     * rounding rather than a different sample path.
+     */
+    void applyLanes(std::uint64_t step, double time, const StreamArray &streams,
+                    Eigen::Ref<Eigen::ArrayXXf> inputs);
+
+private:
+    template <typename Lanes>
+    void applyLanesTo(std::uint64_t step, double time, const StreamArray &streams,
+                      Lanes &inputs);
+
+    void computeCoefficients();
+    [[noreturn]] static void throwInputOutOfRange(std::size_t d, int index, int inputCount);
+    [[noreturn]] static void throwInputControlled(std::size_t d, int index);
+
+    // Both stochastic kinds as one affine update: Brownian has decay 1
+    struct Coefficients {
+        double target = 0.0;
+        double decay = 1.0;
+        double noiseScale = 0.0;
+    };
+
+    std::vector<Disturbance> disturbances_;
+    std::vector<Coefficients> coefficients_;
+    double dt_ = 0.0;
+    std::uint64_t seed_ = 0;
+    std::uint32_t stream_ = 0;
+
+    // applyLanes() scratch, sized on first use
+    Eigen::ArrayXd radius_;
+    Eigen::ArrayXd angle_;
+};
+
+}  // namespace tank_sim
+
+#endif  // TANK_SIM_DISTURBANCE_H
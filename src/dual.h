@@ -0,0 +1,224 @@
+#ifndef TANK_SIM_DUAL_H
+#define TANK_SIM_DUAL_H
+
+#include <Eigen/Core>
+#include <array>
+#include <cmath>
+
+namespace tank_sim {
+
+/**
+ * @brief Forward-mode dual number carrying N directional derivatives.
+ *
+ * A Dual holds a value v and the gradient dv/dp with respect to N seed
+ * parameters p. Arithmetic applies the chain rule alongside the value, so
+ * running a templated computation on Dual<N> instead of double returns the
+ * same value plus its exact derivative (to rounding) in one pass.
+ *
+ * Comparisons look at the value only, so branches (clamps, saturation
+ * checks) take the same path as the double computation and differentiate
+ * the path taken; that is the branch's one-sided subgradient.
+ *
+ * Constants convert implicitly from double with a zero gradient, and the
+ * Eigen traits below let Dual be the scalar of fixed-size Eigen vectors, so
+ * kernels such as rk4Step() run on it unchanged.
+ *
+ * @tparam N Number of seed parameters (must be > 0)
+ */
+template <int N>
+class Dual {
+    static_assert(N > 0, "Dual needs at least one derivative");
+
+public:
+    using Gradient = std::array<double, N>;
+
+    Dual() : value_(0.0), gradient_() {}
+
+    /// A constant: zero gradient
+    Dual(double value) : value_(value), gradient_() {}
+
+    Dual(double value, const Gradient& gradient)
+        : value_(value), gradient_(gradient) {}
+
+    /// Seed parameter index, i.e. d(value)/d(p_index) = 1
+    static Dual variable(double value, int index) {
+        Dual x(value);
+        x.gradient_[index] = 1.0;
+        return x;
+    }
+
+    double value() const { return value_; }
+    double derivative(int index) const { return gradient_[index]; }
+    const Gradient& gradient() const { return gradient_; }
+
+    Dual& operator+=(const Dual& other) {
+        value_ += other.value_;
+        for (int i = 0; i < N; ++i) {
+            gradient_[i] += other.gradient_[i];
+        }
+        return *this;
+    }
+
+    Dual& operator-=(const Dual& other) {
+        value_ -= other.value_;
+        for (int i = 0; i < N; ++i) {
+            gradient_[i] -= other.gradient_[i];
+        }
+        return *this;
+    }
+
+    Dual& operator*=(const Dual& other) {
+        for (int i = 0; i < N; ++i) {
+            gradient_[i] = gradient_[i] * other.value_ + value_ * other.gradient_[i];
+        }
+        value_ *= other.value_;
+        return *this;
+    }
+
+    Dual& operator/=(const Dual& other) {
+        // Divide the value rather than multiply by the reciprocal, so values
+        // round exactly as in the double computation
+        value_ /= other.value_;
+        for (int i = 0; i < N; ++i) {
+            gradient_[i] = (gradient_[i] - value_ * other.gradient_[i]) / other.value_;
+        }
+        return *this;
+    }
+
+    Dual operator-() const {
+        Dual result(-value_);
+        for (int i = 0; i < N; ++i) {
+            result.gradient_[i] = -gradient_[i];
+        }
+        return result;
+    }
+
+    Dual operator+() const { return *this; }
+
+private:
+    double value_;
+    Gradient gradient_;
+};
+
+template <int N>
+inline Dual<N> operator+(Dual<N> a, const Dual<N>& b) { return a += b; }
+template <int N>
+inline Dual<N> operator-(Dual<N> a, const Dual<N>& b) { return a -= b; }
+template <int N>
+inline Dual<N> operator*(Dual<N> a, const Dual<N>& b) { return a *= b; }
+template <int N>
+inline Dual<N> operator/(Dual<N> a, const Dual<N>& b) { return a /= b; }
+
+// Mixed forms, so that double constants in templated code do not need a cast
+template <int N>
+inline Dual<N> operator+(Dual<N> a, double b) { return a += Dual<N>(b); }
+template <int N>
+inline Dual<N> operator+(double a, Dual<N> b) { return b += Dual<N>(a); }
+template <int N>
+inline Dual<N> operator-(Dual<N> a, double b) { return a -= Dual<N>(b); }
+template <int N>
+inline Dual<N> operator-(double a, const Dual<N>& b) { return Dual<N>(a) -= b; }
+template <int N>
+inline Dual<N> operator*(Dual<N> a, double b) {
+    typename Dual<N>::Gradient gradient = a.gradient();
+    for (double& g : gradient) {
+        g *= b;
+    }
+    return Dual<N>(a.value() * b, gradient);
+}
+template <int N>
+inline Dual<N> operator*(double a, const Dual<N>& b) { return b * a; }
+template <int N>
+inline Dual<N> operator/(const Dual<N>& a, double b) {
+    typename Dual<N>::Gradient gradient = a.gradient();
+    for (double& g : gradient) {
+        g /= b;
+    }
+    return Dual<N>(a.value() / b, gradient);
+}
+template <int N>
+inline Dual<N> operator/(double a, const Dual<N>& b) { return Dual<N>(a) /= b; }
+
+#define TANK_SIM_DUAL_COMPARISON(op)                                           \
+    template <int N>                                                           \
+    inline bool operator op(const Dual<N>& a, const Dual<N>& b) {              \
+        return a.value() op b.value();                                         \
+    }                                                                          \
+    template <int N>                                                           \
+    inline bool operator op(const Dual<N>& a, double b) {                      \
+        return a.value() op b;                                                 \
+    }                                                                          \
+    template <int N>                                                           \
+    inline bool operator op(double a, const Dual<N>& b) {                      \
+        return a op b.value();                                                 \
+    }
+
+TANK_SIM_DUAL_COMPARISON(<)
+TANK_SIM_DUAL_COMPARISON(>)
+TANK_SIM_DUAL_COMPARISON(<=)
+TANK_SIM_DUAL_COMPARISON(>=)
+TANK_SIM_DUAL_COMPARISON(==)
+TANK_SIM_DUAL_COMPARISON(!=)
+
+#undef TANK_SIM_DUAL_COMPARISON
+
+/// d sqrt(x) = dx / (2 sqrt(x)); infinite at x = 0, as for the real function
+template <int N>
+inline Dual<N> sqrt(const Dual<N>& x) {
+    const double root = std::sqrt(x.value());
+    return Dual<N>(root, (x * (0.5 / root)).gradient());
+}
+
+/// Subgradient sign(x) dx, with 0 at x = 0
+template <int N>
+inline Dual<N> abs(const Dual<N>& x) {
+    if (x.value() > 0.0) {
+        return x;
+    }
+    if (x.value() < 0.0) {
+        return -x;
+    }
+    return Dual<N>(0.0);
+}
+
+/// The value of a double or a Dual, for code templated on either
+inline double valueOf(double x) { return x; }
+
+template <int N>
+inline double valueOf(const Dual<N>& x) { return x.value(); }
+
+}  // namespace tank_sim
+
+namespace Eigen {
+
+template <int N>
+struct NumTraits<tank_sim::Dual<N>> : NumTraits<double> {
+    using Real = tank_sim::Dual<N>;
+    using NonInteger = tank_sim::Dual<N>;
+    using Nested = tank_sim::Dual<N>;
+    using Literal = tank_sim::Dual<N>;
+    enum {
+        IsComplex = 0,
+        IsInteger = 0,
+        IsSigned = 1,
+        RequireInitialization = 1,
+        ReadCost = N + 1,
+        AddCost = N + 1,
+        MulCost = 2 * N + 1
+    };
+};
+
+// Dual-double expressions (e.g. dt * k1 in rk4Step()) yield Dual
+template <int N, typename BinaryOp>
+struct ScalarBinaryOpTraits<tank_sim::Dual<N>, double, BinaryOp> {
+    using ReturnType = tank_sim::Dual<N>;
+};
+
+template <int N, typename BinaryOp>
+struct ScalarBinaryOpTraits<double, tank_sim::Dual<N>, BinaryOp> {
+    using ReturnType = tank_sim::Dual<N>;
+};
+
+}  // namespace Eigen
+
+#endif  // TANK_SIM_DUAL_H
@@ -0,0 +1,86 @@
+#pragma once
+
+#include "rk4.h"
+#include <Eigen/Dense>
+
+namespace tank_sim {
+
+/**
+ * @class FixedStepper
+ * @brief Compile-time sized RK4 integrator for small ODE systems.
+ *
+ * FixedStepper is the fixed-size counterpart of Stepper. State and input
+ * vectors are `Eigen::Matrix<double, N, 1>` so they live on the stack (or in
+ * registers), and the derivative function is a template parameter rather than
+ * a `std::function`. For the tank model (N = 1, M = 2) the entire RK4 step,
+ * including all four derivative evaluations, inlines into straight-line code
+ * with no heap traffic and no runtime size checks.
+ *
+ * Use Stepper when dimensions are only known at runtime or when GSL's
+ * implementation is wanted for verification; use FixedStepper on hot paths
+ * where the dimensions are fixed by the model (see constants.h).
+ *
+ * ## Numerical Method
+ *
+ * Classic single-step 4th-order Runge-Kutta (the shared rk4Step() kernel):
+ *
+ *   k1 = f(t,        y,             u)
+ *   k2 = f(t + dt/2, y + dt/2 * k1, u)
+ *   k3 = f(t + dt/2, y + dt/2 * k2, u)
+ *   k4 = f(t + dt,   y + dt   * k3, u)
+ *   y' = y + dt/6 * (k1 + 2 k2 + 2 k3 + k4)
+ *
+ * The input u is held constant over the step (zero-order hold), matching the
+ * Stepper contract.
+ *
+ * FixedStepper holds no resources, so unlike Stepper it is freely copyable
+ * and movable.
+ *
+ * The vector scalar defaults to double; Dual<N> (dual.h) steps the same RK4
+ * stages while carrying sensitivities. Time stays double either way.
+ *
+ * @tparam StateSize Number of state variables (must be > 0)
+ * @tparam InputSize Number of input variables (must be > 0)
+ * @tparam Scalar Scalar type of the state and input vectors
+ */
+template <int StateSize, int InputSize, typename Scalar = double>
+class FixedStepper {
+  static_assert(StateSize > 0, "State dimension must be greater than zero");
+  static_assert(InputSize > 0, "Input dimension must be greater than zero");
+
+public:
+  using StateVector = Eigen::Matrix<Scalar, StateSize, 1>;
+  using InputVector = Eigen::Matrix<Scalar, InputSize, 1>;
+
+  /**
+   * @brief Performs one RK4 integration step.
+   *
+   * @tparam DerivativeFunc Callable with signature
+   *         `StateVector(double t, const StateVector& y, const InputVector& u)`
+   *
+   * @param t Current time in the differential equation
+   * @param dt Time step size for integration
+   * @param state Current state vector of the system
+   * @param input Input vector, held constant over the step
+   * @param deriv_func Callable that computes y' = f(t, y, u)
+   *
+   * @return The updated state vector after the RK4 step
+   *
+   * @note deriv_func is called exactly 4 times per step.
+   */
+  template <typename DerivativeFunc>
+  StateVector step(double t, double dt, const StateVector &state,
+                   const InputVector &input,
+                   DerivativeFunc &&deriv_func) const {
+    StateVector next = state;
+    Rk4Workspace<StateVector> ws;
+    rk4Step(t, dt, next, input, ws,
+            [&deriv_func](double tau, const StateVector &y,
+                          const InputVector &u, StateVector &dydt) {
+              dydt = deriv_func(tau, y, u);
+            });
+    return next;
+  }
+};
+
+} // namespace tank_sim
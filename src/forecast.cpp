@@ -0,0 +1,125 @@
+#include "forecast.h"
+#include "constants.h"
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+namespace tank_sim {
+
+Forecaster::Forecaster(const Simulator::Config &config, const Options &options)
+    : config(config), options(options), batch(), values() {
+  if (options.horizonSteps <= 0) {
+    throw std::invalid_argument("Forecast horizon must be positive, got " +
+                                std::to_string(options.horizonSteps) + " steps");
+  }
+  if (options.sampleInterval <= 0 ||
+      options.sampleInterval > options.horizonSteps) {
+    throw std::invalid_argument(
+        "Sample interval must be in [1, horizon], got " +
+        std::to_string(options.sampleInterval));
+  }
+
+  // Deterministic forecasts need no disturbances or history, and lanes
+  // integrate with RK4 whatever the live simulator uses
+  this->config.disturbances.clear();
+  this->config.historyCapacity = 0;
+  this->config.historyLevels.clear();
+  this->config.integrator = Simulator::Integrator::RK4;
+
+  // Validates the config for batch use before the first run()
+  batch = std::make_unique<BatchSimulator>(this->config, 1);
+}
+
+Forecaster::Result
+Forecaster::run(const Simulator::Snapshot &snapshot,
+                const Eigen::Ref<const Eigen::MatrixXd> &setpoints,
+                const Eigen::Ref<const Eigen::MatrixXd> &inletFlows) {
+  if (setpoints.size() == 0 && inletFlows.size() == 0) {
+    throw std::invalid_argument("Forecast needs at least one candidate schedule");
+  }
+  const Eigen::Index candidates =
+      setpoints.size() != 0 ? setpoints.rows() : inletFlows.rows();
+  if (setpoints.size() != 0 && inletFlows.size() != 0 &&
+      setpoints.rows() != inletFlows.rows()) {
+    throw std::invalid_argument(
+        "Setpoint and inlet flow schedules have " +
+        std::to_string(setpoints.rows()) + " and " +
+        std::to_string(inletFlows.rows()) + " candidates");
+  }
+  if (setpoints.cols() > options.horizonSteps ||
+      inletFlows.cols() > options.horizonSteps) {
+    throw std::invalid_argument("Schedule has more segments than horizon steps");
+  }
+  if (setpoints.size() != 0 && !batch->hasController()) {
+    throw std::invalid_argument("Setpoint schedule given but config has no controller");
+  }
+
+  if (batch->getLaneCount() != candidates) {
+    batch = std::make_unique<BatchSimulator>(config, static_cast<int>(candidates));
+  }
+  values.resize(candidates);
+  batch->restore(snapshot);
+
+  const Eigen::Index samples = getSampleCount();
+  Result result;
+  result.time.resize(samples);
+  result.levels.resize(samples, candidates);
+  Eigen::ArrayXd lowest = Eigen::ArrayXd::Constant(
+      candidates, std::numeric_limits<double>::infinity());
+  Eigen::ArrayXd highest = -lowest;
+
+  Eigen::Index sample = 0;
+  for (int k = 0; k < options.horizonSteps; ++k) {
+    applySchedule(setpoints, k, true);
+    applySchedule(inletFlows, k, false);
+    batch->step();
+
+    const BatchSimulator::LaneArray &level = batch->getLevels();
+    lowest = lowest.min(level);
+    highest = highest.max(level);
+    if ((k + 1) % options.sampleInterval == 0) {
+      result.time(sample) = batch->getTime();
+      result.levels.row(sample) = level.matrix().transpose();
+      ++sample;
+    }
+  }
+
+  result.lower = result.levels.rowwise().minCoeff();
+  result.upper = result.levels.rowwise().maxCoeff();
+  result.candidateMin = lowest.matrix();
+  result.candidateMax = highest.matrix();
+  return result;
+}
+
+const Forecaster::Options &Forecaster::getOptions() const {
+  return options;
+}
+
+Eigen::Index Forecaster::getSampleCount() const {
+  return options.horizonSteps / options.sampleInterval;
+}
+
+void Forecaster::applySchedule(const Eigen::Ref<const Eigen::MatrixXd> &schedule,
+                               int step, bool setpoint) {
+  const Eigen::Index segments = schedule.cols();
+  if (segments == 0) {
+    return;
+  }
+  // Segment j starts at step j * length; the last one runs to the horizon
+  const int length = options.horizonSteps / static_cast<int>(segments);
+  if (step % length != 0 || step / length >= segments) {
+    return;
+  }
+
+  const auto column = schedule.col(step / length).array();
+  if (setpoint) {
+    values = column.isNaN().select(batch->getSetpoints(), column);
+    batch->setSetpoints(values);
+  } else {
+    values = column.isNaN().select(
+        batch->getInputs(constants::INPUT_INDEX_INLET_FLOW), column);
+    batch->setInput(constants::INPUT_INDEX_INLET_FLOW, values);
+  }
+}
+
+}  // namespace tank_sim
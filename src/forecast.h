@@ -0,0 +1,94 @@
+#ifndef TANK_SIM_FORECAST_H
+#define TANK_SIM_FORECAST_H
+
+#include "batch_simulator.h"
+#include "simulator.h"
+#include <Eigen/Dense>
+#include <memory>
+
+namespace tank_sim {
+
+/**
+ * @class Forecaster
+ * @brief Predicts the level under many candidate operator moves at once.
+ *
+ * From a snapshot of the live Simulator, run() forks one BatchSimulator
+ * lane per candidate, drives each lane with the candidate's setpoint and
+ * inlet flow schedule over a fixed horizon, and returns the predicted
+ * level of every candidate plus the envelope across candidates. All
+ * candidates advance together in the batch's vectorized step, so the cost
+ * is one array expression per RK4 stage per step, with no per-candidate
+ * work outside the batch. The batch itself is kept between calls.
+ *
+ * ## Schedules
+ *
+ * A schedule is a matrix with one row per candidate and one column per
+ * segment; the horizon is split into equal-length segments (the last one
+ * takes any remainder) and each value is held for its segment. A single
+ * column is a step change held for the whole horizon. NaN holds the
+ * previous segment's value (the snapshot's value in the first segment),
+ * and an empty matrix holds the snapshot value throughout.
+ *
+ * ## Model
+ *
+ * Forecasts are deterministic: the config's disturbances are dropped, so
+ * the inlet follows the schedule exactly. Lanes integrate with RK4 whatever
+ * the config's integrator, which at the default dt matches the other
+ * fixed-step integrators to well under display resolution.
+ */
+class Forecaster {
+public:
+  struct Options {
+    int horizonSteps = 0;    // Steps to predict (must be > 0)
+    int sampleInterval = 1;  // Record every sampleInterval-th step (> 0)
+  };
+
+  struct Result {
+    Eigen::VectorXd time;          // Sample times, one per recorded step
+    Eigen::MatrixXd levels;        // samples x candidates
+    Eigen::VectorXd lower;         // Lowest level across candidates, per sample
+    Eigen::VectorXd upper;         // Highest level across candidates, per sample
+    Eigen::VectorXd candidateMin;  // Lowest level over the horizon, per candidate
+    Eigen::VectorXd candidateMax;  // Highest level over the horizon, per candidate
+  };
+
+  /**
+   * @brief Prepares forecasts for simulators built from config.
+   *
+   * @throws std::invalid_argument if the config is not valid for a
+   *         BatchSimulator, or an option is out of range
+   */
+  Forecaster(const Simulator::Config &config, const Options &options);
+
+  /**
+   * @brief Runs every candidate from snapshot and samples its level.
+   *
+   * The candidate count is the row count of the non-empty schedules. The
+   * batch is rebuilt only when it changes between calls.
+   *
+   * @throws std::invalid_argument if both schedules are empty, their row
+   *         counts differ, either has more columns than horizonSteps, a
+   *         setpoint schedule is given without a controller, or the
+   *         snapshot's controller count differs from the config's
+   */
+  Result run(const Simulator::Snapshot &snapshot,
+             const Eigen::Ref<const Eigen::MatrixXd> &setpoints,
+             const Eigen::Ref<const Eigen::MatrixXd> &inletFlows);
+
+  const Options &getOptions() const;
+  // Number of samples in each Result
+  Eigen::Index getSampleCount() const;
+
+private:
+  void applySchedule(const Eigen::Ref<const Eigen::MatrixXd> &schedule,
+                     int step, bool setpoint);
+
+  Simulator::Config config;
+  Options options;
+  std::unique_ptr<BatchSimulator> batch;
+  Eigen::ArrayXd values;  // Per-lane scratch, sized with the batch
+};
+
+}  // namespace tank_sim
+
+#endif  // TANK_SIM_FORECAST_H
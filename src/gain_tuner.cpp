@@ -0,0 +1,211 @@
+#include "gain_tuner.h"
+#include "dual.h"
+#include "fixed_stepper.h"
+#include "pid_controller_impl.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace tank_sim {
+
+namespace {
+
+// The closed loop on dual numbers: one derivative per tuned gain
+using TuningDual = Dual<3>;
+using DualController = BasicPIDController<TuningDual>;
+using DualState = Eigen::Matrix<TuningDual, TankModel::STATE_SIZE, 1>;
+using DualInputs = Eigen::Matrix<TuningDual, TankModel::INPUT_SIZE, 1>;
+
+Eigen::Vector3d toVector(const PIDController::Gains &gains) {
+  return Eigen::Vector3d(gains.Kc, gains.tau_I, gains.tau_D);
+}
+
+PIDController::Gains toGains(const Eigen::Vector3d &v) {
+  return PIDController::Gains{v(GainTuner::KC), v(GainTuner::TAU_I),
+                              v(GainTuner::TAU_D)};
+}
+
+}  // namespace
+
+GainTuner::GainTuner(const Simulator::Config &base, const Options &options)
+    : base(base), options(options) {
+  if (options.steps <= 0) {
+    throw std::invalid_argument("Tuning horizon must be positive, got " +
+                                std::to_string(options.steps) + " steps");
+  }
+  if (options.maxIterations <= 0) {
+    throw std::invalid_argument("Tuning needs at least one iteration");
+  }
+  if (!(options.tolerance > 0.0)) {
+    throw std::invalid_argument("Tuning tolerance must be positive");
+  }
+  if (options.controllerIndex < 0 ||
+      static_cast<size_t>(options.controllerIndex) >=
+          base.controllerConfig.size()) {
+    throw std::invalid_argument(
+        "Controller index " + std::to_string(options.controllerIndex) +
+        " out of bounds for " + std::to_string(base.controllerConfig.size()) +
+        " controller(s)");
+  }
+  if (base.integrator != Simulator::Integrator::RK4 &&
+      base.integrator != Simulator::Integrator::GslRK4) {
+    throw std::invalid_argument(
+        "GainTuner differentiates the RK4 integrator only");
+  }
+  const Eigen::Vector3d lower = toVector(options.lower);
+  const Eigen::Vector3d upper = toVector(options.upper);
+  if (!lower.allFinite() || !upper.allFinite() ||
+      (lower.array() > upper.array()).any()) {
+    throw std::invalid_argument(
+        "Tuning bounds must be finite with lower <= upper");
+  }
+  if (options.lower.tau_I < 0.0 || options.lower.tau_D < 0.0) {
+    throw std::invalid_argument(
+        "Tuning bounds cannot allow negative time constants");
+  }
+
+  // Building a Simulator runs all of its config validation up front
+  Simulator probe(base);
+}
+
+GainTuner::Evaluation
+GainTuner::evaluate(const PIDController::Gains &gains) const {
+  const int index = options.controllerIndex;
+  const double dt = base.dt;
+
+  // Controllers in config order; only the tuned loop's gains are seeded
+  std::vector<DualController> loops;
+  std::vector<TuningDual> setpoints;
+  std::vector<TuningDual> previousErrors(base.controllerConfig.size());
+  std::vector<bool> controlled(TankModel::INPUT_SIZE, false);
+  for (size_t i = 0; i < base.controllerConfig.size(); ++i) {
+    const Simulator::ControllerConfig &ctrl = base.controllerConfig[i];
+    DualController::Gains dualGains{ctrl.gains.Kc, ctrl.gains.tau_I,
+                                    ctrl.gains.tau_D};
+    if (static_cast<int>(i) == index) {
+      dualGains = DualController::Gains{TuningDual::variable(gains.Kc, KC),
+                                        TuningDual::variable(gains.tau_I, TAU_I),
+                                        TuningDual::variable(gains.tau_D, TAU_D)};
+    }
+    loops.emplace_back(dualGains, ctrl.bias, ctrl.minOutputLimit,
+                       ctrl.maxOutputLimit, ctrl.maxIntegralAccumulation);
+    setpoints.emplace_back(ctrl.initialSetpoint);
+    controlled[ctrl.outputIndex] = true;
+  }
+  if (!std::isnan(options.setpoint)) {
+    setpoints[index] = options.setpoint;
+  }
+
+  // Disturbances only touch uncontrolled inputs, which never depend on the
+  // gains, so they run on plain doubles exactly as in Simulator::step()
+  const DisturbanceGenerator disturbances(base.disturbances, dt,
+                                          base.disturbanceSeed,
+                                          base.disturbanceStream);
+  TankModel::InputVector plainInputs = base.initialInputs;
+
+  const TankModel model(base.params);
+  const FixedStepper<TankModel::STATE_SIZE, TankModel::INPUT_SIZE, TuningDual>
+      stepper;
+  DualState state = base.initialState.cast<TuningDual>();
+  DualInputs inputs = plainInputs.cast<TuningDual>();
+  double time = 0.0;
+  TuningDual iae = 0.0;
+
+  for (int k = 0; k < options.steps; ++k) {
+    if (!disturbances.empty()) {
+      disturbances.apply(static_cast<std::uint64_t>(k), time, plainInputs);
+      for (int j = 0; j < TankModel::INPUT_SIZE; ++j) {
+        if (!controlled[j]) {
+          inputs(j) = plainInputs(j);
+        }
+      }
+    }
+
+    state = stepper.step(time, dt, state, inputs,
+                         [&model](double, const DualState &x,
+                                  const DualInputs &u) {
+                           return model.derivatives(x, u);
+                         });
+    time += dt;
+
+    // Same order as PIDControllerBank::computeAll(): backward-difference
+    // error rate, outputs written in loop order
+    for (size_t i = 0; i < loops.size(); ++i) {
+      const Simulator::ControllerConfig &ctrl = base.controllerConfig[i];
+      const TuningDual error = setpoints[i] - state(ctrl.measuredIndex);
+      inputs(ctrl.outputIndex) =
+          loops[i].compute(error, (error - previousErrors[i]) / dt, dt);
+      previousErrors[i] = error;
+    }
+    iae += abs(previousErrors[index]) * dt;
+  }
+
+  const TuningDual::Gradient &gradient = iae.gradient();
+  return Evaluation{iae.value(),
+                    Gradient(gradient[KC], gradient[TAU_I], gradient[TAU_D])};
+}
+
+GainTuner::Result GainTuner::tune(const PIDController::Gains &initial) const {
+  // Search in box-scaled coordinates z = (g - lower) / width, so that the
+  // step length means the same for all three gains
+  const Eigen::Vector3d lower = toVector(options.lower);
+  const Eigen::Vector3d width = toVector(options.upper) - lower;
+  auto toBox = [&](const Eigen::Vector3d &z) {
+    return toGains(lower + width.cwiseProduct(z));
+  };
+
+  Eigen::Vector3d z = Eigen::Vector3d::Zero();
+  const Eigen::Vector3d start = toVector(initial);
+  for (int i = 0; i < 3; ++i) {
+    if (width(i) > 0.0) {
+      z(i) = std::clamp((start(i) - lower(i)) / width(i), 0.0, 1.0);
+    }
+  }
+
+  Result result{toBox(z), 0.0, Gradient::Zero(), 0, 1, false};
+  Evaluation current = evaluate(result.gains);
+  Eigen::Vector3d slope = current.gradient.cwiseProduct(width);
+
+  // First trial moves the steepest gain a tenth of its range
+  const double steepest = slope.cwiseAbs().maxCoeff();
+  double alpha = steepest > 0.0 ? 0.1 / steepest : 0.0;
+  constexpr double ARMIJO = 1e-4;
+
+  while (alpha > 0.0 && result.iterations < options.maxIterations) {
+    const Eigen::Vector3d trial =
+        (z - alpha * slope).cwiseMax(0.0).cwiseMin(1.0);
+    const Eigen::Vector3d move = trial - z;
+    const double moved = move.cwiseAbs().maxCoeff();
+    if (moved < options.tolerance) {
+      // Projected gradient (nearly) zero, or the line search ran out of
+      // resolution: stationary to tolerance
+      result.converged = true;
+      break;
+    }
+
+    const Evaluation candidate = evaluate(toBox(trial));
+    ++result.evaluations;
+    if (candidate.iae <= current.iae + ARMIJO * slope.dot(move)) {
+      z = trial;
+      current = candidate;
+      slope = current.gradient.cwiseProduct(width);
+      ++result.iterations;
+      alpha *= 2.0;
+    } else {
+      alpha *= 0.5;
+    }
+  }
+  if (alpha == 0.0) {
+    result.converged = true;  // Flat, or every gain held
+  }
+
+  result.gains = toBox(z);
+  result.iae = current.iae;
+  result.gradient = current.gradient;
+  return result;
+}
+
+}  // namespace tank_sim
@@ -0,0 +1,118 @@
+#ifndef TANK_SIM_GAIN_TUNER_H
+#define TANK_SIM_GAIN_TUNER_H
+
+#include "pid_controller.h"
+#include "simulator.h"
+#include <Eigen/Dense>
+#include <limits>
+
+namespace tank_sim {
+
+/**
+ * @class GainTuner
+ * @brief Gradient-based PID tuning: IAE and d(IAE)/d(gains) from one run.
+ *
+ * A ParameterSweep grid needs n^3 simulations to resolve three gains. The
+ * tuner instead runs the closed loop once on Dual<3> numbers (dual.h), seeded
+ * with the gains of one controller: the same RK4 stages (FixedStepper), tank
+ * equations (TankModel::derivatives) and control law (BasicPIDController)
+ * propagate d/d(Kc, tau_I, tau_D) alongside every value, so one evaluate()
+ * returns the IAE together with its exact gradient. tune() descends that
+ * gradient.
+ *
+ * The case is the one ParameterSweep runs: reset to the base config, set
+ * the gains, apply the optional setpoint step at t = 0, run a fixed horizon,
+ * and accumulate iae = sum |e| dt over the errors after every step. For an
+ * RK4 base config the value matches ParameterSweep's iae to rounding.
+ * Disturbances in the base config are replayed with the same seed, so they
+ * stay common to every evaluation and do not depend on the gains.
+ *
+ * ## Nonsmooth points
+ *
+ * Derivatives follow the branch the values take (see
+ * BasicPIDController::compute): a saturated output or a held integral
+ * passes no derivative, |e| uses sign(e) with 0 at e = 0, and an empty tank
+ * has no outlet flow derivative. These are one-sided subgradients, so the
+ * gradient is exact wherever the response is differentiable and a valid
+ * descent direction for the branch taken elsewhere.
+ *
+ * ## Optimizer
+ *
+ * tune() is projected gradient descent with an Armijo backtracking line
+ * search on the gains scaled to the unit box [lower, upper]: a step that
+ * lowers the IAE grows the next trial step, a rejected one halves it. It
+ * stops when an accepted step moves every scaled gain by less than
+ * tolerance, when the step length falls below it without improvement, or
+ * after maxIterations accepted steps. A gain with lower == upper is held.
+ * Each trial costs one dual run, about 1.5x one ParameterSweep case.
+ *
+ * Only RK4 and GslRK4 base configs are accepted. Both are differentiated
+ * with the native single-step RK4; GSL's rk4 step uses step doubling, so
+ * for a GslRK4 base the IAE matches a GslRK4 Simulator only to truncation
+ * error.
+ */
+class GainTuner {
+public:
+  // Gradient components, in Gains field order
+  static constexpr int KC = 0;
+  static constexpr int TAU_I = 1;
+  static constexpr int TAU_D = 2;
+
+  using Gradient = Eigen::Vector3d;
+
+  struct Options {
+    int steps = 0;                 // Horizon in simulator steps (must be > 0)
+    double setpoint =              // Setpoint applied at t = 0; NaN keeps
+        std::numeric_limits<double>::quiet_NaN();  // the configured one
+    int controllerIndex = 0;       // Controller whose gains are tuned
+    PIDController::Gains lower{-10.0, 1.0, 0.0};     // tune() search box
+    PIDController::Gains upper{10.0, 1000.0, 100.0};
+    int maxIterations = 100;       // Accepted tune() steps (must be > 0)
+    double tolerance = 1e-6;       // Scaled step that counts as converged
+  };
+
+  struct Evaluation {
+    double iae;
+    Gradient gradient;             // d(iae)/d(Kc, tau_I, tau_D)
+  };
+
+  struct Result {
+    PIDController::Gains gains;    // Best gains found
+    double iae;
+    Gradient gradient;
+    int iterations;                // Accepted steps
+    int evaluations;               // Closed-loop runs, including the first
+    bool converged;                // False if maxIterations ran out
+  };
+
+  /**
+   * @brief Prepares tuning around a base configuration.
+   *
+   * @throws std::invalid_argument if the base config is invalid, its
+   *         integrator is not RK4 or GslRK4, or any option is out of range
+   *         (including a box with lower > upper, non-finite bounds or
+   *         negative time constants)
+   */
+  GainTuner(const Simulator::Config &base, const Options &options);
+
+  /**
+   * @brief One closed-loop run: IAE and its gradient at the given gains.
+   *
+   * @throws std::invalid_argument if a time constant is negative
+   */
+  Evaluation evaluate(const PIDController::Gains &gains) const;
+
+  /**
+   * @brief Minimizes the IAE over the search box, starting from initial
+   *        (clamped into the box).
+   */
+  Result tune(const PIDController::Gains &initial) const;
+
+private:
+  Simulator::Config base;
+  Options options;
+};
+
+}  // namespace tank_sim
+
+#endif  // TANK_SIM_GAIN_TUNER_H
@@ -0,0 +1,126 @@
+#include "history_buffer.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace tank_sim {
+
+HistoryBuffer::HistoryBuffer(Eigen::Index capacity)
+    : capacity_(capacity), slots_(capacity + 1), data_(), head_(0) {
+    if (capacity <= 0) {
+        throw std::invalid_argument("History capacity must be positive");
+    }
+    data_.setZero(SIGNAL_COUNT, 2 * slots_);
+}
+
+Eigen::Index HistoryBuffer::capacity() const {
+    return capacity_;
+}
+
+Eigen::Index HistoryBuffer::size() const {
+    const std::uint64_t h = head();
+    return h < static_cast<std::uint64_t>(capacity_) ? static_cast<Eigen::Index>(h)
+                                                     : capacity_;
+}
+
+std::uint64_t HistoryBuffer::head() const {
+    return head_.load(std::memory_order_acquire);
+}
+
+Eigen::Index HistoryBuffer::slot(std::uint64_t sequence) const {
+    return static_cast<Eigen::Index>(sequence % static_cast<std::uint64_t>(slots_));
+}
+
+void HistoryBuffer::append(const Sample &sample) {
+    const std::uint64_t n = head_.load(std::memory_order_relaxed);
+    // Keep the previous head store ordered before overwriting the slot (the
+    // writer half of the seqlock pairing with isValid())
+    std::atomic_thread_fence(std::memory_order_release);
+
+    const Eigen::Index s = slot(n);
+    for (int signal = 0; signal < SIGNAL_COUNT; ++signal) {
+        data_(signal, s) = sample[signal];
+        data_(signal, s + slots_) = sample[signal];
+    }
+    head_.store(n + 1, std::memory_order_release);
+}
+
+void HistoryBuffer::clear() {
+    head_.store(0, std::memory_order_release);
+}
+
+HistoryBuffer::Window HistoryBuffer::window(double t0, double t1) const {
+    const std::uint64_t h = head();
+    const std::uint64_t retained =
+        std::min<std::uint64_t>(h, static_cast<std::uint64_t>(capacity_));
+    const std::uint64_t first = h - retained;
+
+    // Retained times are contiguous starting at slot(first)
+    const double *times = data_.row(TIME).data() + slot(first);
+    const double *end = times + retained;
+    const double *lo = std::lower_bound(times, end, t0);
+    const double *hi = std::upper_bound(lo, end, t1);
+
+    Window result;
+    result.begin = first + static_cast<std::uint64_t>(lo - times);
+    result.count = static_cast<Eigen::Index>(hi - lo);
+    return result;
+}
+
+HistoryBuffer::Window HistoryBuffer::latest(Eigen::Index n) const {
+    const std::uint64_t h = head();
+    const std::uint64_t retained =
+        std::min<std::uint64_t>(h, static_cast<std::uint64_t>(capacity_));
+    const std::uint64_t count =
+        std::min<std::uint64_t>(retained, static_cast<std::uint64_t>(std::max<Eigen::Index>(n, 0)));
+
+    Window result;
+    result.begin = h - count;
+    result.count = static_cast<Eigen::Index>(count);
+    return result;
+}
+
+const double *HistoryBuffer::data(Signal signal, const Window &window) const {
+    return data_.row(signal).data() + slot(window.begin);
+}
+
+bool HistoryBuffer::isValid(const Window &window) const {
+    // Reads of the window's data must complete before head is re-read
+    std::atomic_thread_fence(std::memory_order_acquire);
+    const std::uint64_t h = head_.load(std::memory_order_relaxed);
+    // The writer may be filling sequence h, which reuses the slot of
+    // h - slots_; everything from h - capacity_ on is intact
+    if (window.count == 0) {
+        return true;
+    }
+    return window.begin + static_cast<std::uint64_t>(capacity_) >= h &&
+           window.begin + static_cast<std::uint64_t>(window.count) <= h;
+}
+
+HistoryBuffer::Window HistoryBuffer::copyWindow(const Window &window,
+                                                SignalMatrix &out) const {
+    const auto capacity = static_cast<std::uint64_t>(capacity_);
+    Window current = window;
+    // Extra samples dropped from the old end after each failed attempt, so a
+    // writer that keeps advancing cannot keep invalidating the oldest sample
+    std::uint64_t margin = 0;
+    while (true) {
+        // Trim samples the writer has lapped (or is about to)
+        const std::uint64_t h = head();
+        const std::uint64_t oldest =
+            h + margin > capacity ? std::min(h + margin - capacity, h) : 0;
+        if (current.begin < oldest) {
+            const std::uint64_t end = current.begin + current.count;
+            current.begin = std::min(oldest, end);
+            current.count = static_cast<Eigen::Index>(end - current.begin);
+        }
+
+        out.resize(SIGNAL_COUNT, current.count);
+        out = data_.middleCols(slot(current.begin), current.count);
+        if (isValid(current)) {
+            return current;
+        }
+        margin = std::min(capacity, margin > 0 ? 2 * margin : 1);
+    }
+}
+
+}  // namespace tank_sim
@@ -0,0 +1,136 @@
+#ifndef TANK_SIM_HISTORY_BUFFER_H
+#define TANK_SIM_HISTORY_BUFFER_H
+
+#include <Eigen/Dense>
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+namespace tank_sim {
+
+/**
+ * @brief Fixed-capacity ring buffer of per-step telemetry, stored as SoA.
+ *
+ * The buffer keeps the most recent capacity() samples. Each signal (time,
+ * level, setpoint, ...) is stored contiguously, and every sample is written
+ * twice, at slot s and s + slots, so that any run of up to capacity()
+ * consecutive samples is one contiguous block per signal even when it wraps.
+ * A time window can therefore be handed out as plain pointers (or zero-copy
+ * NumPy views) without gathering.
+ *
+ * ## Threading
+ *
+ * One writer, any number of readers, no locks. Samples are numbered by a
+ * monotonically increasing sequence; the writer fills both copies of a slot
+ * and then publishes it by advancing head() with release semantics. There is
+ * one spare slot beyond capacity(), so the slot being written never holds a
+ * sample a reader can see.
+ *
+ * A reader takes a Window (which snapshots head()), reads its data, then
+ * calls isValid() to learn whether the writer has since lapped the oldest
+ * sample it read. copyWindow() does this read-validate loop for you. Readers
+ * on the writer's thread (e.g. between Simulator steps) are always valid.
+ *
+ * clear() is a writer-side operation and must not race with readers.
+ */
+class HistoryBuffer {
+public:
+    /// Recorded signals, one row each, in this order
+    enum Signal : int {
+        TIME = 0,
+        TANK_LEVEL,
+        SETPOINT,
+        INLET_FLOW,
+        OUTLET_FLOW,
+        VALVE_POSITION,
+        CONTROL_ERROR,
+        CONTROLLER_OUTPUT,
+        SIGNAL_COUNT
+    };
+
+    using Sample = std::array<double, SIGNAL_COUNT>;
+
+    /// Row-major so that each signal (row) is contiguous in memory
+    using SignalMatrix =
+        Eigen::Matrix<double, SIGNAL_COUNT, Eigen::Dynamic, Eigen::RowMajor>;
+
+    /// A contiguous run of samples: sequences [begin, begin + count)
+    struct Window {
+        std::uint64_t begin = 0;
+        Eigen::Index count = 0;
+    };
+
+    /**
+     * @brief Allocates storage for the most recent capacity samples.
+     *
+     * @param capacity Number of samples retained (must be > 0)
+     *
+     * @throws std::invalid_argument if capacity is not positive
+     */
+    explicit HistoryBuffer(Eigen::Index capacity);
+
+    HistoryBuffer(const HistoryBuffer &) = delete;
+    HistoryBuffer &operator=(const HistoryBuffer &) = delete;
+
+    /// Maximum number of samples retained
+    Eigen::Index capacity() const;
+
+    /// Number of samples currently retained (min(head(), capacity()))
+    Eigen::Index size() const;
+
+    /// Total samples appended since construction or clear()
+    std::uint64_t head() const;
+
+    /// Writer: appends one sample, overwriting the oldest when full
+    void append(const Sample &sample);
+
+    /// Writer: discards all samples without releasing storage
+    void clear();
+
+    /**
+     * @brief Samples with t0 <= time <= t1.
+     *
+     * Found by binary search over the retained samples, so the cost is
+     * O(log capacity) regardless of window length. Times must be
+     * non-decreasing in append order (true for a Simulator between resets).
+     * Returns an empty window if nothing falls in the range.
+     */
+    Window window(double t0, double t1) const;
+
+    /// The most recent n samples (fewer if not that many are retained)
+    Window latest(Eigen::Index n) const;
+
+    /**
+     * @brief Pointer to window.count contiguous values of one signal.
+     *
+     * The data aliases the ring and is overwritten once the writer laps the
+     * window; check isValid() after reading if the writer runs concurrently.
+     */
+    const double *data(Signal signal, const Window &window) const;
+
+    /// True while none of the window's samples has been overwritten (always
+    /// true for an empty window)
+    bool isValid(const Window &window) const;
+
+    /**
+     * @brief Copies a window into out (resized to SIGNAL_COUNT x count).
+     *
+     * Retries if the writer laps the window mid-copy, trimming the window to
+     * what is still retained, so the result is always a consistent snapshot.
+     *
+     * @return The window that was actually copied
+     */
+    Window copyWindow(const Window &window, SignalMatrix &out) const;
+
+private:
+    Eigen::Index slot(std::uint64_t sequence) const;
+
+    Eigen::Index capacity_;
+    Eigen::Index slots_;                 ///< capacity_ + 1 spare
+    SignalMatrix data_;                  ///< SIGNAL_COUNT x (2 * slots_)
+    std::atomic<std::uint64_t> head_;    ///< Next sequence to be written
+};
+
+}  // namespace tank_sim
+
+#endif  // TANK_SIM_HISTORY_BUFFER_H
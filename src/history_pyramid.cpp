@@ -0,0 +1,256 @@
+#include "history_pyramid.h"
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+namespace tank_sim {
+
+namespace {
+
+constexpr int row(int signal, int stat) {
+    return signal * HistoryPyramid::STAT_COUNT + stat;
+}
+
+}  // namespace
+
+HistoryPyramid::HistoryPyramid(const std::vector<Level> &levels) {
+    if (levels.empty()) {
+        throw std::invalid_argument("History pyramid needs at least one level");
+    }
+    for (size_t i = 0; i < levels.size(); ++i) {
+        const Level &level = levels[i];
+        if (level.factor <= 0 || level.capacity <= 0) {
+            throw std::invalid_argument("Pyramid level " + std::to_string(i) +
+                                        " factor and capacity must be positive");
+        }
+        if (i > 0 && level.factor % levels[i - 1].factor != 0) {
+            throw std::invalid_argument(
+                "Pyramid level " + std::to_string(i) + " factor " +
+                std::to_string(level.factor) + " is not a multiple of " +
+                std::to_string(levels[i - 1].factor));
+        }
+    }
+
+    levels_.resize(levels.size());
+    for (size_t i = 0; i < levels.size(); ++i) {
+        levels_[i].shape = levels[i];
+        levels_[i].ring.setZero(ROW_COUNT, levels[i].capacity);
+    }
+    clear();
+}
+
+int HistoryPyramid::getLevelCount() const {
+    return static_cast<int>(levels_.size());
+}
+
+const HistoryPyramid::Level &HistoryPyramid::getLevel(int index) const {
+    checkLevel(index);
+    return levels_[index].shape;
+}
+
+void HistoryPyramid::checkLevel(int level) const {
+    if (level < 0 || level >= getLevelCount()) {
+        throw std::out_of_range("Pyramid level " + std::to_string(level) +
+                                " out of bounds for " +
+                                std::to_string(getLevelCount()) + " level(s)");
+    }
+}
+
+void HistoryPyramid::append(const Sample &sample) {
+    accumulate(0, sample, sample, sample, sample, 1);
+}
+
+void HistoryPyramid::clear() {
+    for (auto &level : levels_) {
+        level.completed = 0;
+        level.count = 0;
+    }
+}
+
+void HistoryPyramid::accumulate(int index, const Sample &min, const Sample &max,
+                                const Sample &sum, const Sample &last,
+                                int count) {
+    LevelState &level = levels_[index];
+    if (level.count == 0) {
+        level.min = min;
+        level.max = max;
+        level.sum = sum;
+    } else {
+        for (int s = 0; s < HistoryBuffer::SIGNAL_COUNT; ++s) {
+            level.min[s] = std::min(level.min[s], min[s]);
+            level.max[s] = std::max(level.max[s], max[s]);
+            level.sum[s] += sum[s];
+        }
+    }
+    level.last = last;
+    level.count += count;
+
+    if (level.count < level.shape.factor) {
+        return;
+    }
+
+    // Bucket complete: store it, then hand it to the next coarser level
+    const Eigen::Index slot = static_cast<Eigen::Index>(
+        level.completed % static_cast<std::uint64_t>(level.shape.capacity));
+    const double n = static_cast<double>(level.count);
+    for (int s = 0; s < HistoryBuffer::SIGNAL_COUNT; ++s) {
+        level.ring(row(s, MIN), slot) = level.min[s];
+        level.ring(row(s, MAX), slot) = level.max[s];
+        level.ring(row(s, MEAN), slot) = level.sum[s] / n;
+        level.ring(row(s, LAST), slot) = level.last[s];
+    }
+    ++level.completed;
+    const int bucketCount = level.count;
+    level.count = 0;
+
+    if (index + 1 < getLevelCount()) {
+        // Copies: the recursive call must not alias this level's running bucket
+        const Sample bucketMin = level.min, bucketMax = level.max,
+                     bucketSum = level.sum, bucketLast = level.last;
+        accumulate(index + 1, bucketMin, bucketMax, bucketSum, bucketLast,
+                   bucketCount);
+    }
+}
+
+namespace {
+
+// Retained complete buckets of one level, addressed oldest first
+struct RingView {
+    const HistoryPyramid::BucketMatrix &ring;
+    std::uint64_t first;     // Logical index of the oldest retained bucket
+    std::uint64_t end;       // One past the newest
+    Eigen::Index capacity;
+
+    Eigen::Index slot(std::uint64_t i) const {
+        return static_cast<Eigen::Index>(i % static_cast<std::uint64_t>(capacity));
+    }
+    double at(int r, std::uint64_t i) const { return ring(r, slot(i)); }
+
+    // First logical index in [first, end) for which pred is false
+    template <typename Pred>
+    std::uint64_t partition(Pred pred) const {
+        std::uint64_t lo = first, hi = end;
+        while (lo < hi) {
+            const std::uint64_t mid = lo + (hi - lo) / 2;
+            if (pred(mid)) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+        return lo;
+    }
+};
+
+}  // namespace
+
+void HistoryPyramid::completeRange(int index, double t0, double t1,
+                                   std::uint64_t &begin,
+                                   std::uint64_t &end) const {
+    const LevelState &level = levels_[index];
+    const auto capacity = static_cast<std::uint64_t>(level.shape.capacity);
+    RingView view{level.ring,
+                  level.completed > capacity ? level.completed - capacity : 0,
+                  level.completed, level.shape.capacity};
+
+    // Bucket times are non-decreasing, so both ends are binary searches
+    begin = view.partition([&](std::uint64_t i) {
+        return view.at(row(HistoryBuffer::TIME, MAX), i) < t0;
+    });
+    end = std::max(begin, view.partition([&](std::uint64_t i) {
+        return view.at(row(HistoryBuffer::TIME, MIN), i) <= t1;
+    }));
+}
+
+int HistoryPyramid::runningBucket(int index, Sample &min, Sample &max,
+                                  Sample &sum, Sample &last) const {
+    // The running buckets of this and all finer levels together hold exactly
+    // the samples this level has not completed yet
+    int count = 0;
+    for (int l = index; l >= 0; --l) {
+        const LevelState &running = levels_[l];
+        if (running.count == 0) {
+            continue;
+        }
+        for (int s = 0; s < HistoryBuffer::SIGNAL_COUNT; ++s) {
+            min[s] = count > 0 ? std::min(min[s], running.min[s]) : running.min[s];
+            max[s] = count > 0 ? std::max(max[s], running.max[s]) : running.max[s];
+            sum[s] = count > 0 ? sum[s] + running.sum[s] : running.sum[s];
+        }
+        last = running.last;  // Finer levels hold the newer samples
+        count += running.count;
+    }
+    return count;
+}
+
+Eigen::Index HistoryPyramid::countBuckets(int index, double t0, double t1) const {
+    checkLevel(index);
+    std::uint64_t begin = 0, end = 0;
+    completeRange(index, t0, t1, begin, end);
+
+    Sample min{}, max{}, sum{}, last{};
+    const bool partial = runningBucket(index, min, max, sum, last) > 0 &&
+                         min[HistoryBuffer::TIME] <= t1 &&
+                         last[HistoryBuffer::TIME] >= t0;
+    return static_cast<Eigen::Index>(end - begin) + (partial ? 1 : 0);
+}
+
+int HistoryPyramid::selectLevel(double t0, double t1,
+                                Eigen::Index maxPoints) const {
+    if (maxPoints <= 0) {
+        throw std::invalid_argument("Point budget must be positive");
+    }
+    for (int index = 0; index < getLevelCount(); ++index) {
+        const LevelState &level = levels_[index];
+        const auto capacity = static_cast<std::uint64_t>(level.shape.capacity);
+        bool covers = level.completed <= capacity;
+        if (!covers) {
+            const Eigen::Index oldest = static_cast<Eigen::Index>(
+                level.completed % capacity);  // Slot of the oldest bucket
+            covers = level.ring(row(HistoryBuffer::TIME, MIN), oldest) <= t0;
+        }
+        if (covers && countBuckets(index, t0, t1) <= maxPoints) {
+            return index;
+        }
+    }
+    return getLevelCount() - 1;
+}
+
+HistoryPyramid::Buckets HistoryPyramid::query(int index, double t0,
+                                              double t1) const {
+    checkLevel(index);
+    const LevelState &level = levels_[index];
+    std::uint64_t begin = 0, end = 0;
+    completeRange(index, t0, t1, begin, end);
+
+    Sample min{}, max{}, sum{}, last{};
+    const int count = runningBucket(index, min, max, sum, last);
+    const bool partial = count > 0 && min[HistoryBuffer::TIME] <= t1 &&
+                         last[HistoryBuffer::TIME] >= t0;
+
+    const Eigen::Index complete = static_cast<Eigen::Index>(end - begin);
+    Buckets result;
+    result.stats.resize(ROW_COUNT, complete + (partial ? 1 : 0));
+    result.count.resize(result.stats.cols());
+
+    const auto capacity = static_cast<std::uint64_t>(level.shape.capacity);
+    for (Eigen::Index k = 0; k < complete; ++k) {
+        const auto slot = static_cast<Eigen::Index>(
+            (begin + static_cast<std::uint64_t>(k)) % capacity);
+        result.stats.col(k) = level.ring.col(slot);
+        result.count(k) = level.shape.factor;
+    }
+    if (partial) {
+        const Eigen::Index k = complete;
+        for (int s = 0; s < HistoryBuffer::SIGNAL_COUNT; ++s) {
+            result.stats(row(s, MIN), k) = min[s];
+            result.stats(row(s, MAX), k) = max[s];
+            result.stats(row(s, MEAN), k) = sum[s] / count;
+            result.stats(row(s, LAST), k) = last[s];
+        }
+        result.count(k) = count;
+    }
+    return result;
+}
+
+}  // namespace tank_sim
@@ -0,0 +1,132 @@
+#ifndef TANK_SIM_HISTORY_PYRAMID_H
+#define TANK_SIM_HISTORY_PYRAMID_H
+
+#include "history_buffer.h"
+#include <Eigen/Dense>
+#include <cstdint>
+#include <vector>
+
+namespace tank_sim {
+
+/**
+ * @brief Multi-resolution min/max/mean/last summary of per-step telemetry.
+ *
+ * A pyramid has one or more levels. Level L groups factor(L) consecutive
+ * samples into a bucket and keeps, for every HistoryBuffer signal, the
+ * bucket's minimum, maximum, mean and last value. Each level is a ring of
+ * the most recent capacity(L) buckets, so long trends (days at dt = 1 s)
+ * cost a few MB and a query never touches raw samples.
+ *
+ * Buckets are maintained incrementally: every append() updates the level 0
+ * running bucket, and a completed level L bucket is merged into level L + 1
+ * rather than recomputed from samples, so the amortized cost per sample is
+ * O(SIGNAL_COUNT) regardless of the number of levels. This requires each
+ * level's factor to be a multiple of the previous one.
+ *
+ * For the TIME signal the statistics read naturally: min is the first
+ * sample time in the bucket, max (= last) is the final sample time.
+ *
+ * Queries include the bucket still being filled, so trends reach the latest
+ * sample; Buckets::count tells a partial bucket apart.
+ *
+ * Like the Simulator that feeds it, a pyramid is not synchronized: query it
+ * from the thread that steps the simulator, or while it is not stepping.
+ */
+class HistoryPyramid {
+public:
+    using Signal = HistoryBuffer::Signal;
+    using Sample = HistoryBuffer::Sample;
+
+    /// Per-bucket statistics, stored for every signal
+    enum Stat : int { MIN = 0, MAX, MEAN, LAST, STAT_COUNT };
+
+    static constexpr int ROW_COUNT = HistoryBuffer::SIGNAL_COUNT * STAT_COUNT;
+
+    /// Row-major: row signal * STAT_COUNT + stat is one contiguous series
+    using BucketMatrix =
+        Eigen::Matrix<double, ROW_COUNT, Eigen::Dynamic, Eigen::RowMajor>;
+
+    /// Shape of one pyramid level
+    struct Level {
+        int factor;              ///< Samples per bucket
+        Eigen::Index capacity;   ///< Buckets retained
+    };
+
+    /// Buckets returned by query(), oldest first
+    struct Buckets {
+        BucketMatrix stats;                       ///< ROW_COUNT x n
+        Eigen::Matrix<int, Eigen::Dynamic, 1> count;  ///< Samples per bucket [n]
+    };
+
+    /**
+     * @brief Allocates every level's ring.
+     *
+     * @param levels Levels, finest first. Factors must be positive and each
+     *        a multiple of the previous; capacities must be positive.
+     *
+     * @throws std::invalid_argument if levels is empty or violates the above
+     */
+    explicit HistoryPyramid(const std::vector<Level> &levels);
+
+    /// Number of levels
+    int getLevelCount() const;
+
+    /// Shape of level index (0 = finest)
+    const Level &getLevel(int index) const;
+
+    /// Appends one sample to every level
+    void append(const Sample &sample);
+
+    /// Discards all buckets without releasing storage
+    void clear();
+
+    /// Number of buckets (complete and partial) of a level within [t0, t1]
+    Eigen::Index countBuckets(int level, double t0, double t1) const;
+
+    /**
+     * @brief Finest level that covers [t0, t1] in at most maxPoints buckets.
+     *
+     * A level covers the range when its oldest retained bucket starts at or
+     * before t0 (or it holds everything recorded so far). Falls back to the
+     * coarsest level when no level meets both conditions.
+     *
+     * @throws std::invalid_argument if maxPoints is not positive
+     */
+    int selectLevel(double t0, double t1, Eigen::Index maxPoints) const;
+
+    /**
+     * @brief Copies the buckets of a level that overlap [t0, t1].
+     *
+     * A bucket overlaps when its first sample time <= t1 and its last sample
+     * time >= t0. Cost is O(log capacity + number of buckets returned).
+     *
+     * @throws std::out_of_range if level is out of range
+     */
+    Buckets query(int level, double t0, double t1) const;
+
+private:
+    struct LevelState {
+        Level shape;
+        BucketMatrix ring;          ///< ROW_COUNT x capacity, complete buckets
+        std::uint64_t completed;    ///< Complete buckets since clear()
+        Sample sum;                 ///< Running bucket: sums for MEAN
+        Sample min, max, last;      ///< Running bucket: other statistics
+        int count;                  ///< Samples in the running bucket
+    };
+
+    void accumulate(int level, const Sample &min, const Sample &max,
+                    const Sample &sum, const Sample &last, int count);
+    void checkLevel(int level) const;
+    // Logical indices [begin, end) of complete buckets overlapping [t0, t1]
+    void completeRange(int level, double t0, double t1, std::uint64_t &begin,
+                       std::uint64_t &end) const;
+    // Statistics of the incomplete bucket; returns its sample count
+    int runningBucket(int level, Sample &min, Sample &max, Sample &sum,
+                      Sample &last) const;
+
+    std::vector<LevelState> levels_;
+};
+
+}  // namespace tank_sim
+
+#endif  // TANK_SIM_HISTORY_PYRAMID_H
@@ -0,0 +1,89 @@
+#include "metrics.h"
+
+#include <cmath>
+
+namespace tank_sim {
+
+namespace {
+
+double calibrateSecondsPerTick() {
+#if defined(__x86_64__) || defined(_M_X64)
+    // Spin for a couple of milliseconds against steady_clock; the TSC is
+    // invariant on every CPU we run on, so one measurement holds for the
+    // process. Paid on the first report(), never on the step path.
+    using Clock = std::chrono::steady_clock;
+    const auto wallStart = Clock::now();
+    const std::uint64_t tickStart = metricTicks();
+    auto wallEnd = wallStart;
+    while (wallEnd - wallStart < std::chrono::milliseconds(2)) {
+        wallEnd = Clock::now();
+    }
+    const std::uint64_t ticks = metricTicks() - tickStart;
+    const double seconds = std::chrono::duration<double>(wallEnd - wallStart).count();
+    return ticks > 0 ? seconds / static_cast<double>(ticks) : 1e-9;
+#else
+    return 1e-9;  // metricTicks() is steady_clock nanoseconds
+#endif
+}
+
+}  // namespace
+
+double Metrics::secondsPerTick() {
+    static const double seconds = calibrateSecondsPerTick();
+    return seconds;
+}
+
+Metrics::Report Metrics::report() const {
+    Report report;
+#if TANK_SIM_METRICS
+    const double scale = secondsPerTick();
+    report.enabled = true;
+    report.steps = steps_.load(std::memory_order_relaxed);
+    report.derivativeEvaluations = derivativeEvaluations_.load(std::memory_order_relaxed);
+    report.jacobianEvaluations = jacobianEvaluations_.load(std::memory_order_relaxed);
+    for (int p = 0; p < PHASE_COUNT; ++p) {
+        report.phaseSeconds[p] =
+            static_cast<double>(phaseTicks_[p].load(std::memory_order_relaxed)) * scale;
+    }
+    report.stepSeconds =
+        static_cast<double>(stepTicks_.load(std::memory_order_relaxed)) * scale;
+    for (int b = 0; b < HISTOGRAM_BUCKETS; ++b) {
+        report.latencyUpperBounds[b] = b + 1 < HISTOGRAM_BUCKETS
+                                           ? std::ldexp(scale, b + 1)
+                                           : HUGE_VAL;
+        report.latencyCounts[b] = histogram_[b].load(std::memory_order_relaxed);
+    }
+#endif
+    return report;
+}
+
+void Metrics::clear() {
+    steps_.store(0, std::memory_order_relaxed);
+    derivativeEvaluations_.store(0, std::memory_order_relaxed);
+    jacobianEvaluations_.store(0, std::memory_order_relaxed);
+    stepTicks_.store(0, std::memory_order_relaxed);
+    for (auto &ticks : phaseTicks_) {
+        ticks.store(0, std::memory_order_relaxed);
+    }
+    for (auto &count : histogram_) {
+        count.store(0, std::memory_order_relaxed);
+    }
+}
+
+void Metrics::copyFrom(const Metrics &other) {
+    const auto copy = [](Counter &to, const Counter &from) {
+        to.store(from.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    };
+    copy(steps_, other.steps_);
+    copy(derivativeEvaluations_, other.derivativeEvaluations_);
+    copy(jacobianEvaluations_, other.jacobianEvaluations_);
+    copy(stepTicks_, other.stepTicks_);
+    for (int p = 0; p < PHASE_COUNT; ++p) {
+        copy(phaseTicks_[p], other.phaseTicks_[p]);
+    }
+    for (int b = 0; b < HISTOGRAM_BUCKETS; ++b) {
+        copy(histogram_[b], other.histogram_[b]);
+    }
+}
+
+}  // namespace tank_sim
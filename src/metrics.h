@@ -0,0 +1,209 @@
+#ifndef TANK_SIM_METRICS_H
+#define TANK_SIM_METRICS_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+#endif
+
+// Compile-time switch for all instrumentation. Build with
+// -DTANK_SIM_METRICS=0 (CMake: -DTANK_SIM_ENABLE_METRICS=OFF) and every
+// probe below compiles to nothing.
+#ifndef TANK_SIM_METRICS
+#define TANK_SIM_METRICS 1
+#endif
+
+namespace tank_sim {
+
+/**
+ * @brief Cheap monotonic timestamp in CPU ticks.
+ *
+ * The TSC on x86-64 (a few ns per read, no system call), steady_clock
+ * nanoseconds elsewhere. Convert with Metrics::secondsPerTick().
+ */
+inline std::uint64_t metricTicks() {
+#if defined(__x86_64__) || defined(_M_X64)
+    return __rdtsc();
+#else
+    return static_cast<std::uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch())
+            .count());
+#endif
+}
+
+/**
+ * @brief Lock-free work counters and timings for one integrator or simulator.
+ *
+ * Counters are updated by the single thread that steps the owner, with
+ * relaxed load + store (no locked read-modify-write on the hot path), and
+ * may be read from any other thread at any time as a consistent-enough
+ * monitoring view: each value is exact, but values are not captured
+ * atomically as a group.
+ *
+ * Recorded per step:
+ *   - work: steps, derivative and Jacobian evaluations
+ *   - wall time per Phase
+ *   - a log2 latency histogram of whole steps: bucket b counts steps that
+ *     took [2^b, 2^(b+1)) ticks (bucket 0 also holds 0 and 1 tick)
+ *
+ * Heap allocations are not counted here; the benchmark suite measures
+ * them with an interposed allocator, which a library cannot do safely.
+ *
+ * When TANK_SIM_METRICS is 0 every recording method is an empty inline
+ * function and report() returns all zeros with enabled = false.
+ */
+class Metrics {
+public:
+    enum Phase : int {
+        INTEGRATION = 0,  ///< Input disturbances and plant integration
+        CONTROL,          ///< PID updates
+        RECORDING,        ///< History and pyramid appends
+        PHASE_COUNT
+    };
+
+    static constexpr int HISTOGRAM_BUCKETS = 40;
+
+    /// Plain-value copy of the counters, with ticks converted to seconds
+    struct Report {
+        bool enabled = false;  ///< TANK_SIM_METRICS was on at build time
+        std::uint64_t steps = 0;
+        std::uint64_t derivativeEvaluations = 0;
+        std::uint64_t jacobianEvaluations = 0;
+        std::array<double, PHASE_COUNT> phaseSeconds{};
+        double stepSeconds = 0.0;  ///< Sum of whole-step latencies
+        /// Upper bound (seconds) and count of each latency bucket
+        std::array<double, HISTOGRAM_BUCKETS> latencyUpperBounds{};
+        std::array<std::uint64_t, HISTOGRAM_BUCKETS> latencyCounts{};
+    };
+
+    Metrics() = default;
+
+    // Copies take a snapshot of the values (atomics themselves don't copy)
+    Metrics(const Metrics &other) { copyFrom(other); }
+    Metrics &operator=(const Metrics &other) {
+        if (this != &other) {
+            copyFrom(other);
+        }
+        return *this;
+    }
+
+    void addWork(std::uint64_t steps, std::uint64_t derivativeEvaluations,
+                 std::uint64_t jacobianEvaluations = 0) {
+#if TANK_SIM_METRICS
+        bump(steps_, steps);
+        bump(derivativeEvaluations_, derivativeEvaluations);
+        bump(jacobianEvaluations_, jacobianEvaluations);
+#else
+        static_cast<void>(steps);
+        static_cast<void>(derivativeEvaluations);
+        static_cast<void>(jacobianEvaluations);
+#endif
+    }
+
+    void addPhase(Phase phase, std::uint64_t ticks) {
+#if TANK_SIM_METRICS
+        bump(phaseTicks_[phase], ticks);
+#else
+        static_cast<void>(phase);
+        static_cast<void>(ticks);
+#endif
+    }
+
+    void recordStep(std::uint64_t ticks) {
+#if TANK_SIM_METRICS
+        bump(stepTicks_, ticks);
+        bump(histogram_[bucketOf(ticks)], 1);
+#else
+        static_cast<void>(ticks);
+#endif
+    }
+
+    Report report() const;
+
+    /// Zeroes every counter. Call from the stepping thread (or while idle).
+    void clear();
+
+    /// Length of one metricTicks() tick, calibrated once per process
+    static double secondsPerTick();
+
+    /// Histogram bucket for a latency of ticks
+    static int bucketOf(std::uint64_t ticks) {
+        int bucket = 0;
+        while (ticks > 1 && bucket < HISTOGRAM_BUCKETS - 1) {
+            ticks >>= 1;
+            ++bucket;
+        }
+        return bucket;
+    }
+
+private:
+    using Counter = std::atomic<std::uint64_t>;
+
+    // Single writer: a plain add is enough and avoids a locked instruction
+    static void bump(Counter &counter, std::uint64_t n) {
+        counter.store(counter.load(std::memory_order_relaxed) + n,
+                      std::memory_order_relaxed);
+    }
+
+    void copyFrom(const Metrics &other);
+
+    Counter steps_{0};
+    Counter derivativeEvaluations_{0};
+    Counter jacobianEvaluations_{0};
+    Counter stepTicks_{0};
+    std::array<Counter, PHASE_COUNT> phaseTicks_{};
+    std::array<Counter, HISTOGRAM_BUCKETS> histogram_{};
+};
+
+/**
+ * @brief Times one step and its phases into a Metrics.
+ *
+ *   StepTimer timer(metrics);
+ *   integrate();  timer.mark(Metrics::INTEGRATION);
+ *   control();    timer.mark(Metrics::CONTROL);
+ *   // destructor records the whole-step latency
+ *
+ * Each mark() attributes the ticks since the previous mark (or
+ * construction) to a phase. Compiles to nothing without TANK_SIM_METRICS.
+ */
+class StepTimer {
+public:
+#if TANK_SIM_METRICS
+    explicit StepTimer(Metrics &metrics)
+        : metrics_(metrics), start_(metricTicks()), mark_(start_) {}
+
+    void mark(Metrics::Phase phase) {
+        const std::uint64_t now = metricTicks();
+        metrics_.addPhase(phase, now - mark_);
+        mark_ = now;
+    }
+
+    ~StepTimer() { metrics_.recordStep(metricTicks() - start_); }
+#else
+    explicit StepTimer(Metrics &) {}
+    void mark(Metrics::Phase) {}
+#endif
+
+    StepTimer(const StepTimer &) = delete;
+    StepTimer &operator=(const StepTimer &) = delete;
+
+#if TANK_SIM_METRICS
+private:
+    Metrics &metrics_;
+    std::uint64_t start_;
+    std::uint64_t mark_;
+#endif
+};
+
+}  // namespace tank_sim
+
+#endif  // TANK_SIM_METRICS_H
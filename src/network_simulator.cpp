@@ -0,0 +1,238 @@
+#include "network_simulator.h"
+#include "constants.h"
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+namespace tank_sim {
+
+NetworkSimulator::NetworkSimulator(const Config &config)
+    : network(config.network), integrator(config.integrator),
+      workspace(network.getStateSize()),
+      rosenbrockWorkspace(integrator == Simulator::Integrator::Rosenbrock
+                              ? network.getStateSize()
+                              : 0),
+      controllers(), time(0.0), state(config.initialState),
+      inputs(config.initialInputs), initialState(config.initialState),
+      initialInputs(config.initialInputs), dt(config.dt),
+      controllerConfig(config.controllerConfig) {
+  if (state.size() != network.getStateSize()) {
+    throw std::invalid_argument("Initial state size " +
+                                std::to_string(state.size()) +
+                                " does not match network of " +
+                                std::to_string(network.getStateSize()) +
+                                " tank(s)");
+  }
+  if (inputs.size() != network.getInputSize()) {
+    throw std::invalid_argument("Initial inputs size " +
+                                std::to_string(inputs.size()) +
+                                " does not match network input count " +
+                                std::to_string(network.getInputSize()));
+  }
+  if (dt <= 0.0 || dt < constants::MIN_DT || dt > constants::MAX_DT) {
+    throw std::invalid_argument(
+        "dt must be positive and between " + std::to_string(constants::MIN_DT) +
+        " and " + std::to_string(constants::MAX_DT) + " seconds");
+  }
+
+  if (integrator != Simulator::Integrator::RK4 &&
+      integrator != Simulator::Integrator::Rosenbrock) {
+    throw std::invalid_argument(
+        "NetworkSimulator supports the RK4 and Rosenbrock integrators only");
+  }
+  if (integrator == Simulator::Integrator::Rosenbrock) {
+    rosenbrockWorkspace.analyzePattern(network.jacobianPattern());
+  }
+
+  for (size_t i = 0; i < controllerConfig.size(); ++i) {
+    const auto &ctrl = controllerConfig[i];
+    if (ctrl.measuredIndex < 0 || ctrl.measuredIndex >= state.size()) {
+      throw std::invalid_argument(
+          "Controller " + std::to_string(i) + " measured_index " +
+          std::to_string(ctrl.measuredIndex) + " is out of bounds for state " +
+          "vector of size " + std::to_string(state.size()));
+    }
+    if (ctrl.outputIndex < 0 || ctrl.outputIndex >= inputs.size()) {
+      throw std::invalid_argument(
+          "Controller " + std::to_string(i) + " output_index " +
+          std::to_string(ctrl.outputIndex) + " is out of bounds for input " +
+          "vector of size " + std::to_string(inputs.size()));
+    }
+  }
+
+  for (const auto &ctrl : controllerConfig) {
+    controllers.addLoop(ctrl.gains, ctrl.bias, ctrl.minOutputLimit,
+                        ctrl.maxOutputLimit, ctrl.maxIntegralAccumulation,
+                        ctrl.measuredIndex, ctrl.outputIndex, ctrl.initialSetpoint);
+  }
+}
+
+void NetworkSimulator::step() {
+  // Integrate the plant over dt with the inputs from the previous step
+  const auto derivatives = [this](double, const Eigen::VectorXd &x,
+                                  const Eigen::VectorXd &u,
+                                  Eigen::VectorXd &dxdt) {
+    network.derivatives(x, u, dxdt);
+  };
+  if (integrator == Simulator::Integrator::Rosenbrock) {
+    const bool ok = rosenbrockStep(
+        time, dt, state, inputs, rosenbrockWorkspace, derivatives,
+        [this](double, const Eigen::VectorXd &x, const Eigen::VectorXd &u,
+               PlantNetwork::SparseMatrix &jacobian) {
+          network.jacobian(x, u, jacobian);
+        });
+    if (!ok) {
+      throw std::runtime_error("Rosenbrock step failed: singular iteration matrix");
+    }
+    // The linearization of sqrt(h) can carry a vessel that empties within
+    // one step below zero; an empty tank is the physical answer
+    state = state.cwiseMax(0.0);
+  } else {
+    rk4Step(time, dt, state, inputs, workspace, derivatives);
+  }
+  time += dt;
+
+  // Update every controller for the next step, as Simulator::step()
+  controllers.computeAll(dt, state, inputs);
+}
+
+void NetworkSimulator::run(int nSteps) {
+  if (nSteps < 0) {
+    throw std::invalid_argument("Step count cannot be negative, got " +
+                                std::to_string(nSteps));
+  }
+  for (int i = 0; i < nSteps; ++i) {
+    step();
+  }
+}
+
+void NetworkSimulator::run(int nSteps, Trajectory &trajectory) {
+  if (nSteps < 0) {
+    throw std::invalid_argument("Step count cannot be negative, got " +
+                                std::to_string(nSteps));
+  }
+  validateTrajectory(trajectory, nSteps);
+  for (int i = 0; i < nSteps; ++i) {
+    step();
+    record(trajectory);
+  }
+}
+
+Trajectory NetworkSimulator::makeTrajectory(Eigen::Index capacity) const {
+  return Trajectory(capacity, state.size(), inputs.size(),
+                    static_cast<Eigen::Index>(controllerConfig.size()));
+}
+
+void NetworkSimulator::validateTrajectory(const Trajectory &trajectory,
+                                          int nSteps) const {
+  const auto controllerCount = static_cast<Eigen::Index>(controllerConfig.size());
+  if (trajectory.state.rows() != state.size() ||
+      trajectory.inputs.rows() != inputs.size() ||
+      trajectory.setpoint.rows() != controllerCount ||
+      trajectory.error.rows() != controllerCount ||
+      trajectory.controllerOutput.rows() != controllerCount) {
+    throw std::invalid_argument(
+        "Trajectory signal counts do not match simulator (state " +
+        std::to_string(state.size()) + ", inputs " +
+        std::to_string(inputs.size()) + ", controllers " +
+        std::to_string(controllerConfig.size()) + ")");
+  }
+  if (trajectory.remaining() < nSteps) {
+    throw std::invalid_argument(
+        "Trajectory has room for " + std::to_string(trajectory.remaining()) +
+        " samples but " + std::to_string(nSteps) + " steps were requested");
+  }
+}
+
+void NetworkSimulator::record(Trajectory &trajectory) const {
+  Eigen::Index k = trajectory.append();
+  trajectory.time(k) = time;
+  trajectory.state.col(k) = state;
+  trajectory.inputs.col(k) = inputs;
+  for (size_t i = 0; i < controllerConfig.size(); ++i) {
+    const auto c = static_cast<Eigen::Index>(i);
+    trajectory.setpoint(c, k) = controllers.getSetpoint(c);
+    trajectory.error(c, k) =
+        controllers.getSetpoint(c) - state(controllerConfig[i].measuredIndex);
+    trajectory.controllerOutput(c, k) = inputs(controllerConfig[i].outputIndex);
+  }
+}
+
+double NetworkSimulator::getTime() const {
+  return time;
+}
+
+const Eigen::VectorXd &NetworkSimulator::getState() const {
+  return state;
+}
+
+const Eigen::VectorXd &NetworkSimulator::getInputs() const {
+  return inputs;
+}
+
+void NetworkSimulator::checkController(int index) const {
+  if (index < 0 || static_cast<size_t>(index) >= controllerConfig.size()) {
+    throw std::out_of_range("Controller index " + std::to_string(index) +
+                            " out of bounds for " +
+                            std::to_string(controllerConfig.size()) +
+                            " controller(s)");
+  }
+}
+
+double NetworkSimulator::getSetpoint(int index) const {
+  checkController(index);
+  return controllers.getSetpoint(index);
+}
+
+double NetworkSimulator::getControllerOutput(int index) const {
+  checkController(index);
+  return inputs(controllerConfig[index].outputIndex);
+}
+
+double NetworkSimulator::getError(int index) const {
+  checkController(index);
+  return controllers.getSetpoint(index) - state(controllerConfig[index].measuredIndex);
+}
+
+int NetworkSimulator::getControllerCount() const {
+  return static_cast<int>(controllerConfig.size());
+}
+
+Eigen::VectorXd NetworkSimulator::getValveFlows() const {
+  Eigen::VectorXd flows(network.getValveCount());
+  network.valveFlows(state, inputs, flows);
+  return flows;
+}
+
+const PlantNetwork &NetworkSimulator::getNetwork() const {
+  return network;
+}
+
+void NetworkSimulator::setInput(int index, double value) {
+  if (index < 0 || index >= inputs.size()) {
+    throw std::out_of_range("Input index " + std::to_string(index) +
+                            " out of bounds for input vector of size " +
+                            std::to_string(inputs.size()));
+  }
+  inputs(index) = value;
+}
+
+void NetworkSimulator::setSetpoint(int index, double value) {
+  checkController(index);
+  controllers.setSetpoint(index, value);
+}
+
+void NetworkSimulator::setControllerGains(int index,
+                                          const PIDController::Gains &gains) {
+  checkController(index);
+  controllers.setGains(index, gains);
+}
+
+void NetworkSimulator::reset() {
+  time = 0.0;
+  state = initialState;
+  inputs = initialInputs;
+  controllers.reset();
+}
+
+} // namespace tank_sim
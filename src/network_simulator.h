@@ -0,0 +1,100 @@
+#ifndef TANK_SIM_NETWORK_SIMULATOR_H
+#define TANK_SIM_NETWORK_SIMULATOR_H
+
+#include "pid_controller.h"
+#include "pid_controller_bank.h"
+#include "plant_network.h"
+#include "rk4.h"
+#include "rosenbrock.h"
+#include "simulator.h"
+#include "trajectory.h"
+#include <Eigen/Dense>
+#include <vector>
+
+namespace tank_sim {
+
+// Closed-loop simulation of a PlantNetwork: N tanks, any number of PID
+// loops over its state.
+//
+// Simulator stays the fixed-size fast path for the single-tank plant; this
+// class is its dynamic-size counterpart. The stepping contract is the same:
+// each step() integrates the plant over dt with the inputs held, advances
+// time, then runs every controller (in config order) against the new state
+// and writes its output to inputs(outputIndex) for the next step.
+//
+// State, inputs and the integrator workspace are allocated once at
+// construction, so step() does not allocate. With Integrator::RK4 a step
+// costs O(tanks + valves + controllers). Integrator::Rosenbrock adds one
+// sparse Jacobian evaluation and LU refactorization per step (the pattern is
+// analyzed once), which is linear in the valves for tree-like trains and
+// lets dt be set by the slow tanks rather than the fastest surge vessel.
+class NetworkSimulator {
+public:
+  struct Config {
+    PlantNetwork::Topology network;
+    std::vector<Simulator::ControllerConfig> controllerConfig;
+    Eigen::VectorXd initialState;   // One level per tank
+    Eigen::VectorXd initialInputs;  // Topology::inputCount entries
+    double dt;
+    // RK4 or Rosenbrock; the GSL and adaptive integrators are
+    // single-tank only
+    Simulator::Integrator integrator = Simulator::Integrator::RK4;
+  };
+
+  // Throws std::invalid_argument for an invalid topology, state or input
+  // sizes that don't match it, dt outside [MIN_DT, MAX_DT], an unsupported
+  // integrator, or controller indices out of range
+  explicit NetworkSimulator(const Config &config);
+
+  void step();
+
+  // Bulk stepping, as Simulator::run()
+  void run(int nSteps);
+  void run(int nSteps, Trajectory &trajectory);
+
+  // Allocates a Trajectory sized for this simulator's signals
+  Trajectory makeTrajectory(Eigen::Index capacity) const;
+
+  double getTime() const;
+  const Eigen::VectorXd &getState() const;
+  const Eigen::VectorXd &getInputs() const;
+  double getSetpoint(int index) const;
+  double getControllerOutput(int index) const;
+  double getError(int index) const;
+  int getControllerCount() const;
+  // Flow through every valve, in topology order (m³/s)
+  Eigen::VectorXd getValveFlows() const;
+  const PlantNetwork &getNetwork() const;
+
+  // Operator control methods
+  void setInput(int index, double value);
+  void setSetpoint(int index, double value);
+  void setControllerGains(int index, const PIDController::Gains &gains);
+
+  void reset();
+
+private:
+  void checkController(int index) const;
+  void validateTrajectory(const Trajectory &trajectory, int nSteps) const;
+  void record(Trajectory &trajectory) const;
+
+  using SparseSolver = Eigen::SparseLU<PlantNetwork::SparseMatrix>;
+
+  PlantNetwork network;
+  Simulator::Integrator integrator;
+  Rk4Workspace<Eigen::VectorXd> workspace;
+  RosenbrockWorkspace<Eigen::VectorXd, PlantNetwork::SparseMatrix, SparseSolver>
+      rosenbrockWorkspace;  // Only sized for Integrator::Rosenbrock
+  PIDControllerBank controllers;
+  double time;
+  Eigen::VectorXd state;
+  Eigen::VectorXd inputs;
+  Eigen::VectorXd initialState;
+  Eigen::VectorXd initialInputs;
+  double dt;
+  std::vector<Simulator::ControllerConfig> controllerConfig;
+};
+
+} // namespace tank_sim
+
+#endif // TANK_SIM_NETWORK_SIMULATOR_H
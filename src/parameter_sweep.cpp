@@ -0,0 +1,164 @@
+#include "parameter_sweep.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <exception>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+namespace tank_sim {
+
+ParameterSweep::ParameterSweep(const Simulator::Config &base,
+                               const Options &options)
+    : base(base), options(options), threadCount(options.threads),
+      initialMeasurement(0.0) {
+  if (options.steps <= 0) {
+    throw std::invalid_argument("Sweep horizon must be positive, got " +
+                                std::to_string(options.steps) + " steps");
+  }
+  if (!(options.settlingBand > 0.0)) {
+    throw std::invalid_argument("Settling band must be positive");
+  }
+  if (options.threads < 0) {
+    throw std::invalid_argument("Thread count cannot be negative");
+  }
+  if (options.controllerIndex < 0 ||
+      static_cast<size_t>(options.controllerIndex) >=
+          base.controllerConfig.size()) {
+    throw std::invalid_argument(
+        "Controller index " + std::to_string(options.controllerIndex) +
+        " out of bounds for " + std::to_string(base.controllerConfig.size()) +
+        " controller(s)");
+  }
+
+  // Building a Simulator runs all of its config validation up front, so
+  // workers never fail on construction
+  Simulator probe(base);
+  initialMeasurement =
+      probe.getSetpoint(options.controllerIndex) -
+      probe.getError(options.controllerIndex);
+
+  if (threadCount == 0) {
+    threadCount =
+        std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+  }
+}
+
+std::vector<PIDController::Gains>
+ParameterSweep::makeGrid(const std::vector<double> &kc,
+                         const std::vector<double> &tauI,
+                         const std::vector<double> &tauD) {
+  std::vector<PIDController::Gains> grid;
+  grid.reserve(kc.size() * tauI.size() * tauD.size());
+  for (double k : kc) {
+    for (double ti : tauI) {
+      for (double td : tauD) {
+        grid.push_back(PIDController::Gains{k, ti, td});
+      }
+    }
+  }
+  return grid;
+}
+
+std::vector<ParameterSweep::Metrics>
+ParameterSweep::run(const std::vector<PIDController::Gains> &cases) const {
+  for (size_t i = 0; i < cases.size(); ++i) {
+    if (cases[i].tau_I < 0.0 || cases[i].tau_D < 0.0) {
+      throw std::invalid_argument("Case " + std::to_string(i) +
+                                  " has a negative time constant");
+    }
+  }
+
+  std::vector<Metrics> results(cases.size());
+  std::atomic<size_t> nextCase{0};
+  std::exception_ptr failure;
+  std::mutex failureMutex;
+
+  auto worker = [&]() {
+    try {
+      Simulator sim(base);
+      for (size_t i = nextCase.fetch_add(1); i < cases.size();
+           i = nextCase.fetch_add(1)) {
+        results[i] = runCase(sim, cases[i]);
+      }
+    } catch (...) {
+      std::lock_guard<std::mutex> lock(failureMutex);
+      if (!failure) {
+        failure = std::current_exception();
+      }
+      nextCase.store(cases.size());  // Let the other workers drain
+    }
+  };
+
+  // No point starting more workers than there are cases
+  const size_t workerCount =
+      std::min(static_cast<size_t>(threadCount), cases.size());
+  std::vector<std::thread> pool;
+  for (size_t t = 1; t < workerCount; ++t) {
+    pool.emplace_back(worker);
+  }
+  worker();  // The calling thread works too
+  for (auto &thread : pool) {
+    thread.join();
+  }
+
+  if (failure) {
+    std::rethrow_exception(failure);
+  }
+  return results;
+}
+
+ParameterSweep::Metrics
+ParameterSweep::runCase(Simulator &sim,
+                        const PIDController::Gains &gains) const {
+  const int index = options.controllerIndex;
+  const double dt = base.dt;
+
+  sim.reset();
+  sim.setControllerGains(index, gains);
+  if (!std::isnan(options.setpoint)) {
+    sim.setSetpoint(index, options.setpoint);
+  }
+
+  const double setpoint = sim.getSetpoint(index);
+  const double stepSize = setpoint - initialMeasurement;
+  const double direction = stepSize >= 0.0 ? 1.0 : -1.0;
+  const double band =
+      options.settlingBand * (stepSize != 0.0 ? std::abs(stepSize)
+                                              : std::max(std::abs(setpoint), 1.0));
+
+  Metrics metrics{0.0, 0.0, 0.0, 0.0, 0.0};
+  double previousOutput = sim.getControllerOutput(index);
+  int lastOutside = -1;
+
+  for (int k = 0; k < options.steps; ++k) {
+    sim.step();
+    const Simulator::Telemetry telemetry = sim.getTelemetry(index);
+    const double error = telemetry.error;
+
+    metrics.iae += std::abs(error) * dt;
+    metrics.ise += error * error * dt;
+    // y - r = -error; positive past the setpoint in the step direction
+    metrics.overshoot = std::max(metrics.overshoot, -direction * error);
+    metrics.valveTravel += std::abs(telemetry.controllerOutput - previousOutput);
+    previousOutput = telemetry.controllerOutput;
+    if (std::abs(error) > band) {
+      lastOutside = k;
+    }
+  }
+
+  if (lastOutside == options.steps - 1) {
+    metrics.settlingTime = std::numeric_limits<double>::infinity();
+  } else {
+    metrics.settlingTime = (lastOutside + 1) * dt;
+  }
+  return metrics;
+}
+
+int ParameterSweep::getThreadCount() const {
+  return threadCount;
+}
+
+}  // namespace tank_sim
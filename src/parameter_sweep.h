@@ -0,0 +1,104 @@
+#ifndef TANK_SIM_PARAMETER_SWEEP_H
+#define TANK_SIM_PARAMETER_SWEEP_H
+
+#include "pid_controller.h"
+#include "simulator.h"
+#include <limits>
+#include <vector>
+
+namespace tank_sim {
+
+/**
+ * @class ParameterSweep
+ * @brief Runs many closed-loop tuning cases in parallel and keeps only metrics.
+ *
+ * Each case replaces the gains of one controller in a base Simulator::Config,
+ * applies an optional setpoint step at t = 0, runs a fixed horizon, and
+ * reduces the response on the fly to a handful of scalar performance
+ * metrics. No trajectories are stored, so memory use is independent of the
+ * horizon and sweeps of tens of thousands of cases stay cheap.
+ *
+ * ## Threading
+ *
+ * run() spreads the cases over a pool of std::thread workers (the calling
+ * thread is one of them). Workers claim the next unstarted case from a
+ * shared atomic counter, so fast and slow cases balance automatically. Each
+ * worker owns one Simulator, reset between cases, so the hot loop neither
+ * allocates nor shares mutable state. Results depend only on the case, never
+ * on the thread count or scheduling.
+ *
+ * ## Metrics
+ *
+ * With r the setpoint, y the measured variable and e = r - y sampled after
+ * every step (t_k = k * dt, k = 1..steps):
+ *
+ *   - iae:          sum |e| dt
+ *   - ise:          sum e^2 dt
+ *   - overshoot:    max excursion of y past r in the direction of the step
+ *                   (measured-variable units, >= 0)
+ *   - settlingTime: last t_k with |e| outside the settling band, 0 if never
+ *                   outside, +infinity if still outside at the horizon
+ *   - valveTravel:  sum |u_k - u_{k-1}| of the controller output
+ *
+ * The settling band is settlingBand * |r - y0| (y0 = initial measurement),
+ * or settlingBand * max(|r|, 1) when the case has no setpoint step.
+ */
+class ParameterSweep {
+public:
+  struct Options {
+    int steps = 0;                 // Horizon in simulator steps (must be > 0)
+    double setpoint =              // Setpoint applied at t = 0; NaN keeps
+        std::numeric_limits<double>::quiet_NaN();  // the configured one
+    int controllerIndex = 0;       // Controller whose gains are swept
+    double settlingBand = 0.02;    // Relative settling band (must be > 0)
+    int threads = 0;               // Worker count; 0 = hardware concurrency
+  };
+
+  struct Metrics {
+    double iae;
+    double ise;
+    double overshoot;
+    double settlingTime;
+    double valveTravel;
+  };
+
+  /**
+   * @brief Prepares a sweep around a base configuration.
+   *
+   * @throws std::invalid_argument if the base config is invalid, or any
+   *         option is out of range
+   */
+  ParameterSweep(const Simulator::Config &base, const Options &options);
+
+  /**
+   * @brief Full Cartesian grid of gains.
+   *
+   * Ordered with Kc outermost and tau_D innermost, i.e. case
+   * (i * tauI.size() + j) * tauD.size() + k is {kc[i], tauI[j], tauD[k]}.
+   */
+  static std::vector<PIDController::Gains>
+  makeGrid(const std::vector<double> &kc, const std::vector<double> &tauI,
+           const std::vector<double> &tauD);
+
+  /**
+   * @brief Runs every case and returns its metrics, in case order.
+   *
+   * @throws std::invalid_argument if any case has a negative time constant
+   */
+  std::vector<Metrics> run(const std::vector<PIDController::Gains> &cases) const;
+
+  // Number of worker threads run() will use for a large sweep
+  int getThreadCount() const;
+
+private:
+  Metrics runCase(Simulator &sim, const PIDController::Gains &gains) const;
+
+  Simulator::Config base;
+  Options options;
+  int threadCount;
+  double initialMeasurement;
+};
+
+}  // namespace tank_sim
+
+#endif  // TANK_SIM_PARAMETER_SWEEP_H
@@ -8,16 +8,27 @@ namespace tank_sim {
      * Implements a discrete-time PID controller with saturation and anti-windup.
      * Tracks the integral of error over time and prevents integral windup during
      * output saturation. Supports dynamic tuning and configurable output limits.
+     *
+     * The scalar type of the gains, errors and integral state is a template
+     * parameter so the same control law can run on dual numbers (dual.h) to
+     * differentiate a closed-loop response with respect to the gains (see
+     * GainTuner). PIDController is the double instantiation used everywhere
+     * else; definitions live in pid_controller_impl.h, which only code
+     * instantiating other scalar types needs to include.
+     *
+     * @tparam Scalar double, or a type with the same arithmetic and
+     *         comparisons (e.g. Dual<N>)
      */
-    class PIDController {
+    template <typename Scalar = double>
+    class BasicPIDController {
     public:
         /**
          * @brief Struct containing PID controller gain parameters.
          */
         struct Gains {
-            double Kc;      // Proportional gain (dimensionless)
-            double tau_I;   // Integral time constant (seconds), 0 = no integral action
-            double tau_D;   // Derivative time constant (seconds), 0 = no derivative action
+            Scalar Kc;      // Proportional gain (dimensionless)
+            Scalar tau_I;   // Integral time constant (seconds), 0 = no integral action
+            Scalar tau_D;   // Derivative time constant (seconds), 0 = no derivative action
         };
 
         /**
@@ -29,8 +40,8 @@ namespace tank_sim {
          * @param max_output Maximum output saturation limit.
          * @param max_integral Maximum magnitude for integral state clamping.
          */
-        PIDController(const Gains& gains, double bias, double min_output,
-                      double max_output, double max_integral);
+        BasicPIDController(const Gains& gains, double bias, double min_output,
+                           double max_output, double max_integral);
 
         /**
          * @brief Compute the control output based on error signals.
@@ -68,8 +79,17 @@ namespace tank_sim {
          * @note If tau_D = 0, derivative action is disabled and error_dot is ignored.
          * @note This method is stateful: it updates internal integral_state based on
          *       the error and saturation condition. Call reset() to clear the state.
+         *
+         * ## Derivatives
+         *
+         * On a dual Scalar the law is differentiated along the branch the values
+         * take, i.e. every clamp and the anti-windup test use one-sided
+         * subgradients: a saturated output, or an integral held by anti-windup
+         * or pinned at ±max_integral, passes no derivative on; a value exactly at
+         * a limit counts as inside it. With tau_I = 0 the integral term is absent,
+         * so d(output)/d(tau_I) is 0.
          */
-        double compute(double error, double error_dot, double dt);
+        Scalar compute(const Scalar& error, const Scalar& error_dot, double dt);
 
         /**
          * @brief Update the controller gains dynamically.
@@ -116,7 +136,19 @@ namespace tank_sim {
          *
          * @return Current integral accumulation value.
          */
-        double getIntegralState() const;
+        const Scalar& getIntegralState() const;
+
+        /**
+         * @brief Overwrite the integral accumulator, e.g. to restore a snapshot.
+         *
+         * @param value New integral state, clamped to ±max_integral as in compute()
+         */
+        void setIntegralState(const Scalar& value);
+
+        /**
+         * @brief Get the current controller gains.
+         */
+        const Gains& getGains() const;
 
     private:
         Gains gains;
@@ -124,8 +156,11 @@ namespace tank_sim {
         double min_output;
         double max_output;
         double max_integral;
-        double integral_state;
+        Scalar integral_state;
     };
+
+    using PIDController = BasicPIDController<double>;
+    extern template class BasicPIDController<double>;
 }
 
 #endif // PID_CONTROLLER_H
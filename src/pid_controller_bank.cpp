@@ -0,0 +1,138 @@
+#include "pid_controller_bank.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+namespace tank_sim {
+
+namespace {
+
+double inverseOrZero(double tau) {
+    // Matches PIDController::compute(): tau_I = 0 disables integral action
+    return tau != 0.0 ? 1.0 / tau : 0.0;
+}
+
+}  // namespace
+
+void PIDControllerBank::addLoop(const PIDController::Gains &gains, double bias,
+                                double minOutput, double maxOutput, double maxIntegral,
+                                Eigen::Index measuredIndex, Eigen::Index outputIndex,
+                                double initialSetpoint) {
+    const Eigen::Index loop = size();
+    validateLoop(loop, gains, bias, minOutput, maxOutput, maxIntegral, measuredIndex,
+                 outputIndex);
+    resizeForLoop(loop + 1);
+    setLoop(loop, gains, bias, minOutput, maxOutput, maxIntegral, measuredIndex,
+            outputIndex, initialSetpoint);
+}
+
+void PIDControllerBank::resize(Eigen::Index count) {
+    if (count == size()) {
+        return;
+    }
+    for (Eigen::ArrayXd *array :
+         {&kc_, &tauI_, &inverseTauI_, &tauD_, &bias_, &minOutput_, &maxOutput_,
+          &maxIntegral_, &initialSetpoint_, &setpoint_, &integral_, &previousError_,
+          &error_, &unsaturated_}) {
+        array->resize(count);
+    }
+    measuredIndex_.resize(count);
+    outputIndex_.resize(count);
+}
+
+void PIDControllerBank::setLoop(Eigen::Index loop, const PIDController::Gains &gains,
+                                double bias, double minOutput, double maxOutput,
+                                double maxIntegral, Eigen::Index measuredIndex,
+                                Eigen::Index outputIndex, double initialSetpoint) {
+    validateLoop(loop, gains, bias, minOutput, maxOutput, maxIntegral, measuredIndex,
+                 outputIndex);
+    setGains(loop, gains);
+    bias_(loop) = bias;
+    minOutput_(loop) = minOutput;
+    maxOutput_(loop) = maxOutput;
+    maxIntegral_(loop) = maxIntegral;
+    measuredIndex_(loop) = measuredIndex;
+    outputIndex_(loop) = outputIndex;
+    initialSetpoint_(loop) = initialSetpoint;
+    setpoint_(loop) = initialSetpoint;
+    integral_(loop) = 0.0;
+    previousError_(loop) = 0.0;
+}
+
+void PIDControllerBank::validateLoop(Eigen::Index loop, const PIDController::Gains &gains,
+                                     double bias, double minOutput, double maxOutput,
+                                     double maxIntegral, Eigen::Index measuredIndex,
+                                     Eigen::Index outputIndex) {
+    // Construct a scalar controller purely to reuse its parameter validation
+    PIDController validated(gains, bias, minOutput, maxOutput, maxIntegral);
+    static_cast<void>(validated);
+    if (measuredIndex < 0 || outputIndex < 0) {
+        throw std::invalid_argument("Loop " + std::to_string(loop) +
+                                    ": measured and output indices cannot be negative");
+    }
+}
+
+void PIDControllerBank::resizeForLoop(Eigen::Index count) {
+    for (Eigen::ArrayXd *array :
+         {&kc_, &tauI_, &inverseTauI_, &tauD_, &bias_, &minOutput_, &maxOutput_,
+          &maxIntegral_, &initialSetpoint_, &setpoint_, &integral_, &previousError_}) {
+        array->conservativeResize(count);
+    }
+    measuredIndex_.conservativeResize(count);
+    outputIndex_.conservativeResize(count);
+    error_.resize(count);
+    unsaturated_.resize(count);
+}
+
+void PIDControllerBank::computeAll(double dt,
+                                   const Eigen::Ref<const Eigen::VectorXd> &state,
+                                   Eigen::Ref<Eigen::VectorXd> inputs) {
+    const Eigen::Index loops = size();
+
+    // Gather: error = setpoint - measured value
+    for (Eigen::Index i = 0; i < loops; ++i) {
+        error_(i) = setpoint_(i) - state(measuredIndex_(i));
+    }
+
+    // PIDController::compute() for every loop, same term order
+    unsaturated_ = bias_ + kc_ * (error_ + inverseTauI_ * integral_ +
+                                  tauD_ * ((error_ - previousError_) / dt));
+
+    // Anti-windup: hold the integral in saturated loops, otherwise accumulate
+    // and clamp to ±max_integral
+    integral_ = ((unsaturated_ < minOutput_) || (unsaturated_ > maxOutput_))
+                    .select(integral_, (integral_ + error_ * dt)
+                                           .max(-maxIntegral_)
+                                           .min(maxIntegral_));
+    previousError_ = error_;
+
+    // Scatter the clamped outputs in loop order
+    for (Eigen::Index i = 0; i < loops; ++i) {
+        inputs(outputIndex_(i)) = std::min(std::max(unsaturated_(i), minOutput_(i)),
+                                           maxOutput_(i));
+    }
+}
+
+void PIDControllerBank::reset() {
+    setpoint_ = initialSetpoint_;
+    integral_.setZero();
+    previousError_.setZero();
+}
+
+void PIDControllerBank::setIntegralState(Eigen::Index loop, double value) {
+    integral_(loop) = std::clamp(value, -maxIntegral_(loop), maxIntegral_(loop));
+}
+
+PIDController::Gains PIDControllerBank::getGains(Eigen::Index loop) const {
+    return PIDController::Gains{kc_(loop), tauI_(loop), tauD_(loop)};
+}
+
+void PIDControllerBank::setGains(Eigen::Index loop, const PIDController::Gains &gains) {
+    kc_(loop) = gains.Kc;
+    tauI_(loop) = gains.tau_I;
+    inverseTauI_(loop) = inverseOrZero(gains.tau_I);
+    tauD_(loop) = gains.tau_D;
+}
+
+}  // namespace tank_sim
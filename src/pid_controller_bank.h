@@ -0,0 +1,139 @@
+#ifndef TANK_SIM_PID_CONTROLLER_BANK_H
+#define TANK_SIM_PID_CONTROLLER_BANK_H
+
+#include "pid_controller.h"
+#include <Eigen/Dense>
+
+namespace tank_sim {
+
+/**
+ * @brief Many PID loops in structure-of-arrays form, updated in one pass.
+ *
+ * Every per-loop quantity (gains, bias, limits, integral state, previous
+ * error, setpoint, measured and output index) is a contiguous Eigen array.
+ * computeAll() gathers each loop's measurement from the plant state, runs
+ * the PIDController::compute() law for every loop as branch-free array
+ * expressions (clamping as min/max, anti-windup as a select), and scatters
+ * the outputs to the plant inputs:
+ *
+ *   error     = setpoint - state(measured)
+ *   u_unsat   = bias + Kc * (error + integral / tau_I
+ *                            + tau_D * (error - previous_error) / dt)
+ *   output    = clamp(u_unsat, min_output, max_output)
+ *   integral += error * dt,  clamped to ±max_integral, unless saturated
+ *
+ * Term order matches PIDController, which stays the scalar reference: each
+ * loop tracks a PIDController with the same parameters to within floating-
+ * point contraction differences. Outputs are scattered in loop order, so if
+ * two loops drive the same input the later one wins, as with a sequential
+ * loop over PIDControllers.
+ *
+ * Storage is sized by addLoop(); computeAll() does not allocate.
+ */
+class PIDControllerBank {
+public:
+    using IndexArray = Eigen::Array<Eigen::Index, Eigen::Dynamic, 1>;
+
+    PIDControllerBank() = default;
+
+    /**
+     * @brief Append a loop reading state(measuredIndex) and writing
+     *        inputs(outputIndex).
+     *
+     * Parameters are as for PIDController's constructor. Indices are not
+     * range-checked here; the owning simulator validates them against its
+     * plant.
+     *
+     * @throws std::invalid_argument for invalid PID parameters (the same
+     *         checks as PIDController) or a negative index
+     */
+    void addLoop(const PIDController::Gains &gains, double bias, double minOutput,
+                 double maxOutput, double maxIntegral, Eigen::Index measuredIndex,
+                 Eigen::Index outputIndex, double initialSetpoint);
+
+    /**
+     * @brief Size the bank for count loops, to be filled with setLoop().
+     *
+     * Loop values are not preserved unless count is unchanged, in which case
+     * nothing is reallocated; reinitializing a bank of the same shape this
+     * way performs no heap allocations.
+     */
+    void resize(Eigen::Index count);
+
+    /**
+     * @brief Overwrite loop (in [0, size())) as addLoop() would create it:
+     *        setpoint at initialSetpoint, zero integral and previous error.
+     *
+     * @throws std::invalid_argument as addLoop(); the bank is then unchanged
+     */
+    void setLoop(Eigen::Index loop, const PIDController::Gains &gains, double bias,
+                 double minOutput, double maxOutput, double maxIntegral,
+                 Eigen::Index measuredIndex, Eigen::Index outputIndex,
+                 double initialSetpoint);
+
+    /// The checks addLoop() and setLoop() apply, without touching a bank
+    /// (loop only labels the error message)
+    static void validateLoop(Eigen::Index loop, const PIDController::Gains &gains,
+                             double bias, double minOutput, double maxOutput,
+                             double maxIntegral, Eigen::Index measuredIndex,
+                             Eigen::Index outputIndex);
+
+    /**
+     * @brief Update every loop from the current state and write the outputs.
+     *
+     * @param dt Control period (s)
+     * @param state Plant state to measure
+     * @param inputs Plant inputs; only the output indices are written
+     */
+    void computeAll(double dt, const Eigen::Ref<const Eigen::VectorXd> &state,
+                    Eigen::Ref<Eigen::VectorXd> inputs);
+
+    /// Zero integral states and previous errors, restore initial setpoints
+    void reset();
+
+    Eigen::Index size() const { return kc_.size(); }
+    bool empty() const { return kc_.size() == 0; }
+
+    // Per-loop access; loop must be in [0, size())
+    Eigen::Index getMeasuredIndex(Eigen::Index loop) const { return measuredIndex_(loop); }
+    Eigen::Index getOutputIndex(Eigen::Index loop) const { return outputIndex_(loop); }
+    double getSetpoint(Eigen::Index loop) const { return setpoint_(loop); }
+    void setSetpoint(Eigen::Index loop, double value) { setpoint_(loop) = value; }
+    double getPreviousError(Eigen::Index loop) const { return previousError_(loop); }
+    void setPreviousError(Eigen::Index loop, double value) { previousError_(loop) = value; }
+    double getIntegralState(Eigen::Index loop) const { return integral_(loop); }
+    /// Clamped to ±max_integral, as PIDController::setIntegralState()
+    void setIntegralState(Eigen::Index loop, double value);
+    PIDController::Gains getGains(Eigen::Index loop) const;
+    /// Keeps the integral state (bumpless), as PIDController::setGains()
+    void setGains(Eigen::Index loop, const PIDController::Gains &gains);
+
+private:
+    void resizeForLoop(Eigen::Index count);
+
+    // Parameters
+    Eigen::ArrayXd kc_;
+    Eigen::ArrayXd tauI_;
+    Eigen::ArrayXd inverseTauI_;  // 1 / tau_I, or 0 when integral action is off
+    Eigen::ArrayXd tauD_;
+    Eigen::ArrayXd bias_;
+    Eigen::ArrayXd minOutput_;
+    Eigen::ArrayXd maxOutput_;
+    Eigen::ArrayXd maxIntegral_;
+    IndexArray measuredIndex_;
+    IndexArray outputIndex_;
+    Eigen::ArrayXd initialSetpoint_;
+
+    // State
+    Eigen::ArrayXd setpoint_;
+    Eigen::ArrayXd integral_;
+    Eigen::ArrayXd previousError_;
+
+    // computeAll() scratch
+    Eigen::ArrayXd error_;
+    Eigen::ArrayXd unsaturated_;
+};
+
+}  // namespace tank_sim
+
+#endif  // TANK_SIM_PID_CONTROLLER_BANK_H
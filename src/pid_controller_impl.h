@@ -0,0 +1,118 @@
+#ifndef PID_CONTROLLER_IMPL_H
+#define PID_CONTROLLER_IMPL_H
+
+// Member definitions of BasicPIDController. pid_controller.cpp instantiates
+// PIDController; include this header only to instantiate another scalar type.
+
+#include "pid_controller.h"
+#include <stdexcept>
+
+namespace tank_sim {
+
+namespace detail {
+
+// std::clamp for a Scalar against double limits (same tests, same result for
+// double); a value exactly at a limit is returned as is, derivative included
+template <typename Scalar>
+inline Scalar clampTo(const Scalar& value, double low, double high) {
+    if (value < low) {
+        return Scalar(low);
+    }
+    if (high < value) {
+        return Scalar(high);
+    }
+    return value;
+}
+
+}  // namespace detail
+
+template <typename Scalar>
+BasicPIDController<Scalar>::BasicPIDController(const Gains& gains, double bias,
+                                               double min_output, double max_output,
+                                               double max_integral)
+    : gains(gains), bias(bias), min_output(min_output), max_output(max_output),
+      max_integral(max_integral), integral_state(0.0) {
+    // Validate parameters - fail fast
+    if (gains.tau_I < 0.0) {
+        throw std::invalid_argument("Integral time constant (tau_I) cannot be negative");
+    }
+    if (gains.tau_D < 0.0) {
+        throw std::invalid_argument("Derivative time constant (tau_D) cannot be negative");
+    }
+    if (min_output > max_output) {
+        throw std::invalid_argument("min_output must be <= max_output");
+    }
+    if (max_integral < 0.0) {
+        throw std::invalid_argument("max_integral must be non-negative");
+    }
+}
+
+template <typename Scalar>
+Scalar BasicPIDController<Scalar>::compute(const Scalar& error, const Scalar& error_dot,
+                                           double dt) {
+    // Step 1: Calculate proportional term
+    Scalar p_term = error;
+
+    // Step 2: Calculate integral term using CURRENT state
+    Scalar i_term = 0.0;
+    if (gains.tau_I != 0.0) {
+        i_term = (1.0 / gains.tau_I) * integral_state;
+    }
+
+    // Step 3: Calculate derivative term
+    Scalar d_term = gains.tau_D * error_dot;
+
+    // Step 4: Compute unsaturated output
+    Scalar output_unsat = bias + gains.Kc * (p_term + i_term + d_term);
+
+    // Step 5: Clamp to physical limits
+    Scalar output = detail::clampTo(output_unsat, min_output, max_output);
+
+    // Step 6: Anti-windup: Update integral for NEXT timestep only if NOT saturated
+    // Check if output was saturated (output differs from unsaturated value)
+    bool saturated = (output_unsat < min_output || output_unsat > max_output);
+    if (!saturated) {
+        // Only accumulate integral when we're in the linear operating range
+        integral_state = integral_state + error * dt;
+        // Also clamp integral state directly (secondary safety limit)
+        integral_state = detail::clampTo(integral_state, -max_integral, max_integral);
+    }
+
+    return output;
+}
+
+template <typename Scalar>
+void BasicPIDController<Scalar>::setGains(const Gains& gains) {
+    this->gains = gains;
+}
+
+template <typename Scalar>
+void BasicPIDController<Scalar>::setOutputLimits(double min_val, double max_val) {
+    min_output = min_val;
+    max_output = max_val;
+}
+
+template <typename Scalar>
+void BasicPIDController<Scalar>::reset() {
+    integral_state = 0.0;
+}
+
+template <typename Scalar>
+const Scalar& BasicPIDController<Scalar>::getIntegralState() const {
+    return integral_state;
+}
+
+template <typename Scalar>
+void BasicPIDController<Scalar>::setIntegralState(const Scalar& value) {
+    integral_state = detail::clampTo(value, -max_integral, max_integral);
+}
+
+template <typename Scalar>
+const typename BasicPIDController<Scalar>::Gains&
+BasicPIDController<Scalar>::getGains() const {
+    return gains;
+}
+
+}  // namespace tank_sim
+
+#endif  // PID_CONTROLLER_IMPL_H
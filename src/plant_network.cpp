@@ -0,0 +1,262 @@
+#include "plant_network.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+
+namespace tank_sim {
+
+PlantNetwork::PlantNetwork(const Topology &topology)
+    : topology_(topology) {
+    const int tanks = static_cast<int>(topology.tanks.size());
+    if (tanks == 0) {
+        throw std::invalid_argument("Plant network needs at least one tank");
+    }
+    if (topology.inputCount < 0) {
+        throw std::invalid_argument("Plant network input count cannot be negative");
+    }
+    const auto checkTank = [&](int tank, const std::string &what) {
+        if (tank < 0 || tank >= tanks) {
+            throw std::invalid_argument(what + " tank " + std::to_string(tank) +
+                                        " out of bounds for " +
+                                        std::to_string(tanks) + " tank(s)");
+        }
+    };
+    const auto checkInput = [&](int input, const std::string &what) {
+        if (input < 0 || input >= topology.inputCount) {
+            throw std::invalid_argument(what + " input " + std::to_string(input) +
+                                        " out of bounds for " +
+                                        std::to_string(topology.inputCount) +
+                                        " input(s)");
+        }
+    };
+
+    area_.resize(tanks);
+    for (int i = 0; i < tanks; ++i) {
+        const Tank &tank = topology.tanks[i];
+        if (tank.area <= 0.0 || tank.maxHeight <= 0.0) {
+            throw std::invalid_argument("Tank " + std::to_string(i) +
+                                        " area and max height must be positive");
+        }
+        area_(i) = tank.area;
+    }
+
+    for (size_t v = 0; v < topology.valves.size(); ++v) {
+        const Valve &valve = topology.valves[v];
+        const std::string what = "Valve " + std::to_string(v);
+        checkTank(valve.from, what + " source");
+        if (valve.to != DRAIN) {
+            checkTank(valve.to, what + " destination");
+        }
+        if (valve.to == valve.from) {
+            throw std::invalid_argument(what + " connects tank " +
+                                        std::to_string(valve.from) + " to itself");
+        }
+        if (valve.law == FlowLaw::HEAD_DIFFERENCE && valve.to == DRAIN) {
+            throw std::invalid_argument(what +
+                                        " uses HEAD_DIFFERENCE but drains the network");
+        }
+        if (valve.positionInput != FULLY_OPEN) {
+            checkInput(valve.positionInput, what + " position");
+        }
+        if (valve.k_v <= 0.0) {
+            throw std::invalid_argument(what + " coefficient must be positive");
+        }
+    }
+    for (size_t f = 0; f < topology.inflows.size(); ++f) {
+        const Inflow &inflow = topology.inflows[f];
+        checkTank(inflow.tank, "Inflow " + std::to_string(f));
+        checkInput(inflow.input, "Inflow " + std::to_string(f));
+    }
+
+    // Sort edges by source so the derivative pass reads levels in order
+    std::vector<int> order(topology.valves.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](int a, int b) {
+        return topology.valves[a].from < topology.valves[b].from;
+    });
+    for (int v : order) {
+        const Valve &valve = topology.valves[v];
+        edgeFrom_.push_back(valve.from);
+        edgeTo_.push_back(valve.to);
+        edgePosition_.push_back(valve.positionInput);
+        edgeKv_.push_back(valve.k_v);
+        edgeHeadDifference_.push_back(valve.law == FlowLaw::HEAD_DIFFERENCE);
+        edgeValve_.push_back(v);
+    }
+    for (const Inflow &inflow : topology.inflows) {
+        inflowTank_.push_back(inflow.tank);
+        inflowInput_.push_back(inflow.input);
+    }
+
+    // Jacobian pattern: explicit zeros so every slot exists before values do
+    std::vector<Eigen::Triplet<double>> entries;
+    for (int i = 0; i < tanks; ++i) {
+        entries.emplace_back(i, i, 0.0);
+    }
+    for (size_t e = 0; e < edgeFrom_.size(); ++e) {
+        if (edgeTo_[e] == DRAIN) {
+            continue;
+        }
+        entries.emplace_back(edgeTo_[e], edgeFrom_[e], 0.0);
+        if (edgeHeadDifference_[e]) {
+            entries.emplace_back(edgeFrom_[e], edgeTo_[e], 0.0);
+        }
+    }
+    pattern_.resize(tanks, tanks);
+    pattern_.setFromTriplets(entries.begin(), entries.end());
+    pattern_.makeCompressed();
+
+    edgeSlots_.assign(4 * edgeFrom_.size(), -1);
+    for (size_t e = 0; e < edgeFrom_.size(); ++e) {
+        const int from = edgeFrom_[e], to = edgeTo_[e];
+        edgeSlots_[4 * e] = patternSlot(from, from);
+        if (to == DRAIN) {
+            continue;
+        }
+        edgeSlots_[4 * e + 1] = patternSlot(to, from);
+        if (edgeHeadDifference_[e]) {
+            edgeSlots_[4 * e + 2] = patternSlot(from, to);
+            edgeSlots_[4 * e + 3] = patternSlot(to, to);
+        }
+    }
+}
+
+Eigen::Index PlantNetwork::patternSlot(int row, int col) const {
+    const auto *begin = pattern_.innerIndexPtr() + pattern_.outerIndexPtr()[col];
+    const auto *end = pattern_.innerIndexPtr() + pattern_.outerIndexPtr()[col + 1];
+    const auto *it = std::lower_bound(begin, end, row);
+    assert(it != end && *it == row && "Entry missing from Jacobian pattern");
+    return static_cast<Eigen::Index>(it - pattern_.innerIndexPtr());
+}
+
+PlantNetwork::Topology PlantNetwork::singleTank(const TankModel::Parameters &params) {
+    return cascade(1, params);
+}
+
+PlantNetwork::Topology PlantNetwork::cascade(int tankCount,
+                                             const TankModel::Parameters &params) {
+    if (tankCount <= 0) {
+        throw std::invalid_argument("Cascade needs at least one tank");
+    }
+    if (params.valve_characteristic != ValveCharacteristic::LINEAR) {
+        throw std::invalid_argument("PlantNetwork valves have a linear characteristic");
+    }
+    Topology topology;
+    topology.tanks.assign(tankCount, Tank{params.area, params.max_height});
+    topology.inflows.push_back(Inflow{0, constants::INPUT_INDEX_INLET_FLOW});
+    for (int i = 0; i < tankCount; ++i) {
+        topology.valves.push_back(Valve{i, i + 1 < tankCount ? i + 1 : DRAIN,
+                                        params.k_v, i + 1,
+                                        FlowLaw::FREE_DISCHARGE});
+    }
+    topology.inputCount = tankCount + 1;
+    return topology;
+}
+
+Eigen::Index PlantNetwork::getStateSize() const {
+    return area_.size();
+}
+
+Eigen::Index PlantNetwork::getInputSize() const {
+    return topology_.inputCount;
+}
+
+Eigen::Index PlantNetwork::getValveCount() const {
+    return static_cast<Eigen::Index>(edgeFrom_.size());
+}
+
+const PlantNetwork::Topology &PlantNetwork::getTopology() const {
+    return topology_;
+}
+
+inline double PlantNetwork::edgeFlow(
+    std::size_t edge, const Eigen::Ref<const Eigen::VectorXd> &state,
+    const Eigen::Ref<const Eigen::VectorXd> &inputs) const {
+    const int position = edgePosition_[edge];
+    const double x = position == FULLY_OPEN ? 1.0 : inputs(position);
+    const double h = state(edgeFrom_[edge]);
+    if (edgeHeadDifference_[edge]) {
+        const double dh = h - state(edgeTo_[edge]);
+        const double q = edgeKv_[edge] * x * std::sqrt(std::abs(dh));
+        return dh < 0.0 ? -q : q;
+    }
+    // Same expression as TankModel::outletFlow, so one tank matches it exactly
+    return h <= 0.0 ? 0.0 : edgeKv_[edge] * x * std::sqrt(h);
+}
+
+void PlantNetwork::derivatives(const Eigen::Ref<const Eigen::VectorXd> &state,
+                               const Eigen::Ref<const Eigen::VectorXd> &inputs,
+                               Eigen::Ref<Eigen::VectorXd> derivative) const {
+    assert(state.size() == area_.size() && "State vector must have one level per tank");
+    assert(inputs.size() == topology_.inputCount && "Input vector size mismatch");
+    assert(derivative.size() == area_.size() && "Derivative vector size mismatch");
+
+    derivative.setZero();
+    for (size_t f = 0; f < inflowTank_.size(); ++f) {
+        derivative(inflowTank_[f]) += inputs(inflowInput_[f]);
+    }
+    for (size_t e = 0; e < edgeFrom_.size(); ++e) {
+        const double q = edgeFlow(e, state, inputs);
+        derivative(edgeFrom_[e]) -= q;
+        if (edgeTo_[e] != DRAIN) {
+            derivative(edgeTo_[e]) += q;
+        }
+    }
+    // Material balance: net inflow over area, one vectorized pass
+    derivative.array() /= area_.array();
+}
+
+void PlantNetwork::valveFlows(const Eigen::Ref<const Eigen::VectorXd> &state,
+                              const Eigen::Ref<const Eigen::VectorXd> &inputs,
+                              Eigen::Ref<Eigen::VectorXd> flows) const {
+    assert(state.size() == area_.size() && "State vector must have one level per tank");
+    assert(inputs.size() == topology_.inputCount && "Input vector size mismatch");
+    assert(flows.size() == getValveCount() && "Flow vector size mismatch");
+    for (size_t e = 0; e < edgeFrom_.size(); ++e) {
+        flows(edgeValve_[e]) = edgeFlow(e, state, inputs);
+    }
+}
+
+const PlantNetwork::SparseMatrix &PlantNetwork::jacobianPattern() const {
+    return pattern_;
+}
+
+void PlantNetwork::jacobian(const Eigen::Ref<const Eigen::VectorXd> &state,
+                            const Eigen::Ref<const Eigen::VectorXd> &inputs,
+                            SparseMatrix &dfdx) const {
+    assert(state.size() == area_.size() && "State vector must have one level per tank");
+    assert(inputs.size() == topology_.inputCount && "Input vector size mismatch");
+    assert(dfdx.nonZeros() == pattern_.nonZeros() && dfdx.isCompressed() &&
+           "Jacobian must be a copy of jacobianPattern()");
+
+    double *values = dfdx.valuePtr();
+    std::fill(values, values + dfdx.nonZeros(), 0.0);
+    for (size_t e = 0; e < edgeFrom_.size(); ++e) {
+        const int from = edgeFrom_[e], to = edgeTo_[e];
+        const int position = edgePosition_[e];
+        const double x = position == FULLY_OPEN ? 1.0 : inputs(position);
+        const Eigen::Index *slot = &edgeSlots_[4 * e];
+
+        // slope = dq/dh_from; for HEAD_DIFFERENCE dq/dh_to = -slope
+        const double head = edgeHeadDifference_[e]
+                                ? std::abs(state(from) - state(to))
+                                : state(from);
+        const double slope = 0.5 * edgeKv_[e] * x /
+                             std::sqrt(std::max(head, constants::MIN_JACOBIAN_HEAD));
+
+        values[slot[0]] -= slope / area_(from);
+        if (to == DRAIN) {
+            continue;
+        }
+        values[slot[1]] += slope / area_(to);
+        if (edgeHeadDifference_[e]) {
+            values[slot[2]] += slope / area_(from);
+            values[slot[3]] -= slope / area_(to);
+        }
+    }
+}
+
+}  // namespace tank_sim
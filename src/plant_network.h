@@ -0,0 +1,194 @@
+#ifndef TANK_SIM_PLANT_NETWORK_H
+#define TANK_SIM_PLANT_NETWORK_H
+
+#include "tank_model.h"
+#include <Eigen/Dense>
+#include <Eigen/SparseCore>
+#include <cstddef>
+#include <vector>
+
+namespace tank_sim {
+
+/**
+ * @brief Physics model for a graph of tanks linked by valves.
+ *
+ * PlantNetwork generalizes TankModel from one tank to N. The state is the
+ * contiguous vector of tank levels [h_0, ..., h_{N-1}]; the inputs are a
+ * flat vector whose entries are referenced by index from the topology
+ * (inlet flows and valve positions), so controllers address them exactly
+ * as they address TankModel inputs.
+ *
+ * Flows:
+ * - An Inflow adds input u(input) (m³/s) to a tank.
+ * - A Valve moves liquid from one tank to another tank or to the drain:
+ *     FREE_DISCHARGE:   q = k_v * x * sqrt(h_from)                (h_from > 0)
+ *     HEAD_DIFFERENCE:  q = k_v * x * sign(dh) * sqrt(|dh|),  dh = h_from - h_to
+ *   where x is input u(positionInput), or 1 for a valve with FULLY_OPEN.
+ *
+ * Material balance for every tank: dh_i/dt = (sum of flows in - out) / A_i.
+ * A single tank with one inflow and one free-discharge valve to the drain is
+ * exactly TankModel (see singleTank()).
+ *
+ * ## Evaluation
+ *
+ * Valves are stored as a structure-of-arrays edge list, sorted by source
+ * tank, and derivatives() is one sequential pass over the inflows and one
+ * over the edges, so a step costs O(tanks + valves) with no allocation and
+ * a streaming memory access pattern for networks of thousands of tanks.
+ *
+ * jacobian() fills the analytic, sparse df/dh in the same O(valves) pass
+ * for the implicit Rosenbrock integrator: a diagonal entry per tank, plus
+ * (to, from) for every valve between tanks and (from, to) for every
+ * HEAD_DIFFERENCE valve. Heads are bounded below by
+ * constants::MIN_JACOBIAN_HEAD for the slopes, as in TankModel::jacobian().
+ *
+ * Like TankModel, the model is stateless.
+ */
+class PlantNetwork {
+public:
+    /// Valve destination meaning "leaves the network"
+    static constexpr int DRAIN = -1;
+
+    /// Valve position input meaning "no actuator, always fully open"
+    static constexpr int FULLY_OPEN = -1;
+
+    /// Column-major sparse Jacobian type
+    using SparseMatrix = Eigen::SparseMatrix<double>;
+
+    enum class FlowLaw {
+        FREE_DISCHARGE,   ///< Outflow driven by the source level only
+        HEAD_DIFFERENCE   ///< Bidirectional flow driven by the level difference
+    };
+
+    struct Tank {
+        double area;        ///< Cross-sectional area (m²)
+        double maxHeight;   ///< Maximum height (m), for reporting and limits
+    };
+
+    struct Valve {
+        int from;           ///< Source tank
+        int to;             ///< Destination tank, or DRAIN
+        double k_v;         ///< Valve coefficient (m^2.5/s)
+        int positionInput;  ///< Input index of the valve position, or FULLY_OPEN
+        FlowLaw law = FlowLaw::FREE_DISCHARGE;
+    };
+
+    struct Inflow {
+        int tank;           ///< Receiving tank
+        int input;          ///< Input index of the flow rate (m³/s)
+    };
+
+    struct Topology {
+        std::vector<Tank> tanks;
+        std::vector<Valve> valves;
+        std::vector<Inflow> inflows;
+        int inputCount = 0;  ///< Size of the input vector
+    };
+
+    /**
+     * @brief Builds the edge list for a topology.
+     *
+     * @throws std::invalid_argument if there are no tanks, an area, height
+     *         or k_v is not positive, an index is out of range, a valve
+     *         connects a tank to itself, or a HEAD_DIFFERENCE valve drains
+     */
+    explicit PlantNetwork(const Topology &topology);
+
+    /**
+     * @brief The single-tank plant of TankModel.
+     *
+     * Inputs are [q_in, x], as for TankModel.
+     */
+    static Topology singleTank(const TankModel::Parameters &params);
+
+    /**
+     * @brief tankCount identical tanks in series.
+     *
+     * Input 0 feeds tank 0; valve i (position input i + 1) discharges tank i
+     * freely into tank i + 1, and the last tank into the drain. Inputs are
+     * [q_in, x_0, ..., x_{N-1}], so tankCount = 1 reproduces singleTank().
+     *
+     * @throws std::invalid_argument if tankCount <= 0
+     */
+    static Topology cascade(int tankCount, const TankModel::Parameters &params);
+
+    Eigen::Index getStateSize() const;
+    Eigen::Index getInputSize() const;
+    Eigen::Index getValveCount() const;
+    const Topology &getTopology() const;
+
+    /**
+     * @brief Computes dh/dt for every tank into a caller-provided buffer.
+     *
+     * Matches Stepper::InPlaceDerivativeFunc (without the time argument) and
+     * does not allocate.
+     *
+     * @param state Tank levels [getStateSize()]
+     * @param inputs Input vector [getInputSize()]
+     * @param derivative Output [getStateSize()]
+     */
+    void derivatives(const Eigen::Ref<const Eigen::VectorXd> &state,
+                     const Eigen::Ref<const Eigen::VectorXd> &inputs,
+                     Eigen::Ref<Eigen::VectorXd> derivative) const;
+
+    /**
+     * @brief Flow through every valve, in topology order (m³/s).
+     *
+     * Positive values flow from the valve's source to its destination.
+     *
+     * @param flows Output [getValveCount()]
+     */
+    void valveFlows(const Eigen::Ref<const Eigen::VectorXd> &state,
+                    const Eigen::Ref<const Eigen::VectorXd> &inputs,
+                    Eigen::Ref<Eigen::VectorXd> flows) const;
+
+    /**
+     * @brief The Jacobian's sparsity pattern, with every value zero.
+     *
+     * Copy it once to get a matrix for jacobian(), or pass it to
+     * RosenbrockWorkspace::analyzePattern().
+     */
+    const SparseMatrix &jacobianPattern() const;
+
+    /**
+     * @brief Computes d(dh/dt)/dh into a matrix with jacobianPattern().
+     *
+     * Only values are written, so it does not allocate.
+     *
+     * @param dfdx Output, a copy of jacobianPattern()
+     */
+    void jacobian(const Eigen::Ref<const Eigen::VectorXd> &state,
+                  const Eigen::Ref<const Eigen::VectorXd> &inputs,
+                  SparseMatrix &dfdx) const;
+
+private:
+    /// Slot in jacobianPattern().valuePtr() of (row, col), which must exist
+    Eigen::Index patternSlot(int row, int col) const;
+
+    double edgeFlow(std::size_t edge,
+                    const Eigen::Ref<const Eigen::VectorXd> &state,
+                    const Eigen::Ref<const Eigen::VectorXd> &inputs) const;
+
+    Topology topology_;
+    Eigen::VectorXd area_;          ///< Per tank
+
+    // Edge list, structure-of-arrays, sorted by source tank
+    std::vector<int> edgeFrom_;
+    std::vector<int> edgeTo_;
+    std::vector<int> edgePosition_;
+    std::vector<double> edgeKv_;
+    std::vector<char> edgeHeadDifference_;
+    std::vector<int> edgeValve_;    ///< Topology index of each edge
+
+    SparseMatrix pattern_;
+    // Value slots per edge: (from, from), (to, from), (from, to), (to, to);
+    // -1 where the entry does not apply
+    std::vector<Eigen::Index> edgeSlots_;
+
+    std::vector<int> inflowTank_;
+    std::vector<int> inflowInput_;
+};
+
+}  // namespace tank_sim
+
+#endif  // TANK_SIM_PLANT_NETWORK_H
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <Eigen/Dense>
+
+namespace tank_sim {
+
+/**
+ * @brief Stage storage for rk4Step().
+ *
+ * Holds the four RK4 slopes and the intermediate stage state. For fixed-size
+ * vectors the workspace lives on the stack; for Eigen::VectorXd it is sized
+ * once (e.g. in a Stepper constructor) and reused so that stepping never
+ * allocates.
+ *
+ * @tparam Vector Eigen column vector type of the state
+ */
+template <typename Vector>
+struct Rk4Workspace {
+  Vector k1;     ///< Slope at t
+  Vector k2;     ///< Slope at t + dt/2 from k1
+  Vector k3;     ///< Slope at t + dt/2 from k2
+  Vector k4;     ///< Slope at t + dt from k3
+  Vector stage;  ///< Intermediate state passed to the derivative function
+
+  /// Default construction for fixed-size vectors
+  Rk4Workspace() = default;
+
+  /// Preallocates dynamic-size vectors for the given state dimension
+  explicit Rk4Workspace(Eigen::Index state_dimension)
+      : k1(state_dimension), k2(state_dimension), k3(state_dimension),
+        k4(state_dimension), stage(state_dimension) {}
+};
+
+/**
+ * @brief Native classic RK4 step, templated on the derivative functor.
+ *
+ * Unlike Stepper's GSL backend, which reaches the model through a C function
+ * pointer and a std::function, the derivative functor here is a template
+ * parameter. When it is a lambda over an inline model (as in
+ * Simulator::step()), the compiler sees straight through to the model
+ * equations and inlines every stage.
+ *
+ * The functor writes the derivative into its last argument:
+ *
+ *   deriv_func(t, y, u, dydt)
+ *
+ * where y is either the caller's state or the workspace stage vector, and
+ * dydt is one of the workspace slope vectors.
+ *
+ * @param t Current time
+ * @param dt Time step size
+ * @param state State vector, overwritten with the state at t + dt
+ * @param input Input vector, held constant over the step (zero-order hold)
+ * @param ws Preallocated stage storage matching the state dimension
+ * @param deriv_func Callable computing dy/dt = f(t, y, u) in place
+ *
+ * @note deriv_func is called exactly 4 times per step.
+ */
+template <typename State, typename Input, typename Vector,
+          typename DerivativeFunc>
+inline void rk4Step(double t, double dt, State &state, const Input &input,
+                    Rk4Workspace<Vector> &ws, DerivativeFunc &&deriv_func) {
+  const double half_dt = 0.5 * dt;
+
+  deriv_func(t, state, input, ws.k1);
+
+  ws.stage = state + half_dt * ws.k1;
+  deriv_func(t + half_dt, ws.stage, input, ws.k2);
+
+  ws.stage = state + half_dt * ws.k2;
+  deriv_func(t + half_dt, ws.stage, input, ws.k3);
+
+  ws.stage = state + dt * ws.k3;
+  deriv_func(t + dt, ws.stage, input, ws.k4);
+
+  state += (dt / 6.0) * (ws.k1 + 2.0 * ws.k2 + 2.0 * ws.k3 + ws.k4);
+}
+
+} // namespace tank_sim
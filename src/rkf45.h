@@ -0,0 +1,180 @@
+#pragma once
+
+#include <Eigen/Dense>
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+
+namespace tank_sim {
+
+/**
+ * @brief Error tolerances for adaptive integration.
+ *
+ * A step is accepted when, for every component i,
+ *
+ *   |err_i| <= absolute + relative * max(|y_i|, |y_i'|)
+ *
+ * where err is the embedded error estimate and y, y' are the states before
+ * and after the step.
+ */
+struct AdaptiveTolerances {
+  double absolute = 1e-8;
+  double relative = 1e-6;
+};
+
+/// Internal step counts reported by integrateRkf45()
+struct Rkf45Stats {
+  long long accepted = 0;  ///< Steps that met the tolerance
+  long long rejected = 0;  ///< Attempts retried with a smaller step
+};
+
+/**
+ * @brief Stage storage for integrateRkf45().
+ *
+ * Same idea as Rk4Workspace: fixed-size vectors live on the stack, dynamic
+ * ones are sized once and reused.
+ */
+template <typename Vector>
+struct Rkf45Workspace {
+  Vector k1, k2, k3, k4, k5, k6;  ///< Stage slopes
+  Vector stage;                   ///< Intermediate state
+  Vector candidate;               ///< 5th-order solution of the current attempt
+  Vector error;                   ///< Embedded error estimate
+
+  Rkf45Workspace() = default;
+
+  explicit Rkf45Workspace(Eigen::Index state_dimension)
+      : k1(state_dimension), k2(state_dimension), k3(state_dimension),
+        k4(state_dimension), k5(state_dimension), k6(state_dimension),
+        stage(state_dimension), candidate(state_dimension),
+        error(state_dimension) {}
+};
+
+/**
+ * @brief Integrates from t0 to t1 with the Runge-Kutta-Fehlberg 4(5) pair.
+ *
+ * Each attempt evaluates the six Fehlberg stages, advances with the 5th-order
+ * solution and uses its difference from the embedded 4th-order solution as
+ * the local error estimate. Steps that miss the tolerance are retried with a
+ * smaller step; accepted steps grow the next step by up to 5x. The final step
+ * is shortened to land exactly on t1.
+ *
+ * The step size is carried in and out through `step`, so successive calls
+ * over consecutive intervals (e.g. one per control period) keep the size the
+ * controller has learned. Pass step <= 0 to start with the whole interval.
+ *
+ * The derivative functor has the same in-place signature as for rk4Step():
+ * deriv_func(t, y, u, dydt). The input is held constant over [t0, t1].
+ *
+ * @param t0 Start time
+ * @param t1 End time (t1 >= t0)
+ * @param state State at t0, overwritten with the state at t1
+ * @param input Input vector, held constant over the interval
+ * @param step In: suggested first step. Out: suggested next step.
+ * @param tolerances Absolute and relative error tolerances
+ * @param ws Preallocated stage storage matching the state dimension
+ * @param deriv_func Callable computing dy/dt = f(t, y, u) in place
+ *
+ * @return Accepted and rejected step counts for this interval. Each attempt
+ *         costs six derivative evaluations.
+ *
+ * @throws std::runtime_error if the step size underflows (tolerance cannot
+ *         be met, e.g. because the derivative is not finite)
+ */
+template <typename State, typename Input, typename Vector,
+          typename DerivativeFunc>
+inline Rkf45Stats integrateRkf45(double t0, double t1, State &state,
+                                 const Input &input, double &step,
+                                 const AdaptiveTolerances &tolerances,
+                                 Rkf45Workspace<Vector> &ws,
+                                 DerivativeFunc &&deriv_func) {
+  // Fehlberg coefficients
+  constexpr double a21 = 1.0 / 4.0;
+  constexpr double a31 = 3.0 / 32.0, a32 = 9.0 / 32.0;
+  constexpr double a41 = 1932.0 / 2197.0, a42 = -7200.0 / 2197.0,
+                   a43 = 7296.0 / 2197.0;
+  constexpr double a51 = 439.0 / 216.0, a52 = -8.0, a53 = 3680.0 / 513.0,
+                   a54 = -845.0 / 4104.0;
+  constexpr double a61 = -8.0 / 27.0, a62 = 2.0, a63 = -3544.0 / 2565.0,
+                   a64 = 1859.0 / 4104.0, a65 = -11.0 / 40.0;
+  constexpr double b1 = 16.0 / 135.0, b3 = 6656.0 / 12825.0,
+                   b4 = 28561.0 / 56430.0, b5 = -9.0 / 50.0, b6 = 2.0 / 55.0;
+  // Error weights: 5th-order minus 4th-order coefficients
+  constexpr double e1 = 1.0 / 360.0, e3 = -128.0 / 4275.0,
+                   e4 = -2197.0 / 75240.0, e5 = 1.0 / 50.0, e6 = 2.0 / 55.0;
+
+  constexpr double safety = 0.9;
+  constexpr double min_factor = 0.2;
+  constexpr double max_factor = 5.0;
+
+  Rkf45Stats stats;
+  const double span = t1 - t0;
+  if (span <= 0.0) {
+    return stats;
+  }
+
+  double h = (step > 0.0 && step < span) ? step : span;
+  double t = t0;
+
+  while (t < t1) {
+    const bool last = (t + h >= t1);
+    const double h_try = last ? t1 - t : h;
+
+    deriv_func(t, state, input, ws.k1);
+    ws.stage = state + h_try * (a21 * ws.k1);
+    deriv_func(t + h_try / 4.0, ws.stage, input, ws.k2);
+    ws.stage = state + h_try * (a31 * ws.k1 + a32 * ws.k2);
+    deriv_func(t + 3.0 * h_try / 8.0, ws.stage, input, ws.k3);
+    ws.stage = state + h_try * (a41 * ws.k1 + a42 * ws.k2 + a43 * ws.k3);
+    deriv_func(t + 12.0 * h_try / 13.0, ws.stage, input, ws.k4);
+    ws.stage = state + h_try * (a51 * ws.k1 + a52 * ws.k2 + a53 * ws.k3 +
+                                a54 * ws.k4);
+    deriv_func(t + h_try, ws.stage, input, ws.k5);
+    ws.stage = state + h_try * (a61 * ws.k1 + a62 * ws.k2 + a63 * ws.k3 +
+                                a64 * ws.k4 + a65 * ws.k5);
+    deriv_func(t + h_try / 2.0, ws.stage, input, ws.k6);
+
+    ws.candidate = state + h_try * (b1 * ws.k1 + b3 * ws.k3 + b4 * ws.k4 +
+                                    b5 * ws.k5 + b6 * ws.k6);
+    ws.error = h_try * (e1 * ws.k1 + e3 * ws.k3 + e4 * ws.k4 + e5 * ws.k5 +
+                        e6 * ws.k6);
+
+    const double error_norm =
+        (ws.error.array().abs() /
+         (tolerances.absolute +
+          tolerances.relative *
+              state.array().abs().max(ws.candidate.array().abs())))
+            .maxCoeff();
+
+    // Standard step-size update for a 4th-order error estimate
+    double factor = max_factor;
+    if (error_norm > 0.0) {
+      factor = std::clamp(safety * std::pow(error_norm, -0.2), min_factor,
+                          max_factor);
+    }
+
+    if (error_norm <= 1.0) {
+      state = ws.candidate;
+      t = last ? t1 : t + h_try;
+      ++stats.accepted;
+      // Don't let a shortened final step shrink the carried-over step
+      h = last ? std::max(h, h_try * factor) : h_try * factor;
+    } else if (std::isfinite(error_norm)) {
+      ++stats.rejected;
+      h = h_try * factor;
+    } else {
+      h = 0.0;  // Non-finite derivative: fall through to the underflow check
+    }
+
+    if (!(h > 1e-12 * std::max(1.0, std::abs(t)))) {
+      throw std::runtime_error("Adaptive step size underflow at t = " +
+                               std::to_string(t));
+    }
+  }
+
+  step = h;
+  return stats;
+}
+
+}  // namespace tank_sim
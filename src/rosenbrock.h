@@ -0,0 +1,161 @@
+#pragma once
+
+#include <Eigen/Dense>
+#include <Eigen/SparseLU>
+#include <cmath>
+
+namespace tank_sim {
+
+/**
+ * @brief Stage, Jacobian and factorization storage for rosenbrockStep().
+ *
+ * Same idea as Rk4Workspace, plus the iteration matrix W = I - gamma*dt*J
+ * and its LU factorization. Use a fixed-size dense Matrix with
+ * Eigen::PartialPivLU for small plants, or Eigen::SparseMatrix with
+ * Eigen::SparseLU for networks; in the sparse case call analyzePattern()
+ * once with the Jacobian pattern and every step only refactorizes values.
+ *
+ * @tparam Vector Eigen column vector type of the state
+ * @tparam Matrix Jacobian type (dense or Eigen::SparseMatrix)
+ * @tparam Solver LU decomposition of Matrix
+ */
+template <typename Vector, typename Matrix, typename Solver>
+struct RosenbrockWorkspace {
+  Vector k1;        ///< First stage increment
+  Vector k2;        ///< Second stage increment
+  Vector stage;     ///< Intermediate state passed to the derivative function
+  Vector slope;     ///< Derivative at the current stage
+  Matrix jacobian;  ///< df/dy, written by the Jacobian functor
+  Matrix w;         ///< I - gamma * dt * jacobian
+  Solver solver;    ///< Factorization of w
+
+  /// Default construction for fixed-size vectors
+  RosenbrockWorkspace() = default;
+
+  /// Preallocates dynamic-size vectors; the caller sizes the matrices
+  explicit RosenbrockWorkspace(Eigen::Index state_dimension)
+      : k1(state_dimension), k2(state_dimension), stage(state_dimension),
+        slope(state_dimension) {}
+
+  /**
+   * @brief Fixes the sparsity pattern of a sparse Jacobian.
+   *
+   * pattern must contain every diagonal entry (explicit zeros are fine) and
+   * every entry the Jacobian functor will write.
+   */
+  template <typename Pattern>
+  void analyzePattern(const Pattern &pattern) {
+    jacobian = pattern;
+    w = pattern;
+    solver.analyzePattern(w);
+  }
+};
+
+namespace detail {
+
+// Dense decompositions factorize from scratch; SparseLU reuses the pattern
+// analyzed in RosenbrockWorkspace::analyzePattern(). Dense LU has no
+// failure report (W is never singular for the tank models, whose Jacobians
+// have a non-positive diagonal), sparse LU does.
+template <typename Solver, typename Matrix>
+inline bool factorize(Solver &solver, const Matrix &w) {
+  solver.compute(w);
+  return true;
+}
+
+template <typename Matrix, typename Ordering>
+inline bool factorize(Eigen::SparseLU<Matrix, Ordering> &solver,
+                      const Matrix &w) {
+  solver.factorize(w);
+  return solver.info() == Eigen::Success;
+}
+
+// w = I - scale * jacobian, keeping w's storage (and, if sparse, pattern)
+template <typename Scalar, int Rows, int Cols, int Options, int MaxRows,
+          int MaxCols>
+inline void formIterationMatrix(
+    Eigen::Matrix<Scalar, Rows, Cols, Options, MaxRows, MaxCols> &w,
+    const Eigen::Matrix<Scalar, Rows, Cols, Options, MaxRows, MaxCols> &jacobian,
+    double scale) {
+  w = -scale * jacobian;
+  w.diagonal().array() += 1.0;
+}
+
+template <typename Scalar, int Options, typename StorageIndex>
+inline void formIterationMatrix(
+    Eigen::SparseMatrix<Scalar, Options, StorageIndex> &w,
+    const Eigen::SparseMatrix<Scalar, Options, StorageIndex> &jacobian,
+    double scale) {
+  // Same pattern as jacobian (see analyzePattern), so values map 1:1
+  Eigen::Map<Eigen::Matrix<Scalar, Eigen::Dynamic, 1>>(w.valuePtr(),
+                                                       w.nonZeros()) =
+      -scale * Eigen::Map<const Eigen::Matrix<Scalar, Eigen::Dynamic, 1>>(
+                   jacobian.valuePtr(), jacobian.nonZeros());
+  for (Eigen::Index i = 0; i < w.rows(); ++i) {
+    w.coeffRef(i, i) += 1.0;
+  }
+}
+
+}  // namespace detail
+
+/**
+ * @brief One step of the L-stable, linearly implicit ROS2 Rosenbrock method.
+ *
+ * Solves the two linear systems (Verwer et al., 1999)
+ *
+ *   W k1 = f(y)
+ *   W k2 = f(y + dt k1) - 2 k1,        W = I - gamma dt J,  gamma = 1 + 1/sqrt(2)
+ *
+ * and advances y += dt (3/2 k1 + 1/2 k2). J = df/dy is evaluated once at the
+ * start of the step and W is factorized once, so a step costs 2 derivative
+ * evaluations, 1 Jacobian evaluation, 1 factorization and 2 solves.
+ *
+ * The method is second order and L-stable: fast modes (small surge vessels,
+ * tightly coupled tanks) are damped instead of blowing up, so dt is limited
+ * by accuracy on the slow modes, not by the fastest time constant as with
+ * rk4Step(). The models are time-invariant, so no df/dt term is needed.
+ *
+ * deriv_func has the rk4Step() signature; jacobian_func writes df/dy:
+ *
+ *   deriv_func(t, y, u, dydt)
+ *   jacobian_func(t, y, u, J)
+ *
+ * @param t Current time
+ * @param dt Time step size
+ * @param state State vector, overwritten with the state at t + dt
+ * @param input Input vector, held constant over the step (zero-order hold)
+ * @param ws Preallocated storage matching the state dimension
+ * @param deriv_func Callable computing dy/dt = f(t, y, u) in place
+ * @param jacobian_func Callable computing df/dy in place
+ *
+ * @return false if the iteration matrix could not be factorized; state is
+ *         left unchanged in that case
+ */
+template <typename State, typename Input, typename Vector, typename Matrix,
+          typename Solver, typename DerivativeFunc, typename JacobianFunc>
+inline bool rosenbrockStep(double t, double dt, State &state,
+                           const Input &input,
+                           RosenbrockWorkspace<Vector, Matrix, Solver> &ws,
+                           DerivativeFunc &&deriv_func,
+                           JacobianFunc &&jacobian_func) {
+  const double gamma = 1.0 + 1.0 / std::sqrt(2.0);
+
+  jacobian_func(t, state, input, ws.jacobian);
+  detail::formIterationMatrix(ws.w, ws.jacobian, gamma * dt);
+  if (!detail::factorize(ws.solver, ws.w)) {
+    return false;
+  }
+
+  deriv_func(t, state, input, ws.slope);
+  ws.k1 = ws.solver.solve(ws.slope);
+
+  ws.stage = state + dt * ws.k1;
+  deriv_func(t + dt, ws.stage, input, ws.slope);
+  ws.slope -= 2.0 * ws.k1;
+  ws.k2 = ws.solver.solve(ws.slope);
+
+  state += dt * (1.5 * ws.k1 + 0.5 * ws.k2);
+  return true;
+}
+
+} // namespace tank_sim
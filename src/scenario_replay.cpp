@@ -0,0 +1,448 @@
+#include "scenario_replay.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <exception>
+#include <fstream>
+#include <iomanip>
+#include <istream>
+#include <limits>
+#include <mutex>
+#include <ostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+
+namespace tank_sim {
+
+namespace {
+
+const char *const FORMAT_TAG = "tank_sim-scenario";
+constexpr int FORMAT_VERSION = 1;
+
+const char *kindName(Scenario::Event::Kind kind) {
+  switch (kind) {
+  case Scenario::Event::Kind::Input:
+    return "input";
+  case Scenario::Event::Kind::Setpoint:
+    return "setpoint";
+  case Scenario::Event::Kind::Gains:
+    return "gains";
+  }
+  return "";
+}
+
+std::invalid_argument parseError(const std::string &name, int line,
+                                 const std::string &what) {
+  return std::invalid_argument((name.empty() ? "Scenario" : name) + ":" +
+                               std::to_string(line) + ": " + what);
+}
+
+// Step index an event at time t applies before; same rounding as
+// Simulator::stepsUntil(), so an event at k * dt lands on step k
+int stepAt(double t, double dt) {
+  const double steps = t / dt;
+  if (steps <= 0.0) {
+    return 0;
+  }
+  return static_cast<int>(std::ceil(steps - 1e-9 * (1.0 + steps)));
+}
+
+// Large enough for every horizon Simulator::run() can take in one call
+constexpr double MAX_STEPS = std::numeric_limits<int>::max();
+
+}  // namespace
+
+Scenario Scenario::parse(std::istream &in, const std::string &name) {
+  Scenario scenario;
+  scenario.name = name;
+  bool haveTag = false;
+  bool haveDuration = false;
+
+  std::string text;
+  int line = 0;
+  while (std::getline(in, text)) {
+    ++line;
+    const size_t comment = text.find('#');
+    if (comment != std::string::npos) {
+      text.erase(comment);
+    }
+    std::istringstream record(text);
+    std::string first;
+    if (!(record >> first)) {
+      continue;  // Blank line
+    }
+
+    if (!haveTag) {
+      int version = 0;
+      if (first != FORMAT_TAG || !(record >> version)) {
+        throw parseError(name, line, std::string("expected '") + FORMAT_TAG +
+                                          " <version>'");
+      }
+      if (version != FORMAT_VERSION) {
+        throw parseError(name, line, "unsupported version " +
+                                          std::to_string(version));
+      }
+      haveTag = true;
+    } else if (!haveDuration) {
+      if (first != "duration" || !(record >> scenario.duration)) {
+        throw parseError(name, line, "expected 'duration <seconds>'");
+      }
+      if (!std::isfinite(scenario.duration) || scenario.duration < 0.0) {
+        throw parseError(name, line, "duration must be finite and non-negative");
+      }
+      haveDuration = true;
+    } else {
+      Event event{};
+      std::string kind;
+      std::istringstream time(first);
+      if (!(time >> event.time) || !time.eof()) {
+        throw parseError(name, line, "bad event time '" + first + "'");
+      }
+      if (!std::isfinite(event.time) || event.time < 0.0) {
+        throw parseError(name, line, "event time must be finite and non-negative");
+      }
+      if (!(record >> kind >> event.index)) {
+        throw parseError(name, line, "expected '<time> <kind> <index> ...'");
+      }
+      bool ok;
+      if (kind == "input") {
+        event.kind = Event::Kind::Input;
+        ok = static_cast<bool>(record >> event.value);
+      } else if (kind == "setpoint") {
+        event.kind = Event::Kind::Setpoint;
+        ok = static_cast<bool>(record >> event.value);
+      } else if (kind == "gains") {
+        event.kind = Event::Kind::Gains;
+        ok = static_cast<bool>(record >> event.gains.Kc >> event.gains.tau_I >>
+                               event.gains.tau_D);
+      } else {
+        throw parseError(name, line, "unknown event kind '" + kind + "'");
+      }
+      std::string extra;
+      if (!ok || record >> extra) {
+        throw parseError(name, line, "wrong number of values for a " + kind +
+                                          " event");
+      }
+      scenario.events.push_back(event);
+    }
+  }
+
+  if (!haveDuration) {
+    throw parseError(name, line, haveTag ? "missing duration"
+                                         : "empty scenario");
+  }
+  return scenario;
+}
+
+Scenario Scenario::load(const std::string &path) {
+  std::ifstream in(path);
+  if (!in) {
+    throw std::runtime_error("Cannot open scenario " + path);
+  }
+  Scenario scenario = parse(in, path);
+  if (in.bad()) {
+    throw std::runtime_error("Cannot read scenario " + path);
+  }
+  return scenario;
+}
+
+void Scenario::write(std::ostream &out) const {
+  const auto precision = out.precision(17);
+  out << FORMAT_TAG << ' ' << FORMAT_VERSION << '\n'
+      << "duration " << duration << '\n';
+  for (const Event &event : events) {
+    out << event.time << ' ' << kindName(event.kind) << ' ' << event.index;
+    if (event.kind == Event::Kind::Gains) {
+      out << ' ' << event.gains.Kc << ' ' << event.gains.tau_I << ' '
+          << event.gains.tau_D;
+    } else {
+      out << ' ' << event.value;
+    }
+    out << '\n';
+  }
+  out.precision(precision);
+}
+
+void Scenario::save(const std::string &path) const {
+  std::ofstream out(path);
+  if (!out) {
+    throw std::runtime_error("Cannot create scenario " + path);
+  }
+  write(out);
+  out.close();
+  if (!out) {
+    throw std::runtime_error("Cannot write scenario " + path);
+  }
+}
+
+ScenarioReplay::ScenarioReplay(const Simulator::Config &base,
+                               const Options &options)
+    : base(base), options(options), threadCount(options.threads) {
+  if (!(options.tolerance.absolute >= 0.0) ||
+      !(options.tolerance.relative >= 0.0)) {
+    throw std::invalid_argument("Replay tolerances must be non-negative");
+  }
+  if (options.threads < 0) {
+    throw std::invalid_argument("Thread count cannot be negative");
+  }
+
+  // Building a Simulator runs all of its config validation up front, so
+  // workers never fail on construction
+  Simulator probe(base);
+
+  if (threadCount == 0) {
+    threadCount =
+        std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+  }
+}
+
+ScenarioReplay::Plan ScenarioReplay::compile(const Scenario &scenario) const {
+  const std::string what = scenario.name.empty() ? "Scenario" : scenario.name;
+  if (!std::isfinite(scenario.duration) || scenario.duration < 0.0 ||
+      scenario.duration / base.dt > MAX_STEPS) {
+    throw std::invalid_argument(what + " duration must be finite, non-negative "
+                                       "and at most INT_MAX steps");
+  }
+
+  const auto inputCount = static_cast<int>(base.initialInputs.size());
+  const auto controllerCount = static_cast<int>(base.controllerConfig.size());
+  Plan plan;
+  plan.steps = stepAt(scenario.duration, base.dt);
+  plan.events.reserve(scenario.events.size());
+  for (size_t i = 0; i < scenario.events.size(); ++i) {
+    const Scenario::Event &event = scenario.events[i];
+    const std::string where = what + " event " + std::to_string(i);
+    if (!std::isfinite(event.time) || event.time < 0.0) {
+      throw std::invalid_argument(where + " time must be finite and non-negative");
+    }
+    const int limit =
+        event.kind == Scenario::Event::Kind::Input ? inputCount : controllerCount;
+    if (event.index < 0 || event.index >= limit) {
+      throw std::invalid_argument(
+          where + " index " + std::to_string(event.index) + " out of bounds for " +
+          std::to_string(limit) +
+          (event.kind == Scenario::Event::Kind::Input ? " input(s)"
+                                                      : " controller(s)"));
+    }
+    if (event.kind == Scenario::Event::Kind::Gains &&
+        (event.gains.tau_I < 0.0 || event.gains.tau_D < 0.0)) {
+      throw std::invalid_argument(where + " has a negative time constant");
+    }
+    // Events past the horizon never apply; dropping them here keeps the
+    // step index in range for the int conversion
+    if (event.time / base.dt <= MAX_STEPS) {
+      const int step = stepAt(event.time, base.dt);
+      if (step < plan.steps) {
+        plan.events.push_back(PlannedEvent{step, &event});
+      }
+    }
+  }
+  std::stable_sort(plan.events.begin(), plan.events.end(),
+                   [](const PlannedEvent &a, const PlannedEvent &b) {
+                     return a.step < b.step;
+                   });
+  return plan;
+}
+
+void ScenarioReplay::run(Simulator &sim, const Plan &plan,
+                         Trajectory &trajectory) const {
+  sim.reset();
+  // reset() keeps retuned gains; a scenario always starts from the base
+  for (size_t c = 0; c < base.controllerConfig.size(); ++c) {
+    sim.setControllerGains(static_cast<int>(c), base.controllerConfig[c].gains);
+  }
+  trajectory.clear();
+
+  int done = 0;
+  for (const PlannedEvent &planned : plan.events) {
+    if (planned.step > done) {
+      sim.run(planned.step - done, trajectory);
+      done = planned.step;
+    }
+    const Scenario::Event &event = *planned.event;
+    switch (event.kind) {
+    case Scenario::Event::Kind::Input:
+      sim.setInput(event.index, event.value);
+      break;
+    case Scenario::Event::Kind::Setpoint:
+      sim.setSetpoint(event.index, event.value);
+      break;
+    case Scenario::Event::Kind::Gains:
+      sim.setControllerGains(event.index, event.gains);
+      break;
+    }
+  }
+  sim.run(plan.steps - done, trajectory);
+}
+
+template <typename Work>
+void ScenarioReplay::forEach(size_t count, Work work) const {
+  std::atomic<size_t> next{0};
+  std::exception_ptr failure;
+  std::mutex failureMutex;
+
+  auto worker = [&]() {
+    try {
+      Simulator sim(base);
+      Trajectory scratch = sim.makeTrajectory(0);
+      for (size_t i = next.fetch_add(1); i < count; i = next.fetch_add(1)) {
+        work(sim, scratch, i);
+      }
+    } catch (...) {
+      std::lock_guard<std::mutex> lock(failureMutex);
+      if (!failure) {
+        failure = std::current_exception();
+      }
+      next.store(count);  // Let the other workers drain
+    }
+  };
+
+  // No point starting more workers than there are scenarios
+  const size_t workerCount = std::min(static_cast<size_t>(threadCount), count);
+  std::vector<std::thread> pool;
+  for (size_t t = 1; t < workerCount; ++t) {
+    pool.emplace_back(worker);
+  }
+  worker();  // The calling thread works too
+  for (auto &thread : pool) {
+    thread.join();
+  }
+
+  if (failure) {
+    std::rethrow_exception(failure);
+  }
+}
+
+Trajectory ScenarioReplay::replay(const Scenario &scenario) const {
+  const Plan plan = compile(scenario);
+  Simulator sim(base);
+  Trajectory trajectory = sim.makeTrajectory(plan.steps);
+  run(sim, plan, trajectory);
+  return trajectory;
+}
+
+std::vector<Trajectory>
+ScenarioReplay::replayAll(const std::vector<Scenario> &scenarios) const {
+  std::vector<Plan> plans;
+  plans.reserve(scenarios.size());
+  for (const Scenario &scenario : scenarios) {
+    plans.push_back(compile(scenario));
+  }
+
+  // Sized on the calling thread; workers only fill them
+  std::vector<Trajectory> results;
+  results.reserve(scenarios.size());
+  const Simulator shape(base);
+  for (const Plan &plan : plans) {
+    results.push_back(shape.makeTrajectory(plan.steps));
+  }
+  forEach(scenarios.size(), [&](Simulator &sim, Trajectory &, size_t i) {
+    run(sim, plans[i], results[i]);
+  });
+  return results;
+}
+
+std::vector<ScenarioReplay::Result>
+ScenarioReplay::verify(const std::vector<Scenario> &scenarios,
+                       const std::vector<Trajectory> &goldens) const {
+  if (scenarios.size() != goldens.size()) {
+    throw std::invalid_argument(
+        "Got " + std::to_string(goldens.size()) + " golden trajectories for " +
+        std::to_string(scenarios.size()) + " scenario(s)");
+  }
+  std::vector<Plan> plans;
+  plans.reserve(scenarios.size());
+  for (const Scenario &scenario : scenarios) {
+    plans.push_back(compile(scenario));
+  }
+
+  std::vector<Result> results(scenarios.size());
+  forEach(scenarios.size(), [&](Simulator &sim, Trajectory &scratch, size_t i) {
+    if (scratch.capacity() < plans[i].steps) {
+      scratch = sim.makeTrajectory(plans[i].steps);
+    }
+    run(sim, plans[i], scratch);
+    results[i] = compare(scratch, goldens[i], options.tolerance);
+  });
+  return results;
+}
+
+ScenarioReplay::Result ScenarioReplay::compare(const Trajectory &actual,
+                                               const Trajectory &golden,
+                                               const Tolerance &tolerance) {
+  Result result{true, std::min(actual.size(), golden.size()), 0.0, -1, ""};
+  const Eigen::Index n = result.samples;
+
+  const auto fail = [&](Eigen::Index sample, std::string signal) {
+    if (result.passed || sample < result.firstFailure) {
+      result.firstFailure = sample;
+      result.signal = std::move(signal);
+    }
+    result.passed = false;
+  };
+
+  if (actual.state.rows() != golden.state.rows() ||
+      actual.inputs.rows() != golden.inputs.rows() ||
+      actual.setpoint.rows() != golden.setpoint.rows()) {
+    result.samples = 0;
+    result.maxError = std::numeric_limits<double>::infinity();
+    fail(0, "shape");
+    return result;
+  }
+
+  // One contiguous row per signal, vectorized over the samples
+  const auto compareRow = [&](const double *a, const double *g,
+                              const std::string &signal) {
+    if (n == 0) {
+      return;
+    }
+    const Eigen::Map<const Eigen::ArrayXd> x(a, n), y(g, n);
+    const Eigen::ArrayXd error = (x - y).abs();
+    const auto bothNaN = x.isNaN() && y.isNaN();
+    const auto bad =
+        !(error <= tolerance.absolute + tolerance.relative * y.abs()) && !bothNaN;
+    if (bad.any()) {
+      Eigen::Index first = 0;
+      while (!bad(first)) {
+        ++first;
+      }
+      fail(first, signal);
+    }
+    // NaN against a number counts as an infinite error
+    const double rowMax =
+        bothNaN.select(0.0, error.isNaN().select(
+                                std::numeric_limits<double>::infinity(), error))
+            .maxCoeff();
+    result.maxError = std::max(result.maxError, rowMax);
+  };
+
+  compareRow(actual.time.data(), golden.time.data(), "time");
+  const std::pair<const char *, const Trajectory::SignalMatrix Trajectory::*>
+      signals[] = {{"state_", &Trajectory::state},
+                   {"input_", &Trajectory::inputs},
+                   {"setpoint_", &Trajectory::setpoint},
+                   {"error_", &Trajectory::error},
+                   {"controller_output_", &Trajectory::controllerOutput}};
+  for (const auto &[prefix, member] : signals) {
+    const Trajectory::SignalMatrix &a = actual.*member;
+    const Trajectory::SignalMatrix &g = golden.*member;
+    for (Eigen::Index i = 0; i < a.rows(); ++i) {
+      compareRow(a.row(i).data(), g.row(i).data(),
+                 prefix + std::to_string(i));
+    }
+  }
+
+  if (actual.size() != golden.size()) {
+    fail(n, "length");
+  }
+  return result;
+}
+
+int ScenarioReplay::getThreadCount() const {
+  return threadCount;
+}
+
+}  // namespace tank_sim
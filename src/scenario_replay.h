@@ -0,0 +1,192 @@
+#ifndef TANK_SIM_SCENARIO_REPLAY_H
+#define TANK_SIM_SCENARIO_REPLAY_H
+
+#include "pid_controller.h"
+#include "simulator.h"
+#include "trajectory.h"
+#include <Eigen/Dense>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+namespace tank_sim {
+
+/**
+ * @brief A recorded operator scenario: timed events over a fixed horizon.
+ *
+ * Events are the operator actions the UI can take: set an input (e.g. an
+ * inlet flow upset), move a setpoint, or retune a controller. An event at
+ * time t takes effect at the start of the first control period that begins
+ * at or after t, i.e. just before step ceil(t / dt), with the same
+ * round-off tolerance as Simulator::stepsUntil(). Events with equal times
+ * apply in file order; events at or past the horizon have no effect.
+ *
+ * ## File format
+ *
+ * Plain text, one record per line; blank lines and '#' comments are
+ * ignored. The first record is the format tag, the second the horizon:
+ *
+ *   tank_sim-scenario 1
+ *   duration 600
+ *   0    setpoint 0 3.0            # controller 0 setpoint -> 3.0
+ *   120  input    0 1.2            # input 0 (inlet flow) -> 1.2
+ *   300  gains    0 -1.5 8 0.5     # controller 0 gains -> Kc, tau_I, tau_D
+ *
+ * Events need not be in time order. write() prints 17 significant digits,
+ * so a scenario round-trips exactly.
+ */
+struct Scenario {
+  struct Event {
+    enum class Kind {
+      Input,     // inputs(index) = value
+      Setpoint,  // setpoint of controller index = value
+      Gains      // gains of controller index = gains
+    };
+
+    double time;
+    Kind kind;
+    int index;
+    double value;                // Input and Setpoint events
+    PIDController::Gains gains;  // Gains events
+  };
+
+  std::string name;        // Label for reports (load() uses the path)
+  double duration = 0.0;   // Replay horizon (s)
+  std::vector<Event> events;
+
+  /**
+   * @brief Parses a scenario in the text format above.
+   *
+   * @throws std::invalid_argument on a malformed record, with its line
+   *         number, or a negative or non-finite time or duration
+   */
+  static Scenario parse(std::istream &in, const std::string &name = "");
+
+  /**
+   * @throws std::runtime_error if the file cannot be read
+   * @throws std::invalid_argument as for parse()
+   */
+  static Scenario load(const std::string &path);
+
+  void write(std::ostream &out) const;
+
+  /// @throws std::runtime_error if the file cannot be written
+  void save(const std::string &path) const;
+};
+
+/**
+ * @class ScenarioReplay
+ * @brief Replays scenarios against a base configuration and checks them
+ *        against golden trajectories.
+ *
+ * Each scenario is compiled once into a plan: events sorted by time and
+ * mapped to the step index they apply before. The replay itself runs the
+ * bulk Simulator::run(n, trajectory) path between event steps, so the
+ * inner loop has no per-step event checks.
+ *
+ * ## Threading
+ *
+ * replayAll() and verify() use the ParameterSweep worker pool: workers
+ * (the calling thread is one of them) claim scenarios from a shared atomic
+ * counter, and each owns one Simulator and one Trajectory, reset and
+ * reused between scenarios. Results depend only on the scenario, never on
+ * the thread count or scheduling.
+ *
+ * ## Comparison
+ *
+ * compare() checks every recorded signal (time, state, inputs, setpoints,
+ * errors and controller outputs) with
+ *
+ *   |actual - golden| <= absolute + relative * |golden|
+ *
+ * one signal row at a time over contiguous arrays. NaN matches only NaN.
+ */
+class ScenarioReplay {
+public:
+  struct Tolerance {
+    double absolute = 1e-9;
+    double relative = 1e-9;
+  };
+
+  struct Options {
+    Tolerance tolerance;
+    int threads = 0;  // Worker count; 0 = hardware concurrency
+  };
+
+  struct Result {
+    bool passed;
+    Eigen::Index samples;       // Samples compared (the shorter length)
+    double maxError;            // Largest |actual - golden|; inf for a NaN mismatch
+    Eigen::Index firstFailure;  // First failing sample, -1 if passed
+    // Column of the first failure (the first in file order on a tie),
+    // named as in a TrajectoryLog ("time", "state_0", "setpoint_1", ...);
+    // "length" or "shape" if the trajectories differ in size; empty if passed
+    std::string signal;
+  };
+
+  /**
+   * @brief Prepares replays of a base configuration.
+   *
+   * @throws std::invalid_argument if the base config or options are invalid
+   */
+  ScenarioReplay(const Simulator::Config &base, const Options &options);
+
+  /**
+   * @brief Replays one scenario on the calling thread.
+   *
+   * The trajectory holds one sample per step, stepsUntil(duration) steps.
+   *
+   * @throws std::invalid_argument if an event is invalid for the base
+   *         configuration (index out of range, negative time constant,
+   *         negative or non-finite time)
+   */
+  Trajectory replay(const Scenario &scenario) const;
+
+  /**
+   * @brief Replays every scenario in parallel, in scenario order.
+   *
+   * @throws std::invalid_argument as for replay(), before any work starts
+   */
+  std::vector<Trajectory> replayAll(const std::vector<Scenario> &scenarios) const;
+
+  /**
+   * @brief Replays every scenario in parallel and compares it to its
+   *        golden trajectory, keeping only the results.
+   *
+   * @throws std::invalid_argument if the counts differ, or as for replay()
+   */
+  std::vector<Result> verify(const std::vector<Scenario> &scenarios,
+                             const std::vector<Trajectory> &goldens) const;
+
+  /// Compares two trajectories signal by signal (see class comment)
+  static Result compare(const Trajectory &actual, const Trajectory &golden,
+                        const Tolerance &tolerance);
+
+  // Number of worker threads replayAll() and verify() will use
+  int getThreadCount() const;
+
+private:
+  struct PlannedEvent {
+    int step;
+    const Scenario::Event *event;
+  };
+
+  struct Plan {
+    int steps;
+    std::vector<PlannedEvent> events;  // Sorted by step, then file order
+  };
+
+  Plan compile(const Scenario &scenario) const;
+  void run(Simulator &sim, const Plan &plan, Trajectory &trajectory) const;
+
+  template <typename Work>
+  void forEach(size_t count, Work work) const;
+
+  Simulator::Config base;
+  Options options;
+  int threadCount;
+};
+
+}  // namespace tank_sim
+
+#endif  // TANK_SIM_SCENARIO_REPLAY_H
@@ -0,0 +1,167 @@
+#include "session_pool.h"
+#include <algorithm>
+#include <exception>
+#include <stdexcept>
+#include <utility>
+
+namespace tank_sim {
+
+SessionPool::SessionPool(int threads)
+    : threadCount(threads), sessionsMutex(), sessions(), shardSizes(),
+      nextId(0), batchMutex(), batchReady(), batchDone(), generation(0),
+      pendingShards(0), stopping(false), shardTasks(), shardFailures(),
+      workers() {
+  if (threads < 0) {
+    throw std::invalid_argument("Thread count cannot be negative");
+  }
+  if (threadCount == 0) {
+    threadCount =
+        std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+  }
+  shardSizes.assign(threadCount, 0);
+  shardTasks.resize(threadCount);
+  shardFailures.resize(threadCount);
+
+  // Shard 0 runs on the thread that calls advance()
+  workers.reserve(threadCount - 1);
+  for (int shard = 1; shard < threadCount; ++shard) {
+    workers.emplace_back(&SessionPool::workerLoop, this, shard);
+  }
+}
+
+SessionPool::~SessionPool() {
+  {
+    std::lock_guard<std::mutex> lock(batchMutex);
+    stopping = true;
+  }
+  batchReady.notify_all();
+  for (auto &worker : workers) {
+    worker.join();
+  }
+}
+
+SessionPool::SessionId SessionPool::add(std::shared_ptr<Simulator> simulator) {
+  if (!simulator) {
+    throw std::invalid_argument("Session simulator cannot be null");
+  }
+  std::lock_guard<std::mutex> lock(sessionsMutex);
+  const int shard = static_cast<int>(
+      std::min_element(shardSizes.begin(), shardSizes.end()) - shardSizes.begin());
+  const SessionId session = nextId++;
+  sessions.emplace(session, Entry{std::move(simulator), shard});
+  ++shardSizes[shard];
+  return session;
+}
+
+void SessionPool::remove(SessionId session) {
+  std::lock_guard<std::mutex> lock(sessionsMutex);
+  auto it = sessions.find(session);
+  if (it == sessions.end()) {
+    throw std::out_of_range("Unknown session " + std::to_string(session));
+  }
+  --shardSizes[it->second.shard];
+  sessions.erase(it);
+}
+
+bool SessionPool::contains(SessionId session) const {
+  std::lock_guard<std::mutex> lock(sessionsMutex);
+  return sessions.count(session) != 0;
+}
+
+std::size_t SessionPool::size() const {
+  std::lock_guard<std::mutex> lock(sessionsMutex);
+  return sessions.size();
+}
+
+int SessionPool::getThreadCount() const {
+  return threadCount;
+}
+
+int SessionPool::getShard(SessionId session) const {
+  std::lock_guard<std::mutex> lock(sessionsMutex);
+  auto it = sessions.find(session);
+  if (it == sessions.end()) {
+    throw std::out_of_range("Unknown session " + std::to_string(session));
+  }
+  return it->second.shard;
+}
+
+std::vector<SessionPool::Failure>
+SessionPool::advance(const std::vector<Work> &work) {
+  std::lock_guard<std::mutex> lock(sessionsMutex);
+
+  // Validate the whole batch before anything runs
+  for (auto &tasks : shardTasks) {
+    tasks.clear();
+  }
+  for (const Work &request : work) {
+    if (request.steps < 0) {
+      throw std::invalid_argument("Step count cannot be negative, got " +
+                                  std::to_string(request.steps));
+    }
+    auto it = sessions.find(request.session);
+    if (it == sessions.end()) {
+      throw std::out_of_range("Unknown session " + std::to_string(request.session));
+    }
+    shardTasks[it->second.shard].push_back(
+        Task{it->second.simulator.get(), request.session, request.steps});
+  }
+  for (auto &failures : shardFailures) {
+    failures.clear();
+  }
+
+  if (threadCount > 1) {
+    {
+      std::lock_guard<std::mutex> batchLock(batchMutex);
+      ++generation;
+      pendingShards = threadCount - 1;
+    }
+    batchReady.notify_all();
+  }
+  runShard(0);
+  if (threadCount > 1) {
+    std::unique_lock<std::mutex> batchLock(batchMutex);
+    batchDone.wait(batchLock, [this]() { return pendingShards == 0; });
+  }
+
+  std::vector<Failure> failures;
+  for (auto &shard : shardFailures) {
+    for (auto &failure : shard) {
+      failures.push_back(std::move(failure));
+    }
+  }
+  return failures;
+}
+
+void SessionPool::workerLoop(int shard) {
+  std::uint64_t seen = 0;
+  for (;;) {
+    {
+      std::unique_lock<std::mutex> lock(batchMutex);
+      batchReady.wait(lock, [&]() { return stopping || generation != seen; });
+      if (stopping) {
+        return;
+      }
+      seen = generation;
+    }
+    runShard(shard);
+    {
+      std::lock_guard<std::mutex> lock(batchMutex);
+      if (--pendingShards == 0) {
+        batchDone.notify_one();
+      }
+    }
+  }
+}
+
+void SessionPool::runShard(int shard) {
+  for (const Task &task : shardTasks[shard]) {
+    try {
+      task.simulator->run(task.steps);
+    } catch (const std::exception &e) {
+      shardFailures[shard].push_back(Failure{task.session, e.what()});
+    }
+  }
+}
+
+}  // namespace tank_sim
@@ -0,0 +1,136 @@
+#ifndef TANK_SIM_SESSION_POOL_H
+#define TANK_SIM_SESSION_POOL_H
+
+#include "simulator.h"
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace tank_sim {
+
+/**
+ * @class SessionPool
+ * @brief Steps many independent Simulators on a fixed set of worker threads.
+ *
+ * Each session is one Simulator, shared with the caller, and is assigned
+ * for its lifetime to one of threadCount shards (the least loaded when it
+ * is added). advance() hands every shard its share of a batch of
+ * (session, steps) requests at once and blocks until all are done, so a
+ * server with hundreds of sessions makes one call per tick instead of one
+ * per session.
+ *
+ * ## Threading
+ *
+ * The threadCount - 1 workers are started by the constructor and sleep
+ * between batches; the thread calling advance() runs shard 0 itself. A
+ * session is only ever stepped by its shard's thread, and sessions share
+ * no mutable state, so each session's trajectory is exactly what stepping
+ * it alone would give, whatever the thread count or batch composition.
+ *
+ * advance(), add() and remove() are serialized with one another. A
+ * session's Simulator must not be used elsewhere while an advance() that
+ * includes it is running; a server that issues commands from the same
+ * thread that calls advance() gets this for free.
+ */
+class SessionPool {
+public:
+  using SessionId = std::uint64_t;
+
+  // Run steps steps of session in the next batch
+  struct Work {
+    SessionId session;
+    int steps;
+  };
+
+  // A session whose step threw; the message is the exception's what()
+  struct Failure {
+    SessionId session;
+    std::string message;
+  };
+
+  /**
+   * @brief Starts the workers.
+   *
+   * @param threads Shard (and thread) count; 0 = hardware concurrency
+   * @throws std::invalid_argument if threads is negative
+   */
+  explicit SessionPool(int threads = 0);
+  ~SessionPool();
+
+  SessionPool(const SessionPool &) = delete;
+  SessionPool &operator=(const SessionPool &) = delete;
+
+  /**
+   * @brief Adds a session and returns its id (ids are never reused).
+   *
+   * @throws std::invalid_argument if simulator is null
+   */
+  SessionId add(std::shared_ptr<Simulator> simulator);
+
+  /// @throws std::out_of_range for an unknown session
+  void remove(SessionId session);
+
+  bool contains(SessionId session) const;
+  std::size_t size() const;
+  int getThreadCount() const;
+
+  /// Shard the session is stepped on; @throws std::out_of_range if unknown
+  int getShard(SessionId session) const;
+
+  /**
+   * @brief Runs every request in parallel across shards, then returns.
+   *
+   * Requests for the same session run in the order given. A request whose
+   * step throws stops at that step and is reported; the rest of the batch
+   * still runs. Failures come back in shard order, then request order.
+   *
+   * @throws std::invalid_argument for a negative step count and
+   *         std::out_of_range for an unknown session, before anything runs
+   */
+  std::vector<Failure> advance(const std::vector<Work> &work);
+
+private:
+  struct Entry {
+    std::shared_ptr<Simulator> simulator;
+    int shard;
+  };
+
+  struct Task {
+    Simulator *simulator;
+    SessionId session;
+    int steps;
+  };
+
+  void workerLoop(int shard);
+  void runShard(int shard);
+
+  int threadCount;
+
+  // Session table; held for the whole of advance() so sessions cannot be
+  // removed mid-batch
+  mutable std::mutex sessionsMutex;
+  std::unordered_map<SessionId, Entry> sessions;
+  std::vector<int> shardSizes;
+  SessionId nextId;
+
+  // Batch hand-off to the workers
+  std::mutex batchMutex;
+  std::condition_variable batchReady;
+  std::condition_variable batchDone;
+  std::uint64_t generation;  // Incremented once per batch
+  int pendingShards;         // Worker shards still running the batch
+  bool stopping;
+  std::vector<std::vector<Task>> shardTasks;
+  std::vector<std::vector<Failure>> shardFailures;
+  std::vector<std::thread> workers;
+};
+
+}  // namespace tank_sim
+
+#endif  // TANK_SIM_SESSION_POOL_H
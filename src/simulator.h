@@ -1,16 +1,115 @@
 #ifndef TANK_SIMULATOR_H
 #define TANK_SIMULATOR_H
 
+#include "command_queue.h"
+#include "constants.h"
+#include "disturbance.h"
+#include "fixed_stepper.h"
+#include "history_buffer.h"
+#include "history_pyramid.h"
+#include "metrics.h"
 #include "pid_controller.h" // Include the PID controller header
+#include "pid_controller_bank.h"
+#include "rkf45.h"
+#include "rosenbrock.h"
 #include "stepper.h"
 #include "tank_model.h"
+#include "trajectory.h"
 #include <Eigen/src/Core/Matrix.h>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 namespace tank_sim {
 
-class Simulator {
-public:
+/**
+ * Model concept
+ * =============
+ *
+ * BasicSimulator<Model> integrates any plant model with compile-time
+ * dimensions; TankModel is the default. The integrators call the model
+ * directly (no virtual calls, no std::function on the default RK4 path), so
+ * its equations inline into the integrator stages. A Model provides:
+ *
+ *   typename Parameters;                         // Passed to the constructor
+ *   static constexpr int STATE_SIZE, INPUT_SIZE, OUTPUT_SIZE;
+ *   typename StateVector, InputVector, OutputVector;  // Fixed-size columns
+ *   explicit Model(const Parameters &);
+ *   StateVector derivatives(const StateVector &, const InputVector &) const;
+ *   OutputVector outputs(const StateVector &, const InputVector &) const;
+ *
+ * and optionally, detected at compile time:
+ *
+ *   jacobian(state, inputs) -> STATE_SIZE x STATE_SIZE matrix
+ *       required by Integrator::Rosenbrock
+ *   StateVector propagate(state, inputs, dt, int *iterations) const
+ *       required by Integrator::ExactZOH
+ *   StateVector project(const StateVector &) const
+ *       applied after a Rosenbrock step to map the linearized result back
+ *       into the physical domain (TankModel clamps levels at zero)
+ *
+ * Choosing an integrator the model cannot support throws
+ * std::invalid_argument from the constructor.
+ *
+ * The definitions live in simulator_impl.h. simulator.cpp instantiates
+ * Simulator (BasicSimulator<TankModel>); a translation unit that uses
+ * another model includes simulator_impl.h and instantiates it there.
+ */
+
+namespace detail {
+
+template <typename Model, typename = void>
+struct HasJacobian : std::false_type {};
+template <typename Model>
+struct HasJacobian<Model, std::void_t<decltype(std::declval<const Model &>().jacobian(
+                              std::declval<const typename Model::StateVector &>(),
+                              std::declval<const typename Model::InputVector &>()))>>
+    : std::true_type {};
+
+template <typename Model, typename = void>
+struct HasPropagate : std::false_type {};
+template <typename Model>
+struct HasPropagate<Model, std::void_t<decltype(std::declval<const Model &>().propagate(
+                               std::declval<const typename Model::StateVector &>(),
+                               std::declval<const typename Model::InputVector &>(),
+                               0.0, static_cast<int *>(nullptr)))>>
+    : std::true_type {};
+
+template <typename Model, typename = void>
+struct HasProject : std::false_type {};
+template <typename Model>
+struct HasProject<Model, std::void_t<decltype(std::declval<const Model &>().project(
+                             std::declval<const typename Model::StateVector &>()))>>
+    : std::true_type {};
+
+}  // namespace detail
+
+// Types that do not depend on the model, shared by every BasicSimulator
+struct SimulatorTypes {
+  // Integration method used by step()
+  enum class Integrator {
+    RK4,     // Native fixed-size RK4 (FixedStepper), inlined model calls
+    GslRK4,  // GSL rk4 through Stepper, kept as the verification reference
+    AdaptiveRKF45,  // Native RKF45 with error control; dt stays the control
+                    // period and is subdivided only where needed
+    Rosenbrock,  // Linearly implicit, L-stable ROS2 with the model's analytic
+                 // Jacobian, for stiff plants where RK4 would need a tiny dt
+    ExactZOH     // Closed-form solution with inputs held over dt
+                 // (TankModel::propagate()); exact at any dt
+  };
+
+  // Cumulative integrator work since construction or reset(). Fixed-step
+  // integrators take exactly one internal step per control period; ExactZOH
+  // counts its Newton iterations as derivative evaluations.
+  struct IntegrationStats {
+    long long steps = 0;                  // Accepted internal steps
+    long long rejectedSteps = 0;          // Retried adaptive attempts
+    long long derivativeEvaluations = 0;  // Model derivative calls
+    long long jacobianEvaluations = 0;    // Model Jacobian calls (Rosenbrock)
+  };
+
   struct ControllerConfig {
     tank_sim::PIDController::Gains gains; // Use the existing Gains struct
     double bias;
@@ -22,19 +121,114 @@ public:
     double initialSetpoint;
   };
 
+  // Scalar telemetry for one control loop, gathered in a single call.
+  // Controller fields are NaN when the simulator has no controllers. For
+  // models other than TankModel the plant fields are state(0), inputs(0),
+  // outputs(0) and inputs(1), or NaN where the model has no such entry.
+  struct Telemetry {
+    double time;
+    double tankLevel;
+    double setpoint;
+    double inletFlow;
+    double outletFlow;
+    double valvePosition;
+    double error;
+    double controllerOutput;
+  };
+};
+
+template <typename Model = TankModel>
+class BasicSimulator : public SimulatorTypes {
+  static_assert(Model::STATE_SIZE > 0, "Model must have at least one state");
+  static_assert(Model::INPUT_SIZE > 0, "Model must have at least one input");
+
+public:
+  using ModelType = Model;
+  using StateVector = typename Model::StateVector;
+  using InputVector = typename Model::InputVector;
+  using OutputVector = typename Model::OutputVector;
+
   struct Config {
-    tank_sim::TankModel::Parameters params;
+    typename Model::Parameters params;
     std::vector<ControllerConfig> controllerConfig;
     Eigen::VectorXd initialState;
     Eigen::VectorXd initialInputs;
     double dt;
+    Integrator integrator = Integrator::RK4;
+    AdaptiveTolerances tolerances;  // Only used by Integrator::AdaptiveRKF45
+    // When > 0, step() appends getTelemetry(0) to a HistoryBuffer holding
+    // this many of the most recent samples; reset() clears it
+    Eigen::Index historyCapacity = 0;
+    // When non-empty, step() also feeds a min/max/mean HistoryPyramid with
+    // these levels (finest first); reset() clears it
+    std::vector<HistoryPyramid::Level> historyLevels;
+    // Input upsets applied at the start of every step, before integration
+    // (see disturbance.h). Random draws come from stream disturbanceStream
+    // of disturbanceSeed, indexed by step count, so runs are reproducible.
+    std::vector<Disturbance> disturbances;
+    std::uint64_t disturbanceSeed = 0;
+    std::uint32_t disturbanceStream = 0;
+    // When > 0, post() feeds a lock-free CommandQueue of at least this many
+    // pending commands (rounded up to a power of two), drained at the start
+    // of every step(); 0 disables post()
+    Eigen::Index commandQueueCapacity = 0;
+  };
+
+  // Everything step() evolves: time, plant state and inputs, the learned
+  // adaptive step and each loop's setpoint, previous error, integral state
+  // and gains. Plain arrays only, so a snapshot is trivially copyable (a
+  // few hundred bytes, no heap) and save()/restore() cost a memcpy's worth.
+  struct Snapshot {
+    static constexpr int MAX_CONTROLLERS = 4;
+
+    struct Controller {
+      tank_sim::PIDController::Gains gains;
+      double setpoint;
+      double previousError;
+      double integralState;
+    };
+
+    double time;
+    std::uint64_t stepCount;
+    double adaptiveStep;
+    double state[Model::STATE_SIZE];
+    double inputs[Model::INPUT_SIZE];
+    int controllerCount;
+    Controller controllers[MAX_CONTROLLERS];
   };
 
   // Constructor
-  Simulator(const Config &config);
+  BasicSimulator(const Config &config);
+
+  // Movable; copies are made explicitly with fork()
+  BasicSimulator(BasicSimulator &&) = default;
+  BasicSimulator &operator=(BasicSimulator &&) = default;
 
   void step();
 
+  // Bulk stepping: advance many steps in one call. The Trajectory overloads
+  // append one sample per step (the values after that step) to a
+  // preallocated buffer; see trajectory.h for the layout. A FloatTrajectory
+  // stores each sample rounded to float; stepping itself is unchanged.
+  // Throws std::invalid_argument if the buffer's signal counts don't match
+  // this simulator or it lacks room for the requested steps.
+  void run(int nSteps);
+  void run(int nSteps, Trajectory &trajectory);
+  void run(int nSteps, FloatTrajectory &trajectory);
+
+  // Advance until getTime() reaches tEnd (to within floating-point noise),
+  // never overshooting by a full step. Returns the number of steps taken.
+  int runUntil(double tEnd);
+  int runUntil(double tEnd, Trajectory &trajectory);
+  int runUntil(double tEnd, FloatTrajectory &trajectory);
+
+  // Number of steps runUntil(tEnd) would take from the current time
+  int stepsUntil(double tEnd) const;
+
+  // Allocates a Trajectory sized for this simulator's signals
+  Trajectory makeTrajectory(Eigen::Index capacity) const;
+  FloatTrajectory makeFloatTrajectory(Eigen::Index capacity) const;
+
   // State getters (const methods - do not modify simulator state)
   double getTime() const;
   Eigen::VectorXd getState() const;
@@ -43,31 +237,134 @@ public:
   double getControllerOutput(int index) const;
   double getError(int index) const;
   int getControllerCount() const;
+  // outputs(0) of the model; NaN for a model without outputs
+  double getOutletFlow() const;
+  Eigen::VectorXd getOutputs() const;
+  Telemetry getTelemetry(int controllerIndex = 0) const;
+  const IntegrationStats &getIntegrationStats() const;
+  // Control periods stepped since construction or reset(); indexes the
+  // disturbance random streams
+  std::uint64_t getStepCount() const;
+  const std::vector<Disturbance> &getDisturbances() const;
+  // Hot-path instrumentation (see metrics.h): work counters, per-phase time
+  // and a step latency histogram. Safe to read while another thread steps.
+  // Unlike the integration stats it survives reset(); forks start at zero.
+  const Metrics &getMetrics() const;
+  void clearMetrics();
+  // Per-step history, or nullptr when Config::historyCapacity is 0
+  const HistoryBuffer *getHistory() const;
+  // Downsampled history, or nullptr when Config::historyLevels is empty
+  const HistoryPyramid *getHistoryPyramid() const;
 
   // Operator control methods
   void setInput(int index, double value);
   void setSetpoint(int index, double value);
   void setControllerGains(int index, const tank_sim::PIDController::Gains &gains);
+  // Replace the disturbance list, keeping the seed and stream; the random
+  // sequence continues from the current step count. Throws
+  // std::invalid_argument for an invalid disturbance, an input index out of
+  // range or an input written by a controller.
+  void setDisturbances(const std::vector<Disturbance> &disturbances);
+
+  // Non-blocking command ingestion, safe from any thread while another one
+  // steps. Commands are validated here (std::out_of_range for a bad index,
+  // before any is queued) and applied in posting order at the start of the
+  // next step(), before disturbances, so they land on step boundaries. The
+  // vector overload queues a prefix and returns its length; the rest are
+  // dropped if the queue fills. Throws std::runtime_error when
+  // Config::commandQueueCapacity is 0. reset() discards pending commands;
+  // forks start with an empty queue of the same capacity.
+  bool post(const Command &command);
+  Eigen::Index post(const std::vector<Command> &commands);
+  // Queue counters, or nullptr when Config::commandQueueCapacity is 0
+  const CommandQueue *getCommandQueue() const;
 
   // Utility method
   void reset();
 
+  // Rebuild from config as the constructor would, reusing this simulator's
+  // storage: controller arrays, the config and disturbance lists, and the
+  // history buffer, pyramid, command queue and GSL stepper when their sizes
+  // match. Metrics and pending commands are discarded. The whole config is
+  // validated first; on std::invalid_argument the simulator is unchanged.
+  // Reinitializing with a config of the same shape allocates nothing, which
+  // is the cheap way to cycle simulators in ensemble and fork workloads.
+  void reinit(const Config &config);
+
+  // What-if branching. save() captures the current Snapshot (throws
+  // std::runtime_error with more than Snapshot::MAX_CONTROLLERS loops);
+  // restore() rewinds to one taken from a simulator with the same config
+  // (throws std::invalid_argument if the controller count differs) and, like
+  // reset(), clears the history, since its times would no longer be ordered.
+  // fork() returns an independent copy at the current state that shares
+  // nothing with this simulator. Forks do not record history, so a branch
+  // costs a copy of a few short vectors (a GslRK4 fork allocates its GSL
+  // stepper on its first step). Integration stats are carried over.
+  Snapshot save() const;
+  void restore(const Snapshot &snapshot);
+  BasicSimulator fork() const;
+
   private:
+  // Used by fork(): copies everything except the history
+  BasicSimulator(const BasicSimulator &source);
+
+  static void validateConfig(const Config &config);
+  static bool hasLevels(const HistoryPyramid &pyramid,
+                        const std::vector<HistoryPyramid::Level> &levels);
+  template <typename Scalar>
+  void runRecorded(int nSteps, BasicTrajectory<Scalar> &trajectory);
+  template <typename Scalar>
+  void validateTrajectory(const BasicTrajectory<Scalar> &trajectory,
+                          int nSteps) const;
+  static void validateDisturbances(const std::vector<Disturbance> &list,
+                                   const std::vector<ControllerConfig> &loops);
+  template <typename Scalar>
+  void record(BasicTrajectory<Scalar> &trajectory) const;
+  void checkCommand(const Command &command) const;
+  void applyCommands();
 
-  TankModel model;
-  Stepper stepper;
-  std::vector<PIDController> controllers;
+
+  // The model has compile-time dimensions, so state and inputs are stored as
+  // fixed-size vectors and integrated with the inlinable FixedStepper. The
+  // public API still speaks Eigen::VectorXd for generality.
+  using ModelStepper = FixedStepper<Model::STATE_SIZE, Model::INPUT_SIZE>;
+  using JacobianMatrix =
+      Eigen::Matrix<double, Model::STATE_SIZE, Model::STATE_SIZE>;
+
+  Model model;
+  ModelStepper stepper;
+  Integrator integrator;
+  std::unique_ptr<Stepper> gslStepper;  // GslRK4 only, created by step()
+  AdaptiveTolerances tolerances;
+  Rkf45Workspace<StateVector> adaptiveWorkspace;
+  RosenbrockWorkspace<StateVector, JacobianMatrix,
+                      Eigen::PartialPivLU<JacobianMatrix>>
+      rosenbrockWorkspace;
+  double adaptiveStep;  // Step size carried between control periods
+  IntegrationStats stats;
+  Metrics metrics;
+  std::unique_ptr<HistoryBuffer> history;  // Only when historyCapacity > 0
+  std::unique_ptr<HistoryPyramid> pyramid;  // Only when historyLevels is set
+  std::unique_ptr<CommandQueue> commands;  // Only when commandQueueCapacity > 0
+  PIDControllerBank controllers;
+  DisturbanceGenerator disturbances;
   double time;
-  Eigen::VectorXd state;
-  Eigen::VectorXd inputs;
-  Eigen::VectorXd initialState;
-  Eigen::VectorXd initialInputs;
+  std::uint64_t stepCount;
+  StateVector state;
+  InputVector inputs;
+  StateVector initialState;
+  InputVector initialInputs;
   double dt;
-  std::vector<double> setpoints;
-  std::vector<double> previousErrors;  // For error derivative calculation
   std::vector<ControllerConfig> controllerConfig;
 };
 
+// The tank-level simulator used throughout the library and the bindings
+using Simulator = BasicSimulator<TankModel>;
+extern template class BasicSimulator<TankModel>;
+
+static_assert(std::is_trivially_copyable<Simulator::Snapshot>::value,
+              "Simulator::Snapshot must stay trivially copyable");
+
 } // namespace tank_sim
 
 #endif // TANK_SIMULATOR_H
@@ -0,0 +1,828 @@
+#ifndef TANK_SIMULATOR_IMPL_H
+#define TANK_SIMULATOR_IMPL_H
+
+// Member definitions of BasicSimulator<Model>. Included by simulator.cpp for
+// the TankModel instantiation; include it to instantiate another model.
+
+#include "simulator.h"
+#include "constants.h"
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+namespace tank_sim {
+
+template <typename Model>
+BasicSimulator<Model>::BasicSimulator(const Config &config)
+    : model(config.params), stepper(), integrator(config.integrator),
+      gslStepper(), tolerances(config.tolerances),
+      adaptiveWorkspace(), rosenbrockWorkspace(), adaptiveStep(0.0), stats(), metrics(), history(), pyramid(),
+      commands(), controllers(), disturbances(), time(0.0), stepCount(0),
+      state(StateVector::Zero()),
+      inputs(InputVector::Zero()), initialState(state),
+      initialInputs(inputs), dt(config.dt),
+      controllerConfig() {
+  reinit(config);
+}
+
+template <typename Model>
+void BasicSimulator<Model>::validateConfig(const Config &config) {
+  // Validation 1: Check state and input dimensions match the model
+  // (must happen before copying into the fixed-size members)
+  if (config.initialState.size() != Model::STATE_SIZE) {
+    throw std::invalid_argument("Initial state size " +
+                                std::to_string(config.initialState.size()) +
+                                " does not match the model's expectation of " +
+                                std::to_string(Model::STATE_SIZE));
+  }
+
+  if (config.initialInputs.size() != Model::INPUT_SIZE) {
+    throw std::invalid_argument("Initial inputs size " +
+                                std::to_string(config.initialInputs.size()) +
+                                " does not match the model's expectation of " +
+                                std::to_string(Model::INPUT_SIZE));
+  }
+
+  if (config.integrator == Integrator::Rosenbrock && !detail::HasJacobian<Model>::value) {
+    throw std::invalid_argument("Rosenbrock integrator needs Model::jacobian()");
+  }
+  if (config.integrator == Integrator::ExactZOH && !detail::HasPropagate<Model>::value) {
+    throw std::invalid_argument("ExactZOH integrator needs Model::propagate()");
+  }
+
+  const AdaptiveTolerances &tol = config.tolerances;
+  if (config.integrator == Integrator::AdaptiveRKF45 &&
+      (!(tol.absolute >= 0.0) || !(tol.relative >= 0.0) ||
+       tol.absolute + tol.relative <= 0.0)) {
+    throw std::invalid_argument(
+        "Adaptive tolerances must be non-negative and not both zero");
+  }
+
+  // Validation 2: Check dt is positive and reasonable
+  if (config.dt <= 0.0 || config.dt < constants::MIN_DT ||
+      config.dt > constants::MAX_DT) {
+    throw std::invalid_argument(
+        "dt must be positive and between " + std::to_string(constants::MIN_DT) +
+        " and " + std::to_string(constants::MAX_DT) + " seconds");
+  }
+
+  if (config.historyCapacity < 0) {
+    throw std::invalid_argument("History capacity cannot be negative");
+  }
+  if (config.commandQueueCapacity < 0) {
+    throw std::invalid_argument("Command queue capacity cannot be negative");
+  }
+
+  // Validation 3: Check controller indices are in bounds and PID
+  // parameters are valid
+  for (size_t i = 0; i < config.controllerConfig.size(); ++i) {
+    const auto &ctrl = config.controllerConfig[i];
+
+    if (ctrl.measuredIndex < 0 || ctrl.measuredIndex >= Model::STATE_SIZE) {
+      throw std::invalid_argument(
+          "Controller " + std::to_string(i) + " measured_index " +
+          std::to_string(ctrl.measuredIndex) + " is out of bounds for state " +
+          "vector of size " + std::to_string(Model::STATE_SIZE));
+    }
+
+    if (ctrl.outputIndex < 0 || ctrl.outputIndex >= Model::INPUT_SIZE) {
+      throw std::invalid_argument(
+          "Controller " + std::to_string(i) + " output_index " +
+          std::to_string(ctrl.outputIndex) + " is out of bounds for input " +
+          "vector of size " + std::to_string(Model::INPUT_SIZE));
+    }
+
+    PIDControllerBank::validateLoop(
+        static_cast<Eigen::Index>(i), ctrl.gains, ctrl.bias, ctrl.minOutputLimit,
+        ctrl.maxOutputLimit, ctrl.maxIntegralAccumulation, ctrl.measuredIndex,
+        ctrl.outputIndex);
+  }
+
+  // Validation 4: Disturbances, which may not target a controlled input
+  validateDisturbances(config.disturbances, config.controllerConfig);
+}
+
+template <typename Model>
+void BasicSimulator<Model>::reinit(const Config &config) {
+  validateConfig(config);
+
+  // Buffers whose shape changed are built before anything is modified, so
+  // a failure here (e.g. invalid history levels) also leaves *this intact
+  std::unique_ptr<HistoryBuffer> newHistory;
+  if (config.historyCapacity > 0 &&
+      !(history && history->capacity() == config.historyCapacity)) {
+    newHistory = std::make_unique<HistoryBuffer>(config.historyCapacity);
+  }
+  std::unique_ptr<HistoryPyramid> newPyramid;
+  if (!config.historyLevels.empty() &&
+      !(pyramid && hasLevels(*pyramid, config.historyLevels))) {
+    newPyramid = std::make_unique<HistoryPyramid>(config.historyLevels);
+  }
+  std::unique_ptr<CommandQueue> newCommands;
+  if (config.commandQueueCapacity > 0 &&
+      !(commands && commands->capacity() >= config.commandQueueCapacity &&
+        commands->capacity() < 2 * config.commandQueueCapacity)) {
+    newCommands = std::make_unique<CommandQueue>(config.commandQueueCapacity);
+  }
+
+  // Everything below is validated and only reuses or releases storage
+  model = Model(config.params);
+  integrator = config.integrator;
+  tolerances = config.tolerances;
+  dt = config.dt;
+  initialState = config.initialState;
+  initialInputs = config.initialInputs;
+  controllerConfig = config.controllerConfig;  // Reuses the capacity
+
+  // The GSL stepper is created by the first GslRK4 step and then kept
+  if (integrator != Integrator::GslRK4) {
+    gslStepper.reset();
+  }
+
+  if (config.historyCapacity == 0) {
+    history.reset();
+  } else if (newHistory) {
+    history = std::move(newHistory);
+  }
+  if (config.historyLevels.empty()) {
+    pyramid.reset();
+  } else if (newPyramid) {
+    pyramid = std::move(newPyramid);
+  }
+  if (config.commandQueueCapacity == 0) {
+    commands.reset();
+  } else if (newCommands) {
+    commands = std::move(newCommands);
+  }
+
+  // Controllers start at their initial setpoints with zero previous error
+  // (at steady state, error should be zero)
+  controllers.resize(static_cast<Eigen::Index>(controllerConfig.size()));
+  for (size_t i = 0; i < controllerConfig.size(); ++i) {
+    const auto &ctrl = controllerConfig[i];
+    controllers.setLoop(static_cast<Eigen::Index>(i), ctrl.gains, ctrl.bias,
+                        ctrl.minOutputLimit, ctrl.maxOutputLimit,
+                        ctrl.maxIntegralAccumulation, ctrl.measuredIndex,
+                        ctrl.outputIndex, ctrl.initialSetpoint);
+  }
+  disturbances.assign(config.disturbances, dt, config.disturbanceSeed,
+                      config.disturbanceStream);
+
+  // Time, state, inputs, stats and buffers as reset() leaves them
+  reset();
+  metrics.clear();
+}
+
+template <typename Model>
+bool BasicSimulator<Model>::hasLevels(const HistoryPyramid &pyramid,
+                                      const std::vector<HistoryPyramid::Level> &levels) {
+  if (pyramid.getLevelCount() != static_cast<int>(levels.size())) {
+    return false;
+  }
+  for (int i = 0; i < pyramid.getLevelCount(); ++i) {
+    const HistoryPyramid::Level &level = pyramid.getLevel(i);
+    if (level.factor != levels[i].factor || level.capacity != levels[i].capacity) {
+      return false;
+    }
+  }
+  return true;
+}
+
+template <typename Model>
+BasicSimulator<Model>::BasicSimulator(const BasicSimulator &source)
+    : model(source.model), stepper(source.stepper),
+      integrator(source.integrator), gslStepper(),
+      tolerances(source.tolerances),
+      adaptiveWorkspace(source.adaptiveWorkspace),
+      rosenbrockWorkspace(source.rosenbrockWorkspace),
+      adaptiveStep(source.adaptiveStep), stats(source.stats), metrics(),
+      history(),
+      pyramid(), commands(), controllers(source.controllers),
+      disturbances(source.disturbances), time(source.time),
+      stepCount(source.stepCount),
+      state(source.state), inputs(source.inputs),
+      initialState(source.initialState), initialInputs(source.initialInputs),
+      dt(source.dt), controllerConfig(source.controllerConfig) {
+  // gslStepper stays null: GSL driver state is per-instance, so the fork
+  // creates its own on its first GslRK4 step
+
+  // Producers post to the original; the fork gets a queue of its own
+  if (source.commands) {
+    commands = std::make_unique<CommandQueue>(source.commands->capacity());
+  }
+}
+
+template <typename Model>
+void BasicSimulator<Model>::step() {
+  StepTimer timer(metrics);
+  const IntegrationStats before = stats;
+
+  // Step 0: Apply queued operator commands, then input disturbances for the
+  // period [time, time + dt)
+  if (commands) {
+    applyCommands();
+  }
+  disturbances.apply(stepCount, time, inputs);
+
+  // Step 1: Integrate the model forward
+  // Uses RK4 integration with:
+  // - Current time
+  // - Time step dt
+  // - Current state vector
+  // - Current input vector (from PREVIOUS timestep)
+  // - Derivative function
+  switch (integrator) {
+  case Integrator::GslRK4:
+    // Created on first use, so construction, fork() and reinit() never pay
+    // for a GSL allocation that is not stepped
+    if (!gslStepper) {
+      gslStepper = std::make_unique<Stepper>(Model::STATE_SIZE,
+                                             Model::INPUT_SIZE,
+                                             Stepper::Backend::GSL);
+    }
+    // Bound per step rather than stored, so moved and forked simulators never
+    // call through a stale this (the capture fits std::function's small buffer)
+    gslStepper->step(time, dt, state, inputs,
+                     [this](double, const Eigen::Ref<const Eigen::VectorXd> &x,
+                            const Eigen::Ref<const Eigen::VectorXd> &u,
+                            Eigen::Ref<Eigen::VectorXd> dxdt) {
+                       dxdt = model.derivatives(StateVector(x), InputVector(u));
+                       ++stats.derivativeEvaluations;
+                     });
+    ++stats.steps;
+    break;
+
+  case Integrator::AdaptiveRKF45: {
+    // The controller still samples once per dt; only the plant integration
+    // inside the control period is subdivided
+    Rkf45Stats interval = integrateRkf45(
+        time, time + dt, state, inputs, adaptiveStep, tolerances,
+        adaptiveWorkspace,
+        [this](double, const StateVector &x,
+               const InputVector &u, StateVector &dxdt) {
+          dxdt = model.derivatives(x, u);
+        });
+    stats.steps += interval.accepted;
+    stats.rejectedSteps += interval.rejected;
+    stats.derivativeEvaluations += 6 * (interval.accepted + interval.rejected);
+    break;
+  }
+
+  case Integrator::Rosenbrock:
+    if constexpr (detail::HasJacobian<Model>::value) {
+      const bool ok = rosenbrockStep(
+          time, dt, state, inputs, rosenbrockWorkspace,
+          [this](double, const StateVector &x,
+                 const InputVector &u, StateVector &dxdt) {
+            dxdt = model.derivatives(x, u);
+          },
+          [this](double, const StateVector &x,
+                 const InputVector &u,
+                 JacobianMatrix &jacobian) {
+            jacobian = model.jacobian(x, u);
+          });
+      if (!ok) {
+        throw std::runtime_error("Rosenbrock step failed: singular iteration matrix");
+      }
+      // The linearization can leave the physical domain (e.g. undershoot a
+      // tank that empties within one step); the model maps it back
+      if constexpr (detail::HasProject<Model>::value) {
+        state = model.project(state);
+      }
+      ++stats.steps;
+      stats.derivativeEvaluations += 2;
+      ++stats.jacobianEvaluations;
+    }
+    break;
+
+  case Integrator::ExactZOH:
+    if constexpr (detail::HasPropagate<Model>::value) {
+      // Inputs are already held over [time, time + dt), which is exactly the
+      // zero-order hold the closed form assumes
+      int iterations = 0;
+      state = model.propagate(state, inputs, dt, &iterations);
+      ++stats.steps;
+      stats.derivativeEvaluations += iterations;
+    }
+    break;
+
+  case Integrator::RK4:
+    // The lambda is a template argument of FixedStepper, so the model
+    // equations inline into the RK4 stages
+    state = stepper.step(
+        time, dt, state, inputs,
+        [this](double, const StateVector &x,
+               const InputVector &u) {
+          return model.derivatives(x, u);
+        });
+    ++stats.steps;
+    stats.derivativeEvaluations += 4;
+    break;
+  }
+
+  metrics.addWork(
+      static_cast<std::uint64_t>(stats.steps - before.steps),
+      static_cast<std::uint64_t>(stats.derivativeEvaluations -
+                                 before.derivativeEvaluations),
+      static_cast<std::uint64_t>(stats.jacobianEvaluations -
+                                 before.jacobianEvaluations));
+  timer.mark(Metrics::INTEGRATION);
+
+  // Step 2: Advance simulation time
+  time += dt;
+  ++stepCount;
+
+  // Step 3: Update all controllers for NEXT step
+  // Each loop reads its measured value from the current state, computes
+  // error = setpoint - measured and error_dot by backward difference (a
+  // one-step delay, standard for discrete-time PID), and writes its output
+  // to the inputs vector; the bank does every loop in one vectorized pass
+  controllers.computeAll(dt, state, inputs);
+  timer.mark(Metrics::CONTROL);
+
+  // Step 4: Record the post-step telemetry (the same values a caller would
+  // read back with getTelemetry(0))
+  if (history || pyramid) {
+    const Telemetry t = getTelemetry(0);
+    const HistoryBuffer::Sample sample{t.time, t.tankLevel, t.setpoint,
+                                       t.inletFlow, t.outletFlow,
+                                       t.valvePosition, t.error,
+                                       t.controllerOutput};
+    if (history) {
+      history->append(sample);
+    }
+    if (pyramid) {
+      pyramid->append(sample);
+    }
+  }
+  timer.mark(Metrics::RECORDING);
+}
+
+template <typename Model>
+void BasicSimulator<Model>::run(int nSteps) {
+  if (nSteps < 0) {
+    throw std::invalid_argument("Step count cannot be negative, got " +
+                                std::to_string(nSteps));
+  }
+  for (int i = 0; i < nSteps; ++i) {
+    step();
+  }
+}
+
+template <typename Model>
+void BasicSimulator<Model>::run(int nSteps, Trajectory &trajectory) {
+  runRecorded(nSteps, trajectory);
+}
+
+template <typename Model>
+void BasicSimulator<Model>::run(int nSteps, FloatTrajectory &trajectory) {
+  runRecorded(nSteps, trajectory);
+}
+
+template <typename Model>
+template <typename Scalar>
+void BasicSimulator<Model>::runRecorded(int nSteps,
+                                        BasicTrajectory<Scalar> &trajectory) {
+  if (nSteps < 0) {
+    throw std::invalid_argument("Step count cannot be negative, got " +
+                                std::to_string(nSteps));
+  }
+  // Validate once up front so the loop itself has no checks
+  validateTrajectory(trajectory, nSteps);
+  for (int i = 0; i < nSteps; ++i) {
+    step();
+    record(trajectory);
+  }
+}
+
+template <typename Model>
+int BasicSimulator<Model>::stepsUntil(double tEnd) const {
+  // Relative tolerance absorbs accumulated round-off in time += dt, so that
+  // e.g. runUntil(10.0) with dt = 0.1 takes 100 steps, not 101
+  double remaining = (tEnd - time) / dt;
+  if (remaining <= 0.0) {
+    return 0;
+  }
+  return static_cast<int>(std::ceil(remaining - 1e-9 * (1.0 + remaining)));
+}
+
+template <typename Model>
+int BasicSimulator<Model>::runUntil(double tEnd) {
+  int nSteps = stepsUntil(tEnd);
+  run(nSteps);
+  return nSteps;
+}
+
+template <typename Model>
+int BasicSimulator<Model>::runUntil(double tEnd, Trajectory &trajectory) {
+  int nSteps = stepsUntil(tEnd);
+  run(nSteps, trajectory);
+  return nSteps;
+}
+
+template <typename Model>
+int BasicSimulator<Model>::runUntil(double tEnd, FloatTrajectory &trajectory) {
+  int nSteps = stepsUntil(tEnd);
+  run(nSteps, trajectory);
+  return nSteps;
+}
+
+template <typename Model>
+Trajectory BasicSimulator<Model>::makeTrajectory(Eigen::Index capacity) const {
+  return Trajectory(capacity, state.size(), inputs.size(),
+                    static_cast<Eigen::Index>(controllerConfig.size()));
+}
+
+template <typename Model>
+FloatTrajectory
+BasicSimulator<Model>::makeFloatTrajectory(Eigen::Index capacity) const {
+  return FloatTrajectory(capacity, state.size(), inputs.size(),
+                         static_cast<Eigen::Index>(controllerConfig.size()));
+}
+
+template <typename Model>
+template <typename Scalar>
+void BasicSimulator<Model>::validateTrajectory(
+    const BasicTrajectory<Scalar> &trajectory, int nSteps) const {
+  if (trajectory.state.rows() != state.size() ||
+      trajectory.inputs.rows() != inputs.size() ||
+      trajectory.setpoint.rows() != static_cast<Eigen::Index>(controllerConfig.size()) ||
+      trajectory.error.rows() != static_cast<Eigen::Index>(controllerConfig.size()) ||
+      trajectory.controllerOutput.rows() !=
+          static_cast<Eigen::Index>(controllerConfig.size())) {
+    throw std::invalid_argument(
+        "Trajectory signal counts do not match simulator (state " +
+        std::to_string(state.size()) + ", inputs " +
+        std::to_string(inputs.size()) + ", controllers " +
+        std::to_string(controllerConfig.size()) + ")");
+  }
+  if (trajectory.remaining() < nSteps) {
+    throw std::invalid_argument(
+        "Trajectory has room for " + std::to_string(trajectory.remaining()) +
+        " samples but " + std::to_string(nSteps) + " steps were requested");
+  }
+}
+
+template <typename Model>
+template <typename Scalar>
+void BasicSimulator<Model>::record(BasicTrajectory<Scalar> &trajectory) const {
+  Eigen::Index k = trajectory.append();
+  trajectory.time(k) = time;
+  trajectory.state.col(k) = state.template cast<Scalar>();
+  trajectory.inputs.col(k) = inputs.template cast<Scalar>();
+  for (size_t i = 0; i < controllerConfig.size(); ++i) {
+    const auto c = static_cast<Eigen::Index>(i);
+    trajectory.setpoint(c, k) = static_cast<Scalar>(controllers.getSetpoint(c));
+    trajectory.error(c, k) = static_cast<Scalar>(
+        controllers.getSetpoint(c) - state(controllerConfig[i].measuredIndex));
+    trajectory.controllerOutput(c, k) =
+        static_cast<Scalar>(inputs(controllerConfig[i].outputIndex));
+  }
+}
+
+template <typename Model>
+double BasicSimulator<Model>::getTime() const {
+  return time;
+}
+
+template <typename Model>
+Eigen::VectorXd BasicSimulator<Model>::getState() const {
+  return state;
+}
+
+template <typename Model>
+Eigen::VectorXd BasicSimulator<Model>::getInputs() const {
+  return inputs;
+}
+
+template <typename Model>
+double BasicSimulator<Model>::getSetpoint(int index) const {
+  if (index < 0 || static_cast<size_t>(index) >= controllerConfig.size()) {
+    throw std::out_of_range("Setpoint index " + std::to_string(index) +
+                            " out of bounds for " + std::to_string(controllerConfig.size()) +
+                            " controller(s)");
+  }
+  return controllers.getSetpoint(index);
+}
+
+template <typename Model>
+double BasicSimulator<Model>::getControllerOutput(int index) const {
+  if (index < 0 || static_cast<size_t>(index) >= controllerConfig.size()) {
+    throw std::out_of_range("Controller index " + std::to_string(index) +
+                            " out of bounds for " + std::to_string(controllerConfig.size()) +
+                            " controller(s)");
+  }
+  // Get the controller's output from the inputs vector
+  int output_index = controllerConfig[index].outputIndex;
+  return inputs(output_index);
+}
+
+template <typename Model>
+double BasicSimulator<Model>::getError(int index) const {
+  if (index < 0 || static_cast<size_t>(index) >= controllerConfig.size()) {
+    throw std::out_of_range("Controller index " + std::to_string(index) +
+                            " out of bounds for " + std::to_string(controllerConfig.size()) +
+                            " controller(s)");
+  }
+  // Calculate error: setpoint - measured_value
+  int measured_index = controllerConfig[index].measuredIndex;
+  double measured_value = state(measured_index);
+  double setpoint = controllers.getSetpoint(index);
+  return setpoint - measured_value;
+}
+
+template <typename Model>
+double BasicSimulator<Model>::getOutletFlow() const {
+  if constexpr (Model::OUTPUT_SIZE > 0) {
+    return model.outputs(state, inputs)(0);
+  } else {
+    return std::numeric_limits<double>::quiet_NaN();
+  }
+}
+
+template <typename Model>
+Eigen::VectorXd BasicSimulator<Model>::getOutputs() const {
+  return model.outputs(state, inputs);
+}
+
+template <typename Model>
+SimulatorTypes::Telemetry BasicSimulator<Model>::getTelemetry(int controllerIndex) const {
+  Telemetry telemetry;
+  telemetry.time = time;
+  telemetry.tankLevel = state(0);
+  telemetry.outletFlow = getOutletFlow();
+  // Tank input layout; a model with fewer inputs reports NaN
+  const double nan = std::numeric_limits<double>::quiet_NaN();
+  telemetry.inletFlow = nan;
+  telemetry.valvePosition = nan;
+  if constexpr (Model::INPUT_SIZE > constants::INPUT_INDEX_INLET_FLOW) {
+    telemetry.inletFlow = inputs(constants::INPUT_INDEX_INLET_FLOW);
+  }
+  if constexpr (Model::INPUT_SIZE > constants::INPUT_INDEX_VALVE_POSITION) {
+    telemetry.valvePosition = inputs(constants::INPUT_INDEX_VALVE_POSITION);
+  }
+
+  if (controllers.empty() && controllerIndex == 0) {
+    // Open loop: no setpoint to report
+    telemetry.setpoint = nan;
+    telemetry.error = nan;
+    telemetry.controllerOutput = nan;
+    return telemetry;
+  }
+
+  telemetry.setpoint = getSetpoint(controllerIndex);  // Bounds-checked
+  telemetry.error = getError(controllerIndex);
+  telemetry.controllerOutput = getControllerOutput(controllerIndex);
+  return telemetry;
+}
+
+template <typename Model>
+const SimulatorTypes::IntegrationStats &BasicSimulator<Model>::getIntegrationStats() const {
+  return stats;
+}
+
+template <typename Model>
+const Metrics &BasicSimulator<Model>::getMetrics() const {
+  return metrics;
+}
+
+template <typename Model>
+void BasicSimulator<Model>::clearMetrics() {
+  metrics.clear();
+}
+
+template <typename Model>
+const HistoryBuffer *BasicSimulator<Model>::getHistory() const {
+  return history.get();
+}
+
+template <typename Model>
+const HistoryPyramid *BasicSimulator<Model>::getHistoryPyramid() const {
+  return pyramid.get();
+}
+
+template <typename Model>
+void BasicSimulator<Model>::setInput(int index, double value) {
+  if (index < 0 || static_cast<size_t>(index) >= inputs.size()) {
+    throw std::out_of_range("Input index " + std::to_string(index) +
+                            " out of bounds for input vector of size " +
+                            std::to_string(inputs.size()));
+  }
+  inputs(index) = value;
+}
+
+template <typename Model>
+void BasicSimulator<Model>::setSetpoint(int index, double value) {
+  if (index < 0 || static_cast<size_t>(index) >= controllerConfig.size()) {
+    throw std::out_of_range("Setpoint index " + std::to_string(index) +
+                            " out of bounds for " + std::to_string(controllerConfig.size()) +
+                            " controller(s)");
+  }
+  controllers.setSetpoint(index, value);
+}
+
+template <typename Model>
+void BasicSimulator<Model>::setControllerGains(
+    int index, const tank_sim::PIDController::Gains &gains) {
+  if (index < 0 || static_cast<size_t>(index) >= controllerConfig.size()) {
+    throw std::out_of_range("Controller index " + std::to_string(index) +
+                            " out of bounds for " + std::to_string(controllerConfig.size()) +
+                            " controller(s)");
+  }
+  controllers.setGains(index, gains);
+}
+
+template <typename Model>
+void BasicSimulator<Model>::checkCommand(const Command &command) const {
+  const bool input = command.kind == Command::Kind::INPUT;
+  const auto limit = input ? static_cast<int>(inputs.size())
+                           : static_cast<int>(controllerConfig.size());
+  if (command.index < 0 || command.index >= limit) {
+    throw std::out_of_range(
+        std::string(input ? "Input" : "Controller") + " index " +
+        std::to_string(command.index) + " out of bounds for " +
+        std::to_string(limit) + (input ? " input(s)" : " controller(s)"));
+  }
+}
+
+template <typename Model>
+bool BasicSimulator<Model>::post(const Command &command) {
+  if (!commands) {
+    throw std::runtime_error("Simulator has no command queue "
+                             "(Config::commandQueueCapacity is 0)");
+  }
+  checkCommand(command);
+  return commands->push(command);
+}
+
+template <typename Model>
+Eigen::Index BasicSimulator<Model>::post(const std::vector<Command> &batch) {
+  if (!commands) {
+    throw std::runtime_error("Simulator has no command queue "
+                             "(Config::commandQueueCapacity is 0)");
+  }
+  for (const Command &command : batch) {
+    checkCommand(command);
+  }
+  return commands->push(batch.data(), static_cast<Eigen::Index>(batch.size()));
+}
+
+template <typename Model>
+void BasicSimulator<Model>::applyCommands() {
+  // Indices were checked by post(), so this is the same as the setters
+  // without their checks
+  Command command;
+  while (commands->pop(command)) {
+    switch (command.kind) {
+    case Command::Kind::INPUT:
+      inputs(command.index) = command.value;
+      break;
+    case Command::Kind::SETPOINT:
+      controllers.setSetpoint(command.index, command.value);
+      break;
+    case Command::Kind::GAINS:
+      controllers.setGains(command.index, command.gains);
+      break;
+    }
+  }
+}
+
+template <typename Model>
+const CommandQueue *BasicSimulator<Model>::getCommandQueue() const {
+  return commands.get();
+}
+
+template <typename Model>
+void BasicSimulator<Model>::reset() {
+  // Reset simulation to initial conditions
+  time = 0.0;
+  stepCount = 0;
+  state = initialState;
+  inputs = initialInputs;
+  
+  // Reset controller integral states, setpoints and previous errors
+  controllers.reset();
+
+  // Forget the learned adaptive step and the work counters
+  adaptiveStep = 0.0;
+  stats = IntegrationStats();
+
+  if (history) {
+    history->clear();
+  }
+  if (pyramid) {
+    pyramid->clear();
+  }
+  if (commands) {
+    commands->clear();
+  }
+}
+
+template <typename Model>
+int BasicSimulator<Model>::getControllerCount() const {
+  return static_cast<int>(controllerConfig.size());
+}
+
+template <typename Model>
+typename BasicSimulator<Model>::Snapshot BasicSimulator<Model>::save() const {
+  if (controllerConfig.size() > static_cast<size_t>(Snapshot::MAX_CONTROLLERS)) {
+    throw std::runtime_error(
+        "Snapshots hold at most " + std::to_string(Snapshot::MAX_CONTROLLERS) +
+        " controllers, simulator has " + std::to_string(controllerConfig.size()));
+  }
+  Snapshot snapshot{};
+  snapshot.time = time;
+  snapshot.stepCount = stepCount;
+  snapshot.adaptiveStep = adaptiveStep;
+  for (int i = 0; i < Model::STATE_SIZE; ++i) {
+    snapshot.state[i] = state(i);
+  }
+  for (int i = 0; i < Model::INPUT_SIZE; ++i) {
+    snapshot.inputs[i] = inputs(i);
+  }
+  snapshot.controllerCount = static_cast<int>(controllerConfig.size());
+  for (size_t i = 0; i < controllerConfig.size(); ++i) {
+    typename Snapshot::Controller &saved = snapshot.controllers[i];
+    const auto loop = static_cast<Eigen::Index>(i);
+    saved.gains = controllers.getGains(loop);
+    saved.setpoint = controllers.getSetpoint(loop);
+    saved.previousError = controllers.getPreviousError(loop);
+    saved.integralState = controllers.getIntegralState(loop);
+  }
+  return snapshot;
+}
+
+template <typename Model>
+void BasicSimulator<Model>::restore(const Snapshot &snapshot) {
+  if (snapshot.controllerCount != static_cast<int>(controllerConfig.size())) {
+    throw std::invalid_argument(
+        "Snapshot has " + std::to_string(snapshot.controllerCount) +
+        " controller(s) but the simulator has " +
+        std::to_string(controllerConfig.size()));
+  }
+  time = snapshot.time;
+  stepCount = snapshot.stepCount;
+  adaptiveStep = snapshot.adaptiveStep;
+  for (int i = 0; i < Model::STATE_SIZE; ++i) {
+    state(i) = snapshot.state[i];
+  }
+  for (int i = 0; i < Model::INPUT_SIZE; ++i) {
+    inputs(i) = snapshot.inputs[i];
+  }
+  for (size_t i = 0; i < controllerConfig.size(); ++i) {
+    const typename Snapshot::Controller &saved = snapshot.controllers[i];
+    const auto loop = static_cast<Eigen::Index>(i);
+    controllers.setGains(loop, saved.gains);
+    controllers.setIntegralState(loop, saved.integralState);
+    controllers.setSetpoint(loop, saved.setpoint);
+    controllers.setPreviousError(loop, saved.previousError);
+  }
+
+  if (history) {
+    history->clear();
+  }
+  if (pyramid) {
+    pyramid->clear();
+  }
+}
+
+template <typename Model>
+void BasicSimulator<Model>::validateDisturbances(
+    const std::vector<Disturbance> &list,
+    const std::vector<ControllerConfig> &loops) {
+  DisturbanceGenerator::validate(list);
+  DisturbanceGenerator::validateInputs(list, Model::INPUT_SIZE, [&loops](int index) {
+    for (const auto &ctrl : loops) {
+      if (ctrl.outputIndex == index) {
+        return true;
+      }
+    }
+    return false;
+  });
+}
+
+template <typename Model>
+void BasicSimulator<Model>::setDisturbances(const std::vector<Disturbance> &list) {
+  validateDisturbances(list, controllerConfig);
+  disturbances.assign(list, dt, disturbances.getSeed(), disturbances.getStream());
+}
+
+template <typename Model>
+const std::vector<Disturbance> &BasicSimulator<Model>::getDisturbances() const {
+  return disturbances.getDisturbances();
+}
+
+template <typename Model>
+std::uint64_t BasicSimulator<Model>::getStepCount() const {
+  return stepCount;
+}
+
+template <typename Model>
+BasicSimulator<Model> BasicSimulator<Model>::fork() const {
+  return BasicSimulator(*this);
+}
+
+} // namespace tank_sim
+
+#endif // TANK_SIMULATOR_IMPL_H
@@ -3,17 +3,31 @@
 
 namespace tank_sim {
 
+namespace {
+
+// Derivative evaluations per step() call, for the metrics
+constexpr std::uint64_t GSL_RK4_EVALUATIONS = 11;  // Full step + two half steps
+constexpr std::uint64_t NATIVE_RK4_EVALUATIONS = 4;
+
+}  // namespace
+
 /**
  * @brief Constructor to initialize the Stepper object.
  *
- * Allocates the GSL stepper using the RK4 algorithm and validates dimensions.
+ * Validates dimensions and, for the GSL backend, allocates the GSL stepper
+ * using the RK4 algorithm. The Native backend only sizes its stage workspace.
  *
  * @param state_dimension The size of the state vector for the differential equations
  * @param input_dimension The size of the input vector for the differential equations
+ * @param backend The integration backend to use
  * @throws std::invalid_argument if either dimension is zero
  */
-Stepper::Stepper(size_t state_dimension, size_t input_dimension) 
-    : state_dimension_(state_dimension), input_dimension_(input_dimension) {
+Stepper::Stepper(size_t state_dimension, size_t input_dimension,
+                 Backend backend)
+    : backend_(backend), stepper_(nullptr), state_dimension_(state_dimension),
+      input_dimension_(input_dimension),
+      yerr_(static_cast<Eigen::Index>(state_dimension)),
+      workspace_(static_cast<Eigen::Index>(state_dimension)) {
   // Validate dimensions
   if (state_dimension == 0) {
     throw std::invalid_argument("State dimension must be greater than zero");
@@ -22,6 +36,10 @@ Stepper::Stepper(size_t state_dimension, size_t input_dimension)
     throw std::invalid_argument("Input dimension must be greater than zero");
   }
   
+  if (backend_ == Backend::Native) {
+    return;
+  }
+
   // Allocate the GSL stepper using the RK4 algorithm
   stepper_ = gsl_odeiv2_step_alloc(gsl_odeiv2_step_rk4, state_dimension);
   if (stepper_ == nullptr) {
@@ -95,6 +113,35 @@ static int gsl_derivative_wrapper(double t, const double y[], double dydt[],
   return GSL_SUCCESS;
 }
 
+// Context for the in-place GSL callback
+struct InPlaceStepperContext {
+  const Stepper::InPlaceDerivativeFunc *deriv_func;
+  const Eigen::Ref<const Eigen::VectorXd> *input;
+  size_t state_dimension;
+};
+
+/**
+ * @brief GSL-compatible wrapper for in-place derivative functions.
+ *
+ * Maps GSL's y and dydt arrays as Eigen vectors and lets the user's function
+ * write the derivative directly into dydt. Nothing is copied or allocated.
+ *
+ * @param t Current time in the differential equation.
+ * @param y Array of state variables at time t.
+ * @param dydt Array where the derivative values are stored.
+ * @param params Pointer to the InPlaceStepperContext structure.
+ * @return GSL_SUCCESS if successful, otherwise an error code.
+ */
+static int gsl_inplace_derivative_wrapper(double t, const double y[],
+                                          double dydt[], void *params) {
+  auto *ctx = static_cast<InPlaceStepperContext *>(params);
+  const auto n = static_cast<Eigen::Index>(ctx->state_dimension);
+  Eigen::Map<const Eigen::VectorXd> state(y, n);
+  Eigen::Map<Eigen::VectorXd> derivative(dydt, n);
+  (*ctx->deriv_func)(t, state, *ctx->input, derivative);
+  return GSL_SUCCESS;
+}
+
 /**
  * @brief Performs one step of the RK4 integration.
  *
@@ -124,6 +171,21 @@ Eigen::VectorXd Stepper::step(double t, double dt, const Eigen::VectorXd &state,
         "Input vector size does not match stepper dimension");
   }
 
+  StepTimer timer(metrics_);
+
+  // Native backend: integrate a copy of the state with the in-house kernel
+  if (backend_ == Backend::Native) {
+    Eigen::VectorXd result = state;
+    rk4Step(t, dt, result, input, workspace_,
+            [&deriv_func](double tau, const Eigen::VectorXd &y,
+                          const Eigen::VectorXd &u, Eigen::VectorXd &dydt) {
+              dydt = deriv_func(tau, y, u);
+            });
+    metrics_.addWork(1, NATIVE_RK4_EVALUATIONS);
+    timer.mark(Metrics::INTEGRATION);
+    return result;
+  }
+
   // Step 2: Create context structure for the GSL callback
   StepperContext ctx{&deriv_func, t, &input, state_dimension_};
 
@@ -165,10 +227,72 @@ Eigen::VectorXd Stepper::step(double t, double dt, const Eigen::VectorXd &state,
   // y now contains the updated state after the step
   Eigen::VectorXd result(state_dimension_);
   std::copy(y.data(), y.data() + state_dimension_, result.data());
+  metrics_.addWork(1, GSL_RK4_EVALUATIONS);
+  timer.mark(Metrics::INTEGRATION);
 
   // Step 9: Return the result
   // Vectors automatically cleaned up when going out of scope
   return result;
 }
 
+/**
+ * @brief Performs one in-place step of the RK4 integration.
+ *
+ * Validates dimensions, then lets GSL integrate directly on the caller's state
+ * buffer. The error estimate is written to the preallocated yerr_ scratch.
+ *
+ * @param t Current time in the differential equation.
+ * @param dt Time step size for the integration.
+ * @param state State vector, overwritten with the state at t + dt.
+ * @param input Input vector for the differential equations.
+ * @param deriv_func The user's in-place derivative function.
+ */
+void Stepper::step(double t, double dt, Eigen::Ref<Eigen::VectorXd> state,
+                   const Eigen::Ref<const Eigen::VectorXd> &input,
+                   const InPlaceDerivativeFunc &deriv_func) {
+  if (state.size() != static_cast<int>(state_dimension_)) {
+    throw std::runtime_error(
+        "State vector size does not match stepper dimension");
+  }
+  if (input.size() != static_cast<int>(input_dimension_)) {
+    throw std::runtime_error(
+        "Input vector size does not match stepper dimension");
+  }
+
+  StepTimer timer(metrics_);
+
+  // Native backend: stage vectors are preallocated in workspace_, and the
+  // generic lambda forwards them to deriv_func as Eigen::Ref without copying
+  if (backend_ == Backend::Native) {
+    rk4Step(t, dt, state, input, workspace_,
+            [&deriv_func](double tau, const auto &y, const auto &u,
+                          Eigen::VectorXd &dydt) { deriv_func(tau, y, u, dydt); });
+    metrics_.addWork(1, NATIVE_RK4_EVALUATIONS);
+    timer.mark(Metrics::INTEGRATION);
+    return;
+  }
+
+  InPlaceStepperContext ctx{&deriv_func, &input, state_dimension_};
+  gsl_odeiv2_system sys = {gsl_inplace_derivative_wrapper, nullptr,
+                           state_dimension_, &ctx};
+
+  // Eigen::Ref guarantees unit inner stride, so state.data() is a contiguous
+  // array GSL can update in place. On failure GSL restores the initial state.
+  int status = gsl_odeiv2_step_apply(stepper_, t, dt, state.data(),
+                                     yerr_.data(), nullptr, nullptr, &sys);
+  if (status != GSL_SUCCESS) {
+    throw std::runtime_error("GSL RK4 step failed");
+  }
+  metrics_.addWork(1, GSL_RK4_EVALUATIONS);
+  timer.mark(Metrics::INTEGRATION);
+}
+
+Stepper::Backend Stepper::getBackend() const {
+  return backend_;
+}
+
+const Metrics &Stepper::getMetrics() const {
+  return metrics_;
+}
+
 } // namespace tank_sim
@@ -1,5 +1,7 @@
 #pragma once
 
+#include "metrics.h"
+#include "rk4.h"
 #include <Eigen/Dense>
 #include <cstddef>
 #include <functional>
@@ -57,12 +59,43 @@ namespace tank_sim {
  *
  * All GSL resource management follows RAII principles: resources are acquired
  * in the constructor and released in the destructor, ensuring exception safety.
+ *
+ * ## Backends
+ *
+ * Backend::GSL (the default) drives `gsl_odeiv2_step_rk4`. Note that GSL's
+ * rk4 computes a full step and two half steps on every call so it can
+ * report an error estimate, and returns the two-half-step result: 11
+ * derivative evaluations per step.
+ *
+ * Backend::Native runs the in-house rk4Step() kernel (rk4.h): one classic RK4
+ * step, 4 derivative evaluations, no GSL indirection. The two backends agree
+ * to within RK4 truncation error, which is what the equivalence tests in
+ * test_stepper.cpp check. Keep GSL for verifying the native kernel.
  */
 class Stepper {
 public:
+  /**
+   * @brief Integration backend used by step().
+   */
+  enum class Backend {
+    GSL,    ///< gsl_odeiv2_step_rk4 (reference implementation)
+    Native  ///< In-house rk4Step() kernel
+  };
+
   using DerivativeFunc = std::function<Eigen::VectorXd(
       double, const Eigen::VectorXd &, const Eigen::VectorXd &)>;
 
+  /**
+   * @brief Derivative callback that writes dy/dt into a caller-provided buffer.
+   *
+   * Arguments are (t, state, input, dydt). The state and dydt references wrap
+   * the integrator's own arrays, so evaluating the derivative this way never
+   * touches the heap.
+   */
+  using InPlaceDerivativeFunc = std::function<void(
+      double, const Eigen::Ref<const Eigen::VectorXd> &,
+      const Eigen::Ref<const Eigen::VectorXd> &, Eigen::Ref<Eigen::VectorXd>)>;
+
 public:
   /**
    * @brief Constructs a Stepper with the given state and input dimensions.
@@ -72,14 +105,17 @@ public:
    *
    * @param state_dimension Number of state variables (must be > 0)
    * @param input_dimension Number of input variables (must be > 0)
+   * @param backend Integration backend (GSL by default)
    *
    * @throws std::invalid_argument if either dimension is zero
    * @throws std::runtime_error if GSL allocation fails
    *
+   * @note The Native backend does not allocate a GSL stepper.
    * @note The input dimension is not used directly by GSL but is validated
    *       at runtime to ensure consistent vector sizes during integration.
    */
-  Stepper(size_t state_dimension, size_t input_dimension);
+  Stepper(size_t state_dimension, size_t input_dimension,
+          Backend backend = Backend::GSL);
 
   /**
    * @brief Destructor that releases the GSL stepper resource.
@@ -140,10 +176,53 @@ public:
   Eigen::VectorXd step(double t, double dt, const Eigen::VectorXd &state,
                        const Eigen::VectorXd &input, DerivativeFunc deriv_func);
 
+  /**
+   * @brief Performs one RK4 integration step in place, without allocating.
+   *
+   * Same integration as the allocating overload, but the caller's state
+   * buffer is handed straight to GSL and overwritten with the new state. The
+   * GSL error estimate goes into scratch storage held by the Stepper, and the
+   * derivative callback writes into GSL's stage arrays. Once the Stepper is
+   * constructed, repeated calls perform no heap allocations.
+   *
+   * @param t Current time in the differential equation
+   * @param dt Time step size for integration
+   * @param state State vector, replaced by the state at t + dt
+   * @param input Input vector for the derivative function
+   * @param deriv_func Callable that writes dy/dt = f(t, y, u) into its last
+   *                   argument
+   *
+   * @throws std::runtime_error if state or input dimensions don't match
+   * @throws std::runtime_error if GSL integration fails
+   *
+   * @note Pass deriv_func as a long-lived object (e.g. a class member) in hot
+   *       loops; it is taken by reference and never copied.
+   */
+  void step(double t, double dt, Eigen::Ref<Eigen::VectorXd> state,
+            const Eigen::Ref<const Eigen::VectorXd> &input,
+            const InPlaceDerivativeFunc &deriv_func);
+
+  /**
+   * @brief Returns the backend selected at construction.
+   */
+  Backend getBackend() const;
+
+  /**
+   * @brief Instrumentation for every step() call (see metrics.h).
+   *
+   * Counts steps and derivative evaluations (11 per GSL step, 4 per native
+   * step) and times each step as Metrics::INTEGRATION.
+   */
+  const Metrics &getMetrics() const;
+
 private:
-  gsl_odeiv2_step *stepper_;      ///< GSL RK4 stepper (managed, freed in ~Stepper)
+  Backend backend_;               ///< Selected integration backend
+  gsl_odeiv2_step *stepper_;      ///< GSL RK4 stepper (managed, freed in ~Stepper; null for Native)
   size_t state_dimension_;        ///< Cached state vector size for validation
   size_t input_dimension_;        ///< Cached input vector size for validation
+  Eigen::VectorXd yerr_;          ///< Scratch for GSL's error estimate (in-place step)
+  Rk4Workspace<Eigen::VectorXd> workspace_;  ///< Stage storage for the Native backend
+  Metrics metrics_;               ///< Hot-path counters, see getMetrics()
 };
 
 } // namespace tank_sim
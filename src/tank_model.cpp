@@ -1,13 +1,23 @@
 #include "tank_model.h"
-#include <cmath>
 #include <stdexcept>
 
+namespace {
+
+// Safeguarded Newton on G(y) (see TankModel::propagate()) stops when the
+// step is below this, relative to the root; well past double precision of
+// the level, which depends on e^y - 1
+constexpr double ZOH_TOLERANCE = 1e-15;
+constexpr int ZOH_MAX_ITERATIONS = 60;
+
+}  // namespace
+
 namespace tank_sim {
 
 TankModel::TankModel(const Parameters& params)
     : area_(params.area),
       k_v_(params.k_v),
-      max_height_(params.max_height) {
+      max_height_(params.max_height),
+      valve_(params.valve_characteristic, params.rangeability) {
     // Validate parameters immediately - fail fast
     if (area_ <= 0.0) {
         throw std::invalid_argument("Tank area must be positive");
@@ -23,10 +33,20 @@ TankModel::TankModel(const Parameters& params)
 Eigen::VectorXd TankModel::derivatives(
     const Eigen::VectorXd& state,
     const Eigen::VectorXd& inputs) const {
+    Eigen::VectorXd derivative(1);
+    derivatives(state, inputs, derivative);
+    return derivative;
+}
+
+void TankModel::derivatives(
+    const Eigen::Ref<const Eigen::VectorXd>& state,
+    const Eigen::Ref<const Eigen::VectorXd>& inputs,
+    Eigen::Ref<Eigen::VectorXd> derivative) const {
     
     // Validate preconditions (debug mode only)
     assert(state.size() == 1 && "State vector must have size 1");
     assert(inputs.size() == 2 && "Input vector must have size 2");
+    assert(derivative.size() == 1 && "Derivative vector must have size 1");
     
     double h = state(0);              // Current tank level (m)
     double q_in = inputs(0);          // Inlet flow rate (m³/s)
@@ -41,12 +61,110 @@ Eigen::VectorXd TankModel::derivatives(
     double q_out = outletFlow(h, valve_position);
     
     // Material balance equation: dh/dt = (q_in - q_out) / A
-    double dh_dt = (q_in - q_out) / area_;
-    
-    // Return derivative vector
-    Eigen::VectorXd derivative(1);
-    derivative(0) = dh_dt;
-    return derivative;
+    derivative(0) = (q_in - q_out) / area_;
+}
+
+void TankModel::jacobian(
+    const Eigen::Ref<const Eigen::VectorXd>& state,
+    const Eigen::Ref<const Eigen::VectorXd>& inputs,
+    Eigen::Ref<Eigen::MatrixXd> dfdx) const {
+    assert(state.size() == 1 && "State vector must have size 1");
+    assert(inputs.size() == 2 && "Input vector must have size 2");
+    assert(dfdx.rows() == 1 && dfdx.cols() == 1 &&
+           "Jacobian must be 1 x 1");
+
+    // d/dh of (q_in - k_v * x * sqrt(h)) / A
+    dfdx(0, 0) = -outletFlowSlope(state(0), inputs(1)) / area_;
+}
+
+TankModel::StateVector TankModel::propagate(
+    const StateVector& state,
+    const InputVector& inputs,
+    double dt,
+    int* iterations) const {
+    assert(state(0) >= 0.0 && "Tank level must be non-negative");
+    assert(dt > 0.0 && "Period must be positive");
+
+    const double q = inputs(0);
+    const double c = k_v_ * valve_.opening(inputs(1));
+    const double s0 = std::sqrt(std::max(state(0), 0.0));
+    StateVector next;
+    if (iterations != nullptr) {
+        *iterations = 0;
+    }
+
+    // Closed valve: the level changes linearly
+    if (c <= 0.0) {
+        next(0) = std::max(state(0) + q * dt / area_, 0.0);
+        return next;
+    }
+    // No inflow: ds/dt = -c / (2A), so sqrt(h) falls linearly
+    if (q == 0.0) {
+        const double s = std::max(s0 - c * dt / (2.0 * area_), 0.0);
+        next(0) = s * s;
+        return next;
+    }
+    const double w0 = q - c * s0;
+    if (w0 == 0.0) {
+        next = state;  // At equilibrium
+        return next;
+    }
+
+    // G(hi) = tau > 0, G(lo) <= 0 and G is increasing on [lo, hi]
+    const double tau = c * c * dt / (2.0 * area_);
+    double lo;
+    double hi = 0.0;
+    if (q > 0.0) {
+        lo = w0 > 0.0 ? -(w0 + tau) / q : -tau / q;
+    } else {
+        // Inflow negative: the tank empties at w = q, i.e. y = ln(q / w0)
+        lo = std::log(q / w0);
+        if (q * lo - w0 * std::expm1(lo) + tau >= 0.0) {
+            next(0) = 0.0;
+            return next;
+        }
+    }
+
+    // Start from the linearization at y = 0, exact as dt -> 0
+    const double slope0 = c * s0;
+    double y = slope0 > 0.0 ? -tau / slope0 : 0.5 * (lo + hi);
+    if (!(y > lo && y < hi)) {
+        y = 0.5 * (lo + hi);
+    }
+
+    double expm1y = std::expm1(y);
+    int n = 0;
+    while (n < ZOH_MAX_ITERATIONS) {
+        ++n;
+        const double g = q * y - w0 * expm1y + tau;
+        if (g == 0.0) {
+            break;
+        }
+        if (g < 0.0) {
+            lo = y;
+        } else {
+            hi = y;
+        }
+        const double dg = q - w0 * (expm1y + 1.0);
+        double next_y = y - g / dg;
+        if (!(next_y >= lo && next_y <= hi)) {
+            next_y = 0.5 * (lo + hi);  // Newton left the bracket: bisect
+        }
+        const bool converged =
+            std::abs(next_y - y) <= ZOH_TOLERANCE * std::max(1.0, std::abs(y));
+        y = next_y;
+        expm1y = std::expm1(y);
+        if (converged) {
+            break;
+        }
+    }
+    if (iterations != nullptr) {
+        *iterations = n;
+    }
+
+    const double s = std::max(s0 - w0 * expm1y / c, 0.0);
+    next(0) = s * s;
+    return next;
 }
 
 double TankModel::getOutletFlow(
@@ -58,19 +176,4 @@ double TankModel::getOutletFlow(
     return outletFlow(h, valve_position);
 }
 
-double TankModel::outletFlow(double h, double valve_position) const {
-    // Validate preconditions
-    assert(h >= 0.0 && "Tank level must be non-negative");
-    assert(valve_position >= 0.0 && valve_position <= 1.0 && 
-           "Valve position must be in [0, 1]");
-    
-    // No flow if tank is empty
-    if (h <= 0.0) {
-        return 0.0;
-    }
-    
-    // Valve flow equation: q_out = k_v * x * sqrt(h)
-    return k_v_ * valve_position * std::sqrt(h);
-}
-
 }  // namespace tank_sim
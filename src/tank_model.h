@@ -1,7 +1,12 @@
 #ifndef TANK_SIM_TANK_MODEL_H
 #define TANK_SIM_TANK_MODEL_H
 
+#include "constants.h"
+#include "valve.h"
 #include <Eigen/Dense>
+#include <algorithm>
+#include <cassert>
+#include <cmath>
 
 namespace tank_sim {
 
@@ -14,13 +19,32 @@ namespace tank_sim {
  * 
  * The model implements:
  * - Material balance: dh/dt = (q_in - q_out) / A
- * - Valve equation: q_out = k_v * x * sqrt(h)
+ * - Valve equation: q_out = k_v * f(x) * sqrt(h), where f is the valve's
+ *   inherent characteristic (linear by default, see ValveCharacteristic)
  * 
  * @note This class is stateless - it computes derivatives without maintaining
  *       internal state. Integration is handled externally by the Stepper class.
  */
 class TankModel {
 public:
+    /// Dimensions, as required by the Simulator model concept (simulator.h)
+    static constexpr int STATE_SIZE = constants::TANK_STATE_SIZE;
+    static constexpr int INPUT_SIZE = constants::TANK_INPUT_SIZE;
+    static constexpr int OUTPUT_SIZE = 1;
+
+    /// Fixed-size state vector [h], sized from constants::TANK_STATE_SIZE
+    using StateVector = Eigen::Matrix<double, STATE_SIZE, 1>;
+
+    /// Fixed-size input vector [q_in, x], sized from constants::TANK_INPUT_SIZE
+    using InputVector = Eigen::Matrix<double, INPUT_SIZE, 1>;
+
+    /// Fixed-size output vector [q_out]
+    using OutputVector = Eigen::Matrix<double, OUTPUT_SIZE, 1>;
+
+    /// Fixed-size Jacobian d(dh/dt)/dh
+    using JacobianMatrix = Eigen::Matrix<double, constants::TANK_STATE_SIZE,
+                                         constants::TANK_STATE_SIZE>;
+
     /**
      * @brief Configuration parameters for the tank model.
      */
@@ -28,12 +52,20 @@ public:
         double area;          ///< Cross-sectional area (m²)
         double k_v;           ///< Valve coefficient (m^2.5/s)
         double max_height;    ///< Maximum tank height (m)
+        /// Inherent valve characteristic f(x)
+        ValveCharacteristic valve_characteristic = ValveCharacteristic::LINEAR;
+        /// R for ValveCharacteristic::EQUAL_PERCENTAGE
+        double rangeability = constants::DEFAULT_VALVE_RANGEABILITY;
     };
 
     /**
      * @brief Constructs a TankModel with the given parameters.
      * 
      * @param params Physical parameters of the tank system
+     *
+     * @throws std::invalid_argument if area, k_v or max_height is not
+     *         positive, or the valve characteristic is invalid (see
+     *         ValveCurve)
      */
     explicit TankModel(const Parameters& params);
 
@@ -64,6 +96,100 @@ public:
         const Eigen::VectorXd& state,
         const Eigen::VectorXd& inputs) const;
 
+    /**
+     * @brief Computes dh/dt into a caller-provided buffer.
+     *
+     * Allocation-free variant of derivatives() matching
+     * Stepper::InPlaceDerivativeFunc. Same equations and preconditions.
+     *
+     * @param state Current state vector [h]
+     * @param inputs Input vector [q_in, x]
+     * @param derivative Output vector [dh/dt], must have size 1
+     */
+    void derivatives(
+        const Eigen::Ref<const Eigen::VectorXd>& state,
+        const Eigen::Ref<const Eigen::VectorXd>& inputs,
+        Eigen::Ref<Eigen::VectorXd> derivative) const;
+
+    /**
+     * @brief Computes dh/dt on fixed-size vectors.
+     *
+     * Same equations and preconditions as the dynamic overloads, but defined
+     * inline so that FixedStepper can fold all four RK4 stages into a handful
+     * of register operations. This is the overload used by Simulator::step().
+     *
+     * @param state Current state vector [h]
+     * @param inputs Input vector [q_in, x]
+     * @return Derivative vector [dh/dt] in m/s
+     */
+    StateVector derivatives(
+        const StateVector& state,
+        const InputVector& inputs) const;
+
+    /**
+     * @brief The fixed-size derivatives() on another scalar type.
+     *
+     * The same equations on, e.g., Dual<N> state and inputs, so an RK4 step
+     * over them carries sensitivities (see GainTuner). An empty tank has no
+     * outlet flow and passes no derivative through it, since d sqrt(h)/dh is
+     * unbounded there.
+     */
+    template <typename Scalar>
+    Eigen::Matrix<Scalar, STATE_SIZE, 1> derivatives(
+        const Eigen::Matrix<Scalar, STATE_SIZE, 1>& state,
+        const Eigen::Matrix<Scalar, INPUT_SIZE, 1>& inputs) const;
+
+    /**
+     * @brief Exact level after dt with the inputs held (zero-order hold).
+     *
+     * With q_in and x constant, dh/dt = (q_in - c * sqrt(h)) / A with
+     * c = k_v * f(x) separates in s = sqrt(h). Writing w = q_in - c * s (the
+     * net inflow), the solution is the root y = ln(w(dt) / w(0)) of
+     *
+     *   G(y) = q_in * y - w(0) * (e^y - 1) + c^2 * dt / (2 * A) = 0,
+     *
+     * which is strictly increasing on the bracket the implementation starts
+     * from, so a safeguarded Newton iteration converges in a few steps. The
+     * level is then s^2 with s = s(0) - w(0) * (e^y - 1) / c. A closed valve
+     * (linear fill) and q_in = 0 (linear fall in s) are closed-form. A tank
+     * that would empty within dt (only possible for q_in <= 0) returns 0.
+     *
+     * @param state Level at the start of the period [h], h >= 0
+     * @param inputs Inputs held over the period [q_in, x]
+     * @param dt Period length (s), > 0
+     * @param iterations If non-null, receives the Newton iteration count
+     * @return Level at the end of the period
+     */
+    StateVector propagate(
+        const StateVector& state,
+        const InputVector& inputs,
+        double dt,
+        int* iterations = nullptr) const;
+
+    /**
+     * @brief Computes the analytic Jacobian of derivatives() with respect to
+     *        the state into a caller-provided buffer.
+     *
+     * d(dh/dt)/dh = -k_v * x / (2 * A * sqrt(h)), with h bounded below by
+     * constants::MIN_JACOBIAN_HEAD so the slope stays finite at and near an
+     * empty tank. Used by the implicit Rosenbrock integrator (rosenbrock.h).
+     *
+     * @param state Current state vector [h]
+     * @param inputs Input vector [q_in, x]
+     * @param dfdx Output matrix, must be 1 x 1
+     */
+    void jacobian(
+        const Eigen::Ref<const Eigen::VectorXd>& state,
+        const Eigen::Ref<const Eigen::VectorXd>& inputs,
+        Eigen::Ref<Eigen::MatrixXd> dfdx) const;
+
+    /**
+     * @brief Fixed-size overload of jacobian(), defined inline.
+     */
+    JacobianMatrix jacobian(
+        const StateVector& state,
+        const InputVector& inputs) const;
+
     /**
      * @brief Gets the current outlet flow rate for reporting/logging.
      * 
@@ -78,24 +204,132 @@ public:
         const Eigen::VectorXd& state,
         const Eigen::VectorXd& inputs) const;
 
+    /**
+     * @brief Fixed-size overload of getOutletFlow(), defined inline.
+     */
+    double getOutletFlow(
+        const StateVector& state,
+        const InputVector& inputs) const;
+
+    /**
+     * @brief Measured outputs [q_out] (Simulator model concept).
+     */
+    OutputVector outputs(
+        const StateVector& state,
+        const InputVector& inputs) const;
+
+    /**
+     * @brief Maps an integrator result back onto physical levels.
+     *
+     * The linearization in the Rosenbrock step can undershoot a tank that
+     * empties within the step; an empty tank is the physical answer.
+     */
+    StateVector project(const StateVector& state) const;
+
+    /**
+     * @brief The valve characteristic, for callers that evaluate the valve
+     *        equation themselves (e.g. BatchSimulator lanes).
+     */
+    const ValveCurve& getValveCurve() const { return valve_; }
+
 private:
     double area_;         ///< Cross-sectional area (m²)
     double k_v_;          ///< Valve coefficient (m^2.5/s)
     double max_height_;   ///< Maximum tank height (m)
+    ValveCurve valve_;    ///< Inherent characteristic f(x)
 
     /**
      * @brief Internal algebraic equation: calculates outlet flow through valve.
      * 
-     * Implements the valve flow equation: q_out = k_v * x * sqrt(h)
+     * Implements the valve flow equation: q_out = k_v * f(x) * sqrt(h)
      * Returns zero if tank level is zero or negative.
      * 
      * @param h Current tank level (m)
      * @param x Valve position (dimensionless, 0 to 1)
      * @return Outlet flow rate (m³/s)
      */
-    double outletFlow(double h, double x) const;
+    template <typename Scalar>
+    Scalar outletFlow(const Scalar& h, const Scalar& x) const;
+
+    /**
+     * @brief Derivative of outletFlow() with respect to h.
+     *
+     * @return k_v * f(x) / (2 * sqrt(max(h, MIN_JACOBIAN_HEAD)))
+     */
+    double outletFlowSlope(double h, double x) const;
 };
 
+// Hot-path members are defined inline so they can be inlined into the
+// fixed-size integrator (see fixed_stepper.h).
+
+inline TankModel::StateVector TankModel::derivatives(
+    const StateVector& state,
+    const InputVector& inputs) const {
+    return derivatives<double>(state, inputs);
+}
+
+template <typename Scalar>
+inline Eigen::Matrix<Scalar, TankModel::STATE_SIZE, 1> TankModel::derivatives(
+    const Eigen::Matrix<Scalar, STATE_SIZE, 1>& state,
+    const Eigen::Matrix<Scalar, INPUT_SIZE, 1>& inputs) const {
+    Scalar q_out = outletFlow(state(0), inputs(1));
+
+    // Material balance equation: dh/dt = (q_in - q_out) / A
+    Eigen::Matrix<Scalar, STATE_SIZE, 1> derivative;
+    derivative(0) = (inputs(0) - q_out) / area_;
+    return derivative;
+}
+
+inline TankModel::JacobianMatrix TankModel::jacobian(
+    const StateVector& state,
+    const InputVector& inputs) const {
+    JacobianMatrix dfdx;
+    dfdx(0, 0) = -outletFlowSlope(state(0), inputs(1)) / area_;
+    return dfdx;
+}
+
+inline double TankModel::getOutletFlow(
+    const StateVector& state,
+    const InputVector& inputs) const {
+    return outletFlow(state(0), inputs(constants::INPUT_INDEX_VALVE_POSITION));
+}
+
+inline TankModel::OutputVector TankModel::outputs(
+    const StateVector& state,
+    const InputVector& inputs) const {
+    OutputVector y;
+    y(0) = getOutletFlow(state, inputs);
+    return y;
+}
+
+inline TankModel::StateVector TankModel::project(const StateVector& state) const {
+    return state.cwiseMax(0.0);
+}
+
+template <typename Scalar>
+inline Scalar TankModel::outletFlow(const Scalar& h, const Scalar& valve_position) const {
+    using std::sqrt;
+
+    // Validate preconditions
+    assert(h >= 0.0 && "Tank level must be non-negative");
+    assert(valve_position >= 0.0 && valve_position <= 1.0 && 
+           "Valve position must be in [0, 1]");
+    
+    // No flow if tank is empty
+    if (h <= 0.0) {
+        return Scalar(0.0);
+    }
+    
+    // Valve flow equation: q_out = k_v * f(x) * sqrt(h)
+    return k_v_ * valve_.opening(valve_position) * sqrt(h);
+}
+
+inline double TankModel::outletFlowSlope(double h, double valve_position) const {
+    // One-sided slope at an empty tank, see constants::MIN_JACOBIAN_HEAD
+    return 0.5 * k_v_ * valve_.opening(valve_position) /
+           std::sqrt(std::max(h, constants::MIN_JACOBIAN_HEAD));
+}
+
 }  // namespace tank_sim
 
 #endif  // TANK_SIM_TANK_MODEL_H
@@ -0,0 +1,58 @@
+#include "trajectory.h"
+#include <cassert>
+#include <stdexcept>
+
+namespace tank_sim {
+
+template <typename Scalar>
+BasicTrajectory<Scalar>::BasicTrajectory(Eigen::Index capacity,
+                                         Eigen::Index state_size,
+                                         Eigen::Index input_size,
+                                         Eigen::Index controller_count)
+    : size_(0) {
+    // Validate sizes before allocating - fail fast
+    if (capacity < 0) {
+        throw std::invalid_argument("Trajectory capacity cannot be negative");
+    }
+    if (state_size < 0 || input_size < 0 || controller_count < 0) {
+        throw std::invalid_argument("Trajectory signal counts cannot be negative");
+    }
+
+    time.resize(capacity);
+    state.resize(state_size, capacity);
+    inputs.resize(input_size, capacity);
+    setpoint.resize(controller_count, capacity);
+    error.resize(controller_count, capacity);
+    controllerOutput.resize(controller_count, capacity);
+}
+
+template <typename Scalar>
+Eigen::Index BasicTrajectory<Scalar>::capacity() const {
+    return time.size();
+}
+
+template <typename Scalar>
+Eigen::Index BasicTrajectory<Scalar>::size() const {
+    return size_;
+}
+
+template <typename Scalar>
+Eigen::Index BasicTrajectory<Scalar>::remaining() const {
+    return capacity() - size_;
+}
+
+template <typename Scalar>
+void BasicTrajectory<Scalar>::clear() {
+    size_ = 0;
+}
+
+template <typename Scalar>
+Eigen::Index BasicTrajectory<Scalar>::append() {
+    assert(size_ < capacity() && "Trajectory is full");
+    return size_++;
+}
+
+template class BasicTrajectory<double>;
+template class BasicTrajectory<float>;
+
+}  // namespace tank_sim
@@ -0,0 +1,94 @@
+#ifndef TANK_SIM_TRAJECTORY_H
+#define TANK_SIM_TRAJECTORY_H
+
+#include <Eigen/Dense>
+
+namespace tank_sim {
+
+/**
+ * @brief Preallocated structure-of-arrays buffer for recorded simulation data.
+ *
+ * A Trajectory is allocated once by the caller with a fixed capacity and then
+ * filled by Simulator::run() / Simulator::runUntil(), one sample per step.
+ * Every signal is stored contiguously over time: row i of a signal matrix is
+ * the full time series of signal i, so a row can be handed to NumPy or a
+ * plotting routine without copying or striding.
+ *
+ * Sample k (0 <= k < size) holds the values after the k-th recorded step:
+ *   - time(k)                  simulation time (s)
+ *   - state(i, k)              state variable i (state(0) is the tank level, m)
+ *   - inputs(j, k)             input j (inputs(0) = q_in, inputs(1) = valve position)
+ *   - setpoint(c, k)           setpoint of controller c
+ *   - error(c, k)              setpoint - measured value for controller c
+ *   - controllerOutput(c, k)   clamped output of controller c
+ *
+ * Columns at or beyond size are unspecified.
+ *
+ * Signals are stored as Scalar: Trajectory (double) records the simulator
+ * exactly, FloatTrajectory rounds every signal to float and so halves their
+ * memory, for long or many stored runs where 7 significant digits (half
+ * a micrometre of level at 5 m) are enough. time stays double in both: a
+ * float clock can no longer tell neighbouring 0.01 s steps apart after
+ * about a day of simulated time.
+ *
+ * @tparam Scalar double or float
+ */
+template <typename Scalar>
+class BasicTrajectory {
+public:
+    /// Row-major so that each signal (row) is contiguous in memory
+    using SignalMatrix =
+        Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>;
+
+    /**
+     * @brief Allocates storage for up to capacity samples.
+     *
+     * @param capacity Maximum number of samples (must be >= 0)
+     * @param state_size Number of state variables recorded per sample
+     * @param input_size Number of inputs recorded per sample
+     * @param controller_count Number of controllers recorded per sample
+     *
+     * @throws std::invalid_argument if any size is negative
+     */
+    BasicTrajectory(Eigen::Index capacity, Eigen::Index state_size,
+                    Eigen::Index input_size, Eigen::Index controller_count);
+
+    /// Maximum number of samples the buffer can hold
+    Eigen::Index capacity() const;
+
+    /// Number of samples recorded so far
+    Eigen::Index size() const;
+
+    /// Free sample slots left (capacity() - size())
+    Eigen::Index remaining() const;
+
+    /// Discards recorded samples without releasing storage
+    void clear();
+
+    /**
+     * @brief Claims the next free sample slot and returns its column index.
+     *
+     * Used by writers such as Simulator::run(); callers must check
+     * remaining() first.
+     */
+    Eigen::Index append();
+
+    Eigen::VectorXd time;           ///< Simulation time per sample [capacity]
+    SignalMatrix state;             ///< State variables [state_size x capacity]
+    SignalMatrix inputs;            ///< Inputs [input_size x capacity]
+    SignalMatrix setpoint;          ///< Setpoints [controller_count x capacity]
+    SignalMatrix error;             ///< Control errors [controller_count x capacity]
+    SignalMatrix controllerOutput;  ///< Controller outputs [controller_count x capacity]
+
+private:
+    Eigen::Index size_;             ///< Number of recorded samples
+};
+
+using Trajectory = BasicTrajectory<double>;
+using FloatTrajectory = BasicTrajectory<float>;
+extern template class BasicTrajectory<double>;
+extern template class BasicTrajectory<float>;
+
+}  // namespace tank_sim
+
+#endif  // TANK_SIM_TRAJECTORY_H
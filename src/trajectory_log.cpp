@@ -0,0 +1,518 @@
+#include "trajectory_log.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <limits>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace tank_sim {
+
+namespace {
+
+constexpr char LOG_MAGIC[8] = {'T', 'S', 'I', 'M', 'L', 'O', 'G', '\0'};
+constexpr const char *HEADER_FILE = "header";
+constexpr const char *INDEX_FILE = "time_index.f64";
+
+std::runtime_error ioError(const std::string &what, const std::string &file) {
+    return std::runtime_error(what + " " + file + ": " + std::strerror(errno));
+}
+
+// Column file names in file order: time, then each Trajectory signal row
+std::vector<std::string> columnFiles(const LogHeader &header) {
+    std::vector<std::string> names{"time.f64"};
+    const auto rows = [&](const char *prefix, std::uint32_t count) {
+        for (std::uint32_t i = 0; i < count; ++i) {
+            names.push_back(std::string(prefix) + std::to_string(i) + ".f64");
+        }
+    };
+    rows("state_", header.stateSize);
+    rows("input_", header.inputSize);
+    rows("setpoint_", header.controllerCount);
+    rows("error_", header.controllerCount);
+    rows("controller_output_", header.controllerCount);
+    return names;
+}
+
+// Row pointers of a Trajectory in the same order as columnFiles()
+std::vector<const double *> columnRows(const Trajectory &t) {
+    std::vector<const double *> rows{t.time.data()};
+    for (const auto *signal :
+         {&t.state, &t.inputs, &t.setpoint, &t.error, &t.controllerOutput}) {
+        for (Eigen::Index i = 0; i < signal->rows(); ++i) {
+            rows.push_back(signal->row(i).data());
+        }
+    }
+    return rows;
+}
+
+std::vector<double *> columnRows(Trajectory &t) {
+    std::vector<double *> rows;
+    for (const double *row : columnRows(static_cast<const Trajectory &>(t))) {
+        rows.push_back(const_cast<double *>(row));
+    }
+    return rows;
+}
+
+void writeAll(int fd, const void *data, std::size_t length, off_t offset,
+              const std::string &file) {
+    const char *bytes = static_cast<const char *>(data);
+    while (length > 0) {
+        const ssize_t written = ::pwrite(fd, bytes, length, offset);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw ioError("Cannot write", file);
+        }
+        bytes += written;
+        length -= static_cast<std::size_t>(written);
+        offset += written;
+    }
+}
+
+bool readAll(int fd, void *data, std::size_t length) {
+    char *bytes = static_cast<char *>(data);
+    off_t offset = 0;
+    while (length > 0) {
+        const ssize_t got = ::pread(fd, bytes, length, offset);
+        if (got < 0 && errno == EINTR) {
+            continue;
+        }
+        if (got <= 0) {
+            return false;
+        }
+        bytes += got;
+        length -= static_cast<std::size_t>(got);
+        offset += got;
+    }
+    return true;
+}
+
+off_t fileSize(int fd, const std::string &file) {
+    struct stat info {};
+    if (::fstat(fd, &info) != 0) {
+        throw ioError("Cannot stat", file);
+    }
+    return info.st_size;
+}
+
+}  // namespace
+
+// ============================================================================
+// TrajectoryLogWriter
+// ============================================================================
+
+TrajectoryLogWriter::TrajectoryLogWriter(const std::string &path,
+                                         Eigen::Index stateSize,
+                                         Eigen::Index inputSize,
+                                         Eigen::Index controllerCount,
+                                         Eigen::Index batchSize)
+    : path_(path), header_(), columnFds_(), indexFd_(-1), headerFd_(-1),
+      batch_(batchSize > 0 ? batchSize : 0, stateSize, inputSize,
+             controllerCount),
+      lastTime_(-std::numeric_limits<double>::infinity()) {
+    if (batchSize <= 0) {
+        throw std::invalid_argument("Log batch size must be positive");
+    }
+
+    std::memcpy(header_.magic, LOG_MAGIC, sizeof(LOG_MAGIC));
+    header_.version = LOG_VERSION;
+    header_.stateSize = static_cast<std::uint32_t>(stateSize);
+    header_.inputSize = static_cast<std::uint32_t>(inputSize);
+    header_.controllerCount = static_cast<std::uint32_t>(controllerCount);
+    header_.indexStride = INDEX_STRIDE;
+    header_.reserved = 0;
+    header_.sampleCount = 0;
+
+    if (::mkdir(path.c_str(), 0755) != 0 && errno != EEXIST) {
+        throw ioError("Cannot create log directory", path);
+    }
+
+    try {
+        const std::string headerPath = path + "/" + HEADER_FILE;
+        headerFd_ = ::open(headerPath.c_str(), O_RDWR | O_CREAT, 0644);
+        if (headerFd_ < 0) {
+            throw ioError("Cannot open", headerPath);
+        }
+
+        // Resume an existing log if the header is there
+        LogHeader existing{};
+        if (fileSize(headerFd_, headerPath) > 0) {
+            if (!readAll(headerFd_, &existing, sizeof(existing)) ||
+                std::memcmp(existing.magic, LOG_MAGIC, sizeof(LOG_MAGIC)) != 0 ||
+                existing.version != LOG_VERSION) {
+                throw std::runtime_error("Not a version " +
+                                         std::to_string(LOG_VERSION) +
+                                         " trajectory log: " + path);
+            }
+            if (existing.stateSize != header_.stateSize ||
+                existing.inputSize != header_.inputSize ||
+                existing.controllerCount != header_.controllerCount) {
+                throw std::invalid_argument(
+                    "Existing log " + path + " has a different signal shape");
+            }
+            header_ = existing;
+        }
+
+        const std::uint64_t committed = header_.sampleCount;
+        const std::uint64_t indexEntries =
+            (committed + header_.indexStride - 1) / header_.indexStride;
+        const auto open = [&](const std::string &name, std::uint64_t values) {
+            const std::string file = path + "/" + name;
+            const int fd = ::open(file.c_str(), O_RDWR | O_CREAT, 0644);
+            if (fd < 0) {
+                throw ioError("Cannot open", file);
+            }
+            // Drop any uncommitted tail from an interrupted writer
+            const auto length = static_cast<off_t>(values * sizeof(double));
+            if (fileSize(fd, file) < length || ::ftruncate(fd, length) != 0) {
+                ::close(fd);
+                throw std::runtime_error("Log column " + file +
+                                         " is shorter than its header");
+            }
+            return fd;
+        };
+        for (const std::string &name : columnFiles(header_)) {
+            columnFds_.push_back(open(name, committed));
+        }
+        indexFd_ = open(INDEX_FILE, indexEntries);
+
+        if (committed > 0) {
+            const std::string timeFile = path + "/time.f64";
+            const off_t lastOffset =
+                static_cast<off_t>((committed - 1) * sizeof(double));
+            if (::pread(columnFds_[0], &lastTime_, sizeof(double), lastOffset) !=
+                static_cast<ssize_t>(sizeof(double))) {
+                throw ioError("Cannot read", timeFile);
+            }
+        }
+        writeHeader();
+    } catch (...) {
+        for (int fd : columnFds_) {
+            ::close(fd);
+        }
+        if (indexFd_ >= 0) {
+            ::close(indexFd_);
+        }
+        if (headerFd_ >= 0) {
+            ::close(headerFd_);
+        }
+        throw;
+    }
+}
+
+TrajectoryLogWriter::~TrajectoryLogWriter() {
+    try {
+        close();
+    } catch (...) {
+        // Destructors must not throw; close() explicitly to see errors
+    }
+}
+
+void TrajectoryLogWriter::checkOpen() const {
+    if (headerFd_ < 0) {
+        throw std::runtime_error("Trajectory log " + path_ + " is closed");
+    }
+}
+
+std::uint64_t TrajectoryLogWriter::size() const {
+    return header_.sampleCount + static_cast<std::uint64_t>(batch_.size());
+}
+
+std::uint64_t TrajectoryLogWriter::committed() const {
+    return header_.sampleCount;
+}
+
+void TrajectoryLogWriter::append(const Trajectory &trajectory) {
+    checkOpen();
+    if (trajectory.state.rows() != batch_.state.rows() ||
+        trajectory.inputs.rows() != batch_.inputs.rows() ||
+        trajectory.setpoint.rows() != batch_.setpoint.rows()) {
+        throw std::invalid_argument(
+            "Trajectory shape does not match the log's signal shape");
+    }
+    const Eigen::Index n = trajectory.size();
+    if (n == 0) {
+        return;
+    }
+    // Times within a Simulator run never decrease, so checking the ends is
+    // enough to keep the whole log sorted
+    if (trajectory.time(0) < lastTime_ ||
+        trajectory.time(n - 1) < trajectory.time(0)) {
+        throw std::invalid_argument(
+            "Logged times must be non-decreasing (reset simulators need a new log)");
+    }
+
+    Eigen::Index k = 0;
+    while (k < n) {
+        if (batch_.size() == 0 && n - k >= batch_.capacity()) {
+            // Large appends go straight from the caller's rows
+            writeColumns(trajectory, k, n - k);
+            writeHeader();
+            break;
+        }
+        const Eigen::Index take = std::min(batch_.remaining(), n - k);
+        const Eigen::Index at = batch_.size();
+        for (Eigen::Index i = 0; i < take; ++i) {
+            batch_.append();
+        }
+        batch_.time.segment(at, take) = trajectory.time.segment(k, take);
+        batch_.state.middleCols(at, take) = trajectory.state.middleCols(k, take);
+        batch_.inputs.middleCols(at, take) = trajectory.inputs.middleCols(k, take);
+        batch_.setpoint.middleCols(at, take) =
+            trajectory.setpoint.middleCols(k, take);
+        batch_.error.middleCols(at, take) = trajectory.error.middleCols(k, take);
+        batch_.controllerOutput.middleCols(at, take) =
+            trajectory.controllerOutput.middleCols(k, take);
+        k += take;
+        if (batch_.remaining() == 0) {
+            flush();
+        }
+    }
+    lastTime_ = trajectory.time(n - 1);
+}
+
+void TrajectoryLogWriter::flush() {
+    checkOpen();
+    if (batch_.size() == 0) {
+        return;
+    }
+    writeColumns(batch_, 0, batch_.size());
+    batch_.clear();
+    writeHeader();
+}
+
+void TrajectoryLogWriter::close() {
+    if (headerFd_ < 0) {
+        return;
+    }
+    flush();
+    for (int fd : columnFds_) {
+        ::close(fd);
+    }
+    columnFds_.clear();
+    ::close(indexFd_);
+    ::close(headerFd_);
+    indexFd_ = headerFd_ = -1;
+}
+
+void TrajectoryLogWriter::writeColumns(const Trajectory &source,
+                                       Eigen::Index begin, Eigen::Index count) {
+    const std::uint64_t first = header_.sampleCount;
+    const auto offset = static_cast<off_t>(first * sizeof(double));
+    const auto length = static_cast<std::size_t>(count) * sizeof(double);
+    const std::vector<const double *> rows = columnRows(source);
+    const std::vector<std::string> files = columnFiles(header_);
+    for (std::size_t c = 0; c < rows.size(); ++c) {
+        writeAll(columnFds_[c], rows[c] + begin, length, offset, files[c]);
+    }
+
+    // Index entries for the samples at multiples of the stride
+    const std::uint64_t stride = header_.indexStride;
+    std::vector<double> entries;
+    std::uint64_t next = (first + stride - 1) / stride * stride;
+    for (; next < first + static_cast<std::uint64_t>(count); next += stride) {
+        entries.push_back(source.time(begin + static_cast<Eigen::Index>(next - first)));
+    }
+    if (!entries.empty()) {
+        const auto entry = (first + stride - 1) / stride;
+        writeAll(indexFd_, entries.data(), entries.size() * sizeof(double),
+                 static_cast<off_t>(entry * sizeof(double)), INDEX_FILE);
+    }
+    header_.sampleCount = first + static_cast<std::uint64_t>(count);
+}
+
+void TrajectoryLogWriter::writeHeader() {
+    // Written last, so the committed count never covers unwritten data
+    writeAll(headerFd_, &header_, sizeof(header_), 0, HEADER_FILE);
+}
+
+// ============================================================================
+// TrajectoryLogReader
+// ============================================================================
+
+TrajectoryLogReader::TrajectoryLogReader(const std::string &path)
+    : header_(), size_(0), columns_(), index_(), indexCount_(0) {
+    const std::string headerPath = path + "/" + HEADER_FILE;
+    const int headerFd = ::open(headerPath.c_str(), O_RDONLY);
+    if (headerFd < 0) {
+        throw ioError("Cannot open", headerPath);
+    }
+    const bool ok = readAll(headerFd, &header_, sizeof(header_));
+    ::close(headerFd);
+    if (!ok || std::memcmp(header_.magic, LOG_MAGIC, sizeof(LOG_MAGIC)) != 0 ||
+        header_.version != LOG_VERSION || header_.indexStride == 0) {
+        throw std::runtime_error("Not a version " + std::to_string(LOG_VERSION) +
+                                 " trajectory log: " + path);
+    }
+    size_ = static_cast<Eigen::Index>(header_.sampleCount);
+    indexCount_ = (size_ + header_.indexStride - 1) / header_.indexStride;
+
+    const auto map = [&](const std::string &name, Eigen::Index values) {
+        const std::string file = path + "/" + name;
+        Mapping mapping;
+        mapping.length = static_cast<std::size_t>(values) * sizeof(double);
+        if (mapping.length == 0) {
+            return mapping;
+        }
+        const int fd = ::open(file.c_str(), O_RDONLY);
+        if (fd < 0) {
+            throw ioError("Cannot open", file);
+        }
+        if (fileSize(fd, file) < static_cast<off_t>(mapping.length)) {
+            ::close(fd);
+            throw std::runtime_error("Log column " + file +
+                                     " is shorter than its header");
+        }
+        mapping.data = ::mmap(nullptr, mapping.length, PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);  // The mapping keeps the file referenced
+        if (mapping.data == MAP_FAILED) {
+            throw ioError("Cannot map", file);
+        }
+        return mapping;
+    };
+
+    try {
+        index_ = map(INDEX_FILE, indexCount_);
+        for (const std::string &name : columnFiles(header_)) {
+            columns_.push_back(map(name, size_));
+        }
+    } catch (...) {
+        unmap();
+        throw;
+    }
+}
+
+TrajectoryLogReader::~TrajectoryLogReader() {
+    unmap();
+}
+
+void TrajectoryLogReader::unmap() {
+    for (Mapping &mapping : columns_) {
+        if (mapping.data != nullptr) {
+            ::munmap(mapping.data, mapping.length);
+        }
+    }
+    columns_.clear();
+    if (index_.data != nullptr) {
+        ::munmap(index_.data, index_.length);
+        index_.data = nullptr;
+    }
+}
+
+Eigen::Index TrajectoryLogReader::size() const {
+    return size_;
+}
+
+Eigen::Index TrajectoryLogReader::stateSize() const {
+    return header_.stateSize;
+}
+
+Eigen::Index TrajectoryLogReader::inputSize() const {
+    return header_.inputSize;
+}
+
+Eigen::Index TrajectoryLogReader::controllerCount() const {
+    return header_.controllerCount;
+}
+
+const double *TrajectoryLogReader::column(Eigen::Index row) const {
+    return static_cast<const double *>(columns_[static_cast<std::size_t>(row)].data);
+}
+
+const double *TrajectoryLogReader::row(Eigen::Index offset, Eigen::Index count,
+                                       Eigen::Index i, const char *signal) const {
+    if (i < 0 || i >= count) {
+        throw std::out_of_range(std::string(signal) + " index " +
+                                std::to_string(i) + " out of bounds for " +
+                                std::to_string(count) + " row(s)");
+    }
+    return column(offset + i);
+}
+
+const double *TrajectoryLogReader::time() const {
+    return column(0);
+}
+
+const double *TrajectoryLogReader::state(Eigen::Index i) const {
+    return row(1, stateSize(), i, "State");
+}
+
+const double *TrajectoryLogReader::inputs(Eigen::Index j) const {
+    return row(1 + stateSize(), inputSize(), j, "Input");
+}
+
+const double *TrajectoryLogReader::setpoint(Eigen::Index c) const {
+    return row(1 + stateSize() + inputSize(), controllerCount(), c, "Setpoint");
+}
+
+const double *TrajectoryLogReader::error(Eigen::Index c) const {
+    return row(1 + stateSize() + inputSize() + controllerCount(),
+               controllerCount(), c, "Error");
+}
+
+const double *TrajectoryLogReader::controllerOutput(Eigen::Index c) const {
+    return row(1 + stateSize() + inputSize() + 2 * controllerCount(),
+               controllerCount(), c, "Controller output");
+}
+
+template <typename Compare>
+Eigen::Index TrajectoryLogReader::search(double t, Compare before) const {
+    // First index entry not before t; the answer then lies in the stride
+    // block that ends at that entry
+    const auto *index = static_cast<const double *>(index_.data);
+    const auto *time = this->time();
+    const Eigen::Index stride = header_.indexStride;
+    const Eigen::Index entry =
+        std::partition_point(index, index + indexCount_,
+                             [&](double value) { return before(value, t); }) -
+        index;
+    if (entry == 0) {
+        return 0;
+    }
+    const Eigen::Index lo = (entry - 1) * stride + 1;
+    const Eigen::Index hi = std::min(size_, entry * stride);
+    return std::partition_point(time + lo, time + hi,
+                                [&](double value) { return before(value, t); }) -
+           time;
+}
+
+Eigen::Index TrajectoryLogReader::lowerBound(double t) const {
+    return search(t, [](double value, double bound) { return value < bound; });
+}
+
+Eigen::Index TrajectoryLogReader::upperBound(double t) const {
+    return search(t, [](double value, double bound) { return value <= bound; });
+}
+
+TrajectoryLogReader::Window TrajectoryLogReader::window(double t0,
+                                                        double t1) const {
+    Window result;
+    result.begin = lowerBound(t0);
+    result.count = std::max<Eigen::Index>(0, upperBound(t1) - result.begin);
+    return result;
+}
+
+Trajectory TrajectoryLogReader::read(Eigen::Index begin, Eigen::Index count) const {
+    if (begin < 0 || count < 0 || begin + count > size_) {
+        throw std::out_of_range("Log range [" + std::to_string(begin) + ", " +
+                                std::to_string(begin + count) +
+                                ") out of bounds for " + std::to_string(size_) +
+                                " sample(s)");
+    }
+    Trajectory out(count, stateSize(), inputSize(), controllerCount());
+    for (Eigen::Index k = 0; k < count; ++k) {
+        out.append();
+    }
+    const std::vector<double *> rows = columnRows(out);
+    for (std::size_t c = 0; c < rows.size(); ++c) {
+        std::copy_n(column(static_cast<Eigen::Index>(c)) + begin, count, rows[c]);
+    }
+    return out;
+}
+
+}  // namespace tank_sim
@@ -0,0 +1,204 @@
+#ifndef TANK_SIM_TRAJECTORY_LOG_H
+#define TANK_SIM_TRAJECTORY_LOG_H
+
+#include "trajectory.h"
+#include <Eigen/Dense>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace tank_sim {
+
+/**
+ * @brief On-disk, append-only, columnar trajectory log.
+ *
+ * A log is a directory holding one raw float64 file per Trajectory signal
+ * row (time.f64, state_0.f64, input_0.f64, setpoint_0.f64, error_0.f64,
+ * controller_output_0.f64, ...), a sparse time index and a small header:
+ *
+ *   header          magic "TSIMLOG\0", version, signal shape, index stride
+ *                   and the committed sample count (see LogHeader)
+ *   time_index.f64  time of every INDEX_STRIDE-th sample
+ *
+ * Values are stored in host byte order (little-endian on every supported
+ * platform). Because every signal is a flat array, a reader can mmap a
+ * column and hand out any range of it without copying.
+ *
+ * The writer appends column data first and rewrites the sample count in the
+ * header last, so a reader (or a writer reopening the log after a crash)
+ * only ever sees complete samples. Sample times must be non-decreasing,
+ * which is what lets the reader binary search them.
+ */
+struct LogHeader {
+    char magic[8];                  ///< "TSIMLOG\0"
+    std::uint32_t version;          ///< LOG_VERSION
+    std::uint32_t stateSize;
+    std::uint32_t inputSize;
+    std::uint32_t controllerCount;
+    std::uint32_t indexStride;      ///< Samples between time index entries
+    std::uint32_t reserved;
+    std::uint64_t sampleCount;      ///< Committed samples
+};
+
+constexpr std::uint32_t LOG_VERSION = 1;
+constexpr std::uint32_t INDEX_STRIDE = 1024;
+
+/**
+ * @brief Streaming writer for a trajectory log.
+ *
+ * Samples are copied into an in-memory batch and written one column at a
+ * time when the batch fills, so each flush is a handful of large
+ * sequential writes regardless of the number of samples. A Trajectory at
+ * least one batch long is written straight from its rows without copying.
+ *
+ * Opening an existing log resumes it: the shape must match, and any
+ * uncommitted tail left by an interrupted writer is discarded.
+ *
+ * Not thread-safe; the log must have a single writer.
+ */
+class TrajectoryLogWriter {
+public:
+    static constexpr Eigen::Index DEFAULT_BATCH_SIZE = 4096;
+
+    /**
+     * @brief Creates (or resumes) the log directory at path.
+     *
+     * @param path Log directory, created if missing
+     * @param stateSize, inputSize, controllerCount Signal shape, as for
+     *        Trajectory (use Simulator::makeTrajectory to match a simulator)
+     * @param batchSize Samples buffered between writes (must be > 0)
+     *
+     * @throws std::invalid_argument if a size is invalid or an existing log
+     *         has a different shape
+     * @throws std::runtime_error if a file cannot be created or read
+     */
+    TrajectoryLogWriter(const std::string &path, Eigen::Index stateSize,
+                        Eigen::Index inputSize, Eigen::Index controllerCount,
+                        Eigen::Index batchSize = DEFAULT_BATCH_SIZE);
+
+    /// Flushes buffered samples; errors are swallowed, call close() to see them
+    ~TrajectoryLogWriter();
+
+    TrajectoryLogWriter(const TrajectoryLogWriter &) = delete;
+    TrajectoryLogWriter &operator=(const TrajectoryLogWriter &) = delete;
+
+    /**
+     * @brief Appends every recorded sample of trajectory.
+     *
+     * @throws std::invalid_argument if the shape does not match, or the
+     *         samples would make the logged times decrease
+     * @throws std::runtime_error on I/O failure or if the writer is closed
+     */
+    void append(const Trajectory &trajectory);
+
+    /// Writes buffered samples and commits them to the header
+    void flush();
+
+    /// Flushes and closes the files; further appends throw. Idempotent.
+    void close();
+
+    /// Samples appended so far, including those still buffered
+    std::uint64_t size() const;
+
+    /// Samples written and committed to the header
+    std::uint64_t committed() const;
+
+private:
+    void writeColumns(const Trajectory &source, Eigen::Index begin,
+                      Eigen::Index count);
+    void writeHeader();
+    void checkOpen() const;
+
+    std::string path_;
+    LogHeader header_;
+    std::vector<int> columnFds_;    ///< One per signal row, in file order
+    int indexFd_;
+    int headerFd_;
+    Trajectory batch_;
+    double lastTime_;               ///< Time of the newest sample appended
+};
+
+/**
+ * @brief Read-only, memory-mapped view of a trajectory log.
+ *
+ * The reader maps each column at construction and exposes the samples
+ * committed at that moment; reopen it to see samples appended later.
+ * Column pointers stay valid for the reader's lifetime and the pages are
+ * loaded lazily by the OS, so opening a multi-GB log is cheap and replaying
+ * a range only touches that range.
+ *
+ * Time lookups binary search the sparse index and then one INDEX_STRIDE
+ * block of the time column: O(log n), touching a few pages.
+ */
+class TrajectoryLogReader {
+public:
+    /// A contiguous run of samples [begin, begin + count)
+    struct Window {
+        Eigen::Index begin = 0;
+        Eigen::Index count = 0;
+    };
+
+    /**
+     * @throws std::runtime_error if the log is missing, malformed, or its
+     *         column files are shorter than the committed sample count
+     */
+    explicit TrajectoryLogReader(const std::string &path);
+    ~TrajectoryLogReader();
+
+    TrajectoryLogReader(const TrajectoryLogReader &) = delete;
+    TrajectoryLogReader &operator=(const TrajectoryLogReader &) = delete;
+
+    Eigen::Index size() const;
+    Eigen::Index stateSize() const;
+    Eigen::Index inputSize() const;
+    Eigen::Index controllerCount() const;
+
+    // Column pointers, size() values each (nullptr for an empty log)
+    // @throws std::out_of_range if the row index is out of range
+    const double *time() const;
+    const double *state(Eigen::Index i) const;
+    const double *inputs(Eigen::Index j) const;
+    const double *setpoint(Eigen::Index c) const;
+    const double *error(Eigen::Index c) const;
+    const double *controllerOutput(Eigen::Index c) const;
+
+    /// Index of the first sample with time >= t (size() if none)
+    Eigen::Index lowerBound(double t) const;
+
+    /// Index of the first sample with time > t (size() if none)
+    Eigen::Index upperBound(double t) const;
+
+    /// Samples with t0 <= time <= t1
+    Window window(double t0, double t1) const;
+
+    /**
+     * @brief Copies samples [begin, begin + count) into a new Trajectory.
+     *
+     * @throws std::out_of_range if the range is not within [0, size())
+     */
+    Trajectory read(Eigen::Index begin, Eigen::Index count) const;
+
+private:
+    struct Mapping {
+        void *data = nullptr;
+        std::size_t length = 0;
+    };
+
+    void unmap();
+    const double *column(Eigen::Index row) const;
+    const double *row(Eigen::Index offset, Eigen::Index count,
+                      Eigen::Index i, const char *signal) const;
+    template <typename Compare>
+    Eigen::Index search(double t, Compare before) const;
+
+    LogHeader header_;
+    Eigen::Index size_;
+    std::vector<Mapping> columns_;  ///< One per signal row, in file order
+    Mapping index_;
+    Eigen::Index indexCount_;
+};
+
+}  // namespace tank_sim
+
+#endif  // TANK_SIM_TRAJECTORY_LOG_H
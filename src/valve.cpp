@@ -0,0 +1,89 @@
+#include "valve.h"
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+namespace tank_sim {
+
+namespace {
+
+using Table = std::vector<double>;
+
+std::shared_ptr<const Table> buildTable(ValveCharacteristic characteristic,
+                                        double rangeability) {
+    // Not make_shared: the cache's weak_ptr would keep the storage alive
+    std::shared_ptr<Table> table(new Table(ValveCurve::TABLE_SIZE));
+    for (int i = 0; i < ValveCurve::TABLE_SIZE; ++i) {
+        const double x = static_cast<double>(i) / (ValveCurve::TABLE_SIZE - 1);
+        double f = x;
+        switch (characteristic) {
+            case ValveCharacteristic::EQUAL_PERCENTAGE:
+                f = std::expm1(x * std::log(rangeability)) / (rangeability - 1.0);
+                break;
+            case ValveCharacteristic::QUICK_OPENING:
+                f = 1.0 - (1.0 - x) * (1.0 - x);
+                break;
+            case ValveCharacteristic::LINEAR:
+                break;
+        }
+        (*table)[i] = f;
+    }
+    // Exact ends, whatever the rounding above
+    table->front() = 0.0;
+    table->back() = 1.0;
+    return table;
+}
+
+// Curves with the same characteristic and rangeability share one table, so
+// a batch of thousands of identical lanes reads one cache-resident table
+// instead of one per lane. Tables live while any curve holds them.
+std::shared_ptr<const Table> sharedTable(ValveCharacteristic characteristic,
+                                         double rangeability) {
+    static std::mutex mutex;
+    static std::map<std::pair<ValveCharacteristic, double>, std::weak_ptr<const Table>> cache;
+
+    if (characteristic != ValveCharacteristic::EQUAL_PERCENTAGE) {
+        rangeability = 0.0;  // Unused, so not part of the key
+    }
+    const std::lock_guard<std::mutex> lock(mutex);
+    std::weak_ptr<const Table> &entry = cache[{characteristic, rangeability}];
+    std::shared_ptr<const Table> table = entry.lock();
+    if (table == nullptr) {
+        table = buildTable(characteristic, rangeability);
+        entry = table;
+    }
+    return table;
+}
+
+}  // namespace
+
+ValveCurve::ValveCurve(ValveCharacteristic characteristic, double rangeability)
+    : characteristic_(characteristic),
+      table_() {
+    if (characteristic == ValveCharacteristic::LINEAR) {
+        return;
+    }
+    if (characteristic == ValveCharacteristic::EQUAL_PERCENTAGE &&
+        !(rangeability > 1.0)) {
+        throw std::invalid_argument(
+            "Equal-percentage rangeability must be greater than 1, got " +
+            std::to_string(rangeability));
+    }
+    table_ = sharedTable(characteristic, rangeability);
+}
+
+void ValveCurve::openings(const Eigen::Ref<const Eigen::ArrayXd>& x,
+                          Eigen::Ref<Eigen::ArrayXd> out) const {
+    assert(x.size() == out.size() && "Opening buffer must match the positions");
+    if (table_ == nullptr) {
+        out = x;
+        return;
+    }
+    for (Eigen::Index i = 0; i < x.size(); ++i) {
+        out(i) = opening(x(i));
+    }
+}
+
+}  // namespace tank_sim
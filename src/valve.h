@@ -0,0 +1,186 @@
+#ifndef TANK_SIM_VALVE_H
+#define TANK_SIM_VALVE_H
+
+#include "constants.h"
+#include "dual.h"
+#include <Eigen/Dense>
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#ifndef TANK_SIM_FAST_VALVE
+#define TANK_SIM_FAST_VALVE 0
+#endif
+
+namespace tank_sim {
+
+/**
+ * @brief Inherent flow characteristic f(x) of a control valve.
+ *
+ * The outlet flow is q_out = k_v * f(x) * sqrt(h), with f(0) = 0 and
+ * f(1) = 1 for every characteristic:
+ *     LINEAR:            f(x) = x
+ *     EQUAL_PERCENTAGE:  f(x) = (R^x - 1) / (R - 1),  R = rangeability
+ *     QUICK_OPENING:     f(x) = 1 - (1 - x)^2
+ *
+ * EQUAL_PERCENTAGE is the usual R^(x - 1) curve shifted so the valve shuts
+ * tight at x = 0; the two differ by at most 1/R.
+ */
+enum class ValveCharacteristic {
+    LINEAR,
+    EQUAL_PERCENTAGE,
+    QUICK_OPENING
+};
+
+/**
+ * @brief Lookup-table evaluation of a valve characteristic.
+ *
+ * Nonlinear characteristics are sampled once, at construction, on
+ * TABLE_SIZE evenly spaced positions over [0, 1] and evaluated by linear
+ * interpolation, so the per-stage cost is one multiply, one truncation and
+ * two loads instead of a pow(). The interpolation error is at most
+ * max|f''| / (8 (TABLE_SIZE - 1)^2): 2e-6 for EQUAL_PERCENTAGE at R = 50
+ * and 2.4e-7 for QUICK_OPENING. LINEAR has no table and returns x exactly,
+ * so linear valves behave bit-for-bit as before.
+ *
+ * The table is shared between copies, so copying a ValveCurve (and the
+ * TankModel that holds it) is cheap.
+ */
+class ValveCurve {
+public:
+    /// Number of tabulated positions, including both ends
+    static constexpr int TABLE_SIZE = 1025;
+
+    /**
+     * @brief Builds the curve for a characteristic.
+     *
+     * @param characteristic Inherent characteristic
+     * @param rangeability R for EQUAL_PERCENTAGE, ignored otherwise
+     *
+     * @throws std::invalid_argument if rangeability <= 1 for
+     *         EQUAL_PERCENTAGE
+     */
+    explicit ValveCurve(ValveCharacteristic characteristic = ValveCharacteristic::LINEAR,
+                        double rangeability = constants::DEFAULT_VALVE_RANGEABILITY);
+
+    /**
+     * @brief Fraction of full flow at valve position x.
+     *
+     * Templated so that a Dual position carries d(opening)/dx, the slope of
+     * the interpolated segment (the upper segment at a table node).
+     *
+     * x outside [0, 1] is not clamped: the first and last segments are
+     * extended linearly, as the linear curve extends past its ends, so
+     * the table is never read out of bounds. A NaN x gives NaN.
+     */
+    template <typename Scalar>
+    Scalar opening(const Scalar& x) const;
+
+    /**
+     * @brief Applies opening() to every lane.
+     */
+    void openings(const Eigen::Ref<const Eigen::ArrayXd>& x,
+                  Eigen::Ref<Eigen::ArrayXd> out) const;
+
+    ValveCharacteristic getCharacteristic() const { return characteristic_; }
+    bool isLinear() const { return table_ == nullptr; }
+
+private:
+    ValveCharacteristic characteristic_;
+    std::shared_ptr<const std::vector<double>> table_;  ///< Null for LINEAR
+};
+
+template <typename Scalar>
+inline Scalar ValveCurve::opening(const Scalar& x) const {
+    if (table_ == nullptr) {
+        return x;
+    }
+    const Scalar position = x * (TABLE_SIZE - 1);
+    // The end segments also serve x <= 0 and x >= 1; the comparisons are
+    // false for NaN, which therefore reads segment 0
+    const double p = valueOf(position);
+    const int i = p >= TABLE_SIZE - 2 ? TABLE_SIZE - 2
+                  : p > 0.0           ? static_cast<int>(p)
+                                      : 0;
+    const double* f = table_->data() + i;
+    return f[0] + (position - i) * (f[1] - f[0]);
+}
+
+/**
+ * @brief sqrt(h) from a bit-level reciprocal square root seed and three
+ *        Newton steps.
+ *
+ * The seed 0x5FE6EB50C7B537A9 - (bits(h) >> 1) is within 3.5% of
+ * 1/sqrt(h); each Newton step r *= 1.5 - 0.5 h r^2 squares the relative
+ * error (times 1.5), leaving at most 3.2e-11 after three steps plus a few
+ * ulp of rounding, for normal h > 0. fastSqrt(0) is 0. The kernel uses
+ * only multiplies, a shift and an integer subtract, so loops over it
+ * vectorize and pipeline.
+ *
+ * @pre h >= 0 and h is not subnormal
+ */
+inline double fastSqrt(double h) {
+    std::uint64_t bits;
+    std::memcpy(&bits, &h, sizeof(bits));
+    bits = 0x5FE6EB50C7B537A9ULL - (bits >> 1);
+    double r;
+    std::memcpy(&r, &bits, sizeof(r));
+    const double half = 0.5 * h;
+    r *= 1.5 - half * r * r;
+    r *= 1.5 - half * r * r;
+    r *= 1.5 - half * r * r;
+    return h * r;
+}
+
+/// Relative error bound of fastSqrt() for normal h > 0
+constexpr double FAST_SQRT_RELATIVE_ERROR = 4e-11;
+
+/**
+ * @brief Single-precision fastSqrt(): the float seed 0x5F375A86 and the same
+ *        three Newton steps, so the error is float rounding only.
+ *
+ * @pre h >= 0 and h is not subnormal
+ */
+inline float fastSqrt(float h) {
+    std::uint32_t bits;
+    std::memcpy(&bits, &h, sizeof(bits));
+    bits = 0x5F375A86U - (bits >> 1);
+    float r;
+    std::memcpy(&r, &bits, sizeof(r));
+    const float half = 0.5f * h;
+    r *= 1.5f - half * r * r;
+    r *= 1.5f - half * r * r;
+    r *= 1.5f - half * r * r;
+    return h * r;
+}
+
+/// Relative error bound of fastSqrt(float) for normal h > 0
+constexpr float FAST_SQRT_RELATIVE_ERROR_FLOAT = 5e-7f;
+
+/**
+ * @brief Lane-wise square root of the BatchSimulator valve equation, h >= 0.
+ *
+ * h.sqrt(), or fastSqrt() per lane when the core is built with
+ * TANK_SIM_FAST_VALVE (CMake option of the same name). Only the lane
+ * path has the option: inside the fused stage expression the multiply
+ * chain pipelines across lanes where vector sqrt does not, while for the
+ * scalar TankModel one sqrtsd is shorter than three dependent Newton
+ * steps (see BM_BatchSimulatorStepValve and BM_SimulatorStepIntegrator).
+ */
+template <typename Derived>
+inline auto valveSqrt(const Eigen::ArrayBase<Derived>& h) {
+#if TANK_SIM_FAST_VALVE
+    using Scalar = typename Derived::Scalar;
+    return h.unaryExpr([](Scalar v) { return fastSqrt(v); });
+#else
+    return h.sqrt();
+#endif
+}
+
+}  // namespace tank_sim
+
+#endif  // TANK_SIM_VALVE_H
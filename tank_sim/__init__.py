@@ -32,12 +32,45 @@ __version__ = "0.1.0"
 import numpy as np
 
 from ._tank_sim import (
+    AdaptiveTolerances,
+    BatchSimulator,
+    Command,
     ControllerConfig,
+    Disturbance,
+    FloatBatchSimulator,
+    FloatTrajectory,
+    ForecastOptions,
+    Forecaster,
+    GainTuner,
+    HistoryBuffer,
+    HistoryPyramid,
+    Integrator,
+    MixedBatchSimulator,
+    NetworkSimulator,
+    NetworkSimulatorConfig,
+    ParameterSweep,
     PIDGains,
+    PlantNetwork,
+    PrecisionReport,
+    ReplayOptions,
+    ReplayResult,
+    ReplayTolerance,
+    Scenario,
+    ScenarioReplay,
+    SessionPool,
     Simulator,
     SimulatorConfig,
+    SimulatorSnapshot,
+    SweepOptions,
     TankModelParameters,
+    Trajectory,
+    TrajectoryLog,
+    TrajectoryLogWriter,
+    TuneResult,
+    TunerOptions,
+    ValveCharacteristic,
     get_version,
+    measure_precision,
 )
 
 
@@ -110,9 +143,40 @@ def create_default_config():
 __all__ = [
     "get_version",
     "Simulator",
+    "BatchSimulator",
+    "FloatBatchSimulator",
+    "MixedBatchSimulator",
+    "PrecisionReport",
+    "measure_precision",
+    "NetworkSimulator",
+    "NetworkSimulatorConfig",
+    "PlantNetwork",
     "SimulatorConfig",
+    "SimulatorSnapshot",
     "ControllerConfig",
+    "Disturbance",
+    "Command",
+    "Integrator",
+    "AdaptiveTolerances",
     "TankModelParameters",
+    "ValveCharacteristic",
+    "Trajectory",
+    "FloatTrajectory",
+    "TrajectoryLog",
+    "TrajectoryLogWriter",
+    "HistoryBuffer",
+    "HistoryPyramid",
     "PIDGains",
+    "ParameterSweep",
+    "SweepOptions",
+    "GainTuner",
+    "TunerOptions",
+    "TuneResult",
+    "Scenario",
+    "ScenarioReplay",
+    "ReplayOptions",
+    "ReplayResult",
+    "ReplayTolerance",
+    "SessionPool",
     "create_default_config",
 ]
@@ -1,5 +1,8 @@
 """Type stubs for the C++ extension module."""
 
+import enum
+from typing import Any, overload
+
 import numpy as np
 import numpy.typing as npt
 
@@ -18,10 +21,88 @@ class ControllerConfig:
     output_index: int
     initial_setpoint: float
 
+class ValveCharacteristic(enum.Enum):
+    LINEAR = ...
+    EQUAL_PERCENTAGE = ...
+    QUICK_OPENING = ...
+
 class TankModelParameters:
     area: float
     k_v: float
     max_height: float
+    valve_characteristic: ValveCharacteristic
+    rangeability: float
+
+class Integrator(enum.Enum):
+    RK4 = ...
+    GSL_RK4 = ...
+    ADAPTIVE_RKF45 = ...
+    ROSENBROCK = ...
+    EXACT_ZOH = ...
+
+class AdaptiveTolerances:
+    absolute: float
+    relative: float
+    @overload
+    def __init__(self) -> None: ...
+    @overload
+    def __init__(self, absolute: float, relative: float) -> None: ...
+
+class Disturbance:
+    class Kind(enum.Enum):
+        BROWNIAN = ...
+        ORNSTEIN_UHLENBECK = ...
+        STEP = ...
+        RAMP = ...
+    kind: Disturbance.Kind
+    input_index: int
+    sigma: float
+    theta: float
+    mean: float
+    magnitude: float
+    start_time: float
+    duration: float
+    min_value: float
+    max_value: float
+    @staticmethod
+    def brownian(
+        input_index: int, sigma: float, min_value: float = ..., max_value: float = ...
+    ) -> Disturbance: ...
+    @staticmethod
+    def ornstein_uhlenbeck(
+        input_index: int,
+        mean: float,
+        theta: float,
+        sigma: float,
+        min_value: float = ...,
+        max_value: float = ...,
+    ) -> Disturbance: ...
+    @staticmethod
+    def step(input_index: int, start_time: float, magnitude: float) -> Disturbance: ...
+    @staticmethod
+    def ramp(
+        input_index: int, start_time: float, duration: float, magnitude: float
+    ) -> Disturbance: ...
+
+class Command:
+    class Kind(enum.Enum):
+        INPUT = ...
+        SETPOINT = ...
+        GAINS = ...
+    @property
+    def kind(self) -> Command.Kind: ...
+    @property
+    def index(self) -> int: ...
+    @property
+    def value(self) -> float: ...
+    @property
+    def gains(self) -> PIDGains: ...
+    @staticmethod
+    def input(index: int, value: float) -> Command: ...
+    @staticmethod
+    def setpoint(controller: int, value: float) -> Command: ...
+    @staticmethod
+    def retune(controller: int, gains: PIDGains) -> Command: ...
 
 class SimulatorConfig:
     model_params: TankModelParameters
@@ -29,19 +110,548 @@ class SimulatorConfig:
     dt: float
     initial_state: npt.NDArray[np.float64]
     initial_inputs: npt.NDArray[np.float64]
+    integrator: Integrator
+    tolerances: AdaptiveTolerances
+    history_capacity: int
+    history_levels: list[tuple[int, int]]
+    disturbances: list[Disturbance]
+    disturbance_seed: int
+    disturbance_stream: int
+    command_queue_capacity: int
+
+class HistoryBuffer:
+    def __init__(self, capacity: int) -> None: ...
+    def __len__(self) -> int: ...
+    @property
+    def capacity(self) -> int: ...
+    @property
+    def size(self) -> int: ...
+    @property
+    def total(self) -> int: ...
+    def window(
+        self, t0: float, t1: float, copy: bool = False
+    ) -> dict[str, npt.NDArray[np.float64]]: ...
+    def latest(self, n: int, copy: bool = False) -> dict[str, npt.NDArray[np.float64]]: ...
+
+class HistoryPyramid:
+    def __init__(self, levels: list[tuple[int, int]]) -> None: ...
+    @property
+    def levels(self) -> list[tuple[int, int]]: ...
+    def select(self, t0: float, t1: float, max_points: int) -> int: ...
+    def count(self, level: int, t0: float, t1: float) -> int: ...
+    def query(self, level: int, t0: float, t1: float) -> dict[str, Any]: ...
+
+class Trajectory:
+    def __init__(
+        self, capacity: int, state_size: int, input_size: int, controller_count: int
+    ) -> None: ...
+    def __len__(self) -> int: ...
+    def clear(self) -> None: ...
+    @property
+    def capacity(self) -> int: ...
+    @property
+    def size(self) -> int: ...
+    @property
+    def time(self) -> npt.NDArray[np.float64]: ...
+    @property
+    def state(self) -> npt.NDArray[np.float64]: ...
+    @property
+    def level(self) -> npt.NDArray[np.float64]: ...
+    @property
+    def inputs(self) -> npt.NDArray[np.float64]: ...
+    @property
+    def setpoint(self) -> npt.NDArray[np.float64]: ...
+    @property
+    def error(self) -> npt.NDArray[np.float64]: ...
+    @property
+    def controller_output(self) -> npt.NDArray[np.float64]: ...
+
+class FloatTrajectory:
+    def __init__(
+        self, capacity: int, state_size: int, input_size: int, controller_count: int
+    ) -> None: ...
+    def __len__(self) -> int: ...
+    def clear(self) -> None: ...
+    @property
+    def capacity(self) -> int: ...
+    @property
+    def size(self) -> int: ...
+    @property
+    def time(self) -> npt.NDArray[np.float64]: ...
+    @property
+    def state(self) -> npt.NDArray[np.float32]: ...
+    @property
+    def level(self) -> npt.NDArray[np.float32]: ...
+    @property
+    def inputs(self) -> npt.NDArray[np.float32]: ...
+    @property
+    def setpoint(self) -> npt.NDArray[np.float32]: ...
+    @property
+    def error(self) -> npt.NDArray[np.float32]: ...
+    @property
+    def controller_output(self) -> npt.NDArray[np.float32]: ...
+
+class TrajectoryLogWriter:
+    @overload
+    def __init__(
+        self,
+        path: str,
+        state_size: int,
+        input_size: int,
+        controller_count: int,
+        batch_size: int = 4096,
+    ) -> None: ...
+    @overload
+    def __init__(self, path: str, simulator: Simulator, batch_size: int = 4096) -> None: ...
+    def append(self, trajectory: Trajectory) -> None: ...
+    def flush(self) -> None: ...
+    def close(self) -> None: ...
+    @property
+    def size(self) -> int: ...
+    @property
+    def committed(self) -> int: ...
+    def __len__(self) -> int: ...
+    def __enter__(self) -> TrajectoryLogWriter: ...
+    def __exit__(self, *args: object) -> None: ...
+
+class TrajectoryLog:
+    def __init__(self, path: str) -> None: ...
+    @property
+    def size(self) -> int: ...
+    def __len__(self) -> int: ...
+    @property
+    def state_size(self) -> int: ...
+    @property
+    def input_size(self) -> int: ...
+    @property
+    def controller_count(self) -> int: ...
+    @property
+    def time(self) -> npt.NDArray[np.float64]: ...
+    def state(self, i: int) -> npt.NDArray[np.float64]: ...
+    def inputs(self, j: int) -> npt.NDArray[np.float64]: ...
+    def setpoint(self, c: int) -> npt.NDArray[np.float64]: ...
+    def error(self, c: int) -> npt.NDArray[np.float64]: ...
+    def controller_output(self, c: int) -> npt.NDArray[np.float64]: ...
+    def lower_bound(self, t: float) -> int: ...
+    def upper_bound(self, t: float) -> int: ...
+    def window(self, t0: float, t1: float) -> slice: ...
+    def read(self, begin: int, count: int) -> Trajectory: ...
+
+class SimulatorSnapshot:
+    @property
+    def time(self) -> float: ...
+    @property
+    def state(self) -> list[float]: ...
+    @property
+    def inputs(self) -> list[float]: ...
+    @property
+    def controller_count(self) -> int: ...
+    @property
+    def integral_states(self) -> list[float]: ...
 
 class Simulator:
     def __init__(self, config: SimulatorConfig) -> None: ...
     def step(self) -> None: ...
     def reset(self) -> None: ...
+    def reinit(self, config: SimulatorConfig) -> None: ...
     def get_state(self) -> npt.NDArray[np.float64]: ...
     def get_inputs(self) -> npt.NDArray[np.float64]: ...
     def get_time(self) -> float: ...
+    def get_step_count(self) -> int: ...
+    def set_disturbances(self, disturbances: list[Disturbance]) -> None: ...
+    def get_disturbances(self) -> list[Disturbance]: ...
     def get_setpoint(self, index: int) -> float: ...
     def get_error(self, index: int) -> float: ...
     def get_controller_output(self, index: int) -> float: ...
     def set_setpoint(self, index: int, value: float) -> None: ...
     def set_input(self, index: int, value: float) -> None: ...
     def set_controller_gains(self, index: int, gains: PIDGains) -> None: ...
+    def get_outlet_flow(self) -> float: ...
+    def get_outputs(self) -> npt.NDArray[np.float64]: ...
+    def get_integration_stats(self) -> dict[str, int]: ...
+    def get_metrics(self) -> dict[str, Any]: ...
+    def clear_metrics(self) -> None: ...
+    def post_commands(self, commands: list[Command]) -> int: ...
+    def get_command_stats(self) -> dict[str, int]: ...
+    def snapshot(self, index: int = 0) -> dict[str, float]: ...
+    @property
+    def history(self) -> HistoryBuffer | None: ...
+    @property
+    def history_pyramid(self) -> HistoryPyramid | None: ...
+    @overload
+    def run(self, n_steps: int, out: Trajectory | None = None) -> Trajectory: ...
+    @overload
+    def run(self, n_steps: int, out: FloatTrajectory) -> FloatTrajectory: ...
+    @overload
+    def run_until(self, t_end: float, out: Trajectory | None = None) -> Trajectory: ...
+    @overload
+    def run_until(self, t_end: float, out: FloatTrajectory) -> FloatTrajectory: ...
+    def make_trajectory(self, capacity: int) -> Trajectory: ...
+    def make_float_trajectory(self, capacity: int) -> FloatTrajectory: ...
+    def save(self) -> SimulatorSnapshot: ...
+    def restore(self, snapshot: SimulatorSnapshot) -> None: ...
+    def fork(self) -> Simulator: ...
+    def fork_batch(self, config: SimulatorConfig, lane_count: int) -> BatchSimulator: ...
+
+class PlantNetwork:
+    DRAIN: int
+    FULLY_OPEN: int
+
+    class FlowLaw(enum.Enum):
+        FREE_DISCHARGE = ...
+        HEAD_DIFFERENCE = ...
+
+    class Tank:
+        area: float
+        max_height: float
+        @overload
+        def __init__(self) -> None: ...
+        @overload
+        def __init__(self, area: float, max_height: float) -> None: ...
+
+    class Valve:
+        from_tank: int
+        to_tank: int
+        k_v: float
+        position_input: int
+        law: PlantNetwork.FlowLaw
+        @overload
+        def __init__(self) -> None: ...
+        @overload
+        def __init__(
+            self,
+            from_tank: int,
+            to_tank: int,
+            k_v: float,
+            position_input: int = -1,
+            law: PlantNetwork.FlowLaw = ...,
+        ) -> None: ...
+
+    class Inflow:
+        tank: int
+        input: int
+        @overload
+        def __init__(self) -> None: ...
+        @overload
+        def __init__(self, tank: int, input: int) -> None: ...
+
+    class Topology:
+        tanks: list[PlantNetwork.Tank]
+        valves: list[PlantNetwork.Valve]
+        inflows: list[PlantNetwork.Inflow]
+        input_count: int
+
+    def __init__(self, topology: PlantNetwork.Topology) -> None: ...
+    @staticmethod
+    def single_tank(params: TankModelParameters) -> PlantNetwork.Topology: ...
+    @staticmethod
+    def cascade(tank_count: int, params: TankModelParameters) -> PlantNetwork.Topology: ...
+    @property
+    def state_size(self) -> int: ...
+    @property
+    def input_size(self) -> int: ...
+    @property
+    def valve_count(self) -> int: ...
+    @property
+    def topology(self) -> PlantNetwork.Topology: ...
+    def derivatives(
+        self, state: npt.ArrayLike, inputs: npt.ArrayLike
+    ) -> npt.NDArray[np.float64]: ...
+    def valve_flows(
+        self, state: npt.ArrayLike, inputs: npt.ArrayLike
+    ) -> npt.NDArray[np.float64]: ...
+
+class NetworkSimulatorConfig:
+    network: PlantNetwork.Topology
+    controllers: list[ControllerConfig]
+    initial_state: npt.NDArray[np.float64]
+    initial_inputs: npt.NDArray[np.float64]
+    dt: float
+    integrator: Integrator
+
+class NetworkSimulator:
+    def __init__(self, config: NetworkSimulatorConfig) -> None: ...
+    def step(self) -> None: ...
+    def run(self, n_steps: int, out: Trajectory | None = None) -> Trajectory: ...
+    def make_trajectory(self, capacity: int) -> Trajectory: ...
+    def reset(self) -> None: ...
+    def get_time(self) -> float: ...
+    def get_state(self) -> npt.NDArray[np.float64]: ...
+    def get_inputs(self) -> npt.NDArray[np.float64]: ...
+    def get_setpoint(self, index: int) -> float: ...
+    def get_error(self, index: int) -> float: ...
+    def get_controller_output(self, index: int) -> float: ...
+    def get_controller_count(self) -> int: ...
+    def get_valve_flows(self) -> npt.NDArray[np.float64]: ...
+    @property
+    def network(self) -> PlantNetwork: ...
+    def set_input(self, index: int, value: float) -> None: ...
+    def set_setpoint(self, index: int, value: float) -> None: ...
+    def set_controller_gains(self, index: int, gains: PIDGains) -> None: ...
+
+class BatchSimulator:
+    @overload
+    def __init__(self, config: SimulatorConfig, lane_count: int) -> None: ...
+    @overload
+    def __init__(self, configs: list[SimulatorConfig]) -> None: ...
+    def step(self) -> None: ...
+    def run(self, n_steps: int) -> None: ...
+    def reset(self) -> None: ...
+    def restore(self, snapshot: SimulatorSnapshot) -> None: ...
+    @property
+    def lane_count(self) -> int: ...
+    @property
+    def has_controller(self) -> bool: ...
+    def get_time(self) -> float: ...
+    def get_step_count(self) -> int: ...
+    def get_disturbance_streams(self) -> npt.NDArray[np.uint32]: ...
+    def get_levels(self) -> npt.NDArray[np.float64]: ...
+    def get_inputs(self, index: int) -> npt.NDArray[np.float64]: ...
+    def get_setpoints(self) -> npt.NDArray[np.float64]: ...
+    def get_integral_states(self) -> npt.NDArray[np.float64]: ...
+    def get_errors(self) -> npt.NDArray[np.float64]: ...
+    def get_controller_outputs(self) -> npt.NDArray[np.float64]: ...
+    def get_outlet_flows(self) -> npt.NDArray[np.float64]: ...
+    def set_input(self, index: int, values: npt.ArrayLike) -> None: ...
+    def set_lane_input(self, lane: int, index: int, value: float) -> None: ...
+    def set_setpoints(self, values: npt.ArrayLike) -> None: ...
+    def set_setpoint(self, lane: int, value: float) -> None: ...
+    def set_controller_gains(self, lane: int, gains: PIDGains) -> None: ...
+    def set_parameters(self, lane: int, params: TankModelParameters) -> None: ...
+
+class FloatBatchSimulator:
+    @overload
+    def __init__(self, config: SimulatorConfig, lane_count: int) -> None: ...
+    @overload
+    def __init__(self, configs: list[SimulatorConfig]) -> None: ...
+    def step(self) -> None: ...
+    def run(self, n_steps: int) -> None: ...
+    def reset(self) -> None: ...
+    def restore(self, snapshot: SimulatorSnapshot) -> None: ...
+    @property
+    def lane_count(self) -> int: ...
+    @property
+    def has_controller(self) -> bool: ...
+    def get_time(self) -> float: ...
+    def get_step_count(self) -> int: ...
+    def get_disturbance_streams(self) -> npt.NDArray[np.uint32]: ...
+    def get_levels(self) -> npt.NDArray[np.float32]: ...
+    def get_inputs(self, index: int) -> npt.NDArray[np.float32]: ...
+    def get_setpoints(self) -> npt.NDArray[np.float32]: ...
+    def get_integral_states(self) -> npt.NDArray[np.float32]: ...
+    def get_errors(self) -> npt.NDArray[np.float32]: ...
+    def get_controller_outputs(self) -> npt.NDArray[np.float32]: ...
+    def get_outlet_flows(self) -> npt.NDArray[np.float32]: ...
+    def set_input(self, index: int, values: npt.ArrayLike) -> None: ...
+    def set_lane_input(self, lane: int, index: int, value: float) -> None: ...
+    def set_setpoints(self, values: npt.ArrayLike) -> None: ...
+    def set_setpoint(self, lane: int, value: float) -> None: ...
+    def set_controller_gains(self, lane: int, gains: PIDGains) -> None: ...
+    def set_parameters(self, lane: int, params: TankModelParameters) -> None: ...
+
+class MixedBatchSimulator:
+    @overload
+    def __init__(self, config: SimulatorConfig, lane_count: int) -> None: ...
+    @overload
+    def __init__(self, configs: list[SimulatorConfig]) -> None: ...
+    def step(self) -> None: ...
+    def run(self, n_steps: int) -> None: ...
+    def reset(self) -> None: ...
+    def restore(self, snapshot: SimulatorSnapshot) -> None: ...
+    @property
+    def lane_count(self) -> int: ...
+    @property
+    def has_controller(self) -> bool: ...
+    def get_time(self) -> float: ...
+    def get_step_count(self) -> int: ...
+    def get_disturbance_streams(self) -> npt.NDArray[np.uint32]: ...
+    def get_levels(self) -> npt.NDArray[np.float32]: ...
+    def get_inputs(self, index: int) -> npt.NDArray[np.float32]: ...
+    def get_setpoints(self) -> npt.NDArray[np.float32]: ...
+    def get_integral_states(self) -> npt.NDArray[np.float64]: ...
+    def get_errors(self) -> npt.NDArray[np.float32]: ...
+    def get_controller_outputs(self) -> npt.NDArray[np.float32]: ...
+    def get_outlet_flows(self) -> npt.NDArray[np.float32]: ...
+    def set_input(self, index: int, values: npt.ArrayLike) -> None: ...
+    def set_lane_input(self, lane: int, index: int, value: float) -> None: ...
+    def set_setpoints(self, values: npt.ArrayLike) -> None: ...
+    def set_setpoint(self, lane: int, value: float) -> None: ...
+    def set_controller_gains(self, lane: int, gains: PIDGains) -> None: ...
+    def set_parameters(self, lane: int, params: TankModelParameters) -> None: ...
+
+class PrecisionReport:
+    @property
+    def lanes(self) -> int: ...
+    @property
+    def steps(self) -> int: ...
+    @property
+    def max_level_error(self) -> float: ...
+    @property
+    def rms_level_error(self) -> float: ...
+    @property
+    def final_max_level_error(self) -> float: ...
+    @property
+    def worst_lane(self) -> int: ...
+    @property
+    def max_output_error(self) -> float: ...
+    @property
+    def max_integral_error(self) -> float: ...
+
+@overload
+def measure_precision(
+    config: SimulatorConfig, lane_count: int, steps: int, mixed: bool = False
+) -> PrecisionReport: ...
+@overload
+def measure_precision(
+    configs: list[SimulatorConfig], steps: int, mixed: bool = False
+) -> PrecisionReport: ...
+
+class SweepOptions:
+    steps: int
+    setpoint: float
+    controller_index: int
+    settling_band: float
+    threads: int
+    def __init__(self) -> None: ...
+
+class ParameterSweep:
+    def __init__(self, base_config: SimulatorConfig, options: SweepOptions) -> None: ...
+    @property
+    def thread_count(self) -> int: ...
+    @staticmethod
+    def make_grid(
+        Kc: list[float], tau_I: list[float], tau_D: list[float]
+    ) -> list[PIDGains]: ...
+    def run(self, cases: list[PIDGains]) -> dict[str, npt.NDArray[np.float64]]: ...
+    def run_grid(
+        self, Kc: list[float], tau_I: list[float], tau_D: list[float]
+    ) -> dict[str, npt.NDArray[np.float64]]: ...
+
+class TunerOptions:
+    steps: int
+    setpoint: float
+    controller_index: int
+    lower: PIDGains
+    upper: PIDGains
+    max_iterations: int
+    tolerance: float
+    def __init__(self) -> None: ...
+
+class TuneResult:
+    @property
+    def gains(self) -> PIDGains: ...
+    @property
+    def iae(self) -> float: ...
+    @property
+    def gradient(self) -> npt.NDArray[np.float64]: ...
+    @property
+    def iterations(self) -> int: ...
+    @property
+    def evaluations(self) -> int: ...
+    @property
+    def converged(self) -> bool: ...
+
+class GainTuner:
+    def __init__(self, base_config: SimulatorConfig, options: TunerOptions) -> None: ...
+    def evaluate(self, gains: PIDGains) -> tuple[float, npt.NDArray[np.float64]]: ...
+    def tune(self, initial: PIDGains) -> TuneResult: ...
+
+class Scenario:
+    class Event:
+        class Kind(enum.Enum):
+            INPUT = ...
+            SETPOINT = ...
+            GAINS = ...
+        time: float
+        kind: Scenario.Event.Kind
+        index: int
+        value: float
+        gains: PIDGains
+        def __init__(
+            self,
+            time: float,
+            kind: Scenario.Event.Kind,
+            index: int,
+            value: float = 0.0,
+            gains: PIDGains = ...,
+        ) -> None: ...
+    name: str
+    duration: float
+    events: list[Scenario.Event]
+    def __init__(self) -> None: ...
+    @staticmethod
+    def parse(text: str, name: str = "") -> Scenario: ...
+    @staticmethod
+    def load(path: str) -> Scenario: ...
+    def save(self, path: str) -> None: ...
+    def to_string(self) -> str: ...
+
+class ReplayTolerance:
+    absolute: float
+    relative: float
+    def __init__(self) -> None: ...
+
+class ReplayOptions:
+    tolerance: ReplayTolerance
+    threads: int
+    def __init__(self) -> None: ...
+
+class ReplayResult:
+    @property
+    def passed(self) -> bool: ...
+    @property
+    def samples(self) -> int: ...
+    @property
+    def max_error(self) -> float: ...
+    @property
+    def first_failure(self) -> int: ...
+    @property
+    def signal(self) -> str: ...
+
+class ScenarioReplay:
+    def __init__(self, base_config: SimulatorConfig, options: ReplayOptions) -> None: ...
+    @property
+    def thread_count(self) -> int: ...
+    def replay(self, scenario: Scenario) -> Trajectory: ...
+    def replay_all(self, scenarios: list[Scenario]) -> list[Trajectory]: ...
+    def verify(
+        self, scenarios: list[Scenario], goldens: list[Trajectory]
+    ) -> list[ReplayResult]: ...
+    @staticmethod
+    def compare(
+        actual: Trajectory, golden: Trajectory, tolerance: ReplayTolerance
+    ) -> ReplayResult: ...
+
+class ForecastOptions:
+    horizon_steps: int
+    sample_interval: int
+    @overload
+    def __init__(self) -> None: ...
+    @overload
+    def __init__(self, horizon_steps: int, sample_interval: int = 1) -> None: ...
+
+class Forecaster:
+    def __init__(self, config: SimulatorConfig, options: ForecastOptions) -> None: ...
+    @property
+    def options(self) -> ForecastOptions: ...
+    @property
+    def sample_count(self) -> int: ...
+    def run(
+        self,
+        simulator: Simulator,
+        setpoints: npt.ArrayLike | None = None,
+        inlet_flows: npt.ArrayLike | None = None,
+    ) -> dict[str, npt.NDArray[np.float64]]: ...
+
+class SessionPool:
+    def __init__(self, threads: int = 0) -> None: ...
+    @property
+    def thread_count(self) -> int: ...
+    def add(self, simulator: Simulator) -> int: ...
+    def remove(self, session: int) -> None: ...
+    def shard(self, session: int) -> int: ...
+    def __contains__(self, session: int) -> bool: ...
+    def __len__(self) -> int: ...
+    def advance(self, work: list[tuple[int, int]]) -> list[tuple[int, str]]: ...
 
 def get_version() -> str: ...
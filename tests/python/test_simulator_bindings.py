@@ -10,6 +10,7 @@ This module tests the Python bindings to the C++ simulation library, verifying:
 - Exception handling
 - Numpy array conversion
 - Dynamic controller retuning
+- Batch runs into zero-copy trajectories and telemetry snapshots
 
 Tests serve dual purposes:
 1. Verify bindings correctness and completeness
@@ -43,6 +44,23 @@ class TestConfigurationCreation:
         assert params.k_v == 1.2649, "Valve coefficient not set correctly"
         assert params.max_height == 5.0, "Max height not set correctly"
 
+    def test_valve_characteristic(self):
+        """Verify an equal-percentage valve needs more travel at steady state."""
+        linear_sim = tank_sim.Simulator(tank_sim.create_default_config())
+        config = tank_sim.create_default_config()
+        assert config.model_params.valve_characteristic == tank_sim.ValveCharacteristic.LINEAR
+        config.model_params.valve_characteristic = tank_sim.ValveCharacteristic.EQUAL_PERCENTAGE
+        config.model_params.rangeability = 50.0
+        equal_sim = tank_sim.Simulator(config)
+
+        linear_sim.run(300)
+        equal_sim.run(300)
+        assert equal_sim.get_inputs()[1] > linear_sim.get_inputs()[1]
+
+        config.model_params.rangeability = 1.0
+        with pytest.raises(ValueError):
+            tank_sim.Simulator(config)
+
     def test_pid_gains_creation(self):
         """Verify PIDGains can be created and modified.
 
@@ -401,6 +419,31 @@ class TestResetFunctionality:
             "Behavior should be reproducible after reset"
         )
 
+    def test_reinit_matches_new_simulator(self, default_config):
+        """Verify reinit() behaves like constructing from the new config."""
+        sim = tank_sim.Simulator(default_config)
+        sim.run(50)
+
+        controller = default_config.controllers[0]
+        controller.initial_setpoint = 3.0
+        default_config.controllers = [controller]  # The list is a copy
+        sim.reinit(default_config)
+        fresh = tank_sim.Simulator(default_config)
+        assert sim.get_time() == 0.0
+        sim.run(50)
+        fresh.run(50)
+        np.testing.assert_array_equal(sim.get_state(), fresh.get_state())
+        assert sim.get_setpoint(0) == 3.0
+
+    def test_invalid_reinit_leaves_simulator_unchanged(self, default_config):
+        """Verify a rejected reinit() keeps the running simulation."""
+        sim = tank_sim.Simulator(default_config)
+        sim.run(10)
+        default_config.dt = -1.0
+        with pytest.raises(ValueError):
+            sim.reinit(default_config)
+        assert sim.get_time() == pytest.approx(10.0)
+
 
 class TestExceptionHandling:
     """Tests for proper error handling."""
@@ -812,3 +855,880 @@ class TestEdgeCases:
 
         with pytest.raises((ValueError, RuntimeError)):
             tank_sim.Simulator(config)
+
+
+class TestIntegratorSelection:
+    """Tests for choosing the integration backend from Python."""
+
+    def test_default_integrator_is_native_rk4(self, default_config):
+        """Verify the fast native integrator is used unless asked otherwise."""
+        assert default_config.integrator == tank_sim.Integrator.RK4
+
+    def test_gsl_integrator_matches_native(self, default_config):
+        """Verify the GSL reference integrator tracks the native one.
+
+        Both are 4th-order RK4 methods, so a closed-loop step response should
+        agree far more tightly than any control tolerance.
+        """
+        gsl_config = tank_sim.create_default_config()
+        gsl_config.integrator = tank_sim.Integrator.GSL_RK4
+
+        native_sim = tank_sim.Simulator(default_config)
+        gsl_sim = tank_sim.Simulator(gsl_config)
+        native_sim.set_setpoint(0, 3.0)
+        gsl_sim.set_setpoint(0, 3.0)
+
+        for _ in range(200):
+            native_sim.step()
+            gsl_sim.step()
+
+        assert abs(native_sim.get_state()[0] - gsl_sim.get_state()[0]) < 1e-4, (
+            "Integrators should agree to within RK4 truncation error"
+        )
+
+    def test_adaptive_integrator_reports_savings(self, default_config):
+        """Verify the adaptive integrator matches RK4 and reports its work."""
+        adaptive_config = tank_sim.create_default_config()
+        adaptive_config.integrator = tank_sim.Integrator.ADAPTIVE_RKF45
+        adaptive_config.tolerances = tank_sim.AdaptiveTolerances(1e-10, 1e-10)
+
+        rk4_sim = tank_sim.Simulator(default_config)
+        adaptive_sim = tank_sim.Simulator(adaptive_config)
+        rk4_sim.set_setpoint(0, 3.0)
+        adaptive_sim.set_setpoint(0, 3.0)
+        rk4_sim.run(200)
+        adaptive_sim.run(200)
+
+        assert abs(rk4_sim.get_state()[0] - adaptive_sim.get_state()[0]) < 1e-6
+        stats = adaptive_sim.get_integration_stats()
+        assert stats["steps"] >= 200
+        assert stats["derivative_evaluations"] == 6 * (
+            stats["steps"] + stats["rejected_steps"]
+        )
+        assert rk4_sim.get_integration_stats()["steps"] == 200
+
+    def test_rosenbrock_integrator_matches_rk4(self, default_config):
+        """Verify the implicit integrator tracks RK4 and counts Jacobians."""
+        implicit_config = tank_sim.create_default_config()
+        implicit_config.integrator = tank_sim.Integrator.ROSENBROCK
+
+        rk4_sim = tank_sim.Simulator(default_config)
+        implicit_sim = tank_sim.Simulator(implicit_config)
+        rk4_sim.set_setpoint(0, 3.0)
+        implicit_sim.set_setpoint(0, 3.0)
+        rk4_sim.run(200)
+        implicit_sim.run(200)
+
+        assert abs(rk4_sim.get_state()[0] - implicit_sim.get_state()[0]) < 1e-3
+        stats = implicit_sim.get_integration_stats()
+        assert stats["steps"] == 200
+        assert stats["jacobian_evaluations"] == 200
+
+    def test_exact_zoh_integrator_matches_rk4(self, default_config):
+        """Verify the closed-form integrator tracks RK4 and counts its steps."""
+        zoh_config = tank_sim.create_default_config()
+        zoh_config.integrator = tank_sim.Integrator.EXACT_ZOH
+
+        rk4_sim = tank_sim.Simulator(default_config)
+        zoh_sim = tank_sim.Simulator(zoh_config)
+        rk4_sim.set_setpoint(0, 3.0)
+        zoh_sim.set_setpoint(0, 3.0)
+        rk4_sim.run(200)
+        zoh_sim.run(200)
+
+        assert abs(rk4_sim.get_state()[0] - zoh_sim.get_state()[0]) < 1e-9
+        stats = zoh_sim.get_integration_stats()
+        assert stats["steps"] == 200
+        assert stats["jacobian_evaluations"] == 0
+
+    def test_outputs_match_outlet_flow(self, default_config):
+        """Verify the tank model's single output is its outlet flow."""
+        sim = tank_sim.Simulator(default_config)
+        sim.set_setpoint(0, 3.0)
+        sim.run(10)
+        outputs = sim.get_outputs()
+        assert outputs.shape == (1,)
+        assert outputs[0] == sim.get_outlet_flow()
+
+
+class TestTrajectoryRun:
+    """Tests for batch stepping into zero-copy trajectories."""
+
+    def test_run_matches_repeated_step(self, default_config):
+        """Verify run(n) produces the same trajectory as n calls to step()."""
+        batch_sim = tank_sim.Simulator(default_config)
+        loop_sim = tank_sim.Simulator(default_config)
+        batch_sim.set_setpoint(0, 3.0)
+        loop_sim.set_setpoint(0, 3.0)
+
+        traj = batch_sim.run(100)
+
+        levels = []
+        for _ in range(100):
+            loop_sim.step()
+            levels.append(loop_sim.get_state()[0])
+
+        assert len(traj) == 100
+        assert traj.level.shape == (100,)
+        np.testing.assert_array_equal(traj.level, np.array(levels))
+        assert traj.time[-1] == pytest.approx(loop_sim.get_time())
+        assert traj.inputs.shape == (2, 100)
+        assert traj.setpoint.shape == (1, 100)
+        np.testing.assert_array_equal(traj.setpoint[0], 3.0)
+
+    def test_views_share_trajectory_memory(self, default_config):
+        """Verify signal arrays are views that outlive the Python reference."""
+        sim = tank_sim.Simulator(default_config)
+        traj = sim.run(10)
+
+        assert traj.state.base is not None, "state should be a view, not a copy"
+
+        level = traj.level
+        del traj
+        # The view keeps the C++ buffer alive after the trajectory is dropped
+        assert level.shape == (10,)
+        assert np.all(np.isfinite(level))
+
+    def test_run_appends_to_existing_trajectory(self, default_config):
+        """Verify out= reuses a preallocated buffer across calls."""
+        sim = tank_sim.Simulator(default_config)
+        traj = sim.make_trajectory(50)
+
+        result = sim.run(20, out=traj)
+        assert result is traj
+        sim.run(30, out=traj)
+
+        assert traj.size == 50
+        assert traj.capacity == 50
+        assert traj.time[-1] == pytest.approx(sim.get_time())
+
+        with pytest.raises(ValueError):
+            sim.run(1, out=traj)
+
+        traj.clear()
+        assert len(traj) == 0
+        sim.run(5, out=traj)
+        assert len(traj) == 5
+
+    def test_run_until(self, default_config):
+        """Verify run_until stops at the requested simulation time."""
+        sim = tank_sim.Simulator(default_config)
+        traj = sim.run_until(30.0)
+
+        assert sim.get_time() == pytest.approx(30.0)
+        assert len(traj) == 30
+
+    def test_run_rejects_negative_steps(self, default_config):
+        """Verify a negative step count is reported as ValueError."""
+        sim = tank_sim.Simulator(default_config)
+        with pytest.raises(ValueError):
+            sim.run(-1)
+
+    def test_run_into_float_trajectory(self, default_config):
+        """Verify a FloatTrajectory records float32 signals and float64 time."""
+        reference = tank_sim.Simulator(default_config)
+        sim = tank_sim.Simulator(default_config)
+        traj = sim.make_float_trajectory(40)
+
+        assert sim.run(20, out=traj) is traj
+        sim.run_until(40.0, out=traj)
+        expected = reference.run(40)
+
+        assert len(traj) == 40
+        assert traj.level.dtype == np.float32
+        assert traj.time.dtype == np.float64
+        np.testing.assert_array_equal(traj.level, expected.level.astype(np.float32))
+        np.testing.assert_array_equal(traj.time, expected.time)
+
+
+class TestSnapshot:
+    """Tests for single-call telemetry snapshots."""
+
+    def test_snapshot_matches_getters(self, steady_state_simulator):
+        """Verify snapshot() agrees with the individual getters."""
+        sim = steady_state_simulator
+        sim.set_setpoint(0, 3.0)
+        sim.run(10)
+
+        snap = sim.snapshot()
+        inputs = sim.get_inputs()
+
+        assert snap["time"] == sim.get_time()
+        assert snap["tank_level"] == sim.get_state()[0]
+        assert snap["setpoint"] == sim.get_setpoint(0)
+        assert snap["inlet_flow"] == inputs[0]
+        assert snap["valve_position"] == inputs[1]
+        assert snap["error"] == sim.get_error(0)
+        assert snap["controller_output"] == sim.get_controller_output(0)
+        assert snap["outlet_flow"] == pytest.approx(sim.get_outlet_flow())
+
+    def test_snapshot_invalid_index(self, steady_state_simulator):
+        """Verify snapshot() bounds-checks the controller index."""
+        with pytest.raises(IndexError):
+            steady_state_simulator.snapshot(5)
+
+
+class TestHistoryBuffer:
+    """Tests for the simulator's per-step history ring buffer."""
+
+    def test_history_disabled_by_default(self, default_config):
+        """Verify no history is recorded unless a capacity is configured."""
+        assert tank_sim.Simulator(default_config).history is None
+
+    def test_window_matches_snapshots(self, default_config):
+        """Verify window() returns the samples snapshot() saw after each step."""
+        default_config.history_capacity = 100
+        sim = tank_sim.Simulator(default_config)
+        sim.set_setpoint(0, 3.0)
+        snaps = []
+        for _ in range(20):
+            sim.step()
+            snaps.append(sim.snapshot())
+
+        window = sim.history.window(5.0, 9.0)
+        assert list(window) == list(snaps[0])
+        np.testing.assert_array_equal(window["time"], [5.0, 6.0, 7.0, 8.0, 9.0])
+        np.testing.assert_array_equal(
+            window["tank_level"], [s["tank_level"] for s in snaps[4:9]]
+        )
+
+    def test_views_are_zero_copy_and_read_only(self, default_config):
+        """Verify default windows alias the ring; copy=True detaches."""
+        default_config.history_capacity = 8
+        sim = tank_sim.Simulator(default_config)
+        sim.run(20)  # wraps the ring
+
+        view = sim.history.latest(8)
+        assert not view["time"].flags.writeable
+        assert not view["time"].flags.owndata
+        np.testing.assert_array_equal(view["time"], np.arange(13.0, 21.0))
+
+        copy = sim.history.latest(8, copy=True)
+        sim.run(8)
+        np.testing.assert_array_equal(copy["time"], np.arange(13.0, 21.0))
+        # The view now shows whatever the writer put in those slots
+        assert not np.array_equal(view["time"], copy["time"])
+
+    def test_reset_clears_history(self, default_config):
+        """Verify reset() empties the buffer."""
+        default_config.history_capacity = 10
+        sim = tank_sim.Simulator(default_config)
+        sim.run(5)
+        assert len(sim.history) == 5
+        sim.reset()
+        assert len(sim.history) == 0
+        assert sim.history.total == 0
+
+
+class TestHistoryPyramid:
+    """Tests for the downsampled min/max/mean history."""
+
+    def test_buckets_match_raw_history(self, default_config):
+        """Verify bucket statistics equal those computed from raw samples."""
+        default_config.history_capacity = 100
+        default_config.history_levels = [(5, 50), (20, 50)]
+        sim = tank_sim.Simulator(default_config)
+        sim.set_setpoint(0, 3.0)
+        sim.run(100)
+
+        raw = sim.history.latest(100)["tank_level"].reshape(-1, 20)
+        buckets = sim.history_pyramid.query(1, 0.0, 1e9)
+        np.testing.assert_array_equal(buckets["count"], [20] * 5)
+        np.testing.assert_array_equal(buckets["tank_level"]["min"], raw.min(axis=1))
+        np.testing.assert_array_equal(buckets["tank_level"]["max"], raw.max(axis=1))
+        np.testing.assert_allclose(buckets["tank_level"]["mean"], raw.mean(axis=1))
+        np.testing.assert_array_equal(buckets["tank_level"]["last"], raw[:, -1])
+
+    def test_select_respects_point_budget(self, default_config):
+        """Verify select() picks a coarser level when the budget is small."""
+        default_config.history_levels = [(1, 1000), (10, 100)]
+        sim = tank_sim.Simulator(default_config)
+        sim.run(500)
+        assert sim.history_pyramid.levels == [(1, 1000), (10, 100)]
+        assert sim.history_pyramid.select(0.0, 500.0, 1000) == 0
+        assert sim.history_pyramid.select(0.0, 500.0, 100) == 1
+        with pytest.raises(IndexError):
+            sim.history_pyramid.query(2, 0.0, 1.0)
+
+    def test_invalid_levels_raise(self, default_config):
+        """Verify factors must nest."""
+        default_config.history_levels = [(4, 10), (6, 10)]
+        with pytest.raises(ValueError):
+            tank_sim.Simulator(default_config)
+
+
+class TestTrajectoryLog:
+    """Tests for the on-disk trajectory log."""
+
+    def test_round_trip_is_zero_copy(self, default_config, tmp_path):
+        """Verify logged runs read back exactly through read-only views."""
+        sim = tank_sim.Simulator(default_config)
+        sim.set_setpoint(0, 3.0)
+        path = str(tmp_path / "run.tslog")
+        chunks = []
+        with tank_sim.TrajectoryLogWriter(path, sim, batch_size=50) as writer:
+            for _ in range(4):
+                traj = sim.run(120)
+                writer.append(traj)
+                chunks.append(traj.state[0].copy())
+            assert len(writer) == 480
+
+        log = tank_sim.TrajectoryLog(path)
+        assert len(log) == 480
+        level = log.state(0)
+        assert not level.flags.writeable
+        assert not level.flags.owndata
+        np.testing.assert_array_equal(level, np.concatenate(chunks))
+        assert log.time[-1] == sim.get_time()
+        with pytest.raises(IndexError):
+            log.state(1)
+
+    def test_window_and_read(self, default_config, tmp_path):
+        """Verify window() slices by time and read() copies a Trajectory."""
+        sim = tank_sim.Simulator(default_config)
+        path = str(tmp_path / "run.tslog")
+        with tank_sim.TrajectoryLogWriter(path, sim) as writer:
+            writer.append(sim.run(3000))
+
+        log = tank_sim.TrajectoryLog(path)
+        window = log.window(100.0, 199.5)
+        np.testing.assert_array_equal(log.time[window], np.arange(100.0, 200.0))
+        traj = log.read(window.start, window.stop - window.start)
+        assert len(traj) == 100
+        np.testing.assert_array_equal(traj.level, log.state(0)[window])
+
+    def test_resume_rejects_time_going_backwards(self, default_config, tmp_path):
+        """Verify a reset simulator cannot append to the same log."""
+        sim = tank_sim.Simulator(default_config)
+        path = str(tmp_path / "run.tslog")
+        with tank_sim.TrajectoryLogWriter(path, sim) as writer:
+            writer.append(sim.run(10))
+        sim.reset()
+        with tank_sim.TrajectoryLogWriter(path, sim) as writer:
+            assert writer.committed == 10
+            with pytest.raises(ValueError):
+                writer.append(sim.run(10))
+
+
+class TestBatchSimulator:
+    """Tests for the vectorized multi-tank simulator."""
+
+    def test_lanes_match_simulator(self, default_config):
+        """Verify each lane reproduces the scalar Simulator."""
+        batch = tank_sim.BatchSimulator(default_config, 16)
+        sim = tank_sim.Simulator(default_config)
+
+        setpoints = np.linspace(2.0, 3.5, 16)
+        batch.set_setpoints(setpoints)
+        batch.run(200)
+
+        sim.set_setpoint(0, setpoints[5])
+        sim.run(200)
+
+        levels = batch.get_levels()
+        assert levels.shape == (16,)
+        assert levels[5] == pytest.approx(sim.get_state()[0], abs=1e-12)
+        assert batch.get_time() == pytest.approx(sim.get_time())
+
+    def test_bulk_inputs_and_validation(self, default_config):
+        """Verify per-lane input arrays are applied and checked."""
+        batch = tank_sim.BatchSimulator(default_config, 4)
+        batch.set_input(0, np.array([0.5, 1.0, 1.5, 2.0]))
+        np.testing.assert_array_equal(batch.get_inputs(0), [0.5, 1.0, 1.5, 2.0])
+
+        with pytest.raises(ValueError):
+            batch.set_input(0, np.ones(3))
+        with pytest.raises(IndexError):
+            batch.set_setpoint(4, 1.0)
+
+    def test_non_rk4_integrator_raises(self, default_config):
+        """Verify lanes refuse integrators they would not honour."""
+        default_config.integrator = tank_sim.Integrator.EXACT_ZOH
+        with pytest.raises(ValueError):
+            tank_sim.BatchSimulator(default_config, 2)
+
+    def test_float_lanes_and_precision_report(self, default_config):
+        """Verify float32 lanes track the float64 baseline to under 1 mm."""
+        batch = tank_sim.FloatBatchSimulator(default_config, 8)
+        batch.set_setpoints(np.linspace(2.0, 3.5, 8))
+        batch.run(600)
+        assert batch.get_levels().dtype == np.float32
+
+        mixed = tank_sim.MixedBatchSimulator(default_config, 8)
+        mixed.run(10)
+        assert mixed.get_levels().dtype == np.float32
+        assert mixed.get_integral_states().dtype == np.float64
+
+        report = tank_sim.measure_precision(default_config, 8, 600)
+        assert report.lanes == 8
+        assert report.steps == 600
+        assert report.max_level_error < 1e-3
+        assert tank_sim.measure_precision(
+            [default_config, default_config], 600, mixed=True
+        ).max_level_error < 1e-3
+
+        with pytest.raises(ValueError):
+            tank_sim.measure_precision(default_config, 8, -1)
+
+
+class TestDisturbances:
+    """Tests for native input disturbances."""
+
+    def test_brownian_is_reproducible_and_bounded(self, default_config):
+        """Verify the same seed and stream replay the same inlet sequence."""
+        default_config.disturbances = [
+            tank_sim.Disturbance.brownian(0, sigma=0.05, min_value=0.9, max_value=1.1)
+        ]
+        default_config.disturbance_seed = 5
+        a = tank_sim.Simulator(default_config)
+        b = tank_sim.Simulator(default_config)
+        flows_a = a.run(200).inputs[0].copy()
+        flows_b = b.run(200).inputs[0]
+        np.testing.assert_array_equal(flows_a, flows_b)
+        assert flows_a.min() >= 0.9 and flows_a.max() <= 1.1
+        assert len(np.unique(flows_a)) > 1
+        assert a.get_step_count() == 200
+
+    def test_set_disturbances(self, default_config):
+        """Verify disturbances can be swapped at runtime and are validated."""
+        sim = tank_sim.Simulator(default_config)
+        sim.set_disturbances([tank_sim.Disturbance.step(0, start_time=0.0, magnitude=0.2)])
+        assert sim.get_disturbances()[0].kind == tank_sim.Disturbance.Kind.STEP
+        sim.step()
+        assert sim.get_inputs()[0] == pytest.approx(1.2)
+        with pytest.raises(ValueError):
+            sim.set_disturbances([tank_sim.Disturbance.brownian(1, sigma=0.1)])
+
+    def test_batch_lanes_use_separate_streams(self, default_config):
+        """Verify identical lanes diverge but each matches its Simulator."""
+        default_config.disturbances = [
+            tank_sim.Disturbance.ornstein_uhlenbeck(0, mean=1.0, theta=0.01, sigma=0.01)
+        ]
+        batch = tank_sim.BatchSimulator(default_config, 4)
+        batch.run(100)
+        flows = batch.get_inputs(0)
+        assert len(np.unique(flows)) == 4
+
+        default_config.disturbance_stream = 2
+        sim = tank_sim.Simulator(default_config)
+        sim.run(100)
+        assert flows[2] == pytest.approx(sim.get_inputs()[0], abs=1e-12)
+
+
+class TestMetrics:
+    """Tests for the hot-path instrumentation counters."""
+
+    def test_metrics_track_steps(self, default_config):
+        """Verify get_metrics() counts steps and fills the latency histogram."""
+        sim = tank_sim.Simulator(default_config)
+        sim.run(25)
+        metrics = sim.get_metrics()
+        if not metrics["enabled"]:
+            pytest.skip("core built with TANK_SIM_ENABLE_METRICS=OFF")
+
+        assert metrics["steps"] == 25
+        assert metrics["derivative_evaluations"] == (
+            sim.get_integration_stats()["derivative_evaluations"]
+        )
+        assert set(metrics["phase_seconds"]) == {"integration", "control", "recording"}
+        assert sum(metrics["latency_counts"]) == 25
+        assert len(metrics["latency_upper_bounds"]) == len(metrics["latency_counts"])
+
+    def test_clear_metrics(self, default_config):
+        """Verify metrics survive reset() but not clear_metrics()."""
+        sim = tank_sim.Simulator(default_config)
+        sim.run(5)
+        sim.reset()
+        assert sim.get_metrics()["steps"] in (0, 5)
+        sim.clear_metrics()
+        assert sim.get_metrics()["steps"] == 0
+
+
+class TestSaveRestoreFork:
+    """Tests for snapshot save/restore and what-if forking."""
+
+    def test_restore_replays_exactly(self, default_config):
+        """Verify stepping after restore() reproduces the original run."""
+        sim = tank_sim.Simulator(default_config)
+        sim.set_setpoint(0, 3.0)
+        sim.run(20)
+        saved = sim.save()
+        first = sim.run(50).state[0].copy()
+
+        sim.set_setpoint(0, 1.0)
+        sim.run(10)
+        sim.restore(saved)
+        assert sim.get_time() == saved.time
+        np.testing.assert_array_equal(sim.run(50).state[0], first)
+
+    def test_snapshot_pickles(self, default_config):
+        """Verify a snapshot survives a pickle round trip."""
+        import pickle
+
+        sim = tank_sim.Simulator(default_config)
+        sim.run(5)
+        saved = pickle.loads(pickle.dumps(sim.save()))
+        assert saved.controller_count == 1
+        assert saved.state == pytest.approx(list(sim.get_state()))
+
+    def test_fork_is_independent(self, default_config):
+        """Verify a fork starts at the live state and evolves on its own."""
+        sim = tank_sim.Simulator(default_config)
+        sim.run(10)
+        branch = sim.fork()
+        branch.set_setpoint(0, 4.0)
+        branch.run(50)
+        sim.run(50)
+        assert sim.get_setpoint(0) != 4.0
+        assert branch.get_state()[0] > sim.get_state()[0]
+
+    def test_fork_batch(self, default_config):
+        """Verify fork_batch() starts every lane from the live state."""
+        sim = tank_sim.Simulator(default_config)
+        sim.set_setpoint(0, 3.0)
+        sim.run(30)
+        batch = sim.fork_batch(default_config, 8)
+        assert batch.get_time() == pytest.approx(sim.get_time())
+        np.testing.assert_allclose(batch.get_levels(), sim.get_state()[0])
+
+        batch.run(100)
+        sim.run(100)
+        assert batch.get_levels()[0] == pytest.approx(sim.get_state()[0], abs=1e-12)
+
+    def test_restore_rejects_mismatched_snapshot(self, default_config):
+        """Verify a snapshot cannot be restored into a different loop layout."""
+        saved = tank_sim.Simulator(default_config).save()
+        default_config.controllers = []
+        with pytest.raises(ValueError):
+            tank_sim.Simulator(default_config).restore(saved)
+
+
+class TestPlantNetwork:
+    """Tests for multi-tank plant networks and NetworkSimulator."""
+
+    def test_cascade_conserves_mass(self, default_config):
+        """Verify a cascade's accumulation equals inflow minus drain flow."""
+        topology = tank_sim.PlantNetwork.cascade(10, default_config.model_params)
+        network = tank_sim.PlantNetwork(topology)
+        assert network.state_size == 10
+        assert network.input_size == 11
+
+        levels = np.linspace(1.0, 4.0, 10)
+        inputs = np.full(11, 0.6)
+        dhdt = network.derivatives(levels, inputs)
+        flows = network.valve_flows(levels, inputs)
+        area = default_config.model_params.area
+        assert (dhdt * area).sum() == pytest.approx(inputs[0] - flows[-1], abs=1e-12)
+
+        with pytest.raises(ValueError):
+            network.derivatives(levels[:5], inputs)
+
+    def test_custom_topology_validation(self):
+        """Verify topologies are built from Python and checked."""
+        Net = tank_sim.PlantNetwork
+        topology = Net.Topology()
+        topology.tanks = [Net.Tank(100.0, 5.0), Net.Tank(50.0, 5.0)]
+        topology.valves = [Net.Valve(0, 1, 2.0, law=Net.FlowLaw.HEAD_DIFFERENCE)]
+        network = Net(topology)
+        flows = network.valve_flows(np.array([2.0, 3.0]), np.zeros(0))
+        assert flows[0] == pytest.approx(-2.0)
+
+        topology.valves = [Net.Valve(0, Net.DRAIN, 2.0, law=Net.FlowLaw.HEAD_DIFFERENCE)]
+        with pytest.raises(ValueError):
+            Net(topology)
+
+    def test_single_tank_network_matches_simulator(self, default_config):
+        """Verify a one-tank NetworkSimulator reproduces Simulator."""
+        config = tank_sim.NetworkSimulatorConfig()
+        config.network = tank_sim.PlantNetwork.single_tank(default_config.model_params)
+        config.controllers = default_config.controllers
+        config.initial_state = default_config.initial_state
+        config.initial_inputs = default_config.initial_inputs
+        config.dt = default_config.dt
+
+        network_sim = tank_sim.NetworkSimulator(config)
+        sim = tank_sim.Simulator(default_config)
+        network_sim.set_setpoint(0, 3.0)
+        sim.set_setpoint(0, 3.0)
+        traj = network_sim.run(300)
+        sim.run(300)
+
+        assert len(traj) == 300
+        assert network_sim.get_state()[0] == pytest.approx(sim.get_state()[0], abs=1e-12)
+        assert network_sim.get_valve_flows()[0] == pytest.approx(sim.get_outlet_flow(), abs=1e-12)
+        with pytest.raises(IndexError):
+            network_sim.get_setpoint(1)
+
+
+class TestParameterSweep:
+    """Tests for the multithreaded tuning sweep."""
+
+    def _options(self, threads=0):
+        options = tank_sim.SweepOptions()
+        options.steps = 300
+        options.setpoint = 3.0
+        options.threads = threads
+        return options
+
+    def test_run_grid_returns_columns(self, default_config):
+        """Verify grid sweeps return one metric entry per case."""
+        sweep = tank_sim.ParameterSweep(default_config, self._options())
+        results = sweep.run_grid([-0.5, -1.0, -2.0], [5.0, 10.0], [0.0, 1.0])
+
+        assert results["iae"].shape == (12,)
+        np.testing.assert_array_equal(results["Kc"][:4], -0.5)
+        assert np.all(results["iae"] > 0.0)
+        assert np.all(results["valve_travel"] >= 0.0)
+
+    def test_thread_count_does_not_change_results(self, default_config):
+        """Verify parallel sweeps are deterministic."""
+        grid = tank_sim.ParameterSweep.make_grid([-1.0, -3.0], [0.0, 8.0], [0.0])
+        serial = tank_sim.ParameterSweep(default_config, self._options(1)).run(grid)
+        parallel = tank_sim.ParameterSweep(default_config, self._options(4)).run(grid)
+
+        for key in ("iae", "ise", "overshoot", "settling_time", "valve_travel"):
+            np.testing.assert_array_equal(serial[key], parallel[key])
+
+    def test_invalid_options_raise(self, default_config):
+        """Verify a non-positive horizon is rejected."""
+        options = self._options()
+        options.steps = 0
+        with pytest.raises(ValueError):
+            tank_sim.ParameterSweep(default_config, options)
+
+
+class TestGainTuner:
+    """Tests for the dual-number gain tuner."""
+
+    def _options(self):
+        options = tank_sim.TunerOptions()
+        options.steps = 300
+        options.setpoint = 3.0
+        return options
+
+    def test_evaluate_matches_sweep_iae(self, default_config):
+        """Verify the tuner scores a case exactly as ParameterSweep does."""
+        gains = tank_sim.PIDGains()
+        gains.Kc = -1.0
+        gains.tau_I = 50.0
+        gains.tau_D = 2.0
+        iae, gradient = tank_sim.GainTuner(default_config, self._options()).evaluate(gains)
+
+        sweep_options = tank_sim.SweepOptions()
+        sweep_options.steps = 300
+        sweep_options.setpoint = 3.0
+        sweep = tank_sim.ParameterSweep(default_config, sweep_options).run([gains])
+        assert iae == pytest.approx(sweep["iae"][0], rel=1e-12)
+        assert gradient.shape == (3,)
+        assert np.all(np.isfinite(gradient))
+
+    def test_tune_lowers_iae_inside_box(self, default_config):
+        """Verify tune() improves on its start and respects the bounds."""
+        tuner = tank_sim.GainTuner(default_config, self._options())
+        start = tank_sim.PIDGains()
+        start.Kc = -0.2
+        start.tau_I = 200.0
+        start.tau_D = 0.0
+        result = tuner.tune(start)
+
+        assert result.iae < tuner.evaluate(start)[0]
+        assert result.evaluations >= result.iterations + 1
+        assert -10.0 <= result.gains.Kc <= 10.0
+        assert 1.0 <= result.gains.tau_I <= 1000.0
+
+    def test_invalid_integrator_raises(self, default_config):
+        """Verify integrators without a dual path are rejected."""
+        default_config.integrator = tank_sim.Integrator.ROSENBROCK
+        with pytest.raises(ValueError):
+            tank_sim.GainTuner(default_config, self._options())
+
+
+class TestScenarioReplay:
+    """Tests for scenario files and parallel golden replays."""
+
+    SCENARIO = """
+    tank_sim-scenario 1
+    duration 300
+    120 input    0 1.3   # inlet upset
+    10  setpoint 0 3.0
+    200 gains    0 -2.0 5.0 0.5
+    """
+
+    def test_parse_round_trip(self):
+        """Verify the text form parses and round-trips."""
+        scenario = tank_sim.Scenario.parse(self.SCENARIO, "upset")
+        assert scenario.name == "upset"
+        assert scenario.duration == 300.0
+        assert [e.kind for e in scenario.events] == [
+            tank_sim.Scenario.Event.Kind.INPUT,
+            tank_sim.Scenario.Event.Kind.SETPOINT,
+            tank_sim.Scenario.Event.Kind.GAINS,
+        ]
+        assert scenario.events[2].gains.tau_D == 0.5
+
+        again = tank_sim.Scenario.parse(scenario.to_string())
+        assert again.to_string() == scenario.to_string()
+
+        with pytest.raises(ValueError):
+            tank_sim.Scenario.parse("tank_sim-scenario 1\nduration 10\n1 valve 0 1\n")
+
+    def test_replay_applies_events(self, default_config):
+        """Verify events land on their steps."""
+        replay = tank_sim.ScenarioReplay(default_config, tank_sim.ReplayOptions())
+        trajectory = replay.replay(tank_sim.Scenario.parse(self.SCENARIO))
+
+        assert len(trajectory) == 300
+        assert trajectory.setpoint[0, 9] == pytest.approx(2.5)
+        assert trajectory.setpoint[0, 10] == 3.0
+        assert trajectory.inputs[0, 120] == 1.3
+
+    def test_verify_is_deterministic_and_finds_drift(self, default_config):
+        """Verify parallel replays match their goldens and drift is reported."""
+        base = tank_sim.Scenario.parse(self.SCENARIO)
+        scenarios = []
+        for i in range(8):
+            scenario = tank_sim.Scenario.parse(self.SCENARIO)
+            events = scenario.events
+            events[0].value = 1.0 + 0.05 * i
+            scenario.events = events
+            scenarios.append(scenario)
+
+        serial_options = tank_sim.ReplayOptions()
+        serial_options.threads = 1
+        goldens = tank_sim.ScenarioReplay(default_config, serial_options).replay_all(scenarios)
+
+        parallel_options = tank_sim.ReplayOptions()
+        parallel_options.threads = 4
+        replay = tank_sim.ScenarioReplay(default_config, parallel_options)
+        results = replay.verify(scenarios, goldens)
+        assert all(r.passed for r in results)
+        assert all(r.max_error == 0.0 for r in results)
+
+        drifted = replay.verify([base], [goldens[0]])[0]
+        assert not drifted.passed
+        assert drifted.first_failure == 120
+        assert drifted.signal == "state_0"
+
+
+class TestForecaster:
+    """Tests for batched candidate forecasts."""
+
+    def test_forecast_matches_forks(self, default_config):
+        """Verify each candidate's levels follow a forked simulator."""
+        sim = tank_sim.Simulator(default_config)
+        sim.run(30)
+        forecaster = tank_sim.Forecaster(default_config, tank_sim.ForecastOptions(120, 10))
+        setpoints = np.linspace(2.0, 3.5, 8)
+        forecast = forecaster.run(sim, setpoints=setpoints)
+
+        assert forecast["levels"].shape == (forecaster.sample_count, 8)
+        np.testing.assert_array_equal(forecast["lower"], forecast["levels"].min(axis=1))
+        np.testing.assert_array_equal(forecast["upper"], forecast["levels"].max(axis=1))
+        assert sim.get_time() == pytest.approx(30 * default_config.dt)
+
+        branch = sim.fork()
+        branch.set_setpoint(0, setpoints[5])
+        branch.run(120)
+        assert forecast["levels"][-1, 5] == pytest.approx(branch.get_state()[0], abs=1e-9)
+
+    def test_forecast_from_exact_zoh_config(self, default_config):
+        """Verify a non-RK4 config is forecast with RK4 lanes, not rejected."""
+        default_config.integrator = tank_sim.Integrator.EXACT_ZOH
+        sim = tank_sim.Simulator(default_config)
+        sim.run(30)
+        forecaster = tank_sim.Forecaster(default_config, tank_sim.ForecastOptions(120, 10))
+        forecast = forecaster.run(sim, setpoints=np.array([2.0, 3.5]))
+
+        branch = sim.fork()
+        branch.set_setpoint(0, 3.5)
+        branch.run(120)
+        assert forecast["levels"][-1, 1] == pytest.approx(branch.get_state()[0], abs=1e-3)
+
+    def test_forecast_validation(self, default_config):
+        """Verify schedules must be given and agree on candidate count."""
+        sim = tank_sim.Simulator(default_config)
+        forecaster = tank_sim.Forecaster(default_config, tank_sim.ForecastOptions(10))
+        with pytest.raises(ValueError):
+            forecaster.run(sim)
+        with pytest.raises(ValueError):
+            forecaster.run(sim, setpoints=np.ones(3), inlet_flows=np.ones(4))
+        with pytest.raises(ValueError):
+            tank_sim.Forecaster(default_config, tank_sim.ForecastOptions(0))
+
+
+class TestSessionPool:
+    """Tests for the multi-session worker pool."""
+
+    def test_advance_matches_standalone_simulators(self, default_config):
+        """Verify pooled sessions step exactly like standalone simulators."""
+        pool = tank_sim.SessionPool(threads=3)
+        pooled = [tank_sim.Simulator(default_config) for _ in range(10)]
+        alone = [tank_sim.Simulator(default_config) for _ in range(10)]
+        ids = [pool.add(sim) for sim in pooled]
+        for k, sim in enumerate(pooled + alone):
+            sim.set_setpoint(0, 2.0 + 0.1 * (k % 10))
+
+        assert len(pool) == 10
+        assert pool.advance([(session, 20 + k) for k, session in enumerate(ids)]) == []
+        for k, (a, b) in enumerate(zip(pooled, alone)):
+            b.run(20 + k)
+            assert a.get_time() == b.get_time()
+            np.testing.assert_array_equal(a.get_state(), b.get_state())
+
+    def test_remove_and_errors(self, default_config):
+        """Verify unknown sessions and negative step counts are rejected."""
+        pool = tank_sim.SessionPool(threads=2)
+        session = pool.add(tank_sim.Simulator(default_config))
+        assert session in pool
+        assert pool.shard(session) == 0
+
+        with pytest.raises(ValueError):
+            pool.advance([(session, -1)])
+        pool.remove(session)
+        assert session not in pool
+        with pytest.raises(IndexError):
+            pool.advance([(session, 1)])
+        with pytest.raises(IndexError):
+            pool.remove(session)
+
+
+class TestCommandQueue:
+    """Tests for queued operator commands."""
+
+    def test_commands_apply_at_next_step(self, default_config):
+        """Verify posted commands wait for the next step, then match the setters."""
+        default_config.command_queue_capacity = 16
+        posted = tank_sim.Simulator(default_config)
+        default_config.command_queue_capacity = 0
+        direct = tank_sim.Simulator(default_config)
+
+        gains = tank_sim.PIDGains()
+        gains.Kc, gains.tau_I, gains.tau_D = -2.0, 5.0, 0.0
+        commands = [
+            tank_sim.Command.setpoint(0, 3.0),
+            tank_sim.Command.input(0, 1.2),
+            tank_sim.Command.retune(0, gains),
+        ]
+        assert commands[0].kind == tank_sim.Command.Kind.SETPOINT
+        assert posted.post_commands(commands) == 3
+        assert posted.get_setpoint(0) == 2.5
+
+        direct.set_setpoint(0, 3.0)
+        direct.set_input(0, 1.2)
+        direct.set_controller_gains(0, gains)
+        posted.run(30)
+        direct.run(30)
+        np.testing.assert_array_equal(posted.get_state(), direct.get_state())
+        assert posted.get_command_stats() == {"capacity": 16, "pushed": 3, "dropped": 0}
+
+    def test_validation(self, default_config):
+        """Verify bad indices raise and a queue is required."""
+        with pytest.raises(RuntimeError):
+            tank_sim.Simulator(default_config).post_commands([tank_sim.Command.input(0, 1.0)])
+
+        default_config.command_queue_capacity = 2
+        sim = tank_sim.Simulator(default_config)
+        with pytest.raises(IndexError):
+            sim.post_commands([tank_sim.Command.setpoint(0, 3.0), tank_sim.Command.setpoint(5, 3.0)])
+        assert sim.post_commands([tank_sim.Command.input(0, 1.0)] * 3) == 2
+        assert sim.get_command_stats()["dropped"] == 1
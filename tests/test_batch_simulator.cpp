@@ -0,0 +1,431 @@
+#include <gtest/gtest.h>
+#include <Eigen/Dense>
+#include <cmath>
+#include <type_traits>
+#include <vector>
+#include "../src/batch_simulator.h"
+#include "../src/simulator.h"
+#include "../src/constants.h"
+
+using namespace tank_sim;
+using namespace tank_sim::constants;
+
+// Lanes must reproduce the scalar Simulator; only FMA contraction may differ,
+// or fastSqrt() in the lanes when built with TANK_SIM_FAST_VALVE
+constexpr double LANE_TOLERANCE = TANK_SIM_FAST_VALVE ? 1e-9 : 1e-12;
+
+class BatchSimulatorTest : public ::testing::Test {
+protected:
+    // Same steady-state loop as SimulatorTest (reverse-acting, Kc < 0)
+    Simulator::Config createSteadyStateConfig(double setpoint = TANK_NOMINAL_HEIGHT) {
+        Simulator::Config config;
+        config.params = TankModel::Parameters{
+            DEFAULT_TANK_AREA,
+            DEFAULT_VALVE_COEFFICIENT,
+            TANK_MAX_HEIGHT
+        };
+
+        config.initialState = Eigen::VectorXd(1);
+        config.initialState << TANK_NOMINAL_HEIGHT;
+
+        config.initialInputs = Eigen::VectorXd(2);
+        config.initialInputs << TEST_INLET_FLOW, TEST_VALVE_POSITION;
+
+        config.dt = TEST_DT;
+
+        Simulator::ControllerConfig ctrl_config;
+        ctrl_config.gains = PIDController::Gains{-1.0, 10.0, 0.0};
+        ctrl_config.bias = 0.5;
+        ctrl_config.minOutputLimit = 0.0;
+        ctrl_config.maxOutputLimit = 1.0;
+        ctrl_config.maxIntegralAccumulation = 10.0;
+        ctrl_config.measuredIndex = 0;
+        ctrl_config.outputIndex = 1;
+        ctrl_config.initialSetpoint = setpoint;
+        config.controllerConfig.push_back(ctrl_config);
+
+        return config;
+    }
+
+    // A spread of lanes: different tanks, tunings, setpoints and start levels.
+    // Lane 3 saturates the valve so anti-windup is exercised.
+    std::vector<Simulator::Config> createVariedConfigs() {
+        std::vector<Simulator::Config> configs;
+
+        configs.push_back(createSteadyStateConfig(3.0));
+
+        Simulator::Config small_tank = createSteadyStateConfig(2.0);
+        small_tank.params.area = 40.0;
+        small_tank.initialState << 1.0;
+        configs.push_back(small_tank);
+
+        Simulator::Config derivative = createSteadyStateConfig(3.5);
+        derivative.controllerConfig[0].gains = PIDController::Gains{-2.0, 5.0, 1.5};
+        derivative.params.k_v = 0.9;
+        configs.push_back(derivative);
+
+        Simulator::Config saturating = createSteadyStateConfig(4.9);
+        saturating.controllerConfig[0].gains = PIDController::Gains{-20.0, 0.0, 0.0};
+        saturating.initialInputs << 0.5, 0.5;
+        configs.push_back(saturating);
+
+        return configs;
+    }
+
+    static void expectLaneMatches(const BatchSimulator& batch, int lane,
+                                  const Simulator& sim) {
+        EXPECT_NEAR(batch.getLevels()(lane), sim.getState()(0), LANE_TOLERANCE)
+            << "lane " << lane;
+        EXPECT_NEAR(batch.getInputs(1)(lane), sim.getInputs()(1), LANE_TOLERANCE)
+            << "lane " << lane;
+        if (batch.hasController()) {
+            EXPECT_NEAR(batch.getErrors()(lane), sim.getError(0), LANE_TOLERANCE)
+                << "lane " << lane;
+        }
+        EXPECT_NEAR(batch.getOutletFlows()(lane), sim.getOutletFlow(), LANE_TOLERANCE)
+            << "lane " << lane;
+    }
+};
+
+// Test: Every lane reproduces the scalar Simulator built from the same config
+TEST_F(BatchSimulatorTest, LanesMatchIndividualSimulators) {
+    std::vector<Simulator::Config> configs = createVariedConfigs();
+    BatchSimulator batch(configs);
+
+    std::vector<Simulator> sims;
+    for (const auto& config : configs) {
+        sims.emplace_back(config);
+    }
+
+    for (int k = 0; k < 500; ++k) {
+        batch.step();
+        for (auto& sim : sims) {
+            sim.step();
+        }
+    }
+
+    ASSERT_EQ(batch.getLaneCount(), 4);
+    EXPECT_DOUBLE_EQ(batch.getTime(), sims[0].getTime());
+    for (int lane = 0; lane < batch.getLaneCount(); ++lane) {
+        expectLaneMatches(batch, lane, sims[static_cast<size_t>(lane)]);
+    }
+
+    // The saturating lane pinned the valve at its lower limit
+    EXPECT_DOUBLE_EQ(batch.getControllerOutputs()(3), 0.0);
+}
+
+// Test: Open-loop lanes integrate the plant only
+TEST_F(BatchSimulatorTest, OpenLoopMatchesSimulator) {
+    Simulator::Config config = createSteadyStateConfig();
+    config.controllerConfig.clear();
+    config.initialInputs << 0.2, 1.0;  // Draining
+
+    BatchSimulator batch(config, 8);
+    Simulator sim(config);
+    batch.run(200);
+    sim.run(200);
+
+    EXPECT_FALSE(batch.hasController());
+    for (int lane = 0; lane < batch.getLaneCount(); ++lane) {
+        expectLaneMatches(batch, lane, sim);
+    }
+    EXPECT_THROW(batch.getSetpoints(), std::out_of_range);
+    EXPECT_THROW(batch.setSetpoint(0, 1.0), std::out_of_range);
+}
+
+// Test: Per-step bulk disturbances and lane setters match scalar setters
+TEST_F(BatchSimulatorTest, LaneSettersMatchSimulatorSetters) {
+    const int lanes = 6;
+    Simulator::Config config = createSteadyStateConfig();
+    BatchSimulator batch(config, lanes);
+    std::vector<Simulator> sims;
+    for (int lane = 0; lane < lanes; ++lane) {
+        sims.emplace_back(config);
+    }
+
+    for (int lane = 0; lane < lanes; ++lane) {
+        PIDController::Gains gains{-0.5 - 0.25 * lane, 5.0 + lane, 0.1 * lane};
+        batch.setControllerGains(lane, gains);
+        sims[lane].setControllerGains(0, gains);
+        batch.setSetpoint(lane, 2.0 + 0.3 * lane);
+        sims[lane].setSetpoint(0, 2.0 + 0.3 * lane);
+    }
+
+    BatchSimulator::LaneArray inlet(lanes);
+    for (int k = 0; k < 300; ++k) {
+        for (int lane = 0; lane < lanes; ++lane) {
+            inlet(lane) = 1.0 + 0.2 * std::sin(0.05 * k + lane);
+            sims[lane].setInput(INPUT_INDEX_INLET_FLOW, inlet(lane));
+            sims[lane].step();
+        }
+        batch.setInput(INPUT_INDEX_INLET_FLOW, inlet);
+        batch.step();
+    }
+
+    for (int lane = 0; lane < lanes; ++lane) {
+        expectLaneMatches(batch, lane, sims[lane]);
+        EXPECT_DOUBLE_EQ(batch.getSetpoints()(lane), sims[lane].getSetpoint(0));
+    }
+}
+
+// Test: Changing tank parameters per lane
+TEST_F(BatchSimulatorTest, SetParametersPerLane) {
+    Simulator::Config config = createSteadyStateConfig(3.0);
+    BatchSimulator batch(config, 2);
+
+    Simulator::Config wide = config;
+    wide.params.area = 300.0;
+    batch.setParameters(1, wide.params);
+
+    Simulator narrow_sim(config);
+    Simulator wide_sim(wide);
+    batch.run(100);
+    narrow_sim.run(100);
+    wide_sim.run(100);
+
+    expectLaneMatches(batch, 0, narrow_sim);
+    expectLaneMatches(batch, 1, wide_sim);
+    EXPECT_GT(batch.getLevels()(0), batch.getLevels()(1))
+        << "Smaller tank should fill faster";
+
+    EXPECT_THROW(batch.setParameters(0, TankModel::Parameters{-1.0, 1.0, 5.0}),
+                 std::invalid_argument);
+}
+
+// Test: Lanes with different valve characteristics match their Simulators,
+// including after a lane goes back to a linear valve
+TEST_F(BatchSimulatorTest, ValveCharacteristicsPerLane) {
+    Simulator::Config config = createSteadyStateConfig(3.0);
+    std::vector<Simulator::Config> configs(3, config);
+    configs[1].params.valve_characteristic = ValveCharacteristic::EQUAL_PERCENTAGE;
+    configs[2].params.valve_characteristic = ValveCharacteristic::QUICK_OPENING;
+    BatchSimulator batch(configs);
+
+    std::vector<Simulator> sims;
+    for (const auto& c : configs) {
+        sims.emplace_back(c);
+    }
+    batch.run(300);
+    for (auto& sim : sims) {
+        sim.run(300);
+    }
+    for (int lane = 0; lane < 3; ++lane) {
+        expectLaneMatches(batch, lane, sims[static_cast<size_t>(lane)]);
+    }
+    // Equal percentage needs more travel for the same flow
+    EXPECT_GT(batch.getControllerOutputs()(1), batch.getControllerOutputs()(0));
+    EXPECT_LT(batch.getControllerOutputs()(2), batch.getControllerOutputs()(0));
+
+    batch.setParameters(1, config.params);
+    batch.setParameters(2, config.params);
+    batch.reset();
+    batch.run(50);
+    Simulator linear(config);
+    linear.run(50);
+    for (int lane = 0; lane < 3; ++lane) {
+        expectLaneMatches(batch, lane, linear);
+    }
+}
+
+// Test: reset() reproduces the first run exactly
+TEST_F(BatchSimulatorTest, ResetIsReproducible) {
+    BatchSimulator batch(createVariedConfigs());
+    batch.run(100);
+    BatchSimulator::LaneArray first_run = batch.getLevels();
+
+    batch.reset();
+    EXPECT_DOUBLE_EQ(batch.getTime(), 0.0);
+    EXPECT_TRUE(batch.getIntegralStates().isZero());
+    batch.run(100);
+
+    EXPECT_TRUE((batch.getLevels() == first_run).all());
+}
+
+// Test: Construction and argument validation
+TEST_F(BatchSimulatorTest, Validation) {
+    Simulator::Config config = createSteadyStateConfig();
+
+    EXPECT_THROW(BatchSimulator(config, 0), std::invalid_argument);
+    EXPECT_THROW(BatchSimulator(std::vector<Simulator::Config>{}), std::invalid_argument);
+
+    std::vector<Simulator::Config> mixed_dt{config, config};
+    mixed_dt[1].dt = 0.5;
+    EXPECT_THROW(BatchSimulator{mixed_dt}, std::invalid_argument);
+
+    Simulator::Config two_controllers = config;
+    two_controllers.controllerConfig.push_back(config.controllerConfig[0]);
+    EXPECT_THROW(BatchSimulator(two_controllers, 2), std::invalid_argument);
+
+    std::vector<Simulator::Config> mixed_layout{config, config};
+    mixed_layout[1].controllerConfig.clear();
+    EXPECT_THROW(BatchSimulator{mixed_layout}, std::invalid_argument);
+
+    Simulator::Config bad_tau = config;
+    bad_tau.controllerConfig[0].gains.tau_I = -1.0;
+    EXPECT_THROW(BatchSimulator(bad_tau, 2), std::invalid_argument);
+
+    BatchSimulator batch(config, 3);
+    EXPECT_THROW(batch.setInput(3, 0, 1.0), std::out_of_range);
+    EXPECT_THROW(batch.setInput(0, 2, 1.0), std::out_of_range);
+    EXPECT_THROW(batch.setInput(0, BatchSimulator::LaneArray::Ones(2)), std::invalid_argument);
+    EXPECT_THROW(batch.getInputs(-1), std::out_of_range);
+    EXPECT_THROW(batch.run(-1), std::invalid_argument);
+}
+
+// Test: Only the RK4 integrators are accepted, since lanes always run RK4
+TEST_F(BatchSimulatorTest, RejectsNonRK4Integrators) {
+    Simulator::Config config = createSteadyStateConfig();
+
+    for (Simulator::Integrator integrator :
+         {Simulator::Integrator::AdaptiveRKF45, Simulator::Integrator::Rosenbrock,
+          Simulator::Integrator::ExactZOH}) {
+        Simulator::Config other = config;
+        other.integrator = integrator;
+        EXPECT_THROW(BatchSimulator(other, 2), std::invalid_argument);
+        EXPECT_THROW(FloatBatchSimulator(other, 2), std::invalid_argument);
+
+        // A single offending lane is enough
+        std::vector<Simulator::Config> mixed{config, other};
+        EXPECT_THROW(BatchSimulator{mixed}, std::invalid_argument);
+    }
+
+    Simulator::Config gsl = config;
+    gsl.integrator = Simulator::Integrator::GslRK4;
+    EXPECT_NO_THROW(BatchSimulator(gsl, 2));
+}
+
+// Test: restore() forks a live Simulator into every lane
+TEST_F(BatchSimulatorTest, RestoreForksSimulatorIntoLanes) {
+    Simulator::Config config = createSteadyStateConfig(3.0);
+    Simulator sim(config);
+    sim.run(30);
+    sim.setControllerGains(0, PIDController::Gains{-2.0, 5.0, 0.5});
+    sim.run(10);
+
+    BatchSimulator batch(config, 3);
+    batch.restore(sim.save());
+    EXPECT_DOUBLE_EQ(batch.getTime(), sim.getTime());
+    EXPECT_DOUBLE_EQ(batch.getIntegralStates()(2), sim.save().controllers[0].integralState);
+
+    // Lane 0 continues the live plant; lanes 1 and 2 explore what-ifs
+    batch.setSetpoint(1, 4.0);
+    batch.setInput(2, INPUT_INDEX_INLET_FLOW, 0.5);
+    for (int k = 0; k < 100; ++k) {
+        batch.step();
+        sim.step();
+    }
+    expectLaneMatches(batch, 0, sim);
+    EXPECT_GT(batch.getLevels()(1), sim.getState()(0));
+    EXPECT_GT(std::abs(batch.getLevels()(2) - sim.getState()(0)), 0.1);
+
+    config.controllerConfig.clear();
+    BatchSimulator open_loop(config, 2);
+    EXPECT_THROW(open_loop.restore(sim.save()), std::invalid_argument);
+}
+
+// Test: Lanes draw disturbances from their own streams and reproduce the
+// Simulator with the same stream
+TEST_F(BatchSimulatorTest, DisturbancesMatchSimulatorStreams) {
+    Simulator::Config config = createSteadyStateConfig(3.0);
+    config.disturbances = {
+        Disturbance::ornsteinUhlenbeck(INPUT_INDEX_INLET_FLOW, TEST_INLET_FLOW, 0.05,
+                                       0.002, 0.0, 2.0 * TEST_INLET_FLOW),
+        Disturbance::ramp(INPUT_INDEX_INLET_FLOW, 10.0, 20.0, 0.01),
+    };
+    config.disturbanceSeed = 7;
+    config.disturbanceStream = 100;
+
+    const int lanes = 5;
+    BatchSimulator batch(config, lanes);
+    ASSERT_EQ(batch.getDisturbanceStreams()(4), 104u);
+    batch.run(300);
+
+    for (int lane = 0; lane < lanes; ++lane) {
+        Simulator::Config laneConfig = config;
+        laneConfig.disturbanceStream = 100 + static_cast<std::uint32_t>(lane);
+        Simulator sim(laneConfig);
+        sim.run(300);
+        expectLaneMatches(batch, lane, sim);
+        EXPECT_NEAR(batch.getInputs(INPUT_INDEX_INLET_FLOW)(lane),
+                    sim.getInputs()(INPUT_INDEX_INLET_FLOW), LANE_TOLERANCE);
+    }
+    EXPECT_NE(batch.getLevels()(0), batch.getLevels()(1));
+    EXPECT_EQ(batch.getStepCount(), 300u);
+
+    // Lanes must agree on the disturbance list
+    std::vector<Simulator::Config> configs{config, config};
+    configs[1].disturbances.pop_back();
+    EXPECT_THROW(BatchSimulator mismatched(configs), std::invalid_argument);
+    configs[1] = config;
+    configs[1].disturbanceSeed = 8;
+    EXPECT_THROW(BatchSimulator mismatched(configs), std::invalid_argument);
+}
+
+// Test: Float lanes track the double baseline to well under a millimetre,
+// through setpoint transients, valve saturation and stochastic disturbances
+TEST_F(BatchSimulatorTest, FloatLanesTrackDoubleBaseline) {
+    const PrecisionReport varied =
+        measurePrecision<FloatBatchSimulator>(createVariedConfigs(), 3600);
+    EXPECT_EQ(varied.lanes, 4);
+    EXPECT_EQ(varied.steps, 3600);
+    EXPECT_LT(varied.maxLevelError, 1e-3);
+    EXPECT_GT(varied.maxLevelError, 0.0) << "float rounding is visible";
+    EXPECT_LE(varied.rmsLevelError, varied.maxLevelError);
+    EXPECT_LE(varied.finalMaxLevelError, varied.maxLevelError);
+    EXPECT_GE(varied.worstLane, 0);
+    EXPECT_LT(varied.worstLane, 4);
+    EXPECT_LT(varied.maxOutputError, 0.05);
+
+    Simulator::Config config = createSteadyStateConfig(3.0);
+    config.disturbances = {
+        Disturbance::ornsteinUhlenbeck(INPUT_INDEX_INLET_FLOW, TEST_INLET_FLOW, 0.05,
+                                       0.002, 0.0, 2.0 * TEST_INLET_FLOW),
+    };
+    config.disturbanceSeed = 7;
+    const PrecisionReport noisy = measurePrecision<FloatBatchSimulator>(config, 64, 3600);
+    EXPECT_EQ(noisy.lanes, 64);
+    EXPECT_LT(noisy.maxLevelError, 1e-3);
+
+    EXPECT_THROW(measurePrecision<FloatBatchSimulator>(config, 4, -1),
+                 std::invalid_argument);
+    EXPECT_THROW(measurePrecision<MixedBatchSimulator>(config, 0, 10),
+                 std::invalid_argument);
+}
+
+// Test: MixedBatchSimulator keeps the integral in double, which holds a long
+// slowly growing integral sum that float rounds away step by step
+TEST_F(BatchSimulatorTest, MixedPrecisionAccumulatesIntegralInDouble) {
+    static_assert(std::is_same<FloatBatchSimulator::LaneArray, Eigen::ArrayXf>::value,
+                  "float lanes");
+    static_assert(std::is_same<MixedBatchSimulator::LaneArray, Eigen::ArrayXf>::value,
+                  "float lanes");
+    static_assert(std::is_same<MixedBatchSimulator::AccumulatorArray, Eigen::ArrayXd>::value,
+                  "double integral");
+
+    // A weak, slow loop: the level barely moves while the integral sums a
+    // 0.5 m offset into the thousands
+    Simulator::Config config = createSteadyStateConfig(3.0);
+    config.dt = 0.1;
+    config.controllerConfig[0].gains = PIDController::Gains{-1e-6, 1000.0, 0.0};
+    config.controllerConfig[0].maxIntegralAccumulation = 1e5;
+
+    const PrecisionReport single = measurePrecision<FloatBatchSimulator>(config, 4, 100000);
+    const PrecisionReport mixed = measurePrecision<MixedBatchSimulator>(config, 4, 100000);
+    EXPECT_LT(single.maxLevelError, 1e-3);
+    EXPECT_LT(mixed.maxLevelError, 1e-3);
+    EXPECT_LT(mixed.maxIntegralError, 0.5 * single.maxIntegralError);
+
+    // The reduced batches take the same double-valued setters and snapshots
+    Simulator sim(createSteadyStateConfig(3.0));
+    sim.run(20);
+    MixedBatchSimulator batch(createSteadyStateConfig(), 3);
+    const Simulator::Snapshot snapshot = sim.save();
+    batch.restore(snapshot);
+    EXPECT_EQ(batch.getIntegralStates()(2), snapshot.controllers[0].integralState);
+    EXPECT_FLOAT_EQ(batch.getLevels()(1), static_cast<float>(sim.getState()(0)));
+    batch.setInput(INPUT_INDEX_INLET_FLOW, Eigen::ArrayXf::Constant(3, 1.5f));
+    batch.setSetpoint(0, 2.0);
+    batch.step();
+    EXPECT_EQ(batch.getInputs(INPUT_INDEX_INLET_FLOW)(2), 1.5f);
+    EXPECT_EQ(batch.getSetpoints()(0), 2.0f);
+}
@@ -0,0 +1,171 @@
+#include <gtest/gtest.h>
+#include <Eigen/Dense>
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include "../src/command_queue.h"
+
+using namespace tank_sim;
+
+class CommandQueueTest : public ::testing::Test {
+protected:
+    // Producer p's k-th command: the tag round-trips through index and value
+    static Command tagged(int producer, int k) {
+        return Command::input(producer, static_cast<double>(k));
+    }
+};
+
+// Test: Capacity rounds up to a power of two and is validated
+TEST_F(CommandQueueTest, CapacityRoundsUpToPowerOfTwo) {
+    EXPECT_EQ(CommandQueue(1).capacity(), 1);
+    EXPECT_EQ(CommandQueue(5).capacity(), 8);
+    EXPECT_EQ(CommandQueue(64).capacity(), 64);
+    EXPECT_THROW(CommandQueue(0), std::invalid_argument);
+    EXPECT_THROW(CommandQueue(-4), std::invalid_argument);
+    EXPECT_THROW(CommandQueue(Eigen::Index(1) << 40), std::invalid_argument);
+}
+
+// Test: Commands pop in push order with their payloads intact
+TEST_F(CommandQueueTest, PopsInPushOrder) {
+    CommandQueue queue(4);
+    Command command;
+    EXPECT_FALSE(queue.pop(command));
+
+    ASSERT_TRUE(queue.push(Command::input(1, 0.75)));
+    ASSERT_TRUE(queue.push(Command::setpoint(0, 3.0)));
+    ASSERT_TRUE(queue.push(Command::retune(2, PIDController::Gains{-1.5, 8.0, 0.5})));
+
+    ASSERT_TRUE(queue.pop(command));
+    EXPECT_EQ(command.kind, Command::Kind::INPUT);
+    EXPECT_EQ(command.index, 1);
+    EXPECT_DOUBLE_EQ(command.value, 0.75);
+    ASSERT_TRUE(queue.pop(command));
+    EXPECT_EQ(command.kind, Command::Kind::SETPOINT);
+    EXPECT_DOUBLE_EQ(command.value, 3.0);
+    ASSERT_TRUE(queue.pop(command));
+    EXPECT_EQ(command.kind, Command::Kind::GAINS);
+    EXPECT_EQ(command.index, 2);
+    EXPECT_DOUBLE_EQ(command.gains.Kc, -1.5);
+    EXPECT_DOUBLE_EQ(command.gains.tau_I, 8.0);
+    EXPECT_DOUBLE_EQ(command.gains.tau_D, 0.5);
+    EXPECT_FALSE(queue.pop(command));
+    EXPECT_EQ(queue.pushed(), 3u);
+    EXPECT_EQ(queue.dropped(), 0u);
+}
+
+// Test: A full queue rejects pushes and frees cells as they are popped
+TEST_F(CommandQueueTest, FullQueueDropsAndRecovers) {
+    CommandQueue queue(2);
+    EXPECT_TRUE(queue.push(tagged(0, 0)));
+    EXPECT_TRUE(queue.push(tagged(0, 1)));
+    EXPECT_FALSE(queue.push(tagged(0, 2)));
+    EXPECT_EQ(queue.dropped(), 1u);
+
+    // Many wraps of the ring
+    Command command;
+    for (int k = 2; k < 100; ++k) {
+        ASSERT_TRUE(queue.pop(command));
+        EXPECT_DOUBLE_EQ(command.value, k - 2);
+        ASSERT_TRUE(queue.push(tagged(0, k)));
+    }
+    EXPECT_EQ(queue.pushed(), 100u);
+    EXPECT_EQ(queue.dropped(), 1u);
+}
+
+// Test: Bulk push accepts a prefix and counts the rest as dropped
+TEST_F(CommandQueueTest, BulkPushAcceptsPrefix) {
+    CommandQueue queue(4);
+    ASSERT_TRUE(queue.push(tagged(0, -1)));
+    std::vector<Command> batch;
+    for (int k = 0; k < 6; ++k) {
+        batch.push_back(tagged(0, k));
+    }
+    EXPECT_EQ(queue.push(batch.data(), static_cast<Eigen::Index>(batch.size())), 3);
+    EXPECT_EQ(queue.push(batch.data(), 0), 0);
+    EXPECT_EQ(queue.pushed(), 4u);
+    EXPECT_EQ(queue.dropped(), 3u);
+
+    Command command;
+    for (int k = -1; k < 3; ++k) {
+        ASSERT_TRUE(queue.pop(command));
+        EXPECT_DOUBLE_EQ(command.value, k);
+    }
+    EXPECT_FALSE(queue.pop(command));
+}
+
+// Test: clear() discards pending commands and the queue stays usable
+TEST_F(CommandQueueTest, ClearDiscardsPending) {
+    CommandQueue queue(4);
+    for (int k = 0; k < 4; ++k) {
+        ASSERT_TRUE(queue.push(tagged(0, k)));
+    }
+    queue.clear();
+    Command command;
+    EXPECT_FALSE(queue.pop(command));
+    for (int k = 0; k < 4; ++k) {
+        ASSERT_TRUE(queue.push(tagged(0, 10 + k)));
+    }
+    ASSERT_TRUE(queue.pop(command));
+    EXPECT_DOUBLE_EQ(command.value, 10.0);
+}
+
+// Test: Concurrent producers lose nothing and keep their own order
+TEST_F(CommandQueueTest, ConcurrentProducersKeepPerProducerOrder) {
+    constexpr int PRODUCERS = 4;
+    constexpr int PER_PRODUCER = 20000;
+    CommandQueue queue(256);
+    std::atomic<int> finished{0};
+
+    std::vector<std::thread> producers;
+    for (int p = 0; p < PRODUCERS; ++p) {
+        producers.emplace_back([&queue, &finished, p] {
+            for (int k = 0; k < PER_PRODUCER; ++k) {
+                // Half single pushes, half two-command batches
+                if (k % 4 < 2) {
+                    while (!queue.push(tagged(p, k))) {
+                        std::this_thread::yield();
+                    }
+                } else {
+                    const Command pair[2] = {tagged(p, k), tagged(p, k + 1)};
+                    Eigen::Index sent = 0;
+                    while (sent < 2) {
+                        sent += queue.push(pair + sent, 2 - sent);
+                        if (sent < 2) {
+                            std::this_thread::yield();
+                        }
+                    }
+                    ++k;
+                }
+            }
+            finished.fetch_add(1);
+        });
+    }
+
+    std::vector<int> next(PRODUCERS, 0);
+    int received = 0;
+    Command command;
+    while (received < PRODUCERS * PER_PRODUCER) {
+        if (!queue.pop(command)) {
+            // Everything accepted has been received, yet some never arrived
+            ASSERT_FALSE(finished.load() == PRODUCERS &&
+                         queue.pushed() == static_cast<std::uint64_t>(received))
+                << "commands lost";
+            continue;
+        }
+        ASSERT_GE(command.index, 0);
+        ASSERT_LT(command.index, PRODUCERS);
+        ASSERT_EQ(command.value, next[command.index]) << "producer " << command.index;
+        ++next[command.index];
+        ++received;
+    }
+    for (std::thread &producer : producers) {
+        producer.join();
+    }
+
+    EXPECT_FALSE(queue.pop(command));
+    for (int p = 0; p < PRODUCERS; ++p) {
+        EXPECT_EQ(next[p], PER_PRODUCER);
+    }
+    EXPECT_EQ(queue.pushed(), static_cast<std::uint64_t>(PRODUCERS * PER_PRODUCER));
+}
@@ -0,0 +1,204 @@
+#include <gtest/gtest.h>
+#include <Eigen/Dense>
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+#include "../src/disturbance.h"
+
+using namespace tank_sim;
+
+// Test: Philox4x32-10 reproduces the Random123 known-answer vectors
+TEST(DisturbanceTest, PhiloxKnownAnswers) {
+    using Counter = Philox4x32::Counter;
+    EXPECT_EQ(Philox4x32::generate({0, 0, 0, 0}, {0, 0}),
+              (Counter{0x6627e8d5u, 0xe169c58du, 0xbc57ac4cu, 0x9b00dbd8u}));
+    EXPECT_EQ(Philox4x32::generate({0xffffffffu, 0xffffffffu, 0xffffffffu, 0xffffffffu},
+                                   {0xffffffffu, 0xffffffffu}),
+              (Counter{0x408f276du, 0x41c83b0eu, 0xa20bc7c6u, 0x6d5451fdu}));
+    EXPECT_EQ(Philox4x32::generate({0x243f6a88u, 0x85a308d3u, 0x13198a2eu, 0x03707344u},
+                                   {0xa4093822u, 0x299f31d0u}),
+              (Counter{0xd16cfe09u, 0x94fdccebu, 0x5001e420u, 0x24126ea1u}));
+}
+
+// Test: Uniforms lie in (0, 1], so log() in Box-Muller is always finite
+TEST(DisturbanceTest, UniformRange) {
+    EXPECT_GT(Philox4x32::uniform(0, 0), 0.0);
+    EXPECT_EQ(Philox4x32::uniform(0xffffffffu, 0xffffffffu), 1.0);
+}
+
+// Test: Counter normals have zero mean and unit variance, and each
+// coordinate gives an independent value
+TEST(DisturbanceTest, CounterNormalMoments) {
+    const int n = 200000;
+    double sum = 0.0;
+    double sumSquares = 0.0;
+    for (int k = 0; k < n; ++k) {
+        const double x = counterNormal(42, 7, static_cast<std::uint64_t>(k), 0);
+        sum += x;
+        sumSquares += x * x;
+    }
+    const double mean = sum / n;
+    EXPECT_NEAR(mean, 0.0, 0.01);
+    EXPECT_NEAR(sumSquares / n - mean * mean, 1.0, 0.02);
+
+    EXPECT_EQ(counterNormal(1, 2, 3, 4), counterNormal(1, 2, 3, 4));
+    EXPECT_NE(counterNormal(1, 2, 3, 4), counterNormal(1, 3, 3, 4));
+    EXPECT_NE(counterNormal(1, 2, 3, 4), counterNormal(1, 2, 3, 5));
+    EXPECT_NE(counterNormal(1, 2, 3, 4), counterNormal(2, 2, 3, 4));
+}
+
+// Test: Brownian increments have standard deviation sigma * sqrt(dt)
+TEST(DisturbanceTest, BrownianIncrementScale) {
+    const double dt = 0.25;
+    DisturbanceGenerator generator({Disturbance::brownian(0, 2.0)}, dt, 3);
+    const int n = 50000;
+    double sumSquares = 0.0;
+    for (int k = 0; k < n; ++k) {
+        Eigen::VectorXd u = Eigen::VectorXd::Zero(1);
+        generator.apply(static_cast<std::uint64_t>(k), k * dt, u);
+        sumSquares += u(0) * u(0);
+    }
+    EXPECT_NEAR(std::sqrt(sumSquares / n), 2.0 * std::sqrt(dt), 0.02);
+}
+
+// Test: Clamping keeps a noisy input inside its bounds
+TEST(DisturbanceTest, BrownianRespectsBounds) {
+    DisturbanceGenerator generator({Disturbance::brownian(1, 5.0, 0.95, 1.05)}, 1.0);
+    Eigen::Vector2d u(0.0, 1.0);
+    for (std::uint64_t k = 0; k < 1000; ++k) {
+        generator.apply(k, static_cast<double>(k), u);
+        ASSERT_GE(u(1), 0.95);
+        ASSERT_LE(u(1), 1.05);
+    }
+    EXPECT_EQ(u(0), 0.0);  // Other inputs untouched
+}
+
+// Test: Ornstein-Uhlenbeck reverts to its mean with stationary variance
+// sigma^2 / (2 theta), independent of dt (exact discretization)
+TEST(DisturbanceTest, OrnsteinUhlenbeckStationaryStatistics) {
+    const double mean = 1.0, theta = 0.5, sigma = 0.2;
+    for (double dt : {0.1, 5.0}) {
+        DisturbanceGenerator generator(
+            {Disturbance::ornsteinUhlenbeck(0, mean, theta, sigma)}, dt, 11);
+        Eigen::VectorXd u = Eigen::VectorXd::Constant(1, 10.0);
+        double sum = 0.0, sumSquares = 0.0;
+        int samples = 0;
+        for (std::uint64_t k = 0; k < 400000; ++k) {
+            generator.apply(k, k * dt, u);
+            if (k * dt > 50.0) {  // Skip the decay from u = 10
+                sum += u(0);
+                sumSquares += u(0) * u(0);
+                ++samples;
+            }
+        }
+        const double sampleMean = sum / samples;
+        EXPECT_NEAR(sampleMean, mean, 0.01) << "dt = " << dt;
+        EXPECT_NEAR(sumSquares / samples - sampleMean * sampleMean,
+                    sigma * sigma / (2.0 * theta), 0.002)
+            << "dt = " << dt;
+    }
+}
+
+// Test: A step fires once, in the period containing its start time, and a
+// ramp adds its magnitude in total, spread over its duration
+TEST(DisturbanceTest, StepAndRampSchedules) {
+    const double dt = 0.1;
+    DisturbanceGenerator generator(
+        {Disturbance::step(0, 1.0, 0.5), Disturbance::ramp(1, 2.0, 1.0, -0.3)}, dt);
+    Eigen::Vector2d u(1.0, 0.5);
+    double time = 0.0;
+    for (std::uint64_t k = 0; k < 50; ++k) {
+        generator.apply(k, time, u);
+        if (time + dt <= 1.0) {
+            EXPECT_EQ(u(0), 1.0);
+        } else {
+            EXPECT_EQ(u(0), 1.5);
+        }
+        if (time > 2.45 && time < 2.55) {
+            EXPECT_NEAR(u(1), 0.5 - 0.3 * (time + dt - 2.0), 1e-12);  // Mid-ramp
+        }
+        time += dt;
+    }
+    EXPECT_NEAR(u(1), 0.2, 1e-12);
+}
+
+// Test: Invalid parameters are rejected
+TEST(DisturbanceTest, Validation) {
+    EXPECT_THROW(DisturbanceGenerator({Disturbance::brownian(-1, 1.0)}, 1.0),
+                 std::invalid_argument);
+    EXPECT_THROW(DisturbanceGenerator({Disturbance::brownian(0, -1.0)}, 1.0),
+                 std::invalid_argument);
+    EXPECT_THROW(DisturbanceGenerator({Disturbance::brownian(0, 1.0, 2.0, 1.0)}, 1.0),
+                 std::invalid_argument);
+    EXPECT_THROW(DisturbanceGenerator({Disturbance::ornsteinUhlenbeck(0, 1.0, -1.0, 1.0)}, 1.0),
+                 std::invalid_argument);
+    EXPECT_THROW(DisturbanceGenerator({Disturbance::ramp(0, 1.0, 0.0, 1.0)}, 1.0),
+                 std::invalid_argument);
+    EXPECT_THROW(DisturbanceGenerator({Disturbance::step(0, NAN, 1.0)}, 1.0),
+                 std::invalid_argument);
+
+    DisturbanceGenerator generator({Disturbance::brownian(1, 1.0)}, 1.0);
+    EXPECT_NO_THROW(generator.validateInputs(2, {0}));
+    EXPECT_THROW(generator.validateInputs(1, {}), std::invalid_argument);
+    EXPECT_THROW(generator.validateInputs(2, {1}), std::invalid_argument);
+}
+
+// Test: assign() matches a newly constructed generator and validates before
+// it changes anything
+TEST(DisturbanceTest, AssignMatchesConstruction) {
+    const std::vector<Disturbance> list{
+        Disturbance::ornsteinUhlenbeck(0, 1.0, 0.05, 0.02),
+        Disturbance::ramp(1, 2.0, 4.0, 0.3),
+    };
+    const DisturbanceGenerator fresh(list, 0.5, 99, 3);
+    DisturbanceGenerator reused({Disturbance::brownian(1, 5.0)}, 2.0, 1, 1);
+    reused.assign(list, 0.5, 99, 3);
+    EXPECT_EQ(reused.getDisturbances(), list);
+
+    Eigen::Vector2d a(1.0, 0.5);
+    Eigen::Vector2d b = a;
+    for (std::uint64_t k = 0; k < 20; ++k) {
+        fresh.apply(k, 0.5 * static_cast<double>(k), a);
+        reused.apply(k, 0.5 * static_cast<double>(k), b);
+    }
+    EXPECT_EQ(a, b);
+
+    EXPECT_THROW(reused.assign({Disturbance::brownian(0, -1.0)}, 0.5), std::invalid_argument);
+    EXPECT_EQ(reused.getDisturbances(), list);
+    EXPECT_EQ(reused.getSeed(), 99u);
+    EXPECT_THROW(DisturbanceGenerator::validate({Disturbance::ramp(0, 1.0, 0.0, 1.0)}),
+                 std::invalid_argument);
+}
+
+// Test: Vectorized lanes reproduce the scalar path on each lane's stream
+TEST(DisturbanceTest, ApplyLanesMatchesScalar) {
+    const double dt = 0.5;
+    const std::vector<Disturbance> list{
+        Disturbance::brownian(0, 0.3, 0.0, 2.0),
+        Disturbance::ornsteinUhlenbeck(1, 0.5, 0.2, 0.1),
+        Disturbance::step(0, 3.0, 0.25),
+        Disturbance::ramp(1, 1.0, 4.0, 0.1),
+    };
+    DisturbanceGenerator lanes(list, dt, 99);
+
+    const int laneCount = 37;  // Not a multiple of any packet size
+    DisturbanceGenerator::StreamArray streams(laneCount);
+    for (int lane = 0; lane < laneCount; ++lane) {
+        streams(lane) = static_cast<std::uint32_t>(3 * lane + 1);
+    }
+    Eigen::ArrayXXd batchInputs = Eigen::ArrayXXd::Constant(laneCount, 2, 1.0);
+    std::vector<Eigen::Vector2d> scalarInputs(laneCount, Eigen::Vector2d(1.0, 1.0));
+
+    for (std::uint64_t k = 0; k < 20; ++k) {
+        lanes.applyLanes(k, k * dt, streams, batchInputs);
+        for (int lane = 0; lane < laneCount; ++lane) {
+            DisturbanceGenerator(list, dt, 99, streams(lane))
+                .apply(k, k * dt, scalarInputs[lane]);
+        }
+    }
+    for (int lane = 0; lane < laneCount; ++lane) {
+        EXPECT_NEAR(batchInputs(lane, 0), scalarInputs[lane](0), 1e-12) << lane;
+        EXPECT_NEAR(batchInputs(lane, 1), scalarInputs[lane](1), 1e-12) << lane;
+    }
+}
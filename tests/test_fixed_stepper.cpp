@@ -0,0 +1,154 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <Eigen/Dense>
+#include "../src/fixed_stepper.h"
+#include "../src/stepper.h"
+#include "../src/tank_model.h"
+#include "../src/constants.h"
+
+using namespace tank_sim;
+using namespace tank_sim::constants;
+
+// Test fixture for fixed-size RK4 integration tests
+class FixedStepperTest : public ::testing::Test {
+protected:
+    using ScalarStepper = FixedStepper<1, 1>;
+    using OscillatorStepper = FixedStepper<2, 2>;
+};
+
+// Test: Exponential Decay Accuracy
+TEST_F(FixedStepperTest, ExponentialDecayAccuracy) {
+    // ODE: dy/dt = -k*y with k = 1.0
+    // Analytical solution: y(t) = y0 * exp(-k*t)
+    const double k = 1.0;
+    const double dt = TEST_RK4_DT_COARSE;
+    const int num_steps = TEST_NUM_STEPS;
+
+    ScalarStepper stepper;
+    ScalarStepper::StateVector state(1.0);
+    const ScalarStepper::InputVector input = ScalarStepper::InputVector::Zero();
+
+    auto derivative = [k](double t, const ScalarStepper::StateVector& y,
+                          const ScalarStepper::InputVector& u) {
+        return ScalarStepper::StateVector(-k * y(0));
+    };
+
+    double current_time = 0.0;
+    for (int i = 0; i < num_steps; ++i) {
+        state = stepper.step(current_time, dt, state, input, derivative);
+        current_time += dt;
+    }
+
+    EXPECT_NEAR(state(0), std::exp(-k * 1.0), INTEGRATION_TOLERANCE);
+}
+
+// Test: Fourth Order Accuracy Verification
+TEST_F(FixedStepperTest, FourthOrderAccuracyVerification) {
+    // Halving dt should shrink the global error by ~2^4 = 16 for RK4
+    const double k = 1.0;
+    const double expected = std::exp(-k * 1.0);
+
+    auto derivative = [k](double t, const ScalarStepper::StateVector& y,
+                          const ScalarStepper::InputVector& u) {
+        return ScalarStepper::StateVector(-k * y(0));
+    };
+
+    auto integrate = [&](double dt, int num_steps) {
+        ScalarStepper stepper;
+        ScalarStepper::StateVector state(1.0);
+        double current_time = 0.0;
+        for (int i = 0; i < num_steps; ++i) {
+            state = stepper.step(current_time, dt, state,
+                                 ScalarStepper::InputVector::Zero(), derivative);
+            current_time += dt;
+        }
+        return std::abs(state(0) - expected);
+    };
+
+    double error_coarse = integrate(TEST_RK4_DT_COARSE, TEST_NUM_STEPS);
+    double error_fine = integrate(TEST_RK4_DT_FINE, TEST_NUM_STEPS_FINE);
+    double error_ratio = error_coarse / error_fine;
+
+    EXPECT_GT(error_ratio, RK4_MIN_ERROR_RATIO) << "Error ratio " << error_ratio << " is below expected range for fourth-order method";
+    EXPECT_LT(error_ratio, RK4_MAX_ERROR_RATIO) << "Error ratio " << error_ratio << " is above expected range for fourth-order method";
+}
+
+// Test: Oscillatory System (Harmonic Oscillator)
+TEST_F(FixedStepperTest, OscillatorySystemHarmonicOscillator) {
+    // y0' = y1, y1' = -omega^2 * y0; one full period returns to the start
+    const double omega = TWO_PI;
+    const double dt = 0.01;
+    const int num_steps = 100;
+
+    OscillatorStepper stepper;
+    OscillatorStepper::StateVector state(1.0, 0.0);
+
+    auto derivative = [omega](double t, const OscillatorStepper::StateVector& y,
+                              const OscillatorStepper::InputVector& u) {
+        return OscillatorStepper::StateVector(y(1), -omega * omega * y(0));
+    };
+
+    double current_time = 0.0;
+    for (int i = 0; i < num_steps; ++i) {
+        state = stepper.step(current_time, dt, state,
+                             OscillatorStepper::InputVector::Zero(), derivative);
+        current_time += dt;
+    }
+
+    EXPECT_NEAR(state(0), 1.0, OSCILLATOR_POSITION_TOLERANCE) << "Position should return to initial value after one period";
+    EXPECT_NEAR(state(1), 0.0, OSCILLATOR_VELOCITY_TOLERANCE) << "Velocity should return to initial value after one period";
+}
+
+// Test: Derivative function is evaluated exactly four times per step
+TEST_F(FixedStepperTest, FourEvaluationsPerStep) {
+    ScalarStepper stepper;
+    int evaluations = 0;
+
+    auto derivative = [&evaluations](double t, const ScalarStepper::StateVector& y,
+                                     const ScalarStepper::InputVector& u) {
+        ++evaluations;
+        return ScalarStepper::StateVector(u(0));
+    };
+
+    ScalarStepper::StateVector state(0.0);
+    state = stepper.step(0.0, 0.5, state, ScalarStepper::InputVector(2.0), derivative);
+
+    EXPECT_EQ(evaluations, 4);
+    EXPECT_DOUBLE_EQ(state(0), 1.0) << "Constant derivative should integrate exactly";
+}
+
+// Test: Tank model agrees with the dynamic GSL stepper
+TEST_F(FixedStepperTest, TankModelMatchesDynamicStepper) {
+    // Draining tank: level starts above nominal with the valve fully open
+    TankModel model(TankModel::Parameters{
+        DEFAULT_TANK_AREA, DEFAULT_VALVE_COEFFICIENT, TANK_MAX_HEIGHT});
+    const double dt = TEST_DT;
+    const int num_steps = 100;
+
+    FixedStepper<TANK_STATE_SIZE, TANK_INPUT_SIZE> fixed_stepper;
+    TankModel::StateVector fixed_state(4.0);
+    TankModel::InputVector fixed_inputs(TEST_INLET_FLOW, 1.0);
+
+    Stepper dynamic_stepper(TANK_STATE_SIZE, TANK_INPUT_SIZE);
+    Eigen::VectorXd dynamic_state = fixed_state;
+    Eigen::VectorXd dynamic_inputs = fixed_inputs;
+
+    auto fixed_derivative = [&model](double t, const TankModel::StateVector& x,
+                                     const TankModel::InputVector& u) {
+        return model.derivatives(x, u);
+    };
+    auto dynamic_derivative = [&model](double t, const Eigen::VectorXd& x,
+                                       const Eigen::VectorXd& u) -> Eigen::VectorXd {
+        return model.derivatives(x, u);
+    };
+
+    double current_time = 0.0;
+    for (int i = 0; i < num_steps; ++i) {
+        fixed_state = fixed_stepper.step(current_time, dt, fixed_state, fixed_inputs, fixed_derivative);
+        dynamic_state = dynamic_stepper.step(current_time, dt, dynamic_state, dynamic_inputs, dynamic_derivative);
+        current_time += dt;
+    }
+
+    EXPECT_LT(fixed_state(0), 4.0) << "Tank should drain with the valve fully open";
+    EXPECT_NEAR(fixed_state(0), dynamic_state(0), INTEGRATION_TOLERANCE);
+}
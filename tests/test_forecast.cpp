@@ -0,0 +1,203 @@
+#include <gtest/gtest.h>
+#include <Eigen/Dense>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include "../src/forecast.h"
+#include "../src/simulator.h"
+#include "../src/constants.h"
+
+using namespace tank_sim;
+using namespace tank_sim::constants;
+
+// Lanes reproduce the scalar Simulator; only FMA contraction may differ,
+// or fastSqrt() in the lanes when built with TANK_SIM_FAST_VALVE
+constexpr double FORECAST_TOLERANCE = TANK_SIM_FAST_VALVE ? 1e-9 : 1e-12;
+
+const double NaN = std::numeric_limits<double>::quiet_NaN();
+
+class ForecastTest : public ::testing::Test {
+protected:
+    // Same steady-state loop as SimulatorTest (reverse-acting, Kc < 0)
+    Simulator::Config createConfig() {
+        Simulator::Config config;
+        config.params = TankModel::Parameters{
+            DEFAULT_TANK_AREA,
+            DEFAULT_VALVE_COEFFICIENT,
+            TANK_MAX_HEIGHT
+        };
+
+        config.initialState = Eigen::VectorXd(1);
+        config.initialState << TANK_NOMINAL_HEIGHT;
+
+        config.initialInputs = Eigen::VectorXd(2);
+        config.initialInputs << TEST_INLET_FLOW, TEST_VALVE_POSITION;
+
+        config.dt = TEST_DT;
+
+        Simulator::ControllerConfig ctrl_config;
+        ctrl_config.gains = PIDController::Gains{-1.0, 10.0, 0.0};
+        ctrl_config.bias = 0.5;
+        ctrl_config.minOutputLimit = 0.0;
+        ctrl_config.maxOutputLimit = 1.0;
+        ctrl_config.maxIntegralAccumulation = 10.0;
+        ctrl_config.measuredIndex = 0;
+        ctrl_config.outputIndex = 1;
+        ctrl_config.initialSetpoint = TANK_NOMINAL_HEIGHT;
+        config.controllerConfig.push_back(ctrl_config);
+
+        return config;
+    }
+
+    // A live simulator that has been running away from steady state
+    Simulator createLive(const Simulator::Config &config) {
+        Simulator live(config);
+        live.setSetpoint(0, 3.0);
+        live.run(40);
+        return live;
+    }
+};
+
+// Test: Each candidate follows a fork of the live simulator given the same
+// setpoint and inlet moves at the same steps
+TEST_F(ForecastTest, CandidatesMatchForkedSimulators) {
+    const Simulator::Config config = createConfig();
+    Simulator live = createLive(config);
+
+    Forecaster::Options options;
+    options.horizonSteps = 120;
+    options.sampleInterval = 10;
+    Forecaster forecaster(config, options);
+
+    // Two segments of 60 steps; NaN holds the previous value
+    Eigen::MatrixXd setpoints(3, 2);
+    setpoints << 2.0, 2.5,
+                 3.5, NaN,
+                 NaN, 1.5;
+    Eigen::MatrixXd inletFlows(3, 1);
+    inletFlows << TEST_INLET_FLOW, 1.5 * TEST_INLET_FLOW, NaN;
+
+    const Forecaster::Result result = forecaster.run(live.save(), setpoints, inletFlows);
+    ASSERT_EQ(result.time.size(), 12);
+    ASSERT_EQ(result.levels.rows(), 12);
+    ASSERT_EQ(result.levels.cols(), 3);
+
+    for (int c = 0; c < 3; ++c) {
+        Simulator branch = live.fork();
+        if (!std::isnan(inletFlows(c, 0))) {
+            branch.setInput(INPUT_INDEX_INLET_FLOW, inletFlows(c, 0));
+        }
+        double lowest = std::numeric_limits<double>::infinity();
+        double highest = -lowest;
+        for (int k = 0; k < options.horizonSteps; ++k) {
+            if (k % 60 == 0 && !std::isnan(setpoints(c, k / 60))) {
+                branch.setSetpoint(0, setpoints(c, k / 60));
+            }
+            branch.step();
+            lowest = std::min(lowest, branch.getState()(0));
+            highest = std::max(highest, branch.getState()(0));
+            if ((k + 1) % options.sampleInterval == 0) {
+                const int sample = (k + 1) / options.sampleInterval - 1;
+                EXPECT_NEAR(result.time(sample), branch.getTime(), 1e-9);
+                EXPECT_NEAR(result.levels(sample, c), branch.getState()(0),
+                            FORECAST_TOLERANCE)
+                    << "candidate " << c << ", step " << k;
+            }
+        }
+        EXPECT_NEAR(result.candidateMin(c), lowest, FORECAST_TOLERANCE);
+        EXPECT_NEAR(result.candidateMax(c), highest, FORECAST_TOLERANCE);
+    }
+
+    for (Eigen::Index s = 0; s < result.levels.rows(); ++s) {
+        EXPECT_EQ(result.lower(s), result.levels.row(s).minCoeff());
+        EXPECT_EQ(result.upper(s), result.levels.row(s).maxCoeff());
+    }
+}
+
+// Test: Repeated runs from the same snapshot agree, including after the
+// candidate count changes and the batch is rebuilt
+TEST_F(ForecastTest, RerunsAreIndependent) {
+    const Simulator::Config config = createConfig();
+    Simulator live = createLive(config);
+    Forecaster forecaster(config, Forecaster::Options{60, 1});
+
+    Eigen::MatrixXd two(2, 1);
+    two << 2.0, 3.5;
+    const Forecaster::Result first = forecaster.run(live.save(), two, Eigen::MatrixXd());
+
+    Eigen::MatrixXd four(4, 1);
+    four << 2.0, 3.5, 2.0, 3.5;
+    const Forecaster::Result wider = forecaster.run(live.save(), four, Eigen::MatrixXd());
+    const Forecaster::Result again = forecaster.run(live.save(), two, Eigen::MatrixXd());
+
+    EXPECT_EQ(again.levels, first.levels);
+    EXPECT_EQ(wider.levels.leftCols(2), first.levels);
+    EXPECT_EQ(wider.levels.rightCols(2), first.levels);
+
+    // The live simulator is untouched
+    EXPECT_DOUBLE_EQ(live.getTime(), 40 * TEST_DT);
+}
+
+// Test: Disturbances in the config do not enter the forecast
+TEST_F(ForecastTest, IgnoresDisturbances) {
+    Simulator::Config config = createConfig();
+    Simulator live = createLive(config);
+    config.disturbances.push_back(
+        Disturbance::ornsteinUhlenbeck(INPUT_INDEX_INLET_FLOW, TEST_INLET_FLOW, 0.05,
+                                       0.002, 0.0, 2.0 * TEST_INLET_FLOW));
+
+    Forecaster noisy(config, Forecaster::Options{30, 1});
+    Forecaster clean(createConfig(), Forecaster::Options{30, 1});
+    Eigen::MatrixXd setpoints = Eigen::MatrixXd::Constant(2, 1, 2.5);
+    EXPECT_EQ(noisy.run(live.save(), setpoints, Eigen::MatrixXd()).levels,
+              clean.run(live.save(), setpoints, Eigen::MatrixXd()).levels);
+}
+
+// Test: Configs for other integrators are accepted and forecast with RK4
+TEST_F(ForecastTest, OtherIntegratorsForecastWithRK4) {
+    Forecaster rk4(createConfig(), Forecaster::Options{60, 1});
+    Eigen::MatrixXd setpoints(2, 1);
+    setpoints << 2.0, 3.5;
+
+    for (Simulator::Integrator integrator :
+         {Simulator::Integrator::AdaptiveRKF45, Simulator::Integrator::Rosenbrock,
+          Simulator::Integrator::ExactZOH}) {
+        Simulator::Config config = createConfig();
+        config.integrator = integrator;
+        Simulator live = createLive(config);
+
+        Forecaster forecaster(config, Forecaster::Options{60, 1});
+        EXPECT_EQ(forecaster.run(live.save(), setpoints, Eigen::MatrixXd()).levels,
+                  rk4.run(live.save(), setpoints, Eigen::MatrixXd()).levels);
+    }
+}
+
+// Test: Invalid options and schedules are rejected
+TEST_F(ForecastTest, Validation) {
+    const Simulator::Config config = createConfig();
+    EXPECT_THROW(Forecaster(config, Forecaster::Options{0, 1}), std::invalid_argument);
+    EXPECT_THROW(Forecaster(config, Forecaster::Options{10, 0}), std::invalid_argument);
+    EXPECT_THROW(Forecaster(config, Forecaster::Options{10, 11}), std::invalid_argument);
+
+    Forecaster forecaster(config, Forecaster::Options{4, 2});
+    EXPECT_EQ(forecaster.getSampleCount(), 2);
+    const Simulator::Snapshot snapshot = Simulator(config).save();
+    const Eigen::MatrixXd empty;
+    EXPECT_THROW(forecaster.run(snapshot, empty, empty), std::invalid_argument);
+    EXPECT_THROW(forecaster.run(snapshot, Eigen::MatrixXd::Ones(2, 1),
+                                Eigen::MatrixXd::Ones(3, 1)),
+                 std::invalid_argument);
+    EXPECT_THROW(forecaster.run(snapshot, Eigen::MatrixXd::Ones(2, 5), empty),
+                 std::invalid_argument);
+
+    Simulator::Config openLoop = config;
+    openLoop.controllerConfig.clear();
+    Forecaster uncontrolled(openLoop, Forecaster::Options{4, 1});
+    EXPECT_THROW(uncontrolled.run(Simulator(openLoop).save(),
+                                  Eigen::MatrixXd::Ones(2, 1), empty),
+                 std::invalid_argument);
+    EXPECT_THROW(uncontrolled.run(snapshot, empty, Eigen::MatrixXd::Ones(2, 1)),
+                 std::invalid_argument);
+    EXPECT_NO_THROW(uncontrolled.run(Simulator(openLoop).save(), empty,
+                                     Eigen::MatrixXd::Ones(2, 1)));
+}
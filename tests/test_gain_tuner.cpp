@@ -0,0 +1,205 @@
+#include <gtest/gtest.h>
+#include <Eigen/Dense>
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+#include "../src/gain_tuner.h"
+#include "../src/parameter_sweep.h"
+#include "../src/simulator.h"
+#include "../src/constants.h"
+
+using namespace tank_sim;
+using namespace tank_sim::constants;
+
+class GainTunerTest : public ::testing::Test {
+protected:
+    // Steady-state loop from SimulatorTest (reverse-acting, Kc < 0)
+    Simulator::Config createSteadyStateConfig() {
+        Simulator::Config config;
+        config.params = TankModel::Parameters{
+            DEFAULT_TANK_AREA,
+            DEFAULT_VALVE_COEFFICIENT,
+            TANK_MAX_HEIGHT
+        };
+
+        config.initialState = Eigen::VectorXd(1);
+        config.initialState << TANK_NOMINAL_HEIGHT;
+
+        config.initialInputs = Eigen::VectorXd(2);
+        config.initialInputs << TEST_INLET_FLOW, TEST_VALVE_POSITION;
+
+        config.dt = TEST_DT;
+
+        Simulator::ControllerConfig ctrl_config;
+        ctrl_config.gains = PIDController::Gains{-1.0, 10.0, 0.0};
+        ctrl_config.bias = 0.5;
+        ctrl_config.minOutputLimit = 0.0;
+        ctrl_config.maxOutputLimit = 1.0;
+        ctrl_config.maxIntegralAccumulation = 10.0;
+        ctrl_config.measuredIndex = 0;
+        ctrl_config.outputIndex = 1;
+        ctrl_config.initialSetpoint = TANK_NOMINAL_HEIGHT;
+        config.controllerConfig.push_back(ctrl_config);
+
+        return config;
+    }
+
+    GainTuner::Options stepOptions() {
+        GainTuner::Options options;
+        options.steps = 600;
+        options.setpoint = 2.7;  // 0.2 m step up from 2.5 m
+        options.lower = PIDController::Gains{-5.0, 5.0, 0.0};
+        options.upper = PIDController::Gains{-0.05, 500.0, 20.0};
+        return options;
+    }
+
+    // IAE of the same case through ParameterSweep, the double reference
+    double sweepIae(const Simulator::Config &config, const GainTuner::Options &tuning,
+                    const PIDController::Gains &gains) {
+        ParameterSweep::Options options;
+        options.steps = tuning.steps;
+        options.setpoint = tuning.setpoint;
+        options.controllerIndex = tuning.controllerIndex;
+        options.threads = 1;
+        return ParameterSweep(config, options).run({gains})[0].iae;
+    }
+};
+
+// Test: The dual run's IAE is ParameterSweep's, with and without disturbances
+TEST_F(GainTunerTest, EvaluationMatchesParameterSweep) {
+    Simulator::Config config = createSteadyStateConfig();
+    const std::vector<PIDController::Gains> cases = {
+        {-1.0, 10.0, 0.0}, {-0.5, 50.0, 2.0}, {-3.0, 100.0, 5.0}};
+
+    for (int disturbed = 0; disturbed < 2; ++disturbed) {
+        if (disturbed) {
+            config.disturbances = {Disturbance::brownian(INPUT_INDEX_INLET_FLOW, 0.01)};
+            config.disturbanceSeed = 7;
+        }
+        const GainTuner tuner(config, stepOptions());
+        for (const PIDController::Gains &gains : cases) {
+            const double reference = sweepIae(config, stepOptions(), gains);
+            EXPECT_NEAR(tuner.evaluate(gains).iae, reference, 1e-12 * reference)
+                << "Kc=" << gains.Kc << " disturbed=" << disturbed;
+        }
+    }
+}
+
+// Test: The gradient matches central differences of the double IAE
+TEST_F(GainTunerTest, GradientMatchesFiniteDifferences) {
+    const Simulator::Config config = createSteadyStateConfig();
+    const GainTuner::Options options = stepOptions();
+    const GainTuner tuner(config, options);
+    const PIDController::Gains gains{-0.5, 50.0, 2.0};
+
+    const GainTuner::Evaluation evaluation = tuner.evaluate(gains);
+    const Eigen::Vector3d point(gains.Kc, gains.tau_I, gains.tau_D);
+    for (int p = 0; p < 3; ++p) {
+        const double h = 1e-6 * std::max(std::abs(point(p)), 1.0);
+        Eigen::Vector3d plus = point, minus = point;
+        plus(p) += h;
+        minus(p) -= h;
+        const double difference =
+            (sweepIae(config, options, {plus(0), plus(1), plus(2)}) -
+             sweepIae(config, options, {minus(0), minus(1), minus(2)})) / (2.0 * h);
+        EXPECT_NEAR(evaluation.gradient(p), difference,
+                    1e-5 * evaluation.gradient.norm()) << "parameter " << p;
+    }
+    EXPECT_NE(evaluation.gradient(GainTuner::KC), 0.0);
+}
+
+// Test: A loop that is saturated throughout passes no gain derivative
+TEST_F(GainTunerTest, SaturatedLoopHasZeroSubgradient) {
+    Simulator::Config config = createSteadyStateConfig();
+    // Limits pinned below the bias: the output sits at the limit every step
+    config.controllerConfig[0].minOutputLimit = 0.3;
+    config.controllerConfig[0].maxOutputLimit = 0.3;
+    const GainTuner tuner(config, stepOptions());
+
+    const GainTuner::Evaluation evaluation = tuner.evaluate({-1.0, 10.0, 1.0});
+    EXPECT_GT(evaluation.iae, 0.0);
+    EXPECT_EQ(evaluation.gradient, Eigen::Vector3d::Zero());
+}
+
+// Test: tune() improves on its start, stays in the box and beats a coarse grid
+TEST_F(GainTunerTest, TuneImprovesOnStartAndGrid) {
+    const Simulator::Config config = createSteadyStateConfig();
+    const GainTuner::Options options = stepOptions();
+    const GainTuner tuner(config, options);
+    const PIDController::Gains start{-0.2, 200.0, 0.0};
+
+    const GainTuner::Result result = tuner.tune(start);
+    EXPECT_LT(result.iae, 0.5 * tuner.evaluate(start).iae);
+    EXPECT_GE(result.evaluations, result.iterations + 1);
+    EXPECT_GE(result.gains.Kc, options.lower.Kc);
+    EXPECT_LE(result.gains.Kc, options.upper.Kc);
+    EXPECT_GE(result.gains.tau_I, options.lower.tau_I);
+    EXPECT_LE(result.gains.tau_I, options.upper.tau_I);
+    EXPECT_GE(result.gains.tau_D, options.lower.tau_D);
+    EXPECT_LE(result.gains.tau_D, options.upper.tau_D);
+    EXPECT_DOUBLE_EQ(result.iae, tuner.evaluate(result.gains).iae);
+
+    // A 5 x 5 x 3 grid takes more runs and does not find a lower IAE
+    ParameterSweep::Options sweepOptions;
+    sweepOptions.steps = options.steps;
+    sweepOptions.setpoint = options.setpoint;
+    const auto grid = ParameterSweep::makeGrid({-5.0, -2.0, -1.0, -0.5, -0.1},
+                                               {5.0, 20.0, 50.0, 200.0, 500.0},
+                                               {0.0, 5.0, 20.0});
+    double best = INFINITY;
+    for (const auto &metrics : ParameterSweep(config, sweepOptions).run(grid)) {
+        best = std::min(best, metrics.iae);
+    }
+    EXPECT_LT(result.evaluations, static_cast<int>(grid.size()));
+    EXPECT_LE(result.iae, best);
+}
+
+// Test: A gain with lower == upper is held at that value
+TEST_F(GainTunerTest, HeldGainsStayFixed) {
+    GainTuner::Options options = stepOptions();
+    options.lower.tau_D = options.upper.tau_D = 0.0;
+    options.lower.Kc = options.upper.Kc = -1.0;
+    const GainTuner tuner(createSteadyStateConfig(), options);
+
+    const GainTuner::Result result = tuner.tune({-3.0, 100.0, 5.0});
+    EXPECT_EQ(result.gains.Kc, -1.0);
+    EXPECT_EQ(result.gains.tau_D, 0.0);
+    EXPECT_LE(result.iae, tuner.evaluate({-1.0, 100.0, 0.0}).iae);
+}
+
+// Test: Invalid options, configs and gains are rejected
+TEST_F(GainTunerTest, Validation) {
+    const Simulator::Config config = createSteadyStateConfig();
+    GainTuner::Options options = stepOptions();
+
+    options.steps = 0;
+    EXPECT_THROW(GainTuner(config, options), std::invalid_argument);
+    options = stepOptions();
+    options.controllerIndex = 1;
+    EXPECT_THROW(GainTuner(config, options), std::invalid_argument);
+    options = stepOptions();
+    options.maxIterations = 0;
+    EXPECT_THROW(GainTuner(config, options), std::invalid_argument);
+    options = stepOptions();
+    options.tolerance = 0.0;
+    EXPECT_THROW(GainTuner(config, options), std::invalid_argument);
+    options = stepOptions();
+    options.lower.Kc = 0.0;  // Above upper.Kc
+    EXPECT_THROW(GainTuner(config, options), std::invalid_argument);
+    options = stepOptions();
+    options.lower.tau_D = -1.0;
+    EXPECT_THROW(GainTuner(config, options), std::invalid_argument);
+    options = stepOptions();
+    options.upper.tau_I = NAN;
+    EXPECT_THROW(GainTuner(config, options), std::invalid_argument);
+
+    Simulator::Config rosenbrock = config;
+    rosenbrock.integrator = Simulator::Integrator::Rosenbrock;
+    EXPECT_THROW(GainTuner(rosenbrock, stepOptions()), std::invalid_argument);
+    Simulator::Config broken = config;
+    broken.dt = -1.0;
+    EXPECT_THROW(GainTuner(broken, stepOptions()), std::invalid_argument);
+
+    const GainTuner tuner(config, stepOptions());
+    EXPECT_THROW(tuner.evaluate({-1.0, -10.0, 0.0}), std::invalid_argument);
+}
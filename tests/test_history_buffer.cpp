@@ -0,0 +1,197 @@
+#include <gtest/gtest.h>
+#include <Eigen/Dense>
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+#include "../src/history_buffer.h"
+#include "../src/simulator.h"
+#include "../src/constants.h"
+
+using namespace tank_sim;
+using namespace tank_sim::constants;
+
+class HistoryBufferTest : public ::testing::Test {
+protected:
+    // Sample whose every signal encodes its sequence number
+    static HistoryBuffer::Sample sampleFor(double value) {
+        HistoryBuffer::Sample sample;
+        for (int s = 0; s < HistoryBuffer::SIGNAL_COUNT; ++s) {
+            sample[s] = value + 0.125 * s;
+        }
+        return sample;
+    }
+
+    static void fill(HistoryBuffer &buffer, int count, int start = 0) {
+        for (int k = start; k < start + count; ++k) {
+            buffer.append(sampleFor(k));
+        }
+    }
+};
+
+// Test: Window lookup by time before the buffer wraps
+TEST_F(HistoryBufferTest, WindowBeforeWrap) {
+    HistoryBuffer buffer(10);
+    EXPECT_EQ(buffer.size(), 0);
+    EXPECT_EQ(buffer.window(0.0, 100.0).count, 0);
+
+    fill(buffer, 6);  // times 0..5
+    EXPECT_EQ(buffer.size(), 6);
+
+    HistoryBuffer::Window w = buffer.window(1.5, 4.0);
+    EXPECT_EQ(w.begin, 2u);
+    ASSERT_EQ(w.count, 3);
+    const double *time = buffer.data(HistoryBuffer::TIME, w);
+    const double *level = buffer.data(HistoryBuffer::TANK_LEVEL, w);
+    EXPECT_DOUBLE_EQ(time[0], 2.0);
+    EXPECT_DOUBLE_EQ(time[2], 4.0);
+    EXPECT_DOUBLE_EQ(level[1], 3.125);
+    EXPECT_TRUE(buffer.isValid(w));
+}
+
+// Test: A window spanning the wrap point is still contiguous per signal
+TEST_F(HistoryBufferTest, WindowAcrossWrapIsContiguous) {
+    HistoryBuffer buffer(8);
+    fill(buffer, 21);  // retains times 13..20
+
+    EXPECT_EQ(buffer.size(), 8);
+    EXPECT_EQ(buffer.head(), 21u);
+
+    HistoryBuffer::Window all = buffer.window(-1.0, 1e9);
+    EXPECT_EQ(all.begin, 13u);
+    ASSERT_EQ(all.count, 8);
+    const double *time = buffer.data(HistoryBuffer::TIME, all);
+    const double *output = buffer.data(HistoryBuffer::CONTROLLER_OUTPUT, all);
+    for (Eigen::Index k = 0; k < all.count; ++k) {
+        EXPECT_DOUBLE_EQ(time[k], 13.0 + k);
+        EXPECT_DOUBLE_EQ(output[k], 13.0 + k + 0.875);
+    }
+
+    // Older samples are gone
+    EXPECT_EQ(buffer.window(0.0, 12.5).count, 0);
+}
+
+// Test: latest(n) and validity once the writer laps a window
+TEST_F(HistoryBufferTest, LatestAndInvalidation) {
+    HistoryBuffer buffer(5);
+    fill(buffer, 3);
+
+    HistoryBuffer::Window w = buffer.latest(10);
+    EXPECT_EQ(w.begin, 0u);
+    EXPECT_EQ(w.count, 3);
+
+    fill(buffer, 2, 3);
+    EXPECT_TRUE(buffer.isValid(w)) << "Still within capacity";
+    fill(buffer, 1, 5);
+    EXPECT_FALSE(buffer.isValid(w)) << "Oldest sample was overwritten";
+
+    EXPECT_EQ(buffer.latest(2).begin, 4u);
+    EXPECT_EQ(buffer.latest(0).count, 0);
+}
+
+// Test: copyWindow trims lapped samples and returns a consistent copy
+TEST_F(HistoryBufferTest, CopyWindowTrimsLappedSamples) {
+    HistoryBuffer buffer(4);
+    fill(buffer, 4);
+    HistoryBuffer::Window stale = buffer.latest(4);  // times 0..3
+    fill(buffer, 2, 4);                              // now 2..5
+
+    HistoryBuffer::SignalMatrix out;
+    HistoryBuffer::Window copied = buffer.copyWindow(stale, out);
+    EXPECT_EQ(copied.begin, 2u);
+    ASSERT_EQ(out.cols(), 2);
+    EXPECT_DOUBLE_EQ(out(HistoryBuffer::TIME, 0), 2.0);
+    EXPECT_DOUBLE_EQ(out(HistoryBuffer::TIME, 1), 3.0);
+}
+
+// Test: clear() and validation
+TEST_F(HistoryBufferTest, ClearAndValidation) {
+    EXPECT_THROW(HistoryBuffer(0), std::invalid_argument);
+
+    HistoryBuffer buffer(3);
+    fill(buffer, 5);
+    buffer.clear();
+    EXPECT_EQ(buffer.size(), 0);
+    EXPECT_EQ(buffer.head(), 0u);
+    fill(buffer, 1, 100);
+    EXPECT_DOUBLE_EQ(buffer.data(HistoryBuffer::TIME, buffer.latest(1))[0], 100.0);
+}
+
+// Test: Concurrent reader copies are never torn
+TEST_F(HistoryBufferTest, ConcurrentReaderSeesConsistentSnapshots) {
+    HistoryBuffer buffer(64);
+    std::atomic<bool> done{false};
+
+    std::thread writer([&]() {
+        for (int k = 0; k < 200000; ++k) {
+            buffer.append(sampleFor(k));
+        }
+        done.store(true);
+    });
+
+    HistoryBuffer::SignalMatrix out;
+    int checked = 0;
+    while (!done.load() || checked == 0) {
+        buffer.copyWindow(buffer.latest(64), out);
+        for (Eigen::Index k = 0; k < out.cols(); ++k) {
+            const double t = out(HistoryBuffer::TIME, k);
+            ASSERT_DOUBLE_EQ(out(HistoryBuffer::CONTROL_ERROR, k), t + 0.75);
+            if (k > 0) {
+                ASSERT_DOUBLE_EQ(t, out(HistoryBuffer::TIME, k - 1) + 1.0);
+            }
+        }
+        ++checked;
+    }
+    writer.join();
+    EXPECT_GT(checked, 0);
+}
+
+// Test: Simulator history matches a Trajectory recorded over the same run
+TEST_F(HistoryBufferTest, SimulatorRecordsEveryStep) {
+    Simulator::Config config;
+    config.params = TankModel::Parameters{DEFAULT_TANK_AREA, DEFAULT_VALVE_COEFFICIENT,
+                                          TANK_MAX_HEIGHT};
+    config.initialState = Eigen::VectorXd(1);
+    config.initialState << TANK_NOMINAL_HEIGHT;
+    config.initialInputs = Eigen::VectorXd(2);
+    config.initialInputs << TEST_INLET_FLOW, TEST_VALVE_POSITION;
+    config.dt = TEST_DT;
+    Simulator::ControllerConfig ctrl;
+    ctrl.gains = PIDController::Gains{-1.0, 10.0, 0.0};
+    ctrl.bias = 0.5;
+    ctrl.minOutputLimit = 0.0;
+    ctrl.maxOutputLimit = 1.0;
+    ctrl.maxIntegralAccumulation = 10.0;
+    ctrl.measuredIndex = 0;
+    ctrl.outputIndex = 1;
+    ctrl.initialSetpoint = TANK_NOMINAL_HEIGHT;
+    config.controllerConfig.push_back(ctrl);
+
+    Simulator plain(config);
+    EXPECT_EQ(plain.getHistory(), nullptr);
+
+    config.historyCapacity = 50;
+    Simulator sim(config);
+    sim.setSetpoint(0, 3.0);
+    plain.setSetpoint(0, 3.0);
+    Trajectory trajectory = plain.makeTrajectory(80);
+    sim.run(80);
+    plain.run(80, trajectory);
+
+    const HistoryBuffer *history = sim.getHistory();
+    ASSERT_NE(history, nullptr);
+    HistoryBuffer::Window w = history->latest(50);
+    ASSERT_EQ(w.count, 50);
+    const double *level = history->data(HistoryBuffer::TANK_LEVEL, w);
+    const double *error = history->data(HistoryBuffer::CONTROL_ERROR, w);
+    for (Eigen::Index k = 0; k < w.count; ++k) {
+        EXPECT_EQ(level[k], trajectory.state(0, 30 + k));
+        EXPECT_EQ(error[k], trajectory.error(0, 30 + k));
+    }
+    EXPECT_EQ(history->window(sim.getTime() - 9.5 * TEST_DT, sim.getTime()).count, 10);
+
+    sim.reset();
+    EXPECT_EQ(sim.getHistory()->size(), 0);
+
+    config.historyCapacity = -1;
+    EXPECT_THROW(Simulator{config}, std::invalid_argument);
+}
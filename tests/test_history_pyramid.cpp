@@ -0,0 +1,185 @@
+#include <gtest/gtest.h>
+#include <Eigen/Dense>
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+#include "../src/history_pyramid.h"
+#include "../src/simulator.h"
+#include "../src/constants.h"
+
+using namespace tank_sim;
+using namespace tank_sim::constants;
+
+class HistoryPyramidTest : public ::testing::Test {
+protected:
+    // Sample at integer time k with signals that are not monotonic in k
+    static HistoryBuffer::Sample sampleFor(int k) {
+        HistoryBuffer::Sample sample;
+        sample[HistoryBuffer::TIME] = k;
+        for (int s = 1; s < HistoryBuffer::SIGNAL_COUNT; ++s) {
+            sample[s] = ((k * 7 + s * 3) % 11) - 0.5 * s;
+        }
+        return sample;
+    }
+
+    static void fill(HistoryPyramid &pyramid, int count, int start = 0) {
+        for (int k = start; k < start + count; ++k) {
+            pyramid.append(sampleFor(k));
+        }
+    }
+
+    static int row(int signal, int stat) {
+        return signal * HistoryPyramid::STAT_COUNT + stat;
+    }
+
+    // Checks bucket column k against a brute-force pass over samples [first, first + n)
+    static void expectBucket(const HistoryPyramid::Buckets &buckets, Eigen::Index k,
+                             int first, int n) {
+        ASSERT_LT(k, buckets.stats.cols());
+        EXPECT_EQ(buckets.count(k), n);
+        for (int s = 0; s < HistoryBuffer::SIGNAL_COUNT; ++s) {
+            double lo = sampleFor(first)[s], hi = lo, sum = 0.0;
+            for (int j = first; j < first + n; ++j) {
+                lo = std::min(lo, sampleFor(j)[s]);
+                hi = std::max(hi, sampleFor(j)[s]);
+                sum += sampleFor(j)[s];
+            }
+            EXPECT_DOUBLE_EQ(buckets.stats(row(s, HistoryPyramid::MIN), k), lo);
+            EXPECT_DOUBLE_EQ(buckets.stats(row(s, HistoryPyramid::MAX), k), hi);
+            EXPECT_NEAR(buckets.stats(row(s, HistoryPyramid::MEAN), k), sum / n, 1e-12);
+            EXPECT_DOUBLE_EQ(buckets.stats(row(s, HistoryPyramid::LAST), k),
+                             sampleFor(first + n - 1)[s]);
+        }
+    }
+};
+
+// Test: Every level matches statistics computed directly from samples
+TEST_F(HistoryPyramidTest, BucketsMatchBruteForce) {
+    HistoryPyramid pyramid({{2, 100}, {6, 100}, {24, 100}});
+    fill(pyramid, 50);
+
+    HistoryPyramid::Buckets fine = pyramid.query(0, 0.0, 1e9);
+    ASSERT_EQ(fine.stats.cols(), 25);
+    for (Eigen::Index k = 0; k < 25; ++k) {
+        expectBucket(fine, k, static_cast<int>(2 * k), 2);
+    }
+
+    // 50 samples at factor 24: two complete buckets and a partial of 2
+    HistoryPyramid::Buckets coarse = pyramid.query(2, 0.0, 1e9);
+    ASSERT_EQ(coarse.stats.cols(), 3);
+    expectBucket(coarse, 0, 0, 24);
+    expectBucket(coarse, 1, 24, 24);
+    expectBucket(coarse, 2, 48, 2);
+}
+
+// Test: The partial bucket merges the running buckets of all finer levels
+TEST_F(HistoryPyramidTest, PartialBucketCoversUnforwardedSamples) {
+    HistoryPyramid pyramid({{3, 10}, {9, 10}});
+    fill(pyramid, 16);  // 1 complete level 1 bucket, then 2 level 0 buckets + 1 sample
+
+    HistoryPyramid::Buckets coarse = pyramid.query(1, 0.0, 1e9);
+    ASSERT_EQ(coarse.stats.cols(), 2);
+    expectBucket(coarse, 0, 0, 9);
+    expectBucket(coarse, 1, 9, 7);
+
+    HistoryPyramid::Buckets fine = pyramid.query(0, 14.5, 20.0);
+    ASSERT_EQ(fine.stats.cols(), 1);
+    expectBucket(fine, 0, 15, 1);
+}
+
+// Test: Time ranges and wraparound select the expected buckets
+TEST_F(HistoryPyramidTest, QueryRangeAcrossWrap) {
+    HistoryPyramid pyramid({{4, 5}});
+    fill(pyramid, 40);  // retains buckets starting at 20, 24, 28, 32, 36
+
+    HistoryPyramid::Buckets all = pyramid.query(0, -1.0, 1e9);
+    ASSERT_EQ(all.stats.cols(), 5);
+    for (Eigen::Index k = 0; k < 5; ++k) {
+        expectBucket(all, k, static_cast<int>(20 + 4 * k), 4);
+    }
+
+    // Overlap is inclusive at both ends: [27, 29] touches buckets 24..27 and 28..31
+    HistoryPyramid::Buckets some = pyramid.query(0, 27.0, 29.0);
+    ASSERT_EQ(some.stats.cols(), 2);
+    expectBucket(some, 0, 24, 4);
+    expectBucket(some, 1, 28, 4);
+    EXPECT_EQ(pyramid.countBuckets(0, 27.0, 29.0), 2);
+
+    EXPECT_EQ(pyramid.query(0, 0.0, 19.0).stats.cols(), 0) << "Overwritten";
+    EXPECT_EQ(pyramid.countBuckets(0, 100.0, 200.0), 0);
+}
+
+// Test: selectLevel honours the point budget and the retained span
+TEST_F(HistoryPyramidTest, SelectLevelByBudgetAndCoverage) {
+    HistoryPyramid pyramid({{1, 50}, {10, 50}, {100, 50}});
+    fill(pyramid, 1000);  // level 0 keeps 950..999, level 1 keeps 500..999
+
+    EXPECT_EQ(pyramid.selectLevel(960.0, 999.0, 100), 0);
+    EXPECT_EQ(pyramid.selectLevel(960.0, 999.0, 20), 1) << "Level 0 needs 40 points";
+    EXPECT_EQ(pyramid.selectLevel(600.0, 999.0, 1000), 1) << "Level 0 starts at 950";
+    EXPECT_EQ(pyramid.selectLevel(0.0, 999.0, 1000), 2) << "Only level 2 covers t = 0";
+    EXPECT_EQ(pyramid.selectLevel(0.0, 999.0, 1), 2) << "Falls back to the coarsest";
+    EXPECT_THROW(pyramid.selectLevel(0.0, 1.0, 0), std::invalid_argument);
+}
+
+// Test: Construction checks and clear()
+TEST_F(HistoryPyramidTest, ValidationAndClear) {
+    EXPECT_THROW(HistoryPyramid(std::vector<HistoryPyramid::Level>{}), std::invalid_argument);
+    EXPECT_THROW(HistoryPyramid({{0, 10}}), std::invalid_argument);
+    EXPECT_THROW(HistoryPyramid({{2, 0}}), std::invalid_argument);
+    EXPECT_THROW(HistoryPyramid({{4, 10}, {6, 10}}), std::invalid_argument);
+
+    HistoryPyramid pyramid({{2, 4}, {4, 4}});
+    EXPECT_EQ(pyramid.getLevelCount(), 2);
+    EXPECT_EQ(pyramid.getLevel(1).factor, 4);
+    EXPECT_THROW(pyramid.getLevel(2), std::out_of_range);
+    EXPECT_THROW(pyramid.query(-1, 0.0, 1.0), std::out_of_range);
+
+    fill(pyramid, 9);
+    pyramid.clear();
+    EXPECT_EQ(pyramid.query(1, -1e9, 1e9).stats.cols(), 0);
+    fill(pyramid, 3, 100);
+    HistoryPyramid::Buckets fine = pyramid.query(0, -1e9, 1e9);
+    ASSERT_EQ(fine.stats.cols(), 2);
+    expectBucket(fine, 0, 100, 2);
+    expectBucket(fine, 1, 102, 1);
+}
+
+// Test: Simulator feeds the pyramid the same samples as the raw history
+TEST_F(HistoryPyramidTest, SimulatorFeedsPyramid) {
+    Simulator::Config config;
+    config.params = TankModel::Parameters{DEFAULT_TANK_AREA, DEFAULT_VALVE_COEFFICIENT,
+                                          TANK_MAX_HEIGHT};
+    config.initialState = Eigen::VectorXd(1);
+    config.initialState << TANK_NOMINAL_HEIGHT;
+    config.initialInputs = Eigen::VectorXd(2);
+    config.initialInputs << TEST_INLET_FLOW, TEST_VALVE_POSITION;
+    config.dt = TEST_DT;
+    config.historyCapacity = 100;
+    config.historyLevels = {{10, 20}};
+
+    Simulator sim(config);
+    sim.run(100);
+
+    const HistoryBuffer *history = sim.getHistory();
+    const HistoryPyramid *pyramid = sim.getHistoryPyramid();
+    ASSERT_NE(pyramid, nullptr);
+    HistoryPyramid::Buckets buckets = pyramid->query(0, -1.0, 1e9);
+    ASSERT_EQ(buckets.stats.cols(), 10);
+
+    HistoryBuffer::Window all = history->latest(100);
+    const double *level = history->data(HistoryBuffer::TANK_LEVEL, all);
+    for (Eigen::Index k = 0; k < 10; ++k) {
+        const double *bucket = level + 10 * k;
+        EXPECT_DOUBLE_EQ(buckets.stats(row(HistoryBuffer::TANK_LEVEL, HistoryPyramid::MIN), k),
+                         *std::min_element(bucket, bucket + 10));
+        EXPECT_DOUBLE_EQ(buckets.stats(row(HistoryBuffer::TANK_LEVEL, HistoryPyramid::LAST), k),
+                         bucket[9]);
+    }
+
+    sim.reset();
+    EXPECT_EQ(sim.getHistoryPyramid()->query(0, -1.0, 1e9).stats.cols(), 0);
+
+    config.historyLevels = {{10, 20}, {15, 20}};
+    EXPECT_THROW(Simulator{config}, std::invalid_argument);
+}
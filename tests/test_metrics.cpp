@@ -0,0 +1,110 @@
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <cmath>
+#include <numeric>
+#include "../src/metrics.h"
+
+using namespace tank_sim;
+
+namespace {
+
+std::uint64_t histogramTotal(const Metrics::Report &report) {
+    return std::accumulate(report.latencyCounts.begin(), report.latencyCounts.end(),
+                           std::uint64_t{0});
+}
+
+}  // namespace
+
+// Test: Latencies land in log2 buckets, with the last bucket open-ended
+TEST(MetricsTest, BucketOfIsLog2) {
+    EXPECT_EQ(Metrics::bucketOf(0), 0);
+    EXPECT_EQ(Metrics::bucketOf(1), 0);
+    EXPECT_EQ(Metrics::bucketOf(2), 1);
+    EXPECT_EQ(Metrics::bucketOf(3), 1);
+    EXPECT_EQ(Metrics::bucketOf(1024), 10);
+    EXPECT_EQ(Metrics::bucketOf(2047), 10);
+    EXPECT_EQ(Metrics::bucketOf(UINT64_MAX), Metrics::HISTOGRAM_BUCKETS - 1);
+}
+
+#if TANK_SIM_METRICS
+
+// Test: Recorded work, phases and latencies all appear in the report
+TEST(MetricsTest, ReportAccumulates) {
+    Metrics metrics;
+    metrics.addWork(2, 8, 1);
+    metrics.addWork(1, 4);
+    metrics.addPhase(Metrics::CONTROL, 100);
+    metrics.recordStep(3);
+    metrics.recordStep(1000);
+
+    const Metrics::Report report = metrics.report();
+    EXPECT_TRUE(report.enabled);
+    EXPECT_EQ(report.steps, 3u);
+    EXPECT_EQ(report.derivativeEvaluations, 12u);
+    EXPECT_EQ(report.jacobianEvaluations, 1u);
+    EXPECT_DOUBLE_EQ(report.phaseSeconds[Metrics::CONTROL],
+                     100 * Metrics::secondsPerTick());
+    EXPECT_EQ(report.phaseSeconds[Metrics::INTEGRATION], 0.0);
+    EXPECT_DOUBLE_EQ(report.stepSeconds, 1003 * Metrics::secondsPerTick());
+    EXPECT_EQ(report.latencyCounts[1], 1u);
+    EXPECT_EQ(report.latencyCounts[9], 1u);
+    EXPECT_EQ(histogramTotal(report), 2u);
+
+    // Bucket bounds increase and the last is unbounded
+    for (int b = 1; b < Metrics::HISTOGRAM_BUCKETS; ++b) {
+        EXPECT_GT(report.latencyUpperBounds[b], report.latencyUpperBounds[b - 1]);
+    }
+    EXPECT_TRUE(std::isinf(report.latencyUpperBounds.back()));
+}
+
+// Test: StepTimer attributes time to phases and records one step
+TEST(MetricsTest, StepTimerRecordsPhasesAndLatency) {
+    Metrics metrics;
+    {
+        StepTimer timer(metrics);
+        volatile double sink = 0.0;
+        for (int i = 0; i < 1000; ++i) {
+            sink = sink + i;
+        }
+        timer.mark(Metrics::INTEGRATION);
+        timer.mark(Metrics::CONTROL);
+    }
+    const Metrics::Report report = metrics.report();
+    EXPECT_GT(report.phaseSeconds[Metrics::INTEGRATION], 0.0);
+    EXPECT_GE(report.stepSeconds, report.phaseSeconds[Metrics::INTEGRATION] +
+                                      report.phaseSeconds[Metrics::CONTROL]);
+    EXPECT_EQ(histogramTotal(report), 1u);
+}
+
+// Test: Copies snapshot the values; clear() zeroes everything
+TEST(MetricsTest, CopyAndClear) {
+    Metrics metrics;
+    metrics.addWork(5, 20);
+    metrics.recordStep(7);
+
+    Metrics copy = metrics;
+    metrics.clear();
+    EXPECT_EQ(copy.report().steps, 5u);
+    EXPECT_EQ(histogramTotal(copy.report()), 1u);
+
+    const Metrics::Report cleared = metrics.report();
+    EXPECT_EQ(cleared.steps, 0u);
+    EXPECT_EQ(cleared.derivativeEvaluations, 0u);
+    EXPECT_EQ(cleared.stepSeconds, 0.0);
+    EXPECT_EQ(histogramTotal(cleared), 0u);
+}
+
+#else
+
+// Test: With instrumentation compiled out the report is empty
+TEST(MetricsTest, DisabledReportIsEmpty) {
+    Metrics metrics;
+    metrics.addWork(5, 20);
+    metrics.recordStep(7);
+    const Metrics::Report report = metrics.report();
+    EXPECT_FALSE(report.enabled);
+    EXPECT_EQ(report.steps, 0u);
+    EXPECT_EQ(histogramTotal(report), 0u);
+}
+
+#endif
@@ -0,0 +1,203 @@
+#include <gtest/gtest.h>
+#include <Eigen/Dense>
+#include <cmath>
+#include "../src/network_simulator.h"
+#include "../src/simulator.h"
+#include "../src/constants.h"
+
+using namespace tank_sim;
+using namespace tank_sim::constants;
+
+
+class NetworkSimulatorTest : public ::testing::Test {
+protected:
+    TankModel::Parameters params{
+        DEFAULT_TANK_AREA,
+        DEFAULT_VALVE_COEFFICIENT,
+        TANK_MAX_HEIGHT
+    };
+
+    // Reverse-acting level loop on tank `tank`, driving valve input `output`.
+    // Tight proportional action keeps the train from amplifying level swings
+    // from one tank to the next.
+    static Simulator::ControllerConfig levelLoop(int tank, int output,
+                                                 double setpoint) {
+        Simulator::ControllerConfig ctrl;
+        ctrl.gains = PIDController::Gains{-3.0, 200.0, 0.0};
+        ctrl.bias = 0.5;
+        ctrl.minOutputLimit = 0.0;
+        ctrl.maxOutputLimit = 1.0;
+        ctrl.maxIntegralAccumulation = 10.0;
+        ctrl.measuredIndex = tank;
+        ctrl.outputIndex = output;
+        ctrl.initialSetpoint = setpoint;
+        return ctrl;
+    }
+
+    // tanks in series at steady state, one level loop per tank
+    NetworkSimulator::Config createCascadeConfig(int tanks) {
+        NetworkSimulator::Config config;
+        config.network = PlantNetwork::cascade(tanks, params);
+        config.initialState = Eigen::VectorXd::Constant(tanks, TANK_NOMINAL_HEIGHT);
+        config.initialInputs =
+            Eigen::VectorXd::Constant(tanks + 1, TEST_VALVE_POSITION);
+        config.initialInputs(0) = TEST_INLET_FLOW;
+        config.dt = TEST_DT;
+        for (int i = 0; i < tanks; ++i) {
+            config.controllerConfig.push_back(
+                levelLoop(i, i + 1, TANK_NOMINAL_HEIGHT));
+        }
+        return config;
+    }
+};
+
+// A one-tank network reproduces the fixed-size Simulator
+TEST_F(NetworkSimulatorTest, SingleTankMatchesSimulator) {
+    NetworkSimulator::Config config = createCascadeConfig(1);
+    config.controllerConfig[0].initialSetpoint = 3.0;
+
+    Simulator::Config reference;
+    reference.params = params;
+    reference.initialState = config.initialState;
+    reference.initialInputs = config.initialInputs;
+    reference.dt = config.dt;
+    reference.controllerConfig = config.controllerConfig;
+
+    NetworkSimulator network(config);
+    Simulator sim(reference);
+    for (int k = 0; k < 500; ++k) {
+        network.step();
+        sim.step();
+        ASSERT_NEAR(network.getState()(0), sim.getState()(0), 1e-12) << "step " << k;
+        ASSERT_NEAR(network.getInputs()(1), sim.getInputs()(1), 1e-12);
+    }
+    EXPECT_DOUBLE_EQ(network.getTime(), sim.getTime());
+    EXPECT_NEAR(network.getError(0), sim.getError(0), 1e-12);
+    EXPECT_NEAR(network.getValveFlows()(0), sim.getOutletFlow(), 1e-12);
+}
+
+// Hundreds of loops reject an inlet disturbance that ripples down the train
+TEST_F(NetworkSimulatorTest, LargeCascadeSettlesAfterDisturbance) {
+    const int tanks = 200;
+    NetworkSimulator sim(createCascadeConfig(tanks));
+    ASSERT_EQ(sim.getControllerCount(), tanks);
+
+    const double disturbed = 0.9 * TEST_INLET_FLOW;
+    sim.setInput(INPUT_INDEX_INLET_FLOW, disturbed);
+    sim.run(20000);
+
+    const Eigen::VectorXd flows = sim.getValveFlows();
+    for (int i = 0; i < tanks; ++i) {
+        EXPECT_NEAR(sim.getState()(i), TANK_NOMINAL_HEIGHT, 1e-3) << "tank " << i;
+        EXPECT_NEAR(flows(i), disturbed, 1e-3) << "valve " << i;
+    }
+}
+
+TEST_F(NetworkSimulatorTest, RunRecordsTrajectoryAndResetRestores) {
+    NetworkSimulator::Config config = createCascadeConfig(3);
+    config.controllerConfig[1].initialSetpoint = 3.0;
+    NetworkSimulator sim(config);
+
+    Trajectory trajectory = sim.makeTrajectory(20);
+    EXPECT_EQ(trajectory.state.rows(), 3);
+    EXPECT_EQ(trajectory.inputs.rows(), 4);
+    EXPECT_EQ(trajectory.setpoint.rows(), 3);
+    sim.run(20, trajectory);
+    ASSERT_EQ(trajectory.size(), 20);
+    EXPECT_DOUBLE_EQ(trajectory.time(19), sim.getTime());
+    for (int i = 0; i < 3; ++i) {
+        EXPECT_EQ(trajectory.state(i, 19), sim.getState()(i));
+        EXPECT_EQ(trajectory.controllerOutput(i, 19), sim.getControllerOutput(i));
+        EXPECT_EQ(trajectory.error(i, 19), sim.getError(i));
+    }
+    EXPECT_THROW(sim.run(1, trajectory), std::invalid_argument);
+
+    sim.setSetpoint(0, 4.0);
+    sim.reset();
+    EXPECT_EQ(sim.getTime(), 0.0);
+    EXPECT_EQ(sim.getState(), config.initialState);
+    EXPECT_EQ(sim.getInputs(), config.initialInputs);
+    EXPECT_EQ(sim.getSetpoint(0), TANK_NOMINAL_HEIGHT);
+
+    // Same trajectory again after reset
+    Trajectory replay = sim.makeTrajectory(20);
+    sim.run(20, replay);
+    EXPECT_EQ(replay.state, trajectory.state);
+}
+
+// A 0.05 m² surge vessel behind a 120 m² tank has a ~0.1 s time
+// constant. RK4 at dt = 1 s is outside its stability region; Rosenbrock
+// at the same dt tracks an RK4 reference run 100x finer.
+TEST_F(NetworkSimulatorTest, RosenbrockIsStableOnStiffNetwork) {
+    NetworkSimulator::Config config;
+    config.network.tanks = {{DEFAULT_TANK_AREA, TANK_MAX_HEIGHT}, {0.05, 2.0}};
+    config.network.inflows = {{0, INPUT_INDEX_INLET_FLOW}};
+    config.network.valves = {
+        {0, 1, DEFAULT_VALVE_COEFFICIENT, INPUT_INDEX_VALVE_POSITION},
+        {1, PlantNetwork::DRAIN, 1.0, PlantNetwork::FULLY_OPEN}};
+    config.network.inputCount = 2;
+    config.initialState = Eigen::Vector2d(TANK_NOMINAL_HEIGHT, 0.5);
+    config.initialInputs = Eigen::Vector2d(TEST_INLET_FLOW, TEST_VALVE_POSITION);
+    config.controllerConfig = {levelLoop(0, INPUT_INDEX_VALVE_POSITION, 3.0)};
+
+    NetworkSimulator::Config fine = config;
+    fine.dt = 0.01;
+    NetworkSimulator reference(fine);
+    reference.run(60000);
+
+    config.dt = 1.0;
+    NetworkSimulator explicit_sim(config);
+    explicit_sim.run(600);
+    const double explicit_error =
+        (explicit_sim.getState() - reference.getState()).cwiseAbs().maxCoeff();
+    EXPECT_FALSE(explicit_error < 0.1) << "RK4 unexpectedly stable";
+
+    config.integrator = Simulator::Integrator::Rosenbrock;
+    NetworkSimulator implicit_sim(config);
+    implicit_sim.run(600);
+    EXPECT_NEAR(implicit_sim.getState()(0), reference.getState()(0), 1e-2);
+    EXPECT_NEAR(implicit_sim.getState()(1), reference.getState()(1), 1e-2);
+}
+
+// Rosenbrock on a long cascade takes the same path as RK4 when not stiff
+TEST_F(NetworkSimulatorTest, RosenbrockMatchesRk4OnCascade) {
+    NetworkSimulator::Config config = createCascadeConfig(50);
+    config.controllerConfig[0].initialSetpoint = 3.0;
+    NetworkSimulator rk4_sim(config);
+    config.integrator = Simulator::Integrator::Rosenbrock;
+    NetworkSimulator implicit_sim(config);
+    rk4_sim.run(500);
+    implicit_sim.run(500);
+    EXPECT_LT((implicit_sim.getState() - rk4_sim.getState()).cwiseAbs().maxCoeff(),
+              1e-3);
+}
+
+TEST_F(NetworkSimulatorTest, RejectsInconsistentConfig) {
+    NetworkSimulator::Config config = createCascadeConfig(4);
+    config.initialState = Eigen::VectorXd::Zero(3);
+    EXPECT_THROW(NetworkSimulator{config}, std::invalid_argument);
+
+    config = createCascadeConfig(4);
+    config.initialInputs = Eigen::VectorXd::Zero(2);
+    EXPECT_THROW(NetworkSimulator{config}, std::invalid_argument);
+
+    config = createCascadeConfig(4);
+    config.dt = 0.0;
+    EXPECT_THROW(NetworkSimulator{config}, std::invalid_argument);
+
+    config = createCascadeConfig(4);
+    config.integrator = Simulator::Integrator::AdaptiveRKF45;
+    EXPECT_THROW(NetworkSimulator{config}, std::invalid_argument);
+
+    config = createCascadeConfig(4);
+    config.controllerConfig[2].measuredIndex = 4;
+    EXPECT_THROW(NetworkSimulator{config}, std::invalid_argument);
+
+    config = createCascadeConfig(4);
+    config.controllerConfig[2].outputIndex = 5;
+    EXPECT_THROW(NetworkSimulator{config}, std::invalid_argument);
+
+    NetworkSimulator sim(createCascadeConfig(4));
+    EXPECT_THROW(sim.getSetpoint(4), std::out_of_range);
+    EXPECT_THROW(sim.setInput(5, 0.0), std::out_of_range);
+}
@@ -0,0 +1,161 @@
+#include <gtest/gtest.h>
+#include <Eigen/Dense>
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include "../src/parameter_sweep.h"
+#include "../src/simulator.h"
+#include "../src/constants.h"
+
+using namespace tank_sim;
+using namespace tank_sim::constants;
+
+class ParameterSweepTest : public ::testing::Test {
+protected:
+    // Steady-state loop from SimulatorTest (reverse-acting, Kc < 0)
+    Simulator::Config createSteadyStateConfig() {
+        Simulator::Config config;
+        config.params = TankModel::Parameters{
+            DEFAULT_TANK_AREA,
+            DEFAULT_VALVE_COEFFICIENT,
+            TANK_MAX_HEIGHT
+        };
+
+        config.initialState = Eigen::VectorXd(1);
+        config.initialState << TANK_NOMINAL_HEIGHT;
+
+        config.initialInputs = Eigen::VectorXd(2);
+        config.initialInputs << TEST_INLET_FLOW, TEST_VALVE_POSITION;
+
+        config.dt = TEST_DT;
+
+        Simulator::ControllerConfig ctrl_config;
+        ctrl_config.gains = PIDController::Gains{-1.0, 10.0, 0.0};
+        ctrl_config.bias = 0.5;
+        ctrl_config.minOutputLimit = 0.0;
+        ctrl_config.maxOutputLimit = 1.0;
+        ctrl_config.maxIntegralAccumulation = 10.0;
+        ctrl_config.measuredIndex = 0;
+        ctrl_config.outputIndex = 1;
+        ctrl_config.initialSetpoint = TANK_NOMINAL_HEIGHT;
+        config.controllerConfig.push_back(ctrl_config);
+
+        return config;
+    }
+
+    ParameterSweep::Options stepOptions(int threads = 0) {
+        ParameterSweep::Options options;
+        options.steps = 600;
+        options.setpoint = 3.0;  // 0.5 m step up from 2.5 m
+        options.threads = threads;
+        return options;
+    }
+};
+
+// Test: Grid ordering is Kc-major, tau_D-minor
+TEST_F(ParameterSweepTest, MakeGridOrdering) {
+    auto grid = ParameterSweep::makeGrid({-1.0, -2.0}, {5.0, 10.0, 20.0}, {0.0, 1.0});
+
+    ASSERT_EQ(grid.size(), 12u);
+    EXPECT_DOUBLE_EQ(grid[0].Kc, -1.0);
+    EXPECT_DOUBLE_EQ(grid[0].tau_I, 5.0);
+    EXPECT_DOUBLE_EQ(grid[0].tau_D, 0.0);
+    EXPECT_DOUBLE_EQ(grid[1].tau_D, 1.0);
+    EXPECT_DOUBLE_EQ(grid[2].tau_I, 10.0);
+    EXPECT_DOUBLE_EQ(grid[6].Kc, -2.0);
+    EXPECT_DOUBLE_EQ(grid[11].tau_I, 20.0);
+}
+
+// Test: Metrics agree with a hand-rolled reduction over Simulator::step()
+TEST_F(ParameterSweepTest, MetricsMatchManualRun) {
+    Simulator::Config config = createSteadyStateConfig();
+    ParameterSweep::Options options = stepOptions(1);
+    PIDController::Gains gains{-3.0, 8.0, 0.0};
+
+    ParameterSweep sweep(config, options);
+    ParameterSweep::Metrics metrics = sweep.run({gains})[0];
+
+    Simulator sim(config);
+    sim.setControllerGains(0, gains);
+    sim.setSetpoint(0, options.setpoint);
+    double iae = 0.0, ise = 0.0, overshoot = 0.0, travel = 0.0, last_outside = 0.0;
+    double band = options.settlingBand * 0.5;
+    double previous_output = sim.getControllerOutput(0);
+    for (int k = 0; k < options.steps; ++k) {
+        sim.step();
+        double e = sim.getError(0);
+        iae += std::abs(e) * config.dt;
+        ise += e * e * config.dt;
+        overshoot = std::max(overshoot, sim.getState()(0) - options.setpoint);
+        travel += std::abs(sim.getControllerOutput(0) - previous_output);
+        previous_output = sim.getControllerOutput(0);
+        if (std::abs(e) > band) {
+            last_outside = sim.getTime();
+        }
+    }
+
+    EXPECT_NEAR(metrics.iae, iae, 1e-9);
+    EXPECT_NEAR(metrics.ise, ise, 1e-9);
+    EXPECT_NEAR(metrics.overshoot, overshoot, 1e-12);
+    EXPECT_NEAR(metrics.valveTravel, travel, 1e-9);
+    EXPECT_DOUBLE_EQ(metrics.settlingTime, last_outside);
+
+    EXPECT_GT(metrics.iae, 0.0);
+    EXPECT_GT(metrics.settlingTime, 0.0);
+    EXPECT_LT(metrics.settlingTime, options.steps * config.dt) << "Loop should settle";
+}
+
+// Test: Results do not depend on the number of worker threads
+TEST_F(ParameterSweepTest, ResultsIndependentOfThreadCount) {
+    auto grid = ParameterSweep::makeGrid({-0.5, -1.0, -2.0, -4.0},
+                                         {0.0, 5.0, 20.0}, {0.0, 2.0});
+    Simulator::Config config = createSteadyStateConfig();
+
+    auto serial = ParameterSweep(config, stepOptions(1)).run(grid);
+    auto parallel = ParameterSweep(config, stepOptions(4)).run(grid);
+
+    ASSERT_EQ(serial.size(), grid.size());
+    ASSERT_EQ(parallel.size(), grid.size());
+    for (size_t i = 0; i < grid.size(); ++i) {
+        EXPECT_EQ(serial[i].iae, parallel[i].iae) << "case " << i;
+        EXPECT_EQ(serial[i].ise, parallel[i].ise) << "case " << i;
+        EXPECT_EQ(serial[i].overshoot, parallel[i].overshoot) << "case " << i;
+        EXPECT_EQ(serial[i].settlingTime, parallel[i].settlingTime) << "case " << i;
+        EXPECT_EQ(serial[i].valveTravel, parallel[i].valveTravel) << "case " << i;
+    }
+}
+
+// Test: A proportional-only loop keeps an offset and never settles
+TEST_F(ParameterSweepTest, UnsettledCaseReportsInfinity) {
+    ParameterSweep sweep(createSteadyStateConfig(), stepOptions());
+    ParameterSweep::Metrics metrics = sweep.run({PIDController::Gains{-0.05, 0.0, 0.0}})[0];
+
+    EXPECT_TRUE(std::isinf(metrics.settlingTime));
+    EXPECT_DOUBLE_EQ(metrics.overshoot, 0.0);
+}
+
+// Test: Empty sweeps and invalid inputs
+TEST_F(ParameterSweepTest, Validation) {
+    Simulator::Config config = createSteadyStateConfig();
+    ParameterSweep sweep(config, stepOptions());
+    EXPECT_TRUE(sweep.run({}).empty());
+    EXPECT_GE(sweep.getThreadCount(), 1);
+
+    EXPECT_THROW(sweep.run({PIDController::Gains{-1.0, -5.0, 0.0}}), std::invalid_argument);
+
+    ParameterSweep::Options bad = stepOptions();
+    bad.steps = 0;
+    EXPECT_THROW(ParameterSweep(config, bad), std::invalid_argument);
+
+    bad = stepOptions();
+    bad.controllerIndex = 1;
+    EXPECT_THROW(ParameterSweep(config, bad), std::invalid_argument);
+
+    bad = stepOptions();
+    bad.settlingBand = 0.0;
+    EXPECT_THROW(ParameterSweep(config, bad), std::invalid_argument);
+
+    Simulator::Config bad_config = config;
+    bad_config.dt = -1.0;
+    EXPECT_THROW(ParameterSweep(bad_config, stepOptions()), std::invalid_argument);
+}
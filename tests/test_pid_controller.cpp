@@ -1,5 +1,6 @@
 #include <gtest/gtest.h>
-#include "../src/pid_controller.h"
+#include "../src/dual.h"
+#include "../src/pid_controller_impl.h"
 #include "../src/constants.h"
 
 using namespace tank_sim;
@@ -172,3 +173,24 @@ TEST(PIDControllerTest, CombinedPIDAction) {
     // Should increase due to additional integral accumulation
     EXPECT_GT(output2, output1);
 }
+
+// Test: A Dual scalar carries exact gain derivatives, none when saturated
+TEST(PIDControllerTest, DualScalarCarriesGainDerivatives) {
+    using Scalar = Dual<1>;
+    BasicPIDController<Scalar>::Gains gains{Scalar::variable(2.0, 0), 10.0, 1.0};
+    BasicPIDController<Scalar> pid(gains, 0.5, 0.0, 1.0, 10.0);
+    PIDController reference(PIDController::Gains{2.0, 10.0, 1.0}, 0.5, 0.0, 1.0, 10.0);
+
+    // u = bias + Kc (e + I / tau_I + tau_D e_dot), so du/dKc is the bracket
+    // (the integral term uses the state from before this call)
+    pid.setIntegralState(0.5);
+    reference.setIntegralState(0.5);
+    const Scalar output = pid.compute(0.1, 0.02, TEST_DT);
+    EXPECT_EQ(output.value(), reference.compute(0.1, 0.02, TEST_DT));
+    EXPECT_DOUBLE_EQ(output.derivative(0), 0.1 + 0.5 / 10.0 + 1.0 * 0.02);
+
+    // Driven into the upper limit: the clamp passes no derivative
+    const Scalar saturated = pid.compute(5.0, 0.0, TEST_DT);
+    EXPECT_EQ(saturated.value(), 1.0);
+    EXPECT_EQ(saturated.derivative(0), 0.0);
+}
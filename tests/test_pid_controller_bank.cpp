@@ -0,0 +1,180 @@
+#include <gtest/gtest.h>
+#include <Eigen/Dense>
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+#include "../src/pid_controller_bank.h"
+
+using namespace tank_sim;
+
+namespace {
+
+struct LoopSpec {
+    PIDController::Gains gains;
+    double bias;
+    double minOutput;
+    double maxOutput;
+    double maxIntegral;
+    double setpoint;
+};
+
+// A mix of P, PI, PID and saturating loops, including tau_I = 0
+const std::vector<LoopSpec> LOOPS{
+    {{-1.0, 0.0, 0.0}, 0.5, 0.0, 1.0, 10.0, 2.0},
+    {{-1.0, 10.0, 0.0}, 0.5, 0.0, 1.0, 10.0, 2.5},
+    {{-0.5, 5.0, 2.0}, 0.5, 0.0, 1.0, 10.0, 1.5},
+    {{-20.0, 2.0, 0.0}, 0.5, 0.0, 1.0, 10.0, 3.0},   // Saturates, tests anti-windup
+    {{2.0, 1.0, 0.5}, 0.0, -1.0, 1.0, 0.05, 0.8},    // Integral clamp
+};
+
+}  // namespace
+
+// Test: Every loop tracks a scalar PIDController driven with the same
+// errors, through saturation, integral clamping and a mid-run gain change
+TEST(PIDControllerBankTest, MatchesScalarControllers) {
+    const double dt = 0.1;
+    const auto loops = static_cast<Eigen::Index>(LOOPS.size());
+    PIDControllerBank bank;
+    std::vector<PIDController> scalars;
+    std::vector<double> previousErrors(LOOPS.size(), 0.0);
+    for (Eigen::Index i = 0; i < loops; ++i) {
+        const LoopSpec &spec = LOOPS[i];
+        bank.addLoop(spec.gains, spec.bias, spec.minOutput, spec.maxOutput,
+                     spec.maxIntegral, i, i, spec.setpoint);
+        scalars.emplace_back(spec.gains, spec.bias, spec.minOutput, spec.maxOutput,
+                             spec.maxIntegral);
+    }
+    ASSERT_EQ(bank.size(), loops);
+
+    Eigen::VectorXd state(loops);
+    Eigen::VectorXd inputs = Eigen::VectorXd::Zero(loops);
+    for (int k = 0; k < 200; ++k) {
+        if (k == 100) {
+            const PIDController::Gains retuned{-0.8, 4.0, 1.0};
+            bank.setGains(2, retuned);
+            scalars[2].setGains(retuned);
+        }
+        for (Eigen::Index i = 0; i < loops; ++i) {
+            state(i) = 2.0 + std::sin(0.05 * k + static_cast<double>(i));
+        }
+        bank.computeAll(dt, state, inputs);
+        for (Eigen::Index i = 0; i < loops; ++i) {
+            const double error = LOOPS[i].setpoint - state(i);
+            const double expected =
+                scalars[i].compute(error, (error - previousErrors[i]) / dt, dt);
+            previousErrors[i] = error;
+            ASSERT_NEAR(inputs(i), expected, 1e-12) << "loop " << i << ", step " << k;
+            ASSERT_NEAR(bank.getIntegralState(i), scalars[i].getIntegralState(), 1e-12)
+                << "loop " << i << ", step " << k;
+            ASSERT_EQ(bank.getPreviousError(i), error);
+        }
+    }
+    EXPECT_EQ(bank.getGains(2).Kc, -0.8);
+    EXPECT_EQ(bank.getGains(2).tau_I, 4.0);
+}
+
+// Test: Measurements are gathered and outputs scattered by index; when two
+// loops write the same input the later loop wins
+TEST(PIDControllerBankTest, GatherScatterByIndex) {
+    PIDControllerBank bank;
+    const PIDController::Gains proportional{1.0, 0.0, 0.0};
+    bank.addLoop(proportional, 0.0, -10.0, 10.0, 1.0, 2, 1, 5.0);
+    bank.addLoop(proportional, 0.0, -10.0, 10.0, 1.0, 0, 3, 1.0);
+    bank.addLoop(proportional, 0.0, -10.0, 10.0, 1.0, 0, 1, 4.0);
+
+    const Eigen::Vector3d state(0.5, 9.0, 3.0);
+    Eigen::VectorXd inputs = Eigen::VectorXd::Constant(4, -1.0);
+    bank.computeAll(1.0, state, inputs);
+
+    EXPECT_EQ(inputs(0), -1.0);  // Not an output index: untouched
+    EXPECT_EQ(inputs(1), 3.5);   // Loop 2 overwrites loop 0's 2.0
+    EXPECT_EQ(inputs(2), -1.0);
+    EXPECT_EQ(inputs(3), 0.5);
+}
+
+// Test: reset() restores initial setpoints and clears the loop state;
+// setIntegralState() clamps like PIDController
+TEST(PIDControllerBankTest, ResetAndIntegralClamp) {
+    PIDControllerBank bank;
+    bank.addLoop({-1.0, 10.0, 0.0}, 0.5, 0.0, 1.0, 2.0, 0, 0, 2.5);
+    Eigen::VectorXd state = Eigen::VectorXd::Constant(1, 2.0);
+    Eigen::VectorXd inputs = Eigen::VectorXd::Zero(1);
+
+    bank.setSetpoint(0, 2.2);
+    bank.computeAll(0.1, state, inputs);
+    EXPECT_NE(bank.getIntegralState(0), 0.0);
+    EXPECT_NE(bank.getPreviousError(0), 0.0);
+
+    bank.reset();
+    EXPECT_EQ(bank.getSetpoint(0), 2.5);
+    EXPECT_EQ(bank.getIntegralState(0), 0.0);
+    EXPECT_EQ(bank.getPreviousError(0), 0.0);
+
+    bank.setIntegralState(0, 5.0);
+    EXPECT_EQ(bank.getIntegralState(0), 2.0);
+    bank.setIntegralState(0, -5.0);
+    EXPECT_EQ(bank.getIntegralState(0), -2.0);
+}
+
+// Test: Invalid loop parameters are rejected with PIDController's checks
+TEST(PIDControllerBankTest, Validation) {
+    PIDControllerBank bank;
+    EXPECT_TRUE(bank.empty());
+    EXPECT_THROW(bank.addLoop({1.0, -1.0, 0.0}, 0.0, 0.0, 1.0, 1.0, 0, 0, 0.0),
+                 std::invalid_argument);
+    EXPECT_THROW(bank.addLoop({1.0, 0.0, 0.0}, 0.0, 1.0, 0.0, 1.0, 0, 0, 0.0),
+                 std::invalid_argument);
+    EXPECT_THROW(bank.addLoop({1.0, 0.0, 0.0}, 0.0, 0.0, 1.0, -1.0, 0, 0, 0.0),
+                 std::invalid_argument);
+    EXPECT_THROW(bank.addLoop({1.0, 0.0, 0.0}, 0.0, 0.0, 1.0, 1.0, -1, 0, 0.0),
+                 std::invalid_argument);
+    EXPECT_THROW(bank.addLoop({1.0, 0.0, 0.0}, 0.0, 0.0, 1.0, 1.0, 0, -1, 0.0),
+                 std::invalid_argument);
+    EXPECT_TRUE(bank.empty());  // Failed adds leave the bank unchanged
+}
+
+// Test: resize() + setLoop() rebuild a used bank exactly as addLoop() builds
+// a new one; a rejected setLoop() leaves the loop alone
+TEST(PIDControllerBankTest, ResizeAndSetLoopMatchAddLoop) {
+    PIDControllerBank added;
+    PIDControllerBank reused;
+    reused.addLoop({5.0, 1.0, 1.0}, 0.0, -1.0, 1.0, 1.0, 1, 1, 9.0);
+    Eigen::VectorXd state(2);
+    state << 1.0, 2.0;
+    Eigen::VectorXd inputs = Eigen::VectorXd::Zero(static_cast<Eigen::Index>(LOOPS.size()));
+    reused.computeAll(0.1, state, inputs);  // Leaves integral and error state
+
+    reused.resize(static_cast<Eigen::Index>(LOOPS.size()));
+    ASSERT_EQ(reused.size(), static_cast<Eigen::Index>(LOOPS.size()));
+    for (size_t i = 0; i < LOOPS.size(); ++i) {
+        const LoopSpec &loop = LOOPS[i];
+        const Eigen::Index index = static_cast<Eigen::Index>(i);
+        added.addLoop(loop.gains, loop.bias, loop.minOutput, loop.maxOutput,
+                      loop.maxIntegral, 0, index, loop.setpoint);
+        reused.setLoop(index, loop.gains, loop.bias, loop.minOutput, loop.maxOutput,
+                       loop.maxIntegral, 0, index, loop.setpoint);
+    }
+
+    Eigen::VectorXd addedInputs = Eigen::VectorXd::Zero(inputs.size());
+    Eigen::VectorXd reusedInputs = Eigen::VectorXd::Zero(inputs.size());
+    for (int k = 0; k < 20; ++k) {
+        state(0) = 1.0 + 0.1 * k;
+        added.computeAll(0.1, state, addedInputs);
+        reused.computeAll(0.1, state, reusedInputs);
+        EXPECT_EQ(reusedInputs, addedInputs) << "step " << k;
+    }
+
+    EXPECT_THROW(reused.setLoop(0, {1.0, -1.0, 0.0}, 0.0, 0.0, 1.0, 1.0, 0, 0, 0.0),
+                 std::invalid_argument);
+    EXPECT_EQ(reused.getGains(0).tau_I, LOOPS[0].gains.tau_I);
+    EXPECT_EQ(reused.getOutputIndex(0), 0);
+}
+
+// Test: An empty bank leaves the inputs alone
+TEST(PIDControllerBankTest, EmptyBankIsNoOp) {
+    PIDControllerBank bank;
+    Eigen::VectorXd state = Eigen::VectorXd::Ones(2);
+    Eigen::VectorXd inputs = Eigen::VectorXd::Constant(2, 0.25);
+    bank.computeAll(0.1, state, inputs);
+    EXPECT_EQ(inputs, Eigen::VectorXd::Constant(2, 0.25));
+}
@@ -0,0 +1,198 @@
+#include <gtest/gtest.h>
+#include <Eigen/Dense>
+#include <cmath>
+#include "../src/plant_network.h"
+#include "../src/tank_model.h"
+#include "../src/constants.h"
+
+using namespace tank_sim;
+using namespace tank_sim::constants;
+
+class PlantNetworkTest : public ::testing::Test {
+protected:
+    TankModel::Parameters params{
+        DEFAULT_TANK_AREA,
+        DEFAULT_VALVE_COEFFICIENT,
+        TANK_MAX_HEIGHT
+    };
+};
+
+// A one-tank network is TankModel, bit for bit
+TEST_F(PlantNetworkTest, SingleTankMatchesTankModel) {
+    PlantNetwork network(PlantNetwork::singleTank(params));
+    TankModel model(params);
+    ASSERT_EQ(network.getStateSize(), 1);
+    ASSERT_EQ(network.getInputSize(), 2);
+
+    Eigen::VectorXd inputs(2);
+    Eigen::VectorXd expected(1), actual(1);
+    Eigen::VectorXd state(1);
+    for (double h : {0.0, 0.3, TANK_NOMINAL_HEIGHT, 4.9}) {
+        for (double x : {0.0, TEST_VALVE_POSITION, 1.0}) {
+            state << h;
+            inputs << TEST_INLET_FLOW, x;
+            model.derivatives(state, inputs, expected);
+            network.derivatives(state, inputs, actual);
+            EXPECT_EQ(actual(0), expected(0)) << "h = " << h << ", x = " << x;
+
+            Eigen::VectorXd flows(1);
+            network.valveFlows(state, inputs, flows);
+            EXPECT_EQ(flows(0), model.getOutletFlow(state, inputs));
+        }
+    }
+}
+
+// Every valve between tanks moves volume, so sum(A_i * dh_i/dt) is the
+// inflow minus what leaves through the drain
+TEST_F(PlantNetworkTest, CascadeConservesMass) {
+    const int tanks = 50;
+    PlantNetwork network(PlantNetwork::cascade(tanks, params));
+    ASSERT_EQ(network.getStateSize(), tanks);
+    ASSERT_EQ(network.getInputSize(), tanks + 1);
+    ASSERT_EQ(network.getValveCount(), tanks);
+
+    Eigen::VectorXd state = Eigen::VectorXd::LinSpaced(tanks, 0.5, 4.5);
+    Eigen::VectorXd inputs = Eigen::VectorXd::Constant(tanks + 1, 0.7);
+    inputs(0) = 1.3;
+
+    Eigen::VectorXd derivative(tanks), flows(tanks);
+    network.derivatives(state, inputs, derivative);
+    network.valveFlows(state, inputs, flows);
+
+    const double accumulation = (derivative * params.area).sum();
+    EXPECT_NEAR(accumulation, inputs(0) - flows(tanks - 1), 1e-12);
+
+    // Tank i gains from valve i - 1 and loses through valve i
+    for (int i = 1; i < tanks; ++i) {
+        EXPECT_NEAR(derivative(i) * params.area, flows(i - 1) - flows(i), 1e-12);
+    }
+}
+
+// A head-difference valve reverses with the level difference and
+// conserves volume between its two tanks
+TEST_F(PlantNetworkTest, HeadDifferenceFlowIsAntisymmetric) {
+    PlantNetwork::Topology topology;
+    topology.tanks = {{100.0, 5.0}, {50.0, 5.0}};
+    topology.valves = {{0, 1, 2.0, PlantNetwork::FULLY_OPEN,
+                        PlantNetwork::FlowLaw::HEAD_DIFFERENCE}};
+    PlantNetwork network(topology);
+    ASSERT_EQ(network.getInputSize(), 0);
+
+    Eigen::VectorXd inputs(0);
+    Eigen::VectorXd state(2), derivative(2), flows(1);
+
+    state << 3.0, 2.0;
+    network.valveFlows(state, inputs, flows);
+    EXPECT_DOUBLE_EQ(flows(0), 2.0);
+    const double forward = flows(0);
+
+    state << 2.0, 3.0;
+    network.valveFlows(state, inputs, flows);
+    EXPECT_DOUBLE_EQ(flows(0), -forward);
+
+    network.derivatives(state, inputs, derivative);
+    EXPECT_DOUBLE_EQ(derivative(0), 2.0 / 100.0);
+    EXPECT_DOUBLE_EQ(derivative(1), -2.0 / 50.0);
+
+    state << 2.0, 2.0;
+    network.derivatives(state, inputs, derivative);
+    EXPECT_EQ(derivative(0), 0.0);
+    EXPECT_EQ(derivative(1), 0.0);
+}
+
+// Valves may be listed in any order; flows are reported in topology order
+TEST_F(PlantNetworkTest, ValveFlowsFollowTopologyOrder) {
+    PlantNetwork::Topology topology;
+    topology.tanks = {{1.0, 5.0}, {1.0, 5.0}, {1.0, 5.0}};
+    topology.valves = {{2, PlantNetwork::DRAIN, 3.0, PlantNetwork::FULLY_OPEN},
+                       {0, 1, 1.0, PlantNetwork::FULLY_OPEN},
+                       {1, 2, 2.0, PlantNetwork::FULLY_OPEN}};
+    PlantNetwork network(topology);
+
+    Eigen::VectorXd inputs(0);
+    Eigen::VectorXd state(3), flows(3);
+    state << 4.0, 1.0, 9.0;
+    network.valveFlows(state, inputs, flows);
+    EXPECT_DOUBLE_EQ(flows(0), 9.0);
+    EXPECT_DOUBLE_EQ(flows(1), 2.0);
+    EXPECT_DOUBLE_EQ(flows(2), 2.0);
+}
+
+// Analytic sparse Jacobian against central differences, on a network with
+// every valve kind: actuated, fully open, drain and head difference
+TEST_F(PlantNetworkTest, JacobianMatchesFiniteDifference) {
+    PlantNetwork::Topology topology = PlantNetwork::cascade(4, params);
+    topology.tanks[2].area = 0.5;  // Surge vessel
+    topology.valves.push_back({3, 1, 0.8, PlantNetwork::FULLY_OPEN,
+                               PlantNetwork::FlowLaw::HEAD_DIFFERENCE});
+    PlantNetwork network(topology);
+
+    // 4 diagonal + 3 cascade links + 2 for the head-difference valve
+    const PlantNetwork::SparseMatrix &pattern = network.jacobianPattern();
+    EXPECT_EQ(pattern.nonZeros(), 9);
+
+    Eigen::VectorXd state(4), inputs(5);
+    state << 2.5, 1.0, 0.4, 3.2;
+    inputs << TEST_INLET_FLOW, 0.5, 0.6, 0.7, 0.8;
+
+    PlantNetwork::SparseMatrix jacobian = pattern;
+    network.jacobian(state, inputs, jacobian);
+    const Eigen::MatrixXd analytic(jacobian);
+
+    Eigen::MatrixXd numeric(4, 4);
+    Eigen::VectorXd up(4), down(4);
+    for (int j = 0; j < 4; ++j) {
+        const double step = 1e-6;
+        Eigen::VectorXd shifted = state;
+        shifted(j) += step;
+        network.derivatives(shifted, inputs, up);
+        shifted(j) -= 2.0 * step;
+        network.derivatives(shifted, inputs, down);
+        numeric.col(j) = (up - down) / (2.0 * step);
+    }
+    EXPECT_TRUE(analytic.isApprox(numeric, 1e-6))
+        << "analytic\n" << analytic << "\nnumeric\n" << numeric;
+
+    // Entries outside the pattern are structurally zero
+    EXPECT_EQ(analytic(0, 3), 0.0);
+    EXPECT_EQ(numeric(0, 3), 0.0);
+}
+
+TEST_F(PlantNetworkTest, RejectsInvalidTopology) {
+    EXPECT_THROW(PlantNetwork{PlantNetwork::Topology{}}, std::invalid_argument);
+    EXPECT_THROW(PlantNetwork::cascade(0, params), std::invalid_argument);
+    TankModel::Parameters quick = params;
+    quick.valve_characteristic = ValveCharacteristic::QUICK_OPENING;
+    EXPECT_THROW(PlantNetwork::cascade(2, quick), std::invalid_argument);
+
+    const PlantNetwork::Topology valid = PlantNetwork::cascade(2, params);
+    EXPECT_NO_THROW(PlantNetwork{valid});
+
+    PlantNetwork::Topology topology = valid;
+    topology.tanks[1].area = 0.0;
+    EXPECT_THROW(PlantNetwork{topology}, std::invalid_argument);
+
+    topology = valid;
+    topology.valves[0].to = 2;
+    EXPECT_THROW(PlantNetwork{topology}, std::invalid_argument);
+
+    topology = valid;
+    topology.valves[0].to = 0;
+    EXPECT_THROW(PlantNetwork{topology}, std::invalid_argument);
+
+    topology = valid;
+    topology.valves[1].law = PlantNetwork::FlowLaw::HEAD_DIFFERENCE;
+    EXPECT_THROW(PlantNetwork{topology}, std::invalid_argument);
+
+    topology = valid;
+    topology.valves[0].positionInput = 3;
+    EXPECT_THROW(PlantNetwork{topology}, std::invalid_argument);
+
+    topology = valid;
+    topology.valves[0].k_v = -1.0;
+    EXPECT_THROW(PlantNetwork{topology}, std::invalid_argument);
+
+    topology = valid;
+    topology.inflows[0].input = -1;
+    EXPECT_THROW(PlantNetwork{topology}, std::invalid_argument);
+}
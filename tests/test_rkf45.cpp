@@ -0,0 +1,125 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <stdexcept>
+#include <Eigen/Dense>
+#include "../src/rkf45.h"
+#include "../src/constants.h"
+
+using namespace tank_sim;
+using namespace tank_sim::constants;
+
+// Test fixture for the adaptive RKF45 integrator
+class Rkf45Test : public ::testing::Test {
+protected:
+    using Scalar = Eigen::Matrix<double, 1, 1>;
+    using Pair = Eigen::Matrix<double, 2, 1>;
+};
+
+// Test: Exponential decay meets the requested tolerance
+TEST_F(Rkf45Test, ExponentialDecayWithinTolerance) {
+    const double k = 1.0;
+    Scalar state(1.0);
+    Scalar input = Scalar::Zero();
+    Rkf45Workspace<Scalar> ws;
+    AdaptiveTolerances tolerances{1e-10, 1e-10};
+    double step = 0.0;
+
+    auto derivative = [k](double, const Scalar& y, const Scalar&, Scalar& dydt) {
+        dydt(0) = -k * y(0);
+    };
+
+    Rkf45Stats stats = integrateRkf45(0.0, 5.0, state, input, step, tolerances, ws, derivative);
+
+    EXPECT_NEAR(state(0), std::exp(-5.0), 1e-8);
+    EXPECT_GT(stats.accepted, 1) << "Whole-interval first step should be refined";
+    EXPECT_GT(step, 0.0);
+}
+
+// Test: Loose tolerance takes far fewer steps than a tight one
+TEST_F(Rkf45Test, StepCountFollowsTolerance) {
+    auto derivative = [](double, const Scalar& y, const Scalar&, Scalar& dydt) {
+        dydt(0) = -y(0);
+    };
+    auto count_steps = [&](double tolerance) {
+        Scalar state(1.0);
+        Rkf45Workspace<Scalar> ws;
+        double step = 0.0;
+        return integrateRkf45(0.0, 10.0, state, Scalar::Zero().eval(), step,
+                              AdaptiveTolerances{tolerance, tolerance}, ws, derivative)
+            .accepted;
+    };
+
+    EXPECT_LT(count_steps(1e-4), count_steps(1e-10));
+}
+
+// Test: Constant derivative is integrated exactly in one step
+TEST_F(Rkf45Test, ConstantDerivativeSingleStep) {
+    Scalar state(0.0);
+    Scalar input(2.0);
+    Rkf45Workspace<Scalar> ws;
+    double step = 0.0;
+
+    auto derivative = [](double, const Scalar&, const Scalar& u, Scalar& dydt) {
+        dydt(0) = u(0);
+    };
+
+    Rkf45Stats stats = integrateRkf45(0.0, 3.0, state, input, step, AdaptiveTolerances{}, ws, derivative);
+
+    EXPECT_EQ(stats.accepted, 1);
+    EXPECT_EQ(stats.rejected, 0);
+    EXPECT_NEAR(state(0), 6.0, 1e-12);
+    EXPECT_GE(step, 3.0) << "Zero error should grow the suggested step";
+}
+
+// Test: Harmonic oscillator over one period (dynamic-size vectors)
+TEST_F(Rkf45Test, HarmonicOscillatorDynamicSize) {
+    const double omega = TWO_PI;
+    Eigen::VectorXd state(2);
+    state << 1.0, 0.0;
+    Eigen::VectorXd input = Eigen::VectorXd::Zero(1);
+    Rkf45Workspace<Eigen::VectorXd> ws(2);
+    double step = 0.0;
+
+    auto derivative = [omega](double, const Eigen::VectorXd& y, const Eigen::VectorXd&,
+                              Eigen::VectorXd& dydt) {
+        dydt(0) = y(1);
+        dydt(1) = -omega * omega * y(0);
+    };
+
+    integrateRkf45(0.0, 1.0, state, input, step, AdaptiveTolerances{1e-10, 1e-10}, ws, derivative);
+
+    EXPECT_NEAR(state(0), 1.0, 1e-7);
+    EXPECT_NEAR(state(1), 0.0, 1e-6);
+}
+
+// Test: Step size is carried across consecutive intervals
+TEST_F(Rkf45Test, CarriesStepAcrossIntervals) {
+    auto derivative = [](double, const Scalar& y, const Scalar&, Scalar& dydt) {
+        dydt(0) = -0.01 * y(0);
+    };
+    Scalar state(1.0);
+    Rkf45Workspace<Scalar> ws;
+    double step = 0.0;
+    AdaptiveTolerances tolerances{1e-9, 1e-9};
+
+    // Settled, slow dynamics: after warm-up each 1 s interval is one step
+    integrateRkf45(0.0, 1.0, state, Scalar::Zero().eval(), step, tolerances, ws, derivative);
+    Rkf45Stats later = integrateRkf45(1.0, 2.0, state, Scalar::Zero().eval(), step, tolerances, ws, derivative);
+
+    EXPECT_EQ(later.accepted, 1);
+    EXPECT_NEAR(state(0), std::exp(-0.02), 1e-9);
+}
+
+// Test: Non-finite derivatives are reported instead of looping forever
+TEST_F(Rkf45Test, NonFiniteDerivativeThrows) {
+    Scalar state(1.0);
+    Rkf45Workspace<Scalar> ws;
+    double step = 0.0;
+    auto derivative = [](double, const Scalar&, const Scalar&, Scalar& dydt) {
+        dydt(0) = std::nan("");
+    };
+
+    EXPECT_THROW(integrateRkf45(0.0, 1.0, state, Scalar::Zero().eval(), step,
+                                AdaptiveTolerances{}, ws, derivative),
+                 std::runtime_error);
+}
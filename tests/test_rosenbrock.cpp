@@ -0,0 +1,112 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <Eigen/Dense>
+#include <Eigen/SparseCore>
+#include "../src/rk4.h"
+#include "../src/rosenbrock.h"
+
+using namespace tank_sim;
+
+// Test fixture for the linearly implicit ROS2 integrator
+class RosenbrockTest : public ::testing::Test {
+protected:
+    using Scalar = Eigen::Matrix<double, 1, 1>;
+    using ScalarWorkspace =
+        RosenbrockWorkspace<Scalar, Scalar, Eigen::PartialPivLU<Scalar>>;
+    using Sparse = Eigen::SparseMatrix<double>;
+    using SparseWorkspace =
+        RosenbrockWorkspace<Eigen::VectorXd, Sparse, Eigen::SparseLU<Sparse>>;
+
+    // y' = -lambda * (y - target)
+    static auto relaxation(double lambda, double target) {
+        return [lambda, target](double, const Scalar& y, const Scalar&, Scalar& dydt) {
+            dydt(0) = -lambda * (y(0) - target);
+        };
+    }
+    static auto relaxationJacobian(double lambda) {
+        return [lambda](double, const Scalar&, const Scalar&, Scalar& jacobian) {
+            jacobian(0, 0) = -lambda;
+        };
+    }
+};
+
+// Test: A mode 1000x faster than the step decays instead of blowing up
+TEST_F(RosenbrockTest, StiffDecayIsDamped) {
+    const double lambda = 1000.0, target = 2.0, dt = 1.0;
+    Scalar state(5.0);
+    Scalar rk4_state(5.0);
+    const Scalar input = Scalar::Zero();
+    ScalarWorkspace ws;
+    Rk4Workspace<Scalar> rk4_ws;
+
+    for (int k = 0; k < 5; ++k) {
+        ASSERT_TRUE(rosenbrockStep(k * dt, dt, state, input, ws,
+                                   relaxation(lambda, target),
+                                   relaxationJacobian(lambda)));
+        rk4Step(k * dt, dt, rk4_state, input, rk4_ws, relaxation(lambda, target));
+    }
+
+    // L-stability: the error is damped by ~1/(lambda dt) per step
+    EXPECT_NEAR(state(0), target, 1e-9);
+    EXPECT_GT(std::abs(rk4_state(0) - target), 1e6) << "RK4 should be unstable here";
+}
+
+// Test: Global error falls 4x when the step halves (second order)
+TEST_F(RosenbrockTest, SecondOrderConvergence) {
+    auto global_error = [&](int steps) {
+        Scalar state(1.0);
+        ScalarWorkspace ws;
+        const double dt = 2.0 / steps;
+        for (int k = 0; k < steps; ++k) {
+            rosenbrockStep(k * dt, dt, state, Scalar::Zero().eval(), ws,
+                           relaxation(1.0, 0.0), relaxationJacobian(1.0));
+        }
+        return std::abs(state(0) - std::exp(-2.0));
+    };
+
+    const double order = std::log2(global_error(50) / global_error(100));
+    EXPECT_NEAR(order, 2.0, 0.1);
+}
+
+// Test: Sparse workspace gives the same step as the dense one
+TEST_F(RosenbrockTest, SparseMatchesDense) {
+    // Coupled linear pair: y' = A y with a fast and a slow mode
+    Eigen::Matrix2d a;
+    a << -50.0, 0.0,
+          50.0, -0.5;
+
+    Sparse pattern(2, 2);
+    pattern.insert(0, 0) = 0.0;
+    pattern.insert(1, 0) = 0.0;
+    pattern.insert(1, 1) = 0.0;
+    pattern.makeCompressed();
+
+    SparseWorkspace sparse_ws(2);
+    sparse_ws.analyzePattern(pattern);
+    RosenbrockWorkspace<Eigen::Vector2d, Eigen::Matrix2d,
+                        Eigen::PartialPivLU<Eigen::Matrix2d>> dense_ws;
+
+    Eigen::VectorXd sparse_state(2);
+    sparse_state << 1.0, 0.0;
+    Eigen::Vector2d dense_state(1.0, 0.0);
+    const Eigen::Vector2d input = Eigen::Vector2d::Zero();
+
+    auto derivative = [&a](double, const auto& y, const auto&, auto& dydt) {
+        dydt = a * y;
+    };
+    for (int k = 0; k < 10; ++k) {
+        ASSERT_TRUE(rosenbrockStep(0.0, 0.5, sparse_state, input, sparse_ws, derivative,
+                                   [&a](double, const auto&, const auto&, Sparse& jacobian) {
+                                       jacobian.coeffRef(0, 0) = a(0, 0);
+                                       jacobian.coeffRef(1, 0) = a(1, 0);
+                                       jacobian.coeffRef(1, 1) = a(1, 1);
+                                   }));
+        rosenbrockStep(0.0, 0.5, dense_state, input, dense_ws, derivative,
+                       [&a](double, const auto&, const auto&, Eigen::Matrix2d& jacobian) {
+                           jacobian = a;
+                       });
+    }
+    EXPECT_NEAR(sparse_state(0), dense_state(0), 1e-12);
+    EXPECT_NEAR(sparse_state(1), dense_state(1), 1e-12);
+    EXPECT_EQ(sparse_ws.w.nonZeros(), 3) << "Pattern must be preserved";
+}
@@ -0,0 +1,312 @@
+#include <gtest/gtest.h>
+#include <Eigen/Dense>
+#include <cmath>
+#include <filesystem>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "../src/scenario_replay.h"
+#include "../src/simulator.h"
+#include "../src/constants.h"
+
+using namespace tank_sim;
+using namespace tank_sim::constants;
+
+class ScenarioReplayTest : public ::testing::Test {
+protected:
+    // Steady-state loop from SimulatorTest (reverse-acting, Kc < 0)
+    Simulator::Config createSteadyStateConfig() {
+        Simulator::Config config;
+        config.params = TankModel::Parameters{
+            DEFAULT_TANK_AREA,
+            DEFAULT_VALVE_COEFFICIENT,
+            TANK_MAX_HEIGHT
+        };
+
+        config.initialState = Eigen::VectorXd(1);
+        config.initialState << TANK_NOMINAL_HEIGHT;
+
+        config.initialInputs = Eigen::VectorXd(2);
+        config.initialInputs << TEST_INLET_FLOW, TEST_VALVE_POSITION;
+
+        config.dt = TEST_DT;
+
+        Simulator::ControllerConfig ctrl_config;
+        ctrl_config.gains = PIDController::Gains{-1.0, 10.0, 0.0};
+        ctrl_config.bias = 0.5;
+        ctrl_config.minOutputLimit = 0.0;
+        ctrl_config.maxOutputLimit = 1.0;
+        ctrl_config.maxIntegralAccumulation = 10.0;
+        ctrl_config.measuredIndex = 0;
+        ctrl_config.outputIndex = 1;
+        ctrl_config.initialSetpoint = TANK_NOMINAL_HEIGHT;
+        config.controllerConfig.push_back(ctrl_config);
+
+        return config;
+    }
+
+    // Setpoint step, inlet upset and a retune, deliberately out of order
+    Scenario operatorScenario(double upset = 1.3) {
+        Scenario scenario;
+        scenario.name = "operator";
+        scenario.duration = 300.0;
+        scenario.events = {
+            {120.0, Scenario::Event::Kind::Input, INPUT_INDEX_INLET_FLOW, upset, {}},
+            {10.0, Scenario::Event::Kind::Setpoint, 0, 3.0, {}},
+            {200.0, Scenario::Event::Kind::Gains, 0, 0.0, {-2.0, 5.0, 0.5}},
+        };
+        return scenario;
+    }
+
+    void expectSameTrajectory(const Trajectory &a, const Trajectory &b) {
+        ASSERT_EQ(a.size(), b.size());
+        for (Eigen::Index k = 0; k < a.size(); ++k) {
+            ASSERT_EQ(a.time(k), b.time(k));
+            ASSERT_EQ(a.state(0, k), b.state(0, k)) << "sample " << k;
+            ASSERT_EQ(a.inputs(1, k), b.inputs(1, k)) << "sample " << k;
+            ASSERT_EQ(a.setpoint(0, k), b.setpoint(0, k)) << "sample " << k;
+        }
+    }
+};
+
+// Test: The text format parses comments and unordered events, and
+// write() round-trips it exactly
+TEST_F(ScenarioReplayTest, ParseAndWriteRoundTrip) {
+    std::istringstream text(
+        "# recorded from the upsets view\n"
+        "tank_sim-scenario 1\n"
+        "\n"
+        "duration 600\n"
+        "120  input    0 1.2   # inlet upset\n"
+        "0    setpoint 0 3.0\n"
+        "300  gains    0 -1.5 8 0.5\n");
+    const Scenario scenario = Scenario::parse(text, "upset");
+
+    EXPECT_EQ(scenario.name, "upset");
+    EXPECT_DOUBLE_EQ(scenario.duration, 600.0);
+    ASSERT_EQ(scenario.events.size(), 3u);
+    EXPECT_EQ(scenario.events[0].kind, Scenario::Event::Kind::Input);
+    EXPECT_DOUBLE_EQ(scenario.events[0].time, 120.0);
+    EXPECT_DOUBLE_EQ(scenario.events[0].value, 1.2);
+    EXPECT_EQ(scenario.events[1].kind, Scenario::Event::Kind::Setpoint);
+    EXPECT_EQ(scenario.events[2].kind, Scenario::Event::Kind::Gains);
+    EXPECT_DOUBLE_EQ(scenario.events[2].gains.Kc, -1.5);
+    EXPECT_DOUBLE_EQ(scenario.events[2].gains.tau_I, 8.0);
+    EXPECT_DOUBLE_EQ(scenario.events[2].gains.tau_D, 0.5);
+
+    Scenario precise = operatorScenario(1.0 / 3.0);
+    std::stringstream buffer;
+    precise.write(buffer);
+    const Scenario reread = Scenario::parse(buffer);
+    ASSERT_EQ(reread.events.size(), precise.events.size());
+    EXPECT_EQ(reread.duration, precise.duration);
+    for (size_t i = 0; i < precise.events.size(); ++i) {
+        EXPECT_EQ(reread.events[i].time, precise.events[i].time);
+        EXPECT_EQ(reread.events[i].kind, precise.events[i].kind);
+        EXPECT_EQ(reread.events[i].index, precise.events[i].index);
+    }
+    EXPECT_EQ(reread.events[0].value, 1.0 / 3.0);
+    EXPECT_EQ(reread.events[2].gains.tau_D, 0.5);
+}
+
+// Test: Malformed files are rejected with the offending line
+TEST_F(ScenarioReplayTest, ParseRejectsMalformedFiles) {
+    const auto parse = [](const std::string &text) {
+        std::istringstream in(text);
+        return Scenario::parse(in, "bad");
+    };
+    EXPECT_THROW(parse(""), std::invalid_argument);
+    EXPECT_THROW(parse("tank_sim-scenario 2\nduration 1\n"), std::invalid_argument);
+    EXPECT_THROW(parse("tank_sim-scenario 1\n"), std::invalid_argument);
+    EXPECT_THROW(parse("tank_sim-scenario 1\nduration -1\n"), std::invalid_argument);
+    EXPECT_THROW(parse("tank_sim-scenario 1\nduration 10\n-1 input 0 1\n"),
+                 std::invalid_argument);
+    EXPECT_THROW(parse("tank_sim-scenario 1\nduration 10\n1 valve 0 1\n"),
+                 std::invalid_argument);
+    EXPECT_THROW(parse("tank_sim-scenario 1\nduration 10\n1 input 0 1 2\n"),
+                 std::invalid_argument);
+    EXPECT_THROW(parse("tank_sim-scenario 1\nduration 10\n1 gains 0 -1 5\n"),
+                 std::invalid_argument);
+
+    try {
+        parse("tank_sim-scenario 1\nduration 10\n1 input 0 1\n2s input 0 1\n");
+        FAIL() << "Expected std::invalid_argument";
+    } catch (const std::invalid_argument &e) {
+        EXPECT_NE(std::string(e.what()).find("bad:4"), std::string::npos) << e.what();
+    }
+}
+
+// Test: save() and load() go through a file
+TEST_F(ScenarioReplayTest, SaveAndLoad) {
+    const std::string path =
+        (std::filesystem::temp_directory_path() / "tank_sim_scenario_test.txt").string();
+    operatorScenario().save(path);
+    const Scenario loaded = Scenario::load(path);
+    std::filesystem::remove(path);
+
+    EXPECT_EQ(loaded.name, path);
+    EXPECT_EQ(loaded.events.size(), 3u);
+    EXPECT_THROW(Scenario::load(path), std::runtime_error);
+}
+
+// Test: A replay matches hand-applied events over Simulator::step(),
+// including the step each event lands on
+TEST_F(ScenarioReplayTest, ReplayMatchesManualSteps) {
+    const Simulator::Config config = createSteadyStateConfig();
+    const ScenarioReplay replay(config, ScenarioReplay::Options{});
+    const Trajectory trajectory = replay.replay(operatorScenario());
+    ASSERT_EQ(trajectory.size(), 300);
+
+    Simulator sim(config);
+    Trajectory manual = sim.makeTrajectory(300);
+    for (int k = 0; k < 300; ++k) {
+        if (k == 10) {
+            sim.setSetpoint(0, 3.0);
+        }
+        if (k == 120) {
+            sim.setInput(INPUT_INDEX_INLET_FLOW, 1.3);
+        }
+        if (k == 200) {
+            sim.setControllerGains(0, PIDController::Gains{-2.0, 5.0, 0.5});
+        }
+        sim.run(1, manual);
+    }
+    expectSameTrajectory(trajectory, manual);
+    EXPECT_EQ(trajectory.setpoint(0, 9), TANK_NOMINAL_HEIGHT);
+    EXPECT_EQ(trajectory.setpoint(0, 10), 3.0);
+}
+
+// Test: Equal times apply in file order, times between steps round up, and
+// events at or past the horizon are dropped
+TEST_F(ScenarioReplayTest, EventOrderingAndRounding) {
+    const ScenarioReplay replay(createSteadyStateConfig(), ScenarioReplay::Options{});
+    Scenario scenario;
+    scenario.duration = 20.0;
+    scenario.events = {
+        {5.0, Scenario::Event::Kind::Setpoint, 0, 2.0, {}},
+        {5.0, Scenario::Event::Kind::Setpoint, 0, 3.0, {}},
+        {7.5, Scenario::Event::Kind::Setpoint, 0, 3.5, {}},
+        {20.0, Scenario::Event::Kind::Setpoint, 0, 9.0, {}},
+        {1e300, Scenario::Event::Kind::Setpoint, 0, 9.0, {}},
+    };
+    const Trajectory trajectory = replay.replay(scenario);
+    ASSERT_EQ(trajectory.size(), 20);
+    EXPECT_EQ(trajectory.setpoint(0, 4), TANK_NOMINAL_HEIGHT);
+    EXPECT_EQ(trajectory.setpoint(0, 5), 3.0);
+    EXPECT_EQ(trajectory.setpoint(0, 7), 3.0);
+    EXPECT_EQ(trajectory.setpoint(0, 8), 3.5);
+    EXPECT_EQ(trajectory.setpoint(0, 19), 3.5);
+}
+
+// Test: Events invalid for the base configuration fail before any work
+TEST_F(ScenarioReplayTest, RejectsInvalidEvents) {
+    const ScenarioReplay replay(createSteadyStateConfig(), ScenarioReplay::Options{});
+    Scenario scenario = operatorScenario();
+    scenario.events[0].index = 2;
+    EXPECT_THROW(replay.replay(scenario), std::invalid_argument);
+
+    scenario = operatorScenario();
+    scenario.events[1].index = 1;  // Only one controller
+    EXPECT_THROW(replay.replayAll({operatorScenario(), scenario}), std::invalid_argument);
+
+    scenario = operatorScenario();
+    scenario.events[2].gains.tau_I = -1.0;
+    EXPECT_THROW(replay.replay(scenario), std::invalid_argument);
+
+    scenario = operatorScenario();
+    scenario.duration = std::numeric_limits<double>::infinity();
+    EXPECT_THROW(replay.replay(scenario), std::invalid_argument);
+
+    EXPECT_THROW(replay.verify({operatorScenario()}, {}), std::invalid_argument);
+
+    ScenarioReplay::Options options;
+    options.tolerance.absolute = -1.0;
+    EXPECT_THROW(ScenarioReplay(createSteadyStateConfig(), options), std::invalid_argument);
+}
+
+// Test: Parallel replays match serial ones exactly, and a retune in one
+// scenario does not leak into the next on the same worker
+TEST_F(ScenarioReplayTest, ParallelReplayIsDeterministic) {
+    std::vector<Scenario> scenarios;
+    for (int i = 0; i < 24; ++i) {
+        scenarios.push_back(operatorScenario(1.0 + 0.02 * i));
+    }
+    Scenario quiet;
+    quiet.duration = 300.0;  // No events: relies on the base gains
+    scenarios.push_back(quiet);
+
+    ScenarioReplay::Options serialOptions;
+    serialOptions.threads = 1;
+    ScenarioReplay::Options parallelOptions;
+    parallelOptions.threads = 4;
+    const ScenarioReplay serial(createSteadyStateConfig(), serialOptions);
+    const ScenarioReplay parallel(createSteadyStateConfig(), parallelOptions);
+
+    const std::vector<Trajectory> a = serial.replayAll(scenarios);
+    const std::vector<Trajectory> b = parallel.replayAll(scenarios);
+    ASSERT_EQ(a.size(), scenarios.size());
+    ASSERT_EQ(b.size(), scenarios.size());
+    for (size_t i = 0; i < scenarios.size(); ++i) {
+        expectSameTrajectory(a[i], b[i]);
+        expectSameTrajectory(a[i], serial.replay(scenarios[i]));
+    }
+
+    const std::vector<ScenarioReplay::Result> results = parallel.verify(scenarios, a);
+    for (const ScenarioReplay::Result &result : results) {
+        EXPECT_TRUE(result.passed) << result.signal;
+        EXPECT_EQ(result.samples, 300);
+        EXPECT_EQ(result.maxError, 0.0);
+        EXPECT_EQ(result.firstFailure, -1);
+    }
+}
+
+// Test: compare() reports the first out-of-tolerance sample and its
+// column, honours both tolerances and treats NaN as equal only to NaN
+TEST_F(ScenarioReplayTest, CompareFindsDrift) {
+    const ScenarioReplay replay(createSteadyStateConfig(), ScenarioReplay::Options{});
+    const Trajectory golden = replay.replay(operatorScenario());
+    ScenarioReplay::Tolerance tolerance{1e-9, 1e-6};
+
+    Trajectory drifted = golden;
+    drifted.state(0, 150) += 1e-3;
+    drifted.controllerOutput(0, 200) += 1e-3;
+    drifted.error(0, 250) = std::numeric_limits<double>::quiet_NaN();
+    ScenarioReplay::Result result = ScenarioReplay::compare(drifted, golden, tolerance);
+    EXPECT_FALSE(result.passed);
+    EXPECT_EQ(result.firstFailure, 150);
+    EXPECT_EQ(result.signal, "state_0");
+    EXPECT_TRUE(std::isinf(result.maxError));
+
+    // Within the relative tolerance (|y| ~ 3)
+    Trajectory close = golden;
+    close.state(0, 150) *= 1.0 + 1e-7;
+    result = ScenarioReplay::compare(close, golden, tolerance);
+    EXPECT_TRUE(result.passed);
+    EXPECT_GT(result.maxError, 0.0);
+
+    Trajectory bothNaN = golden;
+    Trajectory goldenNaN = golden;
+    bothNaN.inputs(0, 3) = goldenNaN.inputs(0, 3) = std::numeric_limits<double>::quiet_NaN();
+    EXPECT_TRUE(ScenarioReplay::compare(bothNaN, goldenNaN, tolerance).passed);
+
+    Scenario shorter = operatorScenario();
+    shorter.duration = 100.0;
+    result = ScenarioReplay::compare(replay.replay(shorter), golden, tolerance);
+    EXPECT_FALSE(result.passed);
+    EXPECT_EQ(result.samples, 100);
+    EXPECT_EQ(result.firstFailure, 100);
+    EXPECT_EQ(result.signal, "length");
+
+    result = ScenarioReplay::compare(Trajectory(300, 1, 2, 0), golden, tolerance);
+    EXPECT_FALSE(result.passed);
+    EXPECT_EQ(result.signal, "shape");
+
+    // Drift introduced through the scenario itself shows up at the event
+    // step; the level is the first column to move there
+    const std::vector<ScenarioReplay::Result> verified =
+        replay.verify({operatorScenario(1.31)}, {golden});
+    EXPECT_FALSE(verified[0].passed);
+    EXPECT_EQ(verified[0].firstFailure, 120);
+    EXPECT_EQ(verified[0].signal, "state_0");
+}
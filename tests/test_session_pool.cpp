@@ -0,0 +1,160 @@
+#include <gtest/gtest.h>
+#include <Eigen/Dense>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "../src/session_pool.h"
+#include "../src/simulator.h"
+#include "../src/constants.h"
+
+using namespace tank_sim;
+using namespace tank_sim::constants;
+
+class SessionPoolTest : public ::testing::Test {
+protected:
+    // Steady-state loop from SimulatorTest, with a per-session setpoint
+    Simulator::Config createConfig(double setpoint = TANK_NOMINAL_HEIGHT) {
+        Simulator::Config config;
+        config.params = TankModel::Parameters{
+            DEFAULT_TANK_AREA,
+            DEFAULT_VALVE_COEFFICIENT,
+            TANK_MAX_HEIGHT
+        };
+
+        config.initialState = Eigen::VectorXd(1);
+        config.initialState << TANK_NOMINAL_HEIGHT;
+
+        config.initialInputs = Eigen::VectorXd(2);
+        config.initialInputs << TEST_INLET_FLOW, TEST_VALVE_POSITION;
+
+        config.dt = TEST_DT;
+
+        Simulator::ControllerConfig ctrl_config;
+        ctrl_config.gains = PIDController::Gains{-1.0, 10.0, 0.0};
+        ctrl_config.bias = 0.5;
+        ctrl_config.minOutputLimit = 0.0;
+        ctrl_config.maxOutputLimit = 1.0;
+        ctrl_config.maxIntegralAccumulation = 10.0;
+        ctrl_config.measuredIndex = 0;
+        ctrl_config.outputIndex = 1;
+        ctrl_config.initialSetpoint = setpoint;
+        config.controllerConfig.push_back(ctrl_config);
+
+        return config;
+    }
+};
+
+// Test: Sessions are spread over the shards, least loaded first
+TEST_F(SessionPoolTest, AddBalancesShards) {
+    SessionPool pool(3);
+    ASSERT_EQ(pool.getThreadCount(), 3);
+
+    std::vector<SessionPool::SessionId> ids;
+    for (int i = 0; i < 6; ++i) {
+        ids.push_back(pool.add(std::make_shared<Simulator>(createConfig())));
+    }
+    EXPECT_EQ(pool.size(), 6u);
+    for (int i = 0; i < 6; ++i) {
+        EXPECT_EQ(pool.getShard(ids[i]), i % 3);
+    }
+
+    // A freed slot is reused by the next session; its id is not
+    pool.remove(ids[4]);
+    EXPECT_FALSE(pool.contains(ids[4]));
+    const SessionPool::SessionId next = pool.add(std::make_shared<Simulator>(createConfig()));
+    EXPECT_EQ(pool.getShard(next), 1);
+    EXPECT_GT(next, ids[5]);
+}
+
+// Test: Every session ends exactly where stepping it alone would
+TEST_F(SessionPoolTest, AdvanceMatchesSerialStepping) {
+    const int sessionCount = 37;
+    SessionPool pool(4);
+    std::vector<std::shared_ptr<Simulator>> pooled;
+    std::vector<Simulator> serial;
+    std::vector<SessionPool::Work> work;
+    for (int i = 0; i < sessionCount; ++i) {
+        const Simulator::Config config = createConfig(2.0 + 0.02 * i);
+        pooled.push_back(std::make_shared<Simulator>(config));
+        serial.emplace_back(config);
+        work.push_back(SessionPool::Work{pool.add(pooled.back()), 10 + i});
+    }
+
+    for (int batch = 0; batch < 3; ++batch) {
+        EXPECT_TRUE(pool.advance(work).empty());
+        for (int i = 0; i < sessionCount; ++i) {
+            serial[i].run(10 + i);
+        }
+    }
+    for (int i = 0; i < sessionCount; ++i) {
+        EXPECT_EQ(pooled[i]->getTime(), serial[i].getTime()) << i;
+        EXPECT_EQ(pooled[i]->getState(), serial[i].getState()) << i;
+        EXPECT_EQ(pooled[i]->getInputs(), serial[i].getInputs()) << i;
+    }
+}
+
+// Test: Only the requested sessions move, and repeated requests add up
+TEST_F(SessionPoolTest, AdvanceRunsOnlyRequestedSessions) {
+    SessionPool pool(2);
+    auto a = std::make_shared<Simulator>(createConfig());
+    auto b = std::make_shared<Simulator>(createConfig());
+    const auto idA = pool.add(a);
+    pool.add(b);
+
+    pool.advance({{idA, 3}, {idA, 2}});
+    EXPECT_DOUBLE_EQ(a->getTime(), 5 * TEST_DT);
+    EXPECT_DOUBLE_EQ(b->getTime(), 0.0);
+
+    EXPECT_TRUE(pool.advance({}).empty());
+    EXPECT_DOUBLE_EQ(a->getTime(), 5 * TEST_DT);
+}
+
+// Test: Bad requests are rejected before any session runs
+TEST_F(SessionPoolTest, AdvanceValidatesBatch) {
+    SessionPool pool(2);
+    auto sim = std::make_shared<Simulator>(createConfig());
+    const auto id = pool.add(sim);
+
+    EXPECT_THROW(pool.advance({{id, 5}, {id + 1, 5}}), std::out_of_range);
+    EXPECT_THROW(pool.advance({{id, 5}, {id, -1}}), std::invalid_argument);
+    EXPECT_DOUBLE_EQ(sim->getTime(), 0.0);
+
+    EXPECT_THROW(SessionPool(-1), std::invalid_argument);
+    EXPECT_THROW(pool.add(nullptr), std::invalid_argument);
+    EXPECT_THROW(pool.remove(id + 1), std::out_of_range);
+    EXPECT_THROW(pool.getShard(id + 1), std::out_of_range);
+}
+
+// Test: A throwing session is reported without stopping the others
+TEST_F(SessionPoolTest, FailuresAreReportedPerSession) {
+    SessionPool pool(2);
+    auto good = std::make_shared<Simulator>(createConfig());
+    const auto goodId = pool.add(good);
+
+    // No step can meet a 1e-300 absolute tolerance away from steady state,
+    // so RKF45 reports a step size underflow
+    Simulator::Config adaptive = createConfig();
+    adaptive.integrator = Simulator::Integrator::AdaptiveRKF45;
+    adaptive.tolerances = AdaptiveTolerances{1e-300, 0.0};
+    auto bad = std::make_shared<Simulator>(adaptive);
+    const auto badId = pool.add(bad);
+    bad->setInput(INPUT_INDEX_INLET_FLOW, 2.0 * TEST_INLET_FLOW);
+
+    const auto failures = pool.advance({{badId, 4}, {goodId, 4}});
+    ASSERT_EQ(failures.size(), 1u);
+    EXPECT_EQ(failures[0].session, badId);
+    EXPECT_NE(failures[0].message.find("underflow"), std::string::npos);
+    EXPECT_DOUBLE_EQ(good->getTime(), 4 * TEST_DT);
+    EXPECT_DOUBLE_EQ(bad->getTime(), 0.0);
+}
+
+// Test: Destroying an idle pool joins its workers
+TEST_F(SessionPoolTest, DestroyIdlePool) {
+    for (int threads : {1, 2, 8}) {
+        SessionPool pool(threads);
+        EXPECT_EQ(pool.getThreadCount(), threads);
+    }
+    SessionPool automatic;
+    EXPECT_GE(automatic.getThreadCount(), 1);
+}
@@ -23,7 +23,9 @@
 #include <gtest/gtest.h>
 #include <Eigen/Dense>
 #include <cmath>
+#include <vector>
 #include "../src/simulator.h"
+#include "../src/simulator_impl.h"
 #include "../src/constants.h"
 
 using namespace tank_sim;
@@ -603,3 +605,802 @@ TEST_F(SimulatorTest, DerivativeAction) {
     EXPECT_GE(sim_no_deriv.getControllerOutput(0), 0.0);
     EXPECT_LE(sim_no_deriv.getControllerOutput(0), 1.0);
 }
+
+// Test: GSL reference integrator matches the native RK4 integrator
+TEST_F(SimulatorTest, GslIntegratorMatchesNative) {
+    // Closed-loop setpoint step run through both integration backends.
+    // Differences are bounded by RK4 truncation error, well below control precision.
+    Simulator::Config native_config = createSteadyStateConfig(TANK_NOMINAL_HEIGHT);
+    native_config.integrator = Simulator::Integrator::RK4;
+    Simulator::Config gsl_config = native_config;
+    gsl_config.integrator = Simulator::Integrator::GslRK4;
+
+    Simulator native_sim(native_config);
+    Simulator gsl_sim(gsl_config);
+    native_sim.setSetpoint(0, 3.0);
+    gsl_sim.setSetpoint(0, 3.0);
+
+    for (int i = 0; i < 200; ++i) {
+        native_sim.step();
+        gsl_sim.step();
+        ASSERT_NEAR(native_sim.getState()(0), gsl_sim.getState()(0), INTEGRATION_TOLERANCE)
+            << "Integrators diverged at step " << i;
+    }
+
+    EXPECT_NEAR(native_sim.getControllerOutput(0), gsl_sim.getControllerOutput(0), CONTROL_OUTPUT_TOLERANCE);
+    EXPECT_NEAR(native_sim.getState()(0), 3.0, 0.1);
+}
+
+// Test: run(n) produces the same trajectory as repeated step() calls
+TEST_F(SimulatorTest, RunMatchesRepeatedStep) {
+    Simulator::Config config = createSteadyStateConfig(TANK_NOMINAL_HEIGHT);
+    Simulator stepped(config);
+    Simulator bulk(config);
+    stepped.setSetpoint(0, 3.0);
+    bulk.setSetpoint(0, 3.0);
+
+    const int num_steps = 50;
+    Trajectory trajectory = bulk.makeTrajectory(num_steps);
+    bulk.run(num_steps, trajectory);
+
+    ASSERT_EQ(trajectory.size(), num_steps);
+    for (int k = 0; k < num_steps; ++k) {
+        stepped.step();
+        EXPECT_DOUBLE_EQ(trajectory.time(k), stepped.getTime());
+        EXPECT_DOUBLE_EQ(trajectory.state(0, k), stepped.getState()(0));
+        EXPECT_DOUBLE_EQ(trajectory.inputs(0, k), stepped.getInputs()(0));
+        EXPECT_DOUBLE_EQ(trajectory.inputs(1, k), stepped.getInputs()(1));
+        EXPECT_DOUBLE_EQ(trajectory.setpoint(0, k), 3.0);
+        EXPECT_DOUBLE_EQ(trajectory.error(0, k), stepped.getError(0));
+        EXPECT_DOUBLE_EQ(trajectory.controllerOutput(0, k), stepped.getControllerOutput(0));
+    }
+
+    // Simulator state after run() matches as well
+    EXPECT_DOUBLE_EQ(bulk.getTime(), stepped.getTime());
+    EXPECT_DOUBLE_EQ(bulk.getState()(0), stepped.getState()(0));
+}
+
+// Test: A FloatTrajectory records the same run rounded to float, in half the
+// signal memory; time stays double
+TEST_F(SimulatorTest, RunIntoFloatTrajectory) {
+    Simulator::Config config = createSteadyStateConfig(TANK_NOMINAL_HEIGHT);
+    Simulator exact(config);
+    Simulator rounded(config);
+    exact.setSetpoint(0, 3.0);
+    rounded.setSetpoint(0, 3.0);
+
+    const int num_steps = 50;
+    Trajectory reference = exact.makeTrajectory(num_steps);
+    FloatTrajectory trajectory = rounded.makeFloatTrajectory(num_steps);
+    exact.run(num_steps, reference);
+    EXPECT_EQ(rounded.runUntil(num_steps * TEST_DT, trajectory), num_steps);
+
+    ASSERT_EQ(trajectory.size(), num_steps);
+    for (int k = 0; k < num_steps; ++k) {
+        EXPECT_EQ(trajectory.time(k), reference.time(k));
+        EXPECT_EQ(trajectory.state(0, k), static_cast<float>(reference.state(0, k)));
+        EXPECT_EQ(trajectory.inputs(1, k), static_cast<float>(reference.inputs(1, k)));
+        EXPECT_EQ(trajectory.error(0, k), static_cast<float>(reference.error(0, k)));
+        EXPECT_EQ(trajectory.controllerOutput(0, k),
+                  static_cast<float>(reference.controllerOutput(0, k)));
+    }
+    EXPECT_EQ(rounded.getState()(0), exact.getState()(0)) << "Stepping is unchanged";
+    EXPECT_EQ(sizeof(*trajectory.state.data()) * 2, sizeof(*reference.state.data()));
+
+    FloatTrajectory too_small = rounded.makeFloatTrajectory(5);
+    EXPECT_THROW(rounded.run(6, too_small), std::invalid_argument);
+}
+
+// Test: Consecutive run() calls append to the same trajectory
+TEST_F(SimulatorTest, RunAppendsToTrajectory) {
+    Simulator sim(createSteadyStateConfig());
+    Trajectory trajectory = sim.makeTrajectory(30);
+
+    sim.run(10, trajectory);
+    sim.run(20, trajectory);
+
+    EXPECT_EQ(trajectory.size(), 30);
+    EXPECT_EQ(trajectory.remaining(), 0);
+    EXPECT_DOUBLE_EQ(trajectory.time(0), TEST_DT);
+    EXPECT_DOUBLE_EQ(trajectory.time(29), 30 * TEST_DT);
+
+    // clear() keeps the allocation and restarts at sample 0
+    trajectory.clear();
+    EXPECT_EQ(trajectory.size(), 0);
+    EXPECT_EQ(trajectory.capacity(), 30);
+}
+
+// Test: run() without a trajectory just advances the simulation
+TEST_F(SimulatorTest, RunWithoutTrajectory) {
+    Simulator sim(createSteadyStateConfig());
+    sim.run(25);
+    EXPECT_NEAR(sim.getTime(), 25 * TEST_DT, 1e-9);
+
+    EXPECT_THROW(sim.run(-1), std::invalid_argument);
+}
+
+// Test: runUntil() stops at the requested time without overshooting
+TEST_F(SimulatorTest, RunUntilReachesTargetTime) {
+    Simulator::Config config = createSteadyStateConfig();
+    config.dt = 0.1;
+    Simulator sim(config);
+
+    // 10.0 / 0.1 = 100 steps despite round-off in the accumulated time
+    Trajectory trajectory = sim.makeTrajectory(200);
+    EXPECT_EQ(sim.runUntil(10.0, trajectory), 100);
+    EXPECT_EQ(trajectory.size(), 100);
+    EXPECT_NEAR(sim.getTime(), 10.0, 1e-9);
+
+    // A time between steps rounds up to the next step
+    EXPECT_EQ(sim.runUntil(10.25), 3);
+    EXPECT_NEAR(sim.getTime(), 10.3, 1e-9);
+
+    // Target in the past: no steps
+    EXPECT_EQ(sim.runUntil(5.0), 0);
+}
+
+// Test: run() rejects undersized or mismatched trajectories before stepping
+TEST_F(SimulatorTest, RunValidatesTrajectory) {
+    Simulator sim(createSteadyStateConfig());
+
+    Trajectory too_small = sim.makeTrajectory(5);
+    EXPECT_THROW(sim.run(6, too_small), std::invalid_argument);
+    EXPECT_EQ(too_small.size(), 0);
+    EXPECT_DOUBLE_EQ(sim.getTime(), 0.0) << "No steps should run when validation fails";
+
+    Trajectory wrong_controllers(10, TANK_STATE_SIZE, TANK_INPUT_SIZE, 3);
+    EXPECT_THROW(sim.run(1, wrong_controllers), std::invalid_argument);
+
+    EXPECT_THROW(Trajectory(-1, 1, 2, 1), std::invalid_argument);
+}
+
+// Test: getTelemetry() agrees with the individual getters
+TEST_F(SimulatorTest, TelemetryMatchesGetters) {
+    Simulator sim(createSteadyStateConfig());
+    sim.setSetpoint(0, 3.0);
+    sim.run(20);
+
+    Simulator::Telemetry telemetry = sim.getTelemetry();
+    Eigen::VectorXd state = sim.getState();
+    Eigen::VectorXd inputs = sim.getInputs();
+
+    EXPECT_DOUBLE_EQ(telemetry.time, sim.getTime());
+    EXPECT_DOUBLE_EQ(telemetry.tankLevel, state(0));
+    EXPECT_DOUBLE_EQ(telemetry.setpoint, 3.0);
+    EXPECT_DOUBLE_EQ(telemetry.inletFlow, inputs(INPUT_INDEX_INLET_FLOW));
+    EXPECT_DOUBLE_EQ(telemetry.valvePosition, inputs(INPUT_INDEX_VALVE_POSITION));
+    EXPECT_DOUBLE_EQ(telemetry.error, sim.getError(0));
+    EXPECT_DOUBLE_EQ(telemetry.controllerOutput, sim.getControllerOutput(0));
+
+    // Outlet flow follows the valve equation: q_out = k_v * x * sqrt(h)
+    double expected_outlet = DEFAULT_VALVE_COEFFICIENT * inputs(1) * std::sqrt(state(0));
+    EXPECT_NEAR(telemetry.outletFlow, expected_outlet, 1e-12);
+    EXPECT_DOUBLE_EQ(sim.getOutletFlow(), telemetry.outletFlow);
+
+    EXPECT_THROW(sim.getTelemetry(1), std::out_of_range);
+}
+
+// Test: getTelemetry() reports NaN controller fields in open loop
+TEST_F(SimulatorTest, TelemetryOpenLoop) {
+    Simulator::Config config = createSteadyStateConfig();
+    config.controllerConfig.clear();
+    Simulator sim(config);
+
+    Simulator::Telemetry telemetry = sim.getTelemetry();
+    EXPECT_DOUBLE_EQ(telemetry.tankLevel, TANK_NOMINAL_HEIGHT);
+    EXPECT_TRUE(std::isnan(telemetry.setpoint));
+    EXPECT_TRUE(std::isnan(telemetry.error));
+    EXPECT_TRUE(std::isnan(telemetry.controllerOutput));
+}
+
+// Test: Adaptive integrator tracks the fixed-step RK4 reference
+TEST_F(SimulatorTest, AdaptiveIntegratorMatchesRk4) {
+    Simulator::Config rk4_config = createSteadyStateConfig(3.0);
+    Simulator::Config adaptive_config = rk4_config;
+    adaptive_config.integrator = Simulator::Integrator::AdaptiveRKF45;
+    adaptive_config.tolerances = AdaptiveTolerances{1e-10, 1e-10};
+
+    Simulator rk4_sim(rk4_config);
+    Simulator adaptive_sim(adaptive_config);
+    rk4_sim.run(300);
+    adaptive_sim.run(300);
+
+    EXPECT_NEAR(adaptive_sim.getState()(0), rk4_sim.getState()(0), 1e-6);
+    EXPECT_DOUBLE_EQ(adaptive_sim.getTime(), rk4_sim.getTime());
+}
+
+// Test: Integration statistics report internal work per integrator
+TEST_F(SimulatorTest, IntegrationStats) {
+    Simulator::Config config = createSteadyStateConfig();
+    Simulator rk4_sim(config);
+    rk4_sim.run(50);
+    EXPECT_EQ(rk4_sim.getIntegrationStats().steps, 50);
+    EXPECT_EQ(rk4_sim.getIntegrationStats().rejectedSteps, 0);
+    EXPECT_EQ(rk4_sim.getIntegrationStats().derivativeEvaluations, 200);
+
+    config.integrator = Simulator::Integrator::AdaptiveRKF45;
+    config.dt = 10.0;  // Long control period: settled plant needs one step each
+    config.tolerances = AdaptiveTolerances{1e-12, 1e-12};
+    Simulator adaptive_sim(config);
+    adaptive_sim.run(100);
+    const Simulator::IntegrationStats settled = adaptive_sim.getIntegrationStats();
+    EXPECT_EQ(settled.steps, 100);
+
+    // A setpoint change makes the integrator refine inside the periods
+    adaptive_sim.setSetpoint(0, 3.5);
+    adaptive_sim.run(100);
+    const Simulator::IntegrationStats moving = adaptive_sim.getIntegrationStats();
+    EXPECT_GT(moving.steps - settled.steps, 100);
+    EXPECT_EQ(moving.derivativeEvaluations, 6 * (moving.steps + moving.rejectedSteps));
+
+    adaptive_sim.reset();
+    EXPECT_EQ(adaptive_sim.getIntegrationStats().steps, 0);
+}
+
+// Test: Rosenbrock integrator tracks the RK4 reference on the non-stiff tank
+TEST_F(SimulatorTest, RosenbrockIntegratorMatchesRk4) {
+    Simulator::Config rk4_config = createSteadyStateConfig(3.0);
+    Simulator::Config rosenbrock_config = rk4_config;
+    rosenbrock_config.integrator = Simulator::Integrator::Rosenbrock;
+
+    Simulator rk4_sim(rk4_config);
+    Simulator rosenbrock_sim(rosenbrock_config);
+    rk4_sim.run(300);
+    rosenbrock_sim.run(300);
+
+    // Second order vs fourth order, on a plant with minute time constants
+    EXPECT_NEAR(rosenbrock_sim.getState()(0), rk4_sim.getState()(0), 1e-3);
+    const Simulator::IntegrationStats &stats = rosenbrock_sim.getIntegrationStats();
+    EXPECT_EQ(stats.steps, 300);
+    EXPECT_EQ(stats.derivativeEvaluations, 600);
+    EXPECT_EQ(stats.jacobianEvaluations, 300);
+}
+
+// Test: The exact ZOH integrator solves each control period exactly, where
+// a single RK4 step at MAX_DT does not on a small, fast tank
+TEST_F(SimulatorTest, ExactZohIntegratorIsExactAtLargeDt) {
+    Simulator::Config config = createSteadyStateConfig(3.0);
+    config.params.area = 2.0;
+    config.dt = MAX_DT;
+    config.controllerConfig[0].gains = PIDController::Gains{-0.2, 40.0, 0.0};
+    config.integrator = Simulator::Integrator::ExactZOH;
+    Simulator zoh(config);
+    const TankModel model(config.params);
+
+    double worstRk4 = 0.0;
+    for (int k = 0; k < 50; ++k) {
+        const TankModel::StateVector h0 = zoh.getState();
+        const TankModel::InputVector u = zoh.getInputs();
+        zoh.step();
+
+        // Reference: 5000 RK4 substeps with the same held inputs
+        TankModel::StateVector fine = h0;
+        const double step = MAX_DT / 5000;
+        FixedStepper<TANK_STATE_SIZE, TANK_INPUT_SIZE> stepper;
+        auto f = [&model](double, const TankModel::StateVector &x,
+                          const TankModel::InputVector &in) {
+            return model.derivatives(x, in);
+        };
+        for (int i = 0; i < 5000; ++i) {
+            fine = stepper.step(0.0, step, fine, u, f);
+        }
+        ASSERT_NEAR(zoh.getState()(0), fine(0), 1e-10) << "step " << k;
+
+        const TankModel::StateVector coarse = stepper.step(0.0, MAX_DT, h0, u, f);
+        worstRk4 = std::max(worstRk4, std::abs(coarse(0) - fine(0)));
+    }
+    EXPECT_GT(worstRk4, 1e-6);
+
+    const Simulator::IntegrationStats &stats = zoh.getIntegrationStats();
+    EXPECT_EQ(stats.steps, 50);
+    EXPECT_EQ(stats.jacobianEvaluations, 0);
+}
+
+// Test: Invalid adaptive tolerances are rejected
+TEST_F(SimulatorTest, AdaptiveToleranceValidation) {
+    Simulator::Config config = createSteadyStateConfig();
+    config.integrator = Simulator::Integrator::AdaptiveRKF45;
+    config.tolerances = AdaptiveTolerances{0.0, 0.0};
+    EXPECT_THROW(Simulator sim(config), std::invalid_argument);
+
+    config.tolerances = AdaptiveTolerances{-1e-6, 1e-6};
+    EXPECT_THROW(Simulator sim(config), std::invalid_argument);
+}
+
+// Test: restore() rewinds to a snapshot and replays bit-for-bit
+TEST_F(SimulatorTest, SnapshotRestoreReplaysExactly) {
+    Simulator sim(createSteadyStateConfig(3.0));
+    sim.run(40);
+    const Simulator::Snapshot snapshot = sim.save();
+    EXPECT_EQ(snapshot.controllerCount, 1);
+    EXPECT_DOUBLE_EQ(snapshot.time, sim.getTime());
+
+    std::vector<double> first;
+    for (int i = 0; i < 100; ++i) {
+        sim.step();
+        first.push_back(sim.getState()(0));
+    }
+
+    // Disturb everything the snapshot covers, then rewind
+    sim.setSetpoint(0, 1.0);
+    sim.setControllerGains(0, PIDController::Gains{-5.0, 2.0, 1.0});
+    sim.setInput(INPUT_INDEX_INLET_FLOW, 0.2);
+    sim.run(25);
+    sim.restore(snapshot);
+    EXPECT_DOUBLE_EQ(sim.getTime(), snapshot.time);
+    EXPECT_DOUBLE_EQ(sim.getSetpoint(0), 3.0);
+
+    for (int i = 0; i < 100; ++i) {
+        sim.step();
+        ASSERT_EQ(sim.getState()(0), first[i]) << "step " << i;
+    }
+}
+
+// Test: fork() starts at the live state and then evolves independently
+TEST_F(SimulatorTest, ForkIsIndependent) {
+    Simulator::Config config = createSteadyStateConfig(3.0);
+    config.historyCapacity = 16;
+    Simulator sim(config);
+    Simulator reference(config);
+    sim.run(30);
+    reference.run(30);
+
+    Simulator branch = sim.fork();
+    EXPECT_EQ(branch.getHistory(), nullptr);
+    EXPECT_DOUBLE_EQ(branch.getTime(), sim.getTime());
+
+    // An unchanged branch tracks the original exactly
+    Simulator twin = sim.fork();
+    twin.run(50);
+
+    // A what-if change on the branch must not leak back
+    branch.setSetpoint(0, 4.0);
+    branch.run(50);
+    sim.run(50);
+    reference.run(50);
+    EXPECT_EQ(sim.getState()(0), reference.getState()(0));
+    EXPECT_EQ(twin.getState()(0), sim.getState()(0));
+    EXPECT_GT(branch.getState()(0), sim.getState()(0));
+    EXPECT_DOUBLE_EQ(sim.getSetpoint(0), 3.0);
+}
+
+// Test: forks of every integrator, including the GSL reference, step correctly
+TEST_F(SimulatorTest, ForkPreservesIntegrator) {
+    for (Simulator::Integrator integrator :
+         {Simulator::Integrator::RK4, Simulator::Integrator::GslRK4,
+          Simulator::Integrator::AdaptiveRKF45,
+          Simulator::Integrator::Rosenbrock, Simulator::Integrator::ExactZOH}) {
+        Simulator::Config config = createSteadyStateConfig(3.0);
+        config.integrator = integrator;
+        Simulator sim(config);
+        sim.run(20);
+        Simulator branch = sim.fork();
+        sim.run(20);
+        branch.run(20);
+        EXPECT_EQ(branch.getState()(0), sim.getState()(0));
+        EXPECT_EQ(branch.getIntegrationStats().derivativeEvaluations,
+                  sim.getIntegrationStats().derivativeEvaluations);
+    }
+}
+
+// Test: Snapshots only restore into a simulator with the same loops
+TEST_F(SimulatorTest, RestoreValidatesControllerCount) {
+    Simulator::Config config = createSteadyStateConfig();
+    Simulator sim(config);
+    const Simulator::Snapshot snapshot = sim.save();
+
+    config.controllerConfig.clear();
+    Simulator open_loop(config);
+    EXPECT_THROW(open_loop.restore(snapshot), std::invalid_argument);
+
+    config = createSteadyStateConfig();
+    for (int i = 0; i < Simulator::Snapshot::MAX_CONTROLLERS; ++i) {
+        config.controllerConfig.push_back(config.controllerConfig[0]);
+    }
+    Simulator crowded(config);
+    EXPECT_THROW(crowded.save(), std::runtime_error);
+}
+
+// Test: restore() clears the history, whose times would go backwards
+TEST_F(SimulatorTest, RestoreClearsHistory) {
+    Simulator::Config config = createSteadyStateConfig();
+    config.historyCapacity = 8;
+    Simulator sim(config);
+    const Simulator::Snapshot snapshot = sim.save();
+    sim.run(5);
+    ASSERT_EQ(sim.getHistory()->size(), 5);
+    sim.restore(snapshot);
+    EXPECT_EQ(sim.getHistory()->size(), 0);
+}
+
+#if TANK_SIM_METRICS
+// Test: Metrics mirror the integration stats and time every step
+TEST_F(SimulatorTest, MetricsTrackWorkAndPhases) {
+    Simulator::Config config = createSteadyStateConfig(3.0);
+    config.integrator = Simulator::Integrator::AdaptiveRKF45;
+    config.historyCapacity = 16;
+    Simulator sim(config);
+    sim.run(50);
+
+    const Simulator::IntegrationStats &stats = sim.getIntegrationStats();
+    const Metrics::Report report = sim.getMetrics().report();
+    EXPECT_EQ(report.steps, static_cast<std::uint64_t>(stats.steps));
+    EXPECT_EQ(report.derivativeEvaluations,
+              static_cast<std::uint64_t>(stats.derivativeEvaluations));
+    EXPECT_GT(report.phaseSeconds[Metrics::INTEGRATION], 0.0);
+    EXPECT_GT(report.stepSeconds, 0.0);
+
+    std::uint64_t timed = 0;
+    for (std::uint64_t count : report.latencyCounts) {
+        timed += count;
+    }
+    EXPECT_EQ(timed, 50u);  // One latency sample per control period
+
+    // Metrics outlive reset(); forks and clearMetrics() start from zero
+    sim.reset();
+    EXPECT_EQ(sim.getMetrics().report().steps, report.steps);
+    EXPECT_EQ(sim.fork().getMetrics().report().steps, 0u);
+    sim.clearMetrics();
+    EXPECT_EQ(sim.getMetrics().report().steps, 0u);
+}
+#endif
+
+// Test: Disturbances are reproducible from seed and stream, survive
+// save()/restore() and differ between streams
+TEST_F(SimulatorTest, DisturbancesAreReproducible) {
+    Simulator::Config config = createSteadyStateConfig();
+    config.disturbances = {
+        Disturbance::brownian(INPUT_INDEX_INLET_FLOW, 0.01, 0.8, 1.2),
+        Disturbance::step(INPUT_INDEX_INLET_FLOW, 5.0, 0.05),
+    };
+    config.disturbanceSeed = 1234;
+    config.disturbanceStream = 2;
+
+    Simulator a(config);
+    Simulator b(config);
+    a.run(30);
+    b.run(30);
+    EXPECT_EQ(a.getStepCount(), 30u);
+    EXPECT_NE(a.getInputs()(INPUT_INDEX_INLET_FLOW), TEST_INLET_FLOW);
+    EXPECT_EQ(a.getInputs()(INPUT_INDEX_INLET_FLOW), b.getInputs()(INPUT_INDEX_INLET_FLOW));
+    EXPECT_EQ(a.getState()(0), b.getState()(0));
+
+    // Rewinding replays the same draws
+    const Simulator::Snapshot saved = a.save();
+    a.run(20);
+    const Eigen::VectorXd first = a.getInputs();
+    a.restore(saved);
+    EXPECT_EQ(a.getStepCount(), 30u);
+    a.run(20);
+    EXPECT_EQ(a.getInputs(), first);
+
+    // reset() restarts the sequence
+    b.reset();
+    EXPECT_EQ(b.getStepCount(), 0u);
+    b.run(50);
+    EXPECT_EQ(b.getInputs(), first);
+
+    config.disturbanceStream = 3;
+    Simulator other(config);
+    other.run(50);
+    EXPECT_NE(other.getInputs()(INPUT_INDEX_INLET_FLOW), first(INPUT_INDEX_INLET_FLOW));
+}
+
+// Test: Disturbances on inputs that are missing or driven by a controller are
+// rejected; setDisturbances() swaps the list at runtime
+TEST_F(SimulatorTest, DisturbanceValidation) {
+    Simulator::Config config = createSteadyStateConfig();
+    config.disturbances = {Disturbance::brownian(TANK_INPUT_SIZE, 0.01)};
+    EXPECT_THROW(Simulator sim(config), std::invalid_argument);
+    config.disturbances = {Disturbance::brownian(INPUT_INDEX_VALVE_POSITION, 0.01)};
+    EXPECT_THROW(Simulator sim(config), std::invalid_argument);
+
+    config.disturbances.clear();
+    Simulator sim(config);
+    EXPECT_THROW(sim.setDisturbances({Disturbance::ramp(INPUT_INDEX_INLET_FLOW, 0.0, -1.0, 0.1)}),
+                 std::invalid_argument);
+    sim.setDisturbances({Disturbance::ramp(INPUT_INDEX_INLET_FLOW, 0.0, 1.0, 0.1)});
+    ASSERT_EQ(sim.getDisturbances().size(), 1u);
+    sim.run(20);
+    EXPECT_NEAR(sim.getInputs()(INPUT_INDEX_INLET_FLOW), TEST_INLET_FLOW + 0.1, 1e-12);
+}
+
+// Test: Posted commands apply at the next step, same as the setters then
+TEST_F(SimulatorTest, PostedCommandsApplyAtNextStep) {
+    Simulator::Config config = createSteadyStateConfig();
+    config.commandQueueCapacity = 8;
+    Simulator posted(config);
+    config.commandQueueCapacity = 0;
+    Simulator direct(config);
+    ASSERT_NE(posted.getCommandQueue(), nullptr);
+    EXPECT_EQ(posted.getCommandQueue()->capacity(), 8);
+    EXPECT_EQ(direct.getCommandQueue(), nullptr);
+
+    const PIDController::Gains gains{-2.0, 5.0, 0.0};
+    EXPECT_TRUE(posted.post(Command::setpoint(0, 3.0)));
+    EXPECT_EQ(posted.post({Command::input(INPUT_INDEX_INLET_FLOW, 1.2),
+                           Command::retune(0, gains)}), 2);
+    // Nothing changes until the step boundary
+    EXPECT_DOUBLE_EQ(posted.getSetpoint(0), TANK_NOMINAL_HEIGHT);
+    EXPECT_DOUBLE_EQ(posted.getInputs()(INPUT_INDEX_INLET_FLOW), TEST_INLET_FLOW);
+
+    direct.setSetpoint(0, 3.0);
+    direct.setInput(INPUT_INDEX_INLET_FLOW, 1.2);
+    direct.setControllerGains(0, gains);
+    for (int k = 0; k < 20; ++k) {
+        posted.step();
+        direct.step();
+    }
+    EXPECT_EQ(posted.getState()(0), direct.getState()(0));
+    EXPECT_EQ(posted.getInputs(), direct.getInputs());
+    EXPECT_DOUBLE_EQ(posted.getSetpoint(0), 3.0);
+    EXPECT_EQ(posted.getCommandQueue()->pushed(), 3u);
+}
+
+// Test: post() validates before queueing and needs a queue
+TEST_F(SimulatorTest, PostValidatesCommands) {
+    Simulator::Config config = createSteadyStateConfig();
+    Simulator none(config);
+    EXPECT_THROW(none.post(Command::setpoint(0, 3.0)), std::runtime_error);
+
+    config.commandQueueCapacity = -1;
+    EXPECT_THROW(Simulator sim(config), std::invalid_argument);
+
+    config.commandQueueCapacity = 2;
+    Simulator sim(config);
+    EXPECT_THROW(sim.post(Command::input(TANK_INPUT_SIZE, 1.0)), std::out_of_range);
+    EXPECT_THROW(sim.post(Command::setpoint(1, 1.0)), std::out_of_range);
+    EXPECT_THROW(sim.post(Command::retune(-1, PIDController::Gains{-1.0, 10.0, 0.0})),
+                 std::out_of_range);
+    // A bad command rejects the whole batch
+    EXPECT_THROW(sim.post({Command::setpoint(0, 3.0), Command::setpoint(1, 3.0)}),
+                 std::out_of_range);
+    EXPECT_EQ(sim.getCommandQueue()->pushed(), 0u);
+
+    // A full queue drops the tail of a batch
+    EXPECT_EQ(sim.post({Command::setpoint(0, 3.0), Command::setpoint(0, 3.5),
+                        Command::setpoint(0, 4.0)}), 2);
+    EXPECT_FALSE(sim.post(Command::setpoint(0, 4.0)));
+    EXPECT_EQ(sim.getCommandQueue()->dropped(), 2u);
+    sim.step();
+    EXPECT_DOUBLE_EQ(sim.getSetpoint(0), 3.5);
+}
+
+// Test: reset() discards pending commands; forks get their own queue
+TEST_F(SimulatorTest, CommandQueueResetAndFork) {
+    Simulator::Config config = createSteadyStateConfig();
+    config.commandQueueCapacity = 4;
+    Simulator sim(config);
+
+    sim.post(Command::setpoint(0, 3.0));
+    sim.reset();
+    sim.step();
+    EXPECT_DOUBLE_EQ(sim.getSetpoint(0), TANK_NOMINAL_HEIGHT);
+
+    sim.post(Command::setpoint(0, 3.0));
+    Simulator branch = sim.fork();
+    ASSERT_NE(branch.getCommandQueue(), nullptr);
+    EXPECT_EQ(branch.getCommandQueue()->capacity(), 4);
+    branch.step();
+    sim.step();
+    EXPECT_DOUBLE_EQ(branch.getSetpoint(0), TANK_NOMINAL_HEIGHT);
+    EXPECT_DOUBLE_EQ(sim.getSetpoint(0), 3.0);
+}
+
+// Test: reinit() turns a used simulator into one indistinguishable from a
+// newly constructed one, for every integrator
+TEST_F(SimulatorTest, ReinitMatchesFreshConstruction) {
+    for (Simulator::Integrator integrator :
+         {Simulator::Integrator::RK4, Simulator::Integrator::GslRK4,
+          Simulator::Integrator::AdaptiveRKF45,
+          Simulator::Integrator::Rosenbrock, Simulator::Integrator::ExactZOH}) {
+        Simulator::Config first = createSteadyStateConfig(3.0);
+        first.integrator = Simulator::Integrator::GslRK4;
+        first.commandQueueCapacity = 4;
+        Simulator sim(first);
+        sim.run(25);
+        sim.post(Command::setpoint(0, 1.0));  // Must not survive reinit()
+
+        Simulator::Config config = createSteadyStateConfig(2.0);
+        config.integrator = integrator;
+        config.controllerConfig[0].gains = PIDController::Gains{-2.0, 20.0, 1.0};
+        config.disturbances = {Disturbance::brownian(INPUT_INDEX_INLET_FLOW, 0.01)};
+        config.disturbanceSeed = 5;
+        config.commandQueueCapacity = 4;
+        sim.reinit(config);
+        Simulator fresh(config);
+
+        EXPECT_EQ(sim.getTime(), 0.0);
+        EXPECT_EQ(sim.getStepCount(), 0u);
+        EXPECT_EQ(sim.getMetrics().report().steps, 0u);
+        sim.run(40);
+        fresh.run(40);
+        EXPECT_EQ(sim.getState(), fresh.getState());
+        EXPECT_EQ(sim.getInputs(), fresh.getInputs());
+        EXPECT_EQ(sim.getSetpoint(0), 2.0);
+        EXPECT_EQ(sim.getIntegrationStats().derivativeEvaluations,
+                  fresh.getIntegrationStats().derivativeEvaluations);
+    }
+}
+
+// Test: Buffers of an unchanged size are kept (and cleared) by reinit();
+// others are rebuilt or dropped
+TEST_F(SimulatorTest, ReinitReusesMatchingBuffers) {
+    Simulator::Config config = createSteadyStateConfig();
+    config.historyCapacity = 16;
+    config.historyLevels = {{4, 8}};
+    config.commandQueueCapacity = 8;
+    Simulator sim(config);
+    sim.run(10);
+    const HistoryBuffer *history = sim.getHistory();
+    const HistoryPyramid *pyramid = sim.getHistoryPyramid();
+    const CommandQueue *queue = sim.getCommandQueue();
+
+    sim.reinit(config);
+    EXPECT_EQ(sim.getHistory(), history);
+    EXPECT_EQ(sim.getHistory()->size(), 0);
+    EXPECT_EQ(sim.getHistoryPyramid(), pyramid);
+    EXPECT_EQ(sim.getCommandQueue(), queue);
+
+    config.historyCapacity = 32;
+    config.commandQueueCapacity = 0;
+    sim.reinit(config);
+    ASSERT_NE(sim.getHistory(), nullptr);
+    EXPECT_EQ(sim.getHistory()->capacity(), 32);
+    EXPECT_EQ(sim.getCommandQueue(), nullptr);
+
+    config.historyCapacity = 0;
+    config.historyLevels.clear();
+    config.controllerConfig.clear();
+    sim.reinit(config);
+    EXPECT_EQ(sim.getHistory(), nullptr);
+    EXPECT_EQ(sim.getHistoryPyramid(), nullptr);
+    EXPECT_EQ(sim.getControllerCount(), 0);
+}
+
+// Test: A rejected reinit() leaves the simulator exactly as it was
+TEST_F(SimulatorTest, ReinitFailureLeavesSimulatorUnchanged) {
+    const Simulator::Config config = createSteadyStateConfig(3.0);
+    Simulator sim(config);
+    sim.run(10);
+    Simulator twin = sim.fork();
+
+    std::vector<Simulator::Config> invalid(7, createSteadyStateConfig());
+    invalid[0].dt = -1.0;
+    invalid[1].initialState = Eigen::VectorXd::Zero(2);
+    invalid[2].controllerConfig[0].gains.tau_I = -1.0;
+    invalid[3].controllerConfig[0].outputIndex = TANK_INPUT_SIZE;
+    invalid[4].disturbances = {Disturbance::brownian(INPUT_INDEX_VALVE_POSITION, 0.01)};
+    invalid[5].historyLevels = {{0, 8}};
+    invalid[6].commandQueueCapacity = Eigen::Index(1) << 31;
+    for (size_t i = 0; i < invalid.size(); ++i) {
+        EXPECT_THROW(sim.reinit(invalid[i]), std::invalid_argument) << "config " << i;
+    }
+
+    EXPECT_EQ(sim.getTime(), twin.getTime());
+    sim.run(10);
+    twin.run(10);
+    EXPECT_EQ(sim.getState(), twin.getState());
+    EXPECT_EQ(sim.getSetpoint(0), 3.0);
+}
+
+namespace {
+
+// Two first-order lags in series, x1' = (u - x1) / tau1, x2' = (x1 - x2) / tau2,
+// observed at x2: a second plant for the Simulator model concept, with no
+// Jacobian or closed form
+class LagModel {
+public:
+    static constexpr int STATE_SIZE = 2;
+    static constexpr int INPUT_SIZE = 1;
+    static constexpr int OUTPUT_SIZE = 1;
+    using StateVector = Eigen::Matrix<double, STATE_SIZE, 1>;
+    using InputVector = Eigen::Matrix<double, INPUT_SIZE, 1>;
+    using OutputVector = Eigen::Matrix<double, OUTPUT_SIZE, 1>;
+
+    struct Parameters {
+        double tau1;
+        double tau2;
+    };
+
+    explicit LagModel(const Parameters &params) : params_(params) {}
+
+    StateVector derivatives(const StateVector &x, const InputVector &u) const {
+        StateVector dxdt;
+        dxdt << (u(0) - x(0)) / params_.tau1, (x(0) - x(1)) / params_.tau2;
+        return dxdt;
+    }
+
+    OutputVector outputs(const StateVector &x, const InputVector &) const {
+        return OutputVector::Constant(x(1));
+    }
+
+protected:
+    Parameters params_;
+};
+
+// The same plant with its (constant) Jacobian, which enables Rosenbrock
+class LagModelWithJacobian : public LagModel {
+public:
+    using LagModel::LagModel;
+
+    Eigen::Matrix2d jacobian(const StateVector &, const InputVector &) const {
+        Eigen::Matrix2d dfdx;
+        dfdx << -1.0 / params_.tau1, 0.0, 1.0 / params_.tau2, -1.0 / params_.tau2;
+        return dfdx;
+    }
+};
+
+// Unit step response of x2 from rest
+double lagStepResponse(double tau1, double tau2, double t) {
+    return 1.0 - (tau1 * std::exp(-t / tau1) - tau2 * std::exp(-t / tau2)) /
+                     (tau1 - tau2);
+}
+
+template <typename Model>
+typename BasicSimulator<Model>::Config lagConfig(SimulatorTypes::Integrator integrator) {
+    typename BasicSimulator<Model>::Config config;
+    config.params = {5.0, 2.0};
+    config.initialState = Eigen::VectorXd::Zero(2);
+    config.initialInputs = Eigen::VectorXd::Ones(1);
+    config.dt = 0.1;
+    config.integrator = integrator;
+    return config;
+}
+
+}  // namespace
+
+template class tank_sim::BasicSimulator<LagModel>;
+template class tank_sim::BasicSimulator<LagModelWithJacobian>;
+
+// Test: BasicSimulator runs a model other than TankModel, with every
+// integrator the model supports, and rejects the ones it cannot
+TEST(BasicSimulatorTest, RunsAnotherModel) {
+    using LagSimulator = BasicSimulator<LagModel>;
+    using Integrator = SimulatorTypes::Integrator;
+    const double expected = lagStepResponse(5.0, 2.0, 10.0);
+
+    for (Integrator integrator :
+         {Integrator::RK4, Integrator::GslRK4, Integrator::AdaptiveRKF45}) {
+        LagSimulator sim(lagConfig<LagModel>(integrator));
+        sim.run(100);
+        EXPECT_NEAR(sim.getTime(), 10.0, 1e-9);
+        EXPECT_NEAR(sim.getState()(1), expected, 1e-6);
+        ASSERT_EQ(sim.getOutputs().size(), 1);
+        EXPECT_EQ(sim.getOutputs()(0), sim.getState()(1));
+        EXPECT_EQ(sim.getOutletFlow(), sim.getState()(1));
+
+        // Tank-specific telemetry fields the model has no input for are NaN
+        const SimulatorTypes::Telemetry telemetry = sim.getTelemetry();
+        EXPECT_EQ(telemetry.inletFlow, 1.0);
+        EXPECT_TRUE(std::isnan(telemetry.valvePosition));
+    }
+
+    EXPECT_THROW(LagSimulator sim(lagConfig<LagModel>(Integrator::Rosenbrock)),
+                 std::invalid_argument);
+    EXPECT_THROW(LagSimulator sim(lagConfig<LagModel>(Integrator::ExactZOH)),
+                 std::invalid_argument);
+
+    auto config = lagConfig<LagModel>(Integrator::RK4);
+    config.initialState = Eigen::VectorXd::Zero(1);
+    EXPECT_THROW(LagSimulator sim(config), std::invalid_argument);
+}
+
+// Test: a model with jacobian() gets the Rosenbrock integrator, and
+// save()/restore() round-trip the wider state
+TEST(BasicSimulatorTest, DetectsModelJacobian) {
+    using Integrator = SimulatorTypes::Integrator;
+    BasicSimulator<LagModelWithJacobian> sim(
+        lagConfig<LagModelWithJacobian>(Integrator::Rosenbrock));
+    sim.run(50);
+    const auto snapshot = sim.save();
+    sim.run(50);
+    // ROS2 is second order: about 2e-4 at dt = 0.1 on these time constants
+    EXPECT_NEAR(sim.getState()(1), lagStepResponse(5.0, 2.0, 10.0), 5e-4);
+    EXPECT_EQ(sim.getIntegrationStats().jacobianEvaluations, 100);
+
+    const Eigen::VectorXd end = sim.getState();
+    sim.restore(snapshot);
+    sim.run(50);
+    EXPECT_EQ(sim.getState(), end);
+}
@@ -329,3 +329,242 @@ TEST_F(StepperTest, NegativeStepSize) {
     EXPECT_GT(state(0), 0.3679) << "State should be larger than starting value after backward integration";
 }
 
+
+// Test: In-place step matches the allocating step
+TEST_F(StepperTest, InPlaceStepMatchesAllocatingStep) {
+    // Same harmonic oscillator as above, integrated with both APIs.
+    // Both overloads drive the same GSL stepper, so results must be identical.
+    const double omega = TWO_PI;
+    const double dt = 0.01;
+    const int num_steps = 100;
+
+    auto derivative = [&](double t, const Eigen::VectorXd& y, const Eigen::VectorXd& u) -> Eigen::VectorXd {
+        Eigen::VectorXd dy(2);
+        dy(0) = y(1);
+        dy(1) = -omega * omega * y(0);
+        return dy;
+    };
+
+    Stepper::InPlaceDerivativeFunc derivative_in_place =
+        [&](double t, const Eigen::Ref<const Eigen::VectorXd>& y,
+            const Eigen::Ref<const Eigen::VectorXd>& u, Eigen::Ref<Eigen::VectorXd> dy) {
+            dy(0) = y(1);
+            dy(1) = -omega * omega * y(0);
+        };
+
+    Stepper stepper_alloc(2, 2);
+    Stepper stepper_in_place(2, 2);
+
+    Eigen::VectorXd state_alloc(2);
+    state_alloc << 1.0, 0.0;
+    Eigen::VectorXd state_in_place = state_alloc;
+    Eigen::VectorXd input = Eigen::VectorXd::Zero(2);
+
+    double current_time = 0.0;
+    for (int i = 0; i < num_steps; ++i) {
+        state_alloc = stepper_alloc.step(current_time, dt, state_alloc, input, derivative);
+        stepper_in_place.step(current_time, dt, state_in_place, input, derivative_in_place);
+        current_time += dt;
+    }
+
+    EXPECT_DOUBLE_EQ(state_in_place(0), state_alloc(0));
+    EXPECT_DOUBLE_EQ(state_in_place(1), state_alloc(1));
+}
+
+// Test: In-place step works on a caller-owned raw buffer
+TEST_F(StepperTest, InPlaceStepOnRawBuffer) {
+    // dy/dt = u - k*y integrated on a plain double array wrapped with Eigen::Map
+    const double k = 1.0;
+    const double dt = TEST_RK4_DT_COARSE;
+    const int num_steps = TEST_NUM_STEPS;
+
+    double buffer[1] = {0.0};
+    Eigen::Map<Eigen::VectorXd> state(buffer, 1);
+
+    Eigen::VectorXd input(1);
+    input(0) = TEST_INLET_FLOW;
+
+    Stepper::InPlaceDerivativeFunc derivative =
+        [&](double t, const Eigen::Ref<const Eigen::VectorXd>& y,
+            const Eigen::Ref<const Eigen::VectorXd>& u, Eigen::Ref<Eigen::VectorXd> dy) {
+            dy(0) = u(0) - k * y(0);
+        };
+
+    Stepper stepper(1, 1);
+    double current_time = 0.0;
+    for (int i = 0; i < num_steps; ++i) {
+        stepper.step(current_time, dt, state, input, derivative);
+        current_time += dt;
+    }
+
+    double expected = (TEST_INLET_FLOW / k) * (1.0 - std::exp(-k * 1.0));
+    EXPECT_NEAR(buffer[0], expected, INTEGRATION_TOLERANCE) << "Raw buffer should hold the integrated state";
+}
+
+// Test: In-place step validates dimensions and leaves state untouched on error
+TEST_F(StepperTest, InPlaceStepDimensionValidation) {
+    Stepper stepper(2, 2);
+
+    Stepper::InPlaceDerivativeFunc derivative =
+        [](double t, const Eigen::Ref<const Eigen::VectorXd>& y,
+           const Eigen::Ref<const Eigen::VectorXd>& u, Eigen::Ref<Eigen::VectorXd> dy) {
+            dy(0) = y(1);
+            dy(1) = -y(0);
+        };
+
+    Eigen::VectorXd wrong_state(1);
+    wrong_state(0) = 1.0;
+    Eigen::VectorXd valid_input = Eigen::VectorXd::Zero(2);
+
+    EXPECT_THROW(stepper.step(0.0, 0.1, wrong_state, valid_input, derivative), std::runtime_error);
+    EXPECT_EQ(wrong_state(0), 1.0) << "State must not be modified when validation fails";
+
+    Eigen::VectorXd valid_state(2);
+    valid_state << 1.0, 0.5;
+    Eigen::VectorXd wrong_input = Eigen::VectorXd::Zero(1);
+
+    EXPECT_THROW(stepper.step(0.0, 0.1, valid_state, wrong_input, derivative), std::runtime_error);
+    EXPECT_NO_THROW(stepper.step(0.0, 0.1, valid_state, valid_input, derivative));
+}
+
+// Test: Native backend matches GSL on exponential decay
+TEST_F(StepperTest, NativeBackendMatchesGslExponentialDecay) {
+    // GSL's rk4 returns a step-doubled result, the native kernel a single
+    // classic RK4 step. Both are 4th-order, so they agree to within the same
+    // tolerance as the analytical comparisons above.
+    const double k = 1.0;
+    const double dt = TEST_RK4_DT_COARSE;
+    const int num_steps = TEST_NUM_STEPS;
+
+    auto derivative = [&](double t, const Eigen::VectorXd& y, const Eigen::VectorXd& u) -> Eigen::VectorXd {
+        Eigen::VectorXd dy(1);
+        dy(0) = -k * y(0);
+        return dy;
+    };
+
+    Stepper gsl_stepper(1, 1, Stepper::Backend::GSL);
+    Stepper native_stepper(1, 1, Stepper::Backend::Native);
+    EXPECT_EQ(gsl_stepper.getBackend(), Stepper::Backend::GSL);
+    EXPECT_EQ(native_stepper.getBackend(), Stepper::Backend::Native);
+
+    Eigen::VectorXd gsl_state(1);
+    gsl_state(0) = 1.0;
+    Eigen::VectorXd native_state = gsl_state;
+    Eigen::VectorXd input = Eigen::VectorXd::Zero(1);
+
+    double current_time = 0.0;
+    for (int i = 0; i < num_steps; ++i) {
+        gsl_state = gsl_stepper.step(current_time, dt, gsl_state, input, derivative);
+        native_state = native_stepper.step(current_time, dt, native_state, input, derivative);
+        current_time += dt;
+        EXPECT_NEAR(native_state(0), gsl_state(0), INTEGRATION_TOLERANCE) << "Backends diverged at step " << i;
+    }
+
+    EXPECT_NEAR(native_state(0), std::exp(-k * 1.0), INTEGRATION_TOLERANCE);
+}
+
+// Test: Native backend is fourth-order accurate
+TEST_F(StepperTest, NativeBackendFourthOrderAccuracy) {
+    const double k = 1.0;
+    const double expected = std::exp(-k * 1.0);
+
+    auto derivative = [&](double t, const Eigen::VectorXd& y, const Eigen::VectorXd& u) -> Eigen::VectorXd {
+        Eigen::VectorXd dy(1);
+        dy(0) = -k * y(0);
+        return dy;
+    };
+
+    auto integrate = [&](double dt, int num_steps) {
+        Stepper stepper(1, 1, Stepper::Backend::Native);
+        Eigen::VectorXd state(1);
+        state(0) = 1.0;
+        double current_time = 0.0;
+        for (int i = 0; i < num_steps; ++i) {
+            state = stepper.step(current_time, dt, state, Eigen::VectorXd::Zero(1), derivative);
+            current_time += dt;
+        }
+        return std::abs(state(0) - expected);
+    };
+
+    double error_ratio = integrate(TEST_RK4_DT_COARSE, TEST_NUM_STEPS) /
+                         integrate(TEST_RK4_DT_FINE, TEST_NUM_STEPS_FINE);
+
+    EXPECT_GT(error_ratio, RK4_MIN_ERROR_RATIO) << "Error ratio " << error_ratio << " is below expected range for fourth-order method";
+    EXPECT_LT(error_ratio, RK4_MAX_ERROR_RATIO) << "Error ratio " << error_ratio << " is above expected range for fourth-order method";
+}
+
+// Test: Native in-place backend matches GSL on the harmonic oscillator
+TEST_F(StepperTest, NativeBackendMatchesGslHarmonicOscillator) {
+    const double omega = TWO_PI;
+    const double dt = 0.01;
+    const int num_steps = 100;
+
+    Stepper::InPlaceDerivativeFunc derivative =
+        [&](double t, const Eigen::Ref<const Eigen::VectorXd>& y,
+            const Eigen::Ref<const Eigen::VectorXd>& u, Eigen::Ref<Eigen::VectorXd> dy) {
+            dy(0) = y(1);
+            dy(1) = -omega * omega * y(0);
+        };
+
+    Stepper gsl_stepper(2, 2, Stepper::Backend::GSL);
+    Stepper native_stepper(2, 2, Stepper::Backend::Native);
+
+    Eigen::VectorXd gsl_state(2);
+    gsl_state << 1.0, 0.0;
+    Eigen::VectorXd native_state = gsl_state;
+    Eigen::VectorXd input = Eigen::VectorXd::Zero(2);
+
+    double current_time = 0.0;
+    for (int i = 0; i < num_steps; ++i) {
+        gsl_stepper.step(current_time, dt, gsl_state, input, derivative);
+        native_stepper.step(current_time, dt, native_state, input, derivative);
+        current_time += dt;
+    }
+
+    EXPECT_NEAR(native_state(0), gsl_state(0), OSCILLATOR_POSITION_TOLERANCE);
+    EXPECT_NEAR(native_state(1), gsl_state(1), OSCILLATOR_VELOCITY_TOLERANCE);
+    EXPECT_NEAR(native_state(0), 1.0, OSCILLATOR_POSITION_TOLERANCE) << "Position should return to initial value after one period";
+}
+
+// Test: Native backend validates dimensions like the GSL backend
+TEST_F(StepperTest, NativeBackendDimensionValidation) {
+    Stepper stepper(2, 2, Stepper::Backend::Native);
+
+    auto derivative = [](double t, const Eigen::VectorXd& y, const Eigen::VectorXd& u) -> Eigen::VectorXd {
+        Eigen::VectorXd dy(2);
+        dy(0) = y(1);
+        dy(1) = -y(0);
+        return dy;
+    };
+
+    EXPECT_THROW(stepper.step(0.0, 0.1, Eigen::VectorXd::Zero(1), Eigen::VectorXd::Zero(2), derivative), std::runtime_error);
+    EXPECT_THROW(stepper.step(0.0, 0.1, Eigen::VectorXd::Zero(2), Eigen::VectorXd::Zero(1), derivative), std::runtime_error);
+    EXPECT_NO_THROW(stepper.step(0.0, 0.1, Eigen::VectorXd::Zero(2), Eigen::VectorXd::Zero(2), derivative));
+}
+
+#if TANK_SIM_METRICS
+// Test: Metrics count steps and the derivative evaluations each backend makes
+TEST_F(StepperTest, MetricsCountDerivativeEvaluations) {
+    for (Stepper::Backend backend : {Stepper::Backend::GSL, Stepper::Backend::Native}) {
+        Stepper stepper(1, 1, backend);
+        long calls = 0;
+        Stepper::InPlaceDerivativeFunc derivative =
+            [&calls](double, const Eigen::Ref<const Eigen::VectorXd>& y,
+                     const Eigen::Ref<const Eigen::VectorXd>&,
+                     Eigen::Ref<Eigen::VectorXd> dydt) {
+                ++calls;
+                dydt = -y;
+            };
+        Eigen::VectorXd state = Eigen::VectorXd::Ones(1);
+        const Eigen::VectorXd input = Eigen::VectorXd::Zero(1);
+        for (int i = 0; i < 10; ++i) {
+            stepper.step(0.1 * i, 0.1, state, input, derivative);
+        }
+
+        const Metrics::Report report = stepper.getMetrics().report();
+        EXPECT_EQ(report.steps, 10u);
+        EXPECT_EQ(report.derivativeEvaluations, static_cast<std::uint64_t>(calls));
+        EXPECT_GT(report.phaseSeconds[Metrics::INTEGRATION], 0.0);
+    }
+}
+#endif
@@ -142,3 +142,207 @@ TEST_F(TankModelTest, FullValveOpening) {
     
     EXPECT_NEAR(outlet_flow, expected, TANK_STATE_TOLERANCE);
 }
+
+// Test: In-place derivatives match the allocating overload
+TEST_F(TankModelTest, InPlaceDerivativesMatchAllocating) {
+    Eigen::VectorXd state(1);
+    state << 3.2;  // above nominal level
+
+    Eigen::VectorXd inputs(2);
+    inputs << 0.7,  // inlet flow below nominal
+              0.8;  // valve mostly open
+
+    Eigen::VectorXd expected = model.derivatives(state, inputs);
+
+    double buffer[1] = {0.0};
+    Eigen::Map<Eigen::VectorXd> derivative(buffer, 1);
+    model.derivatives(state, inputs, derivative);
+
+    EXPECT_DOUBLE_EQ(buffer[0], expected(0));
+}
+
+// Test: Fixed-size derivatives match the dynamic overload
+TEST_F(TankModelTest, FixedSizeDerivativesMatchDynamic) {
+    Eigen::VectorXd state(1);
+    state << 1.8;
+
+    Eigen::VectorXd inputs(2);
+    inputs << 1.3, 0.35;
+
+    Eigen::VectorXd expected = model.derivatives(state, inputs);
+
+    TankModel::StateVector fixed_state = state;
+    TankModel::InputVector fixed_inputs = inputs;
+    TankModel::StateVector derivative = model.derivatives(fixed_state, fixed_inputs);
+
+    EXPECT_DOUBLE_EQ(derivative(0), expected(0));
+}
+
+// Test: Analytic Jacobian matches a central finite difference
+TEST_F(TankModelTest, JacobianMatchesFiniteDifference) {
+    Eigen::VectorXd inputs(2);
+    inputs << TEST_INLET_FLOW, 0.7;
+
+    for (double h : {0.05, 1.0, TANK_NOMINAL_HEIGHT, 4.5}) {
+        Eigen::VectorXd state(1);
+        state << h;
+        Eigen::MatrixXd jacobian(1, 1);
+        model.jacobian(state, inputs, jacobian);
+
+        const double step = 1e-6 * h;
+        Eigen::VectorXd up(1), down(1);
+        up << h + step;
+        down << h - step;
+        const double numeric =
+            (model.derivatives(up, inputs)(0) - model.derivatives(down, inputs)(0)) /
+            (2.0 * step);
+        EXPECT_NEAR(jacobian(0, 0), numeric, 1e-6 * std::abs(numeric)) << "h = " << h;
+        EXPECT_LT(jacobian(0, 0), 0.0);
+
+        TankModel::JacobianMatrix fixed = model.jacobian(
+            TankModel::StateVector(state), TankModel::InputVector(inputs));
+        EXPECT_DOUBLE_EQ(fixed(0, 0), jacobian(0, 0));
+    }
+}
+
+// Test: Jacobian stays finite at an empty tank (one-sided, bounded slope)
+TEST_F(TankModelTest, JacobianBoundedWhenEmpty) {
+    Eigen::VectorXd state(1);
+    Eigen::VectorXd inputs(2);
+    inputs << TEST_INLET_FLOW, TEST_VALVE_POSITION;
+    Eigen::MatrixXd empty(1, 1), floor(1, 1);
+
+    state << 0.0;
+    model.jacobian(state, inputs, empty);
+    state << MIN_JACOBIAN_HEAD;
+    model.jacobian(state, inputs, floor);
+
+    EXPECT_TRUE(std::isfinite(empty(0, 0)));
+    EXPECT_LT(empty(0, 0), 0.0);
+    EXPECT_DOUBLE_EQ(empty(0, 0), floor(0, 0));
+}
+
+namespace {
+
+// Reference solution: classical RK4 with many substeps, inputs held
+double fineRk4Level(const TankModel &model, double h, const TankModel::InputVector &u,
+                    double dt, int substeps) {
+    const double step = dt / substeps;
+    TankModel::StateVector x;
+    x << h;
+    for (int i = 0; i < substeps; ++i) {
+        const TankModel::StateVector k1 = model.derivatives(x, u);
+        const TankModel::StateVector k2 = model.derivatives(
+            TankModel::StateVector((x + 0.5 * step * k1).cwiseMax(0.0)), u);
+        const TankModel::StateVector k3 = model.derivatives(
+            TankModel::StateVector((x + 0.5 * step * k2).cwiseMax(0.0)), u);
+        const TankModel::StateVector k4 = model.derivatives(
+            TankModel::StateVector((x + step * k3).cwiseMax(0.0)), u);
+        x = (x + step / 6.0 * (k1 + 2.0 * k2 + 2.0 * k3 + k4)).cwiseMax(0.0);
+    }
+    return x(0);
+}
+
+}  // namespace
+
+// Test: The exact ZOH step matches a fine RK4 reference, rising and falling,
+// from an empty tank and on a small tank far from equilibrium at MAX_DT
+TEST_F(TankModelTest, PropagateMatchesFineIntegration) {
+    const TankModel small{TankModel::Parameters{1.5, DEFAULT_VALVE_COEFFICIENT,
+                                                TANK_MAX_HEIGHT}};
+    struct Case {
+        const TankModel *model;
+        double h;
+        double q;
+        double x;
+        double tolerance;  // Relative to the reference
+    };
+    const Case cases[] = {
+        {&model, 1.0, TEST_INLET_FLOW, TEST_VALVE_POSITION, 1e-11},  // Rising
+        {&model, 4.5, TEST_INLET_FLOW, TEST_VALVE_POSITION, 1e-11},  // Falling
+        // RK4 converges slowly through the sqrt(h) singularity at h = 0
+        {&model, 0.0, TEST_INLET_FLOW, TEST_VALVE_POSITION, 1e-8},   // From empty
+        {&small, 0.2, 2.0, 0.9, 1e-11},                              // Fast, nonlinear
+        {&small, 4.0, 0.1, 1.0, 1e-11},                              // Fast drain
+        {&model, 2.0, 0.0, 0.3, 1e-11},                              // No inflow
+        {&model, 2.0, TEST_INLET_FLOW, 0.0, 1e-11},                  // Valve closed
+    };
+    for (const Case &c : cases) {
+        TankModel::StateVector h0;
+        h0 << c.h;
+        TankModel::InputVector u;
+        u << c.q, c.x;
+        int iterations = -1;
+        const double exact = c.model->propagate(h0, u, MAX_DT, &iterations)(0);
+        const double reference = fineRk4Level(*c.model, c.h, u, MAX_DT, 20000);
+        EXPECT_NEAR(exact, reference, c.tolerance * std::max(1.0, reference))
+            << "h0 = " << c.h << ", q = " << c.q << ", x = " << c.x;
+        EXPECT_GE(iterations, 0);
+        EXPECT_LE(iterations, 10);
+    }
+}
+
+// Test: Propagation composes, holds equilibrium and settles at (q / (k_v x))^2
+TEST_F(TankModelTest, PropagateSemigroupAndEquilibrium) {
+    TankModel::InputVector u;
+    u << 1.2 * TEST_INLET_FLOW, TEST_VALVE_POSITION;
+    TankModel::StateVector h0;
+    h0 << 1.0;
+
+    const double whole = model.propagate(h0, u, 7.0)(0);
+    const double split = model.propagate(model.propagate(h0, u, 3.0), u, 4.0)(0);
+    EXPECT_NEAR(whole, split, 1e-13);
+
+    const double s = u(0) / (DEFAULT_VALVE_COEFFICIENT * TEST_VALVE_POSITION);
+    TankModel::StateVector settled;
+    settled << s * s;
+    EXPECT_DOUBLE_EQ(model.propagate(settled, u, MAX_DT)(0), s * s);
+
+    TankModel::StateVector h = h0;
+    for (int i = 0; i < 2000; ++i) {
+        h = model.propagate(h, u, MAX_DT);
+    }
+    EXPECT_NEAR(h(0), s * s, 1e-9);
+}
+
+// Test: A tank that drains all the way within the period ends exactly empty
+TEST_F(TankModelTest, PropagateEmptiesTank) {
+    const TankModel tiny{TankModel::Parameters{0.1, DEFAULT_VALVE_COEFFICIENT,
+                                               TANK_MAX_HEIGHT}};
+    TankModel::StateVector h0;
+    h0 << 0.5;
+    TankModel::InputVector u;
+    u << 0.0, 1.0;
+    EXPECT_EQ(tiny.propagate(h0, u, MAX_DT)(0), 0.0);
+
+    u << -0.01, 1.0;  // Net withdrawal through the inlet
+    EXPECT_EQ(tiny.propagate(h0, u, MAX_DT)(0), 0.0);
+    u << -0.01, 0.0;
+    EXPECT_EQ(tiny.propagate(h0, u, MAX_DT)(0), 0.0);
+}
+
+// Test: A nonlinear valve characteristic scales the outlet flow and slope by
+// f(x) and the exact step still matches a fine integration
+TEST_F(TankModelTest, ValveCharacteristic) {
+    TankModel::Parameters equalParams = params;
+    equalParams.valve_characteristic = ValveCharacteristic::EQUAL_PERCENTAGE;
+    const TankModel equal(equalParams);
+    const double f = equal.getValveCurve().opening(TEST_VALVE_POSITION);
+    EXPECT_LT(f, TEST_VALVE_POSITION);
+
+    TankModel::StateVector h;
+    h << TANK_NOMINAL_HEIGHT;
+    TankModel::InputVector u;
+    u << TEST_INLET_FLOW, TEST_VALVE_POSITION;
+    EXPECT_NEAR(equal.getOutletFlow(h, u),
+                DEFAULT_VALVE_COEFFICIENT * f * std::sqrt(TANK_NOMINAL_HEIGHT), 1e-15);
+    EXPECT_NEAR(equal.jacobian(h, u)(0, 0) / model.jacobian(h, u)(0, 0),
+                f / TEST_VALVE_POSITION, 1e-14);
+
+    u << TEST_INLET_FLOW, 0.8;
+    const double exact = equal.propagate(h, u, MAX_DT)(0);
+    EXPECT_NEAR(exact, fineRk4Level(equal, TANK_NOMINAL_HEIGHT, u, MAX_DT, 20000), 1e-11);
+
+    equalParams.rangeability = 0.5;
+    EXPECT_THROW(TankModel{equalParams}, std::invalid_argument);
+}
@@ -0,0 +1,189 @@
+#include <gtest/gtest.h>
+#include <Eigen/Dense>
+#include <filesystem>
+#include <stdexcept>
+#include <string>
+#include "../src/trajectory_log.h"
+#include "../src/simulator.h"
+#include "../src/constants.h"
+
+using namespace tank_sim;
+using namespace tank_sim::constants;
+
+class TrajectoryLogTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        const auto *info = ::testing::UnitTest::GetInstance()->current_test_info();
+        path = (std::filesystem::temp_directory_path() /
+                (std::string("tank_sim_log_") + info->name()))
+                   .string();
+        std::filesystem::remove_all(path);
+    }
+
+    void TearDown() override { std::filesystem::remove_all(path); }
+
+    // Trajectory with 1 state, 2 inputs, 1 controller and time = start + k
+    static Trajectory ramp(Eigen::Index count, double start) {
+        Trajectory t(count, 1, 2, 1);
+        for (Eigen::Index k = 0; k < count; ++k) {
+            const Eigen::Index col = t.append();
+            const double time = start + static_cast<double>(k);
+            t.time(col) = time;
+            t.state(0, col) = 2.0 * time;
+            t.inputs(0, col) = 3.0 * time;
+            t.inputs(1, col) = -time;
+            t.setpoint(0, col) = 1.0;
+            t.error(0, col) = 0.5 * time;
+            t.controllerOutput(0, col) = time / 4.0;
+        }
+        return t;
+    }
+
+    std::string path;
+};
+
+// Test: Round trip through small batches, a direct write and a partial batch
+TEST_F(TrajectoryLogTest, RoundTripAcrossBatches) {
+    {
+        TrajectoryLogWriter writer(path, 1, 2, 1, /*batchSize=*/100);
+        writer.append(ramp(30, 0.0));     // buffered
+        EXPECT_EQ(writer.committed(), 0u);
+        writer.append(ramp(250, 30.0));   // fills the batch, rest buffered
+        writer.append(ramp(5000, 280.0)); // >= one batch: written directly
+        writer.append(ramp(7, 5280.0));
+        EXPECT_EQ(writer.size(), 5287u);
+    }  // destructor flushes
+
+    TrajectoryLogReader reader(path);
+    ASSERT_EQ(reader.size(), 5287);
+    EXPECT_EQ(reader.stateSize(), 1);
+    EXPECT_EQ(reader.inputSize(), 2);
+    EXPECT_EQ(reader.controllerCount(), 1);
+    for (Eigen::Index k = 0; k < reader.size(); ++k) {
+        ASSERT_EQ(reader.time()[k], static_cast<double>(k));
+        ASSERT_EQ(reader.state(0)[k], 2.0 * k);
+        ASSERT_EQ(reader.inputs(1)[k], -static_cast<double>(k));
+        ASSERT_EQ(reader.controllerOutput(0)[k], k / 4.0);
+    }
+    EXPECT_THROW(reader.state(1), std::out_of_range);
+    EXPECT_THROW(reader.error(-1), std::out_of_range);
+}
+
+// Test: Time lookups agree with a linear scan, including across index blocks
+TEST_F(TrajectoryLogTest, TimeSearchMatchesLinearScan) {
+    {
+        TrajectoryLogWriter writer(path, 1, 2, 1);
+        // Repeated times straddle an index entry at sample 1024
+        Trajectory t = ramp(3000, 0.0);
+        for (Eigen::Index k = 1020; k < 1030; ++k) {
+            t.time(k) = 1020.0;
+        }
+        for (Eigen::Index k = 1030; k < 3000; ++k) {
+            t.time(k) = static_cast<double>(k);
+        }
+        writer.append(t);
+    }
+
+    TrajectoryLogReader reader(path);
+    const auto linear = [&](double t, bool inclusive) {
+        Eigen::Index k = 0;
+        while (k < reader.size() &&
+               (inclusive ? reader.time()[k] < t : reader.time()[k] <= t)) {
+            ++k;
+        }
+        return k;
+    };
+    for (double t : {-5.0, 0.0, 0.5, 1019.0, 1020.0, 1020.5, 1024.0, 1030.0,
+                     2047.5, 2048.0, 2999.0, 5000.0}) {
+        EXPECT_EQ(reader.lowerBound(t), linear(t, true)) << "t = " << t;
+        EXPECT_EQ(reader.upperBound(t), linear(t, false)) << "t = " << t;
+    }
+
+    TrajectoryLogReader::Window w = reader.window(1020.0, 1031.0);
+    EXPECT_EQ(w.begin, 1020);
+    EXPECT_EQ(w.count, 12);
+    EXPECT_EQ(reader.window(10.0, 5.0).count, 0);
+
+    Trajectory copy = reader.read(w.begin, w.count);
+    ASSERT_EQ(copy.size(), 12);
+    EXPECT_EQ(copy.time(11), 1031.0);
+    EXPECT_EQ(copy.inputs(0, 0), 3.0 * 1020);
+    EXPECT_THROW(reader.read(2990, 20), std::out_of_range);
+}
+
+// Test: Reopening resumes the log and drops an uncommitted tail
+TEST_F(TrajectoryLogTest, ResumesAndDiscardsUncommittedTail) {
+    {
+        TrajectoryLogWriter writer(path, 1, 2, 1, /*batchSize=*/10);
+        writer.append(ramp(25, 0.0));
+        writer.flush();
+    }
+    // Simulate a writer that died after writing column data but before the
+    // header: extra bytes at the end of a column file
+    std::filesystem::resize_file(std::filesystem::path(path) / "time.f64",
+                                 40 * sizeof(double));
+    {
+        TrajectoryLogWriter writer(path, 1, 2, 1);
+        EXPECT_EQ(writer.committed(), 25u);
+        EXPECT_THROW(writer.append(ramp(5, 10.0)), std::invalid_argument)
+            << "Times would go backwards";
+        writer.append(ramp(5, 25.0));
+        writer.close();
+        EXPECT_THROW(writer.append(ramp(1, 30.0)), std::runtime_error);
+    }
+
+    TrajectoryLogReader reader(path);
+    ASSERT_EQ(reader.size(), 30);
+    for (Eigen::Index k = 0; k < 30; ++k) {
+        EXPECT_EQ(reader.time()[k], static_cast<double>(k));
+    }
+    EXPECT_THROW(TrajectoryLogWriter(path, 2, 2, 1), std::invalid_argument);
+}
+
+// Test: Validation and empty logs
+TEST_F(TrajectoryLogTest, ValidationAndEmptyLog) {
+    EXPECT_THROW(TrajectoryLogReader{path}, std::runtime_error);
+    EXPECT_THROW(TrajectoryLogWriter(path, 1, 2, 1, 0), std::invalid_argument);
+    {
+        TrajectoryLogWriter writer(path, 1, 2, 1);
+        EXPECT_THROW(writer.append(Trajectory(4, 1, 1, 1)), std::invalid_argument);
+    }
+    TrajectoryLogReader reader(path);
+    EXPECT_EQ(reader.size(), 0);
+    EXPECT_EQ(reader.lowerBound(0.0), 0);
+    EXPECT_EQ(reader.window(-1.0, 1.0).count, 0);
+}
+
+// Test: A logged Simulator run replays exactly
+TEST_F(TrajectoryLogTest, LogsSimulatorRun) {
+    Simulator::Config config;
+    config.params = TankModel::Parameters{DEFAULT_TANK_AREA, DEFAULT_VALVE_COEFFICIENT,
+                                          TANK_MAX_HEIGHT};
+    config.initialState = Eigen::VectorXd(1);
+    config.initialState << TANK_NOMINAL_HEIGHT;
+    config.initialInputs = Eigen::VectorXd(2);
+    config.initialInputs << TEST_INLET_FLOW, TEST_VALVE_POSITION;
+    config.dt = TEST_DT;
+    Simulator sim(config);
+    sim.setInput(0, 1.2 * TEST_INLET_FLOW);
+
+    Trajectory chunk = sim.makeTrajectory(64);
+    Trajectory reference = sim.makeTrajectory(640);
+    {
+        TrajectoryLogWriter writer(path, chunk.state.rows(), chunk.inputs.rows(),
+                                   chunk.setpoint.rows());
+        for (int i = 0; i < 10; ++i) {
+            chunk.clear();
+            sim.run(64, chunk);
+            writer.append(chunk);
+            reference.state.middleCols(64 * i, 64) = chunk.state.leftCols(64);
+        }
+    }
+
+    TrajectoryLogReader reader(path);
+    ASSERT_EQ(reader.size(), 640);
+    EXPECT_EQ(reader.time()[639], sim.getTime());
+    for (Eigen::Index k = 0; k < 640; ++k) {
+        EXPECT_EQ(reader.state(0)[k], reference.state(0, k));
+    }
+}
@@ -0,0 +1,149 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <stdexcept>
+#include "../src/valve.h"
+#include "../src/constants.h"
+
+using namespace tank_sim;
+using namespace tank_sim::constants;
+
+namespace {
+
+double equalPercentage(double x, double r) {
+    return (std::pow(r, x) - 1.0) / (r - 1.0);
+}
+
+double quickOpening(double x) {
+    return 1.0 - (1.0 - x) * (1.0 - x);
+}
+
+}  // namespace
+
+// Test: The linear curve has no table and is the identity, bit for bit
+TEST(ValveCurveTest, LinearIsIdentity) {
+    const ValveCurve linear;
+    EXPECT_TRUE(linear.isLinear());
+    EXPECT_EQ(linear.getCharacteristic(), ValveCharacteristic::LINEAR);
+    for (double x : {0.0, 1e-9, 0.123456789, 0.5, 0.999, 1.0}) {
+        EXPECT_EQ(linear.opening(x), x);
+    }
+}
+
+// Test: Tabulated curves stay within the documented interpolation bounds,
+// are exact at both ends and increase monotonically
+TEST(ValveCurveTest, TabulatedCurvesMatchClosedForm) {
+    const ValveCurve equal(ValveCharacteristic::EQUAL_PERCENTAGE,
+                           DEFAULT_VALVE_RANGEABILITY);
+    const ValveCurve quick(ValveCharacteristic::QUICK_OPENING);
+    EXPECT_FALSE(equal.isLinear());
+    EXPECT_FALSE(quick.isLinear());
+
+    double previousEqual = -1.0;
+    double previousQuick = -1.0;
+    for (int i = 0; i <= 100000; ++i) {
+        const double x = i / 100000.0;
+        const double e = equal.opening(x);
+        const double q = quick.opening(x);
+        EXPECT_NEAR(e, equalPercentage(x, DEFAULT_VALVE_RANGEABILITY), 2e-6) << "x = " << x;
+        EXPECT_NEAR(q, quickOpening(x), 2.4e-7) << "x = " << x;
+        EXPECT_GE(e, previousEqual);
+        EXPECT_GE(q, previousQuick);
+        previousEqual = e;
+        previousQuick = q;
+    }
+    EXPECT_EQ(equal.opening(0.0), 0.0);
+    EXPECT_EQ(equal.opening(1.0), 1.0);
+    EXPECT_EQ(quick.opening(0.0), 0.0);
+    EXPECT_EQ(quick.opening(1.0), 1.0);
+
+    // Equal percentage is throttled at mid travel, quick opening is wide open
+    EXPECT_LT(equal.opening(0.5), 0.5);
+    EXPECT_GT(quick.opening(0.5), 0.5);
+}
+
+// Test: Positions outside [0, 1] extend the end segments linearly instead
+// of reading past the table, and NaN propagates
+TEST(ValveCurveTest, OutOfRangePositionsExtendEndSegments) {
+    const double step = 1.0 / (ValveCurve::TABLE_SIZE - 1);
+    for (ValveCharacteristic characteristic :
+         {ValveCharacteristic::EQUAL_PERCENTAGE, ValveCharacteristic::QUICK_OPENING}) {
+        const ValveCurve curve(characteristic);
+        const double firstSlope = (curve.opening(step) - curve.opening(0.0)) / step;
+        const double lastSlope = (curve.opening(1.0) - curve.opening(1.0 - step)) / step;
+
+        for (double x : {-1e-3, -0.5, -1e6}) {
+            EXPECT_NEAR(curve.opening(x), curve.opening(0.0) + x * firstSlope,
+                        1e-9 * std::abs(x) * firstSlope + 1e-12) << "x = " << x;
+        }
+        for (double x : {1.0 + 1e-3, 1.5, 1e6}) {
+            EXPECT_NEAR(curve.opening(x), curve.opening(1.0) + (x - 1.0) * lastSlope,
+                        1e-9 * std::abs(x) * lastSlope + 1e-12) << "x = " << x;
+        }
+        EXPECT_TRUE(std::isnan(curve.opening(std::nan(""))));
+
+        Eigen::ArrayXd x(3);
+        x << -0.5, 1.5, std::nan("");
+        Eigen::ArrayXd out(3);
+        curve.openings(x, out);
+        EXPECT_EQ(out(0), curve.opening(-0.5));
+        EXPECT_EQ(out(1), curve.opening(1.5));
+        EXPECT_TRUE(std::isnan(out(2)));
+    }
+}
+
+// Test: The lane-wise lookup agrees with the scalar one
+TEST(ValveCurveTest, OpeningsMatchScalar) {
+    const ValveCurve equal(ValveCharacteristic::EQUAL_PERCENTAGE, 20.0);
+    Eigen::ArrayXd x = Eigen::ArrayXd::LinSpaced(33, 0.0, 1.0);
+    Eigen::ArrayXd out(33);
+    equal.openings(x, out);
+    for (Eigen::Index i = 0; i < x.size(); ++i) {
+        EXPECT_EQ(out(i), equal.opening(x(i)));
+    }
+}
+
+// Test: Rangeability must exceed 1 for an equal-percentage valve only
+TEST(ValveCurveTest, RejectsInvalidRangeability) {
+    EXPECT_THROW(ValveCurve(ValveCharacteristic::EQUAL_PERCENTAGE, 1.0),
+                 std::invalid_argument);
+    EXPECT_THROW(ValveCurve(ValveCharacteristic::EQUAL_PERCENTAGE, -3.0),
+                 std::invalid_argument);
+    EXPECT_NO_THROW(ValveCurve(ValveCharacteristic::QUICK_OPENING, 1.0));
+}
+
+// Test: fastSqrt() meets FAST_SQRT_RELATIVE_ERROR over many decades and
+// densely over the tank's operating range
+TEST(FastSqrtTest, RelativeErrorBound) {
+    EXPECT_EQ(fastSqrt(0.0), 0.0);
+
+    double worst = 0.0;
+    for (int i = 0; i <= 200000; ++i) {
+        const double h = std::pow(10.0, -30.0 + 40.0 * i / 200000.0);
+        worst = std::max(worst, std::abs(fastSqrt(h) - std::sqrt(h)) / std::sqrt(h));
+    }
+    for (int i = 1; i <= 200000; ++i) {
+        const double h = TANK_MAX_HEIGHT * i / 200000.0;
+        worst = std::max(worst, std::abs(fastSqrt(h) - std::sqrt(h)) / std::sqrt(h));
+    }
+    EXPECT_LE(worst, FAST_SQRT_RELATIVE_ERROR);
+    EXPECT_GT(worst, 0.0);  // It is an approximation
+}
+
+// Test: the float kernel is within a few float ulp of the exact root over the
+// normal range, so float lanes lose nothing to it beyond their own rounding
+TEST(FastSqrtTest, FloatRelativeErrorBound) {
+    EXPECT_EQ(fastSqrt(0.0f), 0.0f);
+
+    double worst = 0.0;
+    for (int i = 0; i <= 200000; ++i) {
+        const float h = static_cast<float>(std::pow(10.0, -30.0 + 50.0 * i / 200000.0));
+        const double exact = std::sqrt(static_cast<double>(h));
+        worst = std::max(worst, std::abs(fastSqrt(h) - exact) / exact);
+    }
+    for (int i = 1; i <= 200000; ++i) {
+        const float h = static_cast<float>(TANK_MAX_HEIGHT * i / 200000.0);
+        const double exact = std::sqrt(static_cast<double>(h));
+        worst = std::max(worst, std::abs(fastSqrt(h) - exact) / exact);
+    }
+    EXPECT_LE(worst, FAST_SQRT_RELATIVE_ERROR_FLOAT);
+}